@@ -0,0 +1,85 @@
+// ==================== DONUT GAUGE ====================
+// Minimal stand-in for the JustGage donut gauges used on the home page,
+// drawn as plain SVG so the dashboard does not need Raphael or JustGage.
+// Supports the options the dashboard uses: id, value, min, max,
+// gaugeWidthScale, gaugeColor, levelColors and levelColorsGradient.
+function JustGage(config) {
+    const svgNS = "http://www.w3.org/2000/svg";
+    const radius = 80;
+
+    this.config = config;
+    this.circumference = 2 * Math.PI * radius;
+
+    const svg = document.createElementNS(svgNS, "svg");
+    svg.setAttribute("viewBox", "0 0 200 200");
+    svg.setAttribute("width", "100%");
+    svg.setAttribute("height", "100%");
+
+    const strokeWidth = 80 * (config.gaugeWidthScale || 1);
+    const makeCircle = (color) => {
+        const circle = document.createElementNS(svgNS, "circle");
+        circle.setAttribute("cx", 100);
+        circle.setAttribute("cy", 100);
+        circle.setAttribute("r", radius);
+        circle.setAttribute("fill", "none");
+        circle.setAttribute("stroke", color);
+        circle.setAttribute("stroke-width", strokeWidth);
+        svg.appendChild(circle);
+        return circle;
+    };
+
+    // Track behind the level arc, a transparent gaugeColor still leaves a faint ring
+    const track = makeCircle(config.gaugeColor && config.gaugeColor !== "transparent" ? config.gaugeColor : "#edebeb");
+    track.setAttribute("opacity", config.gaugeColor === "transparent" ? 0.4 : 1);
+
+    this.level = makeCircle(config.levelColors[0]);
+    this.level.setAttribute("stroke-linecap", "round");
+    this.level.setAttribute("transform", "rotate(-90 100 100)");
+    this.level.style.transition = "stroke-dasharray 0.6s ease, stroke 0.6s ease";
+
+    this.text = document.createElementNS(svgNS, "text");
+    this.text.setAttribute("x", 100);
+    this.text.setAttribute("y", 100);
+    this.text.setAttribute("text-anchor", "middle");
+    this.text.setAttribute("dominant-baseline", "central");
+    this.text.setAttribute("font-size", 40);
+    this.text.setAttribute("font-weight", "bold");
+    this.text.setAttribute("fill", "#010101");
+    svg.appendChild(this.text);
+
+    document.getElementById(config.id).appendChild(svg);
+    this.refresh(config.value);
+}
+
+JustGage.prototype.refresh = function (value) {
+    const config = this.config;
+    const clamped = Math.min(Math.max(value, config.min), config.max);
+    const ratio = (clamped - config.min) / (config.max - config.min);
+
+    this.level.setAttribute("stroke-dasharray", `${ratio * this.circumference} ${this.circumference}`);
+    this.level.setAttribute("stroke", levelColor(config.levelColors, ratio, config.levelColorsGradient));
+    this.text.textContent = value;
+};
+
+function levelColor(colors, ratio, gradient) {
+    if (colors.length === 1) {
+        return colors[0];
+    }
+    const position = ratio * (colors.length - 1);
+    const index = Math.min(Math.floor(position), colors.length - 2);
+    if (!gradient) {
+        return colors[Math.round(position)];
+    }
+
+    // Blend the two neighbouring level colors
+    const from = parseInt(colors[index].slice(1), 16);
+    const to = parseInt(colors[index + 1].slice(1), 16);
+    const weight = position - index;
+    let result = 0;
+    for (let shift = 16; shift >= 0; shift -= 8) {
+        const a = (from >> shift) & 0xff;
+        const b = (to >> shift) & 0xff;
+        result |= Math.round(a + (b - a) * weight) << shift;
+    }
+    return "#" + result.toString(16).padStart(6, "0");
+}
@@ -40,6 +40,12 @@ function onMessage(event) {
     try {
         var data = JSON.parse(event.data);
         // Có thể thêm xử lý riêng nếu cần (ví dụ cập nhật trạng thái)
+        if (data.page === "events") {
+            renderEvents(data.value);
+        }
+        if (data.page === "profile") {
+            renderProfile(data.value);
+        }
     } catch (e) {
         console.warn("Không phải JSON hợp lệ:", event.data);
     }
@@ -156,6 +162,67 @@ function confirmDelete() {
 }
 
 
+// ==================== EVENT JOURNAL ====================
+function queryEvents() {
+    const from = document.getElementById('eventsFrom').value;
+    const to = document.getElementById('eventsTo').value;
+    const type = document.getElementById('eventsType').value;
+
+    const params = { limit: 50 };
+    if (from) params.from = Math.floor(new Date(from).getTime() / 1000);
+    if (to) params.to = Math.floor(new Date(to).getTime() / 1000);
+    if (type) params.types = [type];
+
+    Send_Data(JSON.stringify({ page: "events", value: params }));
+}
+function renderEvents(result) {
+    const body = document.getElementById('eventsBody');
+    body.innerHTML = "";
+    (result.events || []).forEach(e => {
+        // Events before the clock was synced only have the uptime
+        const time = e.uptime ? `+${e.t}s sau khởi động` : new Date(e.t * 1000).toLocaleString();
+        const row = document.createElement('tr');
+        row.innerHTML = `<td>${time}</td><td>${e.type}</td><td>${e.code}</td><td>${e.value.toFixed(2)}</td>`;
+        body.appendChild(row);
+    });
+    document.getElementById('eventsSummary').textContent =
+        `${result.matched || 0} sự kiện (hiển thị ${(result.events || []).length}), truy vấn ${result.query_us || 0} µs`;
+}
+
+
+// ==================== CPU PROFILER ====================
+let profileTimer = null;
+
+function startProfile() {
+    const hz = parseInt(document.getElementById('profileHz').value, 10);
+    const seconds = parseInt(document.getElementById('profileSeconds').value, 10);
+    Send_Data(JSON.stringify({ page: "profile", value: { action: "start", hz: hz, seconds: seconds } }));
+}
+function stopProfile() {
+    Send_Data(JSON.stringify({ page: "profile", value: { action: "stop" } }));
+}
+function renderProfile(status) {
+    const samples = (status.samples || []).reduce((a, b) => a + b, 0);
+    const dropped = (status.dropped || []).reduce((a, b) => a + b, 0);
+    const overhead = (status.overhead_pct || []).map(p => `${p}%`).join(" / ");
+    let text = status.running
+        ? `Đang lấy mẫu ${status.hz} Hz, ${Math.floor(status.elapsed_ms / 1000)}/${status.seconds} s`
+        : `Đã dừng sau ${(status.elapsed_ms / 1000).toFixed(1)} s`;
+    text += `, ${samples} mẫu, ${status.tasks} task, chi phí ${overhead}`;
+    // Beyond the ring the oldest samples are overwritten, the download only has the last ones
+    if (dropped > 0) text += `, bỏ ${dropped} mẫu cũ (giữ ${status.capacity}/core)`;
+    if (status.error) text += ` — lỗi: ${status.error}`;
+    document.getElementById('profileSummary').textContent = text;
+    document.getElementById('profileDownload').style.display = status.size ? 'inline-block' : 'none';
+
+    // Poll while it runs, the profile stops by itself
+    clearTimeout(profileTimer);
+    if (status.running) {
+        profileTimer = setTimeout(() => Send_Data(JSON.stringify({ page: "profile", value: { action: "status" } })), 1000);
+    }
+}
+
+
 // ==================== SETTINGS FORM (BỔ SUNG) ====================
 document.getElementById("settingsForm").addEventListener("submit", function (e) {
     e.preventDefault();
@@ -0,0 +1,81 @@
+#ifndef __ADMISSION_H__
+#define __ADMISSION_H__
+
+#include <Arduino.h>
+#include "global.h"
+
+/**
+ * @brief Admission control for inbound MQTT messages.
+ *
+ * admission_check() runs first in the MQTT callback and only looks at the
+ * topic and the length: messages on topics the device does not serve and
+ * RPC requests above the total message or byte rate are dropped before they
+ * are copied or parsed. Attribute messages (firmware announcements, attribute
+ * responses) have a bucket of their own, an RPC flood does not starve them.
+ * Per-method limits are applied by the RPC pool with the same token buckets
+ * once the method name is known.
+ *
+ * Everything runs on the network task, the counters are read by the same task.
+ */
+
+// Inbound RPC requests per second, and the burst allowed on top
+#ifndef ADMISSION_MAX_MESSAGES_PER_S
+#define ADMISSION_MAX_MESSAGES_PER_S 5
+#endif
+
+#ifndef ADMISSION_MESSAGE_BURST
+#define ADMISSION_MESSAGE_BURST 10
+#endif
+
+// Inbound RPC payload bytes per second, and the burst allowed on top
+#ifndef ADMISSION_MAX_BYTES_PER_S
+#define ADMISSION_MAX_BYTES_PER_S 1024
+#endif
+
+#ifndef ADMISSION_BYTE_BURST
+#define ADMISSION_BYTE_BURST 4096
+#endif
+
+// Inbound attribute messages per second, and the burst allowed on top
+#ifndef ADMISSION_MAX_ATTRIBUTES_PER_S
+#define ADMISSION_MAX_ATTRIBUTES_PER_S 1
+#endif
+
+#ifndef ADMISSION_ATTRIBUTE_BURST
+#define ADMISSION_ATTRIBUTE_BURST 4
+#endif
+
+typedef struct {
+    float tokens;
+    float rate;         // tokens added per second
+    float burst;        // most tokens held
+    uint32_t last;      // millis() of the last refill
+} TokenBucket_t;
+
+typedef struct {
+    uint32_t accepted;
+    uint32_t droppedTopic;      // topic not served by the device
+    uint32_t droppedRate;       // RPC above the total message rate
+    uint32_t droppedBytes;      // RPC above the total byte rate
+    uint32_t droppedAttributes; // attribute message above the attribute rate
+} AdmissionStats_t;
+
+/**
+ * @brief Starts a bucket full, so a burst is allowed right away.
+ */
+void bucket_init(TokenBucket_t *bucket, float rate, float burst);
+
+/**
+ * @brief Takes cost tokens if the bucket holds them.
+ */
+bool bucket_take(TokenBucket_t *bucket, float cost);
+
+/**
+ * @brief Decides on a message from its topic and length alone.
+ * @return false if the message has to be dropped without further processing
+ */
+bool admission_check(const char *topic, unsigned int length);
+
+AdmissionStats_t admission_get_stats();
+
+#endif
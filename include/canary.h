@@ -0,0 +1,179 @@
+#ifndef __CANARY_H__
+#define __CANARY_H__
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <ArduinoJson.h>
+#include "esp_ota_ops.h"
+#include "global.h"
+#include "snapshot.h"
+#include "stall_detector.h"
+
+/**
+ * @brief Post-update validation window with rollback on performance regressions.
+ *
+ * Every boot measures the first CANARY_WINDOW_MS (after CANARY_WARMUP_MS
+ * for the heap): loop times of the network and sensor tasks, the age of the
+ * oldest sample when a raw batch is published, the free heap trend and low
+ * mark, the least free stack of the tasks watched by the stall detector and
+ * the MQTT reconnects per hour.
+ *
+ * An image that passed its window is validated: its windows are blended into
+ * the baseline kept in NVS. The first boots of a new image (its ELF SHA-256
+ * differs from the validated one) are the canary: at the end of the window
+ * the metrics are checked against the baseline. On a violation, or when the
+ * image restarts CANARY_MAX_BOOTS times without finishing a window, the
+ * verdict is stored and the previous OTA partition is booted again. Either
+ * way the verdict with both metric sets is published by coreiot after the
+ * next connect, from whichever image runs then.
+ *
+ * Without a baseline (first install, erased NVS) the canary passes.
+ */
+
+#ifndef CANARY_WINDOW_MS
+#define CANARY_WINDOW_MS 1800000
+#endif
+
+// Heap samples start after the allocations at startup
+#ifndef CANARY_WARMUP_MS
+#define CANARY_WARMUP_MS 120000
+#endif
+
+#ifndef CANARY_SAMPLE_MS
+#define CANARY_SAMPLE_MS 60000
+#endif
+
+// Restarts of a canary image before it is rolled back without a verdict
+#ifndef CANARY_MAX_BOOTS
+#define CANARY_MAX_BOOTS 3
+#endif
+
+// Regression thresholds: value > baseline * factor + slack
+#ifndef CANARY_LOOP_FACTOR
+#define CANARY_LOOP_FACTOR 1.5f
+#endif
+
+#ifndef CANARY_LOOP_SLACK_MS
+#define CANARY_LOOP_SLACK_MS 5.0f
+#endif
+
+#ifndef CANARY_PUBLISH_FACTOR
+#define CANARY_PUBLISH_FACTOR 1.5f
+#endif
+
+#ifndef CANARY_PUBLISH_SLACK_MS
+#define CANARY_PUBLISH_SLACK_MS 2000.0f
+#endif
+
+#ifndef CANARY_RECONNECT_FACTOR
+#define CANARY_RECONNECT_FACTOR 2.0f
+#endif
+
+#ifndef CANARY_RECONNECT_SLACK
+#define CANARY_RECONNECT_SLACK 2.0f
+#endif
+
+// Heap lost per hour beyond the baseline trend that counts as a leak
+#ifndef CANARY_HEAP_LEAK_BPH
+#define CANARY_HEAP_LEAK_BPH 4096.0f
+#endif
+
+#ifndef CANARY_MIN_HEAP_SAMPLES
+#define CANARY_MIN_HEAP_SAMPLES 10
+#endif
+
+// Lowest free heap may be this much below the baseline
+#ifndef CANARY_HEAP_MARGIN
+#define CANARY_HEAP_MARGIN 16384
+#endif
+
+// Least free stack of any watched task below this, or below half the baseline
+#ifndef CANARY_STACK_MIN
+#define CANARY_STACK_MIN 256
+#endif
+
+#define CANARY_NAMESPACE "canary"
+
+typedef enum {
+    CANARY_NETWORK_LOOP_MS,     // one pass of the coreiot loop, without its sleep
+    CANARY_SENSOR_LOOP_MS,      // one read of the sensor task, without its sleep
+    CANARY_PUBLISH_AGE_MS,      // oldest sample of a published raw batch
+    CANARY_RECONNECT,           // one MQTT reconnect after a drop
+    CANARY_METRIC_COUNT
+} CanaryMetric_t;
+
+typedef enum {
+    CANARY_NONE = 0,            // no verdict yet
+    CANARY_PASS,
+    CANARY_ROLLBACK,
+    CANARY_BASELINE             // validated image, window blended into the baseline
+} CanaryVerdict_t;
+
+// Bits of CanaryReport_t.violations
+#define CANARY_VIOLATION_NETWORK_LOOP 0x01
+#define CANARY_VIOLATION_SENSOR_LOOP 0x02
+#define CANARY_VIOLATION_PUBLISH_AGE 0x04
+#define CANARY_VIOLATION_RECONNECTS 0x08
+#define CANARY_VIOLATION_HEAP_TREND 0x10
+#define CANARY_VIOLATION_HEAP_MIN 0x20
+#define CANARY_VIOLATION_STACK 0x40
+#define CANARY_VIOLATION_RESTARTS 0x80
+
+typedef struct {
+    float mean[CANARY_METRIC_COUNT - 1];    // per sample, CANARY_RECONNECT has none
+    float max[CANARY_METRIC_COUNT - 1];
+    uint32_t samples[CANARY_METRIC_COUNT - 1];
+    float reconnectsPerHour;
+    float heapSlope;                        // bytes per hour, negative while the heap shrinks
+    uint16_t heapSamples;                   // the trend is compared from CANARY_MIN_HEAP_SAMPLES on
+    uint32_t heapMin;                       // lowest free heap since boot
+    uint32_t stackMin;                      // least free stack of a watched task, bytes
+    uint32_t windowMs;
+} CanaryMetrics_t;
+
+typedef struct {
+    uint8_t verdict;                        // CanaryVerdict_t
+    uint8_t violations;
+    bool hasBaseline;
+    char version[32];                       // of the image judged
+    char sha[17];                           // first 16 hex digits of its ELF SHA-256
+    CanaryMetrics_t metrics;
+    CanaryMetrics_t baseline;
+} CanaryReport_t;
+
+/**
+ * @brief Identifies the running image and counts its boot. Rolls back right
+ *        away a canary that restarted CANARY_MAX_BOOTS times. Call once at
+ *        boot, after snapshot_begin().
+ */
+void canary_begin();
+
+/**
+ * @brief Adds a measurement to the window, a no-op once it is over.
+ */
+void canary_record(CanaryMetric_t metric, float value);
+
+/**
+ * @brief Samples heap and stacks and ends the window, created in main.cpp.
+ */
+void canary_task(void *pvParameters);
+
+/**
+ * @brief The last verdict that was not published yet.
+ */
+bool canary_take_report(CanaryReport_t *report);
+void canary_mark_reported();
+
+/**
+ * @brief A report as telemetry: canary_verdict, canary_violations and
+ *        canary_<metric> / canary_base_<metric> for every metric.
+ */
+String canary_report_json(const CanaryReport_t *report);
+
+/**
+ * @brief Compares a window with the baseline.
+ * @return CANARY_VIOLATION_* bits
+ */
+uint8_t canary_check(const CanaryMetrics_t *metrics, const CanaryMetrics_t *baseline);
+
+#endif
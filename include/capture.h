@@ -0,0 +1,118 @@
+#ifndef __CAPTURE_H__
+#define __CAPTURE_H__
+
+#include <Arduino.h>
+#include <time.h>
+#include "LittleFS.h"
+#include "global.h"
+#include "sample_history.h"
+#include "executor.h"
+
+/**
+ * @brief Pre-trigger capture of high-rate sensor samples around alarms.
+ *
+ * The sensor task hands every read (one per CAPTURE_PERIOD_MS, the regular
+ * pipeline only uses every few of them) to capture_add(), which keeps the
+ * last CAPTURE_PRE_SAMPLES in a RAM ring. capture_trigger(), e.g. on an
+ * anomaly or a WARNING / CRITICAL display state, freezes the ring and the
+ * next CAPTURE_POST_SAMPLES are appended to it. The finished capture is
+ * compressed by the sensor task and written to flash as one file by an
+ * executor job, where it waits for coreiot_task to upload it. At most
+ * CAPTURE_MAX_FILES are kept, the oldest is dropped first.
+ *
+ * The anomaly trigger is called by tiny_ml_task, which main.cpp does not
+ * start at the moment; WARNING / CRITICAL come from lcd_display_task.
+ *
+ * File format, little endian: CaptureHeader_t, then per sample the zigzag
+ * varint delta of the temperature and of the humidity to the previous sample
+ * (0.01 °C / 0.01 %, the first sample against 0). A failed read is stored as
+ * CAPTURE_MISSING for both. tools/decode_capture.py decodes a capture.
+ */
+
+// Read period of the sensor task. The DHT20 refuses a read within 1 s of the
+// end of the previous one (~80 ms conversion), and stays below 10 % duty
+// cycle, so it does not heat itself
+#ifndef CAPTURE_PERIOD_MS
+#define CAPTURE_PERIOD_MS 1250
+#endif
+
+// Samples kept before the trigger (2.5 min) and recorded after it (5 min)
+#ifndef CAPTURE_PRE_SAMPLES
+#define CAPTURE_PRE_SAMPLES 120
+#endif
+
+#ifndef CAPTURE_POST_SAMPLES
+#define CAPTURE_POST_SAMPLES 240
+#endif
+
+// Captures waiting for upload on flash
+#ifndef CAPTURE_MAX_FILES
+#define CAPTURE_MAX_FILES 8
+#endif
+
+#define CAPTURE_DIR "/capture"
+#define CAPTURE_FORMAT 1
+#define CAPTURE_MISSING (-32768)
+
+typedef enum {
+    CAPTURE_TRIGGER_ANOMALY = 1,    // value = anomaly score
+    CAPTURE_TRIGGER_WARNING,        // value = temperature
+    CAPTURE_TRIGGER_CRITICAL,       // value = temperature
+} CaptureTrigger_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t format;         // CAPTURE_FORMAT
+    uint8_t reason;         // CaptureTrigger_t
+    uint16_t periodMs;
+    uint32_t time;          // of the trigger, unix time or uptime seconds | HISTORY_TIME_UPTIME
+    uint16_t preSamples;    // samples before the trigger
+    uint16_t samples;       // all samples
+    float value;
+} CaptureHeader_t;
+
+// Largest capture file: header and two varints of at most 3 bytes per sample
+#define CAPTURE_MAX_FILE_SIZE (sizeof(CaptureHeader_t) + (CAPTURE_PRE_SAMPLES + CAPTURE_POST_SAMPLES) * 6)
+
+typedef struct {
+    uint32_t captured;      // captures written to flash
+    uint32_t ignored;       // triggers while a capture was recording
+    uint32_t dropped;       // stored captures dropped before their upload
+    uint32_t failed;        // finished captures that could not be written
+    uint32_t bytesWritten;  // compressed bytes written
+} CaptureStats_t;
+
+/**
+ * @brief Finds the captures left on flash. Call once at boot, after LittleFS is mounted.
+ */
+void capture_begin();
+
+/**
+ * @brief Adds one read, NAN if it failed. Called by the sensor task only.
+ */
+void capture_add(float temperature, float humidity);
+
+/**
+ * @brief Starts a capture with the next read, ignored while one is recording. Any task.
+ */
+void capture_trigger(CaptureTrigger_t reason, float value);
+
+/**
+ * @brief Captures on flash waiting for upload.
+ */
+uint32_t capture_pending();
+
+/**
+ * @brief Reads the oldest capture waiting for upload. A missing capture, or one
+ *        larger than size, is dropped so the ones behind it are not blocked.
+ * @param id Set to the id to pass to capture_remove() once it is uploaded
+ * @return Bytes read, 0 if there is none or it was dropped
+ */
+size_t capture_read_oldest(uint8_t *buffer, size_t size, uint32_t *id);
+
+void capture_remove(uint32_t id);
+
+const char *capture_reason_name(uint8_t reason);
+
+CaptureStats_t capture_get_stats();
+
+#endif
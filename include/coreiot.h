@@ -4,9 +4,93 @@
 #include <Arduino.h>
 #include <WiFi.h>
 #include "global.h"
+#include "event_journal.h"
+#include "scheduler.h"
+#include "snapshot.h"
+#include "tinyml.h"
+#include "dns_cache.h"
+#include "rpc_pool.h"
+#include "admission.h"
+#include "link_quality.h"
+#include "keepalive.h"
+#include "capture.h"
+#include "executor.h"
+#include "stall_detector.h"
+#include "canary.h"
+#include "peer_ota.h"
+#include "cpu_profile.h"
+#include "history_compaction.h"
 #include <PubSubClient.h>
+#include <ArduinoHttpClient.h>
+#include "lwip/sockets.h"
 #include <ArduinoJson.h>
 
+// Set CORE_IOT_USE_WEBSOCKET=1 in build_flags for collectors that only accept
+// WebSocket ingestion: MQTT runs over a WebSocket on CORE_IOT_PORT, every
+// packet write in a binary frame, subprotocol "mqtt"
+#ifndef CORE_IOT_USE_WEBSOCKET
+#define CORE_IOT_USE_WEBSOCKET 0
+#endif
+
+#ifndef CORE_IOT_WEBSOCKET_PATH
+#define CORE_IOT_WEBSOCKET_PATH "/mqtt"
+#endif
+
+// Length of a distribution telemetry window, p5/p50/p95/max of every sample
+// in the window are published once it ends
+#ifndef COREIOT_WINDOW_MS
+#define COREIOT_WINDOW_MS 300000
+#endif
+
+// Set to 0 to only publish the window summaries instead of every 10 s reading
+#ifndef COREIOT_RAW_TELEMETRY
+#define COREIOT_RAW_TELEMETRY 1
+#endif
+
+// Also publish the encoded sketches, so the server can merge windows
+#ifndef COREIOT_SKETCH_TELEMETRY
+#define COREIOT_SKETCH_TELEMETRY 1
+#endif
+
+// Connect with MQTT 5 (topic aliases, message expiry), brokers that only speak
+// 3.1.1 are connected to again with that
+#ifndef COREIOT_MQTT5
+#define COREIOT_MQTT5 1
+#endif
+
+// Seconds an undelivered telemetry message stays valid at the broker (MQTT 5)
+#ifndef COREIOT_TELEMETRY_EXPIRY_S
+#define COREIOT_TELEMETRY_EXPIRY_S 600
+#endif
+
+// Raw telemetry sample period, the samples are published in batches sized by
+// the link quality (LINK_MIN_BATCH .. LINK_MAX_BATCH). Publishing more often
+// than the keepalive interval leaves the NAT timeout search idle, see keepalive.h
+#ifndef COREIOT_PUBLISH_MS
+#define COREIOT_PUBLISH_MS 10000
+#endif
+
+// Longest the task sleeps between two MQTT loop() calls
+#ifndef COREIOT_LOOP_MS
+#define COREIOT_LOOP_MS 100
+#endif
+
+// Heartbeat deadline of the task, a reconnect retrying longer is reported as a stall
+#ifndef COREIOT_STALL_MS
+#define COREIOT_STALL_MS 120000
+#endif
+
+// Bound for the TCP handshake and for the SUBACKs of a reconnect
+#ifndef COREIOT_CONNECT_TIMEOUT_MS
+#define COREIOT_CONNECT_TIMEOUT_MS 5000
+#endif
+
+// Idle seconds before TCP keepalive probes start (5 s apart, 3 probes), raised
+// to the MQTT keep alive so they do not add wake-ups between the pings
+#ifndef COREIOT_TCP_KEEPALIVE_S
+#define COREIOT_TCP_KEEPALIVE_S 30
+#endif
+
 
 void coreiot_task(void *pvParameters);
 
@@ -0,0 +1,164 @@
+#ifndef __CPU_PROFILE_H__
+#define __CPU_PROFILE_H__
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <ESPAsyncWebServer.h>
+#include <ArduinoJson.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_heap_caps.h"
+#include "global.h"
+
+/**
+ * @brief Statistical sampling CPU profiler, per core, for whatever runs in
+ *        production: which functions of a task take its time.
+ *
+ * While a profile runs, a hardware timer per core interrupts it hz times a
+ * second. The handler takes the PC and up to CPU_PROFILE_DEPTH - 1 callers of
+ * the task it interrupted, from the context the FreeRTOS port saved on the
+ * interrupt, and writes them with the task to the ring of that core. The
+ * rings keep the last hz * seconds samples, at most CPU_PROFILE_MAX_SAMPLES
+ * per core: a longer or faster profile overwrites its oldest samples, the
+ * status counts them as dropped. The profile stops by itself after seconds.
+ * Interrupts of an interrupt handler are counted as nested, without a stack.
+ *
+ * Nothing is allocated and no timer runs while no profile was started, a
+ * profile keeps its rings until the next one starts. Started and stopped by
+ * the startProfile / stopProfile RPCs or the web UI, a stopped profile is
+ * downloaded from CPU_PROFILE_PATH:
+ *
+ *   python tools/profile_flamegraph.py profile.bin .pio/build/yolo_uno/firmware.elf > profile.folded
+ *   flamegraph.pl profile.folded > profile.svg
+ *
+ * Format, little endian: a CpuProfileHeader_t, tasks names of
+ * CPU_PROFILE_NAME_LEN bytes, then samples CpuProfileSample_t of every core
+ * in the order they were taken, core 0 first.
+ */
+
+#ifndef CPU_PROFILE_DEFAULT_HZ
+#define CPU_PROFILE_DEFAULT_HZ 97        // prime, does not beat with the 1 kHz tick
+#endif
+
+#ifndef CPU_PROFILE_DEFAULT_SECONDS
+#define CPU_PROFILE_DEFAULT_SECONDS 10
+#endif
+
+#ifndef CPU_PROFILE_MAX_HZ
+#define CPU_PROFILE_MAX_HZ 4999
+#endif
+
+// Ring of each core, 4 + 4 * CPU_PROFILE_DEPTH bytes a sample: 28 KB of
+// internal RAM per core with the defaults
+#ifndef CPU_PROFILE_MAX_SAMPLES
+#define CPU_PROFILE_MAX_SAMPLES 1024
+#endif
+
+// PC and callers recorded per sample
+#ifndef CPU_PROFILE_DEPTH
+#define CPU_PROFILE_DEPTH 6
+#endif
+
+// Hardware timer of core 0, core 1 uses the next one
+#ifndef CPU_PROFILE_TIMER
+#define CPU_PROFILE_TIMER 2
+#endif
+
+#ifndef CPU_PROFILE_MAX_TASKS
+#define CPU_PROFILE_MAX_TASKS 32
+#endif
+
+#if CPU_PROFILE_DEFAULT_HZ * CPU_PROFILE_DEFAULT_SECONDS > CPU_PROFILE_MAX_SAMPLES
+#error "The default profile does not fit CPU_PROFILE_MAX_SAMPLES"
+#endif
+
+#define CPU_PROFILE_PATH "/profile"
+#define CPU_PROFILE_FORMAT 1
+#define CPU_PROFILE_NAME_LEN 16
+
+// Bits of CpuProfileSample_t.core above the core number
+#define CPU_PROFILE_SAMPLE_NESTED 0x80  // interrupted an interrupt handler, no stack
+// CpuProfileSample_t.task once the task table is full
+#define CPU_PROFILE_TASK_UNKNOWN 0xFF
+
+typedef struct __attribute__((packed)) {
+    char magic[4];              // "CPRF"
+    uint8_t format;             // CPU_PROFILE_FORMAT
+    uint8_t cores;
+    uint8_t depth;              // CPU_PROFILE_DEPTH, pc entries of every sample
+    uint8_t tasks;              // names following the header
+    uint16_t hz;
+    uint16_t nameLen;           // CPU_PROFILE_NAME_LEN
+    uint32_t durationMs;        // sampled
+    uint32_t samples;           // following the names
+} CpuProfileHeader_t;
+
+typedef struct {
+    uint8_t core;               // | CPU_PROFILE_SAMPLE_NESTED
+    uint8_t task;               // index in the task names
+    uint8_t depth;              // valid pc entries, the rest is 0
+    uint8_t reserved;
+    uint32_t pc[CPU_PROFILE_DEPTH]; // interrupted PC first, then the call sites of its callers
+} CpuProfileSample_t;
+
+typedef struct {
+    bool running;
+    uint16_t hz;
+    uint32_t durationMs;        // requested
+    uint32_t elapsedMs;         // sampled so far
+    uint32_t capacity;          // ring of each core, samples
+    uint32_t taken[portNUM_PROCESSORS];
+    uint32_t dropped[portNUM_PROCESSORS];   // overwritten by later samples, not in the download
+    uint32_t nested[portNUM_PROCESSORS];
+    uint32_t handlerUs[portNUM_PROCESSORS]; // time spent in the sampling handler
+    uint8_t tasks;
+    uint32_t generation;        // profiles started since boot
+} CpuProfileStatus_t;
+
+/**
+ * @brief Starts a profile, replacing the last one.
+ * @return NULL, or why it did not start: one is running or being
+ *         downloaded, bad parameters, not enough memory. A timer that
+ *         cannot be set up is reported by the status.
+ */
+const char *cpu_profile_start(uint16_t hz, uint32_t seconds);
+
+/**
+ * @brief Stops the running profile early, it stays downloadable.
+ */
+void cpu_profile_stop();
+
+CpuProfileStatus_t cpu_profile_get_status();
+
+/**
+ * @brief Size of the downloadable profile, 0 while one runs or none was taken.
+ * @param generation Receives the profile, for cpu_profile_read()
+ */
+size_t cpu_profile_size(uint32_t *generation);
+
+/**
+ * @brief Copies bytes of the downloadable profile.
+ * @param generation The profile the download started on
+ * @return Bytes copied, 0 at the end or if the profile changed meanwhile
+ */
+size_t cpu_profile_read(uint32_t generation, size_t offset, uint8_t *buffer, size_t length);
+
+/**
+ * @brief For the RPCs and the web UI: params {"hz":97,"seconds":10}, both
+ *        optional. Returns the status, with "error" if it did not start.
+ */
+String cpu_profile_start_json(JsonVariantConst params);
+String cpu_profile_stop_json();
+
+/**
+ * @brief Status, overhead and the download URL once the profile stopped.
+ */
+String cpu_profile_status_json();
+
+/**
+ * @brief Serves the stopped profile on CPU_PROFILE_PATH.
+ */
+void cpu_profile_register(AsyncWebServer &server);
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef __DASHBOARD_BUNDLE_H__
+#define __DASHBOARD_BUNDLE_H__
+
+#include <Arduino.h>
+
+// Generated by tools/build_dashboard.py from data/, do not edit.
+// Gzipped, single file dashboard, serve with Content-Encoding: gzip.
+// Bundle sha256: 68d1bc6c75cc25015805dd8a5ecb787d311e61eef236866aef4321b00a4e58a2
+extern const uint8_t DASHBOARD_HTML[26332];
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef __DNS_CACHE_H__
+#define __DNS_CACHE_H__
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <Preferences.h>
+#include "global.h"
+
+/**
+ * @brief Cache of resolved host names in RAM and NVS.
+ *
+ * A reconnect after a WiFi blip reuses the address resolved before instead of
+ * asking the DNS server again. Entries are fresh for DNS_CACHE_TTL_S after
+ * they were resolved (lwIP does not expose the record TTL). Entries loaded
+ * from NVS at boot have an unknown age: they are used right away and replaced
+ * by a fresh lookup once connecting to them fails, see dns_cache_invalidate().
+ * IP literals never reach the cache.
+ */
+
+#ifndef DNS_CACHE_TTL_S
+#define DNS_CACHE_TTL_S 3600
+#endif
+
+#ifndef DNS_CACHE_ENTRIES
+#define DNS_CACHE_ENTRIES 4
+#endif
+
+#define DNS_CACHE_HOST_LEN 48
+
+/**
+ * @brief Loads the entries saved in NVS. Call once at boot.
+ */
+void dns_cache_begin();
+
+/**
+ * @brief Resolves host, from the cache when it holds a fresh entry.
+ * @param cached Set to true when no DNS query was needed, may be NULL
+ * @return false if the host could not be resolved
+ */
+bool dns_cache_resolve(const char *host, IPAddress &ip, bool *cached);
+
+/**
+ * @brief Drops the entry of host, e.g. after connecting to its address failed,
+ *        so the next dns_cache_resolve() queries the DNS server again.
+ */
+void dns_cache_invalidate(const char *host);
+
+#endif
@@ -0,0 +1,137 @@
+#ifndef __EVENT_JOURNAL_H__
+#define __EVENT_JOURNAL_H__
+
+#include <Arduino.h>
+#include <time.h>
+#include "global.h"
+#include "storage.h"
+#include <ArduinoJson.h>
+
+/**
+ * @brief Append-only journal of typed, fixed-size event records on LittleFS.
+ *
+ * Records are grouped in blocks of JOURNAL_RECORDS_PER_BLOCK. Every completed
+ * block gets one index entry (time range + bitmap of the event types it
+ * contains), which is appended to a small index file and kept in RAM.
+ * A query only reads the blocks whose time range overlaps the requested one
+ * and whose type bitmap matches, a month of events is a few hundred index
+ * entries. The journal keeps two segments: once the current one is full it
+ * replaces the previous one, so storage is bounded.
+ */
+
+#ifndef JOURNAL_RECORDS_PER_BLOCK
+#define JOURNAL_RECORDS_PER_BLOCK 128
+#endif
+
+// Blocks per segment, two segments are kept (128 blocks = 16384 records = 192 KB)
+#ifndef JOURNAL_MAX_BLOCKS
+#define JOURNAL_MAX_BLOCKS 128
+#endif
+
+// Most records a single journal_query_json() returns
+#ifndef JOURNAL_MAX_QUERY_EVENTS
+#define JOURNAL_MAX_QUERY_EVENTS 50
+#endif
+
+// Set JOURNAL_BENCHMARK=1 in build_flags to run journal_benchmark() once at boot
+#ifndef JOURNAL_BENCHMARK
+#define JOURNAL_BENCHMARK 0
+#endif
+
+typedef enum {
+    EVENT_BOOT = 0,             // code = reset reason
+    EVENT_LCD_STATE_CHANGE,     // code = new DisplayState_t, value = temperature
+    EVENT_ANOMALY,              // value = anomaly score
+    EVENT_MQTT_DISCONNECT,      // code = PubSubClient state()
+    EVENT_MQTT_CONNECT,
+    EVENT_SENSOR_FAILURE,
+    EVENT_SCHEDULE,             // code = calendar entry id, value = action param
+    EVENT_STALL,                // code = StallRecovery_t, value = seconds without heartbeat
+    EVENT_TYPE_COUNT
+} EventType_t;
+
+#define EVENT_TYPE_ALL ((1UL << EVENT_TYPE_COUNT) - 1)
+
+// Query flag: match the records with EVENT_FLAG_UPTIME (from/to are then
+// uptime seconds) instead of the unix time ones
+#define EVENT_QUERY_UPTIME (1UL << 31)
+
+// Index entries keep the types of uptime records in their own bits
+#define JOURNAL_UPTIME_TYPE_SHIFT 16
+
+// Record time is seconds since boot, the wall clock was not synced yet
+#define EVENT_FLAG_UPTIME 0x01
+
+typedef struct __attribute__((packed)) {
+    uint32_t time;      // unix time, or uptime seconds with EVENT_FLAG_UPTIME
+    uint8_t type;       // EventType_t
+    uint8_t flags;
+    int16_t code;
+    float value;
+} EventRecord_t;
+
+typedef struct {
+    uint32_t minTime;   // unix time range of the block, uptime records are left out
+    uint32_t maxTime;   // (minTime > maxTime if the block only has uptime records)
+    uint32_t typeMask;  // bit per EventType_t present in the block, uptime records' << JOURNAL_UPTIME_TYPE_SHIFT
+} JournalIndexEntry_t;
+
+typedef struct {
+    JournalIndexEntry_t index[JOURNAL_MAX_BLOCKS];
+    uint32_t records;   // records in the segment, the last block may be partial
+} JournalSegment_t;
+
+typedef struct {
+    char name[16];              // files are /<name>.dat, /<name>.idx, /<name>.old, /<name>.oix
+    StorageHandle_t data;
+    StorageHandle_t indexFile;
+    JournalSegment_t current;
+    JournalSegment_t previous;
+    SemaphoreHandle_t mutex;
+} EventJournal_t;
+
+extern EventJournal_t eventJournal;
+
+/**
+ * @brief Opens (or creates) the journal, loads the index and rebuilds it from
+ *        the records if it is missing or out of date. LittleFS must be mounted.
+ */
+bool journal_begin(EventJournal_t *journal, const char *name);
+bool journal_append(EventJournal_t *journal, EventType_t type, int16_t code, float value);
+
+/**
+ * @brief Finds the records with from <= time <= to whose type is in typeMask,
+ *        oldest first. Records timed before SNTP only match with EVENT_QUERY_UPTIME.
+ * @param out Receives at most maxOut records, may be NULL to only count
+ * @return Number of matching records, can be larger than maxOut
+ */
+size_t journal_query(EventJournal_t *journal, uint32_t from, uint32_t to, uint32_t typeMask,
+                     EventRecord_t *out, size_t maxOut);
+
+const char *journal_type_name(uint8_t type);
+
+/**
+ * @brief Parses a type name as returned by journal_type_name(), -1 if unknown.
+ */
+int journal_type_from_name(const char *name);
+
+/**
+ * @brief Queries the global journal with JSON params, used by the "getEvents"
+ *        RPC and the web UI: {"from":<unix s>,"to":<unix s>,"types":["ANOMALY",...],"limit":20}
+ *        Every param is optional, the defaults match everything timed in unix time.
+ *        "uptime":true queries the records from before SNTP, from/to in uptime seconds.
+ * @return {"matched":<n>,"query_us":<us>,"events":[{"t":..,"type":"..","code":..,"value":..},...]}
+ */
+String journal_query_json(JsonVariantConst params);
+
+/**
+ * @brief Logs an event into the global journal, e.g. journal_log(EVENT_ANOMALY, 0, score).
+ */
+void journal_log(EventType_t type, int16_t code = 0, float value = 0.0f);
+
+/**
+ * @brief Measures append and query latency on a scratch journal.
+ */
+void journal_benchmark();
+
+#endif
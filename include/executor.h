@@ -0,0 +1,127 @@
+#ifndef __EXECUTOR_H__
+#define __EXECUTOR_H__
+
+#include <Arduino.h>
+#include <atomic>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+
+/**
+ * @brief Deferred-work executor, one worker task pinned to each core.
+ *
+ * Work that must not run in its caller's context (a callback of the network
+ * stack, a flash write, a relay sequence) is submitted as a short job instead
+ * of getting a task of its own or blocking the caller.
+ *
+ * Every worker has, per priority, an inbox and a deque. A job submitted by any
+ * other task goes to the inbox of the worker on the submitting core (a bounded
+ * lock-free MPMC ring); a job submitted by a job goes to the bottom of its
+ * worker's own deque (Chase-Lev). A worker runs its own work first, the newest
+ * of its deque before its inbox, and steals from the other workers when it is
+ * out of work: the oldest of their deques and their inboxes. An idle worker
+ * sleeps on its task notification; a submission wakes the target worker if it
+ * sleeps, or another sleeping worker to steal the job if the target is busy.
+ *
+ * EXECUTOR_PRIORITY_HIGH jobs of every worker run before any NORMAL job.
+ * Nothing on the submit and run paths takes a lock; only a sleeping worker is
+ * woken through FreeRTOS.
+ *
+ * Jobs must be short and must not block for long, they hold up every job
+ * queued behind them. Completion is reported by an optional callback, run on
+ * the worker right after the job, and / or an ExecutorFuture_t to wait on.
+ */
+
+#ifndef EXECUTOR_WORKERS
+#define EXECUTOR_WORKERS portNUM_PROCESSORS
+#endif
+
+// Jobs queued or running at once, a power of two up to 256
+#ifndef EXECUTOR_MAX_JOBS
+#define EXECUTOR_MAX_JOBS 32
+#endif
+
+#ifndef EXECUTOR_TASK_PRIORITY
+#define EXECUTOR_TASK_PRIORITY 2
+#endif
+
+// Set EXECUTOR_BENCHMARK=1 in build_flags to run executor_benchmark() once at boot
+#ifndef EXECUTOR_BENCHMARK
+#define EXECUTOR_BENCHMARK 0
+#endif
+
+typedef enum {
+    EXECUTOR_PRIORITY_HIGH = 0,
+    EXECUTOR_PRIORITY_NORMAL,
+    EXECUTOR_PRIORITY_COUNT
+} ExecutorPriority_t;
+
+typedef void (*ExecutorJob_t)(void *arg);
+
+/**
+ * @brief Completion of a job, owned by the submitter. Initialise it once with
+ *        executor_future_init() and keep it alive until the job completed; it
+ *        can be submitted again after executor_wait() returned true.
+ */
+typedef struct {
+    SemaphoreHandle_t done;
+    StaticSemaphore_t buffer;
+    int64_t submittedUs;
+    int64_t startedUs;
+    int64_t finishedUs;
+} ExecutorFuture_t;
+
+typedef struct {
+    uint32_t executed;
+    uint32_t stolen;            // jobs taken from another worker
+    uint32_t maxLatencyUs;      // submission to start
+    uint64_t totalLatencyUs;
+    uint64_t busyUs;
+} ExecutorWorkerStats_t;
+
+typedef struct {
+    uint32_t submitted;
+    uint32_t rejected;          // all EXECUTOR_MAX_JOBS in use
+    ExecutorWorkerStats_t workers[EXECUTOR_WORKERS];
+} ExecutorStats_t;
+
+/**
+ * @brief Prepares the job pool and the queues. Call once at boot, before the
+ *        workers are created and before anything is submitted.
+ */
+void executor_begin();
+
+/**
+ * @brief Worker loop, created in main.cpp once per worker with its index
+ *        (0 .. EXECUTOR_WORKERS - 1) as the parameter.
+ */
+void executor_worker_task(void *pvParameters);
+
+/**
+ * @brief Queues a job. May be called from any task, it only waits a tick in
+ *        the rare case that a preempted task holds the inbox cell it needs.
+ * @param done Optional, runs on the worker after the job with the same arg
+ * @param future Optional, completed after done
+ * @return false if all EXECUTOR_MAX_JOBS are in use, nothing is run then
+ */
+bool executor_submit(ExecutorJob_t job, void *arg, ExecutorPriority_t priority = EXECUTOR_PRIORITY_NORMAL,
+                     ExecutorJob_t done = NULL, ExecutorFuture_t *future = NULL);
+
+void executor_future_init(ExecutorFuture_t *future);
+
+/**
+ * @brief Waits for a submitted job. Must not be called from a job.
+ * @return false if the job did not complete within ticks
+ */
+bool executor_wait(ExecutorFuture_t *future, TickType_t ticks);
+
+ExecutorStats_t executor_get_stats();
+
+/**
+ * @brief Prints the cost of a submission, the latency to the start of a job
+ *        on an idle worker and the speed-up of a batch of CPU bound jobs.
+ */
+void executor_benchmark();
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef __FLASH_BUDGET_H__
+#define __FLASH_BUDGET_H__
+
+#include <Arduino.h>
+#include "LittleFS.h"
+#include "storage.h"
+
+/**
+ * @brief Worst case LittleFS footprint of the on-device stores, checked
+ *        against the partition at boot.
+ *
+ * Every store is bounded by its compile time limits: the raw history and
+ * its scores, the event journal, the minute and hour tiers, the captures,
+ * the snapshot and the schedule table. Each file is counted in whole
+ * STORAGE_BLOCK_SIZE blocks, a store that rewrites through a temporary file
+ * counts it too. Raising one of the limits past what the partition holds
+ * fails flash_budget_check() on the next boot instead of failing appends
+ * once the stores have filled up, months later.
+ */
+
+// Left for the files outside the stores: the data/ folder uploaded with the
+// filesystem image (58 KB), info.dat, and the spare blocks LittleFS needs to
+// relocate metadata and copy blocks on write
+#ifndef FLASH_BUDGET_RESERVE_BYTES
+#define FLASH_BUDGET_RESERVE_BYTES (128 * 1024)
+#endif
+
+/**
+ * @brief Bytes the stores take once every one of them is full.
+ */
+size_t flash_budget_bytes();
+
+/**
+ * @brief Logs the budget and compares the stores plus
+ *        FLASH_BUDGET_RESERVE_BYTES with LittleFS.totalBytes(). Call after
+ *        LittleFS is mounted.
+ * @return false if the partition is too small for them
+ */
+bool flash_budget_check();
+
+#endif
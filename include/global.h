@@ -6,6 +6,8 @@
 #include "freertos/task.h"
 #include "freertos/semphr.h"
 #include "freertos/queue.h"
+#include "quantile_sketch.h"
+#include "lock_profile.h"
 
 extern float glob_temperature;
 extern float glob_humidity;
@@ -47,4 +49,41 @@ typedef enum {
 
 extern DisplayState_t currentDisplayState;
 
+// Distribution telemetry: sketches of every sample of the current reporting
+// window, filled by temp_humi_monitor and drained by coreiot_task
+extern QuantileSketch_t tempWindowSketch;
+extern QuantileSketch_t humiWindowSketch;
+extern SemaphoreHandle_t xSketchMutex;
+
+// Guards the buffers of the write-coalescing storage layer
+extern SemaphoreHandle_t xStorageMutex;
+
+// Guards the scheduler's timer wheel and calendar entries, recursive so
+// timer actions may start or cancel timers
+extern SemaphoreHandle_t xSchedulerMutex;
+
+// Guards the warm-restart snapshot registry and image
+extern SemaphoreHandle_t xSnapshotMutex;
+
+// Guards the sample history segments and their score series
+extern SemaphoreHandle_t xHistoryMutex;
+
+// Guards the minute and hour aggregate segments of the history
+extern SemaphoreHandle_t xCompactionMutex;
+
+// Guards the DNS cache entries
+extern SemaphoreHandle_t xDnsCacheMutex;
+
+// RPC worker pool: requests for the workers, responses for the network task,
+// and the mutex guarding the method table and counters
+extern QueueHandle_t xRpcRequestQueue;
+extern QueueHandle_t xRpcResponseQueue;
+extern SemaphoreHandle_t xRpcMutex;
+
+// Guards the capture triggers and the captures waiting for upload
+extern SemaphoreHandle_t xCaptureMutex;
+
+// Guards the I2C bus shared by the DHT20 and the LCD
+extern SemaphoreHandle_t xI2CMutex;
+
 #endif
\ No newline at end of file
@@ -0,0 +1,116 @@
+#ifndef __HISTORY_COMPACTION_H__
+#define __HISTORY_COMPACTION_H__
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "LittleFS.h"
+#include "global.h"
+#include "sample_history.h"
+
+/**
+ * @brief Age based compaction of the sample history into minute and hour
+ *        aggregates, so flash holds up to a year of history at a fixed size.
+ *
+ * Three tiers, each a pair of segments like the raw history:
+ *  - raw samples (sample_history), 45 .. 90 h at one sample per 5 s
+ *  - min / max / mean per minute, HISTORY_MINUTE_SEGMENT_RECORDS per segment
+ *  - min / max / mean per hour, HISTORY_HOUR_SEGMENT_RECORDS per segment
+ *
+ * A tier is compacted into the next coarser one once it is aged, i.e. once
+ * it sits in the previous segment that the next rotation drops. The
+ * compaction task works through it in passes of at most
+ * HISTORY_COMPACT_BATCH records read, so it never holds the flash for long.
+ * Samples without a unix time cannot be placed in a minute and are skipped.
+ *
+ * Where to resume is derived from the newest aggregate written, so nothing
+ * but the aggregates themselves is stored. After a reset the minute or hour
+ * that was still open is rebuilt from its source records.
+ *
+ * history_query() reads a time range, each stretch from the finest tier that
+ * still holds it.
+ */
+
+// 2880 minutes = 2 days per segment, 58 KB. Both tiers share the partition
+// with the raw history and the journal, see flash_budget.h
+#ifndef HISTORY_MINUTE_SEGMENT_RECORDS
+#define HISTORY_MINUTE_SEGMENT_RECORDS 2880
+#endif
+
+// 4380 hours = half a year per segment, 88 KB
+#ifndef HISTORY_HOUR_SEGMENT_RECORDS
+#define HISTORY_HOUR_SEGMENT_RECORDS 4380
+#endif
+
+// Source records read per compaction pass
+#ifndef HISTORY_COMPACT_BATCH
+#define HISTORY_COMPACT_BATCH 128
+#endif
+
+// Pause between two passes of the compaction task
+#ifndef HISTORY_COMPACT_INTERVAL_MS
+#define HISTORY_COMPACT_INTERVAL_MS 1000
+#endif
+
+// Most records a single history_query_json() returns
+#ifndef HISTORY_MAX_QUERY_RECORDS
+#define HISTORY_MAX_QUERY_RECORDS 100
+#endif
+
+typedef struct __attribute__((packed)) {
+    uint32_t time;              // unix time, start of the interval
+    uint16_t seconds;           // length of the interval, 0 for a raw sample
+    uint16_t count;             // raw samples in the interval
+    int16_t temperatureMin;     // 0.01 °C
+    int16_t temperatureMax;
+    int16_t temperatureMean;
+    uint16_t humidityMin;       // 0.01 %
+    uint16_t humidityMax;
+    uint16_t humidityMean;
+} HistoryAggregate_t;
+
+typedef struct {
+    uint32_t passes;            // passes that read or wrote anything
+    uint32_t recordsRead;       // source records
+    uint32_t recordsWritten;    // aggregates
+    uint32_t bytesRead;
+    uint32_t bytesWritten;
+    uint32_t skipped;           // raw samples without a unix time
+    uint32_t lost;              // source records dropped by a rotation before they were compacted
+} HistoryCompactionStats_t;
+
+/**
+ * @brief Finds the aggregate segments and where compaction resumes. Call once
+ *        at boot, after history_begin().
+ */
+void history_compaction_begin();
+
+/**
+ * @brief Runs one bounded pass over each tier.
+ * @return true if there is more to compact right away
+ */
+bool history_compact();
+
+/**
+ * @brief Low priority background compaction, created in main.cpp.
+ */
+void history_compaction_task(void *pvParameters);
+
+/**
+ * @brief Reads the history from a unix time on, oldest first, each stretch at
+ *        the finest resolution still stored. Raw samples come back as records
+ *        of 0 seconds and a count of 1. An interval still being compacted comes
+ *        back with the seconds its records cover so far.
+ * @return Records read, continue from the end of the last one for more
+ */
+size_t history_query(uint32_t from, uint32_t to, HistoryAggregate_t *records, size_t max);
+
+/**
+ * @brief Queries with JSON params, used by the "getHistory" RPC:
+ *        {"from":<unix s>,"to":<unix s>,"limit":50}, every param is optional.
+ * @return {"query_us":<us>,"records":[{"t":..,"s":..,"n":..,"t_min":..,"t_max":..,"t_mean":..,"h_min":..,"h_max":..,"h_mean":..},...]}
+ */
+String history_query_json(JsonVariantConst params);
+
+HistoryCompactionStats_t history_compaction_get_stats();
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef __KEEPALIVE_H__
+#define __KEEPALIVE_H__
+
+#include <Arduino.h>
+#include <Preferences.h>
+
+/**
+ * @brief Adaptive MQTT keepalive, finds how long the network path (NAT,
+ *        firewall) keeps an idle connection open.
+ *
+ * The device pings a little before the longest idle time confirmed to be
+ * safe. After KEEPALIVE_CONFIRMATIONS answered pings it probes a longer one:
+ * twice the safe value while no limit is known, then halfway to the shortest
+ * interval known to fail, until the two are KEEPALIVE_RESOLUTION_S apart. An
+ * answered probe becomes the safe value. A connection lost during a probe
+ * makes the probe the known limit. A connection lost at the safe value halves
+ * it at once. Drops while WiFi is down are not counted. Every
+ * KEEPALIVE_REVALIDATE_S the known limit is probed once more, so a path that
+ * got more tolerant is used again.
+ *
+ * Only idle time is probed: any publish or PUBACK resets the idle timer, so
+ * while raw telemetry goes out more often than the operating interval (every
+ * COREIOT_PUBLISH_MS, 10 s, by default) no ping is sent and nothing is
+ * learned. The search runs when the device is quieter than that, e.g. with
+ * COREIOT_RAW_TELEMETRY 0 and only the window summaries, and the telemetry
+ * keeps the NAT mapping alive otherwise.
+ *
+ * Both values are kept in NVS per WiFi network. Everything runs on the network task.
+ */
+
+// Ping interval bounds in seconds, the minimum is the fixed keepalive used before
+#ifndef KEEPALIVE_MIN_S
+#define KEEPALIVE_MIN_S 15
+#endif
+
+#ifndef KEEPALIVE_MAX_S
+#define KEEPALIVE_MAX_S 1200
+#endif
+
+// Search stops once the safe and the failing interval are this close
+#ifndef KEEPALIVE_RESOLUTION_S
+#define KEEPALIVE_RESOLUTION_S 30
+#endif
+
+// Pings are sent this much below the safe interval, NAT timers are not exact
+#ifndef KEEPALIVE_MARGIN_PCT
+#define KEEPALIVE_MARGIN_PCT 10
+#endif
+
+// Answered pings at the operating interval before the next probe
+#ifndef KEEPALIVE_CONFIRMATIONS
+#define KEEPALIVE_CONFIRMATIONS 2
+#endif
+
+#ifndef KEEPALIVE_REVALIDATE_S
+#define KEEPALIVE_REVALIDATE_S 604800
+#endif
+
+typedef struct {
+    uint16_t interval;  // current ping interval
+    uint16_t safe;      // longest idle confirmed
+    uint16_t limit;     // shortest idle known to fail, 0 if none
+    uint32_t probes;
+    uint32_t failedProbes;
+    uint32_t drops;     // unexplained drops at the safe interval
+} KeepaliveStats_t;
+
+/**
+ * @brief Keep alive to request in CONNECT, long enough for the next probe.
+ * @param network Name of the WiFi network, the values learned are kept per network
+ */
+uint16_t keepalive_connect_value(const char *network);
+
+/**
+ * @brief Called once connected.
+ * @param negotiated Keep alive of the connection, the broker may have lowered it
+ * @return Ping interval to use
+ */
+uint16_t keepalive_on_connect(uint16_t negotiated);
+
+/**
+ * @brief Called for every answered PINGREQ.
+ * @param idleMs Time without traffic before the ping was sent
+ * @return Ping interval to use from now on
+ */
+uint16_t keepalive_on_ping(uint32_t idleMs);
+
+/**
+ * @brief Called when the connection was lost.
+ * @param explained true if WiFi went down, the network path is not to blame then
+ */
+void keepalive_on_drop(bool explained);
+
+KeepaliveStats_t keepalive_get_stats();
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef __LINK_QUALITY_H__
+#define __LINK_QUALITY_H__
+
+#include <Arduino.h>
+
+/**
+ * @brief Link quality estimate and the publish cadence derived from it.
+ *
+ * The network task feeds in WiFi RSSI, how long each publish blocked in the
+ * socket (a full send buffer means TCP is retransmitting or the link is slow),
+ * the PUBACK / PINGRESP round trip and whether the publish succeeded. Each is
+ * smoothed and mapped to 0 (bad) .. 1 (good) between its LINK_*_GOOD and
+ * LINK_*_BAD bounds, the weakest one is the link quality.
+ *
+ * The controller turns the quality into a batch size: samples are collected
+ * every COREIOT_PUBLISH_MS and published once the batch is full, so a weak
+ * link sends fewer, bigger publishes and a strong one sends every sample at
+ * once. The batch grows as soon as the link gets worse and shrinks by at most
+ * half per publish, so one good publish does not bring back the small ones.
+ *
+ * Everything runs on the network task.
+ */
+
+// Bounds of the batch size, LINK_MIN_BATCH samples per publish on a good link
+#ifndef LINK_MIN_BATCH
+#define LINK_MIN_BATCH 1
+#endif
+
+#ifndef LINK_MAX_BATCH
+#define LINK_MAX_BATCH 12
+#endif
+
+// RSSI in dBm scored as good and as bad
+#ifndef LINK_RSSI_GOOD
+#define LINK_RSSI_GOOD -65
+#endif
+
+#ifndef LINK_RSSI_BAD
+#define LINK_RSSI_BAD -85
+#endif
+
+// Time a publish blocks in the socket, in ms
+#ifndef LINK_SEND_GOOD_MS
+#define LINK_SEND_GOOD_MS 20
+#endif
+
+#ifndef LINK_SEND_BAD_MS
+#define LINK_SEND_BAD_MS 500
+#endif
+
+// PUBACK / PINGRESP round trip, in ms
+#ifndef LINK_RTT_GOOD_MS
+#define LINK_RTT_GOOD_MS 150
+#endif
+
+#ifndef LINK_RTT_BAD_MS
+#define LINK_RTT_BAD_MS 1500
+#endif
+
+// Share of failed publishes scored as bad
+#ifndef LINK_FAILURE_BAD
+#define LINK_FAILURE_BAD 0.2f
+#endif
+
+typedef struct {
+    float rssi;         // smoothed, dBm
+    float sendMs;       // smoothed time a publish blocked
+    float rttMs;        // smoothed PUBACK / PINGRESP round trip
+    float failureRate;  // smoothed share of failed publishes
+    float quality;      // 0 bad .. 1 good
+    uint8_t batch;      // samples per publish
+} LinkStats_t;
+
+void link_record_rssi(int rssi);
+
+/**
+ * @brief Records one publish attempt, durationMs is the time it blocked.
+ */
+void link_record_publish(uint32_t durationMs, bool ok);
+
+void link_record_rtt(uint32_t rttMs);
+
+/**
+ * @brief Samples to collect before the next publish, updated by link_record_publish().
+ */
+uint8_t link_batch_size();
+
+float link_quality();
+
+LinkStats_t link_get_stats();
+
+#endif
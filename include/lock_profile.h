@@ -0,0 +1,146 @@
+#ifndef __LOCK_PROFILE_H__
+#define __LOCK_PROFILE_H__
+
+#include <Arduino.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "esp_timer.h"
+
+/**
+ * @brief Contention profiling of the FreeRTOS mutexes, semaphores and queues
+ *        shared between tasks.
+ *
+ * lock_take(), lock_give(), lock_send() and lock_receive() replace the plain
+ * calls on a registered object and record per object:
+ *  - how long the take / receive blocked and how long the give / send
+ *    blocked (a full queue), as histograms, with the timeouts
+ *  - for mutexes, how long the holder kept it
+ *  - for signals, how long the consumer waited for the give. Consumers poll
+ *    with a timeout, an expired wait is idle time, not a timeout: it is only
+ *    counted, and the wait goes on until the signal arrives
+ *  - the longest wait and the last timeout, with the waiting task and the
+ *    task it waited for: the holder of a mutex, the last giver of a
+ *    semaphore, the last receiver of a full queue
+ *
+ * lock_profile_metrics() renders them in the Prometheus text format, served
+ * on /metrics, lock_profile_waiting_on() tells which object a task is blocked
+ * on right now. Objects that were not registered pass straight through.
+ *
+ * With LOCK_PROFILING=0 the wrappers are the plain FreeRTOS calls and the
+ * profiler is not compiled in. LOCK_PROFILE_BENCHMARK=1 measures the cost of
+ * a profiled take / give pair at boot.
+ *
+ * Task identities are resolved while the wait is recorded, so only profile
+ * objects used by tasks that do not exit.
+ */
+
+#ifndef LOCK_PROFILING
+#define LOCK_PROFILING 1
+#endif
+
+#ifndef LOCK_PROFILE_BENCHMARK
+#define LOCK_PROFILE_BENCHMARK 0
+#endif
+
+#ifndef LOCK_PROFILE_MAX_OBJECTS
+#define LOCK_PROFILE_MAX_OBJECTS 16
+#endif
+
+// Tasks that can be blocked in a profiled call at once, for lock_profile_waiting_on()
+#ifndef LOCK_PROFILE_MAX_WAITS
+#define LOCK_PROFILE_MAX_WAITS 8
+#endif
+
+// Blocking shorter than this is not counted as contention
+#ifndef LOCK_CONTENDED_US
+#define LOCK_CONTENDED_US 50
+#endif
+
+typedef enum {
+    LOCK_KIND_MUTEX,    // taken and given by the same task, hold times are recorded
+    LOCK_KIND_SIGNAL,   // binary / counting semaphore given by a producer, takes are recorded as signal waits
+    LOCK_KIND_QUEUE
+} LockKind_t;
+
+// Histogram upper bounds in us, the last bucket is everything above
+#define LOCK_BUCKETS 7
+extern const uint32_t lockBucketUs[LOCK_BUCKETS - 1];
+
+typedef struct {
+    uint32_t count;
+    uint32_t contended;     // blocked at least LOCK_CONTENDED_US
+    uint32_t timeouts;      // also failed gives of a semaphore already given
+    uint64_t totalUs;
+    uint32_t maxUs;
+    uint32_t buckets[LOCK_BUCKETS];
+} LockTiming_t;
+
+typedef struct {
+    const void *handle;
+    const char *name;
+    LockKind_t kind;
+    LockTiming_t acquire;   // take / receive, not signals
+    LockTiming_t release;   // give / send
+    LockTiming_t hold;      // mutexes: take to give
+    LockTiming_t signal;    // signals: first wait to the take that got the signal
+    uint32_t expiredWaits;  // signals: takes that expired with no signal
+    UBaseType_t maxDepth;   // queues: most items waiting after a send
+    uint32_t worstWaitUs;
+    char worstWaiter[configMAX_TASK_NAME_LEN];
+    char worstBlocker[configMAX_TASK_NAME_LEN];
+    char timeoutWaiter[configMAX_TASK_NAME_LEN];
+    char timeoutBlocker[configMAX_TASK_NAME_LEN];
+} LockProfile_t;
+
+#if LOCK_PROFILING
+
+/**
+ * @brief Starts profiling an object. Call before the tasks using it start.
+ * @param name Metric label, e.g. "lcd_state"
+ */
+void lock_profile_register(const void *handle, const char *name, LockKind_t kind);
+
+BaseType_t lock_take(SemaphoreHandle_t semaphore, TickType_t ticks);
+BaseType_t lock_give(SemaphoreHandle_t semaphore);
+BaseType_t lock_send(QueueHandle_t queue, const void *item, TickType_t ticks);
+BaseType_t lock_receive(QueueHandle_t queue, void *item, TickType_t ticks);
+
+/**
+ * @brief Copies the profile of a registered object.
+ * @return false if it is not registered
+ */
+bool lock_profile_get(const void *handle, LockProfile_t *profile);
+
+/**
+ * @brief Every registered object in the Prometheus text format.
+ */
+String lock_profile_metrics();
+
+/**
+ * @brief Name of the registered object a task is blocked on right now.
+ * @return NULL if it is not blocked in a profiled call
+ */
+const char *lock_profile_waiting_on(TaskHandle_t task);
+
+#else
+
+#define lock_profile_register(handle, name, kind) ((void)0)
+#define lock_take(semaphore, ticks) xSemaphoreTake(semaphore, ticks)
+#define lock_give(semaphore) xSemaphoreGive(semaphore)
+#define lock_send(queue, item, ticks) xQueueSend(queue, item, ticks)
+#define lock_receive(queue, item, ticks) xQueueReceive(queue, item, ticks)
+#define lock_profile_get(handle, profile) false
+#define lock_profile_metrics() String("# lock profiling disabled\n")
+#define lock_profile_waiting_on(task) ((const char *)NULL)
+
+#endif
+
+/**
+ * @brief Measures a plain and a profiled take / give pair of an uncontended
+ *        mutex and prints the cost per pair.
+ */
+void lock_profile_benchmark();
+
+#endif
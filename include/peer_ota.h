@@ -0,0 +1,159 @@
+#ifndef __PEER_OTA_H__
+#define __PEER_OTA_H__
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <HTTPClient.h>
+#include <ESPmDNS.h>
+#include <Preferences.h>
+#include <ESPAsyncWebServer.h>
+#include <ArduinoJson.h>
+#include "esp_ota_ops.h"
+#include "mbedtls/md.h"
+#include "global.h"
+#include "snapshot.h"
+
+/**
+ * @brief LAN-assisted firmware rollout, the image crosses the WAN a few times
+ *        per site instead of once per device.
+ *
+ * The target image is announced by the ThingsBoard shared attributes fw_title,
+ * fw_version, fw_checksum (SHA-256), fw_size and optionally fw_seeders, a
+ * comma separated list of LAN addresses ("192.168.1.20" or "host:port")
+ * to fetch from.
+ *
+ * Every device advertises _iotfw._tcp over mDNS with its id and, once it holds
+ * a verified copy of the target, the first 16 hex digits of its checksum. A
+ * device without the image downloads it in PEER_OTA_CHUNK pieces:
+ *  - from a random peer holding it, with HTTP range requests on PEER_OTA_PATH;
+ *    a peer that fails or is busy is skipped and the download resumes at the
+ *    same offset from the next one
+ *  - from the cloud (ThingsBoard HTTP firmware API, by chunk) if no peer has
+ *    it, and only if the device is elected: its id hashed with the checksum is
+ *    among the PEER_OTA_SEEDERS lowest of the site, or its address is listed in
+ *    fw_seeders. Everyone else waits for the seeders, or for
+ *    PEER_OTA_CLOUD_FALLBACK_MS if none shows up. An mDNS query returns 20
+ *    devices at most, on a larger site nobody can rank itself; the wait is
+ *    then spread over PEER_OTA_CLOUD_FALLBACK_MS by rank instead, so the
+ *    lowest ranks go first and the others find them as peers.
+ *
+ * The image is written to the next OTA partition and hashed on the way; only a
+ * copy matching fw_checksum is served or booted. A failed download is retried
+ * after a pause that doubles with every failure of the same target, an image
+ * the cloud serves with another checksum is not fetched again. A device serves it for
+ * PEER_OTA_SEED_MS before rebooting into it, and again from its running
+ * partition afterwards, so every finished device becomes a seeder. An image
+ * that was applied but is not running after the reboot (rolled back, see
+ * canary.h) is not downloaded or served again.
+ *
+ * Progress goes to the server as the fw_state telemetry of ThingsBoard
+ * (DOWNLOADING .. UPDATED / FAILED), with the bytes fetched from each source.
+ * tools/peer_ota_sim.py simulates the rollout of a site.
+ */
+
+// Name and version of this build, compared with fw_title / fw_version
+#ifndef FIRMWARE_TITLE
+#define FIRMWARE_TITLE "btliot"
+#endif
+
+#ifndef FIRMWARE_VERSION
+#define FIRMWARE_VERSION "1.0.0"
+#endif
+
+#define PEER_OTA_PATH "/peer/fw"
+#define PEER_OTA_SERVICE "iotfw"
+#define PEER_OTA_SHARED_KEYS "fw_title,fw_version,fw_checksum,fw_checksum_algorithm,fw_size,fw_seeders"
+
+// Range and cloud chunk size, also the download buffer
+#ifndef PEER_OTA_CHUNK
+#define PEER_OTA_CHUNK 16384
+#endif
+
+// Devices per site fetching from the cloud
+#ifndef PEER_OTA_SEEDERS
+#define PEER_OTA_SEEDERS 2
+#endif
+
+// Range responses served at once, further requests get 503 and try another peer
+#ifndef PEER_OTA_MAX_SERVES
+#define PEER_OTA_MAX_SERVES 2
+#endif
+
+#ifndef PEER_OTA_MAX_PEERS
+#define PEER_OTA_MAX_PEERS 24
+#endif
+
+// Between two mDNS queries while nobody offers the image
+#ifndef PEER_OTA_DISCOVERY_MS
+#define PEER_OTA_DISCOVERY_MS 15000
+#endif
+
+// A device that is not elected goes to the cloud itself after this long
+#ifndef PEER_OTA_CLOUD_FALLBACK_MS
+#define PEER_OTA_CLOUD_FALLBACK_MS 900000
+#endif
+
+// A peer that failed a range is skipped for this long
+#ifndef PEER_OTA_PEER_BACKOFF_MS
+#define PEER_OTA_PEER_BACKOFF_MS 60000
+#endif
+
+// Serving the new image before rebooting into it
+#ifndef PEER_OTA_SEED_MS
+#define PEER_OTA_SEED_MS 60000
+#endif
+
+#ifndef PEER_OTA_TIMEOUT_MS
+#define PEER_OTA_TIMEOUT_MS 10000
+#endif
+
+#ifndef PEER_OTA_CLOUD_PORT
+#define PEER_OTA_CLOUD_PORT 80
+#endif
+
+// Set to 0 to download and seed without rebooting into the image
+#ifndef PEER_OTA_APPLY
+#define PEER_OTA_APPLY 1
+#endif
+
+typedef struct {
+    uint32_t cloudBytes;        // fetched over the WAN
+    uint32_t lanBytes;          // fetched from peers
+    uint32_t servedBytes;
+    uint16_t servedRanges;
+    uint16_t busyRanges;        // refused, PEER_OTA_MAX_SERVES were running
+    uint16_t peerFailures;      // ranges that failed, resumed elsewhere
+    uint16_t hashFailures;      // downloads that did not match fw_checksum
+    uint32_t downloadMs;
+} PeerOtaStats_t;
+
+/**
+ * @brief Reports the result of the last applied image. Call once at boot,
+ *        after canary_begin().
+ */
+void peer_ota_begin();
+
+/**
+ * @brief Shared attribute update or attribute request response, from the
+ *        MQTT callback. Ignores everything but the fw_* keys.
+ */
+void peer_ota_on_attributes(const uint8_t *payload, unsigned int length);
+
+/**
+ * @brief Serves the verified image on PEER_OTA_PATH, with range requests.
+ */
+void peer_ota_register(AsyncWebServer &server);
+
+/**
+ * @brief Discovery, download and apply, created in main.cpp.
+ */
+void peer_ota_task(void *pvParameters);
+
+/**
+ * @brief The fw_state telemetry, if it changed since the last call.
+ */
+bool peer_ota_take_state(String &payload);
+
+PeerOtaStats_t peer_ota_get_stats();
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef __QUANTILE_SKETCH_H__
+#define __QUANTILE_SKETCH_H__
+
+#include <Arduino.h>
+
+// Relative accuracy of every reported quantile (1%)
+#ifndef QUANTILE_SKETCH_ALPHA
+#define QUANTILE_SKETCH_ALPHA 0.01f
+#endif
+
+// Bins per store, covers values spanning a factor of ((1+a)/(1-a))^bins before
+// the bins closest to zero are collapsed (128 bins at 1% -> factor 13)
+#ifndef QUANTILE_SKETCH_BINS
+#define QUANTILE_SKETCH_BINS 128
+#endif
+
+// Values closer to zero than this are counted as zero, should match the
+// resolution of the sensor (DHT20: 0.01)
+#ifndef QUANTILE_SKETCH_MIN_VALUE
+#define QUANTILE_SKETCH_MIN_VALUE 0.01f
+#endif
+
+/**
+ * @brief Contiguous range of logarithmic bins, bins[0] holds index `offset`.
+ *        An empty store (count == 0) is all zero, so zero-initialised
+ *        sketches are valid and empty.
+ */
+typedef struct {
+    uint32_t bins[QUANTILE_SKETCH_BINS];
+    int32_t offset;
+    uint32_t count;
+} SketchStore_t;
+
+/**
+ * @brief DDSketch: mergeable streaming quantile sketch with bounded memory.
+ *
+ * Every value x > 0 is counted in bin ceil(log_gamma(x)), gamma = (1+a)/(1-a),
+ * so any quantile is returned with a relative error of at most a. Negative
+ * values use a second store on |x|, zeros are counted separately.
+ * Adding a sample is O(1) inside the window of a store and bounded by
+ * QUANTILE_SKETCH_BINS when the window has to move.
+ */
+typedef struct {
+    SketchStore_t positive;
+    SketchStore_t negative;
+    uint32_t zeroCount;
+    uint32_t count;
+    float min;
+    float max;
+    double sum;
+} QuantileSketch_t;
+
+void sketch_reset(QuantileSketch_t *sketch);
+void sketch_add(QuantileSketch_t *sketch, float value);
+void sketch_merge(QuantileSketch_t *dst, const QuantileSketch_t *src);
+
+/**
+ * @brief Returns the value at quantile q (0..1), NAN for an empty sketch.
+ */
+float sketch_quantile(const QuantileSketch_t *sketch, float q);
+
+/**
+ * @brief Writes the sketch in its compact, mergeable text form:
+ *        "a<alpha>;p<first index>:<count>,<count>...;n<...>;z<zeros>"
+ *        Only the range of non-zero bins of each store is written, runs of
+ *        empty bins inside that range are written as "-<run length>".
+ * @return Length of the written string, 0 if the buffer was too small.
+ */
+size_t sketch_encode(const QuantileSketch_t *sketch, char *buffer, size_t size);
+
+#endif
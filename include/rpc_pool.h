@@ -0,0 +1,107 @@
+#ifndef __RPC_POOL_H__
+#define __RPC_POOL_H__
+
+#include <Arduino.h>
+#include "global.h"
+#include "admission.h"
+#include <ArduinoJson.h>
+
+/**
+ * @brief Bounded worker pool for server-side RPC requests.
+ *
+ * The MQTT callback only hands a request to rpc_submit(), which checks the
+ * method and its concurrency limit and queues the raw message. RPC_WORKERS
+ * tasks (rpc_worker_task) run the handlers, so an RPC that reads flash or
+ * runs inference never stalls keepalives or publishes. Finished responses are
+ * queued back and published by the network task in rpc_take_response(); the
+ * submitting task is woken through its task notification.
+ *
+ * Every request gets a deadline of its method's timeout from submission. A
+ * request still queued at its deadline is answered with a timeout error
+ * without running; a response finished after it is dropped, the caller has
+ * given up by then. A full queue, a method at its concurrency limit or above
+ * its request rate is rejected right away: rpc_submit() hands the error
+ * response back for the network task to publish, so every request that
+ * passed admission is answered even while the response queue is full. A
+ * worker response that finds the queue full for a second is dropped
+ * and counted.
+ */
+
+#ifndef RPC_WORKERS
+#define RPC_WORKERS 2
+#endif
+
+// Requests waiting for a worker, also the length of the response queue
+#ifndef RPC_QUEUE_LENGTH
+#define RPC_QUEUE_LENGTH 8
+#endif
+
+// Longest request message that is accepted
+#ifndef RPC_MAX_REQUEST_SIZE
+#define RPC_MAX_REQUEST_SIZE 256
+#endif
+
+#ifndef RPC_MAX_METHODS
+#define RPC_MAX_METHODS 12
+#endif
+
+#define RPC_METHOD_LEN 24
+
+// Runs on a worker task. Returns the response body, an empty string sends none.
+typedef String (*RpcHandler_t)(JsonVariantConst params);
+
+typedef struct {
+    uint32_t requestId;
+    uint8_t method;         // index of the registered method, RPC_MAX_METHODS if unknown
+    uint32_t deadline;      // millis()
+    TaskHandle_t notify;    // network task to wake with the response
+    uint16_t length;
+    char message[RPC_MAX_REQUEST_SIZE];
+} RpcRequest_t;
+
+typedef struct {
+    uint32_t requestId;
+    char *body;             // heap, freed by rpc_take_response()
+} RpcResponse_t;
+
+typedef struct {
+    uint32_t completed;
+    uint32_t rejectedRate;      // method above its request rate
+    uint32_t rejectedBusy;      // method at its concurrency limit
+    uint32_t rejectedFull;      // request queue full
+    uint32_t expired;           // deadline passed while queued
+    uint32_t late;              // response finished after the deadline, dropped
+    uint32_t droppedResponses;  // response queue full, worker response not sent
+} RpcStats_t;
+
+/**
+ * @brief Registers a method. Call before the workers receive requests.
+ * @param maxConcurrent Requests of this method queued or running at once
+ * @param timeoutMs Deadline from submission
+ * @param ratePerS Sustained requests per second accepted, burst more at once
+ */
+bool rpc_register(const char *method, RpcHandler_t handler, uint8_t maxConcurrent, uint32_t timeoutMs,
+                  float ratePerS, uint8_t burst);
+
+/**
+ * @brief Queues a request received on v1/devices/me/rpc/request/<id>. Called by the
+ *        MQTT callback, never blocks.
+ * @param responseTopic Receives the response topic of a rejected request
+ * @param response Receives the error response of a rejected request
+ * @return false if the request was rejected, the caller publishes the error response
+ */
+bool rpc_submit(const char *topic, const uint8_t *payload, unsigned int length, String &responseTopic,
+                String &response);
+
+/**
+ * @brief Takes the next finished response, for the network task to publish.
+ * @param topic Receives the response topic
+ * @return false if no response is waiting
+ */
+bool rpc_take_response(String &topic, String &body);
+
+RpcStats_t rpc_get_stats();
+
+void rpc_worker_task(void *pvParameters);
+
+#endif
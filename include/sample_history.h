@@ -0,0 +1,91 @@
+#ifndef __SAMPLE_HISTORY_H__
+#define __SAMPLE_HISTORY_H__
+
+#include <Arduino.h>
+#include <time.h>
+#include "LittleFS.h"
+#include "global.h"
+#include "storage.h"
+
+/**
+ * @brief On-device history of the raw sensor samples, with an optional score
+ *        series written next to it.
+ *
+ * Samples are 8 byte records appended through the storage layer. Like the
+ * event journal, two segments are kept: once the current one holds
+ * HISTORY_SEGMENT_RECORDS it replaces the previous one. Samples are
+ * addressed by index, oldest first across both segments.
+ *
+ * The score series is parallel to the samples: score i belongs to sample i.
+ * Each segment has its own score file, which starts with the id of the
+ * model that produced the scores. Scores are appended in order, so the
+ * number of scores is also the index of the first unscored sample.
+ */
+
+// Samples per segment (32768 samples = 256 KB = 45 h at one sample per 5 s)
+#ifndef HISTORY_SEGMENT_RECORDS
+#define HISTORY_SEGMENT_RECORDS 32768
+#endif
+
+// Time has this bit set when the clock was not synced yet: seconds since boot
+#define HISTORY_TIME_UPTIME 0x80000000UL
+
+typedef struct __attribute__((packed)) {
+    uint32_t time;          // unix time, or uptime seconds | HISTORY_TIME_UPTIME
+    int16_t temperature;    // 0.01 °C
+    uint16_t humidity;      // 0.01 %
+} HistorySample_t;
+
+bool history_begin();
+bool history_append(float temperature, float humidity);
+
+/**
+ * @brief Samples in both segments.
+ */
+uint32_t history_count();
+
+/**
+ * @brief Samples in the previous segment, indices 0 .. history_aged() - 1. They
+ *        are dropped at the next rotation.
+ */
+uint32_t history_aged();
+
+/**
+ * @brief Increments whenever the segments rotate, which shifts every index.
+ */
+uint32_t history_generation();
+
+/**
+ * @brief Reads up to max samples starting at index.
+ * @return Samples read
+ */
+size_t history_read(uint32_t index, HistorySample_t *samples, size_t max);
+
+inline float history_temperature(const HistorySample_t *sample) { return sample->temperature / 100.0f; }
+inline float history_humidity(const HistorySample_t *sample) { return sample->humidity / 100.0f; }
+
+/**
+ * @brief Number of samples scored by the given model. Scores of any other model
+ *        are discarded, so a new model starts over from the oldest sample.
+ */
+uint32_t history_scored(uint32_t modelId);
+
+/**
+ * @brief Discards the whole score series, e.g. to re-score with the same model.
+ */
+void history_drop_scores();
+
+/**
+ * @brief Appends scores (0..1, stored as 0..65535) for the samples starting at
+ *        index. Fails if index is not history_scored() or the segments rotated
+ *        since generation was read.
+ */
+bool history_append_scores(uint32_t generation, uint32_t index, const float *scores, size_t count);
+
+/**
+ * @brief Reads up to max scores starting at index.
+ * @return Scores read
+ */
+size_t history_read_scores(uint32_t index, float *scores, size_t max);
+
+#endif
@@ -0,0 +1,116 @@
+#ifndef __SCHEDULER_H__
+#define __SCHEDULER_H__
+
+#include <Arduino.h>
+#include <time.h>
+#include "esp_timer.h"
+#include "LittleFS.h"
+#include "global.h"
+#include "timer_wheel.h"
+#include "event_journal.h"
+#include <ArduinoJson.h>
+
+/**
+ * @brief Timed actions on a single dispatcher task.
+ *
+ * All timers, one-shot timers started by code with scheduler_after() as well
+ * as the calendar entries, live in one timer wheel. scheduler_task sleeps on
+ * its task notification until the wheel has work, so there is no task and no
+ * polling per timer. Calendar entries (once / daily / weekly / interval) are
+ * persisted to SCHEDULER_FILE and re-armed at boot; the daily and weekly ones
+ * use local time and wait for a synced clock.
+ *
+ * Actions run on the dispatcher task and must be short.
+ */
+
+// Resolution of the timer wheel
+#ifndef SCHEDULER_TICK_MS
+#define SCHEDULER_TICK_MS 100
+#endif
+
+#ifndef SCHEDULER_MAX_ENTRIES
+#define SCHEDULER_MAX_ENTRIES 32
+#endif
+
+#define SCHEDULER_FILE "/schedule.dat"
+
+// Pins the gpio action may drive: the two user LEDs. Anything else (flash and
+// PSRAM lines, the sensor bus, strapping pins) is refused when an entry is
+// added and again when the action runs
+#ifndef SCHEDULER_GPIO_PINS
+#define SCHEDULER_GPIO_PINS {48, 41}
+#endif
+
+// Until the clock is synced, daily/weekly/once entries are re-checked this often
+#define SCHEDULER_CLOCK_RETRY_S 60
+
+// Set TIMER_WHEEL_BENCHMARK=1 in build_flags to run scheduler_benchmark() once at boot
+#ifndef TIMER_WHEEL_BENCHMARK
+#define TIMER_WHEEL_BENCHMARK 0
+#endif
+
+typedef enum {
+    SCHEDULE_ONCE = 0,      // at = unix time
+    SCHEDULE_DAILY,         // at = seconds after local midnight
+    SCHEDULE_WEEKLY,        // at = seconds after local midnight, on the days of weekdays
+    SCHEDULE_INTERVAL,      // at = period in seconds, counted from boot / creation
+    SCHEDULE_KIND_COUNT
+} ScheduleKind_t;
+
+typedef enum {
+    SCHEDULE_ACTION_LOG = 0,    // journal EVENT_SCHEDULE only
+    SCHEDULE_ACTION_GPIO,       // param = pin | (level << 8), pin one of SCHEDULER_GPIO_PINS
+    SCHEDULE_ACTION_REPORT,     // publish the telemetry window now (registered by coreiot)
+    SCHEDULE_ACTION_RELAY,      // param = relay | (on << 8), relay 31 = all (registered by task_rs485)
+    SCHEDULE_ACTION_COUNT
+} ScheduleAction_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t id;         // 1..255, 0 = unused
+    uint8_t kind;       // ScheduleKind_t
+    uint8_t weekdays;   // SCHEDULE_WEEKLY: bit 0 = Sunday .. bit 6 = Saturday
+    uint8_t action;     // ScheduleAction_t
+    uint32_t at;
+    int32_t param;
+} ScheduleEntry_t;
+
+typedef void (*ScheduleActionHandler_t)(int32_t param);
+
+void scheduler_begin();
+void scheduler_task(void *pvParameters);
+
+/**
+ * @brief Replaces the handler of an action, e.g. SCHEDULE_ACTION_REPORT.
+ */
+void scheduler_set_action(ScheduleAction_t action, ScheduleActionHandler_t handler);
+
+/**
+ * @brief Runs an action once after delayMs (capped at about 19 days).
+ * @return Handle for scheduler_cancel(), TIMER_WHEEL_INVALID_HANDLE if the wheel is full
+ */
+TimerWheelHandle_t scheduler_after(uint32_t delayMs, ScheduleAction_t action, uint16_t param);
+bool scheduler_cancel(TimerWheelHandle_t handle);
+
+/**
+ * @brief Adds a calendar entry, or replaces the one with the same id, and persists it.
+ * @return Id of the entry, 0 if it is invalid or the table is full
+ */
+uint8_t scheduler_add_entry(const ScheduleEntry_t *entry);
+bool scheduler_remove_entry(uint8_t id);
+
+/**
+ * @brief Fills an entry from RPC parameters, e.g.
+ *        {"kind":"daily","at":"07:30","action":"gpio","param":304}
+ *        {"kind":"weekly","at":"18:00","days":62,"action":"report"}
+ *        {"kind":"interval","at":3600,"action":"report"}
+ */
+bool scheduler_entry_from_json(JsonVariantConst params, ScheduleEntry_t *entry);
+
+/**
+ * @brief All calendar entries with their next due time, as a JSON array.
+ */
+String scheduler_list_json();
+
+void scheduler_benchmark();
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef __SNAPSHOT_H__
+#define __SNAPSHOT_H__
+
+#include <Arduino.h>
+#include "LittleFS.h"
+#include "global.h"
+
+/**
+ * @brief Warm-restart snapshots of derived state (window sketches, detector
+ *        and display state, last readings).
+ *
+ * Subsystems register a named, versioned blob with a save and a restore
+ * callback. The blobs are packed into one image with a magic, a sequence
+ * number and a CRC-32, which is written:
+ *  - to RTC memory (RTC_NOINIT, survives every reset except power loss)
+ *    every SNAPSHOT_RTC_PERIOD_MS and by snapshot_restart() / after an OTA
+ *  - to SNAPSHOT_FILE every SNAPSHOT_FLASH_PERIOD_MS
+ *
+ * At boot snapshot_begin() validates both copies and keeps the newer valid
+ * one. Registering a blob restores it right away, when the image holds a
+ * blob of the same name, version and size; anything else starts cold.
+ * Blobs of subsystems that have not registered yet are carried over into
+ * the next saves.
+ */
+
+#ifndef SNAPSHOT_MAX_ENTRIES
+#define SNAPSHOT_MAX_ENTRIES 8
+#endif
+
+// Largest image, header included, also the size reserved in RTC memory
+#ifndef SNAPSHOT_MAX_SIZE
+#define SNAPSHOT_MAX_SIZE 3072
+#endif
+
+#ifndef SNAPSHOT_RTC_PERIOD_MS
+#define SNAPSHOT_RTC_PERIOD_MS 10000
+#endif
+
+#ifndef SNAPSHOT_FLASH_PERIOD_MS
+#define SNAPSHOT_FLASH_PERIOD_MS 900000
+#endif
+
+#define SNAPSHOT_FILE "/snapshot.dat"
+#define SNAPSHOT_NAME_LEN 12
+
+#define SNAPSHOT_TARGET_RTC 0x01
+#define SNAPSHOT_TARGET_FLASH 0x02
+
+// Copies the subsystem state into buffer (exactly the registered size).
+// Buffers are only 4 byte aligned, copy structs with doubles by memcpy.
+typedef void (*SnapshotSave_t)(void *buffer);
+// Applies a validated blob of the registered version and size
+typedef void (*SnapshotRestore_t)(const void *buffer);
+
+/**
+ * @brief Validates the RTC and flash images and keeps the newer one for restoring.
+ *        Call once at boot, after LittleFS is mounted.
+ */
+void snapshot_begin();
+
+/**
+ * @brief Registers a state blob and restores it from the boot image, if it holds one.
+ *        Bump version whenever the layout of the blob changes.
+ * @return true if the blob was restored
+ */
+bool snapshot_register(const char *name, uint16_t version, size_t size,
+                       SnapshotSave_t save, SnapshotRestore_t restore);
+
+/**
+ * @brief Saves every registered blob to the given SNAPSHOT_TARGET_* copies.
+ */
+bool snapshot_save(uint8_t targets);
+
+/**
+ * @brief Planned restart: saves the snapshot to RTC and flash, then restarts.
+ */
+void snapshot_restart();
+
+/**
+ * @brief Periodic RTC and flash saves.
+ */
+void snapshot_task(void *pvParameters);
+
+#endif
@@ -0,0 +1,148 @@
+#ifndef __STALL_DETECTOR_H__
+#define __STALL_DETECTOR_H__
+
+#include <Arduino.h>
+#include <time.h>
+#include "global.h"
+#include "event_journal.h"
+#include "executor.h"
+#include <ArduinoJson.h>
+
+/**
+ * @brief Detects wedged tasks and keeps a crash log of them in RTC memory.
+ *
+ * A task declares with stall_register() how long it may go without a
+ * stall_heartbeat(), and may describe what it is doing with
+ * stall_set_state(), e.g. "wifi connect". stall_monitor_task, above every
+ * application task, checks the deadlines every STALL_CHECK_MS. For a task
+ * past its deadline it records once per stall:
+ *  - the backtrace of the task, from the context saved at its last switch
+ *  - its scheduler state and the profiled object it is blocked on, if any
+ *    (lock_profile_waiting_on())
+ *  - its last state note and the least free stack it ever had
+ *
+ * The records go to a ring of STALL_LOG_ENTRIES in RTC memory (RTC_NOINIT),
+ * so they survive the reboot a stall often ends in, and are journaled as
+ * EVENT_STALL. coreiot publishes the records not yet published after its
+ * next connect. Decode a backtrace with
+ *   xtensa-esp32s3-elf-addr2line -pfiaC -e .pio/build/yolo_uno/firmware.elf <addresses>
+ *
+ * After recording, the configured recovery runs: a handler (e.g. an I2C bus
+ * reset, on the executor so the monitor never blocks), restarting the task,
+ * or rebooting. Restarting deletes the task wherever it is, locks it holds
+ * stay taken; only use it for tasks that share nothing.
+ */
+
+#ifndef STALL_CHECK_MS
+#define STALL_CHECK_MS 1000
+#endif
+
+#ifndef STALL_MONITOR_PRIORITY
+#define STALL_MONITOR_PRIORITY 10
+#endif
+
+#ifndef STALL_MAX_TASKS
+#define STALL_MAX_TASKS 12
+#endif
+
+// Records kept in RTC memory, the oldest is overwritten first
+#ifndef STALL_LOG_ENTRIES
+#define STALL_LOG_ENTRIES 4
+#endif
+
+#ifndef STALL_BACKTRACE_DEPTH
+#define STALL_BACKTRACE_DEPTH 16
+#endif
+
+#define STALL_STATE_LEN 24
+#define STALL_OBJECT_LEN 16
+
+// Record time is seconds since boot, the wall clock was not synced yet
+#define STALL_FLAG_UPTIME 0x01
+#define STALL_FLAG_PUBLISHED 0x02
+
+typedef enum {
+    STALL_RECOVER_NONE = 0,     // record only
+    STALL_RECOVER_HANDLER,      // run the handler on the executor
+    STALL_RECOVER_RESTART_TASK, // delete the task and create it again
+    STALL_RECOVER_REBOOT,       // restart the device, the RTC snapshot is at most SNAPSHOT_RTC_PERIOD_MS old
+    STALL_RECOVER_COUNT
+} StallRecovery_t;
+
+typedef void (*StallHandler_t)(void *arg);
+
+typedef struct {
+    uint32_t sequence;          // records written since the log was started
+    uint32_t time;              // unix time, or uptime seconds with STALL_FLAG_UPTIME
+    uint32_t bootCount;         // boot the stall happened in, see stall_boot_count()
+    uint32_t periodMs;          // declared heartbeat deadline
+    uint32_t overdueMs;         // since the last heartbeat
+    uint32_t stackFree;         // least free stack since the task started, bytes
+    uint8_t flags;
+    uint8_t taskState;          // eTaskState
+    uint8_t recovery;           // StallRecovery_t
+    uint8_t depth;              // backtrace entries
+    char task[configMAX_TASK_NAME_LEN];
+    char state[STALL_STATE_LEN];
+    char blockedOn[STALL_OBJECT_LEN];
+    uint32_t backtrace[STALL_BACKTRACE_DEPTH];
+} StallRecord_t;
+
+/**
+ * @brief Validates the RTC crash log, starts a new one after a power-on.
+ *        Call once at boot, before the tasks register.
+ */
+void stall_begin();
+
+/**
+ * @brief Watches the calling task, its first deadline is periodMs from now.
+ *        A task created again after a restart takes over its old slot.
+ * @param handler STALL_RECOVER_HANDLER: runs with arg on an executor worker
+ */
+bool stall_register(uint32_t periodMs, StallRecovery_t recovery = STALL_RECOVER_NONE,
+                    StallHandler_t handler = NULL, void *arg = NULL);
+
+/**
+ * @brief Watches the calling task with STALL_RECOVER_RESTART_TASK, which
+ *        creates it again from entry with the same name, stack and priority.
+ */
+bool stall_register_restartable(uint32_t periodMs, TaskFunction_t entry, uint32_t stackSize, void *param = NULL);
+
+/**
+ * @brief The calling task is alive, its next deadline is its period from now.
+ */
+void stall_heartbeat();
+
+/**
+ * @brief What the calling task is doing, reported with a stall. Keeps the
+ *        pointer, pass a string literal. NULL clears it.
+ */
+void stall_set_state(const char *state);
+
+void stall_monitor_task(void *pvParameters);
+
+/**
+ * @brief Boots since the crash log was started at power-on.
+ */
+uint32_t stall_boot_count();
+
+/**
+ * @brief Least free stack of any watched task since it started, bytes.
+ *        UINT32_MAX while no task is watched.
+ */
+uint32_t stall_min_stack_free();
+
+/**
+ * @brief Copies the oldest record not published yet.
+ * @return false if every record was published
+ */
+bool stall_take_unpublished(StallRecord_t *record);
+void stall_mark_published(uint32_t sequence);
+
+/**
+ * @brief A record as telemetry, stamped with its time if the clock was set.
+ *        The backtrace is a space separated list of addresses.
+ */
+String stall_record_json(const StallRecord_t *record);
+
+#endif
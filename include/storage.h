@@ -0,0 +1,114 @@
+#ifndef __STORAGE_H__
+#define __STORAGE_H__
+
+#include <Arduino.h>
+#include "LittleFS.h"
+#include "global.h"
+
+/**
+ * @brief Write-coalescing append layer over LittleFS.
+ *
+ * Every small append straight into LittleFS costs a metadata commit and a
+ * copy of the file's tail block. Appends go into a per-file RAM buffer
+ * instead and reach the flash as one write per flush, at the latest when
+ * the buffer is full (buffers are sized to the flash block).
+ *
+ * Data is durable only after a sync point:
+ *  - storage_sync() / storage_sync_all(), explicitly
+ *  - the file's policy: maxDelayMs after the oldest buffered append or
+ *    maxRecords buffered appends, checked by storage_task
+ *  - STORAGE_PRIORITY_CRITICAL appends, synced before returning
+ */
+
+#ifndef STORAGE_MAX_FILES
+#define STORAGE_MAX_FILES 8
+#endif
+
+// LittleFS block size on the ESP32 flash, buffers are at most this big
+#ifndef STORAGE_BLOCK_SIZE
+#define STORAGE_BLOCK_SIZE 4096
+#endif
+
+// RAM shared by all append buffers, files opened after it is used up get
+// smaller buffers, down to STORAGE_MIN_BUFFER, then none (direct writes)
+#ifndef STORAGE_RAM_BUDGET
+#define STORAGE_RAM_BUDGET (16 * 1024)
+#endif
+
+#ifndef STORAGE_MIN_BUFFER
+#define STORAGE_MIN_BUFFER 256
+#endif
+
+// Estimated flash bytes of one LittleFS metadata commit, used for the write amplification estimate
+#ifndef STORAGE_COMMIT_COST
+#define STORAGE_COMMIT_COST 64
+#endif
+
+// Set STORAGE_BENCHMARK=1 in build_flags to run storage_benchmark() once at boot
+#ifndef STORAGE_BENCHMARK
+#define STORAGE_BENCHMARK 0
+#endif
+
+typedef enum {
+    STORAGE_PRIORITY_NORMAL,
+    STORAGE_PRIORITY_CRITICAL   // synced before storage_append() returns
+} StoragePriority_t;
+
+typedef struct {
+    uint32_t maxDelayMs;        // 0 = no time based sync
+    uint32_t maxRecords;        // 0 = no count based sync
+} StorageSyncPolicy_t;
+
+typedef struct {
+    uint32_t appends;           // storage_append() calls
+    uint32_t bytesAppended;     // payload bytes handed to storage_append()
+    uint32_t flashWrites;       // LittleFS writes (one metadata commit each)
+    uint32_t bytesWritten;      // payload bytes written to LittleFS
+    uint32_t estimatedFlashBytes; // bytes LittleFS programs: copied tail block + data + commit
+    uint32_t syncs;             // sync points reached, by any trigger
+    uint32_t failedWrites;      // LittleFS writes that failed, the data is kept buffered
+} StorageStats_t;
+
+typedef int StorageHandle_t;
+#define STORAGE_INVALID_HANDLE (-1)
+
+/**
+ * @brief Registers a file for coalesced appends, the same path always returns the same handle.
+ * @param policy Sync policy, NULL for sync on full buffer / explicit sync only
+ * @param bufferSize Requested buffer size, capped to STORAGE_BLOCK_SIZE and the remaining RAM budget
+ */
+StorageHandle_t storage_open(const char *path, const StorageSyncPolicy_t *policy, size_t bufferSize = STORAGE_BLOCK_SIZE);
+/**
+ * @brief Syncs the file and releases its slot and buffer.
+ * @return false if the buffered appends could not be written, the file then
+ *         stays open with them buffered and the handle remains valid
+ */
+bool storage_close(StorageHandle_t handle);
+bool storage_append(StorageHandle_t handle, const void *data, size_t len, StoragePriority_t priority = STORAGE_PRIORITY_NORMAL);
+bool storage_sync(StorageHandle_t handle);
+void storage_sync_all();
+
+/**
+ * @brief File size including appends that are still buffered.
+ */
+size_t storage_size(StorageHandle_t handle);
+
+void storage_get_stats(StorageHandle_t handle, StorageStats_t *stats);
+
+/**
+ * @brief Estimated flash bytes programmed per payload byte appended (>= 1).
+ */
+float storage_write_amplification(const StorageStats_t *stats);
+
+/**
+ * @brief Applies the time based sync policies, created in main.cpp.
+ */
+void storage_task(void *pvParameters);
+
+/**
+ * @brief Measures append latency, throughput and write amplification of direct
+ *        and coalesced appends for a few access patterns, on a scratch directory.
+ */
+void storage_benchmark();
+
+#endif
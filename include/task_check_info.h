@@ -4,6 +4,7 @@
 #include <ArduinoJson.h>
 #include "LittleFS.h"
 #include "global.h"
+#include "snapshot.h"
 #include "task_wifi.h"
 
 
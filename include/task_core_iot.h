@@ -6,6 +6,8 @@
 #include <Arduino_MQTT_Client.h>
 #include <HTTPClient.h>
 #include "task_check_info.h"
+#include "dns_cache.h"
+#include "coreiot.h"
 
 void CORE_IOT_sendata(String mode, String feed, String data);
 void CORE_IOT_reconnect();
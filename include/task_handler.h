@@ -4,6 +4,8 @@
 
 #include <ArduinoJson.h>
 #include <task_check_info.h>
+#include "event_journal.h"
+#include "cpu_profile.h"
 
 extern void handleWebSocketMessage(String message);
 #endif
\ No newline at end of file
@@ -4,6 +4,9 @@
 #include <Arduino.h>
 #include "LiquidCrystal_I2C.h"
 #include "global.h"
+#include "event_journal.h"
+#include "snapshot.h"
+#include "capture.h"
 
 /**
  * @brief TASK 3: LCD Display Task with State-Based Display
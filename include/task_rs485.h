@@ -3,5 +3,18 @@
 
 #include <HardwareSerial.h>
 #include <Arduino.h>
+#include "scheduler.h"
+#include "executor.h"
+
+#define RELAY_COUNT 4
+#define RELAY_ALL 31
+
+// Flag in the SCHEDULE_ACTION_RELAY param of a step of the relay on / off cycle
+#define RELAY_SEQUENCE 0x8000
+
+#define RELAY_STEP_MS 1000
+#define RELAY_CYCLE_PAUSE_MS 3000
+
+void tasksensor_init();
 
 #endif
\ No newline at end of file
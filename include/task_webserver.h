@@ -8,6 +8,12 @@
 #include <ArduinoJson.h>
 #include <ElegantOTA.h>
 #include <task_handler.h>
+#include "dashboard_bundle.h"
+#include "snapshot.h"
+#include "lock_profile.h"
+#include "executor.h"
+#include "peer_ota.h"
+#include "cpu_profile.h"
 
 extern AsyncWebServer server;
 extern AsyncWebSocket ws;
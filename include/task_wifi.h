@@ -4,6 +4,7 @@
 #include <WiFi.h>
 #include <task_check_info.h>
 #include <task_webserver.h>
+#include "stall_detector.h"
 
 extern bool Wifi_reconnect();
 extern void startAP();
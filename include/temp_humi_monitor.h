@@ -4,6 +4,27 @@
 #include "LiquidCrystal_I2C.h"
 #include "DHT20.h"
 #include "global.h"
+#include "event_journal.h"
+#include "snapshot.h"
+#include "sample_history.h"
+#include "capture.h"
+#include "stall_detector.h"
+#include "canary.h"
+
+#define SENSOR_SDA 11
+#define SENSOR_SCL 12
+
+// Heartbeat deadline of the sensor task, several read periods; past it the
+// I2C bus is reset
+#ifndef SENSOR_STALL_MS
+#define SENSOR_STALL_MS 15000
+#endif
+
+// Longest the bus reset waits for an LCD update; a holder past it is stuck
+// on the bus as well and the reset goes ahead
+#ifndef SENSOR_BUS_RESET_WAIT_MS
+#define SENSOR_BUS_RESET_WAIT_MS 250
+#endif
 
 void temp_humi_monitor(void *pvParameters);
 
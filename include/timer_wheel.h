@@ -0,0 +1,86 @@
+#ifndef __TIMER_WHEEL_H__
+#define __TIMER_WHEEL_H__
+
+#include <Arduino.h>
+
+/**
+ * @brief Hierarchical timer wheel (4 levels x 64 slots) over a fixed pool of
+ *        12 byte timer nodes.
+ *
+ * Timers live in intrusive doubly linked slot lists, so insert and cancel
+ * are O(1). Level 0 holds timers due within 64 ticks, every further level
+ * covers 64 times the range of the one below; a timer is moved down a level
+ * (cascaded) when the wheel below wraps. An occupancy bitmap per level lets
+ * timer_wheel_advance() jump over empty slots and lets the owner ask how
+ * long it may sleep. The wheel itself is not thread safe.
+ */
+
+// Timers the pool holds. A node is 12 bytes and the slot heads take 512 B, so
+// 1024 timers make a TimerWheel_t of about 12.8 KB
+#ifndef TIMER_WHEEL_CAPACITY
+#define TIMER_WHEEL_CAPACITY 1024
+#endif
+
+#define TIMER_WHEEL_LEVELS 4
+#define TIMER_WHEEL_SLOT_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_SLOT_BITS)
+#define TIMER_WHEEL_NONE 0xFFFF
+// Pool indexes and list links are 16 bit, TIMER_WHEEL_NONE is reserved
+#if TIMER_WHEEL_CAPACITY >= TIMER_WHEEL_NONE
+#error TIMER_WHEEL_CAPACITY must be below 65535
+#endif
+// Longest delay the wheel can hold (2^24 - 1 ticks), longer delays are capped
+#define TIMER_WHEEL_MAX_DELAY ((1UL << (TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOT_BITS)) - 1)
+
+// Handle of a timer, combines the pool index with a generation counter so a
+// stale handle can never cancel a timer that reused the node. Not FreeRTOS'
+// TimerHandle_t, the wheel has no software timer behind it
+typedef uint32_t TimerWheelHandle_t;
+#define TIMER_WHEEL_INVALID_HANDLE 0
+
+typedef void (*TimerWheelCallback_t)(uint8_t action, uint16_t arg);
+
+typedef struct {
+    uint32_t expires;   // tick the timer is due
+    uint16_t next;      // slot list, or free list
+    uint16_t prev;
+    uint16_t arg;
+    uint8_t action;
+    uint8_t generation; // 0 = node is free
+} TimerNode_t;
+
+typedef struct {
+    uint32_t now;       // current tick
+    uint16_t heads[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+    uint64_t occupied[TIMER_WHEEL_LEVELS];
+    uint16_t freeList;
+    uint16_t active;
+    uint8_t nextGeneration;
+    TimerNode_t nodes[TIMER_WHEEL_CAPACITY];
+} TimerWheel_t;
+
+void timer_wheel_init(TimerWheel_t *wheel, uint32_t now);
+
+/**
+ * @brief Adds a timer due `delay` ticks from now, clamped to 1..TIMER_WHEEL_MAX_DELAY.
+ * @return Handle for timer_wheel_cancel(), TIMER_WHEEL_INVALID_HANDLE if the pool is full
+ */
+TimerWheelHandle_t timer_wheel_add(TimerWheel_t *wheel, uint32_t delay, uint8_t action, uint16_t arg);
+bool timer_wheel_cancel(TimerWheel_t *wheel, TimerWheelHandle_t handle);
+
+/**
+ * @brief Moves the wheel to tick `to`, calling callback for every timer that
+ *        became due, in order of their due tick. Fired timers are freed before
+ *        their callback runs, callbacks may add or cancel any timer, including
+ *        ones due in the same tick.
+ * @return Number of timers fired
+ */
+uint32_t timer_wheel_advance(TimerWheel_t *wheel, uint32_t to, TimerWheelCallback_t callback);
+
+/**
+ * @brief Ticks until the wheel next has work: the next due timer, or the next
+ *        cascade of a higher level that holds timers. UINT32_MAX if empty.
+ */
+uint32_t timer_wheel_ticks_to_next(const TimerWheel_t *wheel);
+
+#endif
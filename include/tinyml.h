@@ -3,8 +3,20 @@
 
 #include <Arduino.h>
 
-#include "dht_anomaly_model.h"
 #include "global.h"
+#include "event_journal.h"
+#include "snapshot.h"
+#include "sample_history.h"
+#include "capture.h"
+#include "esp_timer.h"
+
+// The model in dht_anomaly_model.h, float or full-integer int8: inputs are
+// quantised and outputs dequantised from the tensors. tools/model/build_model.py
+// --install int8 puts the int8 variant there (see tools/model/quantization_report.md).
+// The backfill reads the batch size from the input tensor, so a fixed-batch
+// model installed with --batch N --install batch scores N samples per Invoke
+#include "dht_anomaly_model.h"
+#define DHT_ANOMALY_MODEL dht_anomaly_model_tflite
 
 #include <TensorFlowLite_ESP32.h>
 #include "tensorflow/lite/micro/all_ops_resolver.h"
@@ -13,7 +25,40 @@
 #include "tensorflow/lite/micro/system_setup.h"
 #include "tensorflow/lite/schema/schema_generated.h"
 
+// Inference results above this are journaled as EVENT_ANOMALY
+#ifndef TINYML_ANOMALY_THRESHOLD
+#define TINYML_ANOMALY_THRESHOLD 0.5f
+#endif
+
+// Samples read from the history and scored per round of the backfill
+#ifndef TINYML_BACKFILL_CHUNK
+#define TINYML_BACKFILL_CHUNK 256
+#endif
+
+#ifndef TINYML_BACKFILL_ARENA_SIZE
+#define TINYML_BACKFILL_ARENA_SIZE (16 * 1024)
+#endif
+
+// Backfill runs just above idle, on the core the Arduino loop does not use
+#ifndef TINYML_BACKFILL_PRIORITY
+#define TINYML_BACKFILL_PRIORITY 1
+#endif
+
+#ifndef TINYML_BACKFILL_CORE
+#define TINYML_BACKFILL_CORE (1 - ARDUINO_RUNNING_CORE)
+#endif
+
 void setupTinyML();
 void tiny_ml_task(void *pvParameters);
 
-#endif
\ No newline at end of file
+/**
+ * @brief Scores the stored sample history with the anomaly model and writes the
+ *        scores as a parallel series (see sample_history.h). Runs once on its own
+ *        task and interpreter, then deletes itself.
+ * @param rescoreAll Discard existing scores, otherwise only unscored samples are scored
+ * @return false if a backfill is already running or the task could not be created
+ */
+bool tinyml_backfill_start(bool rescoreAll);
+void tinyml_backfill_task(void *pvParameters);
+
+#endif
@@ -7,6 +7,7 @@
 
 #include "HttpClient.h"
 #include "WebSocketClient.h"
+#include "WebSocketStreamClient.h"
 #include "URLEncoder.h"
 
 #endif
@@ -8,6 +8,7 @@
 WebSocketClient::WebSocketClient(Client& aClient, const char* aServerName, uint16_t aServerPort)
  : HttpClient(aClient, aServerName, aServerPort),
    iTxStarted(false),
+   iTxFragmented(false),
    iRxSize(0)
 {
 }
@@ -15,6 +16,7 @@ WebSocketClient::WebSocketClient(Client& aClient, const char* aServerName, uint1
 WebSocketClient::WebSocketClient(Client& aClient, const String& aServerName, uint16_t aServerPort) 
  : HttpClient(aClient, aServerName, aServerPort),
    iTxStarted(false),
+   iTxFragmented(false),
    iRxSize(0)
 {
 }
@@ -22,11 +24,17 @@ WebSocketClient::WebSocketClient(Client& aClient, const String& aServerName, uin
 WebSocketClient::WebSocketClient(Client& aClient, const IPAddress& aServerAddress, uint16_t aServerPort)
  : HttpClient(aClient, aServerAddress, aServerPort),
    iTxStarted(false),
+   iTxFragmented(false),
    iRxSize(0)
 {
 }
 
 int WebSocketClient::begin(const char* aPath)
+{
+    return begin(aPath, NULL);
+}
+
+int WebSocketClient::begin(const char* aPath, const char* aProtocol)
 {
     // start the GET request
     beginRequest();
@@ -51,6 +59,10 @@ int WebSocketClient::begin(const char* aPath)
         sendHeader("Connection", "Upgrade");
         sendHeader("Sec-WebSocket-Key", base64RandomKey);
         sendHeader("Sec-WebSocket-Version", "13");
+        if (aProtocol)
+        {
+            sendHeader("Sec-WebSocket-Protocol", aProtocol);
+        }
         endRequest();
 
         status = responseStatusCode();
@@ -81,6 +93,7 @@ int WebSocketClient::beginMessage(int aType)
     }
 
     iTxStarted = true;
+    iTxFragmented = false;
     iTxMessageType = (aType & 0xf);
     iTxSize = 0;
 
@@ -95,54 +108,100 @@ int WebSocketClient::endMessage()
         return 1;
     }
 
-    // send FIN + the message type (opcode)
-    HttpClient::write(0x80 | iTxMessageType);
+    int result = sendFrame(true);
+
+    iTxStarted = false;
+    iTxFragmented = false;
+
+    return result;
+}
+
+int WebSocketClient::sendFrame(bool aFinal)
+{
+    uint8_t header[WS_MAX_HEADER_SIZE];
+    size_t headerSize = 0;
+
+    // FIN flag + the message type (opcode), any fragment after
+    // the first one is sent as a continuation frame
+    header[headerSize++] = (aFinal ? 0x80 : 0x00) | (iTxFragmented ? TYPE_CONTINUATION : iTxMessageType);
 
     // the message is masked (0x80)
     // send the length
     if (iTxSize < 126)
     {
-        HttpClient::write(0x80 | (uint8_t)iTxSize);
+        header[headerSize++] = 0x80 | (uint8_t)iTxSize;
     }
-    else if (iTxSize < 0xffff)
+    else if (iTxSize <= 0xffff)
     {
-        HttpClient::write(0x80 | 126);
-        HttpClient::write((iTxSize >> 8) & 0xff);
-        HttpClient::write((iTxSize >> 0) & 0xff);
+        header[headerSize++] = 0x80 | 126;
+        header[headerSize++] = (iTxSize >> 8) & 0xff;
+        header[headerSize++] = (iTxSize >> 0) & 0xff;
     }
     else
     {
-        HttpClient::write(0x80 | 127);
-        HttpClient::write((iTxSize >> 56) & 0xff);
-        HttpClient::write((iTxSize >> 48) & 0xff);
-        HttpClient::write((iTxSize >> 40) & 0xff);
-        HttpClient::write((iTxSize >> 32) & 0xff);
-        HttpClient::write((iTxSize >> 24) & 0xff);
-        HttpClient::write((iTxSize >> 16) & 0xff);
-        HttpClient::write((iTxSize >> 8) & 0xff);
-        HttpClient::write((iTxSize >> 0) & 0xff);
+        header[headerSize++] = 0x80 | 127;
+        for (int shift = 56; shift >= 0; shift -= 8)
+        {
+            header[headerSize++] = (iTxSize >> shift) & 0xff;
+        }
     }
 
-    uint8_t maskKey[4];
-
-    // create a random mask for the data and send
-    for (int i = 0; i < (int)sizeof(maskKey); i++)
+    // create a random mask for the data
+    uint8_t* maskKey = header + headerSize;
+    for (int i = 0; i < 4; i++)
     {
-        maskKey[i] = random(0xff);
+        maskKey[i] = random(0x100);
     }
-    HttpClient::write(maskKey, sizeof(maskKey));
+    headerSize += 4;
 
-    // mask the data and send
-    for (int i = 0; i < (int)iTxSize; i++) {
-        iTxBuffer[i] ^= maskKey[i % sizeof(maskKey)];
-    }
+    uint8_t* payload = iTxBuffer + WS_MAX_HEADER_SIZE;
+    maskPayload(payload, iTxSize, maskKey);
 
-    size_t txSize = iTxSize;
+    // place the header directly in front of the payload,
+    // so header and payload leave in a single write
+    uint8_t* frame = payload - headerSize;
+    memcpy(frame, header, headerSize);
 
-    iTxStarted = false;
+    size_t frameSize = headerSize + iTxSize;
+
+    iTxFragmented = !aFinal;
     iTxSize = 0;
 
-    return (HttpClient::write(iTxBuffer, txSize) == txSize) ? 0 : 1;
+    return (HttpClient::write(frame, frameSize) == frameSize) ? 0 : 1;
+}
+
+void WebSocketClient::maskPayload(uint8_t* aData, size_t aSize, const uint8_t aMaskKey[4])
+{
+    size_t i = 0;
+
+    // mask single bytes until the data is word aligned
+    for (; i < aSize && (((uintptr_t)(aData + i)) & 0x3); i++)
+    {
+        aData[i] ^= aMaskKey[i & 0x3];
+    }
+
+    // rotate the key, so it lines up with the first aligned byte
+    uint8_t rotatedKey[4];
+    for (int k = 0; k < 4; k++)
+    {
+        rotatedKey[k] = aMaskKey[(i + k) & 0x3];
+    }
+    uint32_t maskWord;
+    memcpy(&maskWord, rotatedKey, sizeof(maskWord));
+
+    uint32_t* words = (uint32_t*)(aData + i);
+    size_t wordCount = (aSize - i) / sizeof(uint32_t);
+    for (size_t w = 0; w < wordCount; w++)
+    {
+        words[w] ^= maskWord;
+    }
+    i += wordCount * sizeof(uint32_t);
+
+    // mask the remaining tail bytes
+    for (; i < aSize; i++)
+    {
+        aData[i] ^= aMaskKey[i & 0x3];
+    }
 }
 
 size_t WebSocketClient::write(uint8_t aByte)
@@ -164,18 +223,33 @@ size_t WebSocketClient::write(const uint8_t *aBuffer, size_t aSize)
         return 0;
     }
 
-    // check if the write size, fits in the buffer
-    if ((iTxSize + aSize) > sizeof(iTxBuffer))
+    size_t written = 0;
+
+    while (written < aSize)
     {
-        aSize = sizeof(iTxSize) - iTxSize;
-    }
+        if (iTxSize == WS_TX_BUFFER_SIZE)
+        {
+            // buffer is full, send it as a non final fragment
+            if (sendFrame(false) != 0)
+            {
+                break;
+            }
+        }
 
-    // copy data into the buffer
-    memcpy(iTxBuffer + iTxSize, aBuffer, aSize);
+        size_t chunk = WS_TX_BUFFER_SIZE - iTxSize;
+        if (chunk > (aSize - written))
+        {
+            chunk = aSize - written;
+        }
+
+        // copy data into the buffer
+        memcpy(iTxBuffer + WS_MAX_HEADER_SIZE + iTxSize, aBuffer + written, chunk);
+
+        iTxSize += chunk;
+        written += chunk;
+    }
 
-    iTxSize += aSize;
-    
-    return aSize;
+    return written;
 }
 
 int WebSocketClient::parseMessage()
@@ -340,7 +414,7 @@ int WebSocketClient::read(uint8_t *aBuffer, size_t aSize)
         // unmask the RX data if needed
         if (iRxMasked)
         {
-            for (int i = 0; i < (int)aSize; i++, iRxMaskIndex++)
+            for (int i = 0; i < readCount; i++, iRxMaskIndex++)
             {
                 aBuffer[i] ^= iRxMaskKey[iRxMaskIndex % sizeof(iRxMaskKey)];
             }
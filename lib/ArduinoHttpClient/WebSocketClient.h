@@ -12,6 +12,10 @@
   #define WS_TX_BUFFER_SIZE 128
 #endif
 
+// Largest possible client frame header: 2 byte base header,
+// 8 byte extended payload length and 4 byte masking key
+#define WS_MAX_HEADER_SIZE 14
+
 static const int TYPE_CONTINUATION     = 0x0;
 static const int TYPE_TEXT             = 0x1;
 static const int TYPE_BINARY           = 0x2;
@@ -33,6 +37,13 @@ public:
     int begin(const char* aPath = "/");
     int begin(const String& aPath);
 
+    /** Start the Web Socket connection, asking for a subprotocol
+      @param aURLPath     Path to use in request
+      @param aProtocol    Sec-WebSocket-Protocol asked for, e.g. "mqtt", NULL for none
+      @return 0 if successful, else error
+     */
+    int begin(const char* aPath, const char* aProtocol);
+
     /** Begin to send a message of type (TYPE_TEXT or TYPE_BINARY)
         Use the write or Stream API's to set message content, followed by endMessage
         to complete the message.
@@ -42,6 +53,9 @@ public:
     int beginMessage(int aType);
 
     /** Completes sending of a message started by beginMessage
+        Messages bigger than WS_TX_BUFFER_SIZE are sent as a sequence of
+        fragments, each fragment is framed, masked and written to the
+        underlying client with a single write call
       @return 0 if successful, else error
     */
     int endMessage();
@@ -84,13 +98,29 @@ public:
     virtual int read(uint8_t *buf, size_t size);
     virtual int peek();
 
+    /** XORs the given data with the 4 byte masking key, a word at a time
+      @param aData        Data to mask in place
+      @param aSize        Amount of bytes to mask
+      @param aMaskKey     Masking key, aData[0] is masked with aMaskKey[0]
+    */
+    static void maskPayload(uint8_t* aData, size_t aSize, const uint8_t aMaskKey[4]);
+
 private:
     void flushRx();
 
+    /** Frames, masks and sends the currently buffered payload
+      @param aFinal       true if this is the last fragment of the message
+      @return 0 if successful, else error
+    */
+    int sendFrame(bool aFinal);
+
 private:
     bool iTxStarted;
+    bool iTxFragmented;
     uint8_t iTxMessageType;
-    uint8_t iTxBuffer[WS_TX_BUFFER_SIZE];
+    // Payload is buffered after WS_MAX_HEADER_SIZE bytes, so the frame
+    // header can be built in front of it and sent in one go
+    uint8_t iTxBuffer[WS_MAX_HEADER_SIZE + WS_TX_BUFFER_SIZE];
     uint64_t iTxSize;
 
     uint8_t iRxOpCode;
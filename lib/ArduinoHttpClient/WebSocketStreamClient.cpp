@@ -0,0 +1,341 @@
+// Byte stream over a WebSocket connection, e.g. MQTT over WebSocket
+// Released under Apache License, version 2.0
+
+#include "WebSocketStreamClient.h"
+
+WebSocketStreamClient::WebSocketStreamClient(Client& aClient, const char* aPath, const char* aProtocol)
+ : iClient(aClient),
+   iPath(aPath),
+   iProtocol(aProtocol),
+   iUpgraded(false),
+   iRxHeaderSize(0),
+   iRxHeaderNeeded(2),
+   iRxRemaining(0),
+   iRxHasFrame(false),
+   iControlSize(0),
+   iFramesSent(0),
+   iFramesReceived(0)
+{
+}
+
+int WebSocketStreamClient::upgrade(const char* aHost, uint16_t aPort)
+{
+    iUpgraded = false;
+    iRxHeaderSize = 0;
+    iRxHeaderNeeded = 2;
+    iRxRemaining = 0;
+    iRxHasFrame = false;
+
+    // Only the handshake goes through the WebSocketClient, it reuses the
+    // connected socket since the request keeps the connection alive
+    WebSocketClient handshake(iClient, aHost, aPort);
+    if (handshake.begin(iPath, iProtocol) != 0)
+    {
+        iClient.stop();
+        return 0;
+    }
+
+    iUpgraded = true;
+    return 1;
+}
+
+int WebSocketStreamClient::connect(IPAddress aIP, uint16_t aPort)
+{
+    if (!iClient.connected() && !iClient.connect(aIP, aPort))
+    {
+        return 0;
+    }
+    return upgrade(aIP.toString().c_str(), aPort);
+}
+
+int WebSocketStreamClient::connect(const char* aHost, uint16_t aPort)
+{
+    if (!iClient.connected() && !iClient.connect(aHost, aPort))
+    {
+        return 0;
+    }
+    return upgrade(aHost, aPort);
+}
+
+size_t WebSocketStreamClient::write(uint8_t aByte)
+{
+    return write(&aByte, sizeof(aByte));
+}
+
+size_t WebSocketStreamClient::write(const uint8_t* aBuffer, size_t aSize)
+{
+    if (!iUpgraded)
+    {
+        return 0;
+    }
+
+    for (size_t sent = 0; sent < aSize; )
+    {
+        size_t chunk = aSize - sent;
+        if (chunk > WS_STREAM_FRAME_SIZE)
+        {
+            chunk = WS_STREAM_FRAME_SIZE;
+        }
+        if (!sendFrame(TYPE_BINARY, aBuffer + sent, chunk))
+        {
+            return 0;
+        }
+        sent += chunk;
+    }
+
+    return aSize;
+}
+
+bool WebSocketStreamClient::sendFrame(uint8_t aOpCode, const uint8_t* aPayload, size_t aSize)
+{
+    uint8_t header[WS_MAX_HEADER_SIZE];
+    size_t headerSize = 0;
+
+    // Every frame is final, the stream has no message boundaries
+    header[headerSize++] = 0x80 | aOpCode;
+    if (aSize < 126)
+    {
+        header[headerSize++] = 0x80 | (uint8_t)aSize;
+    }
+    else
+    {
+        // WS_STREAM_FRAME_SIZE keeps frames below 64 KB
+        header[headerSize++] = 0x80 | 126;
+        header[headerSize++] = (aSize >> 8) & 0xff;
+        header[headerSize++] = (aSize >> 0) & 0xff;
+    }
+
+    uint8_t* maskKey = header + headerSize;
+    for (int i = 0; i < 4; i++)
+    {
+        maskKey[i] = random(0x100);
+    }
+    headerSize += 4;
+
+    // The payload is masked in place, behind room for the longest header
+    uint8_t* payload = iTxFrame + WS_MAX_HEADER_SIZE;
+    memcpy(payload, aPayload, aSize);
+    WebSocketClient::maskPayload(payload, aSize, maskKey);
+
+    uint8_t* frame = payload - headerSize;
+    memcpy(frame, header, headerSize);
+    size_t frameSize = headerSize + aSize;
+
+    if (iClient.write(frame, frameSize) != frameSize)
+    {
+        stop();
+        return false;
+    }
+    iFramesSent++;
+    return true;
+}
+
+bool WebSocketStreamClient::pollFrames()
+{
+    while (iUpgraded)
+    {
+        if (iRxHasFrame)
+        {
+            if ((iRxOpCode & 0x08) == 0)
+            {
+                // Text, binary and continuation frames all carry stream bytes
+                if (iRxRemaining > 0)
+                {
+                    return true;
+                }
+                iRxHasFrame = false;
+                continue;
+            }
+
+            // Control frames are short, collected as far as they arrived
+            while (iRxRemaining > 0)
+            {
+                int c = iClient.read();
+                if (c < 0)
+                {
+                    return false;
+                }
+                if (iRxMasked)
+                {
+                    c ^= iRxMaskKey[iRxMaskIndex++ & 0x3];
+                }
+                iControl[iControlSize++] = c;
+                iRxRemaining--;
+            }
+            iRxHasFrame = false;
+            handleControl();
+            continue;
+        }
+
+        while (iRxHeaderSize < iRxHeaderNeeded)
+        {
+            int c = iClient.read();
+            if (c < 0)
+            {
+                return false;
+            }
+            iRxHeader[iRxHeaderSize++] = c;
+            if (iRxHeaderSize == 2)
+            {
+                // The second byte tells how long the header is
+                uint8_t length = iRxHeader[1] & 0x7f;
+                iRxHeaderNeeded = 2 + ((length == 126) ? 2 : (length == 127) ? 8 : 0) + ((iRxHeader[1] & 0x80) ? 4 : 0);
+            }
+        }
+
+        iRxOpCode = iRxHeader[0] & 0x0f;
+        iRxMasked = (iRxHeader[1] & 0x80) != 0;
+        uint8_t length = iRxHeader[1] & 0x7f;
+        size_t pos = 2;
+        if (length == 126)
+        {
+            iRxRemaining = ((uint16_t)iRxHeader[2] << 8) | iRxHeader[3];
+            pos = 4;
+        }
+        else if (length == 127)
+        {
+            iRxRemaining = 0;
+            for (int i = 0; i < 8; i++)
+            {
+                iRxRemaining = (iRxRemaining << 8) | iRxHeader[2 + i];
+            }
+            pos = 10;
+        }
+        else
+        {
+            iRxRemaining = length;
+        }
+        if (iRxMasked)
+        {
+            memcpy(iRxMaskKey, iRxHeader + pos, sizeof(iRxMaskKey));
+        }
+        iRxMaskIndex = 0;
+        iRxHeaderSize = 0;
+        iRxHeaderNeeded = 2;
+        iRxHasFrame = true;
+        iControlSize = 0;
+        iFramesReceived++;
+
+        if ((iRxOpCode & 0x08) && iRxRemaining > WS_MAX_CONTROL_SIZE)
+        {
+            // Protocol error, control frames are never this long
+            stop();
+            return false;
+        }
+    }
+
+    return false;
+}
+
+void WebSocketStreamClient::handleControl()
+{
+    if (iRxOpCode == TYPE_PING)
+    {
+        sendFrame(TYPE_PONG, iControl, iControlSize);
+    }
+    else if (iRxOpCode == TYPE_CONNECTION_CLOSE)
+    {
+        // Echo the status code, then the connection is over
+        sendFrame(TYPE_CONNECTION_CLOSE, iControl, iControlSize < 2 ? iControlSize : 2);
+        stop();
+    }
+}
+
+int WebSocketStreamClient::available()
+{
+    if (!pollFrames())
+    {
+        return 0;
+    }
+
+    int buffered = iClient.available();
+    if (buffered < 0)
+    {
+        return 0;
+    }
+    return ((uint64_t)buffered < iRxRemaining) ? buffered : (int)iRxRemaining;
+}
+
+int WebSocketStreamClient::read()
+{
+    uint8_t b;
+
+    if (read(&b, sizeof(b)) == 1)
+    {
+        return b;
+    }
+
+    return -1;
+}
+
+int WebSocketStreamClient::read(uint8_t* aBuffer, size_t aSize)
+{
+    if (!pollFrames())
+    {
+        return -1;
+    }
+
+    if (aSize > iRxRemaining)
+    {
+        aSize = iRxRemaining;
+    }
+    int readCount = iClient.read(aBuffer, aSize);
+
+    if (readCount > 0)
+    {
+        iRxRemaining -= readCount;
+
+        if (iRxMasked)
+        {
+            for (int i = 0; i < readCount; i++)
+            {
+                aBuffer[i] ^= iRxMaskKey[iRxMaskIndex++ & 0x3];
+            }
+        }
+    }
+
+    return readCount;
+}
+
+int WebSocketStreamClient::peek()
+{
+    if (!pollFrames())
+    {
+        return -1;
+    }
+
+    int p = iClient.peek();
+    if (p >= 0 && iRxMasked)
+    {
+        p = (uint8_t)p ^ iRxMaskKey[iRxMaskIndex & 0x3];
+    }
+    return p;
+}
+
+void WebSocketStreamClient::flush()
+{
+    iClient.flush();
+}
+
+void WebSocketStreamClient::stop()
+{
+    iClient.stop();
+    iUpgraded = false;
+    iRxHasFrame = false;
+    iRxHeaderSize = 0;
+    iRxHeaderNeeded = 2;
+}
+
+uint8_t WebSocketStreamClient::connected()
+{
+    if (iUpgraded && !iClient.connected())
+    {
+        iUpgraded = false;
+    }
+    return iUpgraded;
+}
+
+WebSocketStreamClient::operator bool()
+{
+    return connected();
+}
@@ -0,0 +1,123 @@
+// Byte stream over a WebSocket connection, e.g. MQTT over WebSocket
+// Released under Apache License, version 2.0
+
+#ifndef WebSocketStreamClient_h
+#define WebSocketStreamClient_h
+
+#include <Arduino.h>
+#include <IPAddress.h>
+#include "Client.h"
+
+#include "WebSocketClient.h"
+
+// Largest payload of a sent frame, a bigger write is split into several
+// frames. Header and payload of a frame leave in one write to the socket
+#ifndef WS_STREAM_FRAME_SIZE
+  #define WS_STREAM_FRAME_SIZE 1422
+#endif
+
+// Largest payload of a control frame (RFC 6455 5.5)
+#define WS_MAX_CONTROL_SIZE 125
+
+/** A Client whose bytes travel in binary WebSocket messages, so a protocol
+    written against Client (PubSubClient) runs over a WebSocket endpoint
+    unchanged, as in MQTT over WebSocket: the bytes of every write() are sent
+    as one binary frame, received data frames are read back as one stream
+    regardless of how the server split them. Pings are answered, a close
+    frame ends the connection.
+
+    The upgrade asks for the aProtocol subprotocol ("mqtt"). Nothing in here
+    blocks once upgraded: frame headers that arrived partially are kept until
+    the rest comes in.
+*/
+class WebSocketStreamClient : public Client
+{
+public:
+    /**
+      @param aClient      Socket the WebSocket runs over
+      @param aPath        Path of the WebSocket endpoint
+      @param aProtocol    Subprotocol asked for, NULL for none
+    */
+    WebSocketStreamClient(Client& aClient, const char* aPath = "/mqtt", const char* aProtocol = "mqtt");
+
+    /** Upgrades a socket that is already connected, e.g. one connected by
+        the caller with its own socket options
+      @param aHost        Host header, the name the server is known by
+      @return 1 if the server accepted the upgrade, else 0
+    */
+    int upgrade(const char* aHost, uint16_t aPort);
+
+    /** Connects the socket unless it is connected, then upgrades it
+      @return 1 if successful, else 0
+    */
+    virtual int connect(IPAddress aIP, uint16_t aPort);
+    virtual int connect(const char* aHost, uint16_t aPort);
+
+    virtual size_t write(uint8_t aByte);
+    /** Sends the data in binary frames of at most WS_STREAM_FRAME_SIZE bytes
+      @return aSize if every frame was written, else 0
+    */
+    virtual size_t write(const uint8_t* aBuffer, size_t aSize);
+
+    /** Payload bytes of data frames that can be read now
+    */
+    virtual int available();
+    virtual int read();
+    virtual int read(uint8_t* aBuffer, size_t aSize);
+    virtual int peek();
+    virtual void flush();
+    virtual void stop();
+    virtual uint8_t connected();
+    virtual operator bool();
+
+    /** Frames sent and received since construction, for benchmarks
+    */
+    uint32_t framesSent() const { return iFramesSent; }
+    uint32_t framesReceived() const { return iFramesReceived; }
+
+private:
+    /** Consumes frame headers and control frames until payload of a data
+        frame is next
+      @return true if payload of a data frame is next, false if more has to
+              arrive first or the connection was closed
+    */
+    bool pollFrames();
+
+    /** Handles the control frame whose payload was read completely
+    */
+    void handleControl();
+
+    /** Frames, masks and writes one frame
+      @return true if the whole frame was written
+    */
+    bool sendFrame(uint8_t aOpCode, const uint8_t* aPayload, size_t aSize);
+
+private:
+    Client& iClient;
+    const char* iPath;
+    const char* iProtocol;
+    bool iUpgraded;
+
+    uint8_t iTxFrame[WS_MAX_HEADER_SIZE + WS_STREAM_FRAME_SIZE];
+
+    // Header of the frame being received, up to its mask key
+    uint8_t iRxHeader[WS_MAX_HEADER_SIZE];
+    uint8_t iRxHeaderSize;
+    uint8_t iRxHeaderNeeded;
+    uint8_t iRxOpCode;
+    bool iRxMasked;
+    uint8_t iRxMaskKey[4];
+    uint8_t iRxMaskIndex;
+    // Payload bytes of the current frame not read yet
+    uint64_t iRxRemaining;
+    bool iRxHasFrame;
+
+    // Payload of the control frame being received
+    uint8_t iControl[WS_MAX_CONTROL_SIZE];
+    uint8_t iControlSize;
+
+    uint32_t iFramesSent;
+    uint32_t iFramesReceived;
+};
+
+#endif
@@ -160,6 +160,9 @@ PubSubClient::PubSubClient(const char* domain, uint16_t port, MQTT_CALLBACK_SIGN
 
 PubSubClient::~PubSubClient() {
   free(this->buffer);
+  free(this->outBuffer);
+  free(this->pendingAliasTopic);
+  clearTopicAliases();
 }
 
 boolean PubSubClient::connect(const char *id) {
@@ -180,107 +183,270 @@ boolean PubSubClient::connect(const char *id, const char *user, const char *pass
 
 boolean PubSubClient::connect(const char *id, const char *user, const char *pass, const char* willTopic, uint8_t willQos, boolean willRetain, const char* willMessage, boolean cleanSession) {
     if (!connected()) {
-        int result = 0;
+        // A socket opened by the caller carries its options, PubSubClient must not replace it
+        boolean ownSocket = !_client->connected();
+        this->_version = this->versionFallback ? MQTT_VERSION_3_1_1 : this->requestedVersion;
+        if (connectWithVersion(id,user,pass,willTopic,willQos,willRetain,willMessage,cleanSession)) {
+            return true;
+        }
+        if (this->_version == MQTT_VERSION_5 && this->_state == MQTT_CONNECT_BAD_PROTOCOL) {
+            // The broker only speaks 3.1.1
+            this->versionFallback = true;
+            if (ownSocket) {
+                this->_version = MQTT_VERSION_3_1_1;
+                return connectWithVersion(id,user,pass,willTopic,willQos,willRetain,willMessage,cleanSession);
+            }
+        }
+        return false;
+    }
+    return true;
+}
+
+boolean PubSubClient::connectWithVersion(const char *id, const char *user, const char *pass, const char* willTopic, uint8_t willQos, boolean willRetain, const char* willMessage, boolean cleanSession) {
+    int result = 0;
 
 
-        if(_client->connected()) {
-            result = 1;
+    if(_client->connected()) {
+        result = 1;
+    } else {
+        if (domain != NULL) {
+            result = _client->connect(this->domain, this->port);
         } else {
-            if (domain != NULL) {
-                result = _client->connect(this->domain, this->port);
-            } else {
-                result = _client->connect(this->ip, this->port);
-            }
+            result = _client->connect(this->ip, this->port);
         }
+    }
 
-        if (result == 1) {
-            nextMsgId = 1;
-            // Leave room in the buffer for header and variable length field
-            uint16_t length = MQTT_MAX_HEADER_SIZE;
-            unsigned int j;
-
-#if MQTT_VERSION == MQTT_VERSION_3_1
-            uint8_t d[9] = {0x00,0x06,'M','Q','I','s','d','p', MQTT_VERSION};
-#define MQTT_HEADER_VERSION_LENGTH 9
-#elif MQTT_VERSION == MQTT_VERSION_3_1_1
-            uint8_t d[7] = {0x00,0x04,'M','Q','T','T',MQTT_VERSION};
-#define MQTT_HEADER_VERSION_LENGTH 7
-#endif
-            for (j = 0;j<MQTT_HEADER_VERSION_LENGTH;j++) {
-                this->buffer[length++] = d[j];
-            }
+    if (result == 1) {
+        nextMsgId = 1;
+        // Nothing of a publish cut short on the previous connection is sent on this one
+        this->outLength = 0;
+        this->outError = false;
+        // Leave room in the buffer for header and variable length field
+        uint16_t length = MQTT_MAX_HEADER_SIZE;
+        unsigned int j;
 
-            uint8_t v;
-            if (willTopic) {
-                v = 0x04|(willQos<<3)|(willRetain<<5);
-            } else {
-                v = 0x00;
+        if (this->_version == MQTT_VERSION_3_1) {
+            uint8_t d[9] = {0x00,0x06,'M','Q','I','s','d','p', MQTT_VERSION_3_1};
+            for (j = 0;j<9;j++) {
+                this->buffer[length++] = d[j];
             }
-            if (cleanSession) {
-                v = v|0x02;
+        } else {
+            uint8_t d[7] = {0x00,0x04,'M','Q','T','T',this->_version};
+            for (j = 0;j<7;j++) {
+                this->buffer[length++] = d[j];
             }
+        }
 
-            if(user != NULL) {
-                v = v|0x80;
+        uint8_t v;
+        if (willTopic) {
+            v = 0x04|(willQos<<3)|(willRetain<<5);
+        } else {
+            v = 0x00;
+        }
+        if (cleanSession) {
+            v = v|0x02;
+        }
 
-                if(pass != NULL) {
-                    v = v|(0x80>>1);
-                }
+        if(user != NULL) {
+            v = v|0x80;
+
+            if(pass != NULL) {
+                v = v|(0x80>>1);
             }
-            this->buffer[length++] = v;
-
-            this->buffer[length++] = ((this->keepAlive) >> 8);
-            this->buffer[length++] = ((this->keepAlive) & 0xFF);
-
-            CHECK_STRING_LENGTH(length,id)
-            length = writeString(id,this->buffer,length);
-            if (willTopic) {
-                CHECK_STRING_LENGTH(length,willTopic)
-                length = writeString(willTopic,this->buffer,length);
-                CHECK_STRING_LENGTH(length,willMessage)
-                length = writeString(willMessage,this->buffer,length);
+        }
+        this->buffer[length++] = v;
+
+        this->buffer[length++] = ((this->keepAlive) >> 8);
+        this->buffer[length++] = ((this->keepAlive) & 0xFF);
+
+        if (this->_version == MQTT_VERSION_5) {
+            // Broker must not send packets bigger than the receive buffer
+            this->buffer[length++] = 5;
+            this->buffer[length++] = MQTTPROP_MAX_PACKET_SIZE;
+            this->buffer[length++] = 0;
+            this->buffer[length++] = 0;
+            this->buffer[length++] = (this->bufferSize >> 8);
+            this->buffer[length++] = (this->bufferSize & 0xFF);
+        }
+
+        CHECK_STRING_LENGTH(length,id)
+        length = writeString(id,this->buffer,length);
+        if (willTopic) {
+            if (this->_version == MQTT_VERSION_5) {
+                // No will properties
+                this->buffer[length++] = 0;
             }
+            CHECK_STRING_LENGTH(length,willTopic)
+            length = writeString(willTopic,this->buffer,length);
+            CHECK_STRING_LENGTH(length,willMessage)
+            length = writeString(willMessage,this->buffer,length);
+        }
 
-            if(user != NULL) {
-                CHECK_STRING_LENGTH(length,user)
-                length = writeString(user,this->buffer,length);
-                if(pass != NULL) {
-                    CHECK_STRING_LENGTH(length,pass)
-                    length = writeString(pass,this->buffer,length);
-                }
+        if(user != NULL) {
+            CHECK_STRING_LENGTH(length,user)
+            length = writeString(user,this->buffer,length);
+            if(pass != NULL) {
+                CHECK_STRING_LENGTH(length,pass)
+                length = writeString(pass,this->buffer,length);
             }
+        }
 
-            write(MQTTCONNECT,this->buffer,length-MQTT_MAX_HEADER_SIZE);
+        write(MQTTCONNECT,this->buffer,length-MQTT_MAX_HEADER_SIZE);
 
-            lastInActivity = lastOutActivity = millis();
+        lastInActivity = lastOutActivity = millis();
 
-            while (!_client->available()) {
-                unsigned long t = millis();
-                if (t-lastInActivity >= ((int32_t) this->socketTimeout*1000UL)) {
-                    _state = MQTT_CONNECTION_TIMEOUT;
-                    _client->stop();
-                    return false;
-                }
+        while (!_client->available()) {
+            unsigned long t = millis();
+            if (t-lastInActivity >= ((int32_t) this->socketTimeout*1000UL)) {
+                _state = MQTT_CONNECTION_TIMEOUT;
+                _client->stop();
+                return false;
             }
-            uint8_t llen;
-            uint32_t len = readPacket(&llen);
-
-            if (len == 4) {
-                if (buffer[3] == 0) {
+        }
+        uint8_t llen;
+        uint32_t len = readPacket(&llen);
+
+        // A 3.1.1 broker answers an MQTT 5 CONNECT with a 3.1.1 CONNACK
+        if (len >= 4 && (this->buffer[0]&0xF0) == MQTTCONNACK) {
+            this->reasonCode = this->buffer[llen+2];
+            if (this->reasonCode == 0) {
+                this->inflight = 0;
+                this->pendingSubscribes = 0;
+                this->ackMsgId = 0;
+                this->maxQos = 1;
+                this->sendQuota = MQTT_MAX_INFLIGHT;
+                this->topicAliasMax = 0;
+                this->maxPacketSize = 0;
+                this->sessionKeepAlive = this->keepAlive;
+                clearTopicAliases();
+                if (this->_version != MQTT_VERSION_5 || readConnackProperties(llen+3, len)) {
                     lastInActivity = millis();
                     pingOutstanding = false;
                     _state = MQTT_CONNECTED;
                     return true;
-                } else {
-                    _state = buffer[3];
+                }
+                _state = MQTT_CONNECT_FAILED;
+            } else if (this->reasonCode < 0x80) {
+                _state = this->reasonCode;
+            } else {
+                // MQTT 5 reason codes mapped onto the 3.1.1 states
+                switch (this->reasonCode) {
+                case MQTT_REASON_UNSUPPORTED_VERSION: _state = MQTT_CONNECT_BAD_PROTOCOL; break;
+                case 0x85: _state = MQTT_CONNECT_BAD_CLIENT_ID; break;
+                case 0x86: _state = MQTT_CONNECT_BAD_CREDENTIALS; break;
+                case 0x87: _state = MQTT_CONNECT_UNAUTHORIZED; break;
+                case 0x88:
+                case 0x89: _state = MQTT_CONNECT_UNAVAILABLE; break;
+                default: _state = MQTT_CONNECT_FAILED; break;
                 }
             }
-            _client->stop();
-        } else {
-            _state = MQTT_CONNECT_FAILED;
         }
+        _client->stop();
+    } else {
+        _state = MQTT_CONNECT_FAILED;
+    }
+    return false;
+}
+
+boolean PubSubClient::readConnackProperties(uint16_t pos, uint16_t end) {
+    uint32_t length;
+    if (!readVarInt(&pos, end, &length) || pos + length > end) {
         return false;
     }
+    end = pos + length;
+    // Defaults of the properties the broker leaves out
+    this->sendQuota = MQTT_MAX_INFLIGHT;
+    while (pos < end) {
+        uint8_t id;
+        uint32_t value;
+        if (!readProperty(&pos, end, &id, &value)) {
+            return false;
+        }
+        if (id == MQTTPROP_RECEIVE_MAXIMUM && value > 0 && value < this->sendQuota) {
+            this->sendQuota = value;
+        } else if (id == MQTTPROP_TOPIC_ALIAS_MAX) {
+            this->topicAliasMax = value;
+        } else if (id == MQTTPROP_MAXIMUM_QOS) {
+            this->maxQos = value;
+        } else if (id == MQTTPROP_MAX_PACKET_SIZE) {
+            this->maxPacketSize = value;
+        } else if (id == MQTTPROP_SERVER_KEEP_ALIVE) {
+            this->sessionKeepAlive = value;
+        }
+    }
+    return true;
+}
+
+uint16_t PubSubClient::writeVarInt(uint32_t value, uint8_t* buf, uint16_t pos) {
+    do {
+        uint8_t digit = value & 127;
+        value >>= 7;
+        if (value > 0) {
+            digit |= 0x80;
+        }
+        buf[pos++] = digit;
+    } while (value > 0);
+    return pos;
+}
+
+boolean PubSubClient::readVarInt(uint16_t* pos, uint16_t end, uint32_t* value) {
+    uint32_t multiplier = 1;
+    *value = 0;
+    for (int i = 0; i < 4 && *pos < end; i++) {
+        uint8_t digit = this->buffer[(*pos)++];
+        *value += (digit & 127) * multiplier;
+        if ((digit & 128) == 0) {
+            return true;
+        }
+        multiplier <<= 7;
+    }
+    return false;
+}
+
+boolean PubSubClient::readProperty(uint16_t* pos, uint16_t end, uint8_t* id, uint32_t* value) {
+    if (*pos >= end) {
+        return false;
+    }
+    *id = this->buffer[(*pos)++];
+    *value = 0;
+    uint32_t size;
+    switch (*id) {
+    case 0x01: case 0x17: case 0x19: case 0x24: case 0x25: case 0x28: case 0x29: case 0x2A:
+        size = 1;
+        break;
+    case 0x13: case 0x21: case 0x22: case 0x23:
+        size = 2;
+        break;
+    case 0x02: case 0x11: case 0x18: case 0x27:
+        size = 4;
+        break;
+    case 0x0B:
+        return readVarInt(pos, end, value);
+    case 0x03: case 0x08: case 0x09: case 0x12: case 0x15: case 0x16: case 0x1A: case 0x1C: case 0x1F:
+        // String or binary data, skipped
+        if (*pos + 2 > end) {
+            return false;
+        }
+        *pos += 2 + ((this->buffer[*pos]<<8) | this->buffer[*pos+1]);
+        return *pos <= end;
+    case MQTTPROP_USER_PROPERTY:
+        // Key and value strings, skipped
+        for (int i = 0; i < 2; i++) {
+            if (*pos + 2 > end) {
+                return false;
+            }
+            *pos += 2 + ((this->buffer[*pos]<<8) | this->buffer[*pos+1]);
+        }
+        return *pos <= end;
+    default:
+        return false;
+    }
+    if (*pos + size > end) {
+        return false;
+    }
+    for (uint32_t i = 0; i < size; i++) {
+        *value = (*value << 8) | this->buffer[(*pos)++];
+    }
     return true;
 }
 
@@ -370,19 +536,25 @@ uint32_t PubSubClient::readPacket(uint8_t* lengthLength) {
 boolean PubSubClient::loop() {
     if (connected()) {
         unsigned long t = millis();
-        if ((t - lastInActivity > this->keepAlive*1000UL) || (t - lastOutActivity > this->keepAlive*1000UL)) {
-            if (pingOutstanding) {
+        unsigned long idle = (t - lastInActivity < t - lastOutActivity) ? t - lastInActivity : t - lastOutActivity;
+        if (pingOutstanding) {
+            // A long keep alive must not delay noticing a dead connection, the
+            // answer is expected within the socket timeout
+            if (t - pingSentAt > this->socketTimeout*1000UL) {
                 this->_state = MQTT_CONNECTION_TIMEOUT;
                 _client->stop();
                 return false;
-            } else {
-                this->buffer[0] = MQTTPINGREQ;
-                this->buffer[1] = 0;
-                _client->write(this->buffer,2);
-                lastOutActivity = t;
-                lastInActivity = t;
-                pingOutstanding = true;
             }
+        } else if ((t - lastInActivity > this->sessionKeepAlive*1000UL) || (t - lastOutActivity > this->sessionKeepAlive*1000UL) ||
+                   (this->pingInterval > 0 && idle >= this->pingInterval*1000UL)) {
+            this->buffer[0] = MQTTPINGREQ;
+            this->buffer[1] = 0;
+            _client->write(this->buffer,2);
+            lastOutActivity = t;
+            lastInActivity = t;
+            pingSentAt = t;
+            pendingPingIdle = idle;
+            pingOutstanding = true;
         }
         if (_client->available()) {
             uint8_t llen;
@@ -398,11 +570,23 @@ boolean PubSubClient::loop() {
                         memmove(this->buffer+llen+2,this->buffer+llen+3,tl); /* move topic inside buffer 1 byte to front */
                         this->buffer[llen+2+tl] = 0; /* end the topic as a 'C' string with \x00 */
                         char *topic = (char*) this->buffer+llen+2;
+                        uint16_t pos = llen+3+tl;
                         // msgId only present for QOS>0
                         if ((this->buffer[0]&0x06) == MQTTQOS1) {
-                            msgId = (this->buffer[llen+3+tl]<<8)+this->buffer[llen+3+tl+1];
-                            payload = this->buffer+llen+3+tl+2;
-                            callback(topic,payload,len-llen-3-tl-2);
+                            msgId = (this->buffer[pos]<<8)+this->buffer[pos+1];
+                            pos += 2;
+                        }
+                        if (this->_version == MQTT_VERSION_5) {
+                            // Properties are not passed on, skip them
+                            uint32_t propLength;
+                            if (!readVarInt(&pos, len, &propLength) || pos + propLength > len) {
+                                return true;
+                            }
+                            pos += propLength;
+                        }
+                        payload = this->buffer+pos;
+                        if ((this->buffer[0]&0x06) == MQTTQOS1) {
+                            callback(topic,payload,len-pos);
 
                             this->buffer[0] = MQTTPUBACK;
                             this->buffer[1] = 2;
@@ -412,16 +596,46 @@ boolean PubSubClient::loop() {
                             lastOutActivity = t;
 
                         } else {
-                            payload = this->buffer+llen+3+tl;
-                            callback(topic,payload,len-llen-3-tl);
+                            callback(topic,payload,len-pos);
                         }
                     }
+                } else if (type == MQTTPUBACK) {
+                    if (this->inflight > 0) {
+                        this->inflight--;
+                    }
+                    msgId = (this->buffer[llen+1]<<8)+this->buffer[llen+2];
+                    if (this->ackMsgId != 0 && msgId == this->ackMsgId) {
+                        this->ackRtt = millis() - this->ackSentAt;
+                        this->ackCount++;
+                        this->ackMsgId = 0;
+                    }
+                    // MQTT 5 leaves out the reason code on success
+                    this->reasonCode = (len > llen+3U) ? this->buffer[llen+3] : 0;
+                    if (ackCallback) {
+                        ackCallback(msgId, this->reasonCode);
+                    }
+                } else if (type == MQTTSUBACK) {
+                    if (this->pendingSubscribes > 0) {
+                        this->pendingSubscribes--;
+                    }
+                    // Granted QoS or failure code of the (only) topic filter comes last
+                    this->reasonCode = this->buffer[len-1];
+                } else if (type == MQTTDISCONNECT) {
+                    // MQTT 5 broker closing the connection, e.g. for a protocol error
+                    this->reasonCode = (len > llen+1U) ? this->buffer[llen+1] : 0;
+                    this->_state = MQTT_CONNECTION_LOST;
+                    _client->stop();
+                    return false;
                 } else if (type == MQTTPINGREQ) {
                     this->buffer[0] = MQTTPINGRESP;
                     this->buffer[1] = 0;
                     _client->write(this->buffer,2);
                 } else if (type == MQTTPINGRESP) {
                     pingOutstanding = false;
+                    this->ackRtt = millis() - pingSentAt;
+                    this->ackCount++;
+                    this->pingIdle = pendingPingIdle;
+                    this->pingCount++;
                 }
             } else if (!connected()) {
                 // readPacket has closed the connection
@@ -446,14 +660,17 @@ boolean PubSubClient::publish(const char* topic, const uint8_t* payload, unsigne
 }
 
 boolean PubSubClient::publish(const char* topic, const uint8_t* payload, unsigned int plength, boolean retained) {
+    return publish(topic, payload, plength, retained, MQTTPublishOptions());
+}
+
+boolean PubSubClient::publish(const char* topic, const uint8_t* payload, unsigned int plength, boolean retained, const MQTTPublishOptions& options) {
     if (connected()) {
-        if (this->bufferSize < MQTT_MAX_HEADER_SIZE + 2+strnlen(topic, this->bufferSize) + plength) {
+        uint8_t header;
+        uint16_t length = preparePublish(topic, retained, options, plength, plength, &header);
+        if (length == 0) {
             // Too long
             return false;
         }
-        // Leave room in the buffer for header and variable length field
-        uint16_t length = MQTT_MAX_HEADER_SIZE;
-        length = writeString(topic,this->buffer,length);
 
         // Add payload
         uint16_t i;
@@ -461,12 +678,9 @@ boolean PubSubClient::publish(const char* topic, const uint8_t* payload, unsigne
             this->buffer[length++] = payload[i];
         }
 
-        // Write the header
-        uint8_t header = MQTTPUBLISH;
-        if (retained) {
-            header |= 1;
-        }
-        return write(header,this->buffer,length-MQTT_MAX_HEADER_SIZE);
+        boolean sent = write(header,this->buffer,length-MQTT_MAX_HEADER_SIZE);
+        finishPublish(sent);
+        return sent;
     }
     return false;
 }
@@ -476,90 +690,313 @@ boolean PubSubClient::publish_P(const char* topic, const char* payload, boolean
 }
 
 boolean PubSubClient::publish_P(const char* topic, const uint8_t* payload, unsigned int plength, boolean retained) {
-    uint8_t llen = 0;
-    uint8_t digit;
+    return publish_P(topic, payload, plength, retained, MQTTPublishOptions());
+}
+
+boolean PubSubClient::publish_P(const char* topic, const uint8_t* payload, unsigned int plength, boolean retained, const MQTTPublishOptions& options) {
     unsigned int rc = 0;
-    uint16_t tlen;
-    unsigned int pos = 0;
     unsigned int i;
     uint8_t header;
-    unsigned int len;
-    int expectedLength;
+    unsigned int expectedLength;
 
     if (!connected()) {
         return false;
     }
 
-    tlen = strnlen(topic, this->bufferSize);
-
-    header = MQTTPUBLISH;
-    if (retained) {
-        header |= 1;
+    uint16_t length = preparePublish(topic, retained, options, plength, 0, &header);
+    if (length == 0) {
+        return false;
     }
-    this->buffer[pos++] = header;
-    len = plength + 2 + tlen;
-    do {
-        digit = len  & 127; //digit = len %128
-        len >>= 7; //len = len / 128
-        if (len > 0) {
-            digit |= 0x80;
-        }
-        this->buffer[pos++] = digit;
-        llen++;
-    } while(len>0);
-
-    pos = writeString(topic,this->buffer,pos);
-
-    rc += _client->write(this->buffer,pos);
-
-    for (i=0;i<plength;i++) {
-        rc += _client->write((char)pgm_read_byte_near(payload + i));
+    size_t hlen = buildHeader(header, this->buffer, length-MQTT_MAX_HEADER_SIZE+plength);
+    unsigned int pos = length-(MQTT_MAX_HEADER_SIZE-hlen);
+
+    // Header, topic and payload are combined into as few writes as possible
+    this->outError = false;
+    rc += bufferedWrite(this->buffer+(MQTT_MAX_HEADER_SIZE-hlen),pos);
+
+    uint8_t chunk[64];
+    for (i=0;i<plength;i+=sizeof(chunk)) {
+        unsigned int n = (plength-i < sizeof(chunk)) ? plength-i : sizeof(chunk);
+        memcpy_P(chunk, payload + i, n);
+        rc += bufferedWrite(chunk,n);
     }
-
-    lastOutActivity = millis();
-
-    expectedLength = 1 + llen + 2 + tlen + plength;
-
-    return (rc == expectedLength);
+    expectedLength = pos + plength;
+    boolean sent = endWrites() && rc == expectedLength;
+    finishPublish(sent);
+    if (sent) {
+        lastOutActivity = millis();
+    }
+    return sent;
 }
 
 boolean PubSubClient::beginPublish(const char* topic, unsigned int plength, boolean retained) {
+    return beginPublish(topic, plength, retained, MQTTPublishOptions());
+}
+
+boolean PubSubClient::beginPublish(const char* topic, unsigned int plength, boolean retained, const MQTTPublishOptions& options) {
     if (connected()) {
         // Send the header and variable length field
-        uint16_t length = MQTT_MAX_HEADER_SIZE;
-        length = writeString(topic,this->buffer,length);
-        uint8_t header = MQTTPUBLISH;
-        if (retained) {
-            header |= 1;
+        uint8_t header;
+        uint16_t length = preparePublish(topic, retained, options, plength, 0, &header);
+        if (length == 0) {
+            return false;
         }
         size_t hlen = buildHeader(header, this->buffer, plength+length-MQTT_MAX_HEADER_SIZE);
-        uint16_t rc = _client->write(this->buffer+(MQTT_MAX_HEADER_SIZE-hlen),length-(MQTT_MAX_HEADER_SIZE-hlen));
+        // Only buffered, the header leaves together with the first payload bytes
+        this->outError = false;
+        uint16_t rc = bufferedWrite(this->buffer+(MQTT_MAX_HEADER_SIZE-hlen),length-(MQTT_MAX_HEADER_SIZE-hlen));
         lastOutActivity = millis();
-        return (rc == (length-(MQTT_MAX_HEADER_SIZE-hlen)));
+        if (rc != (length-(MQTT_MAX_HEADER_SIZE-hlen))) {
+            finishPublish(false);
+            return false;
+        }
+        return true;
     }
     return false;
 }
 
 int PubSubClient::endPublish() {
- return 1;
+    // Sends what is left of the message, fails if any part of it could not be sent
+    boolean sent = endWrites();
+    finishPublish(sent);
+    return sent ? 1 : 0;
 }
 
 size_t PubSubClient::write(uint8_t data) {
     lastOutActivity = millis();
-    return _client->write(data);
+    return bufferedWrite(&data,1);
 }
 
 size_t PubSubClient::write(const uint8_t *buffer, size_t size) {
     lastOutActivity = millis();
-    return _client->write(buffer,size);
+    return bufferedWrite(buffer,size);
+}
+
+size_t PubSubClient::bufferedWrite(const uint8_t* data, size_t size) {
+    if (this->outError) {
+        // Part of the message is lost already, the rest would corrupt the stream
+        return 0;
+    }
+#if MQTT_WRITE_BUFFER_SIZE > 0
+    if (this->outBuffer == NULL) {
+        this->outBuffer = (uint8_t*)malloc(MQTT_WRITE_BUFFER_SIZE);
+    }
+    if (this->outBuffer != NULL) {
+        size_t written = 0;
+        while (written < size) {
+            size_t n = size - written;
+            if (n > (size_t)(MQTT_WRITE_BUFFER_SIZE - this->outLength)) {
+                n = MQTT_WRITE_BUFFER_SIZE - this->outLength;
+            }
+            memcpy(this->outBuffer + this->outLength, data + written, n);
+            this->outLength += n;
+            written += n;
+            // A full buffer is a full segment, send it right away. Bytes of this
+            // call that did not make it out are not reported as written
+            if (this->outLength == MQTT_WRITE_BUFFER_SIZE) {
+                uint16_t unsent = sendWrites();
+                if (unsent > 0) {
+                    written -= (unsent < n) ? unsent : n;
+                    break;
+                }
+            }
+        }
+        return written;
+    }
+#endif
+    size_t rc = _client->write(data,size);
+    if (rc != size) {
+        this->outError = true;
+    }
+    return rc;
+}
+
+uint16_t PubSubClient::sendWrites() {
+    uint16_t unsent = 0;
+    if (this->outLength > 0) {
+        size_t rc = _client->write(this->outBuffer,this->outLength);
+        if (rc != this->outLength) {
+            this->outError = true;
+            unsent = this->outLength - ((rc < this->outLength) ? rc : this->outLength);
+        }
+        this->outLength = 0;
+    }
+    return unsent;
+}
+
+boolean PubSubClient::flushWrites() {
+    sendWrites();
+    return !this->outError;
+}
+
+boolean PubSubClient::endWrites() {
+    boolean ok = flushWrites();
+    this->outError = false;
+    return ok;
+}
+
+uint16_t PubSubClient::preparePublish(const char* topic, boolean retained, const MQTTPublishOptions& options, uint32_t plength, uint32_t inBuffer, uint8_t* header) {
+    uint8_t qos = (options.qos < this->maxQos) ? options.qos : this->maxQos;
+    // Never waits for the quota here: loop() would run the message callback
+    // in the middle of the caller's publish
+    if (qos > 1 || (qos == 1 && this->inflight >= this->sendQuota)) {
+        return 0;
+    }
+    finishPublish(false);
+
+    boolean established = false;
+    uint16_t alias = topicAlias(topic, &established);
+    size_t tlen = established ? 0 : strnlen(topic, this->bufferSize);
+
+    uint32_t propLength = 0;
+    if (this->_version == MQTT_VERSION_5) {
+        if (options.messageExpiry > 0) {
+            propLength += 5;
+        }
+        if (alias > 0) {
+            propLength += 3;
+        }
+        for (uint8_t i = 0; i < options.userPropertyCount; i++) {
+            propLength += 5 + strlen(options.userProperties[2*i]) + strlen(options.userProperties[2*i+1]);
+        }
+    }
+    uint32_t length = MQTT_MAX_HEADER_SIZE + 2 + tlen + (qos ? 2 : 0) + inBuffer;
+    if (this->_version == MQTT_VERSION_5) {
+        length += 4 + propLength;
+    }
+    if (length > this->bufferSize) {
+        return 0;
+    }
+    if (this->maxPacketSize > 0) {
+        // Broker drops the connection on a bigger packet
+        uint32_t remaining = length - MQTT_MAX_HEADER_SIZE - inBuffer + plength;
+        if (1 + (remaining < 128 ? 1 : remaining < 16384 ? 2 : remaining < 2097152 ? 3 : 4) + remaining > this->maxPacketSize) {
+            return 0;
+        }
+    }
+
+    // Leave room in the buffer for header and variable length field
+    uint16_t pos = MQTT_MAX_HEADER_SIZE;
+    if (established) {
+        // Empty topic name, the alias stands for it
+        this->buffer[pos++] = 0;
+        this->buffer[pos++] = 0;
+    } else {
+        pos = writeString(topic,this->buffer,pos);
+        if (alias > 0) {
+            // The broker only knows the alias once this packet reached it
+            this->pendingAlias = alias;
+            this->pendingAliasTopic = strdup(topic);
+        }
+    }
+    if (qos) {
+        nextMsgId++;
+        if (nextMsgId == 0) {
+            nextMsgId = 1;
+        }
+        this->buffer[pos++] = (nextMsgId >> 8);
+        this->buffer[pos++] = (nextMsgId & 0xFF);
+    }
+    this->pendingQos = qos;
+    if (this->_version == MQTT_VERSION_5) {
+        pos = writeVarInt(propLength, this->buffer, pos);
+        if (options.messageExpiry > 0) {
+            this->buffer[pos++] = MQTTPROP_MESSAGE_EXPIRY;
+            this->buffer[pos++] = (options.messageExpiry >> 24);
+            this->buffer[pos++] = (options.messageExpiry >> 16) & 0xFF;
+            this->buffer[pos++] = (options.messageExpiry >> 8) & 0xFF;
+            this->buffer[pos++] = (options.messageExpiry & 0xFF);
+        }
+        if (alias > 0) {
+            this->buffer[pos++] = MQTTPROP_TOPIC_ALIAS;
+            this->buffer[pos++] = (alias >> 8);
+            this->buffer[pos++] = (alias & 0xFF);
+        }
+        for (uint8_t i = 0; i < options.userPropertyCount; i++) {
+            this->buffer[pos++] = MQTTPROP_USER_PROPERTY;
+            pos = writeString(options.userProperties[2*i],this->buffer,pos);
+            pos = writeString(options.userProperties[2*i+1],this->buffer,pos);
+        }
+    }
+
+    *header = MQTTPUBLISH | (qos << 1);
+    if (retained) {
+        *header |= 1;
+    }
+    return pos;
+}
+
+uint16_t PubSubClient::topicAlias(const char* topic, boolean* established) {
+    *established = false;
+    if (this->_version != MQTT_VERSION_5 || this->topicAliasMax == 0) {
+        return 0;
+    }
+    uint16_t limit = (this->topicAliasMax < MQTT_MAX_TOPIC_ALIASES) ? this->topicAliasMax : MQTT_MAX_TOPIC_ALIASES;
+    uint16_t i;
+    for (i = 0; i < limit; i++) {
+        if (this->aliasTopics[i] != NULL && strcmp(this->aliasTopics[i], topic) == 0) {
+            *established = true;
+            return i+1;
+        }
+    }
+
+    // Only topics published before get an alias, one-off topics such as
+    // RPC responses would use up the aliases otherwise
+    uint32_t hash = 2166136261UL;
+    for (const char* c = topic; *c; c++) {
+        hash = (hash ^ (uint8_t)*c) * 16777619UL;
+    }
+    for (uint8_t j = 0; j < MQTT_MAX_TOPIC_ALIASES; j++) {
+        if (this->aliasCandidates[j] == hash) {
+            for (i = 0; i < limit; i++) {
+                if (this->aliasTopics[i] == NULL) {
+                    return i+1;
+                }
+            }
+            return 0;
+        }
+    }
+    this->aliasCandidates[this->nextCandidate] = hash;
+    this->nextCandidate = (this->nextCandidate + 1) % MQTT_MAX_TOPIC_ALIASES;
+    return 0;
+}
+
+void PubSubClient::clearTopicAliases() {
+    // Aliases only live as long as the connection they were set up on
+    for (uint8_t i = 0; i < MQTT_MAX_TOPIC_ALIASES; i++) {
+        free(this->aliasTopics[i]);
+        this->aliasTopics[i] = NULL;
+        this->aliasCandidates[i] = 0;
+    }
+    this->nextCandidate = 0;
+}
+
+void PubSubClient::finishPublish(boolean sent) {
+    if (sent && this->pendingAlias > 0 && this->pendingAliasTopic != NULL) {
+        this->aliasTopics[this->pendingAlias-1] = this->pendingAliasTopic;
+        this->pendingAliasTopic = NULL;
+    }
+    this->lastMessageId = 0;
+    if (sent && this->pendingQos) {
+        this->lastMessageId = nextMsgId;
+        this->inflight++;
+        if (this->ackMsgId == 0) {
+            this->ackMsgId = nextMsgId;
+            this->ackSentAt = millis();
+        }
+    }
+    free(this->pendingAliasTopic);
+    this->pendingAliasTopic = NULL;
+    this->pendingAlias = 0;
+    this->pendingQos = 0;
 }
 
-size_t PubSubClient::buildHeader(uint8_t header, uint8_t* buf, uint16_t length) {
+size_t PubSubClient::buildHeader(uint8_t header, uint8_t* buf, uint32_t length) {
     uint8_t lenBuf[4];
     uint8_t llen = 0;
     uint8_t digit;
     uint8_t pos = 0;
-    uint16_t len = length;
+    uint32_t len = length;
     do {
 
         digit = len  & 127; //digit = len %128
@@ -582,6 +1019,12 @@ boolean PubSubClient::write(uint8_t header, uint8_t* buf, uint16_t length) {
     uint16_t rc;
     uint8_t hlen = buildHeader(header, buf, length);
 
+    // Never lets a packet overtake the buffered part of a streamed publish, nor
+    // follow one that lost bytes: the broker would read it as payload
+    if (!flushWrites()) {
+        return false;
+    }
+
 #ifdef MQTT_MAX_TRANSFER_SIZE
     uint8_t* writeBuf = buf+(MQTT_MAX_HEADER_SIZE-hlen);
     uint16_t bytesRemaining = length+hlen;  //Match the length type
@@ -614,7 +1057,7 @@ boolean PubSubClient::subscribe(const char* topic, uint8_t qos) {
     if (qos > 1) {
         return false;
     }
-    if (this->bufferSize < 9 + topicLength) {
+    if (this->bufferSize < 10 + topicLength) {
         // Too long
         return false;
     }
@@ -627,9 +1070,17 @@ boolean PubSubClient::subscribe(const char* topic, uint8_t qos) {
         }
         this->buffer[length++] = (nextMsgId >> 8);
         this->buffer[length++] = (nextMsgId & 0xFF);
+        if (this->_version == MQTT_VERSION_5) {
+            // No properties
+            this->buffer[length++] = 0;
+        }
         length = writeString((char*)topic, this->buffer,length);
         this->buffer[length++] = qos;
-        return write(MQTTSUBSCRIBE|MQTTQOS1,this->buffer,length-MQTT_MAX_HEADER_SIZE);
+        if (!write(MQTTSUBSCRIBE|MQTTQOS1,this->buffer,length-MQTT_MAX_HEADER_SIZE)) {
+            return false;
+        }
+        this->pendingSubscribes++;
+        return true;
     }
     return false;
 }
@@ -639,7 +1090,7 @@ boolean PubSubClient::unsubscribe(const char* topic) {
     if (topic == 0) {
         return false;
     }
-    if (this->bufferSize < 9 + topicLength) {
+    if (this->bufferSize < 10 + topicLength) {
         // Too long
         return false;
     }
@@ -651,6 +1102,9 @@ boolean PubSubClient::unsubscribe(const char* topic) {
         }
         this->buffer[length++] = (nextMsgId >> 8);
         this->buffer[length++] = (nextMsgId & 0xFF);
+        if (this->_version == MQTT_VERSION_5) {
+            this->buffer[length++] = 0;
+        }
         length = writeString(topic, this->buffer,length);
         return write(MQTTUNSUBSCRIBE|MQTTQOS1,this->buffer,length-MQTT_MAX_HEADER_SIZE);
     }
@@ -723,6 +1177,11 @@ PubSubClient& PubSubClient::setCallback(MQTT_CALLBACK_SIGNATURE) {
     return *this;
 }
 
+PubSubClient& PubSubClient::setAckCallback(MQTT_ACK_CALLBACK_SIGNATURE) {
+    this->ackCallback = ackCallback;
+    return *this;
+}
+
 PubSubClient& PubSubClient::setClient(Client& client){
     this->_client = &client;
     return *this;
@@ -763,7 +1222,46 @@ PubSubClient& PubSubClient::setKeepAlive(uint16_t keepAlive) {
     this->keepAlive = keepAlive;
     return *this;
 }
+uint16_t PubSubClient::getKeepAlive() {
+    return (this->_state == MQTT_CONNECTED) ? this->sessionKeepAlive : this->keepAlive;
+}
+PubSubClient& PubSubClient::setPingInterval(uint16_t seconds) {
+    this->pingInterval = seconds;
+    return *this;
+}
 PubSubClient& PubSubClient::setSocketTimeout(uint16_t timeout) {
     this->socketTimeout = timeout;
     return *this;
 }
+PubSubClient& PubSubClient::setProtocolVersion(uint8_t version) {
+    this->requestedVersion = version;
+    this->versionFallback = false;
+    return *this;
+}
+uint8_t PubSubClient::getProtocolVersion() {
+    return this->_version;
+}
+uint8_t PubSubClient::getReasonCode() {
+    return this->reasonCode;
+}
+uint16_t PubSubClient::getInflight() {
+    return this->inflight;
+}
+uint16_t PubSubClient::getLastMessageId() {
+    return this->lastMessageId;
+}
+uint16_t PubSubClient::getPendingSubscribes() {
+    return this->pendingSubscribes;
+}
+unsigned long PubSubClient::getAckRtt() {
+    return this->ackRtt;
+}
+uint16_t PubSubClient::getAckCount() {
+    return this->ackCount;
+}
+unsigned long PubSubClient::getPingIdle() {
+    return this->pingIdle;
+}
+uint16_t PubSubClient::getPingCount() {
+    return this->pingCount;
+}
@@ -14,8 +14,10 @@
 
 #define MQTT_VERSION_3_1      3
 #define MQTT_VERSION_3_1_1    4
+#define MQTT_VERSION_5        5
 
-// MQTT_VERSION : Pick the version
+// MQTT_VERSION : Pick the version. Override with setProtocolVersion().
+// A broker that rejects MQTT_VERSION_5 gets 3.1.1, see setProtocolVersion()
 //#define MQTT_VERSION MQTT_VERSION_3_1
 #ifndef MQTT_VERSION
 #define MQTT_VERSION MQTT_VERSION_3_1_1
@@ -36,6 +38,29 @@
 #define MQTT_SOCKET_TIMEOUT 15
 #endif
 
+// MQTT_WRITE_BUFFER_SIZE : outgoing bytes are gathered up to this size before they
+//  are passed to the network client, so fixed header, topic and payload of a
+//  PUBLISH leave in one write (one TCP segment) instead of one per fragment or
+//  byte. Defaults to the lwIP TCP MSS. Set to 0 to write every fragment directly.
+#ifndef MQTT_WRITE_BUFFER_SIZE
+#define MQTT_WRITE_BUFFER_SIZE 1436
+#endif
+
+// MQTT_MAX_INFLIGHT : maximum number of QoS 1 messages published and not yet
+//  acknowledged. Further QoS 1 publishes fail until loop() has read a PUBACK,
+//  they never wait inside publish. With MQTT 5 the broker's Receive Maximum
+//  lowers it further.
+#ifndef MQTT_MAX_INFLIGHT
+#define MQTT_MAX_INFLIGHT 4
+#endif
+
+// MQTT_MAX_TOPIC_ALIASES : number of MQTT 5 topic aliases the client assigns,
+//  bounded by the broker's Topic Alias Maximum. A topic gets an alias the second
+//  time it is published, from then on only 2 alias bytes replace its name.
+#ifndef MQTT_MAX_TOPIC_ALIASES
+#define MQTT_MAX_TOPIC_ALIASES 4
+#endif
+
 // MQTT_MAX_TRANSFER_SIZE : limit how much data is passed to the network client
 //  in each write call. Needed for the Arduino Wifi Shield. Leave undefined to
 //  pass the entire MQTT packet in each write call.
@@ -69,6 +94,19 @@
 #define MQTTDISCONNECT  14 << 4 // Client is Disconnecting
 #define MQTTReserved    15 << 4 // Reserved
 
+// MQTT 5 properties used by the client
+#define MQTTPROP_MESSAGE_EXPIRY     0x02
+#define MQTTPROP_SERVER_KEEP_ALIVE  0x13
+#define MQTTPROP_RECEIVE_MAXIMUM    0x21
+#define MQTTPROP_TOPIC_ALIAS_MAX    0x22
+#define MQTTPROP_TOPIC_ALIAS        0x23
+#define MQTTPROP_MAXIMUM_QOS        0x24
+#define MQTTPROP_USER_PROPERTY      0x26
+#define MQTTPROP_MAX_PACKET_SIZE    0x27
+
+// MQTT 5 reason code of a broker that does not speak the requested version
+#define MQTT_REASON_UNSUPPORTED_VERSION 0x84
+
 #define MQTTQOS0        (0 << 1)
 #define MQTTQOS1        (1 << 1)
 #define MQTTQOS2        (2 << 1)
@@ -79,10 +117,21 @@
 #if defined(ESP8266) || defined(ESP32)
 #include <functional>
 #define MQTT_CALLBACK_SIGNATURE std::function<void(char*, uint8_t*, unsigned int)> callback
+#define MQTT_ACK_CALLBACK_SIGNATURE std::function<void(uint16_t, uint8_t)> ackCallback
 #else
 #define MQTT_CALLBACK_SIGNATURE void (*callback)(char*, uint8_t*, unsigned int)
+#define MQTT_ACK_CALLBACK_SIGNATURE void (*ackCallback)(uint16_t, uint8_t)
 #endif
 
+// Per message options of a publish. MQTT 5 only fields are ignored on 3.1.1 connections
+struct MQTTPublishOptions {
+   uint8_t qos;                      // 0 or 1
+   uint32_t messageExpiry;           // Seconds the broker keeps the message for, 0 never expires (MQTT 5)
+   const char* const* userProperties; // Alternating keys and values (MQTT 5)
+   uint8_t userPropertyCount;        // Number of key/value pairs in userProperties
+   MQTTPublishOptions() : qos(0), messageExpiry(0), userProperties(NULL), userPropertyCount(0) {}
+};
+
 #define CHECK_STRING_LENGTH(l,s) if (l+2+strnlen(s, this->bufferSize) > this->bufferSize) {_client->stop();return false;}
 
 class PubSubClient : public Print {
@@ -97,6 +146,7 @@ private:
    unsigned long lastInActivity;
    bool pingOutstanding;
    MQTT_CALLBACK_SIGNATURE;
+   MQTT_ACK_CALLBACK_SIGNATURE = NULL;
    uint32_t readPacket(uint8_t*);
    boolean readByte(uint8_t * result);
    boolean readByte(uint8_t * result, uint16_t * index);
@@ -106,7 +156,71 @@ private:
    // Returns the size of the header
    // Note: the header is built at the end of the first MQTT_MAX_HEADER_SIZE bytes, so will start
    //       (MQTT_MAX_HEADER_SIZE - <returned size>) bytes into the buffer
-   size_t buildHeader(uint8_t header, uint8_t* buf, uint16_t length);
+   size_t buildHeader(uint8_t header, uint8_t* buf, uint32_t length);
+   // Write combining: bytes are gathered in outBuffer (allocated on first use)
+   // and sent with one _client->write() when it is full or on flushWrites().
+   // outError sticks from the first lost byte until endWrites() reports it
+   // for the message (endPublish, publish_P) or a new message starts
+   uint8_t* outBuffer = NULL;
+   uint16_t outLength = 0;
+   boolean outError = false;
+   size_t bufferedWrite(const uint8_t* data, size_t size);
+   // Sends outBuffer, returns the number of its bytes that were not sent
+   uint16_t sendWrites();
+   // Sends outBuffer, false if any byte of the current message was lost
+   boolean flushWrites();
+   // flushWrites() at the end of a message, clears the error for the next one
+   boolean endWrites();
+   // MQTT 5: requested and negotiated protocol version and the limits the broker
+   // announced in its CONNACK
+   uint8_t requestedVersion = MQTT_VERSION;
+   uint8_t _version = MQTT_VERSION;
+   // The broker refused MQTT 5, later connects ask for 3.1.1 right away
+   boolean versionFallback = false;
+   // Keep alive of the current connection, the broker's Server Keep Alive
+   // (MQTT 5) replaces the requested keepAlive for that connection only
+   uint16_t sessionKeepAlive = MQTT_KEEPALIVE;
+   uint8_t reasonCode = 0;
+   uint8_t maxQos = 1;
+   uint16_t sendQuota = MQTT_MAX_INFLIGHT;
+   uint16_t inflight = 0;
+   uint16_t pendingSubscribes = 0;
+   uint16_t topicAliasMax = 0;
+   uint32_t maxPacketSize = 0;
+   char* aliasTopics[MQTT_MAX_TOPIC_ALIASES] = {};
+   uint32_t aliasCandidates[MQTT_MAX_TOPIC_ALIASES] = {};
+   uint8_t nextCandidate = 0;
+   // Publish being sent: the alias it sets up and whether it counts as in flight
+   // only take effect once all of it went out, see finishPublish()
+   uint16_t pendingAlias = 0;
+   char* pendingAliasTopic = NULL;
+   uint8_t pendingQos = 0;
+   uint16_t lastMessageId = 0;
+   // Round trip timing: one QoS 1 publish at a time and every PINGREQ
+   uint16_t ackMsgId = 0;
+   unsigned long ackSentAt = 0;
+   unsigned long pingSentAt = 0;
+   unsigned long ackRtt = 0;
+   uint16_t ackCount = 0;
+   // Adaptive keepalive: PINGREQ after pingInterval seconds without traffic in
+   // either direction, how long the connection was idle before the last answered one
+   uint16_t pingInterval = 0;
+   unsigned long pingIdle = 0;
+   unsigned long pendingPingIdle = 0;
+   uint16_t pingCount = 0;
+   boolean connectWithVersion(const char* id, const char* user, const char* pass, const char* willTopic, uint8_t willQos, boolean willRetain, const char* willMessage, boolean cleanSession);
+   boolean readConnackProperties(uint16_t pos, uint16_t end);
+   uint16_t writeVarInt(uint32_t value, uint8_t* buf, uint16_t pos);
+   boolean readVarInt(uint16_t* pos, uint16_t end, uint32_t* value);
+   boolean readProperty(uint16_t* pos, uint16_t end, uint8_t* id, uint32_t* value);
+   uint16_t topicAlias(const char* topic, boolean* established);
+   void clearTopicAliases();
+   // Commits alias and in flight count of the publish preparePublish() set up if it was sent
+   void finishPublish(boolean sent);
+   // Writes topic (or its alias), packet identifier and properties of a PUBLISH
+   // into the buffer after the header space and sets its fixed header byte.
+   // inBuffer payload bytes must fit behind it. Returns the end position, 0 on error
+   uint16_t preparePublish(const char* topic, boolean retained, const MQTTPublishOptions& options, uint32_t plength, uint32_t inBuffer, uint8_t* header);
    IPAddress ip;
    const char* domain;
    uint16_t port;
@@ -134,10 +248,47 @@ public:
    PubSubClient& setServer(uint8_t * ip, uint16_t port);
    PubSubClient& setServer(const char * domain, uint16_t port);
    PubSubClient& setCallback(MQTT_CALLBACK_SIGNATURE);
+   // Called from loop() with the packet identifier and reason code (0 = success,
+   // >= 0x80 = refused, MQTT 5) of every PUBACK. In-flight messages are not kept
+   // across connections: one that was not acknowledged before a disconnect is
+   // lost and up to the application to publish again
+   PubSubClient& setAckCallback(MQTT_ACK_CALLBACK_SIGNATURE);
    PubSubClient& setClient(Client& client);
    PubSubClient& setStream(Stream& stream);
    PubSubClient& setKeepAlive(uint16_t keepAlive);
+   // Keep alive of the current connection, the broker may lower the requested one (MQTT 5)
+   uint16_t getKeepAlive();
+   // Send PINGREQ after this many seconds without traffic in either direction,
+   // at most the keep alive. 0 only pings when the keep alive runs out
+   PubSubClient& setPingInterval(uint16_t seconds);
    PubSubClient& setSocketTimeout(uint16_t timeout);
+   // Protocol version requested on connect. MQTT_VERSION_5 falls back to 3.1.1
+   // when the broker refuses it: on a socket PubSubClient opened itself the same
+   // connect() tries again, on a socket the caller opened (and possibly tuned)
+   // connect() fails with MQTT_CONNECT_BAD_PROTOCOL and the next one, on the
+   // caller's next socket, asks for 3.1.1. Sticks until setProtocolVersion()
+   PubSubClient& setProtocolVersion(uint8_t version);
+   // Protocol version of the current connection
+   uint8_t getProtocolVersion();
+   // Reason code of the last CONNACK, PUBACK, SUBACK or DISCONNECT received (MQTT 5),
+   // return code of the last CONNACK or SUBACK on 3.1.1 (0x80 = subscription refused)
+   uint8_t getReasonCode();
+   // QoS 1 messages published and not yet acknowledged
+   uint16_t getInflight();
+   // Packet identifier of the last message sent, 0 if it went out at QoS 0
+   // (including a QoS 1 request the broker's Maximum QoS lowered)
+   uint16_t getLastMessageId();
+   // SUBSCRIBEs sent and not yet acknowledged. subscribe() does not wait for the
+   // SUBACK, several subscriptions go out back to back and are acknowledged together
+   uint16_t getPendingSubscribes();
+   // Round trip in ms of the last timed PUBACK or PINGRESP, and how many have been
+   // timed, a changed count means a fresh measurement
+   unsigned long getAckRtt();
+   uint16_t getAckCount();
+   // Idle ms before the last answered PINGREQ, and how many have been answered.
+   // An answer after a long idle shows the network path kept the connection open that long
+   unsigned long getPingIdle();
+   uint16_t getPingCount();
 
    boolean setBufferSize(uint16_t size);
    uint16_t getBufferSize();
@@ -152,8 +303,10 @@ public:
    boolean publish(const char* topic, const char* payload, boolean retained);
    boolean publish(const char* topic, const uint8_t * payload, unsigned int plength);
    boolean publish(const char* topic, const uint8_t * payload, unsigned int plength, boolean retained);
+   boolean publish(const char* topic, const uint8_t * payload, unsigned int plength, boolean retained, const MQTTPublishOptions& options);
    boolean publish_P(const char* topic, const char* payload, boolean retained);
    boolean publish_P(const char* topic, const uint8_t * payload, unsigned int plength, boolean retained);
+   boolean publish_P(const char* topic, const uint8_t * payload, unsigned int plength, boolean retained, const MQTTPublishOptions& options);
    // Start to publish a message.
    // This API:
    //   beginPublish(...)
@@ -163,6 +316,7 @@ public:
    // a new buffer and held in memory at one time
    // Returns 1 if the message was started successfully, 0 if there was an error
    boolean beginPublish(const char* topic, unsigned int plength, boolean retained);
+   boolean beginPublish(const char* topic, unsigned int plength, boolean retained, const MQTTPublishOptions& options);
    // Finish off this publish message (started with beginPublish)
    // Returns 1 if the packet was sent successfully, 0 if there was an error
    int endPublish();
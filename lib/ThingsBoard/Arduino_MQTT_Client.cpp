@@ -63,7 +63,7 @@ bool Arduino_MQTT_Client::connected() {
     return m_mqtt_client.connected();
 }
 
-#if THINGSBOARD_ENABLE_STREAM_UTILS
+#if THINGSBOARD_ENABLE_STREAM_UTILS || THINGSBOARD_ENABLE_STREAMING_PUBLISH
 
 bool Arduino_MQTT_Client::begin_publish(const char *topic, const size_t& length) {
     return m_mqtt_client.beginPublish(topic, length, false);
@@ -81,6 +81,6 @@ size_t Arduino_MQTT_Client::write(const uint8_t *buffer, size_t size) {
     return m_mqtt_client.write(buffer, size);
 }
 
-#endif // THINGSBOARD_ENABLE_STREAM_UTILS
+#endif // THINGSBOARD_ENABLE_STREAM_UTILS || THINGSBOARD_ENABLE_STREAMING_PUBLISH
 
 #endif // ARDUINO
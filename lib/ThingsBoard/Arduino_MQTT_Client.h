@@ -49,7 +49,7 @@ class Arduino_MQTT_Client : public IMQTT_Client {
 
     bool connected() override;
 
-#if THINGSBOARD_ENABLE_STREAM_UTILS
+#if THINGSBOARD_ENABLE_STREAM_UTILS || THINGSBOARD_ENABLE_STREAMING_PUBLISH
 
     bool begin_publish(const char *topic, const size_t& length) override;
 
@@ -63,7 +63,7 @@ class Arduino_MQTT_Client : public IMQTT_Client {
 
     size_t write(const uint8_t *buffer, size_t size) override;
 
-#endif // THINGSBOARD_ENABLE_STREAM_UTILS
+#endif // THINGSBOARD_ENABLE_STREAM_UTILS || THINGSBOARD_ENABLE_STREAMING_PUBLISH
 
   private:
     PubSubClient m_mqtt_client; // Underlying MQTT client instance used to send data
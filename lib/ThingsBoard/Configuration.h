@@ -169,6 +169,20 @@
 #    define THINGSBOARD_ENABLE_STREAM_UTILS 0
 #  endif
 
+// Enables the built-in fallback to directly serialize a json message that is sent to the cloud into the MQTT client,
+// if the size of that message would be bigger than the internal buffer size of the client. Works the same as THINGSBOARD_ENABLE_STREAM_UTILS,
+// but instead of the external StreamUtils library the included Streaming_Publish_Writer is used to combine the small writes of the serialization into bigger chunks.
+// Therefore it does not depend on Arduino or any additional library, but the used IMQTT_Client implementation needs to support begin_publish(), write() and end_publish().
+// If enabled the internal buffer of the client only needs to be as big as the biggest message received from the cloud, because sent messages can be arbitrarily big.
+// Is automatically disabled if THINGSBOARD_ENABLE_STREAM_UTILS is enabled, because then the StreamUtils library is used instead.
+#  ifndef THINGSBOARD_ENABLE_STREAMING_PUBLISH
+#    if THINGSBOARD_ENABLE_STREAM_UTILS
+#      define THINGSBOARD_ENABLE_STREAMING_PUBLISH 0
+#    else
+#      define THINGSBOARD_ENABLE_STREAMING_PUBLISH 1
+#    endif
+#  endif
+
 // Enables the ThingsBoard class to save the allocated memory of the DynamicJsonDocument into psram instead of onto the sram.
 // Enabled by default if THINGSBOARD_ENABLE_DYNAMIC has been set and the esp_heap_caps header exists, because it requries DynamicJsonDocument to work.
 // If enabled the program might be slightly slower, but all the memory will be placed onto psram instead of sram, meaning the sram can be allocated for other things.
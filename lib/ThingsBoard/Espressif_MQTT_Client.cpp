@@ -240,6 +240,26 @@ bool Espressif_MQTT_Client::connected() {
     return m_connected;
 }
 
+#if THINGSBOARD_ENABLE_STREAMING_PUBLISH
+
+bool Espressif_MQTT_Client::begin_publish(const char *topic, const size_t& length) {
+    return false;
+}
+
+bool Espressif_MQTT_Client::end_publish() {
+    return false;
+}
+
+size_t Espressif_MQTT_Client::write(uint8_t payload_byte) {
+    return 0U;
+}
+
+size_t Espressif_MQTT_Client::write(const uint8_t *buffer, size_t size) {
+    return 0U;
+}
+
+#endif // THINGSBOARD_ENABLE_STREAMING_PUBLISH
+
 bool Espressif_MQTT_Client::update_configuration() {
     // Check if the client has been initalized, because if it did not the value should still be nullptr
     // and updating the config makes no sense because the changed settings will be applied anyway when the client is first intialized
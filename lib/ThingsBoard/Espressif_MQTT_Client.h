@@ -109,6 +109,20 @@ class Espressif_MQTT_Client : public IMQTT_Client {
 
     bool connected() override;
 
+#if THINGSBOARD_ENABLE_STREAMING_PUBLISH
+
+    /// @brief The esp-mqtt client requires the complete payload when publishing or enqueuing a message,
+    /// therefore streaming a payload bigger than the internal buffer is not supported and the message is discarded instead
+    bool begin_publish(const char *topic, const size_t& length) override;
+
+    bool end_publish() override;
+
+    size_t write(uint8_t payload_byte) override;
+
+    size_t write(const uint8_t *buffer, size_t size) override;
+
+#endif // THINGSBOARD_ENABLE_STREAMING_PUBLISH
+
 private:
     function m_received_data_callback;             // Callback that will be called as soon as the mqtt client receives any data
     bool m_connected;                              // Whether the client has received the connected or disconnected event
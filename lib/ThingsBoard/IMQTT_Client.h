@@ -28,6 +28,8 @@
 /// but writing each byte one by one, would be too slow, therefore the ArduinoStreamUtils (https://github.com/bblanchon/ArduinoStreamUtils) library is used to buffer those calls into bigger packets.
 /// This allows sending data that is very big without requiring to allocate that much memory, because it is sent in smaller packets.
 /// To support this feature, however this interface needs to additionally implement the Print interface, because that is required by the wrapper class BufferingPrint.
+/// Alternatively THINGSBOARD_ENABLE_STREAMING_PUBLISH provides the same feature without the external library and without the Print interface,
+/// by combining the writes with the included Streaming_Publish_Writer instead.
 #if THINGSBOARD_ENABLE_STREAM_UTILS
 class IMQTT_Client : public Print {
 #else
@@ -111,7 +113,7 @@ class IMQTT_Client {
     /// @return Whether the client is currently connected or not
     virtual bool connected() = 0;
 
-#if THINGSBOARD_ENABLE_STREAM_UTILS
+#if THINGSBOARD_ENABLE_STREAM_UTILS || THINGSBOARD_ENABLE_STREAMING_PUBLISH
 
     /// @brief Start to publish a message over a given topic, without being restricted to the internal buffer size.
     /// Meaning it allows for arbitrarily large payloads to be sent without them having to be copied into a new buffer and held in memory.
@@ -144,7 +146,7 @@ class IMQTT_Client {
     /// @return The amount of bytes successfully written
     virtual size_t write(const uint8_t *buffer, size_t size) = 0;
 
-#endif // THINGSBOARD_ENABLE_STREAM_UTILS
+#endif // THINGSBOARD_ENABLE_STREAM_UTILS || THINGSBOARD_ENABLE_STREAMING_PUBLISH
 };
 
 #endif // IMQTT_Client_h
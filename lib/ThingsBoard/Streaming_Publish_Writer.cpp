@@ -0,0 +1,72 @@
+// Header include.
+#include "Streaming_Publish_Writer.h"
+
+#if THINGSBOARD_ENABLE_STREAMING_PUBLISH
+
+// Library includes.
+#include <string.h>
+
+Streaming_Publish_Writer::Streaming_Publish_Writer(IMQTT_Client& client, uint8_t *buffer, const size_t& buffer_size) :
+    m_client(client),
+    m_buffer(buffer),
+    m_buffer_size(buffer_size),
+    m_buffered(0U),
+    m_failed(false)
+{
+    // Nothing to do
+}
+
+size_t Streaming_Publish_Writer::write(uint8_t payload_byte) {
+    if (m_failed) {
+        return 0U;
+    }
+    if (m_buffered == m_buffer_size && !flush()) {
+        return 0U;
+    }
+    m_buffer[m_buffered++] = payload_byte;
+    return 1U;
+}
+
+size_t Streaming_Publish_Writer::write(const uint8_t *buffer, size_t size) {
+    if (m_failed) {
+        return 0U;
+    }
+
+    // Writes that would not fit into the buffer anyway skip the copy
+    if (size >= m_buffer_size) {
+        if (!flush()) {
+            return 0U;
+        }
+        const size_t written = m_client.write(buffer, size);
+        m_failed = (written != size);
+        return written;
+    }
+
+    size_t written = 0U;
+    while (written < size) {
+        if (m_buffered == m_buffer_size && !flush()) {
+            break;
+        }
+        size_t chunk = m_buffer_size - m_buffered;
+        if (chunk > size - written) {
+            chunk = size - written;
+        }
+        memcpy(m_buffer + m_buffered, buffer + written, chunk);
+        m_buffered += chunk;
+        written += chunk;
+    }
+    return written;
+}
+
+bool Streaming_Publish_Writer::flush() {
+    if (m_failed) {
+        return false;
+    }
+    if (m_buffered > 0U) {
+        m_failed = (m_client.write(m_buffer, m_buffered) != m_buffered);
+        m_buffered = 0U;
+    }
+    return !m_failed;
+}
+
+#endif // THINGSBOARD_ENABLE_STREAMING_PUBLISH
@@ -0,0 +1,49 @@
+#ifndef Streaming_Publish_Writer_h
+#define Streaming_Publish_Writer_h
+
+// Local include.
+#include "IMQTT_Client.h"
+
+#if THINGSBOARD_ENABLE_STREAMING_PUBLISH
+
+/// @brief Write-combining writer, that allows serializing json directly into a publish started with IMQTT_Client::begin_publish().
+/// ArduinoJson writes the serialized json a few bytes at a time, passing each of those writes to the client would result in a lot of tiny network writes,
+/// therefore the bytes are instead collected in a small fixed size buffer, which is only passed to the client once it is full or once flush() is called.
+/// This allows sending payloads that are bigger than the internal buffer of the client, without ever allocating memory for the complete payload.
+/// Replaces the BufferingPrint class from the external StreamUtils library (https://github.com/bblanchon/ArduinoStreamUtils), which was previously required for this feature,
+/// it does not depend on the Arduino Print interface and implements the custom writer interface of ArduinoJson instead (https://arduinojson.org/v6/api/json/serializejson/)
+class Streaming_Publish_Writer {
+  public:
+    /// @brief Constructs the writer with the given client and buffer
+    /// @param client MQTT Client implementation that has already started a publish with begin_publish()
+    /// @param buffer Buffer the written bytes are collected in before they are passed to the client, has to stay valid as long as this instance exists
+    /// @param buffer_size Size of the given buffer in bytes
+    Streaming_Publish_Writer(IMQTT_Client& client, uint8_t *buffer, const size_t& buffer_size);
+
+    /// @brief Writes a single byte into the buffer, passes the buffer to the client if it is full
+    /// @param payload_byte Byte containing part of the payload that should be sent
+    /// @return The amount of bytes successfully written
+    size_t write(uint8_t payload_byte);
+
+    /// @brief Writes multiple bytes into the buffer, passes the buffer to the client each time it is full.
+    /// Writes that are at least as big as the buffer itself are passed to the client directly, after flushing what has been buffered so far
+    /// @param buffer Buffer containing part of the payload that should be sent
+    /// @param size Amount of bytes contained in the buffer that should be sent
+    /// @return The amount of bytes successfully written
+    size_t write(const uint8_t *buffer, size_t size);
+
+    /// @brief Passes all still buffered bytes to the client, has to be called before calling end_publish()
+    /// @return Whether all buffered bytes could be passed to the client or not
+    bool flush();
+
+  private:
+    IMQTT_Client&  m_client;      // MQTT Client the payload is published with
+    uint8_t        *m_buffer;     // Buffer the written bytes are collected in
+    const size_t   m_buffer_size; // Size of the buffer
+    size_t         m_buffered;    // Amount of bytes currently in the buffer
+    bool           m_failed;      // Whether passing bytes to the client has failed, discards all further writes
+};
+
+#endif // THINGSBOARD_ENABLE_STREAMING_PUBLISH
+
+#endif // Streaming_Publish_Writer_h
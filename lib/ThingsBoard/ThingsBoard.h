@@ -18,6 +18,9 @@
 #if THINGSBOARD_ENABLE_STREAM_UTILS
 #include <StreamUtils.h>
 #endif // THINGSBOARD_ENABLE_STREAM_UTILS
+#if THINGSBOARD_ENABLE_STREAMING_PUBLISH
+#include "Streaming_Publish_Writer.h"
+#endif // THINGSBOARD_ENABLE_STREAMING_PUBLISH
 
 
 /// ---------------------------------
@@ -383,16 +386,16 @@ class ThingsBoardSized {
       m_max_stack = maxStackSize;
     }
 
-#if THINGSBOARD_ENABLE_STREAM_UTILS
+#if THINGSBOARD_ENABLE_STREAM_UTILS || THINGSBOARD_ENABLE_STREAMING_PUBLISH
 
-    /// @brief Sets the amount of bytes that can be allocated to speed up fall back serialization with the StreamUtils class
+    /// @brief Sets the amount of bytes that can be allocated to speed up fall back serialization with the StreamUtils class or the Streaming_Publish_Writer.
     /// See https://github.com/bblanchon/ArduinoStreamUtils for more information on the underlying class used
-    /// @param bufferingSize Amount of bytes allocated to speed up serialization
+    /// @param bufferingSize Amount of bytes allocated to speed up serialization, bigger values result in fewer but bigger writes into the client
     inline void setBufferingSize(const size_t& bufferingSize) {
       m_buffering_size = bufferingSize;
     }
 
-#endif // THINGSBOARD_ENABLE_STREAM_UTILS
+#endif // THINGSBOARD_ENABLE_STREAM_UTILS || THINGSBOARD_ENABLE_STREAMING_PUBLISH
 
     /// @brief Sets the size of the buffer for the underlying network client that will be used to establish the connection to ThingsBoard
     /// @param bufferSize Maximum amount of data that can be either received or sent to ThingsBoard at once, if bigger packets are received they are discarded
@@ -406,7 +409,8 @@ class ThingsBoardSized {
     /// that size can vary but if all ThingsBoard features are used a buffer size of 256 bytes should suffice for receiving most responses.
     /// If the aforementioned feature is not enabled the buffer size might need to be much bigger though,
     /// but in that case if a message was too big to be sent the user will be informed with a message to the Logger.
-    /// The aforementioned options can only be enabled if Arduino is used to build this library, because the StreamUtils library requires it
+    /// The aforementioned options can only be enabled if Arduino is used to build this library, because the StreamUtils library requires it,
+    /// alternatively THINGSBOARD_ENABLE_STREAMING_PUBLISH provides the same behaviour without the StreamUtils library and is therefore not restricted to Arduino
     /// @return Whether allocating the needed memory for the given bufferSize was successful or not
     inline bool setBufferSize(const uint16_t& bufferSize) {
       return m_client.set_buffer_size(bufferSize);
@@ -495,7 +499,7 @@ class ThingsBoardSized {
 #endif // !THINGSBOARD_ENABLE_DYNAMIC
       bool result = false;
 
-#if THINGSBOARD_ENABLE_STREAM_UTILS
+#if THINGSBOARD_ENABLE_STREAM_UTILS || THINGSBOARD_ENABLE_STREAMING_PUBLISH
       // Check if the size of the given message would be too big for the actual client,
       // if it is utilize the serialize json work around, so that the internal client buffer can be circumvented
       if (m_client.get_buffer_size() < jsonSize)  {
@@ -509,7 +513,7 @@ class ThingsBoardSized {
       // Check if the remaining stack size of the current task would overflow the stack,
       // if it would allocate the memory on the heap instead to ensure no stack overflow occurs
       else
-#endif // THINGSBOARD_ENABLE_STREAM_UTILS
+#endif // THINGSBOARD_ENABLE_STREAM_UTILS || THINGSBOARD_ENABLE_STREAMING_PUBLISH
       if (getMaximumStackSize() < jsonSize) {
         char* json = new char[jsonSize];
         if (serializeJson(source, json, jsonSize) < jsonSize - 1) {
@@ -548,10 +552,30 @@ class ThingsBoardSized {
       const size_t jsonSize = strlen(json);
 
       if (currentBufferSize < jsonSize) {
+#if THINGSBOARD_ENABLE_STREAM_UTILS || THINGSBOARD_ENABLE_STREAMING_PUBLISH
+        // The string is already completely serialized, therefore it can simply be written into the client in one go,
+        // instead of discarding it because it does not fit into the internal client buffer
+#if THINGSBOARD_ENABLE_DEBUG
+        char message[JSON_STRING_SIZE(strlen(SEND_MESSAGE)) + JSON_STRING_SIZE(strlen(topic)) + JSON_STRING_SIZE(strlen(SEND_SERIALIZED))];
+        snprintf_P(message, sizeof(message), SEND_MESSAGE, topic, SEND_SERIALIZED);
+        Logger::log(message);
+#endif // THINGSBOARD_ENABLE_DEBUG
+        if (!m_client.begin_publish(topic, jsonSize)) {
+          Logger::log(UNABLE_TO_SERIALIZE_JSON);
+          return false;
+        }
+        if (m_client.write(reinterpret_cast<const uint8_t*>(json), jsonSize) != jsonSize) {
+          m_client.end_publish();
+          Logger::log(UNABLE_TO_SERIALIZE_JSON);
+          return false;
+        }
+        return m_client.end_publish();
+#else
         char message[Helper::detectSize(INVALID_BUFFER_SIZE, currentBufferSize, jsonSize)];
         snprintf_P(message, sizeof(message), INVALID_BUFFER_SIZE, currentBufferSize, jsonSize);
         Logger::log(message);
         return false;
+#endif // THINGSBOARD_ENABLE_STREAM_UTILS || THINGSBOARD_ENABLE_STREAMING_PUBLISH
       }
 
 #if THINGSBOARD_ENABLE_DEBUG
@@ -1096,17 +1120,18 @@ class ThingsBoardSized {
     /// @tparam TSource Source class that should be used to serialize the json that is sent to the server
     /// @param topic Topic we want to send the data over
     /// @param source Data source containing our json key value pairs we want to send
-    /// @param jsonSize Size of the data inside the source
+    /// @param jsonSize Size of the data inside the source, including the null terminator as returned by Helper::Measure_Json()
     /// @return Whether sending the data was successful or not
     template <typename TSource>
     inline bool Serialize_Json(const char* topic, const TSource& source, const size_t& jsonSize) {
-      if (!m_client.begin_publish(topic, jsonSize)) {
+      const size_t payloadSize = jsonSize - 1U;
+      if (!m_client.begin_publish(topic, payloadSize)) {
         Logger::log(UNABLE_TO_SERIALIZE_JSON);
         return false;
       }
       BufferingPrint buffered_print(m_client, getBufferingSize());
       const size_t bytes_serialized = serializeJson(source, buffered_print);
-      if (bytes_serialized < jsonSize) {
+      if (bytes_serialized < payloadSize) {
         Logger::log(UNABLE_TO_SERIALIZE_JSON);
         return false;
       }
@@ -1114,6 +1139,36 @@ class ThingsBoardSized {
       return m_client.end_publish();
     }
 
+#elif THINGSBOARD_ENABLE_STREAMING_PUBLISH
+
+    /// @brief Serialize the custom attribute source into the underlying client.
+    /// Sends the given bytes to the client without requiring a temporary buffer for the complete message,
+    /// the small writes of the serialization are combined in a buffer of getBufferingSize() bytes on the stack,
+    /// so that the client only receives a few big writes instead of one write per serialized token
+    /// @tparam TSource Source class that should be used to serialize the json that is sent to the server
+    /// @param topic Topic we want to send the data over
+    /// @param source Data source containing our json key value pairs we want to send
+    /// @param jsonSize Size of the data inside the source, including the null terminator as returned by Helper::Measure_Json()
+    /// @return Whether sending the data was successful or not
+    template <typename TSource>
+    inline bool Serialize_Json(const char* topic, const TSource& source, const size_t& jsonSize) {
+      // The null terminator is not part of the payload, announcing it would leave the publish one byte short
+      const size_t payloadSize = jsonSize - 1U;
+      if (!m_client.begin_publish(topic, payloadSize)) {
+        Logger::log(UNABLE_TO_SERIALIZE_JSON);
+        return false;
+      }
+      uint8_t buffer[getBufferingSize()];
+      Streaming_Publish_Writer writer(m_client, buffer, sizeof(buffer));
+      const size_t bytes_serialized = serializeJson(source, writer);
+      if (bytes_serialized < payloadSize || !writer.flush()) {
+        m_client.end_publish();
+        Logger::log(UNABLE_TO_SERIALIZE_JSON);
+        return false;
+      }
+      return m_client.end_publish();
+    }
+
 #endif // THINGSBOARD_ENABLE_STREAM_UTILS
 
 #if THINGSBOARD_ENABLE_OTA
@@ -1146,16 +1201,16 @@ class ThingsBoardSized {
       return m_max_stack;
     }
 
-#if THINGSBOARD_ENABLE_STREAM_UTILS
+#if THINGSBOARD_ENABLE_STREAM_UTILS || THINGSBOARD_ENABLE_STREAMING_PUBLISH
 
-    /// @brief Returns the amount of bytes that can be allocated to speed up fall back serialization with the StreamUtils class
+    /// @brief Returns the amount of bytes that can be allocated to speed up fall back serialization with the StreamUtils class or the Streaming_Publish_Writer
     /// See https://github.com/bblanchon/ArduinoStreamUtils for more information on the underlying class used
     /// @return Amount of bytes allocated to speed up serialization
     inline const size_t& getBufferingSize() const {
       return m_buffering_size;
     }
 
-#endif // THINGSBOARD_ENABLE_STREAM_UTILS
+#endif // THINGSBOARD_ENABLE_STREAM_UTILS || THINGSBOARD_ENABLE_STREAMING_PUBLISH
 
     /// @brief Requests one client-side or shared attribute calllback,
     /// that will be called if the key-value pair from the server for the given client-side or shared attributes is received
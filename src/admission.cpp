@@ -0,0 +1,95 @@
+#include "admission.h"
+
+#define RPC_REQUEST_PREFIX "v1/devices/me/rpc/request/"
+#define ATTRIBUTES_PREFIX "v1/devices/me/attributes"
+
+static TokenBucket_t messageBucket = {ADMISSION_MESSAGE_BURST, ADMISSION_MAX_MESSAGES_PER_S, ADMISSION_MESSAGE_BURST, 0};
+static TokenBucket_t byteBucket = {ADMISSION_BYTE_BURST, ADMISSION_MAX_BYTES_PER_S, ADMISSION_BYTE_BURST, 0};
+static TokenBucket_t attributeBucket = {ADMISSION_ATTRIBUTE_BURST, ADMISSION_MAX_ATTRIBUTES_PER_S,
+                                        ADMISSION_ATTRIBUTE_BURST, 0};
+static AdmissionStats_t stats;
+
+void bucket_init(TokenBucket_t *bucket, float rate, float burst)
+{
+    bucket->tokens = burst;
+    bucket->rate = rate;
+    bucket->burst = burst;
+    bucket->last = millis();
+}
+
+bool bucket_take(TokenBucket_t *bucket, float cost)
+{
+    uint32_t now = millis();
+    bucket->tokens = min(bucket->burst, bucket->tokens + (now - bucket->last) * bucket->rate / 1000.0f);
+    bucket->last = now;
+    if (bucket->tokens < cost)
+    {
+        return false;
+    }
+    bucket->tokens -= cost;
+    return true;
+}
+
+/**
+ * @brief RPC requests need a numeric request id.
+ */
+static bool rpcTopic(const char *topic)
+{
+    if (strncmp(topic, RPC_REQUEST_PREFIX, sizeof(RPC_REQUEST_PREFIX) - 1) != 0)
+    {
+        return false;
+    }
+    const char *id = topic + sizeof(RPC_REQUEST_PREFIX) - 1;
+    if (*id == '\0')
+    {
+        return false;
+    }
+    for (; *id != '\0'; id++)
+    {
+        if (!isdigit((unsigned char)*id))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool admission_check(const char *topic, unsigned int length)
+{
+    // Attribute updates and responses are the only other topics the device
+    // subscribes to. They have their own bucket, so an RPC flood cannot starve
+    // firmware announcements.
+    if (strncmp(topic, ATTRIBUTES_PREFIX, sizeof(ATTRIBUTES_PREFIX) - 1) == 0)
+    {
+        if (!bucket_take(&attributeBucket, 1))
+        {
+            stats.droppedAttributes++;
+            return false;
+        }
+        stats.accepted++;
+        return true;
+    }
+    if (!rpcTopic(topic))
+    {
+        stats.droppedTopic++;
+        return false;
+    }
+    // Checked before the byte bucket, a rejected message costs no byte tokens
+    if (!bucket_take(&messageBucket, 1))
+    {
+        stats.droppedRate++;
+        return false;
+    }
+    if (!bucket_take(&byteBucket, length))
+    {
+        stats.droppedBytes++;
+        return false;
+    }
+    stats.accepted++;
+    return true;
+}
+
+AdmissionStats_t admission_get_stats()
+{
+    return stats;
+}
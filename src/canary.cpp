@@ -0,0 +1,479 @@
+#include "canary.h"
+#include "esp_heap_caps.h"
+
+#define CANARY_SAMPLED_METRICS (CANARY_METRIC_COUNT - 1)
+
+// Weight of a new window in the baseline of a validated image
+#define CANARY_BASELINE_WEIGHT 0.5f
+
+typedef struct {
+    double sum[CANARY_SAMPLED_METRICS];
+    float max[CANARY_SAMPLED_METRICS];
+    uint32_t samples[CANARY_SAMPLED_METRICS];
+    uint32_t reconnects;
+    // Least squares of the free heap over hours since the warm-up
+    double sumT;
+    double sumH;
+    double sumTT;
+    double sumTH;
+    uint16_t heapSamples;
+    uint32_t stackMin;
+} CanaryWindow_t;
+
+static CanaryWindow_t window;
+static bool windowOpen = true;
+static bool trial = false;                  // this image is the canary
+static char imageSha[17];
+static char validSha[17];                   // last validated image, the one a rollback must boot
+static char imageVersion[32];
+
+static CanaryReport_t pending;
+static bool reportPending = false;
+
+// canary_record() is called from the network and the sensor task
+static portMUX_TYPE canaryMux = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *metricNames[CANARY_SAMPLED_METRICS] = {"network_loop_ms", "sensor_loop_ms", "publish_age_ms"};
+static const char *verdictNames[] = {"none", "pass", "rollback", "baseline"};
+
+static void saveReport(const CanaryReport_t *report)
+{
+    Preferences prefs;
+    if (!prefs.begin(CANARY_NAMESPACE, false))
+    {
+        return;
+    }
+    prefs.putBytes("report", report, sizeof(CanaryReport_t));
+    prefs.putBool("reported", false);
+    prefs.end();
+
+    portENTER_CRITICAL(&canaryMux);
+    pending = *report;
+    reportPending = true;
+    portEXIT_CRITICAL(&canaryMux);
+}
+
+static void fillReport(CanaryReport_t *report, CanaryVerdict_t verdict, uint8_t violations,
+                       const CanaryMetrics_t *metrics, const CanaryMetrics_t *baseline)
+{
+    memset(report, 0, sizeof(CanaryReport_t));
+    report->verdict = verdict;
+    report->violations = violations;
+    report->hasBaseline = baseline != NULL;
+    strncpy(report->version, imageVersion, sizeof(report->version) - 1);
+    strncpy(report->sha, imageSha, sizeof(report->sha) - 1);
+    if (metrics != NULL)
+    {
+        report->metrics = *metrics;
+    }
+    if (baseline != NULL)
+    {
+        report->baseline = *baseline;
+    }
+}
+
+/**
+ * @brief Boots the other OTA slot again. Returns only if it does not hold the
+ *        last validated image: the slot may be empty, hold an older image, or
+ *        a download cut short since.
+ */
+static void rollback()
+{
+    const esp_partition_t *previous = esp_ota_get_next_update_partition(NULL);
+    esp_app_desc_t description;
+    char previousSha[17] = "";
+    if (previous != NULL && esp_ota_get_partition_description(previous, &description) == ESP_OK)
+    {
+        // The same 16 hex digits as esp_ota_get_app_elf_sha256()
+        for (int i = 0; i < 8; i++)
+        {
+            snprintf(previousSha + 2 * i, 3, "%02x", description.app_elf_sha256[i]);
+        }
+    }
+    if (previousSha[0] == '\0' || strcmp(previousSha, validSha) != 0)
+    {
+        Serial.printf("[CANARY] No previous image to roll back to, the other slot holds %s instead of %s\n",
+                      previousSha[0] != '\0' ? previousSha : "nothing", validSha);
+        return;
+    }
+    Serial.printf("[CANARY] Rolling back to %s in %s\n", description.version, previous->label);
+
+    Preferences prefs;
+    if (prefs.begin(CANARY_NAMESPACE, false))
+    {
+        prefs.putUChar("boots", 0);
+        prefs.end();
+    }
+    // Not esp_ota_mark_app_invalid_rollback_and_reboot(): the Arduino core marks
+    // every image valid at startup, and it would restart without a snapshot
+    if (esp_ota_set_boot_partition(previous) != ESP_OK)
+    {
+        Serial.println("[CANARY] Could not select the previous image");
+        return;
+    }
+    snapshot_restart();
+}
+
+static bool loadBaseline(CanaryMetrics_t *baseline)
+{
+    Preferences prefs;
+    bool found = false;
+    if (prefs.begin(CANARY_NAMESPACE, true))
+    {
+        found = prefs.getBytes("base", baseline, sizeof(CanaryMetrics_t)) == sizeof(CanaryMetrics_t);
+        prefs.end();
+    }
+    return found;
+}
+
+void canary_begin()
+{
+    esp_ota_get_app_elf_sha256(imageSha, sizeof(imageSha));
+    strncpy(imageVersion, esp_ota_get_app_description()->version, sizeof(imageVersion) - 1);
+    window.stackMin = UINT32_MAX;
+
+    Preferences prefs;
+    if (!prefs.begin(CANARY_NAMESPACE, false))
+    {
+        return;
+    }
+    char valid[17] = "";
+    char tried[17] = "";
+    prefs.getString("valid", valid, sizeof(valid));
+    prefs.getString("trial", tried, sizeof(tried));
+    uint8_t boots = prefs.getUChar("boots", 0);
+    if (prefs.getBytes("report", &pending, sizeof(pending)) == sizeof(pending))
+    {
+        reportPending = !prefs.getBool("reported", true);
+    }
+
+    // First install or erased NVS: nothing to compare with, this image sets the baseline
+    if (valid[0] == '\0')
+    {
+        prefs.putString("valid", imageSha);
+        strncpy(valid, imageSha, sizeof(valid) - 1);
+    }
+    strncpy(validSha, valid, sizeof(validSha) - 1);
+    trial = strcmp(valid, imageSha) != 0;
+    if (trial)
+    {
+        if (strcmp(tried, imageSha) != 0)
+        {
+            prefs.putString("trial", imageSha);
+            boots = 0;
+        }
+        boots++;
+        prefs.putUChar("boots", boots);
+    }
+    prefs.end();
+
+    if (!trial)
+    {
+        esp_ota_mark_app_valid_cancel_rollback();
+        Serial.printf("[CANARY] Image %s (%s) validated\n", imageVersion, imageSha);
+        return;
+    }
+    Serial.printf("[CANARY] Image %s (%s) on trial, boot %u of %u\n", imageVersion, imageSha, boots,
+                  CANARY_MAX_BOOTS);
+    if (boots > CANARY_MAX_BOOTS)
+    {
+        CanaryMetrics_t baseline;
+        bool hasBaseline = loadBaseline(&baseline);
+        CanaryReport_t report;
+        fillReport(&report, CANARY_ROLLBACK, CANARY_VIOLATION_RESTARTS, NULL, hasBaseline ? &baseline : NULL);
+        saveReport(&report);
+        windowOpen = false;
+        rollback();
+    }
+}
+
+void canary_record(CanaryMetric_t metric, float value)
+{
+    portENTER_CRITICAL(&canaryMux);
+    if (windowOpen)
+    {
+        if (metric == CANARY_RECONNECT)
+        {
+            window.reconnects++;
+        }
+        else if (metric < CANARY_SAMPLED_METRICS)
+        {
+            window.sum[metric] += value;
+            window.max[metric] = max(window.max[metric], value);
+            window.samples[metric]++;
+        }
+    }
+    portEXIT_CRITICAL(&canaryMux);
+}
+
+static void sampleResources()
+{
+    uint32_t stack = stall_min_stack_free();
+    uint32_t now = millis();
+    uint32_t heap = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+
+    portENTER_CRITICAL(&canaryMux);
+    window.stackMin = min(window.stackMin, stack);
+    if (now >= CANARY_WARMUP_MS)
+    {
+        double t = (now - CANARY_WARMUP_MS) / 3600000.0;
+        window.sumT += t;
+        window.sumH += heap;
+        window.sumTT += t * t;
+        window.sumTH += t * heap;
+        window.heapSamples++;
+    }
+    portEXIT_CRITICAL(&canaryMux);
+}
+
+static void closeWindow(CanaryMetrics_t *metrics)
+{
+    portENTER_CRITICAL(&canaryMux);
+    windowOpen = false;
+    portEXIT_CRITICAL(&canaryMux);
+
+    memset(metrics, 0, sizeof(CanaryMetrics_t));
+    metrics->windowMs = millis();
+    for (int i = 0; i < CANARY_SAMPLED_METRICS; i++)
+    {
+        metrics->samples[i] = window.samples[i];
+        metrics->max[i] = window.max[i];
+        metrics->mean[i] = window.samples[i] > 0 ? window.sum[i] / window.samples[i] : 0;
+    }
+    metrics->reconnectsPerHour = window.reconnects * 3600000.0f / metrics->windowMs;
+    metrics->heapSamples = window.heapSamples;
+    double n = window.heapSamples;
+    double denominator = n * window.sumTT - window.sumT * window.sumT;
+    if (n >= 2 && denominator > 0)
+    {
+        metrics->heapSlope = (n * window.sumTH - window.sumT * window.sumH) / denominator;
+    }
+    metrics->heapMin = heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT);
+    // 0 when no task was watched, the stack is not compared then
+    metrics->stackMin = window.stackMin == UINT32_MAX ? 0 : window.stackMin;
+}
+
+static bool exceeds(float value, float baseline, float factor, float slack)
+{
+    return value > baseline * factor + slack;
+}
+
+uint8_t canary_check(const CanaryMetrics_t *metrics, const CanaryMetrics_t *baseline)
+{
+    static const uint8_t loopBits[CANARY_SAMPLED_METRICS] = {
+        CANARY_VIOLATION_NETWORK_LOOP, CANARY_VIOLATION_SENSOR_LOOP, CANARY_VIOLATION_PUBLISH_AGE};
+    static const float factors[CANARY_SAMPLED_METRICS] = {
+        CANARY_LOOP_FACTOR, CANARY_LOOP_FACTOR, CANARY_PUBLISH_FACTOR};
+    static const float slacks[CANARY_SAMPLED_METRICS] = {
+        CANARY_LOOP_SLACK_MS, CANARY_LOOP_SLACK_MS, CANARY_PUBLISH_SLACK_MS};
+
+    uint8_t violations = 0;
+    // A metric without samples on either side (e.g. no WiFi) is not compared
+    for (int i = 0; i < CANARY_SAMPLED_METRICS; i++)
+    {
+        if (metrics->samples[i] > 0 && baseline->samples[i] > 0 &&
+            exceeds(metrics->mean[i], baseline->mean[i], factors[i], slacks[i]))
+        {
+            violations |= loopBits[i];
+        }
+    }
+    if (exceeds(metrics->reconnectsPerHour, baseline->reconnectsPerHour, CANARY_RECONNECT_FACTOR,
+                CANARY_RECONNECT_SLACK))
+    {
+        violations |= CANARY_VIOLATION_RECONNECTS;
+    }
+    if (metrics->heapSamples >= CANARY_MIN_HEAP_SAMPLES && baseline->heapSamples >= CANARY_MIN_HEAP_SAMPLES &&
+        metrics->heapSlope < baseline->heapSlope - CANARY_HEAP_LEAK_BPH)
+    {
+        violations |= CANARY_VIOLATION_HEAP_TREND;
+    }
+    if (baseline->heapMin > 0 && metrics->heapMin + CANARY_HEAP_MARGIN < baseline->heapMin)
+    {
+        violations |= CANARY_VIOLATION_HEAP_MIN;
+    }
+    if (metrics->stackMin > 0 &&
+        (metrics->stackMin < CANARY_STACK_MIN || metrics->stackMin < baseline->stackMin / 2))
+    {
+        violations |= CANARY_VIOLATION_STACK;
+    }
+    return violations;
+}
+
+static float blend(float baseline, float value)
+{
+    return baseline + (value - baseline) * CANARY_BASELINE_WEIGHT;
+}
+
+/**
+ * @brief Moves the baseline towards a window of a validated image. Metrics
+ *        the window has no samples of keep their baseline.
+ */
+static void updateBaseline(CanaryMetrics_t *baseline, bool hasBaseline, const CanaryMetrics_t *metrics)
+{
+    if (!hasBaseline)
+    {
+        *baseline = *metrics;
+    }
+    else
+    {
+        for (int i = 0; i < CANARY_SAMPLED_METRICS; i++)
+        {
+            if (metrics->samples[i] == 0)
+            {
+                continue;
+            }
+            baseline->mean[i] = baseline->samples[i] > 0 ? blend(baseline->mean[i], metrics->mean[i]) : metrics->mean[i];
+            baseline->max[i] = baseline->samples[i] > 0 ? blend(baseline->max[i], metrics->max[i]) : metrics->max[i];
+            baseline->samples[i] = metrics->samples[i];
+        }
+        baseline->reconnectsPerHour = blend(baseline->reconnectsPerHour, metrics->reconnectsPerHour);
+        if (metrics->heapSamples >= CANARY_MIN_HEAP_SAMPLES)
+        {
+            baseline->heapSlope = baseline->heapSamples >= CANARY_MIN_HEAP_SAMPLES
+                                      ? blend(baseline->heapSlope, metrics->heapSlope)
+                                      : metrics->heapSlope;
+            baseline->heapSamples = metrics->heapSamples;
+        }
+        baseline->heapMin = blend(baseline->heapMin, metrics->heapMin);
+        if (metrics->stackMin > 0)
+        {
+            baseline->stackMin = baseline->stackMin > 0 ? blend(baseline->stackMin, metrics->stackMin) : metrics->stackMin;
+        }
+        baseline->windowMs = metrics->windowMs;
+    }
+
+    Preferences prefs;
+    if (prefs.begin(CANARY_NAMESPACE, false))
+    {
+        prefs.putBytes("base", baseline, sizeof(CanaryMetrics_t));
+        prefs.end();
+    }
+}
+
+static void judge(const CanaryMetrics_t *metrics)
+{
+    CanaryMetrics_t baseline;
+    bool hasBaseline = loadBaseline(&baseline);
+    CanaryReport_t report;
+
+    if (!trial)
+    {
+        fillReport(&report, CANARY_BASELINE, 0, metrics, hasBaseline ? &baseline : NULL);
+        saveReport(&report);
+        updateBaseline(&baseline, hasBaseline, metrics);
+        return;
+    }
+
+    uint8_t violations = hasBaseline ? canary_check(metrics, &baseline) : 0;
+    fillReport(&report, violations != 0 ? CANARY_ROLLBACK : CANARY_PASS, violations, metrics,
+               hasBaseline ? &baseline : NULL);
+    saveReport(&report);
+    Serial.printf("[CANARY] Image %s %s, violations 0x%02x\n", imageVersion, verdictNames[report.verdict], violations);
+    if (violations != 0)
+    {
+        rollback();
+        return;
+    }
+
+    Preferences prefs;
+    if (prefs.begin(CANARY_NAMESPACE, false))
+    {
+        prefs.putString("valid", imageSha);
+        prefs.putUChar("boots", 0);
+        prefs.end();
+    }
+    strncpy(validSha, imageSha, sizeof(validSha) - 1);
+    trial = false;
+    esp_ota_mark_app_valid_cancel_rollback();
+    updateBaseline(&baseline, hasBaseline, metrics);
+}
+
+void canary_task(void *pvParameters)
+{
+    TickType_t lastWake = xTaskGetTickCount();
+    while (millis() < CANARY_WINDOW_MS)
+    {
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(CANARY_SAMPLE_MS));
+        sampleResources();
+    }
+
+    CanaryMetrics_t metrics;
+    closeWindow(&metrics);
+    judge(&metrics);
+    vTaskDelete(NULL);
+}
+
+bool canary_take_report(CanaryReport_t *report)
+{
+    portENTER_CRITICAL(&canaryMux);
+    bool found = reportPending;
+    if (found)
+    {
+        *report = pending;
+    }
+    portEXIT_CRITICAL(&canaryMux);
+    return found;
+}
+
+void canary_mark_reported()
+{
+    portENTER_CRITICAL(&canaryMux);
+    reportPending = false;
+    portEXIT_CRITICAL(&canaryMux);
+
+    Preferences prefs;
+    if (prefs.begin(CANARY_NAMESPACE, false))
+    {
+        prefs.putBool("reported", true);
+        prefs.end();
+    }
+}
+
+static void appendMetrics(JsonObject values, const char *prefix, const CanaryMetrics_t *metrics)
+{
+    char key[40];
+    for (int i = 0; i < CANARY_SAMPLED_METRICS; i++)
+    {
+        if (metrics->samples[i] == 0)
+        {
+            continue;
+        }
+        snprintf(key, sizeof(key), "%s%s", prefix, metricNames[i]);
+        values[key] = metrics->mean[i];
+        snprintf(key, sizeof(key), "%s%s_max", prefix, metricNames[i]);
+        values[key] = metrics->max[i];
+    }
+    snprintf(key, sizeof(key), "%sreconnects_per_h", prefix);
+    values[key] = metrics->reconnectsPerHour;
+    if (metrics->heapSamples >= CANARY_MIN_HEAP_SAMPLES)
+    {
+        snprintf(key, sizeof(key), "%sheap_slope_bph", prefix);
+        values[key] = metrics->heapSlope;
+    }
+    snprintf(key, sizeof(key), "%sheap_min", prefix);
+    values[key] = metrics->heapMin;
+    snprintf(key, sizeof(key), "%sstack_min", prefix);
+    values[key] = metrics->stackMin;
+}
+
+String canary_report_json(const CanaryReport_t *report)
+{
+    DynamicJsonDocument doc(1536);
+    JsonObject values = doc.to<JsonObject>();
+    values["canary_verdict"] = verdictNames[min(report->verdict, (uint8_t)CANARY_BASELINE)];
+    values["canary_violations"] = report->violations;
+    values["canary_version"] = (const char *)report->version;
+    values["canary_sha"] = (const char *)report->sha;
+    // A crash loop ends the window early, there are no metrics then
+    if (report->metrics.windowMs > 0)
+    {
+        appendMetrics(values, "canary_", &report->metrics);
+    }
+    if (report->hasBaseline)
+    {
+        appendMetrics(values, "canary_base_", &report->baseline);
+    }
+    String json;
+    serializeJson(doc, json);
+    return json;
+}
@@ -0,0 +1,353 @@
+#include "capture.h"
+
+#define CAPTURE_SAMPLES (CAPTURE_PRE_SAMPLES + CAPTURE_POST_SAMPLES)
+
+typedef struct {
+    int16_t temperature;    // 0.01 °C, CAPTURE_MISSING for a failed read
+    int16_t humidity;       // 0.01 %
+} CaptureSample_t;
+
+// Only used by the sensor task: the ring while waiting, the capture while recording
+static CaptureSample_t samples[CAPTURE_SAMPLES];
+static uint16_t head = 0;       // next ring slot
+static uint16_t filled = 0;     // samples in the ring or in the capture
+static CaptureHeader_t header;
+
+// The finished capture, written to flash by storeJob() on an executor worker
+static uint8_t encoded[CAPTURE_MAX_FILE_SIZE];
+static size_t encodedLength = 0;
+
+// Shared with the triggering tasks and the uploader, under xCaptureMutex
+static bool recording = false;
+static bool storing = false;    // encoded is waiting for or being written by storeJob()
+static uint8_t pendingReason = 0;
+static float pendingValue = 0;
+static uint32_t firstId = 0;    // oldest capture on flash
+static uint32_t nextId = 0;     // id of the next capture written
+static CaptureStats_t stats;
+
+static void capturePath(uint32_t id, char *path, size_t size)
+{
+    snprintf(path, size, CAPTURE_DIR "/%lu.bin", (unsigned long)id);
+}
+
+static size_t writeVarint(uint8_t *out, uint32_t value)
+{
+    size_t length = 0;
+    do
+    {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        out[length++] = byte | (value != 0 ? 0x80 : 0);
+    } while (value != 0);
+    return length;
+}
+
+static uint32_t zigzag(int32_t value)
+{
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+/**
+ * @brief Delta encodes the finished capture behind its header.
+ * @return Bytes of the encoded capture
+ */
+static size_t encodeCapture()
+{
+    header.samples = filled;
+    memcpy(encoded, &header, sizeof(header));
+    size_t length = sizeof(header);
+    int32_t previousTemperature = 0;
+    int32_t previousHumidity = 0;
+    for (uint16_t i = 0; i < filled; i++)
+    {
+        length += writeVarint(encoded + length, zigzag(samples[i].temperature - previousTemperature));
+        length += writeVarint(encoded + length, zigzag(samples[i].humidity - previousHumidity));
+        previousTemperature = samples[i].temperature;
+        previousHumidity = samples[i].humidity;
+    }
+    return length;
+}
+
+/**
+ * @brief Writes the encoded capture as the newest file, dropping the oldest
+ *        when CAPTURE_MAX_FILES are waiting. Runs on an executor worker, the
+ *        sensor task keeps its read period.
+ */
+static void storeJob(void *arg)
+{
+    CaptureHeader_t stored;
+    memcpy(&stored, encoded, sizeof(stored));
+
+    xSemaphoreTake(xCaptureMutex, portMAX_DELAY);
+    uint32_t id = nextId;
+    uint32_t drop = UINT32_MAX;
+    if (nextId - firstId >= CAPTURE_MAX_FILES)
+    {
+        drop = firstId++;
+        stats.dropped++;
+    }
+    xSemaphoreGive(xCaptureMutex);
+
+    char path[32];
+    if (drop != UINT32_MAX)
+    {
+        capturePath(drop, path, sizeof(path));
+        LittleFS.remove(path);
+    }
+
+    capturePath(id, path, sizeof(path));
+    File file = LittleFS.open(path, "w");
+    bool ok = file && file.write(encoded, encodedLength) == encodedLength;
+    if (file)
+    {
+        file.close();
+    }
+    if (!ok)
+    {
+        LittleFS.remove(path);
+        Serial.printf("[CAPTURE] Unable to write %s\n", path);
+    }
+    else
+    {
+        Serial.printf("[CAPTURE] %s: %u samples (%u before the trigger), %u bytes instead of %u\n",
+                      capture_reason_name(stored.reason), stored.samples, stored.preSamples, (unsigned)encodedLength,
+                      (unsigned)(stored.samples * sizeof(HistorySample_t)));
+    }
+
+    xSemaphoreTake(xCaptureMutex, portMAX_DELAY);
+    if (ok)
+    {
+        // Only visible to the uploader once it is complete
+        nextId++;
+        stats.captured++;
+        stats.bytesWritten += encodedLength;
+    }
+    else
+    {
+        stats.failed++;
+    }
+    storing = false;
+    xSemaphoreGive(xCaptureMutex);
+}
+
+/**
+ * @brief Encodes the finished capture and hands it to the executor. Should the
+ *        previous one still be waiting for its write, this one is lost.
+ */
+static void finishCapture()
+{
+    xSemaphoreTake(xCaptureMutex, portMAX_DELAY);
+    bool busy = storing;
+    storing = true;
+    if (busy)
+    {
+        stats.failed++;
+    }
+    xSemaphoreGive(xCaptureMutex);
+    if (busy)
+    {
+        Serial.println("[CAPTURE] Previous capture still being written, capture lost");
+        return;
+    }
+
+    encodedLength = encodeCapture();
+    if (!executor_submit(storeJob, NULL))
+    {
+        // Every executor job in use, the write blocks the sensor task this once
+        storeJob(NULL);
+    }
+}
+
+/**
+ * @brief Puts the ring in chronological order at the start of the buffer and
+ *        fills in the header, recording is already set.
+ */
+static void freeze(uint8_t reason, float value)
+{
+    if (filled == CAPTURE_PRE_SAMPLES)
+    {
+        // Oldest sample sits at head, rotate it to the front
+        CaptureSample_t ordered[CAPTURE_PRE_SAMPLES];
+        for (uint16_t i = 0; i < CAPTURE_PRE_SAMPLES; i++)
+        {
+            ordered[i] = samples[(head + i) % CAPTURE_PRE_SAMPLES];
+        }
+        memcpy(samples, ordered, sizeof(ordered));
+    }
+
+    time_t now = time(nullptr);
+    header.format = CAPTURE_FORMAT;
+    header.reason = reason;
+    header.periodMs = CAPTURE_PERIOD_MS;
+    // Anything before 2020 means SNTP has not set the clock yet
+    header.time = (now > 1577836800) ? (uint32_t)now : (millis() / 1000) | HISTORY_TIME_UPTIME;
+    header.preSamples = filled;
+    header.value = value;
+}
+
+void capture_begin()
+{
+    LittleFS.mkdir(CAPTURE_DIR);
+
+    // Ids are consecutive, the files left over give the range still waiting
+    uint32_t first = UINT32_MAX;
+    uint32_t last = 0;
+    File dir = LittleFS.open(CAPTURE_DIR);
+    for (File file = dir.openNextFile(); file; file = dir.openNextFile())
+    {
+        const char *name = strrchr(file.name(), '/');
+        uint32_t id = strtoul(name != NULL ? name + 1 : file.name(), NULL, 10);
+        first = min(first, id);
+        last = max(last, id);
+        file.close();
+    }
+    dir.close();
+
+    xSemaphoreTake(xCaptureMutex, portMAX_DELAY);
+    firstId = (first == UINT32_MAX) ? 0 : first;
+    nextId = (first == UINT32_MAX) ? 0 : last + 1;
+    xSemaphoreGive(xCaptureMutex);
+    Serial.printf("[CAPTURE] %lu captures waiting for upload\n", (unsigned long)(nextId - firstId));
+}
+
+void capture_add(float temperature, float humidity)
+{
+    CaptureSample_t sample;
+    if (isnan(temperature) || isnan(humidity))
+    {
+        sample.temperature = sample.humidity = CAPTURE_MISSING;
+    }
+    else
+    {
+        sample.temperature = (int16_t)constrain(lroundf(temperature * 100), -32767L, 32767L);
+        sample.humidity = (int16_t)constrain(lroundf(humidity * 100), 0L, 32767L);
+    }
+
+    if (recording)
+    {
+        samples[filled++] = sample;
+        if (filled == header.preSamples + CAPTURE_POST_SAMPLES)
+        {
+            finishCapture();
+            filled = 0;
+            head = 0;
+            xSemaphoreTake(xCaptureMutex, portMAX_DELAY);
+            recording = false;
+            xSemaphoreGive(xCaptureMutex);
+        }
+        return;
+    }
+
+    samples[head] = sample;
+    head = (head + 1) % CAPTURE_PRE_SAMPLES;
+    filled = min((uint16_t)(filled + 1), (uint16_t)CAPTURE_PRE_SAMPLES);
+
+    xSemaphoreTake(xCaptureMutex, portMAX_DELAY);
+    uint8_t reason = pendingReason;
+    float value = pendingValue;
+    pendingReason = 0;
+    recording = reason != 0;
+    xSemaphoreGive(xCaptureMutex);
+    if (reason != 0)
+    {
+        freeze(reason, value);
+    }
+}
+
+void capture_trigger(CaptureTrigger_t reason, float value)
+{
+    xSemaphoreTake(xCaptureMutex, portMAX_DELAY);
+    if (recording || pendingReason != 0)
+    {
+        // Already covered by the capture being recorded
+        stats.ignored++;
+    }
+    else
+    {
+        pendingReason = reason;
+        pendingValue = value;
+    }
+    xSemaphoreGive(xCaptureMutex);
+}
+
+uint32_t capture_pending()
+{
+    xSemaphoreTake(xCaptureMutex, portMAX_DELAY);
+    uint32_t pending = nextId - firstId;
+    xSemaphoreGive(xCaptureMutex);
+    return pending;
+}
+
+size_t capture_read_oldest(uint8_t *buffer, size_t size, uint32_t *id)
+{
+    xSemaphoreTake(xCaptureMutex, portMAX_DELAY);
+    bool pending = nextId != firstId;
+    *id = firstId;
+    xSemaphoreGive(xCaptureMutex);
+    if (!pending)
+    {
+        return 0;
+    }
+
+    char path[32];
+    capturePath(*id, path, sizeof(path));
+    File file = LittleFS.open(path, "r");
+    if (!file)
+    {
+        // Lost, e.g. a reset during the write, skip it
+        capture_remove(*id);
+        return 0;
+    }
+    size_t length = (file.size() <= size) ? file.read(buffer, file.size()) : 0;
+    bool oversized = file.size() > size;
+    file.close();
+    if (oversized)
+    {
+        // Not written by this firmware, it would block every later capture
+        Serial.printf("[CAPTURE] %s is %u bytes, more than %u, dropped\n", path, (unsigned)file.size(),
+                      (unsigned)size);
+        capture_remove(*id);
+        xSemaphoreTake(xCaptureMutex, portMAX_DELAY);
+        stats.dropped++;
+        xSemaphoreGive(xCaptureMutex);
+    }
+    return length;
+}
+
+void capture_remove(uint32_t id)
+{
+    char path[32];
+    capturePath(id, path, sizeof(path));
+    LittleFS.remove(path);
+
+    xSemaphoreTake(xCaptureMutex, portMAX_DELAY);
+    if (id == firstId && firstId != nextId)
+    {
+        firstId++;
+    }
+    xSemaphoreGive(xCaptureMutex);
+}
+
+const char *capture_reason_name(uint8_t reason)
+{
+    switch (reason)
+    {
+    case CAPTURE_TRIGGER_ANOMALY:
+        return "ANOMALY";
+    case CAPTURE_TRIGGER_WARNING:
+        return "WARNING";
+    case CAPTURE_TRIGGER_CRITICAL:
+        return "CRITICAL";
+    default:
+        return "UNKNOWN";
+    }
+}
+
+CaptureStats_t capture_get_stats()
+{
+    xSemaphoreTake(xCaptureMutex, portMAX_DELAY);
+    CaptureStats_t copy = stats;
+    xSemaphoreGive(xCaptureMutex);
+    return copy;
+}
@@ -7,10 +7,179 @@ const int   mqttPort = 1883;
 // ----------------------------------------
 
 WiFiClient espClient;
+#if CORE_IOT_USE_WEBSOCKET
+// Upgraded by connectTransport() once the socket is tuned
+WebSocketStreamClient wsClient(espClient, CORE_IOT_WEBSOCKET_PATH);
+PubSubClient client(wsClient);
+#else
 PubSubClient client(espClient);
+#endif
 
+// Set by the scheduler's report action, handled on the next loop of coreiot_task
+static volatile bool reportRequested = false;
+
+// Start of the current distribution telemetry window
+static unsigned long windowStart = 0;
+
+// Phases of the last (re)connect in ms, published as telemetry with the first
+// publish of the connection
+typedef struct {
+  uint32_t dns;
+  uint32_t tcp;
+  uint32_t connack;
+  uint32_t suback;
+  uint32_t firstPublish;  // from the start of the connect, time to operational
+  bool dnsCached;
+} ConnectTiming_t;
+
+static ConnectTiming_t connectTiming;
+static unsigned long connectStart = 0;
+static bool timingPending = false;
+
+#if COREIOT_RAW_TELEMETRY
+// Raw samples waiting for the batch to fill, see link_batch_size()
+typedef struct {
+  uint64_t ts;  // ms since the epoch
+  float temperature;
+  float humidity;
+} RawSample_t;
+
+static RawSample_t rawBatch[LINK_MAX_BATCH];
+static uint8_t rawCount = 0;
+#endif
+
+// Reports published at QoS 1 are only released (removed, marked published) on
+// their PUBACK. PubSubClient keeps no in-flight state across connections, a
+// report without PUBACK when the connection drops is published again
+typedef enum {
+  ACKED_CAPTURE,
+  ACKED_STALL,
+  ACKED_CANARY,
+  ACKED_REPORT_COUNT
+} AckedReport_t;
+
+static uint16_t awaitingAck[ACKED_REPORT_COUNT];  // packet id, 0 = none in flight
+static uint32_t awaitingKey[ACKED_REPORT_COUNT];  // capture id, stall sequence
+
+// The open window survives warm restarts: its sketches and how far it has run
+typedef struct {
+  uint32_t elapsedMs;
+  QuantileSketch_t temperature;
+  QuantileSketch_t humidity;
+} WindowSnapshot_t;
+
+
+/**
+ * @brief Resolves the server through the DNS cache and opens the TCP connection
+ *        with Nagle disabled and TCP keepalive, upgraded to a WebSocket with
+ *        CORE_IOT_USE_WEBSOCKET. PubSubClient reuses the open socket.
+ */
+static bool connectTransport() {
+  const char *host = CORE_IOT_SERVER.c_str();
+  unsigned long start = millis();
+  IPAddress ip;
+  if (!dns_cache_resolve(host, ip, &connectTiming.dnsCached)) {
+    return false;
+  }
+  connectTiming.dns = millis() - start;
+
+  start = millis();
+  if (!espClient.connect(ip, CORE_IOT_PORT.toInt(), COREIOT_CONNECT_TIMEOUT_MS)) {
+    // The cached address may be stale, look it up again next time
+    dns_cache_invalidate(host);
+    return false;
+  }
+  connectTiming.tcp = millis() - start;
+
+  // Small MQTT packets go out at once instead of waiting for the previous ACK
+  espClient.setNoDelay(true);
+  int fd = espClient.fd();
+  int enable = 1;
+  // TCP probes would keep waking the radio between the MQTT pings
+  int idle = max((int)COREIOT_TCP_KEEPALIVE_S, (int)client.getKeepAlive());
+  int interval = 5;
+  int count = 3;
+  setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &enable, sizeof(enable));
+  setsockopt(fd, IPPROTO_TCP, TCP_KEEPIDLE, &idle, sizeof(idle));
+  setsockopt(fd, IPPROTO_TCP, TCP_KEEPINTVL, &interval, sizeof(interval));
+  setsockopt(fd, IPPROTO_TCP, TCP_KEEPCNT, &count, sizeof(count));
+
+#if CORE_IOT_USE_WEBSOCKET
+  // The handshake runs on the socket just opened, PubSubClient then finds it connected
+  if (!wsClient.upgrade(host, CORE_IOT_PORT.toInt())) {
+    return false;
+  }
+#endif
+  return true;
+}
+
+static void releaseReport(AckedReport_t report, uint32_t key) {
+  switch (report) {
+  case ACKED_CAPTURE: capture_remove(key); break;
+  case ACKED_STALL: stall_mark_published(key); break;
+  case ACKED_CANARY: canary_mark_reported(); break;
+  default: break;
+  }
+}
+
+/**
+ * @brief Waits for the PUBACK of the report just published, releases it right
+ *        away if the broker lowered the publish to QoS 0.
+ */
+static void awaitAck(AckedReport_t report, uint32_t key) {
+  uint16_t id = client.getLastMessageId();
+  if (id == 0) {
+    releaseReport(report, key);
+    return;
+  }
+  awaitingAck[report] = id;
+  awaitingKey[report] = key;
+}
+
+static void onPublishAck(uint16_t id, uint8_t reasonCode) {
+  for (int i = 0; i < ACKED_REPORT_COUNT; i++) {
+    if (awaitingAck[i] != 0 && awaitingAck[i] == id) {
+      awaitingAck[i] = 0;
+      // A refusal (MQTT 5 reason >= 0x80) leaves the report for the next try
+      if (reasonCode < 0x80) {
+        releaseReport((AckedReport_t)i, awaitingKey[i]);
+      }
+    }
+  }
+}
+
+/**
+ * @brief Publishes the phase timings of the last connect once, after its first publish.
+ */
+static void reportConnectTiming() {
+  if (!timingPending) {
+    return;
+  }
+  timingPending = false;
+  connectTiming.firstPublish = millis() - connectStart;
+
+  String payload = "{\"conn_dns_ms\":" + String(connectTiming.dns) +
+                   ",\"conn_dns_cached\":" + String(connectTiming.dnsCached ? "true" : "false") +
+                   ",\"conn_tcp_ms\":" + String(connectTiming.tcp) +
+                   ",\"conn_connack_ms\":" + String(connectTiming.connack) +
+                   ",\"conn_suback_ms\":" + String(connectTiming.suback) +
+                   ",\"conn_operational_ms\":" + String(connectTiming.firstPublish) + "}";
+  client.publish("v1/devices/me/telemetry", payload.c_str());
+  Serial.println("Connect timing: " + payload);
+}
 
 void reconnect() {
+  static bool wasConnected = false;
+  if (wasConnected && !client.connected()) {
+    journal_log(EVENT_MQTT_DISCONNECT, client.state());
+    keepalive_on_drop(WiFi.status() != WL_CONNECTED);
+    canary_record(CANARY_RECONNECT, 1);
+    wasConnected = false;
+    memset(awaitingAck, 0, sizeof(awaitingAck));
+  }
+
+  // Reported if the retries outlast COREIOT_STALL_MS
+  stall_set_state("mqtt connect");
   // Loop until we're reconnected
   while (!client.connected()) {
     Serial.print("Attempting MQTT connection...");
@@ -19,12 +188,39 @@ void reconnect() {
     String clientId = "ESP32Client-";
     clientId += String(random(0xffff), HEX);
 
-    if (client.connect(clientId.c_str())) {
+    // Long enough for the next keepalive probe, pings are sent by interval below
+    client.setKeepAlive(keepalive_connect_value(WiFi.SSID().c_str()));
+
+    connectStart = millis();
+    bool transport = connectTransport();
+    unsigned long start = millis();
+    if (transport && client.connect(clientId.c_str())) {
+      connectTiming.connack = millis() - start;
         
-      Serial.println("connected to CoreIOT Server!");
+      Serial.printf("connected to CoreIOT Server! (MQTT %s)\n", client.getProtocolVersion() == MQTT_VERSION_5 ? "5" : "3.1.1");
+      journal_log(EVENT_MQTT_CONNECT);
+      wasConnected = true;
+      client.setPingInterval(keepalive_on_connect(client.getKeepAlive()));
+
+      // Every SUBSCRIBE goes out back to back, their SUBACKs are awaited together
+      start = millis();
       client.subscribe("v1/devices/me/rpc/request/+");
+      client.subscribe("v1/devices/me/attributes");
+      client.subscribe("v1/devices/me/attributes/response/+");
+      while (client.getPendingSubscribes() > 0 && client.connected() && millis() - start < COREIOT_CONNECT_TIMEOUT_MS) {
+        client.loop();
+        vTaskDelay(1);
+      }
+      connectTiming.suback = millis() - start;
+      timingPending = true;
       Serial.println("Subscribed to v1/devices/me/rpc/request/+");
 
+      // The firmware announced while we were away
+      client.publish("v1/devices/me/attributes/request/1", "{\"sharedKeys\":\"" PEER_OTA_SHARED_KEYS "\"}");
+
+    } else if (transport && client.state() == MQTT_CONNECT_BAD_PROTOCOL) {
+      // The broker refused MQTT 5, the next connect asks for 3.1.1 on a fresh socket
+      Serial.println("MQTT 5 refused, retrying with 3.1.1");
     } else {
       Serial.print("failed, rc=");
       Serial.print(client.state());
@@ -32,50 +228,470 @@ void reconnect() {
       delay(5000);
     }
   }
+  stall_set_state(NULL);
 }
 
 
 void callback(char* topic, byte* payload, unsigned int length) {
+  // Floods are dropped on topic and length alone, before any copy or parse
+  if (!admission_check(topic, length)) {
+    return;
+  }
+
   Serial.print("Message arrived [");
   Serial.print(topic);
   Serial.println("] ");
 
-  // Allocate a temporary buffer for the message
-  char message[length + 1];
-  memcpy(message, payload, length);
-  message[length] = '\0';
-  Serial.print("Payload: ");
-  Serial.println(message);
+  // Firmware announcements, only the fw_* keys are parsed
+  if (strncmp(topic, "v1/devices/me/attributes", 24) == 0) {
+    peer_ota_on_attributes(payload, length);
+    return;
+  }
+
+  // Handlers run on the RPC workers, their responses come back through rpc_take_response().
+  // A rejection is answered right here, it does not depend on room in the response queue.
+  String responseTopic;
+  String response;
+  if (!rpc_submit(topic, payload, length, responseTopic, response)) {
+    client.publish(responseTopic.c_str(), response.c_str());
+  }
+}
 
-  // Parse JSON
-  StaticJsonDocument<256> doc;
-  DeserializationError error = deserializeJson(doc, message);
+// Example: {"method": "setStateLED", "params": "ON"}
+static String rpcSetStateLED(JsonVariantConst params) {
+  const char* state = params | "";
 
-  if (error) {
-    Serial.print("deserializeJson() failed: ");
-    Serial.println(error.c_str());
-    return;
+  if (strcmp(state, "ON") == 0) {
+    Serial.println("Device turned ON.");
+    //TODO
+
+  } else {   
+    Serial.println("Device turned OFF.");
+    //TODO
+
+  }
+  return String();
+}
+
+static String rpcGetEvents(JsonVariantConst params) {
+  return journal_query_json(params);
+}
+
+// Example: {"method":"getHistory","params":{"from":1735689600,"limit":50}}
+static String rpcGetHistory(JsonVariantConst params) {
+  return history_query_json(params);
+}
+
+// Example: {"method":"rescore","params":{"all":true}} -> {"started":false} while a backfill
+// runs, progress and samples/s go to the log
+static String rpcRescore(JsonVariantConst params) {
+  bool started = tinyml_backfill_start(params["all"] | false);
+  Serial.println(started ? "Backfill started" : "Backfill already running");
+  return String("{\"started\":") + (started ? "true" : "false") + "}";
+}
+
+// Example: {"method":"setSchedule","params":{"kind":"daily","at":"07:30","action":"gpio","param":304}}
+static String rpcSetSchedule(JsonVariantConst params) {
+  ScheduleEntry_t entry;
+  uint8_t id = scheduler_entry_from_json(params, &entry) ? scheduler_add_entry(&entry) : 0;
+  return "{\"id\":" + String(id) + "}";
+}
+
+static String rpcDeleteSchedule(JsonVariantConst params) {
+  bool removed = scheduler_remove_entry(params["id"] | 0);
+  return String("{\"removed\":") + (removed ? "true" : "false") + "}";
+}
+
+static String rpcGetSchedules(JsonVariantConst params) {
+  return scheduler_list_json();
+}
+
+// Example: {"method":"startProfile","params":{"hz":97,"seconds":10}}, the result has the download URL once it stopped
+static String rpcStartProfile(JsonVariantConst params) {
+  return cpu_profile_start_json(params);
+}
+
+static String rpcStopProfile(JsonVariantConst params) {
+  return cpu_profile_stop_json();
+}
+
+static String rpcGetProfile(JsonVariantConst params) {
+  return cpu_profile_status_json();
+}
+
+/**
+ * @brief Publishes the responses the RPC workers have finished.
+ */
+static void publishRpcResponses() {
+  String topic;
+  String response;
+  while (rpc_take_response(topic, response)) {
+    client.beginPublish(topic.c_str(), response.length(), false);
+    client.print(response);
+    client.endPublish();
   }
+}
 
-  const char* method = doc["method"];
-  if (strcmp(method, "setStateLED") == 0) {
-    // Check params type (could be boolean, int, or string according to your RPC)
-    // Example: {"method": "setValueLED", "params": "ON"}
-    const char* params = doc["params"];
+/**
+ * @brief Publishes the inbound admission and RPC counters, totals since boot.
+ */
+static void publishRpcMetrics() {
+  AdmissionStats_t admission = admission_get_stats();
+  RpcStats_t rpc = rpc_get_stats();
+  String payload = "{\"inbound_accepted\":" + String(admission.accepted) +
+                   ",\"inbound_drop_topic\":" + String(admission.droppedTopic) +
+                   ",\"inbound_drop_rate\":" + String(admission.droppedRate) +
+                   ",\"inbound_drop_bytes\":" + String(admission.droppedBytes) +
+                   ",\"inbound_drop_attributes\":" + String(admission.droppedAttributes) +
+                   ",\"rpc_completed\":" + String(rpc.completed) +
+                   ",\"rpc_drop_method_rate\":" + String(rpc.rejectedRate) +
+                   ",\"rpc_drop_busy\":" + String(rpc.rejectedBusy) +
+                   ",\"rpc_drop_queue_full\":" + String(rpc.rejectedFull) +
+                   ",\"rpc_expired\":" + String(rpc.expired) +
+                   ",\"rpc_late\":" + String(rpc.late) +
+                   ",\"rpc_drop_response\":" + String(rpc.droppedResponses) + "}";
+  // Streamed, longer than the PubSubClient buffer
+  client.beginPublish("v1/devices/me/telemetry", payload.length(), false);
+  client.print(payload);
+  client.endPublish();
+}
 
-    if (strcmp(params, "ON") == 0) {
-      Serial.println("Device turned ON.");
-      //TODO
+/**
+ * @brief Publishes the link estimate and the keepalive learned, so the cadence
+ *        chosen can be followed on the dashboard, and the capture counters.
+ */
+static void publishLinkMetrics() {
+  LinkStats_t link = link_get_stats();
+  KeepaliveStats_t keepalive = keepalive_get_stats();
+  CaptureStats_t capture = capture_get_stats();
+  ExecutorStats_t executor = executor_get_stats();
+  uint32_t executorLatencyMaxUs = 0;
+  for (int i = 0; i < EXECUTOR_WORKERS; i++) {
+    executorLatencyMaxUs = max(executorLatencyMaxUs, executor.workers[i].maxLatencyUs);
+  }
+  String payload = "{\"link_quality\":" + String(link.quality, 2) +
+                   ",\"link_batch\":" + String(link.batch) +
+                   ",\"link_rssi\":" + String(link.rssi, 0) +
+                   ",\"link_send_ms\":" + String(link.sendMs, 0) +
+                   ",\"link_rtt_ms\":" + String(link.rttMs, 0) +
+                   ",\"link_failure_rate\":" + String(link.failureRate, 2) +
+                   ",\"keepalive_s\":" + String(keepalive.interval) +
+                   ",\"keepalive_safe_s\":" + String(keepalive.safe) +
+                   ",\"keepalive_limit_s\":" + String(keepalive.limit) +
+                   ",\"keepalive_failed_probes\":" + String(keepalive.failedProbes) +
+                   ",\"keepalive_drops\":" + String(keepalive.drops) +
+                   ",\"captures\":" + String(capture.captured) +
+                   ",\"captures_ignored\":" + String(capture.ignored) +
+                   ",\"captures_dropped\":" + String(capture.dropped) +
+                   ",\"captures_failed\":" + String(capture.failed) +
+                   ",\"captures_pending\":" + String(capture_pending()) +
+                   ",\"executor_jobs\":" + String(executor.submitted) +
+                   ",\"executor_rejected\":" + String(executor.rejected) +
+                   ",\"executor_latency_max_us\":" + String(executorLatencyMaxUs) + "}";
+  // Streamed, longer than the PubSubClient buffer
+  client.beginPublish("v1/devices/me/telemetry", payload.length(), false);
+  client.print(payload);
+  client.endPublish();
+}
 
-    } else {   
-      Serial.println("Device turned OFF.");
-      //TODO
+/**
+ * @brief Writes the data base64 encoded to the publish in progress.
+ */
+static void printBase64(const uint8_t *data, size_t length) {
+  static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  char chunk[64];
+  size_t used = 0;
+  for (size_t i = 0; i < length; i += 3) {
+    uint32_t bits = (uint32_t)data[i] << 16;
+    if (i + 1 < length) bits |= (uint32_t)data[i + 1] << 8;
+    if (i + 2 < length) bits |= data[i + 2];
+    chunk[used++] = alphabet[(bits >> 18) & 0x3F];
+    chunk[used++] = alphabet[(bits >> 12) & 0x3F];
+    chunk[used++] = (i + 1 < length) ? alphabet[(bits >> 6) & 0x3F] : '=';
+    chunk[used++] = (i + 2 < length) ? alphabet[bits & 0x3F] : '=';
+    if (used == sizeof(chunk)) {
+      client.write((const uint8_t *)chunk, used);
+      used = 0;
+    }
+  }
+  client.write((const uint8_t *)chunk, used);
+}
 
+/**
+ * @brief Uploads the oldest capture waiting on flash as one telemetry message,
+ *        the compressed file base64 encoded, and removes it on its PUBACK.
+ */
+static void publishCapture() {
+  static uint8_t buffer[CAPTURE_MAX_FILE_SIZE];
+  if (awaitingAck[ACKED_CAPTURE] != 0) {
+    return;
+  }
+  uint32_t id;
+  size_t length = capture_read_oldest(buffer, sizeof(buffer), &id);
+  if (length < sizeof(CaptureHeader_t)) {
+    if (length > 0) {
+      capture_remove(id);
     }
+    return;
+  }
+  CaptureHeader_t header;
+  memcpy(&header, buffer, sizeof(header));
+
+  // Stamped with the trigger time, the broker's time if the clock was not set
+  String prefix = "{\"capture_reason\":\"" + String(capture_reason_name(header.reason)) +
+                  "\",\"capture_samples\":" + String(header.samples) + ",\"capture\":\"";
+  String suffix = "\"}";
+  if ((header.time & HISTORY_TIME_UPTIME) == 0) {
+    prefix = "{\"ts\":" + String(header.time) + "000,\"values\":" + prefix;
+    suffix += "}";
+  }
+  size_t encodedLength = (length + 2) / 3 * 4;
+
+  MQTTPublishOptions options;
+  options.qos = 1;
+  bool ok = client.beginPublish("v1/devices/me/telemetry", prefix.length() + encodedLength + suffix.length(), false, options);
+  if (ok) {
+    client.print(prefix);
+    printBase64(buffer, length);
+    client.print(suffix);
+    ok = client.endPublish();
+  }
+  if (ok) {
+    Serial.printf("Published %s capture %lu (%u bytes)\n", capture_reason_name(header.reason), (unsigned long)id, (unsigned)length);
+    awaitAck(ACKED_CAPTURE, id);
+  }
+}
+
+/**
+ * @brief Publishes the verdict of the last validation window, possibly judged
+ *        by the image that was rolled back.
+ */
+static void publishCanaryReport() {
+  CanaryReport_t report;
+  if (awaitingAck[ACKED_CANARY] != 0 || !canary_take_report(&report)) {
+    return;
+  }
+  String payload = canary_report_json(&report);
+  MQTTPublishOptions options;
+  options.qos = 1;
+  bool ok = client.beginPublish("v1/devices/me/telemetry", payload.length(), false, options);
+  if (ok) {
+    client.print(payload);
+    ok = client.endPublish();
+  }
+  if (ok) {
+    Serial.println("Published canary verdict: " + payload);
+    awaitAck(ACKED_CANARY, 0);
+  }
+}
+
+/**
+ * @brief Publishes fw_state after a step of a firmware download, a lost
+ *        intermediate state is superseded by the next one.
+ */
+static void publishFirmwareState() {
+  String payload;
+  if (!peer_ota_take_state(payload)) {
+    return;
+  }
+  MQTTPublishOptions options;
+  options.qos = 1;
+  bool ok = client.beginPublish("v1/devices/me/telemetry", payload.length(), false, options);
+  if (ok) {
+    client.print(payload);
+    ok = client.endPublish();
+  }
+  if (ok) {
+    Serial.println("Published firmware state: " + payload);
+  }
+}
+
+/**
+ * @brief Publishes the oldest stall record that was not published yet.
+ */
+static void publishStallReport() {
+  StallRecord_t record;
+  if (awaitingAck[ACKED_STALL] != 0 || !stall_take_unpublished(&record)) {
+    return;
+  }
+  String payload = stall_record_json(&record);
+  MQTTPublishOptions options;
+  options.qos = 1;
+  bool ok = client.beginPublish("v1/devices/me/telemetry", payload.length(), false, options);
+  if (ok) {
+    client.print(payload);
+    ok = client.endPublish();
+  }
+  if (ok) {
+    Serial.printf("Published stall of %s\n", record.task);
+    awaitAck(ACKED_STALL, record.sequence);
+  }
+}
+
+#if COREIOT_RAW_TELEMETRY
+/**
+ * @brief Adds the current reading to the batch, the oldest sample is dropped
+ *        when publishes keep failing and the batch is full.
+ */
+static void collectRawSample() {
+  if (rawCount == LINK_MAX_BATCH) {
+    memmove(rawBatch, rawBatch + 1, (LINK_MAX_BATCH - 1) * sizeof(RawSample_t));
+    rawCount--;
+  }
+  time_t now = time(nullptr);
+  // Anything before 2020 means SNTP has not set the clock yet, untimed samples
+  // cannot share a batch and only the newest is kept
+  if (now <= 1577836800) {
+    rawCount = 0;
+  }
+  RawSample_t &sample = rawBatch[rawCount++];
+  sample.ts = (now > 1577836800) ? (uint64_t)now * 1000 : 0;
+  sample.temperature = glob_temperature;
+  sample.humidity = glob_humidity;
+}
+
+/**
+ * @brief Publishes the collected samples in one message and reports how the
+ *        publish went to the link estimator. A failed batch is kept for the next try.
+ */
+static void publishRawBatch() {
+  String payload;
+  if (rawCount == 1) {
+    payload = "{\"temperature\":" + String(rawBatch[0].temperature) + ",\"humidity\":" + String(rawBatch[0].humidity) + "}";
   } else {
-    Serial.print("Unknown method: ");
-    Serial.println(method);
+    payload = "[";
+    for (uint8_t i = 0; i < rawCount; i++) {
+      char ts[21];
+      snprintf(ts, sizeof(ts), "%llu", (unsigned long long)rawBatch[i].ts);
+      payload += String(i > 0 ? "," : "") + "{\"ts\":" + ts + ",\"values\":{\"temperature\":" + String(rawBatch[i].temperature) +
+                 ",\"humidity\":" + String(rawBatch[i].humidity) + "}}";
+    }
+    payload += "]";
+  }
+
+  // Acknowledged, the PUBACK round trip feeds the link estimate
+  MQTTPublishOptions options;
+  options.qos = 1;
+  options.messageExpiry = COREIOT_TELEMETRY_EXPIRY_S;
+
+  unsigned long start = millis();
+  bool ok = client.beginPublish("v1/devices/me/telemetry", payload.length(), false, options) &&
+            client.print(payload) == payload.length() && client.endPublish();
+  link_record_publish(millis() - start, ok);
+
+  if (ok) {
+    // Age of the oldest sample, how long batching and retries held the data back
+    if (rawBatch[0].ts != 0) {
+      canary_record(CANARY_PUBLISH_AGE_MS, (uint64_t)time(nullptr) * 1000 - rawBatch[0].ts);
+    }
+    Serial.printf("Published %u samples (link quality %.2f): %s\n", rawCount, link_quality(), payload.c_str());
+    rawCount = 0;
+  }
+}
+#endif
+
+/**
+ * @brief Appends the window summary of one metric to a telemetry payload,
+ *        e.g. "temperature_p5":..,"temperature_p50":..,"temperature_p95":..,"temperature_max":..
+ */
+void appendWindowSummary(String &payload, const char *name, const QuantileSketch_t *sketch)
+{
+  static const float quantiles[] = {0.05f, 0.50f, 0.95f};
+  static const char *suffixes[] = {"_p5", "_p50", "_p95"};
+
+  for (int i = 0; i < 3; i++) {
+    payload += ",\"" + String(name) + suffixes[i] + "\":" + String(sketch_quantile(sketch, quantiles[i]), 2);
+  }
+  payload += ",\"" + String(name) + "_max\":" + String(sketch->max, 2);
+  payload += ",\"" + String(name) + "_count\":" + String(sketch->count);
+
+#if COREIOT_SKETCH_TELEMETRY
+  char encoded[512];
+  if (sketch_encode(sketch, encoded, sizeof(encoded)) > 0) {
+    payload += ",\"" + String(name) + "_sketch\":\"" + encoded + "\"";
+  }
+#endif
+}
+
+/**
+ * @brief Publishes the summaries of the window that just ended and starts a new one.
+ *        The sketches are copied under the mutex, so the sensor task is never blocked by MQTT.
+ */
+void publishWindowSummary()
+{
+  static QuantileSketch_t temp;
+  static QuantileSketch_t humi;
+
+  if (xSemaphoreTake(xSketchMutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+    return;
+  }
+  temp = tempWindowSketch;
+  humi = humiWindowSketch;
+  sketch_reset(&tempWindowSketch);
+  sketch_reset(&humiWindowSketch);
+  xSemaphoreGive(xSketchMutex);
+
+  if (temp.count == 0 && humi.count == 0) {
+    return;
+  }
+
+  String payload = "{\"window_s\":" + String(COREIOT_WINDOW_MS / 1000);
+  if (temp.count > 0) {
+    appendWindowSummary(payload, "temperature", &temp);
   }
+  if (humi.count > 0) {
+    appendWindowSummary(payload, "humidity", &humi);
+  }
+  payload += "}";
+
+  // Tells consumers which encoding the batch carries without parsing it
+  static const char *properties[] = {"encoding", COREIOT_SKETCH_TELEMETRY ? "summary+sketch" : "summary"};
+  MQTTPublishOptions options;
+  options.messageExpiry = COREIOT_TELEMETRY_EXPIRY_S;
+  options.userProperties = properties;
+  options.userPropertyCount = 1;
+
+  // Streamed, the payload can be bigger than the PubSubClient buffer
+  client.beginPublish("v1/devices/me/telemetry", payload.length(), false, options);
+  client.print(payload);
+  client.endPublish();
+
+  Serial.println("Published window summary: " + payload);
+}
+
+
+static void saveWindowSnapshot(void *buffer)
+{
+  uint8_t *out = (uint8_t *)buffer;
+  uint32_t elapsed = millis() - windowStart;
+  memcpy(out + offsetof(WindowSnapshot_t, elapsedMs), &elapsed, sizeof(elapsed));
+
+  xSemaphoreTake(xSketchMutex, portMAX_DELAY);
+  memcpy(out + offsetof(WindowSnapshot_t, temperature), &tempWindowSketch, sizeof(QuantileSketch_t));
+  memcpy(out + offsetof(WindowSnapshot_t, humidity), &humiWindowSketch, sizeof(QuantileSketch_t));
+  xSemaphoreGive(xSketchMutex);
+}
+
+static void restoreWindowSnapshot(const void *buffer)
+{
+  const uint8_t *in = (const uint8_t *)buffer;
+  uint32_t elapsed;
+  memcpy(&elapsed, in + offsetof(WindowSnapshot_t, elapsedMs), sizeof(elapsed));
+  windowStart = millis() - min(elapsed, (uint32_t)COREIOT_WINDOW_MS);
+
+  xSemaphoreTake(xSketchMutex, portMAX_DELAY);
+  memcpy(&tempWindowSketch, in + offsetof(WindowSnapshot_t, temperature), sizeof(QuantileSketch_t));
+  memcpy(&humiWindowSketch, in + offsetof(WindowSnapshot_t, humidity), sizeof(QuantileSketch_t));
+  xSemaphoreGive(xSketchMutex);
+}
+
+/**
+ * @brief Scheduler action, runs on the dispatcher task, so the publish itself
+ *        is left to coreiot_task.
+ */
+void requestReport(int32_t param)
+{
+  reportRequested = true;
 }
 
 
@@ -103,28 +719,100 @@ void setup_coreiot(){
 
   client.setServer(CORE_IOT_SERVER.c_str(), CORE_IOT_PORT.toInt());
   client.setCallback(callback);
+  client.setAckCallback(onPublishAck);
+#if COREIOT_MQTT5
+  client.setProtocolVersion(MQTT_VERSION_5);
+#endif
+  scheduler_set_action(SCHEDULE_ACTION_REPORT, requestReport);
+
+  // Flash bound methods run one at a time, a second request is rejected as busy.
+  // Rates are per second, with the burst accepted on top
+  rpc_register("setStateLED", rpcSetStateLED, 2, 2000, 2.0f, 4);
+  rpc_register("getEvents", rpcGetEvents, 1, 10000, 0.2f, 2);
+  rpc_register("getHistory", rpcGetHistory, 1, 10000, 0.2f, 2);
+  rpc_register("rescore", rpcRescore, 1, 2000, 0.02f, 1);
+  rpc_register("setSchedule", rpcSetSchedule, 1, 5000, 0.5f, 4);
+  rpc_register("deleteSchedule", rpcDeleteSchedule, 1, 5000, 0.5f, 4);
+  rpc_register("getSchedules", rpcGetSchedules, 2, 5000, 0.5f, 2);
+  rpc_register("startProfile", rpcStartProfile, 1, 2000, 0.1f, 2);
+  rpc_register("stopProfile", rpcStopProfile, 1, 2000, 0.5f, 2);
+  rpc_register("getProfile", rpcGetProfile, 1, 2000, 1.0f, 2);
 
 }
 
 void coreiot_task(void *pvParameters){
 
+    windowStart = millis();
+    snapshot_register("window", 1, sizeof(WindowSnapshot_t), saveWindowSnapshot, restoreWindowSnapshot);
     setup_coreiot();
+    stall_register(COREIOT_STALL_MS);
+#if COREIOT_RAW_TELEMETRY
+    unsigned long lastPublish = millis() - COREIOT_PUBLISH_MS;
+#endif
+    uint16_t ackCount = 0;
+    uint16_t pingCount = 0;
 
     while(1){
+        stall_heartbeat();
 
+        // Passes that reconnect are not timed, they wait on the network
+        bool timed = client.connected();
+        unsigned long passStart = micros();
         if (!client.connected()) {
             reconnect();
         }
         client.loop();
+        publishRpcResponses();
 
-        // Sample payload, publish to 'v1/devices/me/telemetry'
-        String payload = "{\"temperature\":" + String(glob_temperature) +  ",\"humidity\":" + String(glob_humidity) + "}";
-        
-        client.publish("v1/devices/me/telemetry", payload.c_str());
+        if (client.getAckCount() != ackCount) {
+            ackCount = client.getAckCount();
+            link_record_rtt(client.getAckRtt());
+        }
+        if (client.getPingCount() != pingCount) {
+            pingCount = client.getPingCount();
+            client.setPingInterval(keepalive_on_ping(client.getPingIdle()));
+        }
 
+#if COREIOT_RAW_TELEMETRY
+        if (millis() - lastPublish >= COREIOT_PUBLISH_MS) {
+            lastPublish = millis();
+            link_record_rssi(WiFi.RSSI());
+            collectRawSample();
+            // Without a clock the samples carry no timestamp and cannot wait for a batch
+            if (rawCount >= link_batch_size() || rawBatch[0].ts == 0) {
+                publishRawBatch();
+                reportConnectTiming();
+            }
+        }
+#endif
 
-        
-        Serial.println("Published payload: " + payload);
-        vTaskDelay(10000);  // Publish every 10 seconds
+        if (millis() - windowStart >= COREIOT_WINDOW_MS || reportRequested) {
+            reportRequested = false;
+            windowStart = millis();
+            publishWindowSummary();
+            publishRpcMetrics();
+            publishLinkMetrics();
+            reportConnectTiming();
+        }
+
+        // One per pass, RPCs and pings are served between two captures
+        if (client.connected() && capture_pending() > 0) {
+            publishCapture();
+        }
+
+        // Stalls recorded before this connect, possibly before a reboot
+        if (client.connected()) {
+            publishStallReport();
+            publishCanaryReport();
+            publishFirmwareState();
+        }
+
+        if (timed) {
+            canary_record(CANARY_NETWORK_LOOP_MS, (micros() - passStart) / 1000.0f);
+        }
+
+        // Short slices keep keepalives and incoming RPCs served between the
+        // publishes, an RPC worker wakes the task as soon as a response is ready
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(COREIOT_LOOP_MS));
     }
 }
\ No newline at end of file
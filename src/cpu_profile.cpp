@@ -0,0 +1,496 @@
+#include "cpu_profile.h"
+#include "hal/cpu_hal.h"
+
+#if CONFIG_IDF_TARGET_ARCH_XTENSA
+#include "freertos/xtensa_context.h"
+#include "esp_debug_helpers.h"
+#if __has_include("esp_memory_utils.h")
+#include "esp_memory_utils.h"
+#else
+#include "soc/soc_memory_layout.h"
+#endif
+#endif
+
+// Interrupt nesting of each core, kept by the port on interrupt entry and exit
+extern "C" volatile unsigned port_interruptNesting[portNUM_PROCESSORS];
+
+// Sampler tasks check for a stop this often
+#define CPU_PROFILE_POLL_MS 100
+#define CPU_PROFILE_SAMPLER_PRIORITY 5
+
+// Written by the sampling handler of each core
+static CpuProfileSample_t *rings[portNUM_PROCESSORS];
+static volatile uint32_t heads[portNUM_PROCESSORS];        // samples taken, the next goes to head % capacity
+static volatile uint32_t nestedCount[portNUM_PROCESSORS];
+static volatile uint32_t handlerCycles[portNUM_PROCESSORS];
+static uint32_t capacity = 0;
+
+// Tasks seen by the handlers, a handle is named when it is first sampled
+static TaskHandle_t taskHandles[CPU_PROFILE_MAX_TASKS];
+static char taskNames[CPU_PROFILE_MAX_TASKS][CPU_PROFILE_NAME_LEN];
+static volatile uint8_t taskCount = 0;
+
+static uint16_t profileHz = 0;
+static uint32_t durationMs = 0;
+static uint32_t startedAt = 0;
+static uint32_t stoppedAt = 0;
+static uint32_t generation = 0;
+static uint8_t active = 0;              // sampler tasks running, or about to
+static uint8_t readers = 0;             // cpu_profile_read() copying out of the rings
+static volatile bool stopRequested = false;
+static volatile bool timerFailed = false;
+
+// Guards the task table and the bookkeeping above
+static portMUX_TYPE profileMux = portMUX_INITIALIZER_UNLOCKED;
+
+#if CONFIG_IDF_TARGET_ARCH_XTENSA
+/**
+ * @brief Maps a return address to its call instruction, as the panic handler does.
+ */
+static inline uint32_t ARDUINO_ISR_ATTR callSite(uint32_t pc)
+{
+    if (pc & 0x80000000)
+    {
+        // The top two bits hold the window increment of the call
+        pc = (pc & 0x3FFFFFFF) | 0x40000000;
+    }
+    return pc - 3;
+}
+
+/**
+ * @brief Walks the stack of the task the handler interrupted. The port saved
+ *        its context, with the register windows spilled, where pxTopOfStack
+ *        points to when the interrupt was entered.
+ */
+static uint8_t ARDUINO_ISR_ATTR captureStack(TaskHandle_t task, uint32_t *pcs)
+{
+    // pxTopOfStack is the first member of the TCB
+    const XtExcFrame *saved = *(XtExcFrame *const *)task;
+    if (!esp_stack_ptr_is_sane((uint32_t)saved))
+    {
+        return 0;
+    }
+    esp_backtrace_frame_t frame;
+    frame.pc = saved->pc;
+    frame.sp = saved->a1;
+    frame.next_pc = saved->a0;
+    if (!esp_ptr_executable((void *)frame.pc))
+    {
+        return 0;
+    }
+
+    // The interrupted instruction itself, then the calls that led to it
+    uint8_t depth = 0;
+    pcs[depth++] = frame.pc;
+    while (depth < CPU_PROFILE_DEPTH && frame.next_pc != 0 && esp_backtrace_get_next_frame(&frame))
+    {
+        uint32_t pc = callSite(frame.pc);
+        if (!esp_stack_ptr_is_sane(frame.sp) || !esp_ptr_executable((void *)pc))
+        {
+            break;
+        }
+        pcs[depth++] = pc;
+    }
+    return depth;
+}
+#endif
+
+static uint8_t ARDUINO_ISR_ATTR taskIndex(TaskHandle_t task)
+{
+    uint8_t count = taskCount;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (taskHandles[i] == task)
+        {
+            return i;
+        }
+    }
+
+    // First sample of the task, possibly on both cores at once
+    uint8_t index = CPU_PROFILE_TASK_UNKNOWN;
+    portENTER_CRITICAL_ISR(&profileMux);
+    for (uint8_t i = count; i < taskCount; i++)
+    {
+        if (taskHandles[i] == task)
+        {
+            index = i;
+        }
+    }
+    if (index == CPU_PROFILE_TASK_UNKNOWN && taskCount < CPU_PROFILE_MAX_TASKS)
+    {
+        index = taskCount;
+        const char *name = pcTaskGetName(task);
+        for (uint8_t i = 0; i < CPU_PROFILE_NAME_LEN - 1; i++)
+        {
+            taskNames[index][i] = name[i];
+            if (name[i] == '\0')
+            {
+                break;
+            }
+        }
+        taskNames[index][CPU_PROFILE_NAME_LEN - 1] = '\0';
+        taskHandles[index] = task;
+        taskCount = index + 1;
+    }
+    portEXIT_CRITICAL_ISR(&profileMux);
+    return index;
+}
+
+static void ARDUINO_ISR_ATTR sampleIsr()
+{
+    uint32_t begin = cpu_hal_get_cycle_count();
+    int core = xPortGetCoreID();
+    uint32_t head = heads[core];
+    CpuProfileSample_t *sample = &rings[core][head % capacity];
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+
+    sample->core = core;
+    sample->task = taskIndex(task);
+    sample->depth = 0;
+    sample->reserved = 0;
+    if (port_interruptNesting[core] > 1)
+    {
+        // The saved context is the task's, not the one of the handler we interrupted
+        sample->core |= CPU_PROFILE_SAMPLE_NESTED;
+        nestedCount[core]++;
+    }
+#if CONFIG_IDF_TARGET_ARCH_XTENSA
+    else
+    {
+        sample->depth = captureStack(task, sample->pc);
+    }
+#endif
+    for (uint8_t i = sample->depth; i < CPU_PROFILE_DEPTH; i++)
+    {
+        sample->pc[i] = 0;
+    }
+    heads[core] = head + 1;
+    handlerCycles[core] += cpu_hal_get_cycle_count() - begin;
+}
+
+/**
+ * @brief Runs the timer of its core for the profile. The interrupt is
+ *        allocated on the core that attaches it, hence a task per core.
+ */
+static void samplerTask(void *pvParameters)
+{
+    int core = (int)(intptr_t)pvParameters;
+    // 1 MHz from the 80 MHz APB clock
+    hw_timer_t *timer = timerBegin(CPU_PROFILE_TIMER + core, 80, true);
+    if (timer != NULL)
+    {
+        timerAttachInterrupt(timer, sampleIsr, false);
+        timerAlarmWrite(timer, 1000000 / profileHz, true);
+        timerAlarmEnable(timer);
+        while (!stopRequested && millis() - startedAt < durationMs)
+        {
+            vTaskDelay(pdMS_TO_TICKS(CPU_PROFILE_POLL_MS));
+        }
+        timerAlarmDisable(timer);
+        timerDetachInterrupt(timer);
+        timerEnd(timer);
+    }
+    else
+    {
+        timerFailed = true;
+    }
+
+    portENTER_CRITICAL(&profileMux);
+    if (--active == 0)
+    {
+        stoppedAt = millis();
+    }
+    portEXIT_CRITICAL(&profileMux);
+    vTaskDelete(NULL);
+}
+
+const char *cpu_profile_start(uint16_t hz, uint32_t seconds)
+{
+    if (hz == 0 || hz > CPU_PROFILE_MAX_HZ || seconds == 0 || seconds > 3600)
+    {
+        return "bad parameters";
+    }
+
+    portENTER_CRITICAL(&profileMux);
+    bool busy = active > 0 || readers > 0;
+    if (!busy)
+    {
+        // Keeps downloads and other starts out until the samplers are set up
+        active = portNUM_PROCESSORS;
+        generation++;
+    }
+    portEXIT_CRITICAL(&profileMux);
+    if (busy)
+    {
+        return "busy";
+    }
+
+    uint32_t samples = min((uint32_t)CPU_PROFILE_MAX_SAMPLES, (uint32_t)hz * seconds);
+    if (samples != capacity)
+    {
+        for (int core = 0; core < portNUM_PROCESSORS; core++)
+        {
+            free(rings[core]);
+            // Internal RAM, the handler may run while the flash cache is off
+            rings[core] = (CpuProfileSample_t *)heap_caps_malloc(samples * sizeof(CpuProfileSample_t),
+                                                                MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        }
+        capacity = samples;
+    }
+    bool allocated = true;
+    for (int core = 0; core < portNUM_PROCESSORS; core++)
+    {
+        allocated = allocated && rings[core] != NULL;
+        heads[core] = 0;
+        nestedCount[core] = 0;
+        handlerCycles[core] = 0;
+    }
+    taskCount = 0;
+    profileHz = hz;
+    durationMs = seconds * 1000;
+    stopRequested = false;
+    timerFailed = false;
+    startedAt = millis();
+    stoppedAt = startedAt;
+
+    if (!allocated)
+    {
+        for (int core = 0; core < portNUM_PROCESSORS; core++)
+        {
+            free(rings[core]);
+            rings[core] = NULL;
+        }
+        capacity = 0;
+        portENTER_CRITICAL(&profileMux);
+        active = 0;
+        portEXIT_CRITICAL(&profileMux);
+        return "not enough memory";
+    }
+
+    for (int core = 0; core < portNUM_PROCESSORS; core++)
+    {
+        if (xTaskCreatePinnedToCore(samplerTask, "Task Profiler", 2048, (void *)(intptr_t)core,
+                                    CPU_PROFILE_SAMPLER_PRIORITY, NULL, core) != pdPASS)
+        {
+            timerFailed = true;
+            portENTER_CRITICAL(&profileMux);
+            active--;
+            portEXIT_CRITICAL(&profileMux);
+        }
+    }
+    Serial.printf("CPU profile started, %u Hz for %lu s, the last %lu samples per core are kept\n", (unsigned)hz,
+                  (unsigned long)seconds, (unsigned long)samples);
+    return NULL;
+}
+
+void cpu_profile_stop()
+{
+    stopRequested = true;
+}
+
+CpuProfileStatus_t cpu_profile_get_status()
+{
+    CpuProfileStatus_t status = {};
+    portENTER_CRITICAL(&profileMux);
+    status.running = active > 0;
+    status.hz = profileHz;
+    status.durationMs = durationMs;
+    status.elapsedMs = (status.running ? millis() : stoppedAt) - startedAt;
+    status.capacity = capacity;
+    status.tasks = taskCount;
+    status.generation = generation;
+    portEXIT_CRITICAL(&profileMux);
+
+    uint32_t mhz = getCpuFrequencyMhz();
+    for (int core = 0; core < portNUM_PROCESSORS; core++)
+    {
+        status.taken[core] = heads[core];
+        status.dropped[core] = heads[core] > status.capacity ? heads[core] - status.capacity : 0;
+        status.nested[core] = nestedCount[core];
+        status.handlerUs[core] = handlerCycles[core] / mhz;
+    }
+    return status;
+}
+
+static uint32_t keptSamples(int core)
+{
+    return min((uint32_t)heads[core], capacity);
+}
+
+static size_t profileSize()
+{
+    size_t size = sizeof(CpuProfileHeader_t) + (size_t)taskCount * CPU_PROFILE_NAME_LEN;
+    for (int core = 0; core < portNUM_PROCESSORS; core++)
+    {
+        size += (size_t)keptSamples(core) * sizeof(CpuProfileSample_t);
+    }
+    return size;
+}
+
+size_t cpu_profile_size(uint32_t *generationOut)
+{
+    portENTER_CRITICAL(&profileMux);
+    size_t size = active == 0 && capacity > 0 ? profileSize() : 0;
+    *generationOut = generation;
+    portEXIT_CRITICAL(&profileMux);
+    return size;
+}
+
+/**
+ * @brief Copies the part of [offset, offset + length) that falls into a region
+ *        of the file starting at regionStart.
+ */
+static size_t copyRegion(const uint8_t *region, size_t regionStart, size_t regionLength, size_t offset,
+                         uint8_t *buffer, size_t length)
+{
+    if (offset >= regionStart + regionLength || offset + length <= regionStart)
+    {
+        return 0;
+    }
+    size_t from = offset > regionStart ? offset - regionStart : 0;
+    size_t to = min(regionLength, offset + length - regionStart);
+    memcpy(buffer + (regionStart + from - offset), region + from, to - from);
+    return to - from;
+}
+
+size_t cpu_profile_read(uint32_t wanted, size_t offset, uint8_t *buffer, size_t length)
+{
+    portENTER_CRITICAL(&profileMux);
+    bool valid = active == 0 && capacity > 0 && generation == wanted;
+    if (valid)
+    {
+        readers++;
+    }
+    portEXIT_CRITICAL(&profileMux);
+    if (!valid)
+    {
+        return 0;
+    }
+
+    size_t size = profileSize();
+    length = offset < size ? min(length, size - offset) : 0;
+
+    CpuProfileHeader_t header;
+    memcpy(header.magic, "CPRF", 4);
+    header.format = CPU_PROFILE_FORMAT;
+    header.cores = portNUM_PROCESSORS;
+    header.depth = CPU_PROFILE_DEPTH;
+    header.tasks = taskCount;
+    header.hz = profileHz;
+    header.nameLen = CPU_PROFILE_NAME_LEN;
+    header.durationMs = stoppedAt - startedAt;
+    header.samples = 0;
+    for (int core = 0; core < portNUM_PROCESSORS; core++)
+    {
+        header.samples += keptSamples(core);
+    }
+
+    size_t start = 0;
+    copyRegion((const uint8_t *)&header, start, sizeof(header), offset, buffer, length);
+    start += sizeof(header);
+    copyRegion((const uint8_t *)taskNames, start, (size_t)taskCount * CPU_PROFILE_NAME_LEN, offset, buffer, length);
+    start += (size_t)taskCount * CPU_PROFILE_NAME_LEN;
+    for (int core = 0; core < portNUM_PROCESSORS; core++)
+    {
+        // Oldest first: the ring wrapped once more samples were taken than it holds
+        uint32_t kept = keptSamples(core);
+        uint32_t oldest = heads[core] > capacity ? heads[core] % capacity : 0;
+        const uint8_t *ring = (const uint8_t *)rings[core];
+        size_t tail = (size_t)(capacity - oldest) * sizeof(CpuProfileSample_t);
+        size_t total = (size_t)kept * sizeof(CpuProfileSample_t);
+        if (oldest == 0)
+        {
+            copyRegion(ring, start, total, offset, buffer, length);
+        }
+        else
+        {
+            copyRegion(ring + (size_t)oldest * sizeof(CpuProfileSample_t), start, tail, offset, buffer, length);
+            copyRegion(ring, start + tail, total - tail, offset, buffer, length);
+        }
+        start += total;
+    }
+
+    portENTER_CRITICAL(&profileMux);
+    readers--;
+    portEXIT_CRITICAL(&profileMux);
+    return length;
+}
+
+static String statusJson(const char *error)
+{
+    CpuProfileStatus_t status = cpu_profile_get_status();
+    uint32_t generationNow;
+    size_t size = cpu_profile_size(&generationNow);
+
+    StaticJsonDocument<768> doc;
+    doc["running"] = status.running;
+    doc["hz"] = status.hz;
+    doc["seconds"] = status.durationMs / 1000;
+    doc["elapsed_ms"] = status.elapsedMs;
+    doc["capacity"] = status.capacity;
+    doc["tasks"] = status.tasks;
+    JsonArray taken = doc.createNestedArray("samples");
+    JsonArray dropped = doc.createNestedArray("dropped");
+    JsonArray nested = doc.createNestedArray("nested");
+    JsonArray overhead = doc.createNestedArray("overhead_pct");
+    for (int core = 0; core < portNUM_PROCESSORS; core++)
+    {
+        taken.add(status.taken[core]);
+        dropped.add(status.dropped[core]);
+        nested.add(status.nested[core]);
+        // Share of the core spent in the sampling handler
+        overhead.add(status.elapsedMs > 0 ? roundf(status.handlerUs[core] / (status.elapsedMs * 10.0f) * 1000) / 1000 : 0);
+    }
+    if (size > 0)
+    {
+        doc["size"] = size;
+        doc["url"] = "http://" + WiFi.localIP().toString() + CPU_PROFILE_PATH;
+    }
+    if (error != NULL)
+    {
+        doc["error"] = error;
+    }
+    else if (timerFailed)
+    {
+        doc["error"] = "no timer";
+    }
+    String payload;
+    serializeJson(doc, payload);
+    return payload;
+}
+
+String cpu_profile_start_json(JsonVariantConst params)
+{
+    return statusJson(cpu_profile_start(params["hz"] | CPU_PROFILE_DEFAULT_HZ,
+                                        params["seconds"] | CPU_PROFILE_DEFAULT_SECONDS));
+}
+
+String cpu_profile_stop_json()
+{
+    cpu_profile_stop();
+    return statusJson(NULL);
+}
+
+String cpu_profile_status_json()
+{
+    return statusJson(NULL);
+}
+
+void cpu_profile_register(AsyncWebServer &server)
+{
+    server.on(CPU_PROFILE_PATH, HTTP_GET, [](AsyncWebServerRequest *request)
+              {
+                  uint32_t generation;
+                  size_t size = cpu_profile_size(&generation);
+                  if (size == 0)
+                  {
+                      request->send(404, "text/plain", "No stopped profile");
+                      return;
+                  }
+                  AsyncWebServerResponse *response = request->beginResponse(
+                      "application/octet-stream", size,
+                      [generation](uint8_t *buffer, size_t maxLen, size_t index) -> size_t
+                      { return cpu_profile_read(generation, index, buffer, maxLen); });
+                  response->addHeader("Content-Disposition", "attachment; filename=\"profile.bin\"");
+                  request->send(response); });
+}
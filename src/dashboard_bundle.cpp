@@ -0,0 +1,883 @@
+#include "dashboard_bundle.h"
+
+// Bundle sha256: 68d1bc6c75cc25015805dd8a5ecb787d311e61eef236866aef4321b00a4e58a2
+const uint8_t DASHBOARD_HTML[26332] PROGMEM = {
+31,139,8,0,0,0,0,0,2,3,228,187,87,146,228,104,182,30,248,222,171,136,155,205,190,93,69,84,36,180,
+202,236,106,14,224,112,0,238,144,174,1,167,209,72,104,225,80,14,13,212,173,135,177,89,193,172,97,118,49,243,
+58,27,225,78,248,195,35,82,103,85,245,37,95,218,140,149,21,225,16,191,56,242,59,223,1,60,254,246,47,130,
+177,58,218,230,250,73,62,106,234,223,255,22,183,121,246,148,57,69,244,243,155,62,121,3,206,3,199,255,251,223,
+242,160,117,158,188,216,169,155,160,253,249,205,233,40,62,51,111,94,175,22,78,30,44,99,131,161,42,235,246,205,
+147,87,22,109,80,128,81,67,226,183,241,207,126,208,39,94,240,252,56,249,233,41,41,146,54,113,178,231,198,115,
+178,224,103,244,45,2,86,105,147,54,11,254,206,255,247,255,247,255,41,162,167,255,255,255,78,254,251,255,247,127,
+118,79,183,24,124,254,95,197,147,109,168,198,211,73,55,254,6,191,12,251,91,211,78,224,195,45,253,233,151,220,
+169,163,164,120,135,188,15,193,150,207,161,147,39,217,244,238,141,89,86,85,82,52,111,126,226,106,176,211,79,141,
+83,52,207,77,80,39,225,123,63,105,170,204,153,222,133,89,48,190,143,131,36,138,219,119,40,130,244,241,123,215,
+241,110,81,93,118,133,255,236,149,89,89,191,251,115,16,132,88,72,255,250,182,73,252,192,117,234,95,30,242,191,
+195,40,164,26,191,51,26,195,88,66,196,222,191,156,13,113,210,6,95,110,182,252,122,246,147,58,240,218,164,44,
+222,129,113,93,94,188,119,178,36,42,158,193,224,188,121,231,1,147,5,245,123,183,28,159,155,216,241,203,225,29,
+94,141,79,200,19,10,54,124,170,35,215,249,1,249,233,241,239,45,246,227,175,111,179,50,42,159,23,67,59,73,
+17,124,16,14,168,242,151,207,100,251,158,28,105,215,180,73,56,61,191,250,232,195,174,223,17,164,114,124,63,41,
+162,119,216,178,63,2,228,170,253,160,126,118,203,182,45,243,119,24,184,214,148,89,226,127,41,25,250,65,178,36,
+143,94,101,98,128,72,175,150,118,186,182,252,245,109,225,244,143,141,94,239,179,224,254,135,173,80,10,44,187,236,
+247,254,213,177,204,99,235,135,115,155,100,14,222,161,224,194,203,233,240,178,36,133,32,239,189,174,110,128,209,171,
+50,121,53,224,67,208,218,241,147,174,121,183,88,239,253,7,143,122,33,21,134,239,219,26,4,68,242,112,131,147,
+101,79,200,91,188,121,10,156,230,43,67,125,199,34,145,83,189,67,129,230,159,116,120,235,0,119,246,193,47,159,
+217,252,207,33,216,226,203,160,248,204,165,200,19,1,84,250,214,165,40,9,44,151,3,95,126,112,204,47,139,16,
+239,208,143,166,33,150,41,143,216,43,251,160,14,179,114,120,158,94,13,26,57,93,20,52,159,5,195,183,129,55,
+212,64,244,229,215,67,7,124,89,230,251,129,240,186,218,179,231,212,254,47,223,68,210,87,166,165,150,76,248,92,
+183,197,125,15,31,126,21,20,31,181,120,236,220,6,99,251,252,48,239,7,195,190,68,2,142,60,238,126,242,206,
+227,48,44,235,252,147,143,126,253,243,67,190,255,10,108,95,253,244,122,28,119,121,242,69,118,190,134,219,203,201,
+7,136,120,122,49,214,43,24,101,73,211,254,161,157,48,242,227,252,231,182,252,3,187,189,46,252,181,225,30,225,
+240,165,221,30,1,254,133,221,200,215,176,255,198,110,175,90,45,206,255,148,143,31,70,127,199,144,85,249,106,186,
+58,200,156,37,50,127,51,216,191,16,248,93,188,4,213,47,31,237,253,98,121,176,66,96,255,240,12,182,251,241,
+75,113,151,172,124,72,241,16,23,39,126,66,9,230,39,140,192,22,104,90,226,248,117,229,4,152,232,151,79,185,
+139,83,159,50,241,53,49,94,109,251,138,41,75,86,252,250,182,45,163,40,11,158,221,182,248,2,212,30,22,124,
+87,148,197,55,81,136,125,102,155,199,201,215,248,240,25,124,60,68,248,10,46,62,243,85,128,47,255,62,183,217,
+98,175,207,101,122,11,84,250,108,70,6,242,205,169,159,163,69,22,224,129,31,88,196,15,162,159,94,213,251,233,
+207,168,75,135,1,242,227,23,85,225,91,48,192,190,107,73,226,97,200,44,104,95,13,249,209,181,142,11,128,183,
+3,43,45,33,249,128,183,250,165,142,97,159,33,29,77,120,184,247,149,170,191,190,5,86,122,94,34,99,122,152,
+247,227,138,97,50,6,254,251,87,47,224,228,199,21,31,135,191,163,45,138,147,95,170,235,208,100,64,125,173,238,
+111,57,142,4,110,253,80,34,62,37,237,227,248,179,160,33,190,227,177,175,33,231,219,212,1,97,248,173,23,191,
+208,254,155,144,127,240,145,31,0,31,97,254,241,104,95,124,4,232,80,11,66,111,97,24,143,210,254,203,191,183,
+220,62,128,167,105,157,186,253,16,198,15,176,33,62,51,202,146,2,159,237,244,125,112,254,144,3,228,199,74,241,
+71,176,243,40,67,159,84,251,172,22,125,112,12,249,130,160,227,243,107,173,38,255,242,45,232,124,37,216,83,140,
+253,242,187,89,78,46,89,254,229,148,234,195,12,138,162,190,26,254,136,193,207,50,120,153,253,231,15,179,69,224,
+184,207,81,226,127,138,113,253,250,54,41,170,174,125,94,140,89,253,242,45,130,190,170,206,252,229,51,67,208,159,
+149,150,143,148,232,1,95,159,173,245,148,252,70,210,46,145,159,5,97,251,66,103,126,3,117,145,191,252,248,21,
+90,126,73,131,190,218,106,57,254,220,20,95,80,170,101,252,75,97,38,137,111,226,2,253,116,233,29,250,150,252,
+72,236,254,236,121,222,231,123,210,223,229,189,33,187,252,251,109,78,245,8,184,100,94,68,249,200,32,191,39,251,
+187,176,244,186,230,151,215,49,191,195,159,62,39,196,95,151,158,239,201,23,134,191,190,5,249,254,220,56,128,167,
+125,86,204,177,63,0,183,127,8,202,255,177,162,180,24,158,32,190,140,227,127,136,200,126,77,173,152,239,163,208,
+151,96,247,85,153,255,160,251,239,214,120,236,251,53,254,251,149,137,124,212,120,208,89,149,209,243,178,38,200,184,
+175,107,201,98,96,228,37,198,145,215,98,130,124,40,48,200,231,86,255,2,120,128,30,255,147,189,202,252,156,20,
+254,194,151,17,228,131,104,127,196,94,177,207,57,213,130,50,79,15,122,247,74,69,153,239,243,171,47,225,115,49,
+15,78,126,175,246,56,69,146,59,15,123,84,101,181,41,158,150,171,31,121,215,67,188,167,24,255,140,27,97,216,
+215,220,232,195,184,183,131,83,23,64,196,101,252,23,197,253,227,66,95,128,231,87,72,249,154,103,97,18,100,254,
+23,24,241,69,215,133,253,14,0,124,167,155,250,30,158,191,134,131,219,129,107,69,243,15,213,192,71,55,245,157,
+201,79,47,159,191,124,20,15,121,13,197,223,203,55,228,143,211,233,27,62,240,213,182,111,129,124,97,2,10,202,
+255,18,40,124,187,172,239,20,17,72,188,47,120,230,43,61,251,189,105,158,83,120,65,246,197,52,223,247,63,4,
+9,142,227,191,190,13,122,32,83,3,188,155,181,255,64,215,247,32,191,223,43,127,95,44,243,18,37,63,125,117,
+177,1,68,212,107,191,116,201,103,97,243,133,27,254,129,82,242,240,250,151,59,124,23,163,145,247,95,236,136,35,
+159,205,107,29,55,11,190,109,17,22,220,207,156,170,9,222,125,56,120,255,71,109,44,246,89,83,253,46,78,124,
+63,40,126,143,165,127,254,172,227,115,89,158,218,248,167,175,46,248,95,89,140,248,18,84,22,124,252,234,185,10,
+250,201,102,65,16,124,179,193,23,225,240,237,35,167,95,255,143,91,48,133,181,147,7,205,211,3,120,126,9,235,
+50,255,134,228,34,111,1,199,45,43,199,75,218,233,29,242,107,91,126,75,131,63,221,71,127,253,245,111,240,203,
+35,183,215,39,111,111,67,231,249,33,227,199,144,75,138,37,81,158,221,172,244,110,175,8,138,6,249,71,246,10,
+14,129,121,219,4,44,253,170,249,51,48,31,70,130,235,223,20,108,144,180,53,80,121,181,156,188,7,217,236,222,
+146,246,57,119,154,219,187,222,169,127,120,126,6,123,47,237,208,143,79,47,209,251,4,63,189,62,247,120,42,74,
+192,238,171,192,105,223,255,251,134,255,186,232,83,101,128,124,124,28,254,174,171,179,31,222,248,78,235,188,3,56,
+30,5,112,211,71,208,152,103,63,253,5,95,129,195,39,112,88,52,63,255,53,110,219,234,29,12,15,195,240,118,
+192,223,150,117,4,99,8,130,44,131,255,250,180,60,13,229,203,241,231,191,62,24,11,5,254,255,235,95,240,53,
+152,95,57,109,252,4,130,62,123,174,187,44,248,249,175,139,135,75,223,255,235,147,255,243,95,53,250,9,139,177,
+158,140,201,30,147,217,158,148,233,51,43,99,103,58,38,231,191,194,47,211,151,213,193,209,155,31,31,98,71,0,
+157,254,9,196,166,222,146,79,104,140,103,111,137,39,236,9,125,75,189,101,193,111,246,249,45,3,62,200,39,236,
+45,245,188,124,162,111,241,30,92,206,94,143,159,63,221,91,134,62,63,230,61,47,75,196,207,120,6,14,158,177,
+229,218,51,184,8,70,60,6,144,207,96,252,178,38,56,198,207,244,91,84,69,223,162,79,228,91,38,251,116,143,
+125,236,186,76,155,53,6,220,35,29,236,177,15,249,96,142,200,211,203,241,203,57,80,251,249,183,76,59,36,97,
+242,79,96,90,160,12,144,213,121,177,217,67,7,20,121,194,159,62,157,35,40,242,140,207,26,14,78,216,183,148,
+67,1,3,46,63,203,13,246,9,201,128,165,8,48,146,112,8,240,73,188,220,64,158,169,183,216,19,50,107,111,
+105,48,150,113,80,100,25,131,188,206,66,9,96,199,207,38,50,224,147,249,48,17,69,129,121,145,223,48,217,146,
+254,255,4,38,35,158,232,51,233,0,109,31,234,0,113,123,44,70,123,70,6,17,51,231,64,239,152,0,183,49,
+16,169,15,141,136,223,84,7,96,233,63,129,54,192,47,192,213,192,125,228,19,241,26,0,75,62,0,151,80,42,
+13,220,136,162,50,8,114,144,88,164,76,156,81,66,70,123,144,61,36,200,30,240,195,125,154,5,252,250,88,104,
+206,209,167,71,64,61,161,175,9,1,150,120,28,47,201,128,253,134,41,154,160,94,154,135,127,2,107,0,116,64,
+9,128,140,64,17,228,137,254,120,12,140,66,254,142,86,203,216,127,167,202,160,34,68,255,4,10,47,192,10,124,
+219,19,49,126,70,101,20,5,7,203,41,238,124,238,218,103,252,113,2,252,15,74,70,191,0,225,23,158,95,238,
+50,103,82,254,45,168,3,196,167,170,166,103,80,205,111,255,20,46,6,26,163,25,254,4,170,5,186,248,246,129,
+118,61,80,34,166,207,32,116,23,88,103,95,243,119,113,230,82,115,176,87,103,18,191,161,161,91,102,237,63,129,
+106,236,226,16,117,169,61,108,12,156,3,48,246,137,126,162,159,89,153,121,251,91,190,1,204,172,137,255,25,226,
+112,17,61,38,179,151,186,35,163,228,25,151,209,51,56,140,137,89,195,158,64,84,98,139,58,40,38,227,192,99,
+75,133,5,136,75,159,169,151,19,164,103,150,176,5,167,223,106,249,137,93,122,117,82,181,127,15,187,226,241,196,
+238,105,11,250,70,9,232,248,195,163,49,139,126,124,250,229,79,224,168,105,159,192,84,253,240,244,243,211,155,223,
+86,243,205,251,215,177,47,36,31,12,102,144,247,127,106,227,164,121,105,243,34,112,229,229,224,195,213,164,246,186,
+60,12,0,249,244,2,112,19,123,250,143,79,26,48,200,91,115,3,142,94,86,121,255,105,127,48,194,47,193,4,
+192,42,223,122,53,96,145,193,58,11,150,51,253,240,195,67,188,159,158,222,44,98,252,248,254,79,224,99,121,220,
+201,181,109,157,128,238,46,248,225,205,171,7,222,128,49,139,15,48,228,241,243,253,177,15,54,189,140,92,122,156,
+239,15,121,161,217,159,143,121,21,179,173,203,91,112,89,22,120,232,15,244,120,53,229,203,75,190,199,157,195,194,
+247,159,254,237,223,158,208,143,243,114,231,22,172,128,57,178,197,14,63,60,104,249,143,79,63,255,253,163,249,189,
+15,247,254,208,2,47,35,31,18,61,142,190,18,220,91,76,0,100,254,205,251,211,239,223,175,193,237,23,207,252,
+214,136,37,154,23,195,44,143,12,126,83,140,23,59,129,97,47,170,254,238,168,231,15,254,248,204,184,175,78,113,
+170,42,40,252,85,156,100,254,15,47,43,128,27,117,208,118,117,241,106,178,247,127,250,245,131,141,65,90,123,55,
+96,194,79,182,254,194,53,143,246,231,233,95,255,245,233,219,139,255,242,51,8,252,71,191,86,57,75,167,244,230,
+233,63,125,103,212,187,167,55,127,14,252,192,13,220,69,237,199,110,95,233,243,218,223,61,212,254,122,246,207,223,
+217,99,161,135,239,30,81,242,200,151,12,160,67,246,93,5,30,119,30,235,52,255,25,249,47,95,140,255,190,73,
+151,222,209,115,170,197,79,143,78,240,205,239,205,249,216,169,190,12,111,65,220,253,240,204,190,84,130,37,84,190,
+158,188,64,203,219,79,143,126,22,212,120,221,214,7,192,234,212,181,51,1,213,168,151,135,115,31,220,250,233,202,
+155,215,213,150,174,253,31,137,248,101,220,71,17,150,147,175,196,255,20,241,191,53,98,250,195,17,47,79,16,10,
+47,46,151,4,120,147,39,190,255,146,100,191,53,193,47,243,164,112,138,246,217,5,26,45,214,94,166,45,13,113,
+237,100,191,55,239,227,19,27,48,158,64,254,104,224,240,17,134,64,181,245,127,119,221,215,172,252,51,232,93,192,
+191,55,223,73,160,143,83,193,189,143,70,143,130,246,213,226,252,180,241,63,196,91,226,255,248,197,84,176,212,135,
+189,235,32,172,131,38,254,48,178,119,178,110,73,202,95,255,244,161,180,188,173,64,8,149,237,84,5,31,198,2,
+39,127,44,64,63,188,76,248,4,124,31,42,199,103,117,228,67,66,123,153,147,87,129,15,110,62,170,6,48,248,
+15,47,7,206,248,178,204,199,60,3,183,126,252,116,226,140,63,126,42,85,96,215,7,228,190,174,245,252,249,148,
+39,248,35,122,131,73,95,222,251,227,28,251,24,236,192,238,255,237,63,252,242,178,213,127,124,250,182,244,253,250,
+244,31,126,249,206,213,255,246,199,123,128,149,63,165,254,119,192,224,167,23,5,63,170,254,217,45,233,245,249,234,
+143,95,4,205,242,107,245,242,204,24,88,229,97,196,7,130,126,244,207,23,219,125,177,197,135,7,182,139,239,146,
+240,181,136,45,194,23,209,82,12,1,188,161,203,173,15,232,252,1,172,150,208,120,241,197,135,247,25,96,227,15,
+182,250,106,145,231,207,42,230,227,229,195,55,174,7,180,26,72,246,97,165,31,95,235,203,103,11,96,96,129,69,
+186,127,249,92,220,47,101,122,44,244,64,197,79,11,125,38,230,242,120,15,236,91,45,223,202,219,20,237,171,136,
+255,249,33,207,127,121,219,100,137,183,60,203,3,128,66,125,148,181,45,127,107,194,19,244,132,254,198,164,151,220,
+94,38,126,176,203,243,139,210,239,255,148,5,32,114,131,166,203,150,219,128,99,1,108,126,250,97,185,216,196,73,
+184,92,67,169,247,175,199,127,95,6,188,30,63,3,70,242,41,179,156,37,236,31,202,252,253,239,47,3,126,124,
+250,215,39,100,12,195,15,18,184,203,8,32,251,183,247,95,55,255,183,87,243,191,24,203,1,202,252,224,2,41,
+157,31,129,235,94,196,255,241,233,111,127,123,153,188,24,240,213,206,111,254,252,6,12,125,89,227,109,91,30,64,
+80,23,209,15,64,245,183,149,227,31,150,183,242,63,80,11,79,91,64,106,161,170,47,28,245,111,240,203,151,34,
+151,47,33,254,253,111,126,210,47,249,223,52,63,191,121,253,178,224,155,47,46,126,249,93,61,112,47,201,163,47,
+238,129,243,55,79,77,237,253,252,57,179,175,138,232,253,2,216,20,241,83,114,230,141,253,128,40,82,84,114,224,
+63,253,112,138,215,167,136,227,120,135,0,167,34,191,226,108,240,185,10,205,52,54,151,1,43,139,223,92,44,13,
+28,53,7,240,75,93,71,242,1,183,104,6,28,71,220,58,91,239,206,123,162,48,112,127,69,199,222,21,191,133,
+208,13,198,19,204,106,221,163,177,45,78,92,195,217,110,42,240,129,106,140,251,116,181,139,98,66,228,84,46,47,
+60,107,181,195,227,74,184,12,182,34,85,115,126,242,133,125,181,74,2,153,151,142,3,183,83,111,205,229,120,216,
+149,149,74,202,106,178,227,162,72,66,136,72,61,198,135,195,221,238,178,105,69,90,210,96,19,19,190,69,51,148,
+46,32,207,173,49,12,35,15,104,101,97,215,60,244,89,167,103,225,121,94,233,215,166,191,6,13,230,234,180,28,
+178,40,221,7,46,35,175,199,245,142,123,252,183,225,79,170,185,87,94,78,86,187,117,179,70,95,142,249,237,250,
+60,8,143,195,45,119,26,142,167,151,203,235,219,222,226,180,199,225,109,123,20,173,136,144,74,191,184,187,17,17,
+187,92,20,215,2,158,77,16,163,108,46,115,223,242,45,77,135,177,236,212,14,229,89,108,171,242,228,49,181,79,
+59,191,185,202,21,139,216,7,44,57,114,139,24,138,208,139,183,81,59,234,73,205,174,177,25,181,209,152,13,237,
+221,80,221,231,80,67,252,141,189,107,119,109,20,58,174,67,93,16,109,83,187,38,227,194,173,176,18,27,154,246,
+28,204,190,16,238,139,112,211,145,216,222,33,197,189,55,46,57,139,40,219,88,6,177,140,113,59,163,102,148,249,
+124,197,91,35,94,247,248,238,2,99,35,144,1,183,77,77,208,129,23,129,29,132,67,46,139,186,53,239,93,220,
+198,102,65,65,5,228,122,97,251,93,220,81,216,76,171,107,179,118,68,99,70,253,51,42,44,50,175,185,108,229,
+80,215,118,218,18,120,74,203,245,168,9,216,132,162,225,254,162,12,38,172,24,33,61,83,228,189,165,235,18,114,
+199,205,67,186,108,77,14,199,35,12,44,120,74,25,56,162,46,88,237,249,46,138,22,61,4,181,247,53,252,24,
+164,159,178,78,177,67,189,161,103,135,57,238,2,196,244,173,50,203,239,116,139,9,137,190,58,166,86,24,238,152,
+23,109,247,162,135,12,112,13,193,28,74,165,233,100,231,72,216,55,206,198,59,172,31,247,207,27,60,146,250,173,
+197,50,167,246,197,206,145,253,93,63,242,71,94,127,13,135,3,88,147,27,94,98,65,212,254,29,177,240,191,217,
+26,151,35,55,106,193,250,124,56,31,102,244,140,88,187,44,114,119,85,202,248,23,44,201,233,59,36,160,108,106,
+13,113,236,142,16,116,188,145,210,110,72,44,54,23,105,150,216,237,198,120,75,225,69,167,142,16,77,80,234,206,
+245,173,214,127,248,103,27,21,131,117,94,229,119,180,19,20,27,143,99,14,19,55,208,190,235,152,163,146,139,240,
+74,18,45,240,83,192,226,101,247,136,65,77,184,174,20,82,69,243,17,221,19,221,16,220,186,176,203,153,216,119,
+195,245,90,237,143,110,62,227,135,232,17,11,131,236,137,232,193,174,185,224,214,143,136,152,233,178,119,54,104,9,
+31,145,203,13,63,197,21,250,200,129,181,176,229,117,95,216,214,43,105,79,68,60,219,94,141,142,150,245,250,101,
+141,104,165,80,242,157,5,185,158,12,212,81,15,79,148,85,8,130,118,18,141,212,199,177,18,245,253,120,89,132,
+231,250,93,222,197,148,80,54,37,61,135,10,212,192,91,67,132,220,14,66,48,178,105,246,12,191,44,70,221,218,
+193,188,8,250,185,240,125,107,19,27,217,108,105,83,69,17,142,148,23,184,31,215,237,176,236,41,156,102,68,233,
+161,128,67,46,44,174,111,236,189,15,150,182,219,19,200,125,181,83,87,243,75,30,160,155,57,10,110,43,5,49,
+43,105,53,11,171,66,179,240,249,78,39,253,110,247,144,39,221,71,103,45,226,143,96,110,100,82,116,215,242,189,
+75,159,154,197,167,92,16,243,30,75,22,59,41,114,243,248,138,98,54,25,250,171,225,81,6,216,168,107,160,5,
+187,36,100,179,41,168,94,91,19,10,66,115,76,236,26,9,34,209,29,171,46,234,114,194,121,91,167,221,13,115,
+234,110,182,187,109,30,228,250,110,62,245,177,176,234,110,20,173,93,108,252,17,63,226,193,26,247,5,125,165,66,
+176,215,181,59,238,82,190,150,94,100,72,98,221,99,17,9,96,11,226,236,234,8,129,38,111,21,184,201,132,5,
+85,199,156,203,135,189,206,91,127,191,9,205,147,43,91,86,188,23,32,181,107,10,46,44,174,22,49,104,88,208,
+161,143,61,148,40,144,253,112,110,39,28,223,14,220,53,201,117,178,45,234,248,97,36,165,218,142,240,137,209,197,
+222,79,15,210,218,100,96,108,117,18,32,171,141,43,29,191,146,242,110,177,247,234,190,247,66,20,54,18,44,46,
+212,170,139,30,117,176,220,104,50,42,11,103,23,247,144,56,22,206,87,55,29,79,35,92,37,115,250,72,12,160,
+154,66,20,117,175,119,23,130,56,107,195,69,157,94,226,160,189,198,163,185,11,23,31,183,43,67,116,177,11,66,
+156,117,159,44,172,107,58,27,141,186,204,61,113,8,85,119,190,20,79,193,237,234,152,214,139,30,28,5,226,112,
+222,76,7,161,149,65,13,142,30,155,108,78,7,105,190,174,135,205,86,235,136,71,68,110,128,207,229,53,27,204,
+37,189,57,33,110,191,34,94,226,225,176,2,242,160,104,119,65,6,116,115,196,183,143,216,230,69,144,43,197,113,
+142,36,199,223,142,143,252,17,185,125,212,245,215,110,62,224,130,237,56,158,184,222,46,243,203,213,102,141,210,230,
+206,149,79,162,77,174,186,181,195,232,203,245,157,112,218,212,185,95,232,74,160,199,110,53,122,187,219,98,159,72,
+138,142,86,51,25,68,92,239,201,116,88,176,158,63,69,6,79,249,197,126,126,200,14,50,53,55,56,231,165,222,
+174,110,170,121,157,0,212,164,250,185,247,91,224,139,214,59,135,245,182,205,69,13,147,26,104,194,112,112,173,217,
+23,16,30,144,70,135,75,20,76,250,218,226,183,187,23,174,81,67,43,102,67,48,43,182,68,163,25,14,49,236,
+134,179,105,137,129,117,167,187,45,113,187,243,109,208,142,98,76,50,228,174,97,45,95,186,109,203,171,43,141,167,
+53,211,211,0,107,170,169,197,8,94,114,234,128,44,215,167,123,175,12,117,53,157,97,43,83,19,156,141,15,49,
+155,69,123,111,19,110,237,22,31,173,43,81,137,243,38,87,177,173,6,91,151,27,169,97,116,29,198,40,11,202,
+248,182,162,79,244,145,86,251,65,227,140,149,134,174,69,46,31,194,83,179,82,136,56,176,183,245,124,79,175,212,
+157,168,141,251,169,8,39,100,46,183,84,13,95,117,49,8,101,187,186,24,116,79,212,233,213,168,210,208,187,154,
+87,148,29,123,99,196,106,97,2,61,18,109,176,55,136,188,11,54,118,60,39,209,10,163,54,199,250,198,25,115,
+157,185,119,30,178,202,3,235,238,92,248,56,167,106,113,186,30,85,198,134,136,22,38,45,229,158,203,2,89,24,
+16,46,69,209,14,219,140,217,189,148,167,202,33,147,228,84,231,32,118,214,220,89,188,47,57,6,216,68,98,123,
+103,158,189,87,114,178,149,212,105,175,108,173,82,184,186,120,136,30,87,32,248,13,222,139,230,19,63,6,80,127,
+219,64,222,177,53,242,70,217,147,214,49,205,46,108,108,201,135,0,142,13,73,186,236,111,36,89,160,3,201,94,
+89,147,65,115,228,48,165,87,19,57,239,122,75,86,246,126,172,198,48,223,94,225,59,105,24,161,57,3,124,8,
+160,50,164,15,77,55,223,40,212,39,75,216,128,173,181,197,69,70,67,113,210,41,210,121,10,196,17,39,30,141,
+76,229,41,123,80,112,141,163,213,187,45,99,215,13,135,232,199,113,218,51,170,16,145,240,150,81,188,110,100,146,
+91,192,43,248,221,74,215,176,43,21,198,154,194,58,250,114,49,171,180,107,152,104,212,35,88,188,178,110,78,164,
+146,86,10,165,232,80,14,137,9,163,127,55,157,13,221,108,143,187,126,85,225,129,82,248,5,106,210,123,30,111,
+135,21,90,114,215,3,135,136,29,175,123,220,121,189,25,67,12,158,70,149,0,131,44,86,19,183,72,30,238,168,
+163,125,63,66,126,151,251,128,217,110,155,8,34,79,199,118,138,11,230,54,223,73,144,171,222,25,223,37,180,181,
+91,237,65,0,142,157,19,1,239,121,38,159,15,218,42,40,226,22,43,224,112,10,215,69,42,219,248,33,37,72,
+16,29,156,225,223,128,253,110,66,10,106,46,127,85,6,181,174,79,116,115,197,166,105,77,111,208,234,160,209,98,
+119,163,239,120,76,251,71,169,246,78,0,103,58,184,216,160,52,210,57,4,17,217,173,127,208,187,123,144,143,187,
+252,94,200,152,132,138,59,85,240,39,120,157,46,124,207,131,37,242,124,13,59,170,61,52,74,224,136,59,214,61,
+237,84,35,231,203,205,122,229,16,252,180,85,185,46,129,114,63,63,134,23,254,88,97,68,147,152,65,235,86,101,
+107,140,14,114,46,116,143,56,10,107,164,155,165,160,91,48,208,74,167,182,193,183,18,142,95,58,146,191,168,171,
+4,109,3,130,247,123,137,108,79,104,36,120,147,44,221,163,30,93,175,118,171,133,47,136,183,202,45,66,239,82,
+236,215,136,8,141,7,153,181,194,245,136,237,58,247,226,4,219,155,123,224,165,36,205,167,11,57,49,218,129,175,
+147,178,45,218,221,52,36,67,55,98,236,188,18,24,176,94,30,69,232,154,223,53,229,57,0,216,50,157,246,199,
+91,71,88,151,29,45,65,148,112,188,230,158,41,141,221,170,192,2,80,81,14,65,232,49,27,76,219,106,133,139,
+119,234,105,7,178,133,212,64,176,19,201,172,96,204,245,222,209,85,152,144,219,122,39,145,183,157,174,243,251,251,
+102,149,108,9,254,206,169,252,222,23,42,104,102,86,74,145,199,42,99,136,55,55,173,36,42,182,27,205,178,134,
+62,164,250,114,80,168,91,96,250,187,245,241,192,78,208,120,181,21,250,180,91,27,5,176,103,172,77,229,58,82,
+118,231,18,17,177,60,44,182,119,187,74,109,42,56,182,190,10,98,148,160,253,152,68,177,18,105,140,222,220,30,
+239,29,129,96,87,144,81,180,174,198,87,13,155,46,3,223,93,21,225,188,163,244,61,167,37,54,89,115,219,45,
+176,255,220,139,231,106,190,39,133,28,199,6,230,53,86,68,123,144,106,76,219,104,173,219,86,139,57,253,157,81,
+3,245,66,140,240,220,197,250,145,183,156,59,127,187,111,196,104,197,129,124,90,237,183,251,241,94,108,224,120,139,
+20,150,232,186,128,173,248,204,94,88,239,153,26,102,125,186,208,197,4,194,96,205,22,117,238,168,100,96,230,1,
+0,136,116,144,57,125,39,43,107,180,2,192,190,242,171,38,52,213,100,223,9,190,100,116,132,107,153,106,190,130,
+194,13,113,59,238,144,53,55,41,4,159,112,213,46,111,141,10,77,202,121,151,185,88,66,162,68,227,112,215,189,
+31,232,40,168,185,71,138,142,204,108,199,97,103,94,216,237,132,141,26,73,27,30,180,16,8,85,172,20,208,28,
+103,220,165,80,163,209,209,243,53,202,160,23,31,67,54,182,213,172,242,97,123,59,68,216,73,60,158,118,236,182,
+136,164,146,187,137,156,21,248,119,32,26,190,173,221,173,227,117,130,88,106,238,28,220,52,49,192,187,162,144,210,
+197,6,92,3,234,65,148,14,192,6,202,62,185,162,114,57,156,12,197,214,202,237,133,36,58,244,82,40,145,129,
+106,198,62,42,221,14,199,189,1,179,215,243,121,135,182,123,14,89,5,42,125,74,239,68,155,213,25,177,203,146,
+209,89,143,118,155,3,238,106,202,100,179,129,97,179,91,67,114,116,219,21,242,42,26,55,158,165,192,120,79,102,
+247,110,115,129,128,139,65,159,223,165,6,220,31,235,110,4,185,65,71,229,218,86,142,68,122,3,68,86,77,41,
+184,77,14,131,114,90,73,32,71,206,37,231,172,76,192,193,110,52,90,212,226,205,43,250,221,241,192,108,142,42,
+26,157,194,98,6,53,206,219,155,10,53,42,252,64,233,177,108,92,232,91,100,74,213,25,6,137,106,200,118,18,
+171,141,89,112,67,49,34,26,17,36,202,154,38,38,95,208,154,139,58,196,56,94,32,9,46,91,125,96,198,39,
+146,74,56,9,115,170,92,106,91,55,134,143,158,221,178,186,123,0,160,76,117,139,156,119,104,145,83,180,113,108,
+68,91,252,232,164,23,108,75,251,84,107,214,16,23,156,1,201,179,53,103,101,92,183,222,26,193,236,155,192,214,
+194,89,29,90,211,2,141,188,14,16,95,152,238,167,216,82,99,234,116,142,128,176,26,17,222,33,117,238,217,253,
+4,219,153,56,211,4,196,52,157,213,170,52,27,6,157,169,120,150,165,179,184,35,204,30,235,153,99,99,194,67,
+96,166,110,56,15,49,178,113,143,138,68,143,232,13,95,109,150,94,244,130,118,141,3,157,12,125,27,187,78,232,
+75,74,79,167,57,23,181,41,168,87,1,86,201,34,43,86,208,33,231,5,91,156,182,156,115,151,65,202,11,156,
+25,229,221,193,55,232,137,15,36,171,160,49,70,68,55,112,80,236,99,149,74,140,144,116,132,110,139,23,106,6,
+35,39,0,13,227,217,184,176,59,181,5,221,136,30,67,112,39,15,48,46,11,209,213,172,229,194,81,83,150,98,
+60,63,52,249,104,207,150,14,68,72,85,82,229,6,202,222,170,236,184,61,204,114,237,93,76,207,31,78,194,154,
+152,26,201,188,54,71,204,69,187,213,16,230,123,14,61,29,46,101,148,115,33,175,159,114,91,80,238,33,11,39,
+25,97,171,231,213,72,95,208,243,112,54,231,156,106,204,96,227,210,141,125,109,60,131,86,129,219,162,17,135,207,
+171,221,241,136,156,55,200,230,68,166,163,134,216,231,94,187,182,247,164,214,2,29,119,29,193,242,175,26,151,184,
+73,150,39,1,211,123,128,40,23,185,68,214,182,14,240,125,123,89,240,157,92,103,227,49,111,186,176,89,29,153,
+169,208,45,86,184,223,101,182,43,173,140,103,245,84,106,66,230,158,138,176,23,220,16,25,107,233,178,24,88,22,
+38,145,61,49,99,0,80,15,232,74,118,118,88,74,238,16,87,7,141,23,6,224,244,64,171,156,132,234,37,168,
+216,153,67,246,27,129,189,151,82,117,228,152,181,7,120,207,245,222,228,3,116,247,122,75,63,90,251,189,81,111,
+56,247,122,196,113,141,104,233,20,48,124,91,172,233,179,188,99,67,188,240,24,218,76,220,1,90,211,54,164,163,
+248,140,158,142,198,64,36,92,123,15,206,216,245,94,69,170,67,201,134,19,55,213,208,156,218,23,188,218,41,150,
+31,172,28,76,184,128,188,65,151,188,49,246,188,167,225,194,138,106,51,183,45,98,222,133,100,25,218,70,142,221,
+245,235,234,182,69,46,179,230,183,76,120,25,240,243,72,56,249,180,159,171,221,197,57,163,214,62,228,111,160,209,
+140,84,128,71,236,69,144,162,56,63,88,130,190,19,230,49,186,89,113,123,96,237,245,149,198,78,72,167,116,30,
+173,161,206,45,102,123,136,130,176,35,49,81,76,176,154,59,40,208,35,104,11,106,241,185,8,102,108,226,200,179,
+187,182,111,7,154,129,218,56,191,29,54,210,85,50,188,53,218,31,106,63,49,156,203,171,204,131,179,186,92,185,
+18,201,2,183,168,189,36,52,84,7,9,249,162,30,251,106,190,32,151,75,239,91,130,42,167,202,86,132,25,92,
+171,7,40,12,67,145,34,8,167,154,233,139,62,181,250,165,30,211,157,39,194,231,233,106,73,137,208,35,216,41,
+223,68,155,77,196,145,183,141,126,94,177,247,205,54,18,65,15,164,93,200,89,135,13,22,130,227,217,71,79,218,
+101,164,40,134,218,42,25,17,222,44,21,202,80,219,135,145,209,51,99,244,206,4,119,246,4,109,4,136,170,175,
+185,113,4,4,41,73,194,251,177,29,236,88,67,50,220,114,123,111,152,108,241,120,222,185,78,206,219,27,231,150,
+106,227,85,230,194,169,184,247,134,96,193,128,188,234,200,153,244,203,38,234,105,208,247,207,110,159,18,46,65,73,
+40,10,65,101,237,210,81,50,151,138,180,166,210,178,165,46,45,219,248,126,120,14,15,222,176,54,58,53,240,117,
+129,64,35,80,139,35,253,188,126,200,31,31,14,198,44,70,102,157,210,35,182,53,231,2,37,48,73,68,33,160,
+191,63,30,247,117,34,27,3,222,203,113,214,153,184,78,18,39,188,191,28,178,51,113,185,61,122,59,247,222,26,
+231,243,190,53,26,228,158,48,53,53,107,229,48,210,110,105,105,128,244,156,208,147,129,85,209,133,147,120,29,216,
+136,155,26,31,29,216,117,74,83,88,37,14,212,69,187,0,4,147,230,195,161,110,46,85,220,25,206,36,130,92,
+14,184,53,182,58,75,158,182,199,229,189,139,182,82,113,45,84,245,52,210,43,225,234,237,102,45,139,239,37,14,
+234,198,210,9,56,12,121,119,202,16,109,88,187,19,0,228,81,170,96,236,247,115,184,142,244,70,246,1,21,63,
+164,138,191,61,14,154,6,106,220,188,187,208,225,85,161,47,88,7,13,100,180,81,8,143,201,73,116,154,189,193,
+198,202,104,149,151,145,177,105,155,32,119,84,68,49,155,59,42,161,93,92,94,246,196,138,161,175,151,122,200,79,
+192,151,133,126,58,92,195,219,136,219,42,14,79,77,47,24,199,153,221,145,167,147,135,206,128,175,185,10,110,91,
+65,129,239,163,58,152,180,67,165,0,166,124,72,47,43,239,60,218,154,93,132,123,207,50,131,110,233,231,165,86,
+242,209,121,39,205,229,206,78,238,27,57,162,183,27,179,46,187,235,221,148,244,80,186,173,114,84,115,155,99,143,
+223,115,175,21,32,175,89,163,177,117,8,102,46,45,27,194,234,141,213,13,18,113,179,32,134,208,192,130,27,122,
+166,147,142,85,108,190,79,72,214,110,25,203,168,17,140,110,142,57,63,159,82,185,185,56,230,109,216,157,244,50,
+189,140,120,7,246,159,251,86,8,203,38,141,154,235,185,224,91,97,231,71,58,176,41,47,156,118,133,136,77,32,
+93,71,138,25,176,150,97,52,148,233,194,94,56,48,144,99,21,49,215,94,242,105,123,188,90,235,253,56,167,20,
+25,154,161,193,187,1,24,130,199,132,46,111,187,59,116,128,203,22,175,72,230,234,154,103,215,10,157,212,175,194,
+157,3,239,203,114,166,109,198,103,153,176,27,21,23,10,239,254,122,198,165,50,128,241,241,198,172,217,56,216,148,
+98,18,128,134,203,24,170,180,204,118,50,239,23,221,212,166,150,181,102,226,213,29,98,239,160,54,79,129,215,130,
+192,219,145,217,236,158,236,74,227,219,123,41,232,7,110,88,155,55,92,149,217,19,61,159,54,94,145,70,128,117,
+56,245,185,223,23,151,179,37,91,194,8,55,219,148,68,212,205,190,247,79,48,86,228,230,169,183,24,102,169,215,
+147,79,133,5,147,137,41,90,218,115,214,145,141,224,231,27,152,114,33,131,1,218,85,81,201,195,176,107,170,53,
+121,40,187,186,47,146,3,233,72,71,148,192,165,148,102,198,131,25,195,174,23,214,157,18,91,238,245,210,115,169,
+229,28,195,59,158,137,251,241,66,215,230,233,100,89,211,204,177,3,61,158,251,67,224,120,215,226,104,219,243,137,
+49,251,214,206,67,81,180,70,177,189,177,227,81,30,17,69,15,75,194,80,110,236,188,39,234,115,112,134,71,167,
+186,106,164,143,157,134,149,166,81,217,200,123,28,109,196,124,85,138,250,94,56,93,200,77,181,216,24,63,220,17,
+185,162,45,139,38,18,216,172,50,133,222,120,43,88,101,35,200,140,35,71,59,18,199,54,37,32,153,230,153,43,
+93,78,12,228,65,225,30,47,24,115,7,141,187,30,74,153,125,32,131,190,213,69,196,59,206,48,150,102,1,31,
+131,56,191,139,3,232,99,137,112,112,173,122,152,96,99,58,102,229,185,54,241,77,20,202,254,6,162,72,169,206,
+59,172,75,59,89,190,12,121,149,212,34,38,33,128,50,227,227,144,215,87,143,25,150,231,224,129,180,141,77,200,
+49,143,114,6,139,242,105,58,218,161,35,1,223,27,89,58,73,247,169,150,199,3,46,142,225,213,31,131,102,90,
+139,186,36,204,56,114,137,189,194,171,58,53,188,102,52,201,58,155,11,118,2,177,162,119,130,58,16,6,116,154,
+237,94,197,179,221,77,34,250,126,77,173,136,72,187,220,163,11,224,76,243,105,28,43,140,189,248,112,47,181,135,
+120,181,218,178,42,160,217,134,51,38,168,36,5,23,75,29,47,162,198,130,78,142,240,146,52,237,13,249,122,29,
+233,245,222,240,99,56,80,84,80,67,81,24,246,84,43,37,60,24,199,177,27,203,175,45,19,173,111,140,33,251,
+83,229,193,246,41,39,104,46,83,7,182,146,213,29,0,238,105,190,211,65,127,26,3,51,154,113,118,214,245,153,
+128,71,252,18,250,40,140,65,189,147,158,79,167,13,125,147,229,185,83,242,224,36,40,76,36,223,119,233,117,59,
+0,162,54,28,189,19,232,50,81,4,39,125,103,133,95,51,55,18,219,2,196,65,2,106,207,41,16,153,203,214,
+82,166,107,27,31,251,214,31,122,88,109,207,109,116,40,194,181,179,190,59,44,207,156,105,255,214,23,101,95,156,
+103,73,71,79,123,82,199,215,21,74,153,250,225,108,19,14,127,226,76,52,30,203,13,149,152,34,200,116,93,191,
+102,233,89,169,237,171,133,3,186,239,221,204,128,72,226,118,59,142,154,135,247,5,52,137,232,22,190,250,208,150,
+87,175,247,107,78,195,80,47,7,54,170,122,51,197,82,88,175,14,240,166,3,77,185,163,155,170,179,39,155,203,
+170,219,98,84,61,248,201,209,70,232,190,80,59,101,147,249,91,177,157,4,103,44,156,91,141,179,141,177,74,146,
+204,207,21,115,134,34,247,56,193,57,129,137,107,79,164,206,24,126,133,238,157,210,166,59,92,158,218,4,63,238,
+29,220,87,170,206,38,186,240,66,230,78,221,77,86,218,94,2,201,11,214,4,74,244,71,136,178,215,167,117,198,
+86,55,73,188,219,50,117,228,144,53,122,189,38,158,128,157,246,231,227,93,137,156,35,12,229,206,45,20,8,25,
+105,102,99,131,242,236,145,5,236,193,49,195,176,216,12,132,26,226,218,105,23,54,158,37,0,254,85,90,145,31,
+118,173,168,48,90,38,78,132,1,51,158,152,144,10,29,9,194,53,12,241,192,58,194,206,181,187,182,54,0,80,
+31,87,217,163,204,166,203,187,155,172,225,177,76,114,28,181,25,161,169,94,19,233,136,74,0,163,195,43,168,85,
+189,130,214,109,93,143,144,138,116,209,9,115,210,189,152,202,254,246,20,242,244,154,147,219,194,219,251,160,139,70,
+242,1,142,200,76,210,7,119,39,86,202,198,115,156,53,0,92,145,215,149,157,107,69,80,218,108,202,227,64,1,
+78,39,96,44,51,217,117,112,52,140,211,168,174,40,134,70,142,132,109,132,38,59,185,167,51,34,107,94,12,97,
+20,98,154,230,94,211,103,180,223,91,233,245,70,134,152,81,139,199,149,43,167,126,63,185,5,218,92,173,226,184,
+69,50,26,247,253,44,189,120,177,169,217,155,100,36,40,249,14,240,127,236,237,117,123,55,14,201,141,238,240,13,
+165,6,154,130,109,156,224,152,184,160,71,83,205,115,234,183,180,61,40,174,54,182,104,239,37,86,188,143,29,145,
+71,219,110,222,40,53,137,186,166,56,51,166,222,218,12,125,194,75,208,215,151,134,184,227,16,9,173,4,150,0,
+153,75,140,84,107,197,22,75,143,94,117,219,117,45,77,143,140,25,194,107,56,45,29,157,30,17,245,76,143,160,
+174,207,36,217,183,53,232,46,205,45,110,163,48,187,145,89,34,44,122,19,147,137,29,3,5,135,148,129,93,223,
+140,21,173,64,162,68,41,232,51,230,133,73,15,131,198,30,148,73,125,159,180,198,173,44,189,142,194,68,180,52,
+44,12,151,246,248,174,112,43,99,107,135,185,230,92,102,61,165,235,81,181,76,49,152,140,12,157,250,245,138,74,
+248,86,204,42,193,241,247,220,142,218,72,81,87,238,44,209,247,44,254,56,220,216,64,143,147,46,104,146,161,185,
+160,35,8,115,70,179,115,45,130,224,18,54,247,124,192,108,104,218,137,217,75,193,144,183,68,198,73,3,34,84,
+24,186,24,37,82,104,185,75,70,172,167,14,91,154,193,214,45,141,220,170,75,230,14,237,117,114,112,194,137,186,
+54,158,20,156,192,182,243,92,251,173,152,232,189,191,244,165,71,227,204,48,91,165,61,75,204,150,189,147,166,14,
+37,19,185,222,249,247,61,116,159,217,83,1,192,62,209,247,203,115,235,138,111,189,11,223,229,199,137,132,134,173,
+60,55,58,226,174,246,65,96,25,12,75,53,117,67,241,245,122,188,41,160,107,48,42,62,185,107,100,216,7,23,
+136,49,205,222,232,32,70,111,66,3,141,41,17,118,15,227,65,244,60,54,87,152,141,24,90,103,220,209,243,67,
+7,2,188,53,246,86,209,146,5,106,28,119,164,188,7,183,166,227,13,59,111,154,161,114,68,59,222,137,148,223,
+94,124,195,204,236,45,158,222,189,208,4,145,99,73,121,74,44,207,158,186,253,65,112,80,132,11,247,28,109,83,
+48,92,89,186,42,239,144,195,21,13,96,104,54,100,185,187,119,122,162,147,116,78,179,84,45,6,148,9,155,102,
+205,193,161,177,118,65,88,64,3,100,181,211,210,179,198,27,200,11,208,178,38,1,24,56,197,249,10,66,27,119,
+237,28,228,212,245,238,161,164,43,185,129,86,245,109,167,48,247,141,7,223,134,162,220,186,90,165,25,151,66,221,
+201,162,135,90,229,30,99,102,15,201,111,56,219,94,217,45,194,95,209,181,144,157,56,157,135,179,141,94,23,102,
+133,223,210,131,112,14,124,12,234,52,245,210,32,147,136,192,166,94,212,235,13,53,223,65,79,6,65,242,141,69,
+125,131,200,147,51,138,227,196,206,4,205,111,24,136,51,75,146,170,48,14,237,118,224,32,16,199,237,61,181,230,
+11,220,177,246,236,159,27,227,56,94,39,165,174,157,35,228,200,219,123,208,142,14,46,77,167,161,16,143,122,239,
+106,197,173,59,182,245,116,243,90,98,235,133,167,104,104,239,92,119,222,131,78,102,45,236,246,228,97,162,8,53,
+37,34,220,179,49,30,242,0,216,10,117,44,227,251,237,169,85,161,144,58,70,161,101,2,92,186,80,35,159,123,
+146,138,67,245,41,52,246,113,192,106,244,196,117,179,61,135,76,145,131,120,184,147,16,132,175,90,214,207,218,3,
+206,112,252,164,156,8,156,98,83,79,1,209,231,185,248,217,58,6,193,129,70,51,119,109,228,135,168,131,58,172,
+130,112,122,179,87,175,179,115,95,39,15,91,69,58,95,85,10,131,206,176,176,9,239,89,130,105,174,223,211,42,
+114,38,10,90,21,196,113,167,137,104,119,177,165,92,144,141,64,21,138,82,98,125,113,189,113,241,130,156,250,213,
+37,35,161,227,124,35,183,32,124,73,21,43,39,129,190,157,72,182,171,81,81,58,68,231,73,97,78,85,176,211,
+160,146,192,146,27,22,220,187,227,133,163,115,62,75,225,116,187,235,77,136,103,238,9,127,184,239,164,168,24,50,
+131,58,96,203,123,188,57,207,81,38,85,69,111,135,142,174,166,155,41,55,227,164,59,247,136,156,18,8,239,25,
+236,104,155,162,152,88,202,224,218,158,77,18,197,70,98,73,182,41,226,186,108,39,210,107,86,42,60,21,134,21,
+203,14,27,100,62,101,40,126,8,109,234,67,103,55,225,234,104,236,15,133,209,97,242,157,240,210,178,103,69,11,
+14,201,94,245,124,126,206,54,132,207,161,230,122,157,173,17,253,12,58,167,181,180,43,41,223,58,27,29,42,245,
+122,141,99,138,74,99,237,92,59,231,25,138,87,86,140,159,244,32,22,68,140,245,220,81,212,96,56,130,251,149,
+49,179,172,35,165,97,70,27,170,70,175,122,168,19,64,90,46,120,34,64,44,142,20,49,93,203,117,145,42,77,
+33,28,123,52,109,207,86,53,104,87,179,222,13,113,77,141,32,249,80,100,181,25,178,102,106,51,251,46,221,55,
+90,118,31,26,86,245,75,198,42,78,17,129,102,87,3,3,193,48,156,89,177,228,218,134,67,183,59,71,225,80,
+48,48,62,50,73,87,139,142,184,114,71,203,94,158,197,214,221,113,165,97,180,92,197,10,12,51,6,67,107,133,
+58,180,109,216,58,37,94,231,162,77,215,51,125,53,19,63,5,124,153,119,14,55,10,118,122,121,128,112,119,108,
+84,23,175,183,83,47,152,69,157,51,58,204,50,210,150,34,175,183,172,159,123,208,117,2,54,193,52,27,247,48,
+83,60,158,52,27,218,43,50,54,117,240,22,36,182,218,143,8,189,158,170,34,189,233,91,12,187,38,134,113,89,
+222,57,227,150,39,12,91,208,116,249,74,204,151,170,182,229,89,239,136,90,88,161,199,249,157,236,181,89,191,198,
+49,235,200,233,13,91,11,56,14,121,114,10,211,118,32,51,3,94,37,108,180,135,89,25,14,147,163,231,233,214,
+221,211,114,113,152,51,155,168,102,116,221,152,53,126,177,137,109,34,89,16,32,87,20,36,43,229,46,13,207,164,
+113,101,215,180,67,169,30,161,227,7,182,223,149,131,10,250,108,3,244,61,183,109,222,68,121,19,136,107,179,110,
+105,124,42,20,208,2,23,98,206,116,13,20,42,28,190,159,111,86,227,153,68,229,161,89,233,138,247,157,149,78,
+229,24,200,157,97,169,98,194,108,210,145,244,37,222,110,67,97,181,73,97,198,151,89,141,244,164,29,163,138,20,
+177,81,70,175,75,120,100,169,127,160,213,113,65,24,157,87,140,105,245,56,243,250,188,48,145,65,61,52,45,246,
+134,227,98,113,240,198,147,53,227,243,25,98,94,242,217,84,231,113,123,232,36,45,179,243,184,245,97,182,190,239,
+241,102,108,157,36,151,211,174,119,85,173,36,124,225,230,137,248,133,100,182,150,192,48,115,156,229,37,151,115,55,
+244,36,212,167,221,150,187,130,126,46,223,222,204,26,25,46,29,28,2,6,101,103,195,0,121,70,60,162,225,81,
+237,85,35,2,108,22,47,60,34,93,77,118,46,17,148,57,137,253,133,199,250,187,54,134,133,170,64,102,16,202,
+34,98,23,253,221,230,113,24,174,213,147,25,50,189,199,122,198,145,240,87,35,194,117,56,205,198,184,41,207,88,
+56,162,32,56,103,101,182,60,111,117,133,239,50,135,195,212,245,190,183,106,142,113,214,32,45,13,101,26,137,235,
+174,88,32,137,197,47,3,233,11,44,18,181,199,246,174,32,59,146,222,69,137,181,173,57,178,26,207,242,168,95,
+110,208,208,113,78,166,9,219,211,70,231,205,219,222,146,194,28,180,71,141,188,174,74,216,67,194,130,155,96,198,
+241,228,160,197,40,197,206,121,86,106,195,102,181,245,188,78,78,172,91,204,34,97,38,200,38,199,166,123,0,238,
+136,21,55,37,40,51,66,192,4,146,101,135,120,146,136,88,10,19,6,79,64,26,27,154,173,226,234,36,166,96,
+194,41,140,160,227,163,167,234,101,154,157,106,30,25,182,12,167,29,4,24,62,0,94,3,10,130,87,48,19,68,
+172,226,211,118,152,101,31,149,28,63,63,67,183,204,245,188,129,112,0,133,83,239,250,138,91,131,146,113,221,93,
+244,61,127,219,203,43,255,102,129,125,91,139,27,231,193,51,143,235,61,220,169,125,58,157,206,186,74,51,211,169,
+23,198,59,232,245,9,182,86,141,10,53,41,191,187,106,151,149,85,251,35,171,108,213,172,119,87,68,26,223,73,
+173,167,211,210,243,67,220,32,88,184,155,198,115,145,53,199,158,9,93,136,49,250,121,61,73,2,78,157,186,176,
+5,61,59,123,117,111,214,236,82,206,116,68,97,39,23,202,253,161,194,97,135,168,49,71,189,51,206,177,237,154,
+3,182,33,230,75,16,118,43,142,187,239,56,236,36,166,167,221,117,189,31,138,171,156,31,135,25,35,221,250,129,
+179,176,203,16,162,73,79,119,196,87,241,41,127,60,83,235,141,121,123,96,244,20,52,99,185,9,90,125,87,150,
+105,130,81,54,76,184,174,103,244,22,244,237,137,149,142,117,104,140,107,16,200,133,80,217,196,57,241,97,122,12,
+32,70,197,231,232,140,134,120,215,156,100,242,58,102,43,252,222,95,161,50,189,66,137,153,241,206,104,218,166,123,
+107,177,41,41,239,184,129,185,195,108,84,152,118,48,228,53,123,220,243,170,205,115,198,85,3,182,189,125,180,237,
+62,77,132,91,169,148,200,186,11,25,229,192,172,122,211,218,75,1,155,25,106,128,137,197,217,179,44,237,72,117,
+129,118,159,240,130,134,137,148,9,4,8,38,105,69,62,136,53,164,173,48,8,162,14,167,122,160,24,200,135,11,
+110,108,57,6,134,54,89,148,183,135,178,109,1,140,108,202,62,111,81,75,59,208,66,117,111,221,104,235,122,183,
+235,5,221,121,145,143,221,163,81,73,248,205,10,90,81,200,192,4,16,30,25,185,2,51,27,60,237,195,213,164,
+130,114,4,29,179,24,222,131,34,180,101,168,154,29,73,244,114,217,104,148,144,18,76,165,102,196,25,166,183,132,
+70,195,233,137,131,36,163,67,8,45,60,245,1,20,100,2,225,181,116,74,4,120,143,149,3,168,153,146,118,13,
+252,43,32,105,222,1,35,228,148,246,247,121,78,169,161,68,142,32,224,56,45,241,165,36,214,157,68,216,196,198,
+138,26,75,194,43,134,8,199,241,53,210,27,248,133,39,28,104,13,41,13,149,134,208,172,221,7,194,206,84,5,
+144,29,243,172,143,133,150,100,41,122,243,224,254,104,237,241,202,199,120,152,102,90,113,64,200,64,194,40,208,187,
+145,34,51,239,97,16,164,48,36,78,154,80,224,141,190,117,250,163,160,130,66,47,242,12,10,75,132,180,110,35,
+137,33,110,172,125,57,66,252,186,192,56,225,120,26,140,236,176,67,214,249,149,55,174,193,134,182,97,204,143,173,
+185,185,114,113,223,193,22,184,99,214,91,148,26,20,121,190,181,7,51,70,91,96,159,217,187,239,176,148,61,168,
+107,1,194,253,160,77,85,15,238,220,57,72,52,38,78,114,35,105,11,2,7,60,50,208,73,211,243,69,211,73,
+76,178,174,182,75,89,46,206,190,126,188,133,227,29,74,207,126,163,155,62,15,31,212,11,89,242,213,221,147,14,
+149,230,172,128,105,58,141,94,251,140,43,13,52,142,179,88,8,249,226,180,102,124,31,167,57,6,216,74,188,1,
+156,130,180,90,128,102,138,113,105,235,116,81,89,171,14,81,231,241,238,69,191,6,173,36,223,57,249,226,183,61,
+164,72,77,200,225,248,60,7,45,5,147,240,206,204,230,19,89,80,162,218,43,109,30,14,130,123,58,5,101,225,
+134,75,158,217,211,86,103,227,204,203,87,245,192,15,70,126,143,116,37,231,55,60,112,20,49,50,221,192,168,91,
+136,0,92,116,237,242,176,116,14,61,227,90,142,163,108,203,75,158,120,106,109,248,177,214,0,115,168,12,164,210,
+51,69,1,128,99,11,172,239,130,140,131,86,44,46,111,113,28,37,10,31,109,180,32,64,148,234,20,65,157,127,
+246,134,194,189,27,233,188,198,98,156,24,149,104,23,29,177,50,218,72,57,216,115,66,224,174,103,9,63,98,152,
+206,182,47,61,188,130,24,31,92,94,73,68,24,244,22,111,65,80,137,23,177,7,120,121,162,12,116,169,169,231,
+132,209,122,60,204,140,224,241,8,12,51,218,68,38,44,191,239,44,56,32,194,139,239,147,140,102,209,93,209,83,
+250,146,84,119,134,216,234,208,203,215,142,184,195,105,207,159,245,248,80,96,128,64,29,110,125,24,27,94,187,58,
+235,155,109,41,55,115,244,149,127,200,141,96,66,16,179,65,83,143,173,163,14,39,9,47,79,98,214,235,194,94,
+61,90,114,56,221,171,9,174,253,243,124,180,198,0,180,187,41,131,1,183,4,21,222,12,108,2,107,46,128,102,
+203,144,3,162,37,1,45,240,14,176,209,155,184,187,91,159,120,197,7,76,161,56,3,134,46,91,160,79,159,130,
+150,45,182,201,165,195,186,166,48,93,246,124,229,113,222,113,238,60,114,183,165,178,63,172,136,185,129,80,16,154,
+4,197,22,130,230,30,12,2,89,75,242,185,150,215,178,37,163,32,94,31,207,224,239,12,157,107,226,117,121,47,
+82,147,26,224,223,140,105,227,243,38,192,61,127,21,195,212,80,137,87,213,221,216,59,168,193,67,243,24,33,66,
+205,40,103,38,39,118,39,14,190,90,66,2,218,127,41,226,162,29,171,138,130,102,93,135,17,130,9,44,238,89,
+45,184,142,28,125,133,105,26,223,175,32,36,141,250,78,240,149,156,164,144,77,72,91,89,111,174,154,246,2,76,
+166,235,164,50,50,158,12,43,91,7,241,100,188,64,252,1,234,97,134,15,228,33,69,230,139,148,142,33,203,226,
+90,54,177,176,39,236,174,247,252,152,242,211,202,25,113,107,71,186,219,33,85,232,117,155,72,77,55,110,67,179,
+247,182,85,3,201,151,53,135,160,28,168,187,140,206,243,249,14,52,184,247,218,13,193,30,116,116,26,250,85,15,
+247,164,247,242,238,212,83,193,186,13,239,123,99,92,216,254,200,16,82,64,83,132,149,18,3,104,247,108,99,53,
+199,129,137,247,134,116,71,119,106,125,75,113,104,28,93,84,141,103,6,57,51,254,42,13,67,239,178,143,164,209,
+128,253,98,98,30,24,140,157,44,117,64,234,108,38,136,46,217,157,138,16,77,227,201,93,205,103,134,52,90,190,
+141,228,219,68,140,101,160,246,22,30,139,28,18,238,155,25,91,219,62,58,172,188,67,4,28,116,229,0,209,28,
+177,147,11,47,207,23,212,96,80,44,19,19,183,208,70,15,13,33,0,169,13,122,151,200,26,125,59,245,65,159,
+67,87,138,21,251,123,6,210,116,174,13,186,160,16,224,83,192,173,121,86,60,24,137,151,37,160,77,112,121,223,
+53,207,197,33,161,86,8,99,161,198,20,128,226,219,206,151,253,69,229,86,187,141,183,70,61,88,165,207,20,161,
+156,231,17,117,46,240,197,187,17,185,193,110,76,249,218,108,238,164,7,27,171,162,24,182,210,54,70,156,202,148,
+1,21,59,66,106,67,142,102,218,248,123,153,235,87,37,234,102,250,121,93,204,53,13,205,219,222,88,209,48,41,
+15,32,223,12,45,56,86,162,112,38,248,253,198,51,44,152,75,174,199,186,221,147,108,123,35,240,54,9,119,170,
+187,187,146,19,165,218,70,212,117,114,97,220,146,129,28,96,126,249,62,112,87,64,78,203,92,217,30,15,186,144,
+242,203,237,164,221,55,242,161,138,64,204,112,73,151,95,173,45,191,7,65,101,241,251,38,109,186,184,229,71,219,
+227,8,181,179,236,196,46,6,156,38,209,77,113,236,205,49,235,224,224,62,130,221,117,73,74,96,104,187,205,74,
+75,238,162,66,216,198,118,43,216,172,181,138,9,124,123,208,80,51,93,13,160,243,145,173,61,179,9,67,89,25,
+74,196,140,68,173,48,237,229,189,7,226,136,194,150,21,13,214,184,64,69,191,98,64,239,162,30,179,166,82,86,
+179,46,117,202,136,31,36,185,218,227,88,137,235,74,64,220,148,6,55,27,21,136,123,224,4,80,135,115,122,115,
+179,84,174,12,161,218,58,247,62,135,109,125,80,162,37,126,19,6,161,191,101,54,86,95,16,96,6,13,160,9,
+15,187,14,210,82,59,112,251,226,72,172,45,38,136,224,209,170,179,38,40,122,203,30,93,100,7,81,234,44,78,
+238,49,182,104,163,137,172,88,61,176,161,116,165,231,78,187,100,105,181,227,65,140,17,86,16,139,211,117,177,227,
+85,179,42,248,36,178,80,18,50,196,37,227,186,46,186,78,101,228,36,236,70,141,243,42,163,49,82,178,226,133,
+151,10,70,208,170,2,200,213,92,99,136,40,209,58,62,141,248,25,48,53,125,63,74,170,68,27,131,235,232,56,
+14,180,132,48,202,186,213,67,175,245,128,20,64,80,179,21,43,155,185,94,92,242,182,115,211,68,241,250,149,205,
+144,174,168,128,92,50,201,67,59,156,184,251,230,154,223,199,190,111,244,252,50,93,245,177,26,16,110,167,216,107,
+148,156,207,61,59,13,90,61,99,188,215,170,244,116,128,24,136,58,18,222,194,21,67,128,57,238,110,7,8,212,
+137,62,166,9,225,211,41,202,53,182,121,3,28,13,217,171,5,174,17,25,137,251,89,145,176,48,188,110,29,51,
+46,112,182,12,89,149,22,162,171,134,142,248,177,115,240,60,64,46,229,136,206,77,106,180,171,43,173,22,84,58,
+193,98,192,107,232,154,231,152,232,104,21,186,4,167,68,51,152,247,11,179,223,167,253,242,126,133,54,11,44,9,
+133,110,30,105,197,187,203,188,161,94,111,94,177,223,210,218,30,98,143,198,133,13,174,25,232,14,75,219,234,153,
+116,66,148,23,76,227,84,208,43,169,248,136,184,42,30,202,39,241,82,169,12,85,26,43,76,134,172,177,106,48,
+174,106,216,109,227,187,126,209,86,201,217,30,135,50,25,203,210,181,8,104,199,45,182,24,47,130,130,194,68,80,
+168,135,54,227,27,183,167,106,152,142,157,71,255,8,121,10,137,213,211,137,110,140,85,207,180,40,133,104,233,72,
+211,87,37,246,49,201,172,197,104,103,246,182,187,129,228,59,189,11,166,158,7,186,85,219,176,216,2,36,144,114,
+97,149,164,82,4,152,147,170,238,140,40,202,163,189,84,70,145,156,41,14,121,98,111,241,218,178,15,67,218,110,
+200,249,142,131,173,134,80,184,179,4,126,190,23,187,224,94,218,146,9,95,246,3,37,21,120,97,133,129,52,251,
+35,177,60,78,242,233,14,116,196,74,200,140,13,86,15,179,121,233,36,66,220,153,119,167,190,208,119,31,215,79,
+86,109,158,241,253,118,133,109,219,216,81,177,254,241,94,239,194,209,156,244,120,207,29,17,100,85,225,178,112,238,
+2,41,52,101,122,123,146,125,93,80,230,16,190,2,238,232,131,254,253,222,235,135,113,91,28,1,197,188,217,6,
+91,119,29,222,227,219,115,160,219,59,131,230,83,0,205,157,53,87,22,57,159,56,195,2,189,238,144,47,123,55,
+162,62,122,166,126,189,65,233,81,107,7,59,186,2,222,224,220,216,97,246,12,6,238,55,103,226,116,177,84,30,
+119,142,53,192,53,208,31,132,51,137,27,250,200,140,164,236,244,49,127,228,160,1,14,26,140,236,247,235,228,64,
+132,195,92,206,177,31,76,77,15,15,62,59,224,80,62,172,185,134,189,54,254,209,211,60,7,106,21,132,218,161,
+227,197,180,52,243,126,223,29,45,192,26,174,107,116,6,198,134,153,194,56,11,216,97,61,214,38,138,144,104,76,
+80,19,142,7,195,90,241,174,16,67,55,154,28,164,198,96,207,33,178,15,188,94,234,83,220,85,70,7,216,43,
+131,235,54,224,7,126,131,4,1,163,244,198,164,65,122,203,15,171,210,4,120,45,224,197,241,128,58,210,158,66,
+28,88,79,231,206,20,146,118,207,144,107,149,160,245,156,46,142,147,97,208,125,66,82,128,19,225,1,107,153,56,
+44,14,90,32,155,6,59,14,35,162,114,211,105,34,201,99,149,234,183,250,180,206,113,95,47,117,26,131,56,4,
+214,174,171,195,209,36,202,129,185,234,168,41,28,93,46,229,113,209,179,73,212,146,227,189,35,163,152,103,201,202,
+153,38,251,154,15,17,129,221,154,105,66,55,190,149,9,194,14,96,178,71,118,193,112,186,31,92,15,29,182,121,
+21,217,194,109,229,144,228,180,129,66,131,78,13,60,135,33,66,218,245,241,6,141,85,64,22,56,152,176,89,25,
+46,87,68,40,32,123,237,200,177,237,60,227,120,195,24,142,195,13,156,134,201,244,242,93,71,14,6,57,106,130,
+190,161,9,9,185,68,2,208,184,31,77,188,184,53,189,177,145,44,223,157,25,143,52,229,161,182,112,121,23,249,
+6,132,11,192,63,115,174,20,218,242,247,29,230,109,153,188,187,218,61,141,225,50,59,232,210,150,81,175,174,64,
+44,239,4,213,221,177,163,132,26,26,232,181,67,18,51,196,203,241,0,156,39,81,181,56,114,220,70,134,0,207,
+32,39,122,48,89,138,78,140,194,147,96,120,21,210,3,131,226,178,42,9,208,148,26,43,27,74,119,48,157,132,
+227,220,82,108,200,198,128,136,170,112,126,229,118,2,50,218,164,209,97,162,206,13,43,110,149,165,205,254,114,60,
+20,86,16,174,52,214,211,96,86,216,52,212,12,119,94,136,181,140,122,57,235,243,100,95,212,129,54,45,53,186,
+213,25,113,29,16,71,187,196,158,115,143,109,184,212,55,80,12,225,152,60,54,186,207,18,148,76,247,72,49,64,
+1,236,29,129,43,97,53,207,33,198,196,161,187,17,179,1,100,155,57,99,64,22,192,49,136,65,25,68,231,68,
+142,239,238,8,207,173,170,149,167,129,240,233,205,235,14,146,206,20,233,136,30,233,234,230,46,209,75,235,226,93,
+81,12,219,19,76,39,40,96,135,90,29,170,181,215,11,37,19,88,225,62,58,201,56,232,112,179,254,188,155,186,
+0,147,49,129,9,5,118,128,180,24,212,122,178,22,7,10,13,204,44,44,27,156,238,235,147,25,95,150,183,88,
+189,197,82,115,61,6,205,140,135,98,86,10,220,246,60,244,23,178,230,54,194,125,45,206,243,141,79,13,184,185,
+89,66,233,225,189,156,102,133,236,42,143,134,68,98,248,193,221,54,160,49,81,24,109,66,19,70,55,45,58,34,
+96,99,95,134,84,24,21,106,203,236,142,49,14,57,138,60,116,32,190,45,244,234,168,104,178,233,38,118,217,23,
+74,129,109,16,52,52,226,9,242,27,120,184,34,48,76,158,3,51,238,152,208,228,139,0,62,245,69,220,235,151,
+185,39,72,28,215,35,156,27,39,78,225,20,182,203,49,62,90,149,98,3,114,12,54,33,108,128,228,43,69,250,
+235,30,116,184,100,168,57,77,112,18,207,53,232,191,141,75,124,246,216,208,202,8,87,210,247,42,58,4,85,159,
+178,69,175,150,128,30,202,130,186,77,89,220,44,130,41,92,181,53,3,137,42,49,235,41,133,168,118,150,154,45,
+61,32,182,49,3,128,77,121,56,235,241,105,66,248,136,187,219,150,81,224,135,20,110,83,6,196,108,37,121,26,
+146,142,156,64,45,207,125,69,139,206,43,50,8,124,139,158,150,60,33,28,160,15,45,7,179,113,142,19,91,30,
+49,20,34,149,108,166,114,205,138,79,78,127,184,156,25,36,238,194,113,29,134,110,11,49,174,0,193,174,127,137,
+75,2,217,39,129,140,163,108,100,198,59,26,194,186,52,0,149,124,76,42,252,164,213,30,134,45,114,108,54,196,
+6,11,46,34,8,150,135,29,16,162,226,89,227,108,94,120,53,128,245,237,60,228,166,17,64,187,85,156,74,3,
+156,177,120,49,204,48,75,121,193,74,14,61,253,58,15,160,133,6,60,167,110,67,250,126,215,135,234,230,120,91,
+217,109,71,43,133,161,113,31,172,77,11,215,59,104,139,89,128,223,248,29,1,73,160,115,5,133,108,5,187,227,
+120,246,250,27,77,71,61,12,55,213,153,176,114,243,50,171,109,183,61,16,107,201,240,156,11,194,172,64,217,64,
+163,222,212,117,247,170,92,87,168,185,252,29,10,209,89,235,71,61,249,80,203,221,214,154,25,64,158,96,234,162,
+192,2,228,88,250,245,34,103,72,20,10,20,98,202,219,70,213,253,113,0,37,129,82,185,96,8,251,192,245,72,
+206,172,41,239,216,145,88,211,93,198,53,6,184,214,5,110,205,80,238,114,221,142,115,4,167,241,108,8,104,92,
+50,119,48,75,139,170,12,87,29,0,2,150,152,239,205,253,216,243,186,175,93,219,179,23,93,150,191,181,227,65,
+144,113,252,92,70,246,234,150,4,4,121,159,147,178,196,5,65,185,23,93,39,221,61,70,155,209,100,216,110,166,
+78,50,104,136,194,49,133,147,247,1,219,27,74,53,49,27,218,236,207,28,13,68,43,181,147,65,43,176,175,193,
+73,36,115,171,136,87,241,29,150,141,47,185,147,77,128,86,123,240,18,127,3,1,212,149,226,192,67,232,100,181,
+149,235,16,42,60,198,12,67,51,206,59,216,75,120,252,118,226,57,142,207,221,139,177,252,189,80,187,252,189,208,
+89,12,208,211,77,154,68,38,56,208,106,76,109,205,57,200,2,255,164,214,135,64,148,252,200,196,250,150,232,133,
+45,133,92,105,238,136,112,222,218,166,156,180,56,163,251,107,202,43,156,132,174,133,83,209,173,156,171,48,166,115,
+160,14,22,12,159,157,21,124,170,109,115,62,39,4,224,208,142,146,5,107,246,76,226,245,134,59,112,8,203,159,
+167,113,63,154,90,84,47,127,119,224,167,141,24,41,213,145,35,228,40,191,29,94,250,38,194,135,92,235,66,216,
+242,133,21,154,194,14,67,252,245,251,42,3,141,101,221,122,157,42,56,58,244,27,157,31,44,199,213,134,53,157,
+219,133,148,179,200,212,72,215,245,70,207,4,27,93,75,123,238,116,115,43,34,82,52,20,157,176,50,14,19,52,
+187,120,97,136,141,248,152,86,254,21,21,198,248,88,28,87,33,74,80,106,183,157,240,122,121,236,99,108,27,118,
+127,73,90,102,152,55,201,30,240,177,75,25,77,155,133,182,171,235,192,119,70,4,142,197,108,154,209,77,124,0,
+88,79,222,16,34,33,209,153,35,146,204,200,61,42,103,185,91,78,239,47,145,174,241,252,125,179,226,73,44,109,
+170,253,110,106,109,34,28,151,186,206,68,91,173,177,246,251,213,242,44,205,3,170,82,141,21,247,97,103,84,71,
+205,191,137,98,42,71,49,231,110,246,123,66,111,104,119,231,98,244,120,227,56,1,205,228,253,128,95,70,32,43,
+82,231,136,182,145,192,15,53,154,246,214,172,56,80,139,243,199,251,33,221,247,216,92,176,218,144,115,162,109,237,
+158,97,207,63,137,6,62,90,6,7,122,173,152,231,79,156,239,156,164,178,191,174,166,70,68,151,191,117,89,175,
+149,141,66,44,64,193,207,212,10,148,12,63,211,227,22,196,204,204,5,110,77,167,7,227,238,174,72,83,162,185,
+60,223,252,143,242,222,109,215,113,36,75,12,125,207,175,80,111,183,157,59,161,172,164,46,188,136,217,85,53,16,
+73,145,148,40,145,148,72,93,7,131,42,94,69,138,87,241,42,178,156,128,15,108,99,30,198,192,76,219,62,56,
+240,13,211,229,62,115,26,99,123,48,51,176,13,219,85,48,6,112,246,241,127,228,252,192,241,39,56,130,210,222,
+91,123,103,102,101,77,183,1,63,156,135,204,77,145,17,43,86,172,251,138,32,99,109,28,97,13,44,191,73,149,
+8,169,77,167,65,216,13,45,19,41,100,47,39,13,93,67,156,30,95,205,42,184,166,207,140,231,147,105,147,107,
+30,86,253,181,88,105,165,96,171,187,160,139,87,203,96,79,206,107,110,128,248,70,177,161,57,52,140,187,221,122,
+165,245,187,195,126,148,81,57,161,100,189,161,225,46,17,155,80,225,183,48,245,164,191,137,60,183,141,163,131,77,
+197,37,100,31,39,208,114,212,14,208,98,239,102,206,150,240,123,125,105,61,144,205,89,136,153,135,29,238,241,167,
+162,52,98,79,95,206,57,31,190,98,193,121,32,153,12,240,126,222,115,104,122,26,229,130,85,4,170,143,109,122,
+39,9,120,232,186,30,160,50,62,233,76,187,136,44,158,48,18,13,231,178,186,95,128,60,179,220,77,15,97,57,
+150,17,126,105,109,17,89,97,221,126,65,181,211,163,79,15,132,154,39,82,116,202,246,6,99,22,136,67,58,41,
+75,235,200,110,205,208,165,150,178,141,21,14,185,37,15,72,237,13,116,78,157,48,68,21,19,67,144,195,234,121,
+185,238,117,3,195,158,102,66,232,160,172,224,81,56,159,103,33,150,210,32,0,136,250,61,46,67,64,156,131,41,
+83,254,96,37,41,155,9,73,60,112,13,248,26,46,150,135,84,84,183,251,17,204,101,19,11,67,219,178,208,70,
+219,124,144,156,202,201,134,40,66,140,10,17,4,190,183,150,78,144,94,63,31,144,168,147,183,65,246,134,32,196,
+74,237,14,44,187,216,193,245,109,232,55,35,153,75,86,131,9,193,239,22,70,193,174,234,112,178,193,218,250,246,
+40,195,244,208,212,108,179,199,18,32,116,26,123,250,186,239,246,112,163,78,79,104,176,40,231,64,5,214,200,184,
+60,237,165,0,232,195,136,82,202,205,102,161,175,59,139,83,116,196,145,177,63,117,144,233,8,41,76,114,50,16,
+129,17,74,173,38,174,32,58,101,238,35,110,53,38,38,233,162,115,114,100,68,100,148,130,233,121,70,70,187,179,
+132,2,22,221,182,81,172,108,35,157,56,32,243,131,32,78,53,103,97,97,36,77,250,155,35,181,246,150,24,43,
+118,244,58,156,130,105,175,253,34,214,198,233,130,239,166,236,170,100,86,202,156,115,157,70,214,74,153,209,22,129,
+25,68,168,20,228,49,81,162,168,68,170,225,116,195,116,218,220,37,133,81,244,181,236,232,186,209,238,136,246,188,
+237,43,125,27,233,162,185,116,132,155,152,178,158,164,5,200,45,165,45,72,194,35,84,38,54,7,178,173,7,113,
+177,236,233,241,41,16,78,61,35,153,98,211,221,161,180,215,243,96,101,76,235,25,173,229,69,149,82,82,12,98,
+221,121,105,227,129,72,31,88,34,155,77,93,124,140,81,46,35,129,212,137,139,169,129,0,104,209,233,145,147,206,
+166,68,88,16,99,10,165,120,66,8,93,35,13,118,133,149,3,19,252,158,121,190,90,133,187,238,81,208,247,246,
+20,147,12,177,179,244,201,149,237,14,43,122,158,136,168,214,145,101,48,148,227,13,68,159,70,187,163,233,114,51,
+202,43,52,78,167,238,48,58,144,236,88,46,15,36,121,18,167,117,121,104,163,201,68,87,44,97,175,111,11,144,
+166,237,219,163,141,92,51,107,174,187,81,84,130,83,67,169,202,116,66,195,77,197,19,200,106,93,50,107,83,169,
+218,227,193,80,55,252,34,236,228,154,160,78,149,85,70,38,162,217,109,232,27,185,216,114,47,46,172,138,95,156,
+22,65,124,148,145,62,1,252,180,86,97,122,103,103,132,236,64,118,56,74,177,117,131,103,183,219,66,31,117,172,
+21,34,227,171,227,96,12,228,174,163,249,110,207,66,250,192,49,46,37,134,235,200,244,146,235,69,213,124,172,131,
+96,101,203,150,86,120,204,83,150,81,88,167,93,68,59,75,2,73,103,90,7,92,74,106,148,226,194,247,171,199,
+1,240,43,209,54,112,136,184,11,98,139,106,179,153,58,209,38,67,42,154,28,160,188,79,244,209,185,56,41,250,
+84,81,88,32,184,101,45,115,98,241,89,210,141,86,181,159,98,197,41,213,245,130,16,58,58,150,177,248,70,169,
+119,67,142,46,233,205,182,135,184,237,62,234,237,215,157,104,142,8,182,2,63,175,33,183,206,238,104,155,184,156,
+79,160,205,226,149,190,229,85,158,69,98,185,150,88,196,90,21,119,179,225,100,63,17,87,180,6,223,19,113,205,
+5,231,108,156,195,42,171,120,57,36,163,218,67,202,74,6,185,132,96,34,86,165,98,29,62,86,54,51,230,36,
+2,180,236,46,126,144,131,73,216,54,64,158,0,220,110,156,142,246,19,123,128,109,162,121,143,97,237,106,188,90,
+136,139,211,124,27,174,68,230,180,158,56,189,147,216,198,252,84,237,13,181,161,237,143,152,120,233,137,212,196,31,
+11,201,62,79,92,215,151,157,246,202,218,186,245,145,33,9,172,93,135,203,197,160,13,184,144,35,131,218,129,185,
+12,63,112,142,100,159,236,235,192,21,111,82,83,26,144,1,78,144,20,170,159,74,161,195,27,66,215,226,167,219,
+213,134,148,124,98,174,200,61,50,165,45,74,215,220,163,62,247,144,4,237,228,179,225,120,21,237,119,130,119,138,
+198,179,152,119,209,168,194,167,116,146,247,162,129,193,240,8,8,200,103,181,29,79,121,53,210,203,110,220,145,29,
+170,107,203,147,218,63,68,222,84,36,136,163,13,244,44,168,219,91,107,3,151,97,168,145,53,19,249,14,48,138,
+181,94,123,203,169,218,155,151,88,93,12,55,27,144,175,160,202,168,92,48,194,174,109,245,41,83,62,88,124,226,
+28,88,99,153,187,193,201,146,65,40,60,209,135,230,80,198,93,106,116,156,113,251,164,244,216,238,9,126,51,141,
+226,109,65,162,24,141,29,234,9,72,44,101,167,191,27,96,172,132,98,51,158,224,244,211,148,215,229,218,229,209,
+54,91,32,167,35,18,74,22,72,6,129,18,32,203,106,46,242,42,129,108,209,108,164,142,122,188,156,117,128,130,
+244,15,200,90,62,8,133,35,50,125,21,229,18,23,63,120,252,56,74,179,109,144,14,187,93,160,118,167,165,110,
+235,59,126,134,42,90,159,217,39,59,95,9,125,195,149,134,218,113,24,117,151,60,220,155,166,23,19,202,12,225,
+183,162,1,150,103,122,81,103,113,33,244,29,143,197,144,118,143,183,80,82,172,187,233,34,76,252,158,177,2,116,
+153,241,137,192,112,131,254,134,68,101,30,198,201,70,210,237,143,140,5,214,31,45,250,181,84,19,36,170,172,128,
+242,140,248,162,110,139,53,82,224,212,96,195,168,62,158,244,67,41,192,18,83,204,187,194,6,173,56,150,154,106,
+249,152,1,88,34,81,110,227,85,144,172,43,179,205,228,3,166,191,220,50,93,206,235,155,240,155,23,213,117,245,
+78,143,14,106,91,209,249,101,159,45,59,217,80,244,149,97,181,154,0,251,181,83,84,1,101,14,3,33,233,27,
+235,25,226,40,83,225,16,123,245,158,222,205,140,13,78,44,251,60,192,201,218,162,237,237,18,59,206,202,113,220,
+15,113,107,190,97,219,218,124,170,47,71,86,76,5,138,186,245,233,94,226,109,55,193,102,174,143,182,17,222,238,
+246,38,68,20,100,238,198,98,135,131,106,201,185,251,198,86,43,83,16,23,40,123,124,190,28,3,91,158,121,155,
+13,200,162,164,19,59,108,143,123,9,77,98,28,74,15,54,108,39,149,217,52,180,186,99,32,238,242,17,87,87,
+131,141,113,236,137,232,108,218,177,178,163,41,8,243,57,97,46,152,208,44,49,14,35,70,11,58,148,164,172,86,
+225,123,196,43,215,96,74,198,83,239,246,128,105,53,70,129,62,26,214,186,32,135,200,2,190,63,178,218,12,197,
+90,100,218,146,32,213,113,98,96,88,61,157,170,253,33,185,153,166,32,237,15,240,116,142,154,161,183,98,230,210,
+113,58,138,150,154,185,193,87,113,38,230,7,106,213,151,132,45,30,186,136,148,59,59,99,72,128,24,163,90,209,
+204,92,197,148,53,118,90,68,204,140,80,6,235,128,237,110,80,50,48,164,185,74,115,32,70,115,146,232,132,212,
+165,25,212,242,246,20,2,185,30,137,166,62,42,80,75,195,101,115,176,247,82,170,51,28,224,35,78,137,12,141,
+102,4,117,97,24,221,114,88,145,41,8,201,103,131,157,193,91,200,36,82,93,36,19,195,99,18,117,234,124,33,
+111,253,36,25,163,122,231,180,140,229,5,197,248,70,46,243,22,63,153,184,168,206,232,163,28,229,250,210,88,226,
+20,170,110,246,128,198,163,253,12,157,36,192,105,25,216,188,160,21,172,152,150,77,44,51,105,222,23,207,247,54,
+95,226,236,97,108,215,12,92,79,128,107,32,168,193,140,59,61,172,118,49,105,174,16,92,55,95,162,211,93,181,
+221,251,104,138,115,120,58,8,142,52,186,80,53,126,161,145,164,191,71,54,100,164,48,120,149,153,218,112,94,197,
+229,78,216,83,209,120,16,44,150,244,116,83,157,134,233,218,153,35,3,60,79,202,202,202,184,146,68,218,97,27,
+100,159,68,81,133,242,144,152,118,211,29,82,4,181,143,26,205,55,26,4,98,216,136,99,28,208,45,72,91,26,
+143,211,150,156,131,69,238,132,37,67,113,219,56,66,83,94,50,203,227,154,242,79,126,128,6,89,13,13,181,134,
+239,148,1,39,47,29,125,150,249,146,137,15,102,75,149,215,132,124,211,143,209,124,6,69,117,62,243,225,187,157,
+240,59,142,229,124,95,165,50,146,104,158,206,212,27,20,231,170,10,179,70,46,138,219,228,104,23,34,250,216,221,
+111,28,111,15,98,243,53,200,3,201,209,52,23,145,106,16,206,12,129,25,18,210,66,13,181,246,56,243,230,126,
+10,116,214,235,28,184,93,133,134,98,66,205,195,8,247,242,50,52,142,147,94,159,241,17,1,103,216,165,188,44,
+117,9,137,100,229,184,101,5,16,173,211,246,48,200,143,122,109,195,245,203,246,84,6,249,175,18,202,193,46,247,
+250,188,171,76,88,219,50,136,106,32,120,89,68,116,134,252,196,93,108,134,199,92,113,244,144,54,114,159,235,147,
+211,197,18,216,180,49,209,71,140,29,237,211,211,46,181,93,145,155,20,145,243,184,4,16,226,33,179,154,231,240,
+125,2,37,164,196,216,88,157,120,156,196,219,137,80,234,50,71,91,42,34,134,53,136,109,108,87,46,106,84,217,
+20,186,183,155,163,154,52,205,140,125,94,192,207,63,54,213,132,113,42,107,237,233,218,226,56,94,5,198,200,42,
+215,107,3,247,36,150,183,60,155,146,142,193,113,59,115,79,9,142,140,58,227,149,127,140,38,66,180,87,168,98,
+31,164,71,144,147,108,14,133,206,217,182,170,74,6,224,251,212,66,180,120,83,114,41,154,199,157,21,155,237,99,
+198,113,181,112,155,156,86,161,228,44,79,186,238,238,152,57,207,186,203,163,58,136,205,110,37,179,101,192,207,234,
+185,78,48,203,163,79,185,71,153,219,239,171,73,226,6,94,62,166,15,99,4,73,13,110,70,174,92,92,24,171,
+118,27,183,67,142,74,233,29,182,83,13,29,15,4,110,191,75,185,201,41,58,128,132,213,50,133,68,56,217,53,
+47,32,179,136,21,3,197,11,117,101,25,179,153,41,182,213,238,209,51,52,108,132,196,12,240,231,67,108,53,100,
+230,54,58,234,118,85,41,206,173,12,167,251,67,105,228,158,6,72,76,22,68,173,149,115,41,244,214,236,169,72,
+195,177,39,240,147,163,66,55,250,24,31,136,62,137,86,240,155,72,156,225,182,27,185,83,46,66,95,176,124,26,
+241,18,155,221,201,107,227,64,58,189,165,186,239,116,224,58,251,113,168,83,226,110,169,176,221,201,160,111,129,136,
+6,17,150,118,48,241,182,107,196,89,180,233,142,225,230,3,61,92,40,242,73,129,239,175,238,54,217,60,90,228,
+76,90,75,135,94,79,114,123,192,224,59,68,62,62,165,53,226,216,22,85,91,57,62,59,69,19,120,142,1,200,
+120,59,163,174,194,161,177,63,109,247,141,182,61,26,96,186,164,215,76,251,184,146,215,121,52,220,103,242,52,93,
+139,67,139,1,177,239,2,221,172,149,238,114,197,207,119,132,2,204,174,181,24,197,93,32,109,135,44,88,230,216,
+220,69,139,99,144,25,3,177,179,59,204,245,16,126,175,12,84,122,114,28,173,78,170,96,144,36,193,81,188,51,
+41,143,135,253,9,171,6,133,108,44,24,138,228,199,89,17,8,84,225,117,55,189,128,242,164,209,46,232,36,133,
+59,213,103,24,79,217,172,60,51,77,110,135,151,142,150,204,186,66,53,236,206,100,49,25,9,203,19,87,11,211,
+173,66,31,253,33,195,236,80,141,22,98,222,24,117,253,141,140,143,38,22,187,56,162,59,68,97,200,186,222,48,
+140,145,58,236,41,93,97,38,219,79,187,34,179,18,107,26,99,115,77,119,243,153,91,105,68,243,173,118,150,133,
+199,83,216,39,48,44,52,185,67,22,219,184,109,86,156,239,116,7,201,17,158,175,52,47,221,254,68,174,7,73,
+84,243,86,57,213,61,45,75,231,174,27,141,153,205,124,40,184,84,52,141,160,28,112,26,134,98,161,24,174,99,
+16,181,149,100,58,174,93,38,92,147,152,27,3,14,5,199,126,14,140,2,211,118,137,240,16,143,187,139,149,221,
+134,111,25,196,20,51,56,177,153,235,150,235,101,17,111,118,85,17,132,157,32,88,250,217,124,147,137,71,173,100,
+116,143,16,70,115,37,26,138,115,124,201,225,46,60,7,66,181,183,199,193,105,101,243,81,103,185,246,229,137,232,
+187,39,107,228,215,36,166,233,135,238,113,96,24,10,66,141,123,104,145,99,187,42,155,246,180,35,152,176,80,197,
+61,211,60,138,202,105,189,58,161,9,151,183,103,200,100,90,200,104,159,232,168,158,135,19,29,211,6,241,159,179,
+232,4,167,46,217,91,225,92,219,242,250,169,175,243,130,63,7,1,215,232,132,19,174,26,73,148,208,222,246,117,
+128,240,49,205,48,185,67,248,49,221,113,6,155,89,62,176,205,152,231,131,83,102,237,165,93,15,15,236,136,200,
+132,64,167,79,169,57,151,83,67,201,250,217,54,108,219,75,247,20,71,72,182,24,46,233,54,173,85,241,97,189,
+245,249,65,103,19,250,39,73,155,183,143,2,26,158,144,56,177,211,112,125,244,112,150,158,110,151,94,180,42,112,
+105,130,56,196,164,131,244,170,154,152,200,70,55,242,186,50,162,75,49,146,96,8,176,236,253,37,157,27,132,208,
+167,22,227,78,73,78,83,129,73,6,156,37,88,172,76,32,238,86,37,134,61,76,155,210,189,92,56,69,246,161,
+16,146,42,140,1,171,179,121,70,179,139,81,209,155,118,18,84,179,42,105,199,131,76,191,102,6,24,231,46,107,
+62,212,211,85,219,194,57,182,227,236,247,162,57,156,29,199,220,112,60,117,3,37,152,134,70,215,203,173,88,221,
+115,41,182,199,122,11,106,93,243,137,90,118,219,110,135,34,236,46,151,50,131,120,86,230,91,99,37,140,116,187,
+62,110,216,168,205,31,138,208,205,135,46,136,105,221,50,243,38,32,40,145,29,135,238,138,61,52,219,75,226,122,
+190,29,229,3,174,210,168,218,119,204,254,128,74,143,99,94,130,11,19,242,104,81,50,6,189,95,169,107,84,142,
+123,11,58,218,76,135,93,177,131,182,7,177,26,50,199,50,100,79,150,71,104,35,103,206,160,214,184,55,96,231,
+72,217,177,132,36,207,50,122,93,78,203,113,21,237,85,151,229,246,7,169,20,226,106,56,60,45,13,171,208,229,
+48,223,105,154,210,110,83,5,147,26,131,44,245,252,169,188,80,45,47,29,246,134,179,106,13,114,58,160,199,66,
+61,234,158,84,110,105,202,234,68,237,173,36,98,208,247,60,126,20,87,187,125,84,199,18,231,29,164,33,161,176,
+135,148,161,234,67,82,56,200,26,126,39,89,43,171,162,172,24,126,94,242,43,140,51,236,114,51,26,238,42,11,
+141,15,211,220,214,232,1,42,71,118,17,218,198,126,190,8,177,195,46,231,143,220,86,33,10,38,60,122,100,88,
+34,177,130,244,71,121,166,228,120,185,8,244,161,180,91,206,197,197,114,40,83,235,185,155,31,183,21,65,184,189,
+16,71,66,11,100,77,204,10,209,76,131,6,238,126,49,79,220,163,109,164,75,19,203,178,164,159,233,59,6,159,
+88,109,248,253,185,108,115,11,21,51,122,107,178,35,78,214,8,19,198,2,34,99,67,187,249,168,117,203,238,169,
+189,186,89,205,118,226,166,142,141,202,151,177,58,115,209,125,233,4,11,207,160,14,109,218,93,228,29,76,51,72,
+30,247,251,155,221,130,156,90,157,162,141,120,84,0,191,187,141,75,141,230,22,148,177,60,249,118,222,54,189,182,
+180,149,157,140,236,218,230,108,83,149,225,108,172,26,107,205,154,207,88,137,232,102,194,12,213,20,67,62,206,237,
+13,14,226,127,34,139,148,130,24,96,221,1,101,0,126,31,225,123,99,179,74,129,118,217,202,218,197,124,57,65,
+36,184,247,195,76,205,54,185,115,25,154,219,73,134,129,30,76,241,40,110,212,163,164,165,97,56,95,106,194,168,
+93,47,49,130,91,91,203,114,146,68,236,110,89,202,43,223,137,198,59,207,41,85,109,51,26,201,65,14,2,183,
+2,7,62,44,60,145,249,114,136,99,66,91,243,136,194,164,103,251,14,107,79,251,145,56,139,85,56,63,96,136,
+211,60,195,86,157,194,96,7,71,131,59,58,70,23,32,69,131,176,80,176,12,145,103,208,45,127,240,208,25,194,
+249,36,186,40,120,115,85,48,253,137,211,173,149,217,146,95,154,235,46,62,144,39,109,111,39,100,120,120,84,72,
+58,23,214,51,189,27,165,41,183,52,216,3,149,104,71,70,91,206,101,106,58,4,188,220,149,40,14,2,30,57,
+244,34,158,241,218,185,60,196,205,112,141,192,61,78,158,41,75,10,228,220,91,60,87,173,14,118,56,162,4,8,
+152,15,9,192,83,195,29,195,22,107,83,239,155,156,82,20,182,228,37,104,225,49,131,238,146,233,69,251,53,189,
+166,68,115,217,73,65,30,61,244,236,118,42,44,246,91,117,51,211,23,237,122,1,162,155,53,109,153,84,82,210,
+163,165,147,84,18,210,43,118,216,65,151,250,51,132,45,119,154,146,38,65,113,152,71,52,182,220,203,171,61,160,
+33,230,81,165,186,94,147,38,105,57,134,220,13,153,200,60,76,144,164,207,76,17,108,95,154,12,142,138,60,16,
+18,129,18,142,105,192,175,205,118,222,15,124,129,137,42,222,76,87,162,29,108,143,115,58,80,98,171,32,23,225,
+102,61,200,81,44,235,245,162,254,114,222,239,236,183,235,227,190,242,103,76,185,40,199,201,49,232,240,171,193,128,
+231,137,211,176,39,145,37,239,181,73,167,109,209,84,243,110,20,122,154,119,15,243,160,136,66,98,140,163,158,99,
+11,218,72,29,18,214,33,144,196,9,226,79,11,142,45,84,157,223,76,219,206,105,34,155,115,30,190,208,117,116,
+183,144,119,11,200,59,183,150,138,109,155,25,216,72,223,143,108,58,35,242,146,38,40,71,57,117,150,91,187,205,
+147,219,54,151,101,100,93,108,199,163,182,16,29,251,32,49,83,213,108,21,139,125,157,231,182,84,79,21,54,169,
+65,112,71,41,138,245,94,64,78,144,97,176,18,119,19,193,24,246,103,193,226,24,121,205,55,202,192,174,247,146,
+67,236,14,76,198,183,6,187,234,148,218,18,0,61,46,16,67,85,13,203,182,39,253,164,62,30,53,113,68,36,
+93,164,144,205,16,233,247,11,215,68,233,195,128,196,218,37,73,184,53,213,54,123,53,176,13,2,179,213,88,46,
+246,55,198,52,204,245,2,40,40,71,118,172,117,237,1,159,222,45,56,121,219,159,46,199,97,216,237,15,67,33,
+160,4,207,16,41,89,42,123,51,252,160,7,99,158,140,179,162,123,232,136,194,214,97,55,252,136,32,219,214,96,
+60,58,29,182,229,222,113,60,42,33,38,85,186,89,245,70,214,106,49,46,184,60,232,89,73,174,32,53,201,25,
+146,29,109,237,205,201,182,187,240,220,14,166,94,205,69,205,165,182,19,172,3,210,193,249,17,196,96,46,155,186,
+214,86,113,165,222,250,112,50,64,54,115,20,183,135,201,234,168,36,253,196,10,123,240,204,186,62,193,145,26,194,
+214,234,116,30,54,244,25,193,179,63,134,22,173,149,148,128,97,187,177,122,180,163,101,194,206,151,59,44,199,245,
+185,190,73,178,99,15,195,168,35,59,93,111,68,174,218,5,37,195,106,35,174,138,35,141,150,227,145,49,236,14,
+133,96,178,169,22,120,65,29,109,16,159,164,4,138,247,214,166,119,90,147,135,195,46,73,112,119,220,167,66,212,
+35,59,75,66,94,109,212,34,213,123,17,181,61,14,237,238,136,218,193,239,92,248,50,200,135,75,135,30,109,169,
+212,244,82,175,83,249,121,182,81,93,63,50,209,50,209,169,185,167,116,189,165,24,26,59,223,236,158,182,123,42,
+223,177,204,110,190,18,23,76,39,176,134,218,158,155,47,179,206,34,31,177,104,205,43,102,190,214,15,34,189,202,
+73,104,143,138,69,48,179,178,196,208,249,21,239,32,93,49,30,84,17,181,59,20,24,234,105,2,223,61,142,169,
+253,16,158,7,168,44,88,203,168,116,214,53,11,149,167,200,137,27,165,115,105,205,37,49,57,223,132,167,40,62,
+182,115,188,61,241,128,221,159,6,234,188,183,20,153,229,156,25,31,246,92,196,120,180,48,192,188,246,20,93,115,
+70,96,1,27,169,81,156,219,118,19,218,23,23,252,54,158,119,167,193,162,66,218,101,132,35,41,211,5,180,83,
+226,177,70,15,119,99,72,59,47,74,104,91,232,211,161,228,45,209,210,235,173,229,42,53,25,46,181,217,35,220,
+227,90,15,144,238,144,2,246,15,238,49,100,28,237,208,204,122,212,29,208,3,160,70,74,52,215,232,49,176,241,
+245,128,200,67,102,187,30,243,246,201,76,50,41,39,88,105,107,96,29,16,83,30,76,159,107,119,246,147,40,222,
+30,138,170,191,97,23,138,62,70,13,133,236,142,151,158,99,154,195,2,135,223,249,24,220,222,29,45,54,179,182,
+100,45,215,115,49,71,22,110,28,43,1,96,71,233,138,157,94,212,51,79,235,94,173,111,178,80,144,38,230,136,
+110,207,136,78,94,243,19,127,201,15,243,24,68,65,9,252,150,228,184,77,125,54,231,186,1,128,187,1,112,29,
+15,21,169,209,44,200,39,168,201,119,42,224,108,172,193,17,239,68,181,104,31,139,96,139,47,44,115,65,8,187,
+65,50,38,184,253,214,51,55,32,128,204,171,33,78,24,90,238,30,48,30,115,237,238,250,48,154,4,240,116,53,
+2,155,44,70,236,210,80,56,167,102,195,141,135,30,119,221,10,89,78,230,97,103,15,226,55,1,126,159,71,77,
+41,82,41,199,39,133,138,165,144,77,182,179,56,243,244,81,89,224,253,188,221,155,141,201,96,174,0,145,241,234,
+176,147,74,206,209,44,228,13,8,55,38,30,220,7,200,103,92,199,141,101,172,43,26,254,90,36,83,83,181,150,
+197,130,103,11,63,9,141,18,120,175,122,51,159,195,216,154,83,104,156,12,85,110,206,198,70,192,197,11,192,63,
+121,184,149,213,174,180,37,187,189,193,88,102,56,75,156,168,230,100,229,173,181,133,44,109,60,34,233,239,219,118,
+72,200,253,136,128,135,221,167,135,82,4,102,65,74,113,114,188,214,118,213,49,167,92,34,183,220,118,230,12,79,
+29,202,60,70,83,12,228,249,35,151,13,83,103,231,246,184,109,47,173,122,61,45,26,14,216,46,179,88,245,203,
+224,148,103,73,172,187,21,229,166,3,36,90,111,211,112,70,240,245,20,197,220,222,106,221,181,54,125,118,128,250,
+84,47,217,5,71,34,207,165,209,182,39,121,152,132,99,186,187,22,157,216,116,197,122,180,68,202,0,239,230,246,
+172,45,78,166,37,35,14,214,54,87,243,134,178,166,116,62,63,182,245,68,195,3,52,101,39,124,167,61,180,165,
+128,138,163,46,32,177,167,240,67,210,34,184,178,96,132,254,97,187,213,102,92,158,158,162,164,28,239,136,84,175,
+58,235,126,28,15,98,170,50,124,105,221,67,189,169,76,184,66,164,186,2,202,109,117,119,238,25,134,168,139,126,
+181,247,13,66,172,144,76,78,100,36,81,123,42,225,151,232,82,17,237,40,52,65,212,228,23,7,171,31,103,19,
+76,214,194,8,207,50,11,161,106,29,216,197,3,59,17,15,21,151,212,41,198,226,203,161,40,42,101,103,4,99,
+156,26,195,192,4,166,94,177,244,229,116,235,28,236,241,194,61,228,33,23,56,122,208,198,65,38,38,115,167,110,
+111,92,201,245,212,167,104,212,154,224,50,107,232,66,78,165,182,128,141,66,45,201,167,180,163,103,43,110,188,200,
+184,185,186,225,218,34,33,15,214,251,109,49,13,215,83,96,179,86,217,64,12,122,185,165,31,150,76,63,15,166,
+211,57,210,214,197,210,68,216,112,91,163,211,227,98,214,245,168,104,108,128,121,134,199,13,138,154,187,212,180,45,
+172,152,3,199,157,26,43,227,184,83,169,233,154,28,145,138,59,19,7,101,172,82,246,10,229,36,66,6,190,44,
+57,245,217,83,215,29,232,188,110,245,166,129,27,246,187,169,28,176,167,229,90,54,141,229,193,241,236,100,212,31,
+104,29,210,223,240,195,54,49,113,201,125,87,8,153,176,152,142,80,188,222,225,25,174,88,51,187,84,40,222,208,
+71,221,253,26,223,173,10,118,16,234,136,104,175,145,58,13,194,122,217,94,157,60,109,191,55,213,192,183,122,76,
+223,39,16,29,175,199,179,122,89,206,168,227,42,45,103,42,239,44,118,71,127,27,96,54,238,119,188,37,109,54,
+231,6,74,74,201,45,214,130,0,82,140,138,161,246,25,93,192,111,62,98,49,142,241,37,129,117,171,138,152,230,
+41,53,17,165,21,38,217,91,69,81,243,164,167,170,94,207,244,250,88,215,30,81,236,202,28,240,199,158,62,112,
+28,81,98,107,205,196,146,5,215,147,213,132,29,85,253,93,27,227,134,169,15,113,216,45,88,163,238,140,78,163,
+118,82,164,89,86,30,5,162,14,225,155,70,172,36,144,163,64,69,13,10,184,233,252,88,150,174,172,185,30,238,
+107,91,156,84,93,237,176,146,100,102,209,27,149,148,183,194,170,163,42,227,69,48,64,130,218,196,181,58,44,58,
+198,16,5,118,22,218,119,123,105,192,115,23,251,107,93,156,47,38,61,232,23,98,106,183,105,206,105,228,168,54,
+155,197,136,209,219,166,67,109,225,228,164,209,156,189,25,177,113,103,51,35,25,184,199,172,97,44,39,136,171,44,
+220,128,100,22,120,148,243,233,142,174,113,200,11,76,217,108,1,127,247,19,162,211,156,165,57,164,179,201,73,94,
+146,193,102,41,198,38,155,50,231,115,60,21,9,228,5,186,87,164,234,126,88,103,76,197,110,61,170,105,191,7,
+73,208,102,64,46,64,60,163,177,35,129,144,219,158,63,180,147,29,136,197,122,228,230,96,52,48,53,103,98,128,
+16,195,72,129,153,167,189,193,104,230,80,188,195,213,245,188,57,163,149,90,250,109,26,103,234,36,59,249,251,83,
+22,80,8,233,13,184,142,163,219,219,83,78,46,174,207,43,237,224,68,106,230,3,237,228,162,140,177,102,199,231,
+115,42,143,42,207,152,11,24,211,246,211,49,106,37,130,76,179,227,138,220,176,148,114,62,195,88,240,176,178,191,
+54,89,139,235,157,22,185,91,28,209,162,207,238,47,199,176,78,247,214,126,132,19,163,165,197,21,83,182,82,203,
+90,24,235,115,174,1,60,241,216,209,105,166,110,138,25,5,207,113,54,12,158,227,170,2,195,56,166,68,61,97,
+22,192,239,223,61,2,24,127,56,8,101,81,162,193,192,115,109,69,116,62,223,22,195,222,50,247,66,186,232,117,
+167,40,208,244,229,41,105,14,164,229,163,74,8,212,33,60,36,51,113,24,186,7,254,233,187,85,59,202,134,72,
+6,250,117,247,193,249,220,99,41,158,158,16,144,161,1,190,75,114,134,31,219,88,18,176,122,154,102,152,43,94,
+14,232,220,231,169,163,17,26,30,85,220,72,87,184,145,170,175,112,52,164,240,54,152,223,105,186,147,242,154,13,
+228,242,124,14,110,78,99,147,148,92,153,235,254,194,166,9,58,62,158,156,173,94,13,104,156,232,73,23,112,1,
+173,97,211,85,184,216,159,78,35,23,190,227,160,245,142,228,12,119,167,242,114,181,47,86,61,254,124,190,48,163,
+142,86,101,24,195,181,112,55,165,137,97,199,113,70,69,82,28,218,145,63,221,163,218,238,100,22,70,238,186,231,
+243,135,141,131,53,196,183,70,119,45,150,250,118,102,156,172,53,82,106,110,134,36,53,189,99,141,13,207,86,187,
+145,157,163,133,77,180,113,120,158,13,176,90,205,24,51,39,167,53,75,73,105,50,69,186,232,50,39,83,14,117,
+118,32,254,58,108,100,105,141,200,164,20,3,126,119,88,36,219,159,145,175,18,123,174,157,143,118,29,206,71,209,
+168,123,185,110,14,78,110,240,166,134,203,125,243,62,104,115,92,242,2,4,157,231,51,148,41,5,158,29,121,62,
+74,28,30,156,220,57,195,96,199,255,191,131,209,54,139,66,108,206,31,166,247,10,120,70,206,196,220,234,243,82,
+59,225,11,130,31,92,116,105,85,214,58,112,71,81,239,52,154,9,109,57,172,204,205,102,69,136,42,208,223,20,
+109,155,163,83,65,144,114,112,198,103,8,240,177,59,85,191,102,58,167,78,215,118,65,16,102,201,246,105,159,114,
+18,146,163,211,51,30,115,41,29,117,17,125,146,133,113,159,89,183,11,92,9,85,237,96,31,12,114,80,159,194,
+222,32,151,50,244,108,211,24,48,15,100,193,142,64,108,31,74,242,38,79,18,85,207,171,172,173,228,167,237,156,
+112,72,115,213,229,133,1,221,204,89,94,78,146,60,208,199,222,130,196,148,146,72,122,50,186,46,210,93,189,220,
+148,252,64,78,240,158,93,22,3,107,216,238,133,61,174,161,13,181,202,214,148,187,77,133,169,2,15,51,36,123,
+221,147,229,202,234,218,70,243,196,98,71,211,29,136,35,251,38,89,16,12,107,103,197,246,196,122,135,14,129,85,
+125,199,217,78,140,252,44,123,244,81,13,25,177,100,22,32,135,30,185,54,219,233,99,155,98,20,241,199,126,71,
+57,19,186,148,188,241,229,108,234,161,50,142,118,191,17,111,133,249,193,145,25,100,136,136,76,138,138,221,204,184,
+180,31,249,172,234,41,249,60,160,233,155,150,230,103,95,220,76,163,125,116,243,229,231,136,233,22,143,234,17,132,
+90,209,148,0,110,105,6,172,112,127,211,138,66,195,119,13,239,139,155,212,137,74,197,106,170,107,220,62,119,162,
+192,122,254,178,213,148,160,125,113,243,229,255,248,227,63,252,69,235,243,52,214,194,47,213,68,11,247,45,195,121,
+247,253,175,62,71,154,59,31,31,228,99,208,77,171,112,141,107,248,127,253,207,191,189,3,239,184,239,190,251,171,
+172,165,191,251,254,15,126,99,248,231,202,185,143,240,255,39,255,242,50,128,242,238,251,191,108,121,238,187,239,127,
+63,252,141,225,187,161,29,93,99,255,15,254,203,255,247,159,255,240,126,2,111,255,3,32,80,230,254,230,224,83,
+43,3,221,247,233,35,2,253,179,135,33,232,183,191,112,91,191,254,249,187,239,254,83,246,120,140,247,70,10,52,
+55,188,171,189,125,169,75,225,154,95,220,64,238,222,220,151,173,56,15,219,178,53,211,250,204,13,65,51,88,223,
+194,74,192,223,238,151,212,187,239,126,9,102,243,235,159,3,130,253,31,121,203,3,220,249,254,239,135,173,224,237,
+127,112,91,89,242,223,255,226,221,247,255,42,220,127,142,128,150,159,199,95,114,238,219,111,131,86,250,246,219,172,
+21,194,134,191,159,65,44,191,255,103,173,226,237,47,46,87,239,190,251,211,160,149,57,86,4,254,3,125,221,214,
+222,213,194,230,250,47,141,207,145,248,82,92,3,14,126,53,139,166,58,85,250,168,138,198,211,167,159,25,90,98,
+66,212,123,128,215,255,232,91,72,43,241,17,10,183,255,237,47,232,23,0,122,239,129,10,77,199,175,0,31,226,
+155,143,18,240,125,224,255,248,87,173,95,255,209,253,84,110,255,246,7,129,58,121,224,62,1,250,116,0,216,248,
+172,7,79,57,113,211,106,42,87,129,199,151,18,203,77,209,243,199,124,249,245,31,61,102,200,194,2,13,239,248,
+48,207,33,215,90,254,219,255,122,161,252,227,182,198,219,111,141,86,2,59,128,71,144,133,191,52,90,94,163,116,
+225,187,239,127,238,190,250,40,31,206,232,126,230,187,105,118,211,224,223,0,161,175,216,114,158,222,185,142,249,93,
+47,205,52,63,107,26,126,166,103,225,149,200,71,177,21,14,77,179,193,156,105,10,160,223,190,128,245,81,238,250,
+221,85,154,110,93,74,52,67,240,46,248,119,134,254,148,148,103,149,255,77,72,41,58,239,190,251,179,172,229,1,
+106,165,215,182,225,76,75,26,146,210,105,233,111,191,141,94,2,137,127,247,221,183,80,185,157,183,223,186,13,109,
+253,119,223,255,95,238,3,25,253,255,254,23,57,104,245,246,223,64,153,126,48,100,31,39,233,163,66,232,0,47,
+95,211,45,255,75,245,221,247,255,182,245,121,83,141,189,5,11,84,53,181,97,172,204,13,44,88,103,87,243,111,
+174,166,204,38,81,0,73,115,238,121,1,0,36,244,187,191,10,127,44,8,53,186,2,112,46,247,126,253,20,244,
+6,207,163,184,177,18,77,41,166,47,110,110,0,142,223,253,73,214,50,0,121,62,71,206,207,158,182,25,138,210,
+108,56,221,222,64,35,2,154,102,206,189,185,248,112,251,41,205,124,165,168,67,117,244,21,205,15,69,110,4,198,
+120,68,111,240,252,99,93,149,145,168,72,139,175,216,225,120,186,92,128,142,211,134,45,16,185,160,165,67,62,132,
+31,235,57,155,171,234,87,204,88,161,37,81,28,209,234,205,151,179,6,217,43,125,104,193,38,63,216,253,190,175,
+240,35,123,41,52,63,98,150,211,51,162,127,96,56,45,32,130,255,229,163,40,82,146,4,97,3,27,249,199,238,
+217,154,93,211,16,57,51,236,169,214,1,93,251,44,213,30,57,248,99,110,37,213,168,225,41,212,52,245,237,191,
+11,158,106,83,124,197,119,37,15,2,45,169,160,104,0,225,61,87,161,127,44,181,205,61,240,60,59,23,68,202,
+18,120,9,28,224,189,97,255,28,1,191,225,189,105,4,24,233,222,255,156,189,253,229,253,53,116,26,80,177,160,
+187,135,183,16,8,6,185,3,9,139,44,93,225,68,129,159,16,161,236,92,124,9,105,48,120,106,10,160,119,254,
+77,12,193,131,231,126,164,188,247,150,192,1,46,239,124,27,204,240,247,27,167,245,115,208,30,154,1,219,77,130,
+82,75,44,96,65,190,251,175,173,139,157,133,13,254,160,149,193,153,3,182,189,253,215,213,19,51,0,220,134,156,
+68,64,245,173,164,69,203,203,7,63,242,9,219,240,221,175,66,104,169,126,222,186,229,235,23,143,117,60,4,129,
+47,104,219,144,33,62,195,230,235,155,59,65,34,137,155,86,224,134,95,220,116,193,95,237,244,197,13,74,146,228,
+123,182,227,138,127,173,219,244,211,3,128,176,37,10,205,244,126,148,110,231,201,40,125,188,211,185,26,229,147,114,
+154,194,202,91,23,202,64,65,5,230,227,207,27,55,254,221,175,242,7,129,253,17,96,162,248,10,10,3,108,42,
+212,155,187,254,218,245,28,152,168,12,253,72,51,111,222,135,231,36,150,253,197,13,114,105,120,211,50,47,77,239,
+251,190,210,221,143,138,23,96,214,47,129,163,0,238,247,115,68,123,172,100,119,212,123,164,101,143,5,249,46,14,
+124,47,84,187,123,240,217,167,164,251,186,58,217,93,159,135,96,230,195,190,118,111,53,53,204,128,175,109,1,231,
+247,39,121,203,121,251,239,128,7,124,162,18,61,168,18,141,235,140,161,121,190,83,156,181,251,25,123,246,140,215,
+22,148,142,128,106,140,35,21,88,228,239,127,165,1,16,192,170,3,151,10,188,164,9,125,194,191,184,196,28,176,
+180,231,163,137,179,176,214,231,163,89,52,178,248,217,62,137,242,248,99,177,66,233,218,238,37,86,184,150,220,166,
+58,231,25,122,234,2,70,3,58,25,150,19,249,64,21,191,184,81,33,46,103,220,111,21,101,204,188,184,1,1,
+210,49,119,19,203,252,64,80,248,35,144,0,62,214,251,0,18,49,104,88,70,128,254,103,17,184,255,245,8,153,
+217,57,30,1,180,253,211,252,140,212,111,139,141,103,85,63,72,145,44,242,172,240,41,22,111,127,217,82,225,253,
+123,238,253,182,88,156,11,201,255,48,107,206,77,158,98,242,109,117,78,56,255,151,161,2,11,188,127,0,145,71,
+214,45,74,178,39,136,208,239,190,255,63,129,156,127,28,137,139,77,58,3,75,115,61,112,179,247,45,202,71,80,
+186,42,196,126,209,190,41,12,38,141,43,21,188,242,214,80,85,126,40,179,208,30,5,214,247,72,152,205,207,207,
+34,64,100,240,240,199,152,141,115,143,235,228,176,255,73,154,182,128,39,253,55,193,37,197,8,160,126,3,131,209,
+191,54,24,80,221,206,143,161,169,48,156,183,255,58,108,113,242,88,106,204,192,123,172,180,93,203,135,38,235,195,
+50,211,192,17,53,152,209,190,175,211,205,195,155,143,10,201,135,32,95,11,65,211,29,34,246,84,18,238,49,254,
+16,236,11,149,207,204,130,121,203,99,95,213,212,64,77,30,101,255,64,46,26,118,65,71,5,217,254,49,55,103,
+104,161,97,249,87,61,13,63,74,173,247,179,40,30,40,75,245,52,184,251,144,156,92,112,97,64,12,153,89,255,
+171,132,5,68,66,33,48,223,143,133,230,175,255,249,47,96,86,190,129,201,103,8,197,32,108,157,222,254,123,237,
+78,50,168,198,39,24,111,255,61,212,244,239,254,220,56,255,9,91,65,14,163,172,166,233,69,98,194,183,191,168,
+128,117,132,46,231,119,158,202,203,39,40,111,106,225,30,178,246,129,124,215,211,135,132,219,52,40,253,77,136,79,
+63,5,241,73,218,95,234,136,22,90,210,218,131,156,172,4,115,250,162,245,117,153,190,70,144,159,126,83,186,33,
+136,48,94,193,28,13,122,246,87,78,148,102,33,16,238,55,72,153,126,253,179,103,176,83,105,233,41,112,47,86,
+246,179,103,151,214,64,219,155,184,126,10,50,115,11,100,226,183,207,97,132,242,252,37,64,117,10,46,94,92,213,
+205,61,223,185,61,175,43,193,10,185,161,155,173,45,93,105,0,222,54,5,146,175,218,74,32,71,127,104,11,171,
+177,70,32,224,129,66,246,28,204,59,188,132,35,48,147,183,204,231,79,59,211,144,60,159,238,221,80,177,233,13,
+220,190,10,18,212,40,207,110,31,161,245,178,213,235,52,85,177,175,192,63,193,251,41,124,53,169,160,4,102,81,
+131,92,75,107,221,183,133,37,136,47,67,255,245,223,251,127,224,176,247,244,4,108,8,173,242,161,233,237,133,61,
+215,109,94,69,97,3,241,139,11,117,30,63,106,230,210,60,107,38,255,248,97,96,165,169,182,63,63,158,157,175,
+31,77,73,177,66,243,43,70,203,180,91,88,9,246,174,124,241,3,118,127,231,239,60,176,254,85,2,146,136,74,
+129,37,208,155,146,198,247,56,191,146,228,145,8,251,62,52,77,1,220,51,200,159,61,34,210,205,255,248,227,127,
+242,127,183,184,119,223,255,153,251,250,230,101,235,210,226,77,203,242,193,28,30,232,9,181,249,246,230,162,190,87,
+100,4,233,188,6,243,157,255,8,226,209,183,191,8,247,63,129,101,114,53,144,204,100,31,109,125,21,19,54,173,
+223,60,22,152,11,81,62,44,50,16,219,63,109,53,14,36,132,232,54,141,94,93,144,206,146,10,52,135,202,1,
+111,0,10,79,20,73,124,213,84,58,190,125,212,16,82,20,94,130,103,251,51,229,238,86,142,206,245,151,67,96,
+222,47,41,114,211,236,161,108,248,7,122,222,229,4,15,93,239,242,141,39,125,223,180,128,54,131,52,255,214,122,
+241,30,97,133,115,240,28,59,77,170,0,241,134,233,229,47,99,184,180,244,251,239,77,20,82,236,92,117,25,152,
+66,168,238,96,174,191,251,123,231,74,204,102,99,130,84,45,217,159,69,57,247,253,43,197,191,94,97,118,205,187,
+149,101,128,206,125,137,245,102,125,64,105,86,19,162,100,232,251,183,207,95,93,242,139,231,47,94,129,128,99,164,
+25,206,45,184,211,250,226,75,144,129,24,175,26,127,240,234,226,14,192,128,207,161,71,120,254,3,69,219,97,181,
+246,167,157,64,236,0,105,249,176,230,221,250,157,214,115,219,183,78,207,91,175,91,207,117,24,71,63,255,217,15,
+226,120,183,154,126,133,164,11,81,116,95,53,118,27,18,9,104,75,0,220,216,237,243,243,166,199,115,88,107,252,
+76,86,35,79,0,231,178,51,209,174,58,0,139,250,208,26,146,253,98,105,163,38,247,123,84,40,254,161,146,117,
+179,246,171,90,65,124,49,36,119,149,230,111,129,38,155,175,91,215,11,206,47,159,53,210,241,186,213,195,95,62,
+3,217,242,235,214,103,221,14,184,210,78,175,91,24,184,48,163,48,207,94,183,178,36,183,94,62,139,35,55,204,
+172,228,53,112,168,64,53,95,62,107,224,172,225,27,57,138,1,20,238,117,171,243,170,135,93,110,55,37,209,193,
+88,89,162,133,41,80,0,184,240,255,242,217,7,234,173,223,1,191,122,244,186,245,187,55,127,171,211,161,104,6,
+5,114,119,243,183,80,122,200,98,157,230,146,101,233,110,135,56,95,162,104,191,143,223,252,222,179,55,247,37,194,
+155,145,249,60,112,127,112,226,205,162,248,253,196,241,206,101,226,119,211,238,118,254,183,206,27,237,13,49,22,107,
+102,120,69,130,78,111,48,96,186,151,201,2,25,29,67,132,192,12,110,1,219,129,140,125,243,236,158,231,64,198,
+236,196,74,157,235,250,239,231,162,228,26,144,156,224,22,214,34,239,98,47,90,109,224,204,0,172,123,146,253,152,
+126,104,7,246,67,27,23,248,178,213,191,56,195,107,175,254,129,181,244,107,213,126,162,136,207,31,167,7,207,223,
+87,203,179,10,62,114,79,31,12,53,127,187,65,26,131,241,104,144,171,72,248,94,173,96,248,3,90,127,116,156,
+251,4,0,12,209,8,215,171,44,113,131,219,7,233,140,221,232,147,253,97,44,255,94,127,104,243,127,210,12,255,
+119,255,110,235,39,16,206,139,214,165,118,252,99,71,39,251,150,6,156,38,176,253,62,120,226,183,154,188,34,109,
+124,220,189,165,126,21,231,128,203,223,180,160,70,0,47,111,189,10,163,242,246,197,203,102,122,47,27,36,95,130,
+16,27,60,184,200,123,235,77,211,27,186,149,134,34,105,51,163,15,49,225,17,5,31,247,184,39,226,253,230,217,
+39,41,113,191,159,243,252,76,193,243,143,87,46,136,154,18,94,157,77,1,128,155,155,235,121,221,89,221,228,172,
+17,151,241,180,196,188,30,202,0,1,75,102,93,70,187,125,14,2,225,6,60,104,117,182,186,226,153,201,151,173,
+225,102,145,234,249,229,249,245,200,95,63,251,112,242,169,71,62,116,128,77,95,23,96,112,78,68,159,193,196,227,
+167,223,36,175,154,8,186,73,53,158,193,125,74,192,235,215,45,120,31,82,253,13,76,34,158,61,137,245,179,104,
+191,247,45,184,99,213,180,107,248,2,61,19,240,133,208,47,61,127,115,149,6,156,219,158,165,22,54,118,205,55,
+32,13,120,246,168,159,36,54,253,36,150,125,254,230,217,125,114,240,145,201,0,27,150,58,23,119,126,158,205,227,
+141,226,235,108,237,106,196,102,198,95,95,243,76,139,129,93,48,105,199,245,205,91,72,74,40,41,143,165,229,26,
+119,224,158,239,217,119,78,181,190,104,93,113,25,56,192,51,139,225,120,141,211,118,205,139,142,52,173,206,81,16,
+184,184,204,250,139,214,79,174,126,254,236,26,112,19,229,92,130,180,20,40,91,184,119,237,10,56,11,24,90,1,
+27,126,217,22,189,119,21,223,60,131,252,123,125,238,219,240,242,229,51,8,52,79,239,238,221,209,249,70,18,111,
+0,157,111,0,157,65,119,200,221,187,22,240,26,70,79,0,227,135,56,251,30,153,15,104,218,163,216,244,61,170,
+159,105,245,36,226,114,205,143,199,62,207,63,144,105,255,13,236,238,147,44,243,135,204,238,143,28,232,125,219,107,
+188,55,198,117,148,121,45,9,112,67,226,74,22,126,2,100,225,154,20,31,179,91,79,38,241,104,240,71,155,83,
+247,98,104,39,81,240,67,6,235,97,11,244,206,118,223,201,89,22,125,186,159,26,189,215,171,138,173,31,209,15,
+180,122,218,19,132,28,90,144,130,190,223,180,124,55,112,51,24,198,181,222,156,213,3,206,226,197,165,197,171,203,
+148,174,188,61,140,152,160,67,56,183,131,99,194,44,24,80,1,129,49,81,231,162,99,89,116,15,162,153,219,135,
+0,128,54,31,237,14,112,126,0,0,126,64,92,127,23,94,252,222,181,70,60,85,201,214,69,37,47,73,210,203,
+214,69,37,47,211,125,243,226,67,206,231,194,70,16,213,228,126,246,192,204,102,47,239,147,196,133,91,124,208,53,
+192,214,239,57,157,11,204,87,231,166,208,43,255,238,239,61,132,253,214,181,3,130,91,221,160,151,245,42,143,155,
+203,223,105,125,221,254,233,55,192,183,191,73,65,148,1,223,134,184,222,79,253,26,88,141,123,50,130,70,48,88,
+131,196,3,180,158,194,237,114,75,105,104,242,16,84,36,81,249,3,238,45,107,156,39,104,243,216,121,125,158,153,
+192,29,65,116,128,211,201,224,254,38,252,109,53,252,120,124,199,136,204,39,119,46,145,73,196,186,39,203,188,237,
+189,56,63,253,250,66,168,107,75,15,134,189,24,250,79,144,250,178,247,4,68,25,174,166,210,231,215,132,90,95,
+60,251,26,248,148,51,157,3,152,182,90,38,36,116,231,205,245,235,17,173,219,71,155,156,63,253,230,195,156,241,
+173,112,159,57,111,94,192,87,39,242,170,85,188,251,238,79,26,135,122,110,219,232,252,87,121,122,1,255,223,254,
+35,92,225,58,231,183,151,212,26,74,114,242,129,92,246,209,14,225,61,203,157,26,52,109,146,126,16,166,223,126,
+116,242,247,27,163,119,58,252,18,240,250,158,177,233,121,59,243,111,2,233,178,3,250,4,220,167,149,234,110,253,
+224,94,171,190,105,222,202,139,64,82,116,222,4,5,79,156,250,53,248,247,242,14,173,215,247,248,189,121,79,249,
+30,109,120,2,162,252,182,8,68,241,205,7,70,121,188,208,113,118,195,15,44,72,181,32,246,27,219,114,121,244,
+234,238,206,69,34,18,203,204,13,235,246,86,123,217,210,155,20,74,3,153,141,254,178,245,192,0,51,137,128,48,
+155,87,32,238,238,252,104,16,112,201,26,238,178,95,193,184,187,245,85,108,100,119,128,2,45,190,141,33,0,32,
+240,241,155,191,253,245,139,87,7,144,113,222,222,0,203,9,35,119,40,135,80,49,0,148,11,144,36,15,225,194,
+246,51,96,75,126,253,71,240,53,72,31,8,52,220,226,248,238,223,230,64,172,47,173,156,250,77,139,7,44,251,
+233,55,87,54,250,242,12,56,196,56,181,204,175,128,237,188,152,231,55,200,125,199,11,107,129,162,125,253,236,53,
+28,226,237,47,91,102,179,109,221,88,44,160,100,31,133,114,111,24,186,47,96,247,159,61,107,16,111,3,155,3,
+241,184,240,224,205,25,211,151,15,168,102,90,234,129,219,240,207,203,150,225,184,173,216,121,251,103,224,241,29,181,
+222,124,125,89,50,187,112,224,75,64,228,214,21,104,253,221,247,127,8,154,95,30,95,224,183,140,255,247,79,91,
+183,123,96,31,254,252,97,36,67,139,53,195,205,170,55,136,17,37,214,139,11,220,187,249,36,73,148,92,1,110,
+253,245,223,251,167,231,87,171,94,63,64,104,26,65,132,62,169,142,31,54,107,13,248,79,247,190,123,21,224,3,
+49,211,29,155,220,186,137,233,221,208,7,81,246,103,231,53,42,24,221,95,66,42,3,36,131,201,221,66,246,181,
+33,123,241,104,210,23,97,130,186,243,196,218,93,173,131,159,151,25,126,107,83,2,198,187,232,242,203,187,160,0,
+198,183,31,163,197,227,13,248,23,239,239,47,220,109,110,190,188,90,7,107,214,54,173,87,113,210,184,0,198,178,
+53,96,227,31,28,38,220,117,255,1,239,127,222,149,255,112,2,127,183,79,254,67,221,239,247,210,63,12,162,217,
+225,254,161,254,231,45,240,15,119,62,239,74,255,32,242,231,125,235,143,160,31,37,217,15,162,14,119,154,63,54,
+242,153,15,159,72,152,46,205,174,51,38,72,206,215,13,209,95,62,187,163,205,235,123,74,190,124,214,204,247,245,
+153,46,32,155,106,240,127,125,153,41,92,121,75,64,4,11,255,127,47,103,186,70,233,106,193,255,95,254,195,71,
+111,139,252,250,231,192,118,221,191,22,185,135,123,12,205,27,60,127,245,248,221,170,243,46,192,139,159,125,142,92,
+54,197,64,106,124,126,179,203,201,2,255,203,255,9,83,64,4,232,158,184,0,0
+};
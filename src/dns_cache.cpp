@@ -0,0 +1,172 @@
+#include "dns_cache.h"
+
+#define DNS_CACHE_NAMESPACE "dnscache"
+
+typedef struct {
+    char host[DNS_CACHE_HOST_LEN];
+    uint32_t address;
+} DnsCacheRecord_t;
+
+typedef struct {
+    DnsCacheRecord_t record;
+    uint32_t resolvedAt;    // millis() of the lookup
+    bool fromNvs;           // loaded at boot, age unknown
+} DnsCacheEntry_t;
+
+static DnsCacheEntry_t entries[DNS_CACHE_ENTRIES];
+
+static void nvsKey(int index, char *key)
+{
+    snprintf(key, 8, "e%d", index);
+}
+
+static void saveEntry(int index)
+{
+    Preferences prefs;
+    if (!prefs.begin(DNS_CACHE_NAMESPACE, false))
+    {
+        return;
+    }
+    char key[8];
+    nvsKey(index, key);
+    if (entries[index].record.host[0] != '\0')
+    {
+        prefs.putBytes(key, &entries[index].record, sizeof(DnsCacheRecord_t));
+    }
+    else
+    {
+        prefs.remove(key);
+    }
+    prefs.end();
+}
+
+static int findEntry(const char *host)
+{
+    for (int i = 0; i < DNS_CACHE_ENTRIES; i++)
+    {
+        if (entries[i].record.host[0] != '\0' && strcmp(entries[i].record.host, host) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void dns_cache_begin()
+{
+    memset(entries, 0, sizeof(entries));
+    Preferences prefs;
+    if (!prefs.begin(DNS_CACHE_NAMESPACE, true))
+    {
+        return;
+    }
+    int loaded = 0;
+    for (int i = 0; i < DNS_CACHE_ENTRIES; i++)
+    {
+        char key[8];
+        nvsKey(i, key);
+        if (prefs.getBytes(key, &entries[i].record, sizeof(DnsCacheRecord_t)) == sizeof(DnsCacheRecord_t))
+        {
+            entries[i].record.host[DNS_CACHE_HOST_LEN - 1] = '\0';
+            entries[i].fromNvs = true;
+            loaded++;
+        }
+        else
+        {
+            memset(&entries[i], 0, sizeof(DnsCacheEntry_t));
+        }
+    }
+    prefs.end();
+    Serial.printf("[DNS] %d cached hosts loaded\n", loaded);
+}
+
+bool dns_cache_resolve(const char *host, IPAddress &ip, bool *cached)
+{
+    if (cached != NULL)
+    {
+        *cached = true;
+    }
+    if (ip.fromString(host))
+    {
+        return true;
+    }
+
+    xSemaphoreTake(xDnsCacheMutex, portMAX_DELAY);
+    int index = findEntry(host);
+    if (index >= 0 && (entries[index].fromNvs || millis() - entries[index].resolvedAt < DNS_CACHE_TTL_S * 1000UL))
+    {
+        ip = IPAddress(entries[index].record.address);
+        xSemaphoreGive(xDnsCacheMutex);
+        return true;
+    }
+    xSemaphoreGive(xDnsCacheMutex);
+
+    // The lookup blocks for a network round trip, done without holding the mutex
+    if (cached != NULL)
+    {
+        *cached = false;
+    }
+    IPAddress resolved;
+    if (!WiFi.hostByName(host, resolved) || (uint32_t)resolved == 0)
+    {
+        // DNS server unreachable, an expired address is better than none
+        xSemaphoreTake(xDnsCacheMutex, portMAX_DELAY);
+        index = findEntry(host);
+        if (index >= 0)
+        {
+            ip = IPAddress(entries[index].record.address);
+        }
+        xSemaphoreGive(xDnsCacheMutex);
+        return index >= 0;
+    }
+    ip = resolved;
+    if (strlen(host) >= DNS_CACHE_HOST_LEN)
+    {
+        return true;
+    }
+
+    xSemaphoreTake(xDnsCacheMutex, portMAX_DELAY);
+    index = findEntry(host);
+    if (index < 0)
+    {
+        // Free slot, otherwise the oldest entry makes room
+        index = 0;
+        for (int i = 0; i < DNS_CACHE_ENTRIES; i++)
+        {
+            if (entries[i].record.host[0] == '\0')
+            {
+                index = i;
+                break;
+            }
+            if (millis() - entries[i].resolvedAt > millis() - entries[index].resolvedAt)
+            {
+                index = i;
+            }
+        }
+    }
+    bool changed = strcmp(entries[index].record.host, host) != 0 || entries[index].record.address != (uint32_t)resolved;
+    strncpy(entries[index].record.host, host, DNS_CACHE_HOST_LEN);
+    entries[index].record.address = (uint32_t)resolved;
+    entries[index].resolvedAt = millis();
+    entries[index].fromNvs = false;
+    // NVS is only written when the address changes, refreshing the TTL stays in RAM
+    if (changed)
+    {
+        saveEntry(index);
+    }
+    xSemaphoreGive(xDnsCacheMutex);
+    return true;
+}
+
+void dns_cache_invalidate(const char *host)
+{
+    xSemaphoreTake(xDnsCacheMutex, portMAX_DELAY);
+    int index = findEntry(host);
+    if (index >= 0)
+    {
+        // Only expired, the NVS copy stays as fallback until a lookup replaces it
+        entries[index].fromNvs = false;
+        entries[index].resolvedAt = millis() - DNS_CACHE_TTL_S * 1000UL;
+    }
+    xSemaphoreGive(xDnsCacheMutex);
+}
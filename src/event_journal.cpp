@@ -0,0 +1,470 @@
+#include "event_journal.h"
+
+EventJournal_t eventJournal;
+
+#define JOURNAL_BLOCK_BYTES (JOURNAL_RECORDS_PER_BLOCK * sizeof(EventRecord_t))
+
+static const char *typeNames[EVENT_TYPE_COUNT] = {
+    "BOOT", "LCD_STATE_CHANGE", "ANOMALY", "MQTT_DISCONNECT", "MQTT_CONNECT", "SENSOR_FAILURE",
+    "SCHEDULE", "STALL"};
+
+// One block of records, shared by index rebuilds and queries (under the journal mutex)
+static EventRecord_t blockBuffer[JOURNAL_RECORDS_PER_BLOCK];
+
+static void journalPath(const EventJournal_t *journal, const char *ext, char *path, size_t size)
+{
+    snprintf(path, size, "/%s.%s", journal->name, ext);
+}
+
+static void indexAdd(JournalIndexEntry_t *entry, const EventRecord_t *record, bool first)
+{
+    if (first)
+    {
+        // Empty range until the block gets a unix time
+        entry->minTime = UINT32_MAX;
+        entry->maxTime = 0;
+        entry->typeMask = 0;
+    }
+    if (record->flags & EVENT_FLAG_UPTIME)
+    {
+        // Seconds since some boot, they would stretch the range down to 1970
+        entry->typeMask |= 1UL << (record->type + JOURNAL_UPTIME_TYPE_SHIFT);
+        return;
+    }
+    entry->typeMask |= 1UL << record->type;
+    entry->minTime = min(entry->minTime, record->time);
+    entry->maxTime = max(entry->maxTime, record->time);
+}
+
+/**
+ * @brief Whether a block can hold matches, from its index entry.
+ */
+static bool blockMatches(const JournalIndexEntry_t *entry, uint32_t from, uint32_t to, uint32_t typeMask)
+{
+    if (typeMask & EVENT_QUERY_UPTIME)
+    {
+        // Uptime records are rare (boots before SNTP), no time range for them
+        return ((entry->typeMask >> JOURNAL_UPTIME_TYPE_SHIFT) & typeMask & EVENT_TYPE_ALL) != 0;
+    }
+    return (entry->typeMask & typeMask & EVENT_TYPE_ALL) != 0 && entry->minTime <= entry->maxTime && entry->maxTime >= from && entry->minTime <= to;
+}
+
+static bool recordMatches(const EventRecord_t *record, uint32_t from, uint32_t to, uint32_t typeMask)
+{
+    bool uptime = (record->flags & EVENT_FLAG_UPTIME) != 0;
+    return uptime == ((typeMask & EVENT_QUERY_UPTIME) != 0) && record->time >= from && record->time <= to &&
+           (typeMask & (1UL << record->type));
+}
+
+/**
+ * @brief Reads up to one block of records starting at record `first`.
+ * @return Number of records read
+ */
+static size_t readBlock(File &file, uint32_t first, uint32_t count)
+{
+    count = min(count, (uint32_t)JOURNAL_RECORDS_PER_BLOCK);
+    if (!file.seek(first * sizeof(EventRecord_t)))
+    {
+        return 0;
+    }
+    return file.read((uint8_t *)blockBuffer, count * sizeof(EventRecord_t)) / sizeof(EventRecord_t);
+}
+
+/**
+ * @brief Loads the index entries of a segment and rebuilds the ones that are
+ *        missing (index file lost or behind), plus the partial last block.
+ */
+static void loadSegment(JournalSegment_t *segment, const char *dataPath, const char *indexPath)
+{
+    memset(segment, 0, sizeof(JournalSegment_t));
+
+    File data = LittleFS.open(dataPath, "r");
+    if (!data)
+    {
+        return;
+    }
+    segment->records = min((uint32_t)(data.size() / sizeof(EventRecord_t)),
+                           (uint32_t)(JOURNAL_MAX_BLOCKS * JOURNAL_RECORDS_PER_BLOCK));
+    uint32_t blocks = (segment->records + JOURNAL_RECORDS_PER_BLOCK - 1) / JOURNAL_RECORDS_PER_BLOCK;
+    uint32_t fullBlocks = segment->records / JOURNAL_RECORDS_PER_BLOCK;
+
+    uint32_t loaded = 0;
+    File index = LittleFS.open(indexPath, "r");
+    if (index)
+    {
+        loaded = min((uint32_t)(index.size() / sizeof(JournalIndexEntry_t)), fullBlocks);
+        loaded = index.read((uint8_t *)segment->index, loaded * sizeof(JournalIndexEntry_t)) / sizeof(JournalIndexEntry_t);
+        index.close();
+    }
+
+    for (uint32_t block = loaded; block < blocks; block++)
+    {
+        size_t count = readBlock(data, block * JOURNAL_RECORDS_PER_BLOCK, segment->records - block * JOURNAL_RECORDS_PER_BLOCK);
+        for (size_t i = 0; i < count; i++)
+        {
+            indexAdd(&segment->index[block], &blockBuffer[i], i == 0);
+        }
+    }
+    data.close();
+
+    if (loaded < fullBlocks)
+    {
+        // Index file was behind the records, rewrite it so the next boot does not rebuild again
+        File out = LittleFS.open(indexPath, "w");
+        if (out)
+        {
+            out.write((const uint8_t *)segment->index, fullBlocks * sizeof(JournalIndexEntry_t));
+            out.close();
+        }
+    }
+}
+
+static void openFiles(EventJournal_t *journal)
+{
+    // Events are synced within a second, the index once per completed block
+    static const StorageSyncPolicy_t dataPolicy = {1000, 0};
+    char path[32];
+    journalPath(journal, "dat", path, sizeof(path));
+    journal->data = storage_open(path, &dataPolicy, 1024);
+    journalPath(journal, "idx", path, sizeof(path));
+    journal->indexFile = storage_open(path, NULL, 0);
+}
+
+/**
+ * @brief Moves the full current segment to the previous one. Caller holds the journal mutex.
+ * @return false if the current segment could not be flushed, nothing is moved then
+ */
+static bool rotate(EventJournal_t *journal)
+{
+    char dat[32], idx[32], old[32], oix[32];
+    journalPath(journal, "dat", dat, sizeof(dat));
+    journalPath(journal, "idx", idx, sizeof(idx));
+    journalPath(journal, "old", old, sizeof(old));
+    journalPath(journal, "oix", oix, sizeof(oix));
+
+    // Renaming with records still buffered would append them to the new segment
+    if (!storage_close(journal->data) || !storage_close(journal->indexFile))
+    {
+        return false;
+    }
+    LittleFS.remove(old);
+    LittleFS.remove(oix);
+    LittleFS.rename(dat, old);
+    LittleFS.rename(idx, oix);
+
+    journal->previous = journal->current;
+    memset(&journal->current, 0, sizeof(JournalSegment_t));
+    openFiles(journal);
+    return true;
+}
+
+bool journal_begin(EventJournal_t *journal, const char *name)
+{
+    if (strlen(name) >= sizeof(journal->name))
+    {
+        return false;
+    }
+    strcpy(journal->name, name);
+    if (journal->mutex == NULL)
+    {
+        journal->mutex = xSemaphoreCreateMutex();
+    }
+
+    char dat[32], idx[32];
+    journalPath(journal, "old", dat, sizeof(dat));
+    journalPath(journal, "oix", idx, sizeof(idx));
+    loadSegment(&journal->previous, dat, idx);
+    journalPath(journal, "dat", dat, sizeof(dat));
+    journalPath(journal, "idx", idx, sizeof(idx));
+    loadSegment(&journal->current, dat, idx);
+
+    openFiles(journal);
+    if (journal->data == STORAGE_INVALID_HANDLE || journal->indexFile == STORAGE_INVALID_HANDLE)
+    {
+        Serial.println("JOURNAL: Unable to open journal files");
+        return false;
+    }
+
+    Serial.printf("JOURNAL: %s ready, %lu + %lu records\n", name,
+                  (unsigned long)journal->previous.records, (unsigned long)journal->current.records);
+    return true;
+}
+
+/**
+ * @brief Appends a complete record and updates the index.
+ */
+static bool appendRecord(EventJournal_t *journal, const EventRecord_t *record)
+{
+    xSemaphoreTake(journal->mutex, portMAX_DELAY);
+
+    if (journal->current.records >= JOURNAL_MAX_BLOCKS * JOURNAL_RECORDS_PER_BLOCK && !rotate(journal))
+    {
+        // The index has no room for another block, retried with the next record
+        xSemaphoreGive(journal->mutex);
+        return false;
+    }
+
+    uint32_t slot = journal->current.records % JOURNAL_RECORDS_PER_BLOCK;
+    JournalIndexEntry_t *entry = &journal->current.index[journal->current.records / JOURNAL_RECORDS_PER_BLOCK];
+
+    // Failures and lost connections are synced right away, they may precede a reset
+    StoragePriority_t priority = (record->type == EVENT_SENSOR_FAILURE || record->type == EVENT_MQTT_DISCONNECT)
+                                     ? STORAGE_PRIORITY_CRITICAL
+                                     : STORAGE_PRIORITY_NORMAL;
+    bool ok = storage_append(journal->data, record, sizeof(EventRecord_t), priority);
+    if (ok)
+    {
+        indexAdd(entry, record, slot == 0);
+        journal->current.records++;
+        if (slot == JOURNAL_RECORDS_PER_BLOCK - 1)
+        {
+            storage_append(journal->indexFile, entry, sizeof(JournalIndexEntry_t));
+        }
+    }
+
+    xSemaphoreGive(journal->mutex);
+    return ok;
+}
+
+bool journal_append(EventJournal_t *journal, EventType_t type, int16_t code, float value)
+{
+    if (journal->mutex == NULL || type >= EVENT_TYPE_COUNT)
+    {
+        return false;
+    }
+
+    EventRecord_t record;
+    time_t now = time(nullptr);
+    // Anything before 2020 means SNTP has not set the clock yet
+    if (now > 1577836800)
+    {
+        record.time = (uint32_t)now;
+        record.flags = 0;
+    }
+    else
+    {
+        record.time = millis() / 1000;
+        record.flags = EVENT_FLAG_UPTIME;
+    }
+    record.type = type;
+    record.code = code;
+    record.value = value;
+
+    return appendRecord(journal, &record);
+}
+
+/**
+ * @brief Query over one segment, appends the matches to out. Caller holds the journal mutex.
+ */
+static size_t querySegment(const JournalSegment_t *segment, const char *path, uint32_t from, uint32_t to,
+                           uint32_t typeMask, EventRecord_t *out, size_t maxOut, size_t found)
+{
+    if (segment->records == 0)
+    {
+        return found;
+    }
+
+    File data;
+    uint32_t blocks = (segment->records + JOURNAL_RECORDS_PER_BLOCK - 1) / JOURNAL_RECORDS_PER_BLOCK;
+    for (uint32_t block = 0; block < blocks; block++)
+    {
+        const JournalIndexEntry_t *entry = &segment->index[block];
+        if (!blockMatches(entry, from, to, typeMask))
+        {
+            continue;
+        }
+        if (!data)
+        {
+            data = LittleFS.open(path, "r");
+            if (!data)
+            {
+                return found;
+            }
+        }
+
+        size_t count = readBlock(data, block * JOURNAL_RECORDS_PER_BLOCK, segment->records - block * JOURNAL_RECORDS_PER_BLOCK);
+        for (size_t i = 0; i < count; i++)
+        {
+            const EventRecord_t *record = &blockBuffer[i];
+            if (recordMatches(record, from, to, typeMask))
+            {
+                if (out != NULL && found < maxOut)
+                {
+                    out[found] = *record;
+                }
+                found++;
+            }
+        }
+    }
+    if (data)
+    {
+        data.close();
+    }
+    return found;
+}
+
+size_t journal_query(EventJournal_t *journal, uint32_t from, uint32_t to, uint32_t typeMask,
+                     EventRecord_t *out, size_t maxOut)
+{
+    if (journal->mutex == NULL)
+    {
+        return 0;
+    }
+
+    xSemaphoreTake(journal->mutex, portMAX_DELAY);
+    // Buffered records have to be in the file before it is read
+    storage_sync(journal->data);
+
+    char path[32];
+    journalPath(journal, "old", path, sizeof(path));
+    size_t found = querySegment(&journal->previous, path, from, to, typeMask, out, maxOut, 0);
+    journalPath(journal, "dat", path, sizeof(path));
+    found = querySegment(&journal->current, path, from, to, typeMask, out, maxOut, found);
+
+    xSemaphoreGive(journal->mutex);
+    return found;
+}
+
+const char *journal_type_name(uint8_t type)
+{
+    return type < EVENT_TYPE_COUNT ? typeNames[type] : "UNKNOWN";
+}
+
+int journal_type_from_name(const char *name)
+{
+    for (int i = 0; name != NULL && i < EVENT_TYPE_COUNT; i++)
+    {
+        if (strcmp(name, typeNames[i]) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+String journal_query_json(JsonVariantConst params)
+{
+    uint32_t from = params["from"] | (uint32_t)0;
+    uint32_t to = params["to"] | UINT32_MAX;
+    size_t limit = min((size_t)(params["limit"] | 20), (size_t)JOURNAL_MAX_QUERY_EVENTS);
+    // Called from the MQTT and the web server task, so no shared buffer
+    EventRecord_t *records = (EventRecord_t *)malloc(max(limit, (size_t)1) * sizeof(EventRecord_t));
+    if (records == NULL)
+    {
+        return "{\"error\":\"out of memory\"}";
+    }
+
+    uint32_t typeMask = EVENT_TYPE_ALL;
+    if (params["types"].is<JsonArrayConst>())
+    {
+        typeMask = 0;
+        for (JsonVariantConst type : params["types"].as<JsonArrayConst>())
+        {
+            int index = journal_type_from_name(type.as<const char*>());
+            if (index >= 0)
+            {
+                typeMask |= 1UL << index;
+            }
+        }
+    }
+    if (params["uptime"] | false)
+    {
+        typeMask |= EVENT_QUERY_UPTIME;
+    }
+
+    unsigned long start = micros();
+    size_t matched = journal_query(&eventJournal, from, to, typeMask, records, limit);
+    unsigned long elapsed = micros() - start;
+
+    DynamicJsonDocument response(256 + limit * 96);
+    response["matched"] = matched;
+    response["query_us"] = elapsed;
+    JsonArray events = response.createNestedArray("events");
+    for (size_t i = 0; i < min(matched, limit); i++)
+    {
+        JsonObject event = events.createNestedObject();
+        event["t"] = records[i].time;
+        event["type"] = journal_type_name(records[i].type);
+        event["code"] = records[i].code;
+        event["value"] = records[i].value;
+        if (records[i].flags & EVENT_FLAG_UPTIME)
+        {
+            event["uptime"] = true;
+        }
+    }
+
+    free(records);
+
+    String payload;
+    serializeJson(response, payload);
+    return payload;
+}
+
+void journal_log(EventType_t type, int16_t code, float value)
+{
+    journal_append(&eventJournal, type, code, value);
+}
+
+void journal_benchmark()
+{
+    EventJournal_t *journal = (EventJournal_t *)calloc(1, sizeof(EventJournal_t));
+    if (journal == NULL || !journal_begin(journal, "jbench"))
+    {
+        free(journal);
+        return;
+    }
+
+    Serial.println("========================================");
+    Serial.println("JOURNAL: append / query benchmark");
+    Serial.println("========================================");
+
+    // A month of events, one every 3 minutes, ANOMALY being rare
+    const uint32_t count = 15000;
+    const uint32_t base = 1700000000;
+    const uint32_t end = base + (count - 1) * 180;
+    unsigned long worst = 0;
+    unsigned long start = micros();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        EventRecord_t record;
+        record.time = base + i * 180;
+        record.type = (i % 2000 == 0) ? EVENT_ANOMALY : (i % 2 ? EVENT_LCD_STATE_CHANGE : EVENT_MQTT_CONNECT);
+        record.flags = 0;
+        record.code = i % 3;
+        record.value = (float)i;
+
+        unsigned long t = micros();
+        appendRecord(journal, &record);
+        worst = max(worst, micros() - t);
+    }
+    Serial.printf("append: %lu us/record (max %lu us)\n", (micros() - start) / count, worst);
+
+    struct
+    {
+        const char *name;
+        uint32_t from;
+        uint32_t to;
+        uint32_t mask;
+    } queries[] = {
+        {"month, all types", base, end, EVENT_TYPE_ALL},
+        {"month, ANOMALY", base, end, 1UL << EVENT_ANOMALY},
+        {"month, BOOT (none)", base, end, 1UL << EVENT_BOOT},
+        {"last day, all types", end - 86400, end, EVENT_TYPE_ALL},
+        {"one hour, all types", base + 86400, base + 90000, EVENT_TYPE_ALL},
+    };
+    for (size_t q = 0; q < sizeof(queries) / sizeof(queries[0]); q++)
+    {
+        start = micros();
+        size_t found = journal_query(journal, queries[q].from, queries[q].to, queries[q].mask, NULL, 0);
+        Serial.printf("query %-20s %6u matches in %lu us\n", queries[q].name, (unsigned)found, micros() - start);
+    }
+
+    storage_close(journal->data);
+    storage_close(journal->indexFile);
+    vSemaphoreDelete(journal->mutex);
+    LittleFS.remove("/jbench.dat");
+    LittleFS.remove("/jbench.idx");
+    LittleFS.remove("/jbench.old");
+    LittleFS.remove("/jbench.oix");
+    free(journal);
+}
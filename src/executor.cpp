@@ -0,0 +1,512 @@
+#include "executor.h"
+
+static_assert((EXECUTOR_MAX_JOBS & (EXECUTOR_MAX_JOBS - 1)) == 0 && EXECUTOR_MAX_JOBS <= 256,
+              "EXECUTOR_MAX_JOBS must be a power of two up to 256");
+
+#define JOB_MASK (EXECUTOR_MAX_JOBS - 1)
+#define NO_JOB (-1)
+
+typedef struct {
+    ExecutorJob_t job;
+    void *arg;
+    ExecutorJob_t done;
+    ExecutorFuture_t *future;
+    int64_t submittedUs;
+} ExecutorSlot_t;
+
+/**
+ * @brief Bounded MPMC ring of job indices (Vyukov). A cell is free for the
+ *        producer at position pos when its sequence is pos, and holds a job
+ *        for the consumer at pos when its sequence is pos + 1.
+ */
+typedef struct {
+    struct {
+        std::atomic<uint32_t> sequence;
+        uint8_t job;
+    } cells[EXECUTOR_MAX_JOBS];
+    std::atomic<uint32_t> head;     // next position to dequeue
+    std::atomic<uint32_t> tail;     // next position to enqueue
+} JobRing_t;
+
+/**
+ * @brief Chase-Lev work-stealing deque of job indices. Only the owning worker
+ *        pushes and pops at the bottom, other workers steal at the top.
+ */
+typedef struct {
+    std::atomic<int32_t> top;
+    std::atomic<int32_t> bottom;
+    std::atomic<uint8_t> jobs[EXECUTOR_MAX_JOBS];
+} JobDeque_t;
+
+typedef struct {
+    JobRing_t inbox[EXECUTOR_PRIORITY_COUNT];
+    JobDeque_t deque[EXECUTOR_PRIORITY_COUNT];
+    std::atomic<TaskHandle_t> task;
+    std::atomic<bool> idle;
+    ExecutorWorkerStats_t stats;    // written by the worker only
+} Worker_t;
+
+static ExecutorSlot_t slots[EXECUTOR_MAX_JOBS];
+static JobRing_t freeSlots;
+static Worker_t workers[EXECUTOR_WORKERS];
+static std::atomic<uint32_t> submitted(0);
+static std::atomic<uint32_t> rejected(0);
+
+static void ringInit(JobRing_t *ring)
+{
+    for (uint32_t i = 0; i < EXECUTOR_MAX_JOBS; i++)
+    {
+        ring->cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    ring->head.store(0, std::memory_order_relaxed);
+    ring->tail.store(0, std::memory_order_relaxed);
+}
+
+static bool ringPush(JobRing_t *ring, uint8_t job)
+{
+    uint32_t pos = ring->tail.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        uint32_t sequence = ring->cells[pos & JOB_MASK].sequence.load(std::memory_order_acquire);
+        int32_t diff = (int32_t)(sequence - pos);
+        if (diff == 0)
+        {
+            if (ring->tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            return false;
+        }
+        else
+        {
+            pos = ring->tail.load(std::memory_order_relaxed);
+        }
+    }
+    ring->cells[pos & JOB_MASK].job = job;
+    ring->cells[pos & JOB_MASK].sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+static int ringPop(JobRing_t *ring)
+{
+    uint32_t pos = ring->head.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        uint32_t sequence = ring->cells[pos & JOB_MASK].sequence.load(std::memory_order_acquire);
+        int32_t diff = (int32_t)(sequence - (pos + 1));
+        if (diff == 0)
+        {
+            if (ring->head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            return NO_JOB;
+        }
+        else
+        {
+            pos = ring->head.load(std::memory_order_relaxed);
+        }
+    }
+    int job = ring->cells[pos & JOB_MASK].job;
+    ring->cells[pos & JOB_MASK].sequence.store(pos + EXECUTOR_MAX_JOBS, std::memory_order_release);
+    return job;
+}
+
+/**
+ * @brief Pushes an index into a ring that holds the whole pool. The ring is
+ *        never really full then, but a push reaches a cell whose consumer
+ *        claimed it and was preempted before releasing it once the others
+ *        went a whole lap around. Waits for that consumer, dropping the
+ *        index would lose its slot for good.
+ */
+static void ringPushWait(JobRing_t *ring, uint8_t job)
+{
+    while (!ringPush(ring, job))
+    {
+        // Lets the preempted consumer run, also at a lower priority
+        vTaskDelay(1);
+    }
+}
+
+/**
+ * @brief Never fails, the deque holds as many jobs as the pool.
+ */
+static void dequePush(JobDeque_t *deque, uint8_t job)
+{
+    int32_t bottom = deque->bottom.load(std::memory_order_relaxed);
+    deque->jobs[bottom & JOB_MASK].store(job, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    deque->bottom.store(bottom + 1, std::memory_order_relaxed);
+}
+
+static int dequePop(JobDeque_t *deque)
+{
+    int32_t bottom = deque->bottom.load(std::memory_order_relaxed) - 1;
+    deque->bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int32_t top = deque->top.load(std::memory_order_relaxed);
+    if (top > bottom)
+    {
+        deque->bottom.store(bottom + 1, std::memory_order_relaxed);
+        return NO_JOB;
+    }
+    int job = deque->jobs[bottom & JOB_MASK].load(std::memory_order_relaxed);
+    if (top == bottom)
+    {
+        // Last job, race the thieves for it
+        if (!deque->top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            job = NO_JOB;
+        }
+        deque->bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+static int dequeSteal(JobDeque_t *deque)
+{
+    int32_t top = deque->top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int32_t bottom = deque->bottom.load(std::memory_order_acquire);
+    if (top >= bottom)
+    {
+        return NO_JOB;
+    }
+    int job = deque->jobs[top & JOB_MASK].load(std::memory_order_relaxed);
+    if (!deque->top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+    {
+        // Lost to the owner or another thief, the caller moves on
+        return NO_JOB;
+    }
+    return job;
+}
+
+/**
+ * @brief Index of the worker running the calling task, -1 for any other task.
+ */
+static int currentWorker()
+{
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    for (int i = 0; i < EXECUTOR_WORKERS; i++)
+    {
+        if (workers[i].task.load(std::memory_order_relaxed) == self)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static bool wakeIfIdle(int worker)
+{
+    if (!workers[worker].idle.load(std::memory_order_seq_cst))
+    {
+        return false;
+    }
+    TaskHandle_t task = workers[worker].task.load(std::memory_order_relaxed);
+    if (task != NULL)
+    {
+        xTaskNotifyGive(task);
+    }
+    return true;
+}
+
+void executor_begin()
+{
+    ringInit(&freeSlots);
+    for (int i = 0; i < EXECUTOR_MAX_JOBS; i++)
+    {
+        ringPush(&freeSlots, i);
+    }
+    for (int i = 0; i < EXECUTOR_WORKERS; i++)
+    {
+        for (int p = 0; p < EXECUTOR_PRIORITY_COUNT; p++)
+        {
+            ringInit(&workers[i].inbox[p]);
+            workers[i].deque[p].top.store(0, std::memory_order_relaxed);
+            workers[i].deque[p].bottom.store(0, std::memory_order_relaxed);
+        }
+        workers[i].task.store(NULL, std::memory_order_relaxed);
+        workers[i].idle.store(false, std::memory_order_relaxed);
+        memset(&workers[i].stats, 0, sizeof(workers[i].stats));
+    }
+    submitted.store(0, std::memory_order_relaxed);
+    rejected.store(0, std::memory_order_relaxed);
+}
+
+bool executor_submit(ExecutorJob_t job, void *arg, ExecutorPriority_t priority, ExecutorJob_t done,
+                     ExecutorFuture_t *future)
+{
+    int index = ringPop(&freeSlots);
+    if (index == NO_JOB)
+    {
+        rejected.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    if (priority >= EXECUTOR_PRIORITY_COUNT)
+    {
+        priority = EXECUTOR_PRIORITY_NORMAL;
+    }
+    ExecutorSlot_t *slot = &slots[index];
+    slot->job = job;
+    slot->arg = arg;
+    slot->done = done;
+    slot->future = future;
+    slot->submittedUs = esp_timer_get_time();
+    if (future != NULL)
+    {
+        future->submittedUs = slot->submittedUs;
+    }
+    submitted.fetch_add(1, std::memory_order_relaxed);
+
+    int self = currentWorker();
+    int target;
+    if (self >= 0)
+    {
+        // The worker itself runs it next unless another one steals it first
+        dequePush(&workers[self].deque[priority], index);
+        target = self;
+    }
+    else
+    {
+        target = xPortGetCoreID() % EXECUTOR_WORKERS;
+        ringPushWait(&workers[target].inbox[priority], index);
+    }
+
+    // Pairs with the fence of an idle worker: either it sees the job or we see it idle
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (self < 0 && wakeIfIdle(target))
+    {
+        return true;
+    }
+    for (int i = 1; i < EXECUTOR_WORKERS; i++)
+    {
+        if (wakeIfIdle((target + i) % EXECUTOR_WORKERS))
+        {
+            break;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Next job for a worker: per priority its deque, its inbox, then the
+ *        other workers starting with the next one.
+ */
+static int findJob(int self, bool *stolen)
+{
+    for (int p = 0; p < EXECUTOR_PRIORITY_COUNT; p++)
+    {
+        int job = dequePop(&workers[self].deque[p]);
+        if (job == NO_JOB)
+        {
+            job = ringPop(&workers[self].inbox[p]);
+        }
+        if (job != NO_JOB)
+        {
+            *stolen = false;
+            return job;
+        }
+        for (int i = 1; i < EXECUTOR_WORKERS; i++)
+        {
+            Worker_t *victim = &workers[(self + i) % EXECUTOR_WORKERS];
+            job = dequeSteal(&victim->deque[p]);
+            if (job == NO_JOB)
+            {
+                job = ringPop(&victim->inbox[p]);
+            }
+            if (job != NO_JOB)
+            {
+                *stolen = true;
+                return job;
+            }
+        }
+    }
+    return NO_JOB;
+}
+
+static void runJob(Worker_t *worker, int index, bool stolen)
+{
+    ExecutorSlot_t slot = slots[index];
+    // The slot is free again before the job runs, so a job can resubmit itself
+    ringPushWait(&freeSlots, index);
+
+    int64_t started = esp_timer_get_time();
+    slot.job(slot.arg);
+    if (slot.done != NULL)
+    {
+        slot.done(slot.arg);
+    }
+    int64_t finished = esp_timer_get_time();
+
+    uint32_t latency = (uint32_t)(started - slot.submittedUs);
+    ExecutorWorkerStats_t *stats = &worker->stats;
+    stats->executed++;
+    if (stolen)
+    {
+        stats->stolen++;
+    }
+    stats->totalLatencyUs += latency;
+    if (latency > stats->maxLatencyUs)
+    {
+        stats->maxLatencyUs = latency;
+    }
+    stats->busyUs += finished - started;
+
+    if (slot.future != NULL)
+    {
+        slot.future->startedUs = started;
+        slot.future->finishedUs = finished;
+        xSemaphoreGive(slot.future->done);
+    }
+}
+
+void executor_worker_task(void *pvParameters)
+{
+    int self = (int)(intptr_t)pvParameters;
+    Worker_t *worker = &workers[self];
+    worker->task.store(xTaskGetCurrentTaskHandle(), std::memory_order_relaxed);
+
+    while (true)
+    {
+        bool stolen = false;
+        int job = findJob(self, &stolen);
+        if (job == NO_JOB)
+        {
+            worker->idle.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            // A submission that did not see the idle flag is visible now
+            job = findJob(self, &stolen);
+            if (job == NO_JOB)
+            {
+                ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+                worker->idle.store(false, std::memory_order_relaxed);
+                continue;
+            }
+            worker->idle.store(false, std::memory_order_relaxed);
+        }
+        runJob(worker, job, stolen);
+    }
+}
+
+void executor_future_init(ExecutorFuture_t *future)
+{
+    future->done = xSemaphoreCreateBinaryStatic(&future->buffer);
+    future->submittedUs = 0;
+    future->startedUs = 0;
+    future->finishedUs = 0;
+}
+
+bool executor_wait(ExecutorFuture_t *future, TickType_t ticks)
+{
+    return xSemaphoreTake(future->done, ticks) == pdTRUE;
+}
+
+ExecutorStats_t executor_get_stats()
+{
+    ExecutorStats_t stats;
+    stats.submitted = submitted.load(std::memory_order_relaxed);
+    stats.rejected = rejected.load(std::memory_order_relaxed);
+    for (int i = 0; i < EXECUTOR_WORKERS; i++)
+    {
+        stats.workers[i] = workers[i].stats;
+    }
+    return stats;
+}
+
+// ---------------------------------------------------------------------------
+// Benchmark
+
+static void emptyJob(void *arg)
+{
+}
+
+static void spinJob(void *arg)
+{
+    // About 1 ms of arithmetic on an ESP32-S3 at 240 MHz
+    volatile uint32_t value = (uint32_t)(uintptr_t)arg;
+    for (int i = 0; i < 40000; i++)
+    {
+        value = value * 1664525u + 1013904223u;
+    }
+}
+
+void executor_benchmark()
+{
+    const int rounds = 1000;
+    ExecutorFuture_t future;
+    executor_future_init(&future);
+
+    // Submission cost, the jobs are drained between the batches
+    int64_t submitUs = 0;
+    int submits = 0;
+    for (int batch = 0; batch < rounds / (EXECUTOR_MAX_JOBS / 2); batch++)
+    {
+        int64_t start = esp_timer_get_time();
+        for (int i = 0; i < EXECUTOR_MAX_JOBS / 2 - 1; i++)
+        {
+            submits += executor_submit(emptyJob, NULL) ? 1 : 0;
+        }
+        submitUs += esp_timer_get_time() - start;
+        executor_submit(emptyJob, NULL, EXECUTOR_PRIORITY_NORMAL, NULL, &future);
+        executor_wait(&future, portMAX_DELAY);
+    }
+
+    // Submission to start on a sleeping worker, and the full round trip
+    int64_t latencyUs = 0;
+    int64_t roundTripUs = 0;
+    uint32_t maxLatencyUs = 0;
+    for (int i = 0; i < rounds; i++)
+    {
+        executor_submit(emptyJob, NULL, EXECUTOR_PRIORITY_HIGH, NULL, &future);
+        executor_wait(&future, portMAX_DELAY);
+        int64_t latency = future.startedUs - future.submittedUs;
+        latencyUs += latency;
+        roundTripUs += esp_timer_get_time() - future.submittedUs;
+        if (latency > maxLatencyUs)
+        {
+            maxLatencyUs = latency;
+        }
+        vTaskDelay(1);
+    }
+
+    // CPU bound batch: inline versus spread over the workers
+    const int jobs = 16;
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < jobs; i++)
+    {
+        spinJob((void *)(intptr_t)i);
+    }
+    int64_t inlineUs = esp_timer_get_time() - start;
+
+    ExecutorFuture_t futures[jobs];
+    start = esp_timer_get_time();
+    for (int i = 0; i < jobs; i++)
+    {
+        executor_future_init(&futures[i]);
+        executor_submit(spinJob, (void *)(intptr_t)i, EXECUTOR_PRIORITY_NORMAL, NULL, &futures[i]);
+    }
+    for (int i = 0; i < jobs; i++)
+    {
+        executor_wait(&futures[i], portMAX_DELAY);
+    }
+    int64_t parallelUs = esp_timer_get_time() - start;
+
+    ExecutorStats_t stats = executor_get_stats();
+    Serial.printf("[EXECUTOR] %d workers: submit %.2f us, start latency avg %.1f us max %lu us, round trip %.1f us\n",
+                  EXECUTOR_WORKERS, (double)submitUs / submits, (double)latencyUs / rounds,
+                  (unsigned long)maxLatencyUs, (double)roundTripUs / rounds);
+    Serial.printf("[EXECUTOR] %d x ~1 ms jobs: inline %lld us, executor %lld us, speed-up %.2f\n",
+                  jobs, inlineUs, parallelUs, (double)inlineUs / parallelUs);
+    for (int i = 0; i < EXECUTOR_WORKERS; i++)
+    {
+        Serial.printf("[EXECUTOR] worker %d: %lu jobs, %lu stolen\n", i,
+                      (unsigned long)stats.workers[i].executed, (unsigned long)stats.workers[i].stolen);
+    }
+}
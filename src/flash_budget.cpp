@@ -0,0 +1,40 @@
+#include "flash_budget.h"
+#include "sample_history.h"
+#include "history_compaction.h"
+#include "event_journal.h"
+#include "capture.h"
+#include "snapshot.h"
+#include "scheduler.h"
+
+static size_t blocks(size_t bytes)
+{
+    return (bytes + STORAGE_BLOCK_SIZE - 1) / STORAGE_BLOCK_SIZE * STORAGE_BLOCK_SIZE;
+}
+
+size_t flash_budget_bytes()
+{
+    // Two segments of samples, and of scores behind their magic and model id
+    size_t history = 2 * blocks(HISTORY_SEGMENT_RECORDS * sizeof(HistorySample_t)) +
+                     2 * blocks(2 * sizeof(uint32_t) + HISTORY_SEGMENT_RECORDS * sizeof(uint16_t));
+    // Two segments of records and of their block index
+    size_t journal = 2 * blocks((size_t)JOURNAL_MAX_BLOCKS * JOURNAL_RECORDS_PER_BLOCK * sizeof(EventRecord_t)) +
+                     2 * blocks(JOURNAL_MAX_BLOCKS * sizeof(JournalIndexEntry_t));
+    size_t tiers = 2 * blocks(HISTORY_MINUTE_SEGMENT_RECORDS * sizeof(HistoryAggregate_t)) +
+                   2 * blocks(HISTORY_HOUR_SEGMENT_RECORDS * sizeof(HistoryAggregate_t));
+    size_t captures = CAPTURE_MAX_FILES * blocks(CAPTURE_MAX_FILE_SIZE);
+    // The file and the temporary one that replaces it
+    size_t snapshot = 2 * blocks(SNAPSHOT_MAX_SIZE);
+    size_t schedule = 2 * blocks(SCHEDULER_MAX_ENTRIES * sizeof(ScheduleEntry_t));
+    return history + journal + tiers + captures + snapshot + schedule;
+}
+
+bool flash_budget_check()
+{
+    size_t stores = flash_budget_bytes();
+    size_t total = LittleFS.totalBytes();
+    bool ok = stores + FLASH_BUDGET_RESERVE_BYTES <= total;
+    Serial.printf("[FLASH] Stores take up to %u bytes, %u reserved, partition %u bytes%s\n", (unsigned)stores,
+                  (unsigned)FLASH_BUDGET_RESERVE_BYTES, (unsigned)total,
+                  ok ? "" : ": TOO SMALL, lower the history or journal limits");
+    return ok;
+}
@@ -1,4 +1,5 @@
 #include "global.h"
+#include "rpc_pool.h"
 float glob_temperature = 0;
 float glob_humidity = 0;
 
@@ -32,4 +33,38 @@ QueueHandle_t xSensorDataQueue = xQueueCreate(5, sizeof(SensorData_t));
 SemaphoreHandle_t xLCDStateSemaphore = xSemaphoreCreateMutex();
 
 // TASK 3: Current display state
-DisplayState_t currentDisplayState = DISPLAY_STATE_NORMAL;
\ No newline at end of file
+DisplayState_t currentDisplayState = DISPLAY_STATE_NORMAL;
+
+// Distribution telemetry: per window sketches, zero-initialised = empty
+QuantileSketch_t tempWindowSketch;
+QuantileSketch_t humiWindowSketch;
+SemaphoreHandle_t xSketchMutex = xSemaphoreCreateMutex();
+
+// Write-coalescing storage layer: guards the per file append buffers
+SemaphoreHandle_t xStorageMutex = xSemaphoreCreateMutex();
+
+// Scheduler: guards the timer wheel, taken again by actions that add timers
+SemaphoreHandle_t xSchedulerMutex = xSemaphoreCreateRecursiveMutex();
+
+// Warm-restart snapshots: guards the registry and the image being saved
+SemaphoreHandle_t xSnapshotMutex = xSemaphoreCreateMutex();
+
+// Sample history: guards the segment files and the score series
+SemaphoreHandle_t xHistoryMutex = xSemaphoreCreateMutex();
+
+// History compaction: guards the minute and hour aggregate segments
+SemaphoreHandle_t xCompactionMutex = xSemaphoreCreateMutex();
+
+// DNS cache: guards the cached entries
+SemaphoreHandle_t xDnsCacheMutex = xSemaphoreCreateMutex();
+
+// RPC worker pool: request and response queues, method table and counters
+QueueHandle_t xRpcRequestQueue = xQueueCreate(RPC_QUEUE_LENGTH, sizeof(RpcRequest_t));
+QueueHandle_t xRpcResponseQueue = xQueueCreate(RPC_QUEUE_LENGTH, sizeof(RpcResponse_t));
+SemaphoreHandle_t xRpcMutex = xSemaphoreCreateMutex();
+
+// Capture: guards the triggers and the captures waiting for upload
+SemaphoreHandle_t xCaptureMutex = xSemaphoreCreateMutex();
+
+// I2C bus of the DHT20 and the LCD, one transfer or bus reset at a time
+SemaphoreHandle_t xI2CMutex = xSemaphoreCreateMutex();
\ No newline at end of file
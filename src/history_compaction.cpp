@@ -0,0 +1,540 @@
+#include "history_compaction.h"
+
+#define TIER_COUNT 2
+
+// Levels as used below: 0 is the raw history, 1 + t is tiers[t]
+#define LEVEL_COUNT (TIER_COUNT + 1)
+
+typedef struct {
+    const char *path;           // current segment
+    const char *oldPath;        // previous segment, aged
+    uint16_t seconds;
+    uint32_t segmentRecords;
+    uint32_t oldRecords;
+    uint32_t currentRecords;
+    uint32_t generation;        // rotations since boot
+
+    // Compaction of the next finer level into this tier, only touched by the compaction task
+    bool started;
+    uint32_t sourceGeneration;  // of the aged source segment the cursor is in
+    uint32_t sourceAged;        // records in that segment
+    uint32_t cursor;            // next record to read in it
+
+    // Also read by history_query(), under xCompactionMutex
+    uint32_t lastTime;          // newest source record consumed
+    HistoryAggregate_t bucket;  // interval being built, count 0 if none
+    int32_t temperatureSum;
+    uint32_t humiditySum;
+} HistoryTier_t;
+
+static HistoryTier_t tiers[TIER_COUNT] = {
+    {"/history.m1", "/history.m1o", 60, HISTORY_MINUTE_SEGMENT_RECORDS},
+    {"/history.h1", "/history.h1o", 3600, HISTORY_HOUR_SEGMENT_RECORDS},
+};
+static HistoryCompactionStats_t stats;
+
+// Compaction task only
+static HistoryAggregate_t sourceRecords[HISTORY_COMPACT_BATCH];
+static HistoryAggregate_t compacted[HISTORY_COMPACT_BATCH + 1];
+
+static uint32_t recordCount(const char *path)
+{
+    File file = LittleFS.open(path, "r");
+    if (!file)
+    {
+        return 0;
+    }
+    uint32_t count = file.size() / sizeof(HistoryAggregate_t);
+    file.close();
+    return count;
+}
+
+static size_t readRecords(const char *path, uint32_t index, HistoryAggregate_t *records, size_t count)
+{
+    File file = LittleFS.open(path, "r");
+    if (!file)
+    {
+        return 0;
+    }
+    size_t read = file.seek(index * sizeof(HistoryAggregate_t))
+                      ? file.read((uint8_t *)records, count * sizeof(HistoryAggregate_t)) / sizeof(HistoryAggregate_t)
+                      : 0;
+    file.close();
+    return read;
+}
+
+static void fromSample(const HistorySample_t *sample, HistoryAggregate_t *record)
+{
+    record->time = sample->time;
+    record->seconds = 0;
+    record->count = 1;
+    record->temperatureMin = record->temperatureMax = record->temperatureMean = sample->temperature;
+    record->humidityMin = record->humidityMax = record->humidityMean = sample->humidity;
+}
+
+static uint32_t levelCount(uint8_t level)
+{
+    if (level == 0)
+    {
+        return history_count();
+    }
+    xSemaphoreTake(xCompactionMutex, portMAX_DELAY);
+    uint32_t count = tiers[level - 1].oldRecords + tiers[level - 1].currentRecords;
+    xSemaphoreGive(xCompactionMutex);
+    return count;
+}
+
+/**
+ * @brief Reads up to max records of a level starting at index, oldest first
+ *        across both segments. Raw samples are converted to records.
+ */
+static size_t levelRead(uint8_t level, uint32_t index, HistoryAggregate_t *records, size_t max)
+{
+    size_t read = 0;
+    if (level == 0)
+    {
+        HistorySample_t samples[16];
+        while (read < max)
+        {
+            size_t n = history_read(index + read, samples, min(max - read, (size_t)16));
+            for (size_t i = 0; i < n; i++)
+            {
+                fromSample(&samples[i], &records[read + i]);
+            }
+            read += n;
+            if (n == 0)
+            {
+                break;
+            }
+        }
+        return read;
+    }
+
+    HistoryTier_t *tier = &tiers[level - 1];
+    xSemaphoreTake(xCompactionMutex, portMAX_DELAY);
+    if (index < tier->oldRecords && max > 0)
+    {
+        read = readRecords(tier->oldPath, index, records, min((size_t)(tier->oldRecords - index), max));
+    }
+    if (read < max && index + read >= tier->oldRecords && index + read < tier->oldRecords + tier->currentRecords)
+    {
+        uint32_t first = index + read - tier->oldRecords;
+        read += readRecords(tier->path, first, records + read, min((size_t)(tier->currentRecords - first), max - read));
+    }
+    xSemaphoreGive(xCompactionMutex);
+    return read;
+}
+
+/**
+ * @brief Time of the first record at or after index with a unix time,
+ *        UINT32_MAX if a few reads find none. Only raw samples can lack one.
+ */
+static uint32_t levelTime(uint8_t level, uint32_t index, uint32_t count)
+{
+    HistoryAggregate_t records[16];
+    size_t chunk = (level == 0) ? 16 : 1;
+    for (uint8_t reads = 0; reads < 4 && index < count; reads++)
+    {
+        size_t n = levelRead(level, index, records, min((size_t)(count - index), chunk));
+        for (size_t i = 0; i < n; i++)
+        {
+            if ((records[i].time & HISTORY_TIME_UPTIME) == 0)
+            {
+                return records[i].time;
+            }
+        }
+        if (n == 0)
+        {
+            break;
+        }
+        index += n;
+    }
+    return UINT32_MAX;
+}
+
+/**
+ * @brief First index below count whose time is at least time.
+ */
+static uint32_t lowerBound(uint8_t level, uint32_t count, uint32_t time)
+{
+    uint32_t low = 0;
+    uint32_t high = count;
+    while (low < high)
+    {
+        uint32_t middle = low + (high - low) / 2;
+        if (levelTime(level, middle, count) < time)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+static int16_t divideRounded(int32_t sum, uint32_t count)
+{
+    return (sum >= 0) ? (sum + (int32_t)(count / 2)) / (int32_t)count : -((-sum + (int32_t)(count / 2)) / (int32_t)count);
+}
+
+static void addToBucket(HistoryTier_t *tier, const HistoryAggregate_t *record)
+{
+    HistoryAggregate_t *bucket = &tier->bucket;
+    if (bucket->count == 0)
+    {
+        bucket->time = record->time - record->time % tier->seconds;
+        bucket->seconds = tier->seconds;
+        bucket->temperatureMin = INT16_MAX;
+        bucket->temperatureMax = INT16_MIN;
+        bucket->humidityMin = UINT16_MAX;
+        bucket->humidityMax = 0;
+        tier->temperatureSum = 0;
+        tier->humiditySum = 0;
+    }
+    bucket->count = min((uint32_t)bucket->count + record->count, (uint32_t)UINT16_MAX);
+    bucket->temperatureMin = min(bucket->temperatureMin, record->temperatureMin);
+    bucket->temperatureMax = max(bucket->temperatureMax, record->temperatureMax);
+    bucket->humidityMin = min(bucket->humidityMin, record->humidityMin);
+    bucket->humidityMax = max(bucket->humidityMax, record->humidityMax);
+    // Weighted, an aggregate counts as many times as it has samples
+    tier->temperatureSum += (int32_t)record->temperatureMean * record->count;
+    tier->humiditySum += (uint32_t)record->humidityMean * record->count;
+}
+
+static void bucketRecord(const HistoryTier_t *tier, HistoryAggregate_t *record)
+{
+    *record = tier->bucket;
+    record->temperatureMean = divideRounded(tier->temperatureSum, tier->bucket.count);
+    record->humidityMean = (uint16_t)divideRounded((int32_t)tier->humiditySum, tier->bucket.count);
+}
+
+static void closeBucket(HistoryTier_t *tier, HistoryAggregate_t *record)
+{
+    bucketRecord(tier, record);
+    tier->bucket.count = 0;
+}
+
+/**
+ * @brief The interval a tier is still building, as a record that covers only
+ *        the source records consumed so far; the rest are still in the finer
+ *        level. Once the source rotates, the bucket is the only copy of the
+ *        consumed ones until the interval closes.
+ * @return false if the level has no open interval
+ */
+static bool openInterval(uint8_t level, HistoryAggregate_t *record)
+{
+    if (level == 0)
+    {
+        return false;
+    }
+    HistoryTier_t *tier = &tiers[level - 1];
+    xSemaphoreTake(xCompactionMutex, portMAX_DELAY);
+    bool open = tier->bucket.count > 0;
+    if (open)
+    {
+        bucketRecord(tier, record);
+        uint32_t sourceSeconds = (level == 1) ? 1 : tiers[level - 2].seconds;
+        record->seconds = tier->lastTime + sourceSeconds - tier->bucket.time;
+    }
+    xSemaphoreGive(xCompactionMutex);
+    return open;
+}
+
+/**
+ * @brief Moves the full current segment to the previous one, dropping the
+ *        oldest. Caller holds xCompactionMutex.
+ */
+static void rotateTier(HistoryTier_t *tier)
+{
+    LittleFS.remove(tier->oldPath);
+    LittleFS.rename(tier->path, tier->oldPath);
+    tier->oldRecords = tier->currentRecords;
+    tier->currentRecords = 0;
+    tier->generation++;
+}
+
+/**
+ * @brief Appends aggregates to a tier, rotating it when full. Caller holds xCompactionMutex.
+ */
+static void appendTier(HistoryTier_t *tier, const HistoryAggregate_t *records, size_t count)
+{
+    while (count > 0)
+    {
+        if (tier->currentRecords >= tier->segmentRecords)
+        {
+            rotateTier(tier);
+        }
+        size_t n = min(count, (size_t)(tier->segmentRecords - tier->currentRecords));
+        size_t length = n * sizeof(HistoryAggregate_t);
+        File file = LittleFS.open(tier->path, "a");
+        bool ok = file && file.write((const uint8_t *)records, length) == length;
+        if (file)
+        {
+            file.close();
+        }
+        if (!ok)
+        {
+            Serial.printf("HISTORY: Unable to append to %s\n", tier->path);
+            break;
+        }
+        tier->currentRecords += n;
+        stats.recordsWritten += n;
+        stats.bytesWritten += length;
+        records += n;
+        count -= n;
+    }
+}
+
+/**
+ * @brief One bounded pass compacting the aged segment of level t into tiers[t].
+ * @return true if more of it is waiting
+ */
+static bool compactTier(uint8_t t)
+{
+    HistoryTier_t *tier = &tiers[t];
+    uint32_t generation = (t == 0) ? history_generation() : tiers[t - 1].generation;
+    uint32_t aged = (t == 0) ? history_aged() : tiers[t - 1].oldRecords;
+
+    if (!tier->started || generation != tier->sourceGeneration)
+    {
+        // First pass since boot, or the source rotated: a new segment aged
+        if (tier->started)
+        {
+            // The rest of the segment the cursor was in, and any full segment
+            // that aged and was dropped between two passes
+            uint32_t sourceSegment = (t == 0) ? HISTORY_SEGMENT_RECORDS : tiers[t - 1].segmentRecords;
+            stats.lost += (tier->sourceAged - min(tier->cursor, tier->sourceAged)) +
+                          (generation - tier->sourceGeneration - 1) * sourceSegment;
+        }
+        tier->started = true;
+        tier->sourceGeneration = generation;
+        tier->sourceAged = aged;
+        tier->cursor = lowerBound(t, aged, tier->lastTime + 1);
+    }
+
+    size_t n = min((uint32_t)HISTORY_COMPACT_BATCH, aged - tier->cursor);
+    if (n == 0)
+    {
+        return false;
+    }
+    n = levelRead(t, tier->cursor, sourceRecords, n);
+    uint32_t current = (t == 0) ? history_generation() : tiers[t - 1].generation;
+    if (n == 0 || current != generation)
+    {
+        // Rotated while reading, the indices moved, start over in the next pass
+        return n > 0;
+    }
+
+    // Closed intervals reach the tier file together with the bucket update, so
+    // history_query() finds every consumed record in one or the other
+    xSemaphoreTake(xCompactionMutex, portMAX_DELAY);
+    size_t count = 0;
+    uint32_t skipped = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        const HistoryAggregate_t *record = &sourceRecords[i];
+        if (record->time & HISTORY_TIME_UPTIME)
+        {
+            skipped++;
+            continue;
+        }
+        // Compacted before a reset, or the clock stepped back
+        if (record->time <= tier->lastTime)
+        {
+            continue;
+        }
+        if (tier->bucket.count > 0 && record->time - tier->bucket.time >= tier->seconds)
+        {
+            closeBucket(tier, &compacted[count++]);
+        }
+        addToBucket(tier, record);
+        tier->lastTime = record->time;
+    }
+    tier->cursor += n;
+    if (count > 0)
+    {
+        appendTier(tier, compacted, count);
+    }
+
+    stats.passes++;
+    stats.recordsRead += n;
+    stats.bytesRead += n * ((t == 0) ? sizeof(HistorySample_t) : sizeof(HistoryAggregate_t));
+    stats.skipped += skipped;
+    xSemaphoreGive(xCompactionMutex);
+
+    if (tier->cursor >= aged)
+    {
+        Serial.printf("HISTORY: Aged segment compacted into %u s records\n", tier->seconds);
+    }
+    return tier->cursor < aged;
+}
+
+void history_compaction_begin()
+{
+    for (uint8_t t = 0; t < TIER_COUNT; t++)
+    {
+        HistoryTier_t *tier = &tiers[t];
+        xSemaphoreTake(xCompactionMutex, portMAX_DELAY);
+        tier->oldRecords = recordCount(tier->oldPath);
+        tier->currentRecords = recordCount(tier->path);
+        xSemaphoreGive(xCompactionMutex);
+
+        // Resume after the newest interval written, an open one is rebuilt
+        HistoryAggregate_t last;
+        uint32_t count = tier->oldRecords + tier->currentRecords;
+        tier->lastTime = (count > 0 && levelRead(t + 1, count - 1, &last, 1) == 1) ? last.time + tier->seconds - 1 : 0;
+        tier->bucket.count = 0;
+        tier->started = false;
+    }
+    Serial.printf("HISTORY: %lu + %lu minutes, %lu + %lu hours\n", (unsigned long)tiers[0].oldRecords,
+                  (unsigned long)tiers[0].currentRecords, (unsigned long)tiers[1].oldRecords,
+                  (unsigned long)tiers[1].currentRecords);
+}
+
+bool history_compact()
+{
+    bool more = false;
+    for (uint8_t t = 0; t < TIER_COUNT; t++)
+    {
+        more |= compactTier(t);
+    }
+    return more;
+}
+
+void history_compaction_task(void *pvParameters)
+{
+    while (1)
+    {
+        // Nothing aged waiting: check again in a minute
+        vTaskDelay(pdMS_TO_TICKS(history_compact() ? HISTORY_COMPACT_INTERVAL_MS : 60000));
+    }
+}
+
+size_t history_query(uint32_t from, uint32_t to, HistoryAggregate_t *records, size_t max)
+{
+    // Where each level starts, UINT32_MAX when empty
+    uint32_t count[LEVEL_COUNT];
+    uint32_t first[LEVEL_COUNT];
+    bool open[LEVEL_COUNT];
+    HistoryAggregate_t openRecord[LEVEL_COUNT];
+    for (uint8_t level = 0; level < LEVEL_COUNT; level++)
+    {
+        count[level] = levelCount(level);
+        open[level] = openInterval(level, &openRecord[level]);
+        first[level] = (count[level] > 0) ? levelTime(level, 0, count[level])
+                                          : (open[level] ? openRecord[level].time : UINT32_MAX);
+    }
+
+    size_t read = 0;
+    for (int level = LEVEL_COUNT - 1; level >= 0 && read < max && from <= to; level--)
+    {
+        // A level is read up to where a finer one starts
+        uint32_t end = UINT32_MAX;
+        for (int finer = 0; finer < level; finer++)
+        {
+            end = min(end, first[finer]);
+        }
+        if ((count[level] == 0 && !open[level]) || from >= end)
+        {
+            continue;
+        }
+
+        size_t levelStart = read;
+        uint32_t index = lowerBound(level, count[level], from);
+        bool done = false;
+        while (!done && read < max && index < count[level])
+        {
+            size_t n = levelRead(level, index, records + read, max - read);
+            if (n == 0)
+            {
+                break;
+            }
+            index += n;
+            size_t kept = 0;
+            for (size_t i = 0; i < n; i++)
+            {
+                const HistoryAggregate_t *record = &records[read + i];
+                if (record->time & HISTORY_TIME_UPTIME)
+                {
+                    continue;
+                }
+                if (record->time >= end || record->time > to)
+                {
+                    done = true;
+                    break;
+                }
+                if (record->time >= from)
+                {
+                    records[read + kept++] = *record;
+                }
+            }
+            read += kept;
+        }
+
+        // The open interval follows the stored ones, it may hold records the finer level dropped
+        const HistoryAggregate_t *record = &openRecord[level];
+        if (open[level] && index >= count[level] && read < max && record->time >= from && record->time < end &&
+            record->time <= to)
+        {
+            records[read++] = *record;
+        }
+
+        // The finer level continues after the last interval returned, which may overlap its start
+        if (read > levelStart)
+        {
+            const HistoryAggregate_t *last = &records[read - 1];
+            from = last->time + (last->seconds > 0 ? last->seconds : 1);
+        }
+    }
+    return read;
+}
+
+String history_query_json(JsonVariantConst params)
+{
+    uint32_t from = params["from"] | (uint32_t)0;
+    uint32_t to = params["to"] | UINT32_MAX;
+    size_t limit = min((size_t)(params["limit"] | 50), (size_t)HISTORY_MAX_QUERY_RECORDS);
+    // Called from the RPC workers, so no shared buffer
+    HistoryAggregate_t *records = (HistoryAggregate_t *)malloc(max(limit, (size_t)1) * sizeof(HistoryAggregate_t));
+    if (records == NULL)
+    {
+        return "{\"error\":\"out of memory\"}";
+    }
+
+    unsigned long start = micros();
+    size_t read = history_query(from, to, records, limit);
+    unsigned long elapsed = micros() - start;
+
+    DynamicJsonDocument response(256 + limit * 192);
+    response["query_us"] = elapsed;
+    JsonArray array = response.createNestedArray("records");
+    for (size_t i = 0; i < read; i++)
+    {
+        JsonObject record = array.createNestedObject();
+        record["t"] = records[i].time;
+        record["s"] = records[i].seconds;
+        record["n"] = records[i].count;
+        record["t_min"] = records[i].temperatureMin / 100.0f;
+        record["t_max"] = records[i].temperatureMax / 100.0f;
+        record["t_mean"] = records[i].temperatureMean / 100.0f;
+        record["h_min"] = records[i].humidityMin / 100.0f;
+        record["h_max"] = records[i].humidityMax / 100.0f;
+        record["h_mean"] = records[i].humidityMean / 100.0f;
+    }
+
+    free(records);
+
+    String payload;
+    serializeJson(response, payload);
+    return payload;
+}
+
+HistoryCompactionStats_t history_compaction_get_stats()
+{
+    xSemaphoreTake(xCompactionMutex, portMAX_DELAY);
+    HistoryCompactionStats_t copy = stats;
+    xSemaphoreGive(xCompactionMutex);
+    return copy;
+}
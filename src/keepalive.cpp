@@ -0,0 +1,194 @@
+#include "keepalive.h"
+
+#define KEEPALIVE_NAMESPACE "keepalive"
+
+typedef struct {
+    uint32_t network;   // hash of the WiFi network name
+    uint16_t safe;
+    uint16_t limit;
+} KeepaliveRecord_t;
+
+static KeepaliveRecord_t record = {0, KEEPALIVE_MIN_S, 0};
+static KeepaliveStats_t stats;
+static bool loaded = false;
+static uint16_t negotiated = KEEPALIVE_MAX_S;
+static uint16_t interval = KEEPALIVE_MIN_S;
+static uint8_t confirmations = 0;
+static uint32_t limitCheckedAt = 0;    // millis() the limit was last confirmed
+
+static uint32_t hashName(const char *name)
+{
+    uint32_t hash = 2166136261UL;
+    for (; *name != '\0'; name++)
+    {
+        hash = (hash ^ (uint8_t)*name) * 16777619UL;
+    }
+    return hash;
+}
+
+static void save()
+{
+    Preferences prefs;
+    if (!prefs.begin(KEEPALIVE_NAMESPACE, false))
+    {
+        return;
+    }
+    prefs.putBytes("path", &record, sizeof(record));
+    prefs.end();
+}
+
+/**
+ * @brief Loads the values learned on this network, a new network starts at the minimum.
+ */
+static void load(const char *network)
+{
+    uint32_t hash = hashName(network);
+    if (loaded && record.network == hash)
+    {
+        return;
+    }
+    loaded = true;
+
+    KeepaliveRecord_t stored;
+    Preferences prefs;
+    bool found = false;
+    if (prefs.begin(KEEPALIVE_NAMESPACE, true))
+    {
+        found = prefs.getBytes("path", &stored, sizeof(stored)) == sizeof(stored) && stored.network == hash;
+        prefs.end();
+    }
+    if (found)
+    {
+        record = stored;
+        record.safe = constrain(record.safe, KEEPALIVE_MIN_S, KEEPALIVE_MAX_S);
+    }
+    else
+    {
+        record = {hash, KEEPALIVE_MIN_S, 0};
+    }
+    confirmations = 0;
+    limitCheckedAt = millis();
+    Serial.printf("[KEEPALIVE] %s: safe %u s, limit %u s\n", network, record.safe, record.limit);
+}
+
+/**
+ * @brief Ping interval between probes, a margin below the safe value covers
+ *        timer jitter in the NAT.
+ */
+static uint16_t operating()
+{
+    return max((uint16_t)(record.safe - record.safe * KEEPALIVE_MARGIN_PCT / 100), (uint16_t)KEEPALIVE_MIN_S);
+}
+
+/**
+ * @brief The operating interval, or the next probe once it has been confirmed often enough.
+ */
+static uint16_t nextInterval()
+{
+    if (confirmations < KEEPALIVE_CONFIRMATIONS)
+    {
+        return operating();
+    }
+    uint32_t candidate;
+    if (record.limit == 0)
+    {
+        candidate = record.safe * 2;
+    }
+    else if (millis() - limitCheckedAt >= KEEPALIVE_REVALIDATE_S * 1000UL)
+    {
+        candidate = record.limit;
+    }
+    else
+    {
+        candidate = (record.safe + record.limit) / 2;
+        if (record.limit - record.safe <= KEEPALIVE_RESOLUTION_S)
+        {
+            return operating();
+        }
+    }
+    candidate = min(candidate, (uint32_t)min(negotiated, (uint16_t)KEEPALIVE_MAX_S));
+    return (candidate > record.safe) ? candidate : operating();
+}
+
+uint16_t keepalive_connect_value(const char *network)
+{
+    load(network);
+    // Probes never go past the known limit, the maximum leaves room to search
+    // without reconnecting while none is known
+    return (record.limit > 0) ? min(record.limit, (uint16_t)KEEPALIVE_MAX_S) : KEEPALIVE_MAX_S;
+}
+
+uint16_t keepalive_on_connect(uint16_t value)
+{
+    negotiated = (value > 0) ? value : KEEPALIVE_MAX_S;
+    confirmations = 0;
+    interval = min(operating(), negotiated);
+    return interval;
+}
+
+uint16_t keepalive_on_ping(uint32_t idleMs)
+{
+    // Pings sent for other reasons, e.g. the keep alive running out, prove nothing
+    if (idleMs + 1000 < interval * 1000UL)
+    {
+        return interval;
+    }
+
+    if (interval > record.safe)
+    {
+        Serial.printf("[KEEPALIVE] %u s idle survived\n", interval);
+        if (interval >= record.limit)
+        {
+            // Revalidation passed, the path got more tolerant
+            record.limit = 0;
+        }
+        record.safe = interval;
+        confirmations = 0;
+        save();
+    }
+    else if (confirmations < KEEPALIVE_CONFIRMATIONS)
+    {
+        confirmations++;
+    }
+
+    interval = nextInterval();
+    if (interval > record.safe)
+    {
+        stats.probes++;
+    }
+    return interval;
+}
+
+void keepalive_on_drop(bool explained)
+{
+    if (explained || !loaded)
+    {
+        return;
+    }
+    if (interval > record.safe)
+    {
+        stats.failedProbes++;
+        record.limit = interval;
+        Serial.printf("[KEEPALIVE] %u s idle failed, staying at %u s\n", interval, record.safe);
+    }
+    else
+    {
+        // The path got less tolerant, or the safe value was wrong all along
+        stats.drops++;
+        record.limit = record.safe;
+        record.safe = max((uint16_t)(record.safe / 2), (uint16_t)KEEPALIVE_MIN_S);
+        Serial.printf("[KEEPALIVE] Connection lost, shrinking to %u s\n", record.safe);
+    }
+    limitCheckedAt = millis();
+    confirmations = 0;
+    interval = operating();
+    save();
+}
+
+KeepaliveStats_t keepalive_get_stats()
+{
+    stats.interval = interval;
+    stats.safe = record.safe;
+    stats.limit = record.limit;
+    return stats;
+}
@@ -51,7 +51,7 @@ void led_blinky(void *pvParameters){
   while(1) {
     // Wait for temperature update semaphore with timeout
     // Timeout allows LED to continue blinking even if temp sensor fails
-    if (xSemaphoreTake(xTempUpdateSemaphore, pdMS_TO_TICKS(100)) == pdTRUE) {
+    if (lock_take(xTempUpdateSemaphore, pdMS_TO_TICKS(100)) == pdTRUE) {
       // Semaphore acquired - new temperature data available
       // TASK 3: Read from global only when signaled (alternative: could use queue)
       // Note: For backwards compatibility with Task 1, we still use glob_temperature
@@ -0,0 +1,92 @@
+#include "link_quality.h"
+
+// Weight of a new measurement in the smoothed values
+#define LINK_SMOOTHING 0.25f
+
+typedef struct {
+    float value;
+    bool known;     // false until the first measurement
+} Smoothed_t;
+
+static Smoothed_t rssi;
+static Smoothed_t sendMs;
+static Smoothed_t rttMs;
+static Smoothed_t failures;
+static uint8_t batch = LINK_MIN_BATCH;
+
+static void smooth(Smoothed_t *smoothed, float value)
+{
+    smoothed->value = smoothed->known ? smoothed->value + LINK_SMOOTHING * (value - smoothed->value) : value;
+    smoothed->known = true;
+}
+
+/**
+ * @brief Maps a value to 1 at good and 0 at bad, either bound may be the larger one.
+ */
+static float score(const Smoothed_t *smoothed, float good, float bad)
+{
+    if (!smoothed->known)
+    {
+        return 1.0f;
+    }
+    return constrain((smoothed->value - bad) / (good - bad), 0.0f, 1.0f);
+}
+
+void link_record_rssi(int value)
+{
+    // 0 while the station is not associated
+    if (value < 0)
+    {
+        smooth(&rssi, value);
+    }
+}
+
+void link_record_rtt(uint32_t value)
+{
+    smooth(&rttMs, value);
+}
+
+float link_quality()
+{
+    float quality = score(&rssi, LINK_RSSI_GOOD, LINK_RSSI_BAD);
+    quality = min(quality, score(&sendMs, LINK_SEND_GOOD_MS, LINK_SEND_BAD_MS));
+    quality = min(quality, score(&rttMs, LINK_RTT_GOOD_MS, LINK_RTT_BAD_MS));
+    quality = min(quality, score(&failures, 0.0f, LINK_FAILURE_BAD));
+    return quality;
+}
+
+void link_record_publish(uint32_t durationMs, bool ok)
+{
+    if (ok)
+    {
+        smooth(&sendMs, durationMs);
+    }
+    smooth(&failures, ok ? 0.0f : 1.0f);
+
+    uint8_t target = LINK_MIN_BATCH + (uint8_t)lroundf((1.0f - link_quality()) * (LINK_MAX_BATCH - LINK_MIN_BATCH));
+    if (target > batch)
+    {
+        batch = target;
+    }
+    else if (target < batch)
+    {
+        batch = max(target, (uint8_t)(batch / 2));
+    }
+}
+
+uint8_t link_batch_size()
+{
+    return batch;
+}
+
+LinkStats_t link_get_stats()
+{
+    LinkStats_t stats;
+    stats.rssi = rssi.value;
+    stats.sendMs = sendMs.value;
+    stats.rttMs = rttMs.value;
+    stats.failureRate = failures.value;
+    stats.quality = link_quality();
+    stats.batch = batch;
+    return stats;
+}
@@ -0,0 +1,518 @@
+#include "lock_profile.h"
+
+const uint32_t lockBucketUs[LOCK_BUCKETS - 1] = {10, 100, 1000, 10000, 100000, 1000000};
+
+#if LOCK_PROFILING
+
+typedef struct {
+    LockProfile_t profile;
+    TaskHandle_t holder;        // mutexes
+    int64_t heldSince;
+    TaskHandle_t lastAcquirer;
+    TaskHandle_t lastReleaser;
+    bool polling;               // signals: the consumer's waits expired since the last signal
+    int64_t pollingSince;
+} LockEntry_t;
+
+// Only added to before the tasks start, so lookups need no lock
+static LockEntry_t entries[LOCK_PROFILE_MAX_OBJECTS];
+static uint8_t entryCount = 0;
+// Guards the counters, short enough for a spinlock shared by both cores
+static portMUX_TYPE lockMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Tasks blocked in a profiled call right now, for lock_profile_waiting_on()
+typedef struct {
+    TaskHandle_t task;
+    const LockEntry_t *entry;
+} LockWait_t;
+
+static LockWait_t waits[LOCK_PROFILE_MAX_WAITS];
+
+static LockEntry_t *find(const void *handle)
+{
+    for (uint8_t i = 0; i < entryCount; i++)
+    {
+        if (entries[i].profile.handle == handle)
+        {
+            return &entries[i];
+        }
+    }
+    return NULL;
+}
+
+static void copyName(char *name, TaskHandle_t task)
+{
+    strncpy(name, task != NULL ? pcTaskGetName(task) : "-", configMAX_TASK_NAME_LEN - 1);
+    name[configMAX_TASK_NAME_LEN - 1] = '\0';
+}
+
+static void record(LockTiming_t *timing, uint32_t us, bool ok)
+{
+    uint8_t bucket = 0;
+    while (bucket < LOCK_BUCKETS - 1 && us > lockBucketUs[bucket])
+    {
+        bucket++;
+    }
+    timing->buckets[bucket]++;
+    timing->count++;
+    timing->totalUs += us;
+    timing->maxUs = max(timing->maxUs, us);
+    if (us >= LOCK_CONTENDED_US)
+    {
+        timing->contended++;
+    }
+    if (!ok)
+    {
+        timing->timeouts++;
+    }
+}
+
+/**
+ * @brief Notes that the current task may block on entry.
+ * @return Slot for endWait(), -1 if it does not block or the table is full
+ */
+static int beginWait(const LockEntry_t *entry, TickType_t ticks)
+{
+    if (ticks == 0)
+    {
+        return -1;
+    }
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    int slot = -1;
+    portENTER_CRITICAL(&lockMux);
+    for (int i = 0; i < LOCK_PROFILE_MAX_WAITS; i++)
+    {
+        if (waits[i].task == NULL)
+        {
+            waits[i].task = self;
+            waits[i].entry = entry;
+            slot = i;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&lockMux);
+    return slot;
+}
+
+/**
+ * @brief Caller holds lockMux.
+ */
+static void endWait(int slot)
+{
+    if (slot >= 0)
+    {
+        waits[slot].task = NULL;
+    }
+}
+
+/**
+ * @brief Records a take / give / send / receive of the current task, blocker
+ *        is the task it waited for. Caller holds lockMux.
+ */
+static void recordWait(LockEntry_t *entry, LockTiming_t *timing, uint32_t us, bool ok, TaskHandle_t blocker)
+{
+    LockProfile_t *profile = &entry->profile;
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    record(timing, us, ok);
+    if (us >= LOCK_CONTENDED_US && us > profile->worstWaitUs)
+    {
+        profile->worstWaitUs = us;
+        copyName(profile->worstWaiter, self);
+        copyName(profile->worstBlocker, blocker);
+    }
+    if (!ok)
+    {
+        copyName(profile->timeoutWaiter, self);
+        copyName(profile->timeoutBlocker, blocker);
+    }
+}
+
+/**
+ * @brief Records a take of a signal. A consumer polling for the next signal
+ *        is idle rather than contended: expired waits are only counted, the
+ *        time to the signal, across them, is recorded once it arrives.
+ *        Caller holds lockMux.
+ */
+static void recordSignalWait(LockEntry_t *entry, int64_t start, int64_t now, bool signalled)
+{
+    if (!entry->polling)
+    {
+        entry->polling = true;
+        entry->pollingSince = start;
+    }
+    if (!signalled)
+    {
+        entry->profile.expiredWaits++;
+        return;
+    }
+    record(&entry->profile.signal, now - entry->pollingSince, true);
+    entry->polling = false;
+}
+
+void lock_profile_register(const void *handle, const char *name, LockKind_t kind)
+{
+    if (handle == NULL || find(handle) != NULL || entryCount >= LOCK_PROFILE_MAX_OBJECTS)
+    {
+        return;
+    }
+    LockEntry_t *entry = &entries[entryCount];
+    memset(entry, 0, sizeof(*entry));
+    entry->profile.handle = handle;
+    entry->profile.name = name;
+    entry->profile.kind = kind;
+    entryCount++;
+}
+
+BaseType_t lock_take(SemaphoreHandle_t semaphore, TickType_t ticks)
+{
+    LockEntry_t *entry = find(semaphore);
+    if (entry == NULL)
+    {
+        return xSemaphoreTake(semaphore, ticks);
+    }
+    bool mutex = entry->profile.kind == LOCK_KIND_MUTEX;
+    // Whoever a wait would be on, read before blocking
+    TaskHandle_t blocker = mutex ? entry->holder : entry->lastReleaser;
+    int wait = beginWait(entry, ticks);
+
+    int64_t start = esp_timer_get_time();
+    BaseType_t result = xSemaphoreTake(semaphore, ticks);
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&lockMux);
+    endWait(wait);
+    if (entry->profile.kind == LOCK_KIND_SIGNAL)
+    {
+        recordSignalWait(entry, start, now, result == pdTRUE);
+    }
+    else
+    {
+        recordWait(entry, &entry->profile.acquire, now - start, result == pdTRUE, blocker);
+    }
+    if (result == pdTRUE)
+    {
+        entry->lastAcquirer = xTaskGetCurrentTaskHandle();
+        if (mutex)
+        {
+            entry->holder = entry->lastAcquirer;
+            entry->heldSince = now;
+        }
+    }
+    portEXIT_CRITICAL(&lockMux);
+    return result;
+}
+
+BaseType_t lock_give(SemaphoreHandle_t semaphore)
+{
+    LockEntry_t *entry = find(semaphore);
+    if (entry == NULL)
+    {
+        return xSemaphoreGive(semaphore);
+    }
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+
+    // The hold ends before the give, a waiting task may run right away
+    if (entry->profile.kind == LOCK_KIND_MUTEX)
+    {
+        int64_t now = esp_timer_get_time();
+        portENTER_CRITICAL(&lockMux);
+        if (entry->holder == self)
+        {
+            record(&entry->profile.hold, now - entry->heldSince, true);
+            entry->holder = NULL;
+        }
+        portEXIT_CRITICAL(&lockMux);
+    }
+
+    // A give never blocks, it fails when the semaphore was not taken since the last one
+    BaseType_t result = xSemaphoreGive(semaphore);
+    portENTER_CRITICAL(&lockMux);
+    recordWait(entry, &entry->profile.release, 0, result == pdTRUE, entry->lastAcquirer);
+    if (result == pdTRUE)
+    {
+        entry->lastReleaser = self;
+    }
+    portEXIT_CRITICAL(&lockMux);
+    return result;
+}
+
+BaseType_t lock_send(QueueHandle_t queue, const void *item, TickType_t ticks)
+{
+    LockEntry_t *entry = find(queue);
+    if (entry == NULL)
+    {
+        return xQueueSend(queue, item, ticks);
+    }
+    // A full queue waits for its consumer
+    TaskHandle_t blocker = entry->lastAcquirer;
+    int wait = beginWait(entry, ticks);
+
+    int64_t start = esp_timer_get_time();
+    BaseType_t result = xQueueSend(queue, item, ticks);
+    int64_t now = esp_timer_get_time();
+    UBaseType_t depth = (result == pdTRUE) ? uxQueueMessagesWaiting(queue) : 0;
+
+    portENTER_CRITICAL(&lockMux);
+    endWait(wait);
+    recordWait(entry, &entry->profile.release, now - start, result == pdTRUE, blocker);
+    if (result == pdTRUE)
+    {
+        entry->lastReleaser = xTaskGetCurrentTaskHandle();
+        entry->profile.maxDepth = max(entry->profile.maxDepth, depth);
+    }
+    portEXIT_CRITICAL(&lockMux);
+    return result;
+}
+
+BaseType_t lock_receive(QueueHandle_t queue, void *item, TickType_t ticks)
+{
+    LockEntry_t *entry = find(queue);
+    if (entry == NULL)
+    {
+        return xQueueReceive(queue, item, ticks);
+    }
+    TaskHandle_t blocker = entry->lastReleaser;
+    int wait = beginWait(entry, ticks);
+
+    int64_t start = esp_timer_get_time();
+    BaseType_t result = xQueueReceive(queue, item, ticks);
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&lockMux);
+    endWait(wait);
+    recordWait(entry, &entry->profile.acquire, now - start, result == pdTRUE, blocker);
+    if (result == pdTRUE)
+    {
+        entry->lastAcquirer = xTaskGetCurrentTaskHandle();
+    }
+    portEXIT_CRITICAL(&lockMux);
+    return result;
+}
+
+bool lock_profile_get(const void *handle, LockProfile_t *profile)
+{
+    LockEntry_t *entry = find(handle);
+    if (entry == NULL)
+    {
+        return false;
+    }
+    portENTER_CRITICAL(&lockMux);
+    *profile = entry->profile;
+    portEXIT_CRITICAL(&lockMux);
+    return true;
+}
+
+const char *lock_profile_waiting_on(TaskHandle_t task)
+{
+    const char *name = NULL;
+    portENTER_CRITICAL(&lockMux);
+    for (int i = 0; i < LOCK_PROFILE_MAX_WAITS; i++)
+    {
+        if (waits[i].task == task)
+        {
+            name = waits[i].entry->profile.name;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&lockMux);
+    return name;
+}
+
+static const char *kindName(LockKind_t kind)
+{
+    switch (kind)
+    {
+    case LOCK_KIND_MUTEX:
+        return "mutex";
+    case LOCK_KIND_SIGNAL:
+        return "signal";
+    default:
+        return "queue";
+    }
+}
+
+// appendHistogram() kinds
+#define KIND_BIT(kind) (1 << (kind))
+#define ALL_KINDS (KIND_BIT(LOCK_KIND_MUTEX) | KIND_BIT(LOCK_KIND_SIGNAL) | KIND_BIT(LOCK_KIND_QUEUE))
+
+static void appendHistogram(String &out, const char *metric, const char *help, const LockProfile_t *profiles,
+                            uint8_t count, size_t offset, uint8_t kinds)
+{
+    char line[160];
+    snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s histogram\n", metric, help, metric);
+    out += line;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if ((kinds & KIND_BIT(profiles[i].kind)) == 0)
+        {
+            continue;
+        }
+        const LockTiming_t *timing = (const LockTiming_t *)((const uint8_t *)&profiles[i] + offset);
+        uint32_t cumulative = 0;
+        for (uint8_t b = 0; b < LOCK_BUCKETS; b++)
+        {
+            cumulative += timing->buckets[b];
+            if (b < LOCK_BUCKETS - 1)
+            {
+                snprintf(line, sizeof(line), "%s_bucket{lock=\"%s\",le=\"%g\"} %lu\n", metric, profiles[i].name,
+                         lockBucketUs[b] / 1e6, (unsigned long)cumulative);
+            }
+            else
+            {
+                snprintf(line, sizeof(line), "%s_bucket{lock=\"%s\",le=\"+Inf\"} %lu\n", metric, profiles[i].name,
+                         (unsigned long)cumulative);
+            }
+            out += line;
+        }
+        snprintf(line, sizeof(line), "%s_sum{lock=\"%s\"} %.6f\n%s_count{lock=\"%s\"} %lu\n", metric, profiles[i].name,
+                 timing->totalUs / 1e6, metric, profiles[i].name, (unsigned long)timing->count);
+        out += line;
+    }
+}
+
+String lock_profile_metrics()
+{
+    // Copied out first, rendering allocates
+    uint8_t count = entryCount;
+    LockProfile_t *profiles = (LockProfile_t *)malloc(max(count, (uint8_t)1) * sizeof(LockProfile_t));
+    if (profiles == NULL)
+    {
+        return "# out of memory\n";
+    }
+    portENTER_CRITICAL(&lockMux);
+    for (uint8_t i = 0; i < count; i++)
+    {
+        profiles[i] = entries[i].profile;
+    }
+    portEXIT_CRITICAL(&lockMux);
+
+    String out;
+    out.reserve(1024 + count * 1536);
+    appendHistogram(out, "lock_acquire_wait_seconds", "Time a take or receive blocked", profiles, count,
+                    offsetof(LockProfile_t, acquire), ALL_KINDS & ~KIND_BIT(LOCK_KIND_SIGNAL));
+    appendHistogram(out, "lock_release_wait_seconds", "Time a give or send blocked", profiles, count,
+                    offsetof(LockProfile_t, release), ALL_KINDS);
+    appendHistogram(out, "lock_hold_seconds", "Time a mutex was held", profiles, count,
+                    offsetof(LockProfile_t, hold), KIND_BIT(LOCK_KIND_MUTEX));
+    appendHistogram(out, "lock_signal_wait_seconds", "Time a consumer waited for a signal, over expired waits",
+                    profiles, count, offsetof(LockProfile_t, signal), KIND_BIT(LOCK_KIND_SIGNAL));
+
+    char line[192];
+    out += "# HELP lock_contended_total Operations blocked at least " + String(LOCK_CONTENDED_US) + " us\n"
+           "# TYPE lock_contended_total counter\n";
+    for (uint8_t i = 0; i < count; i++)
+    {
+        snprintf(line, sizeof(line), "lock_contended_total{lock=\"%s\",kind=\"%s\",op=\"acquire\"} %lu\n"
+                                     "lock_contended_total{lock=\"%s\",kind=\"%s\",op=\"release\"} %lu\n",
+                 profiles[i].name, kindName(profiles[i].kind), (unsigned long)profiles[i].acquire.contended,
+                 profiles[i].name, kindName(profiles[i].kind), (unsigned long)profiles[i].release.contended);
+        out += line;
+    }
+    out += "# HELP lock_timeouts_total Takes, receives and sends that timed out, gives that failed\n"
+           "# TYPE lock_timeouts_total counter\n";
+    for (uint8_t i = 0; i < count; i++)
+    {
+        snprintf(line, sizeof(line), "lock_timeouts_total{lock=\"%s\",op=\"acquire\"} %lu\n"
+                                     "lock_timeouts_total{lock=\"%s\",op=\"release\"} %lu\n",
+                 profiles[i].name, (unsigned long)profiles[i].acquire.timeouts,
+                 profiles[i].name, (unsigned long)profiles[i].release.timeouts);
+        out += line;
+    }
+    out += "# HELP lock_signal_expired_total Waits for a signal that expired before the give, not timeouts\n"
+           "# TYPE lock_signal_expired_total counter\n";
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (profiles[i].kind == LOCK_KIND_SIGNAL)
+        {
+            snprintf(line, sizeof(line), "lock_signal_expired_total{lock=\"%s\"} %lu\n", profiles[i].name,
+                     (unsigned long)profiles[i].expiredWaits);
+            out += line;
+        }
+    }
+    out += "# HELP lock_max_seconds Longest wait or hold\n# TYPE lock_max_seconds gauge\n";
+    for (uint8_t i = 0; i < count; i++)
+    {
+        snprintf(line, sizeof(line), "lock_max_seconds{lock=\"%s\",op=\"acquire\"} %.6f\n"
+                                     "lock_max_seconds{lock=\"%s\",op=\"release\"} %.6f\n",
+                 profiles[i].name, profiles[i].acquire.maxUs / 1e6, profiles[i].name, profiles[i].release.maxUs / 1e6);
+        out += line;
+        if (profiles[i].kind == LOCK_KIND_MUTEX)
+        {
+            snprintf(line, sizeof(line), "lock_max_seconds{lock=\"%s\",op=\"hold\"} %.6f\n", profiles[i].name,
+                     profiles[i].hold.maxUs / 1e6);
+            out += line;
+        }
+    }
+    out += "# HELP lock_queue_max_depth Most items waiting in a queue after a send\n# TYPE lock_queue_max_depth gauge\n";
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (profiles[i].kind == LOCK_KIND_QUEUE)
+        {
+            snprintf(line, sizeof(line), "lock_queue_max_depth{lock=\"%s\"} %u\n", profiles[i].name,
+                     (unsigned)profiles[i].maxDepth);
+            out += line;
+        }
+    }
+    out += "# HELP lock_worst_wait_seconds Longest contended wait, the task waiting and the task it waited for\n"
+           "# TYPE lock_worst_wait_seconds gauge\n";
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (profiles[i].worstWaitUs > 0)
+        {
+            snprintf(line, sizeof(line), "lock_worst_wait_seconds{lock=\"%s\",waiter=\"%s\",blocker=\"%s\"} %.6f\n",
+                     profiles[i].name, profiles[i].worstWaiter, profiles[i].worstBlocker, profiles[i].worstWaitUs / 1e6);
+            out += line;
+        }
+    }
+    out += "# HELP lock_last_timeout_info Task of the last timeout and the task it waited for\n"
+           "# TYPE lock_last_timeout_info gauge\n";
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (profiles[i].acquire.timeouts + profiles[i].release.timeouts > 0)
+        {
+            snprintf(line, sizeof(line), "lock_last_timeout_info{lock=\"%s\",waiter=\"%s\",blocker=\"%s\"} 1\n",
+                     profiles[i].name, profiles[i].timeoutWaiter, profiles[i].timeoutBlocker);
+            out += line;
+        }
+    }
+
+    free(profiles);
+    return out;
+}
+
+#endif
+
+void lock_profile_benchmark()
+{
+    const int rounds = 10000;
+    SemaphoreHandle_t mutex = xSemaphoreCreateMutex();
+
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < rounds; i++)
+    {
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        xSemaphoreGive(mutex);
+    }
+    float plainUs = (esp_timer_get_time() - start) / (float)rounds;
+
+#if LOCK_PROFILING
+    // Registered only for the measurement, at boot nothing else is running yet
+    lock_profile_register(mutex, "benchmark", LOCK_KIND_MUTEX);
+    start = esp_timer_get_time();
+    for (int i = 0; i < rounds; i++)
+    {
+        lock_take(mutex, portMAX_DELAY);
+        lock_give(mutex);
+    }
+    float profiledUs = (esp_timer_get_time() - start) / (float)rounds;
+    if (entryCount > 0 && entries[entryCount - 1].profile.handle == mutex)
+    {
+        entryCount--;
+    }
+    Serial.printf("[LOCK] take + give: %.2f us plain, %.2f us profiled (+%.2f us)\n", plainUs, profiledUs,
+                  profiledUs - plainUs);
+#else
+    Serial.printf("[LOCK] take + give: %.2f us, profiling compiled out\n", plainUs);
+#endif
+    vSemaphoreDelete(mutex);
+}
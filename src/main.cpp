@@ -14,6 +14,25 @@
 #include "task_webserver.h"
 #include "task_core_iot.h"
 #include "task_lcd_display.h"  // TASK 3: LCD Display with state management
+#include "storage.h"
+#include "event_journal.h"
+#include "scheduler.h"
+#include "snapshot.h"
+#include "sample_history.h"
+#include "history_compaction.h"
+#include "flash_budget.h"
+#include "dns_cache.h"
+#include "rpc_pool.h"
+#include "capture.h"
+#include "executor.h"
+#include "stall_detector.h"
+#include "canary.h"
+#include "peer_ota.h"
+
+// loop() passes take milliseconds, unless it waits for WiFi in startSTA()
+#ifndef LOOP_STALL_MS
+#define LOOP_STALL_MS 60000
+#endif
 
 void setup()
 {
@@ -30,6 +49,79 @@ void setup()
   Serial.println();
   
   check_info_File(0);
+  // Every store at its limits has to fit the LittleFS partition mounted above
+  flash_budget_check();
+
+#if STORAGE_BENCHMARK
+  storage_benchmark();
+#endif
+#if JOURNAL_BENCHMARK
+  journal_benchmark();
+#endif
+#if TIMER_WHEEL_BENCHMARK
+  scheduler_benchmark();
+#endif
+#if LOCK_PROFILE_BENCHMARK
+  lock_profile_benchmark();
+#endif
+
+  // Waits on the objects shared by the sensor pipeline, served on /metrics
+  lock_profile_register(xTempUpdateSemaphore, "temp_update", LOCK_KIND_SIGNAL);
+  lock_profile_register(xHumidityUpdateSemaphore, "humidity_update", LOCK_KIND_SIGNAL);
+  lock_profile_register(xSensorDataQueue, "sensor_data", LOCK_KIND_QUEUE);
+  lock_profile_register(xLCDStateSemaphore, "lcd_state", LOCK_KIND_MUTEX);
+  lock_profile_register(xI2CMutex, "i2c_bus", LOCK_KIND_MUTEX);
+
+  // Before any task registers its state, so they all restore from the same image
+  snapshot_begin();
+
+  stall_begin();
+  // May roll back to the previous image right away, after a crash loop of a new one
+  canary_begin();
+  peer_ota_begin();
+  journal_begin(&eventJournal, "events");
+  journal_log(EVENT_BOOT, esp_reset_reason());
+  history_begin();
+  history_compaction_begin();
+  scheduler_begin();
+  dns_cache_begin();
+  capture_begin();
+  executor_begin();
+
+  // One deferred-work executor per core, jobs are stolen by whichever core is idle
+  for (int i = 0; i < EXECUTOR_WORKERS; i++)
+  {
+    char name[20];
+    snprintf(name, sizeof(name), "Task Executor %d", i);
+    xTaskCreatePinnedToCore(executor_worker_task, name, 4096, (void *)(intptr_t)i, EXECUTOR_TASK_PRIORITY, NULL,
+                            i % portNUM_PROCESSORS);
+  }
+#if EXECUTOR_BENCHMARK
+  executor_benchmark();
+#endif
+
+  // Above every application task, records the backtrace of a task past its heartbeat deadline
+  xTaskCreate(stall_monitor_task, "Task Stall Monitor", 3072, NULL, STALL_MONITOR_PRIORITY, NULL);
+  // loop() runs in this task, it hangs in startSTA() while WiFi does not come up
+  stall_register(LOOP_STALL_MS);
+
+  // Validation window of a new image, rolls it back on a performance regression
+  xTaskCreate(canary_task, "Task Canary", 3072, NULL, 1, NULL);
+
+  // Fetches announced firmware from the peers of the site, or from the cloud for them
+  xTaskCreate(peer_ota_task, "Task Peer OTA", 6144, NULL, 1, NULL);
+
+  // Applies the time based sync policies of the LittleFS append buffers
+  xTaskCreate(storage_task, "Task Storage", 3072, NULL, 1, NULL);
+
+  // Single dispatcher for every timed action and calendar entry
+  xTaskCreate(scheduler_task, "Task Scheduler", 3072, NULL, 2, NULL);
+
+  // Periodic RTC and flash copies of the registered warm-restart state
+  xTaskCreate(snapshot_task, "Task Snapshot", 3072, NULL, 1, NULL);
+
+  // Compacts aged raw history into minute and hour aggregates, in bounded passes
+  xTaskCreate(history_compaction_task, "Task History Compaction", 3072, NULL, 1, NULL);
 
   // TASK 1: Temperature-responsive LED blink
   xTaskCreate(led_blinky, "Task LED Blink", 2048, NULL, 2, NULL);
@@ -37,8 +129,9 @@ void setup()
   // TASK 2: Humidity-responsive NeoPixel colors
   xTaskCreate(neo_blinky, "Task NEO Blink", 2048, NULL, 2, NULL);
   
-  // Sensor monitoring task (provides data to all consumer tasks)
-  xTaskCreate(temp_humi_monitor, "Task TEMP HUMI Monitor", 2048, NULL, 2, NULL);
+  // Sensor monitoring task (provides data to all consumer tasks), hands the
+  // finished captures to the executor for the LittleFS write
+  xTaskCreate(temp_humi_monitor, "Task TEMP HUMI Monitor", 4096, NULL, 2, NULL);
   
   // TASK 3: LCD Display with state management
   xTaskCreate(lcd_display_task, "Task LCD Display", 3072, NULL, 2, NULL);
@@ -46,7 +139,16 @@ void setup()
   // Other tasks
   // xTaskCreate(main_server_task, "Task Main Server" ,8192  ,NULL  ,2 , NULL);
   // xTaskCreate( tiny_ml_task, "Tiny ML Task" ,2048  ,NULL  ,2 , NULL);
-  xTaskCreate(coreiot_task, "CoreIOT Task" ,4096  ,NULL  ,2 , NULL);
+  // The MQTT callback parses the fw_* attributes on this stack, about 1 KB of JSON documents
+  xTaskCreate(coreiot_task, "CoreIOT Task" ,6144  ,NULL  ,2 , NULL);
+
+  // RPC handlers run below the network task, so slow ones never stall MQTT
+  for (int i = 0; i < RPC_WORKERS; i++)
+  {
+    char name[16];
+    snprintf(name, sizeof(name), "Task RPC %d", i);
+    xTaskCreate(rpc_worker_task, name, 4096, NULL, 1, NULL);
+  }
   // xTaskCreate(Task_Toogle_BOOT, "Task_Toogle_BOOT", 4096, NULL, 2, NULL);
   
   Serial.println("All tasks created successfully!");
@@ -55,6 +157,7 @@ void setup()
 
 void loop()
 {
+  stall_heartbeat();
   if (check_info_File(1))
   {
     if (!Wifi_reconnect())
@@ -76,7 +76,7 @@ void neo_blinky(void *pvParameters){
     
     while(1) {
         // Wait for humidity update semaphore with timeout
-        if (xSemaphoreTake(xHumidityUpdateSemaphore, pdMS_TO_TICKS(100)) == pdTRUE) {
+        if (lock_take(xHumidityUpdateSemaphore, pdMS_TO_TICKS(100)) == pdTRUE) {
             // Semaphore acquired - new humidity data available
             // TASK 3: Read from global only when signaled (synchronized access)
             currentHumidity = glob_humidity;
@@ -0,0 +1,981 @@
+#include "peer_ota.h"
+
+#define PEER_OTA_NAMESPACE "peer_ota"
+
+// Ranges failing in a row, on any source, before a download is given up
+#define PEER_OTA_MAX_FAILURES 10
+// Pause after a failed cloud chunk
+#define PEER_OTA_CLOUD_RETRY_MS 5000
+// First pause after a failed download, doubled for every further failure of
+// the same target
+#define PEER_OTA_RETRY_MS 60000
+#define PEER_OTA_RETRY_MAX_MS 3600000
+// Answers MDNS.queryService() returns at most, a larger site is never seen whole
+#define PEER_OTA_MDNS_RESULTS 20
+// Left for coreiot to publish UPDATING before the restart
+#define PEER_OTA_REPORT_MS 3000
+
+#define SOURCE_NONE -1
+#define SOURCE_CLOUD -2
+
+typedef struct {
+    char title[32];
+    char version[32];
+    char checksum[65];          // SHA-256, hex
+    char seeders[96];           // fw_seeders
+    uint32_t size;
+    uint32_t generation;        // changes with every new target
+} PeerOtaTarget_t;
+
+typedef struct {
+    IPAddress ip;
+    uint16_t port;
+    uint32_t rank;              // of its id for the target, lowest fetch from the cloud
+    bool ranked;                // found by mDNS, listed seeders have no id
+    bool hasImage;              // advertises the target checksum
+    bool listed;                // in fw_seeders
+    bool failed;                // a range failed, skipped until PEER_OTA_PEER_BACKOFF_MS after failedAt
+    uint32_t failedAt;
+} Peer_t;
+
+static PeerOtaTarget_t target;
+static bool targetValid = false;
+static uint32_t generation = 0;
+static TaskHandle_t otaTask = NULL;
+
+// Verified image served to the peers, read by the AsyncTCP task
+static const esp_partition_t *servePartition = NULL;
+static uint32_t serveSize = 0;
+static char serveChecksum[65];
+static uint32_t serveGeneration = 0;
+static volatile uint8_t activeServes = 0;
+
+static Peer_t peers[PEER_OTA_MAX_PEERS];
+static uint8_t peerCount = 0;
+static uint32_t discoveredAt = 0;
+static bool discovered = false;
+static bool seedersListed = false;  // fw_seeders is set, it decides who fetches from the cloud
+static bool selfListed = false;
+static bool siteComplete = false;   // every device of the site answered the last query
+
+// Back-off of the target whose download failed last
+static uint32_t retryGeneration = 0;
+static uint32_t retryAt = 0;
+static uint32_t retryMs = 0;
+
+static bool mdnsStarted = false;
+static char ownId[13];
+static char rejected[65];           // applied but rolled back, never downloaded again
+
+static char fwState[16];
+static char fwError[48];
+static bool statePending = true;    // current_fw_* once per boot
+static PeerOtaStats_t stats;
+
+// Guards the target, the served image and the fw_state
+static portMUX_TYPE peerOtaMux = portMUX_INITIALIZER_UNLOCKED;
+
+static void setState(const char *state, const char *error = NULL)
+{
+    portENTER_CRITICAL(&peerOtaMux);
+    strncpy(fwState, state, sizeof(fwState) - 1);
+    strncpy(fwError, error != NULL ? error : "", sizeof(fwError) - 1);
+    statePending = true;
+    portEXIT_CRITICAL(&peerOtaMux);
+    if (error != NULL)
+    {
+        Serial.printf("[PEER_OTA] %s: %s\n", state, error);
+    }
+}
+
+void peer_ota_begin()
+{
+    Preferences prefs;
+    if (!prefs.begin(PEER_OTA_NAMESPACE, false))
+    {
+        return;
+    }
+    char applied[65] = "";
+    char label[17] = "";
+    prefs.getString("applied", applied, sizeof(applied));
+    prefs.getString("part", label, sizeof(label));
+    prefs.getString("rejected", rejected, sizeof(rejected));
+    if (applied[0] != '\0')
+    {
+        if (strcmp(esp_ota_get_running_partition()->label, label) == 0)
+        {
+            setState("UPDATED");
+        }
+        else
+        {
+            // Rolled back, by the canary or the bootloader
+            strncpy(rejected, applied, sizeof(rejected) - 1);
+            prefs.putString("rejected", rejected);
+            setState("FAILED", "rolled back after the update");
+        }
+        prefs.remove("applied");
+        prefs.remove("part");
+    }
+    prefs.end();
+}
+
+void peer_ota_on_attributes(const uint8_t *payload, unsigned int length)
+{
+    static const char *keys[] = {"fw_title", "fw_version", "fw_checksum", "fw_checksum_algorithm", "fw_size", "fw_seeders"};
+    StaticJsonDocument<384> filter;
+    for (const char *key : keys)
+    {
+        filter[key] = true;
+        filter["shared"][key] = true;
+    }
+    StaticJsonDocument<512> doc;
+    if (deserializeJson(doc, payload, length, DeserializationOption::Filter(filter)) != DeserializationError::Ok)
+    {
+        return;
+    }
+    // An attribute request response nests the values under "shared"
+    JsonObjectConst values = doc.containsKey("shared") ? doc["shared"].as<JsonObjectConst>() : doc.as<JsonObjectConst>();
+
+    portENTER_CRITICAL(&peerOtaMux);
+    if (values.containsKey("fw_seeders"))
+    {
+        strncpy(target.seeders, values["fw_seeders"] | "", sizeof(target.seeders) - 1);
+        discovered = false;
+    }
+    portEXIT_CRITICAL(&peerOtaMux);
+
+    const char *checksum = values["fw_checksum"] | "";
+    if (!values.containsKey("fw_version") || strlen(checksum) != 64)
+    {
+        if (otaTask != NULL)
+        {
+            xTaskNotifyGive(otaTask);
+        }
+        return;
+    }
+    if (strcasecmp(values["fw_checksum_algorithm"] | "SHA256", "SHA256") != 0)
+    {
+        setState("FAILED", "checksum algorithm not supported");
+        return;
+    }
+
+    portENTER_CRITICAL(&peerOtaMux);
+    if (!targetValid || strcasecmp(target.checksum, checksum) != 0)
+    {
+        memset(target.title, 0, sizeof(target.title));
+        memset(target.version, 0, sizeof(target.version));
+        memset(target.checksum, 0, sizeof(target.checksum));
+        strncpy(target.title, values["fw_title"] | "", sizeof(target.title) - 1);
+        strncpy(target.version, values["fw_version"] | "", sizeof(target.version) - 1);
+        strncpy(target.checksum, checksum, sizeof(target.checksum) - 1);
+        target.size = values["fw_size"] | 0;
+        target.generation = ++generation;
+        targetValid = true;
+        discovered = false;
+    }
+    portEXIT_CRITICAL(&peerOtaMux);
+    if (otaTask != NULL)
+    {
+        xTaskNotifyGive(otaTask);
+    }
+}
+
+static bool copyTarget(PeerOtaTarget_t *copy)
+{
+    portENTER_CRITICAL(&peerOtaMux);
+    bool valid = targetValid;
+    *copy = target;
+    portEXIT_CRITICAL(&peerOtaMux);
+    return valid;
+}
+
+static bool targetChanged(const PeerOtaTarget_t *wanted)
+{
+    portENTER_CRITICAL(&peerOtaMux);
+    bool changed = target.generation != wanted->generation;
+    portEXIT_CRITICAL(&peerOtaMux);
+    return changed;
+}
+
+static uint32_t rankOf(const char *id, const char *checksum)
+{
+    uint32_t hash = 2166136261UL;
+    for (const char *text : {id, checksum})
+    {
+        for (; *text != '\0'; text++)
+        {
+            hash = (hash ^ (uint8_t)tolower(*text)) * 16777619UL;
+        }
+    }
+    return hash;
+}
+
+// ---------------------------------------------------------------------------
+// Serving
+
+static void advertise(const char *checksum)
+{
+    if (!mdnsStarted)
+    {
+        return;
+    }
+    char prefix[17] = "";
+    if (checksum != NULL)
+    {
+        strncpy(prefix, checksum, 16);
+    }
+    MDNS.addServiceTxt(PEER_OTA_SERVICE, "tcp", "sha", prefix);
+}
+
+static void setServing(const esp_partition_t *partition, const PeerOtaTarget_t *image)
+{
+    portENTER_CRITICAL(&peerOtaMux);
+    servePartition = partition;
+    serveSize = image->size;
+    serveGeneration = image->generation;
+    memcpy(serveChecksum, image->checksum, sizeof(serveChecksum));
+    portEXIT_CRITICAL(&peerOtaMux);
+    advertise(image->checksum);
+}
+
+/**
+ * @brief Stops serving a partition before it is overwritten. A response still
+ *        running reads the new data, the peer's hash check rejects it.
+ */
+static void stopServing(const esp_partition_t *partition)
+{
+    portENTER_CRITICAL(&peerOtaMux);
+    bool stopped = servePartition == partition;
+    if (stopped)
+    {
+        servePartition = NULL;
+    }
+    portEXIT_CRITICAL(&peerOtaMux);
+    if (stopped)
+    {
+        advertise(NULL);
+    }
+}
+
+static void handleImage(AsyncWebServerRequest *request)
+{
+    portENTER_CRITICAL(&peerOtaMux);
+    const esp_partition_t *partition = servePartition;
+    uint32_t size = serveSize;
+    char checksum[65];
+    memcpy(checksum, serveChecksum, sizeof(checksum));
+    portEXIT_CRITICAL(&peerOtaMux);
+
+    if (partition == NULL)
+    {
+        request->send(404);
+        return;
+    }
+    // Flash reads and the radio are shared with the application, and a peer
+    // refused here simply asks another one
+    if (activeServes >= PEER_OTA_MAX_SERVES)
+    {
+        stats.busyRanges++;
+        AsyncWebServerResponse *response = request->beginResponse(503);
+        response->addHeader("Retry-After", "5");
+        request->send(response);
+        return;
+    }
+
+    uint32_t start = 0;
+    uint32_t end = size - 1;
+    bool partial = request->hasHeader("Range");
+    if (partial)
+    {
+        String range = request->header("Range");
+        unsigned long first = 0;
+        unsigned long last = end;
+        int fields = sscanf(range.c_str(), "bytes=%lu-%lu", &first, &last);
+        if (fields < 1 || first > last || first >= size)
+        {
+            AsyncWebServerResponse *response = request->beginResponse(416);
+            response->addHeader("Content-Range", "bytes */" + String(size));
+            request->send(response);
+            return;
+        }
+        start = first;
+        end = min((uint32_t)last, size - 1);
+    }
+    uint32_t length = end - start + 1;
+
+    activeServes++;
+    request->onDisconnect([]()
+                          { activeServes--; });
+    AsyncWebServerResponse *response = request->beginResponse(
+        "application/octet-stream", length, [partition, start, length](uint8_t *buffer, size_t maxLen, size_t index) -> size_t
+        {
+            size_t chunk = min(maxLen, (size_t)(length - index));
+            if (esp_partition_read(partition, start + index, buffer, chunk) != ESP_OK)
+            {
+                return 0;
+            }
+            stats.servedBytes += chunk;
+            return chunk;
+        });
+    if (partial)
+    {
+        char contentRange[48];
+        snprintf(contentRange, sizeof(contentRange), "bytes %lu-%lu/%lu", (unsigned long)start, (unsigned long)end,
+                 (unsigned long)size);
+        response->setCode(206);
+        response->addHeader("Content-Range", contentRange);
+    }
+    response->addHeader("Accept-Ranges", "bytes");
+    response->addHeader("X-Fw-Checksum", checksum);
+    stats.servedRanges++;
+    request->send(response);
+}
+
+void peer_ota_register(AsyncWebServer &server)
+{
+    server.on(PEER_OTA_PATH, HTTP_GET, handleImage);
+}
+
+// ---------------------------------------------------------------------------
+// Discovery
+
+static void startMdns()
+{
+    if (mdnsStarted)
+    {
+        return;
+    }
+    String mac = WiFi.macAddress();
+    mac.replace(":", "");
+    strncpy(ownId, mac.c_str(), sizeof(ownId) - 1);
+    char host[16];
+    snprintf(host, sizeof(host), "iot-%s", ownId + 6);
+    if (!MDNS.begin(host))
+    {
+        return;
+    }
+    MDNS.addService(PEER_OTA_SERVICE, "tcp", 80);
+    MDNS.addServiceTxt(PEER_OTA_SERVICE, "tcp", "id", ownId);
+    mdnsStarted = true;
+
+    portENTER_CRITICAL(&peerOtaMux);
+    bool serving = servePartition != NULL;
+    char checksum[65];
+    memcpy(checksum, serveChecksum, sizeof(checksum));
+    portEXIT_CRITICAL(&peerOtaMux);
+    advertise(serving ? checksum : NULL);
+}
+
+static Peer_t *findPeer(Peer_t *list, uint8_t count, IPAddress ip)
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (list[i].ip == ip)
+        {
+            return &list[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Rebuilds the peer list from fw_seeders and an mDNS query, keeping
+ *        the back-off of peers that failed before.
+ */
+static void discover(const PeerOtaTarget_t *wanted)
+{
+    Peer_t found[PEER_OTA_MAX_PEERS];
+    uint8_t count = 0;
+    IPAddress self = WiFi.localIP();
+
+    char list[sizeof(wanted->seeders)];
+    memcpy(list, wanted->seeders, sizeof(list));
+    seedersListed = false;
+    selfListed = false;
+    char *saveptr = NULL;
+    for (char *entry = strtok_r(list, ", ", &saveptr); entry != NULL; entry = strtok_r(NULL, ", ", &saveptr))
+    {
+        char *colon = strchr(entry, ':');
+        uint16_t port = 80;
+        if (colon != NULL)
+        {
+            *colon = '\0';
+            port = atoi(colon + 1);
+        }
+        IPAddress ip;
+        if (!ip.fromString(entry))
+        {
+            continue;
+        }
+        seedersListed = true;
+        if (ip == self)
+        {
+            selfListed = true;
+        }
+        else if (count < PEER_OTA_MAX_PEERS)
+        {
+            found[count++] = {ip, port, 0, false, false, true, false, 0};
+        }
+    }
+
+    char prefix[17] = "";
+    strncpy(prefix, wanted->checksum, 16);
+    int answers = MDNS.queryService(PEER_OTA_SERVICE, "tcp");
+    bool truncated = answers >= PEER_OTA_MDNS_RESULTS;
+    for (int i = 0; i < answers; i++)
+    {
+        IPAddress ip = MDNS.IP(i);
+        if (ip == self)
+        {
+            continue;
+        }
+        Peer_t *peer = findPeer(found, count, ip);
+        if (peer == NULL)
+        {
+            if (count == PEER_OTA_MAX_PEERS)
+            {
+                truncated = true;
+                continue;
+            }
+            peer = &found[count++];
+            *peer = {ip, 80, 0, false, false, false, false, 0};
+        }
+        peer->port = MDNS.port(i);
+        peer->rank = rankOf(MDNS.txt(i, "id").c_str(), wanted->checksum);
+        peer->ranked = true;
+        peer->hasImage = MDNS.txt(i, "sha").equalsIgnoreCase(prefix);
+    }
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        Peer_t *old = findPeer(peers, peerCount, found[i].ip);
+        if (old != NULL)
+        {
+            found[i].failed = old->failed;
+            found[i].failedAt = old->failedAt;
+        }
+    }
+    memcpy(peers, found, count * sizeof(Peer_t));
+    peerCount = count;
+    siteComplete = !truncated;
+    discoveredAt = millis();
+    discovered = true;
+}
+
+/**
+ * @brief True if this device fetches the image from the cloud for the site at
+ *        once: listed in fw_seeders, or without such a list among the
+ *        PEER_OTA_SEEDERS lowest ranks of the devices that lack the image.
+ *        Ranks are only compared when the last query saw the whole site, on
+ *        a partial view every device would find itself among the lowest of
+ *        its own sample.
+ */
+static bool elected(const PeerOtaTarget_t *wanted)
+{
+    if (seedersListed)
+    {
+        return selfListed;
+    }
+    if (!siteComplete)
+    {
+        return false;
+    }
+    uint32_t own = rankOf(ownId, wanted->checksum);
+    uint8_t lower = 0;
+    for (uint8_t i = 0; i < peerCount; i++)
+    {
+        if (peers[i].ranked && !peers[i].hasImage && peers[i].rank < own)
+        {
+            lower++;
+        }
+    }
+    return lower < PEER_OTA_SEEDERS;
+}
+
+/**
+ * @brief How long an unelected device waits for a peer before it goes to the
+ *        cloud itself. On a site too large to rank, spread over
+ *        PEER_OTA_CLOUD_FALLBACK_MS by rank: the lowest ranks go first and
+ *        the rest find them as peers.
+ */
+static uint32_t fallbackMs(const PeerOtaTarget_t *wanted)
+{
+    if (seedersListed || siteComplete)
+    {
+        return PEER_OTA_CLOUD_FALLBACK_MS;
+    }
+    return ((uint64_t)PEER_OTA_CLOUD_FALLBACK_MS * rankOf(ownId, wanted->checksum)) >> 32;
+}
+
+/**
+ * @brief A random peer offering the image, the cloud if there is none and
+ *        this device is elected or waited long enough, or SOURCE_NONE.
+ */
+static int pickSource(const PeerOtaTarget_t *wanted, uint32_t waitingSince)
+{
+    for (int pass = 0; pass < 2; pass++)
+    {
+        int candidates[PEER_OTA_MAX_PEERS];
+        int count = 0;
+        for (uint8_t i = 0; i < peerCount; i++)
+        {
+            bool backedOff = peers[i].failed && millis() - peers[i].failedAt < PEER_OTA_PEER_BACKOFF_MS;
+            if ((peers[i].hasImage || peers[i].listed) && !backedOff)
+            {
+                candidates[count++] = i;
+            }
+        }
+        if (count > 0)
+        {
+            return candidates[random(count)];
+        }
+        if (discovered && millis() - discoveredAt < PEER_OTA_DISCOVERY_MS)
+        {
+            break;
+        }
+        discover(wanted);
+    }
+    if (elected(wanted) || millis() - waitingSince >= fallbackMs(wanted))
+    {
+        return SOURCE_CLOUD;
+    }
+    return SOURCE_NONE;
+}
+
+// ---------------------------------------------------------------------------
+// Download
+
+/**
+ * @brief GETs exactly length bytes into buffer.
+ * @param range Range header, a 206 is expected with it
+ * @param checksum If set, the X-Fw-Checksum the peer has to serve
+ */
+static bool fetch(const String &url, const char *range, const char *checksum, uint8_t *buffer, size_t length)
+{
+    HTTPClient http;
+    http.setConnectTimeout(PEER_OTA_TIMEOUT_MS);
+    http.setTimeout(PEER_OTA_TIMEOUT_MS);
+    if (!http.begin(url))
+    {
+        return false;
+    }
+    const char *headers[] = {"X-Fw-Checksum"};
+    http.collectHeaders(headers, 1);
+    if (range != NULL)
+    {
+        http.addHeader("Range", range);
+    }
+    int code = http.GET();
+    bool ok = code == (range != NULL ? 206 : 200) && http.getSize() == (int)length;
+    if (ok && checksum != NULL)
+    {
+        ok = http.header("X-Fw-Checksum").equalsIgnoreCase(checksum);
+    }
+    if (ok)
+    {
+        WiFiClient *stream = http.getStreamPtr();
+        size_t received = 0;
+        unsigned long start = millis();
+        while (received < length && millis() - start < PEER_OTA_TIMEOUT_MS)
+        {
+            size_t read = stream->readBytes(buffer + received, length - received);
+            received += read;
+            if (read == 0 && !stream->connected())
+            {
+                break;
+            }
+        }
+        ok = received == length;
+    }
+    http.end();
+    return ok;
+}
+
+/**
+ * @brief One chunk of the ThingsBoard HTTP firmware API, chunks are numbered
+ *        in units of PEER_OTA_CHUNK.
+ */
+static bool fetchCloud(const PeerOtaTarget_t *wanted, uint32_t offset, uint8_t *buffer, size_t length)
+{
+    String url = "http://" + CORE_IOT_SERVER + ":" + String(PEER_OTA_CLOUD_PORT) + "/api/v1/" + CORE_IOT_TOKEN +
+                 "/firmware?title=" + wanted->title + "&version=" + wanted->version +
+                 "&size=" + String(PEER_OTA_CHUNK) + "&chunk=" + String(offset / PEER_OTA_CHUNK);
+    return fetch(url, NULL, NULL, buffer, length);
+}
+
+static bool fetchPeer(const Peer_t *peer, const PeerOtaTarget_t *wanted, uint32_t offset, uint8_t *buffer, size_t length)
+{
+    String url = "http://" + peer->ip.toString() + ":" + String(peer->port) + PEER_OTA_PATH;
+    char range[32];
+    snprintf(range, sizeof(range), "bytes=%lu-%lu", (unsigned long)offset, (unsigned long)(offset + length - 1));
+    return fetch(url, range, wanted->checksum, buffer, length);
+}
+
+static void digestHex(const uint8_t *digest, char *hex)
+{
+    for (int i = 0; i < 32; i++)
+    {
+        sprintf(hex + i * 2, "%02x", digest[i]);
+    }
+}
+
+/**
+ * @brief Hashes the first size bytes of a partition, true if they are the target.
+ */
+static bool partitionHolds(const esp_partition_t *partition, const PeerOtaTarget_t *wanted, uint8_t *buffer)
+{
+    if (wanted->size == 0 || wanted->size > partition->size)
+    {
+        return false;
+    }
+    mbedtls_md_context_t md;
+    mbedtls_md_init(&md);
+    mbedtls_md_setup(&md, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 0);
+    mbedtls_md_starts(&md);
+    bool ok = true;
+    for (uint32_t offset = 0; offset < wanted->size && ok; offset += PEER_OTA_CHUNK)
+    {
+        size_t length = min((uint32_t)PEER_OTA_CHUNK, wanted->size - offset);
+        ok = esp_partition_read(partition, offset, buffer, length) == ESP_OK;
+        mbedtls_md_update(&md, buffer, length);
+    }
+    uint8_t digest[32];
+    char hex[65];
+    mbedtls_md_finish(&md, digest);
+    mbedtls_md_free(&md);
+    digestHex(digest, hex);
+    return ok && strcasecmp(hex, wanted->checksum) == 0;
+}
+
+/**
+ * @brief Serves the partition if it holds the target, hashed once per target.
+ */
+static bool serveIfHeld(const esp_partition_t *partition, const PeerOtaTarget_t *wanted)
+{
+    static const esp_partition_t *checkedPartition = NULL;
+    static uint32_t checkedGeneration = 0;
+
+    portENTER_CRITICAL(&peerOtaMux);
+    bool serving = servePartition == partition && serveGeneration == wanted->generation;
+    portEXIT_CRITICAL(&peerOtaMux);
+    if (serving)
+    {
+        return true;
+    }
+    if (checkedPartition == partition && checkedGeneration == wanted->generation)
+    {
+        return false;
+    }
+    checkedPartition = partition;
+    checkedGeneration = wanted->generation;
+
+    uint8_t *buffer = (uint8_t *)malloc(PEER_OTA_CHUNK);
+    bool held = buffer != NULL && partitionHolds(partition, wanted, buffer);
+    free(buffer);
+    if (held)
+    {
+        Serial.printf("[PEER_OTA] %s holds %s %s, serving it\n", partition->label, wanted->title, wanted->version);
+        setServing(partition, wanted);
+    }
+    return held;
+}
+
+static int findPeerIp(const IPAddress *list, uint8_t count, IPAddress ip)
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (list[i] == ip)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Downloads the target into partition in PEER_OTA_CHUNK ranges, each
+ *        from any source that has it, and verifies it against fw_checksum.
+ */
+static bool download(const PeerOtaTarget_t *wanted, const esp_partition_t *partition)
+{
+    stopServing(partition);
+    uint8_t *buffer = (uint8_t *)malloc(PEER_OTA_CHUNK);
+    esp_ota_handle_t handle;
+    if (buffer == NULL || esp_ota_begin(partition, wanted->size, &handle) != ESP_OK)
+    {
+        free(buffer);
+        setState("FAILED", "cannot start the update");
+        return false;
+    }
+    mbedtls_md_context_t md;
+    mbedtls_md_init(&md);
+    mbedtls_md_setup(&md, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 0);
+    mbedtls_md_starts(&md);
+
+    Serial.printf("[PEER_OTA] Downloading %s %s, %lu bytes\n", wanted->title, wanted->version, (unsigned long)wanted->size);
+    setState("DOWNLOADING");
+    uint32_t started = millis();
+    uint32_t offset = 0;
+    // Peers that delivered a range, blamed if the hash fails. By address, a
+    // discovery while downloading rebuilds and reorders peers[]
+    IPAddress used[PEER_OTA_MAX_PEERS];
+    uint8_t usedCount = 0;
+    uint8_t failures = 0;
+    int source = SOURCE_NONE;
+    bool ok = true;
+    discovered = false;
+
+    while (offset < wanted->size)
+    {
+        if (targetChanged(wanted) || failures >= PEER_OTA_MAX_FAILURES)
+        {
+            ok = false;
+            break;
+        }
+        // Every range goes to a random peer again, spreading the load; the
+        // cloud is kept once chosen
+        if (source != SOURCE_CLOUD)
+        {
+            source = pickSource(wanted, started);
+        }
+        if (source == SOURCE_NONE || WiFi.status() != WL_CONNECTED)
+        {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(PEER_OTA_DISCOVERY_MS));
+            continue;
+        }
+
+        size_t length = min((uint32_t)PEER_OTA_CHUNK, wanted->size - offset);
+        bool fetched = source == SOURCE_CLOUD ? fetchCloud(wanted, offset, buffer, length)
+                                              : fetchPeer(&peers[source], wanted, offset, buffer, length);
+        if (!fetched)
+        {
+            failures++;
+            if (source == SOURCE_CLOUD)
+            {
+                vTaskDelay(pdMS_TO_TICKS(PEER_OTA_CLOUD_RETRY_MS));
+            }
+            else
+            {
+                peers[source].failed = true;
+                peers[source].failedAt = millis();
+                stats.peerFailures++;
+            }
+            source = SOURCE_NONE;
+            continue;
+        }
+        if (esp_ota_write(handle, buffer, length) != ESP_OK)
+        {
+            ok = false;
+            break;
+        }
+        mbedtls_md_update(&md, buffer, length);
+        offset += length;
+        failures = 0;
+        if (source == SOURCE_CLOUD)
+        {
+            stats.cloudBytes += length;
+        }
+        else
+        {
+            stats.lanBytes += length;
+            if (usedCount < PEER_OTA_MAX_PEERS && findPeerIp(used, usedCount, peers[source].ip) < 0)
+            {
+                used[usedCount++] = peers[source].ip;
+            }
+        }
+    }
+
+    uint8_t digest[32];
+    char hex[65];
+    mbedtls_md_finish(&md, digest);
+    mbedtls_md_free(&md);
+    free(buffer);
+    digestHex(digest, hex);
+
+    if (!ok)
+    {
+        esp_ota_abort(handle);
+        if (!targetChanged(wanted))
+        {
+            setState("FAILED", "download incomplete");
+        }
+        return false;
+    }
+    if (strcasecmp(hex, wanted->checksum) != 0)
+    {
+        esp_ota_abort(handle);
+        stats.hashFailures++;
+        for (uint8_t i = 0; i < peerCount; i++)
+        {
+            if (findPeerIp(used, usedCount, peers[i].ip) >= 0)
+            {
+                peers[i].failed = true;
+                peers[i].failedAt = millis();
+            }
+        }
+        if (usedCount == 0)
+        {
+            // The cloud itself serves something else, fetching it again only costs WAN
+            strncpy(rejected, wanted->checksum, sizeof(rejected) - 1);
+            setState("FAILED", "checksum mismatch from the cloud");
+            return false;
+        }
+        setState("FAILED", "checksum mismatch");
+        return false;
+    }
+    setState("DOWNLOADED");
+    if (esp_ota_end(handle) != ESP_OK)
+    {
+        setState("FAILED", "invalid image");
+        return false;
+    }
+    stats.downloadMs = millis() - started;
+    Serial.printf("[PEER_OTA] Verified after %lu ms, %lu bytes from the cloud, %lu from peers\n",
+                  (unsigned long)stats.downloadMs, (unsigned long)stats.cloudBytes, (unsigned long)stats.lanBytes);
+    setServing(partition, wanted);
+    setState("VERIFIED");
+    return true;
+}
+
+/**
+ * @brief False while the target is backed off after a failed download.
+ */
+static bool retryDue(const PeerOtaTarget_t *wanted)
+{
+    return wanted->generation != retryGeneration || (int32_t)(millis() - retryAt) >= 0;
+}
+
+/**
+ * @brief Backs the target off for PEER_OTA_RETRY_MS, twice as long for every
+ *        further failure up to PEER_OTA_RETRY_MAX_MS. A new target starts over.
+ */
+static void backOff(const PeerOtaTarget_t *wanted)
+{
+    if (wanted->generation != retryGeneration)
+    {
+        retryGeneration = wanted->generation;
+        retryMs = PEER_OTA_RETRY_MS;
+    }
+    else
+    {
+        retryMs = min(retryMs * 2, (uint32_t)PEER_OTA_RETRY_MAX_MS);
+    }
+    retryAt = millis() + retryMs;
+    Serial.printf("[PEER_OTA] Retrying %s %s in %lu s\n", wanted->title, wanted->version, (unsigned long)(retryMs / 1000));
+}
+
+/**
+ * @brief Seeds the image for PEER_OTA_SEED_MS, then boots it.
+ */
+static void apply(const PeerOtaTarget_t *wanted, const esp_partition_t *partition)
+{
+    Serial.printf("[PEER_OTA] Seeding for %u s before the update\n", PEER_OTA_SEED_MS / 1000);
+    vTaskDelay(pdMS_TO_TICKS(PEER_OTA_SEED_MS));
+    if (targetChanged(wanted))
+    {
+        return;
+    }
+
+    Preferences prefs;
+    if (prefs.begin(PEER_OTA_NAMESPACE, false))
+    {
+        prefs.putString("applied", wanted->checksum);
+        prefs.putString("part", partition->label);
+        prefs.end();
+    }
+    if (esp_ota_set_boot_partition(partition) != ESP_OK)
+    {
+        setState("FAILED", "cannot select the new image");
+        return;
+    }
+    setState("UPDATING");
+    vTaskDelay(pdMS_TO_TICKS(PEER_OTA_REPORT_MS));
+    snapshot_restart();
+}
+
+void peer_ota_task(void *pvParameters)
+{
+    otaTask = xTaskGetCurrentTaskHandle();
+    while (true)
+    {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(PEER_OTA_DISCOVERY_MS));
+        if (WiFi.status() != WL_CONNECTED)
+        {
+            continue;
+        }
+        startMdns();
+
+        PeerOtaTarget_t wanted;
+        if (!copyTarget(&wanted) || strcmp(wanted.title, FIRMWARE_TITLE) != 0)
+        {
+            continue;
+        }
+        // Up to date: the running image is served once it hashes to the target
+        if (strcmp(wanted.version, FIRMWARE_VERSION) == 0)
+        {
+            serveIfHeld(esp_ota_get_running_partition(), &wanted);
+            continue;
+        }
+        if (strcasecmp(wanted.checksum, rejected) == 0 || !retryDue(&wanted))
+        {
+            continue;
+        }
+        const esp_partition_t *partition = esp_ota_get_next_update_partition(NULL);
+        if (partition == NULL || wanted.size == 0 || wanted.size > partition->size)
+        {
+            setState("FAILED", "image does not fit");
+            strncpy(rejected, wanted.checksum, sizeof(rejected) - 1);
+            continue;
+        }
+        // Downloaded before a restart, or by an earlier pass with PEER_OTA_APPLY=0
+        bool ready = serveIfHeld(partition, &wanted) || download(&wanted, partition);
+        if (!ready && !targetChanged(&wanted))
+        {
+            backOff(&wanted);
+        }
+        else if (ready && PEER_OTA_APPLY)
+        {
+            apply(&wanted, partition);
+        }
+    }
+}
+
+bool peer_ota_take_state(String &payload)
+{
+    char state[sizeof(fwState)];
+    char error[sizeof(fwError)];
+    portENTER_CRITICAL(&peerOtaMux);
+    bool pending = statePending;
+    statePending = false;
+    memcpy(state, fwState, sizeof(state));
+    memcpy(error, fwError, sizeof(error));
+    portEXIT_CRITICAL(&peerOtaMux);
+    if (!pending)
+    {
+        return false;
+    }
+
+    StaticJsonDocument<384> doc;
+    doc["current_fw_title"] = FIRMWARE_TITLE;
+    doc["current_fw_version"] = FIRMWARE_VERSION;
+    if (state[0] != '\0')
+    {
+        doc["fw_state"] = state;
+    }
+    if (error[0] != '\0')
+    {
+        doc["fw_error"] = error;
+    }
+    doc["fw_cloud_bytes"] = stats.cloudBytes;
+    doc["fw_lan_bytes"] = stats.lanBytes;
+    doc["fw_served_bytes"] = stats.servedBytes;
+    doc["fw_download_ms"] = stats.downloadMs;
+    payload = "";
+    serializeJson(doc, payload);
+    return true;
+}
+
+PeerOtaStats_t peer_ota_get_stats()
+{
+    return stats;
+}
@@ -0,0 +1,300 @@
+#include "quantile_sketch.h"
+
+namespace
+{
+    const float kGamma = (1.0f + QUANTILE_SKETCH_ALPHA) / (1.0f - QUANTILE_SKETCH_ALPHA);
+    const float kInvLogGamma = 1.0f / logf(kGamma);
+
+    int32_t valueToIndex(float value)
+    {
+        return (int32_t)ceilf(logf(value) * kInvLogGamma);
+    }
+
+    // Midpoint of the bin, within QUANTILE_SKETCH_ALPHA of every value in it
+    float indexToValue(int32_t index)
+    {
+        return 2.0f * powf(kGamma, (float)index) / (kGamma + 1.0f);
+    }
+
+    // Sum of the bins [first, last] of the store
+    uint32_t storeMass(const SketchStore_t *store, int first, int last)
+    {
+        uint32_t mass = 0;
+        for (int i = first; i <= last; i++)
+        {
+            mass += store->bins[i];
+        }
+        return mass;
+    }
+
+    /**
+     * Moves the window by shift bins (positive: up, negative: down), the bins
+     * falling off the far end are collapsed into the new edge bin there.
+     */
+    void storeSlide(SketchStore_t *store, int32_t shift)
+    {
+        const int32_t n = QUANTILE_SKETCH_BINS;
+        const int32_t distance = abs(shift);
+        if (distance >= n)
+        {
+            uint32_t total = storeMass(store, 0, n - 1);
+            memset(store->bins, 0, sizeof(store->bins));
+            store->bins[shift > 0 ? 0 : n - 1] = total;
+        }
+        else if (shift > 0)
+        {
+            uint32_t collapsed = storeMass(store, 0, distance);
+            memmove(&store->bins[1], &store->bins[distance + 1], (n - distance - 1) * sizeof(uint32_t));
+            memset(&store->bins[n - distance], 0, distance * sizeof(uint32_t));
+            store->bins[0] = collapsed;
+        }
+        else
+        {
+            uint32_t collapsed = storeMass(store, n - 1 - distance, n - 1);
+            memmove(&store->bins[distance], &store->bins[0], (n - distance - 1) * sizeof(uint32_t));
+            memset(&store->bins[0], 0, distance * sizeof(uint32_t));
+            store->bins[n - 1] = collapsed;
+        }
+        store->offset += shift;
+    }
+
+    /**
+     * Counts `count` values in bin `index`. Indices outside the window move the
+     * window towards them only if the bins falling off the other end hold no
+     * more values than have already been clamped into the edge bin, otherwise
+     * the value is clamped into the edge bin. That way the window follows the
+     * bulk of the distribution while single outliers cost no accuracy, the
+     * exact min / max are tracked by the sketch anyway.
+     */
+    void storeAdd(SketchStore_t *store, int32_t index, uint32_t count)
+    {
+        const int32_t n = QUANTILE_SKETCH_BINS;
+        if (store->count == 0)
+        {
+            memset(store->bins, 0, sizeof(store->bins));
+            // Start centred, so both directions can grow without a slide
+            store->offset = index - n / 2;
+        }
+
+        int32_t slot = index - store->offset;
+        if (slot >= n)
+        {
+            int32_t shift = slot - n + 1;
+            uint32_t lost = storeMass(store, 0, min(shift, n) - 1);
+            if (lost <= store->bins[n - 1])
+            {
+                storeSlide(store, shift);
+            }
+            slot = n - 1;
+        }
+        else if (slot < 0)
+        {
+            int32_t shift = -slot;
+            uint32_t lost = storeMass(store, n - min(shift, n), n - 1);
+            if (lost <= store->bins[0])
+            {
+                storeSlide(store, -shift);
+            }
+            slot = 0;
+        }
+
+        store->bins[slot] += count;
+        store->count += count;
+    }
+
+    void storeMerge(SketchStore_t *dst, const SketchStore_t *src)
+    {
+        if (src->count == 0)
+        {
+            return;
+        }
+        // Add from the highest bin down, so the window is positioned by the first add
+        for (int i = QUANTILE_SKETCH_BINS - 1; i >= 0; i--)
+        {
+            if (src->bins[i] != 0)
+            {
+                storeAdd(dst, src->offset + i, src->bins[i]);
+            }
+        }
+    }
+
+    // Index of the bin holding the rank-th value of the store, walking up or down
+    int32_t storeIndexAtRank(const SketchStore_t *store, uint32_t rank, bool descending)
+    {
+        uint32_t seen = 0;
+        for (int i = 0; i < QUANTILE_SKETCH_BINS; i++)
+        {
+            int slot = descending ? QUANTILE_SKETCH_BINS - 1 - i : i;
+            seen += store->bins[slot];
+            if (seen > rank)
+            {
+                return store->offset + slot;
+            }
+        }
+        return store->offset + (descending ? 0 : QUANTILE_SKETCH_BINS - 1);
+    }
+
+    int storeEncode(const SketchStore_t *store, char tag, char *buffer, size_t size)
+    {
+        int written = snprintf(buffer, size, ";%c", tag);
+        if (store->count == 0 || written < 0 || (size_t)written >= size)
+        {
+            return written;
+        }
+
+        int first = 0;
+        int last = QUANTILE_SKETCH_BINS - 1;
+        while (store->bins[first] == 0)
+        {
+            first++;
+        }
+        while (store->bins[last] == 0)
+        {
+            last--;
+        }
+
+        written += snprintf(buffer + written, size - written, "%ld:", (long)(store->offset + first));
+        int run = 0;
+        for (int i = first; i <= last && (size_t)written < size; i++)
+        {
+            if (store->bins[i] == 0)
+            {
+                run++;
+                continue;
+            }
+            if (run > 0)
+            {
+                written += snprintf(buffer + written, size - written, "-%d,", run);
+                run = 0;
+            }
+            if ((size_t)written < size)
+            {
+                written += snprintf(buffer + written, size - written, "%lu,", (unsigned long)store->bins[i]);
+            }
+        }
+        // Drop the trailing separator
+        if ((size_t)written < size)
+        {
+            buffer[--written] = '\0';
+        }
+        return written;
+    }
+} // namespace
+
+void sketch_reset(QuantileSketch_t *sketch)
+{
+    memset(sketch, 0, sizeof(QuantileSketch_t));
+}
+
+void sketch_add(QuantileSketch_t *sketch, float value)
+{
+    if (isnan(value))
+    {
+        return;
+    }
+
+    if (value > QUANTILE_SKETCH_MIN_VALUE)
+    {
+        storeAdd(&sketch->positive, valueToIndex(value), 1);
+    }
+    else if (value < -QUANTILE_SKETCH_MIN_VALUE)
+    {
+        storeAdd(&sketch->negative, valueToIndex(-value), 1);
+    }
+    else
+    {
+        sketch->zeroCount++;
+    }
+
+    if (sketch->count == 0 || value < sketch->min)
+    {
+        sketch->min = value;
+    }
+    if (sketch->count == 0 || value > sketch->max)
+    {
+        sketch->max = value;
+    }
+    sketch->count++;
+    sketch->sum += value;
+}
+
+void sketch_merge(QuantileSketch_t *dst, const QuantileSketch_t *src)
+{
+    if (src->count == 0)
+    {
+        return;
+    }
+    storeMerge(&dst->positive, &src->positive);
+    storeMerge(&dst->negative, &src->negative);
+    dst->zeroCount += src->zeroCount;
+    if (dst->count == 0 || src->min < dst->min)
+    {
+        dst->min = src->min;
+    }
+    if (dst->count == 0 || src->max > dst->max)
+    {
+        dst->max = src->max;
+    }
+    dst->count += src->count;
+    dst->sum += src->sum;
+}
+
+float sketch_quantile(const QuantileSketch_t *sketch, float q)
+{
+    if (sketch->count == 0)
+    {
+        return NAN;
+    }
+    if (q <= 0.0f)
+    {
+        return sketch->min;
+    }
+    if (q >= 1.0f)
+    {
+        return sketch->max;
+    }
+
+    uint32_t rank = (uint32_t)(q * (sketch->count - 1));
+    float value;
+    if (rank < sketch->negative.count)
+    {
+        // Most negative values first, i.e. highest |x| bins first
+        value = -indexToValue(storeIndexAtRank(&sketch->negative, rank, true));
+    }
+    else if (rank < sketch->negative.count + sketch->zeroCount)
+    {
+        value = 0.0f;
+    }
+    else
+    {
+        rank -= sketch->negative.count + sketch->zeroCount;
+        value = indexToValue(storeIndexAtRank(&sketch->positive, rank, false));
+    }
+    return constrain(value, sketch->min, sketch->max);
+}
+
+size_t sketch_encode(const QuantileSketch_t *sketch, char *buffer, size_t size)
+{
+    int written = snprintf(buffer, size, "a%g", (double)QUANTILE_SKETCH_ALPHA);
+    if (written > 0 && (size_t)written < size)
+    {
+        written += storeEncode(&sketch->positive, 'p', buffer + written, size - written);
+    }
+    if (written > 0 && (size_t)written < size)
+    {
+        written += storeEncode(&sketch->negative, 'n', buffer + written, size - written);
+    }
+    if (written > 0 && (size_t)written < size)
+    {
+        written += snprintf(buffer + written, size - written, ";z%lu", (unsigned long)sketch->zeroCount);
+    }
+    if (written < 0 || (size_t)written >= size)
+    {
+        if (size > 0)
+        {
+            buffer[0] = '\0';
+        }
+        return 0;
+    }
+    return written;
+}
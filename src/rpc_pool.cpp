@@ -0,0 +1,237 @@
+#include "rpc_pool.h"
+
+#define RPC_RESPONSE_TOPIC "v1/devices/me/rpc/response/"
+
+// A worker waits this long for the network task to make room for its response
+#define RPC_RESPONSE_WAIT pdMS_TO_TICKS(1000)
+
+typedef struct {
+    char name[RPC_METHOD_LEN];
+    RpcHandler_t handler;
+    uint8_t maxConcurrent;
+    uint8_t pending;        // queued or running
+    uint32_t timeoutMs;
+    TokenBucket_t bucket;
+} RpcMethod_t;
+
+static RpcMethod_t methods[RPC_MAX_METHODS];
+static int methodCount = 0;
+static RpcStats_t stats;
+
+bool rpc_register(const char *method, RpcHandler_t handler, uint8_t maxConcurrent, uint32_t timeoutMs,
+                  float ratePerS, uint8_t burst)
+{
+    if (methodCount >= RPC_MAX_METHODS || strlen(method) >= RPC_METHOD_LEN || maxConcurrent == 0)
+    {
+        return false;
+    }
+    xSemaphoreTake(xRpcMutex, portMAX_DELAY);
+    RpcMethod_t *entry = &methods[methodCount];
+    strncpy(entry->name, method, RPC_METHOD_LEN);
+    entry->handler = handler;
+    entry->maxConcurrent = maxConcurrent;
+    entry->pending = 0;
+    entry->timeoutMs = timeoutMs;
+    bucket_init(&entry->bucket, ratePerS, burst);
+    methodCount++;
+    xSemaphoreGive(xRpcMutex);
+    return true;
+}
+
+/**
+ * @brief Queues a response for the network task and wakes it. Takes ownership of body.
+ *        Runs on the workers, which wait up to RPC_RESPONSE_WAIT for room.
+ */
+static void respond(uint32_t requestId, char *body, TaskHandle_t notify)
+{
+    if (body == NULL)
+    {
+        return;
+    }
+    RpcResponse_t response = {requestId, body};
+    if (xQueueSend(xRpcResponseQueue, &response, RPC_RESPONSE_WAIT) != pdTRUE)
+    {
+        Serial.printf("[RPC] Response %lu dropped, response queue full\n", (unsigned long)requestId);
+        free(body);
+        xSemaphoreTake(xRpcMutex, portMAX_DELAY);
+        stats.droppedResponses++;
+        xSemaphoreGive(xRpcMutex);
+        return;
+    }
+    if (notify != NULL)
+    {
+        xTaskNotifyGive(notify);
+    }
+}
+
+static void respondError(uint32_t requestId, const char *error, TaskHandle_t notify)
+{
+    char body[48];
+    snprintf(body, sizeof(body), "{\"error\":\"%s\"}", error);
+    respond(requestId, strdup(body), notify);
+}
+
+/**
+ * @brief Fills in the error response of a rejected request, published by the caller.
+ */
+static bool reject(uint32_t requestId, const char *error, String &topic, String &body)
+{
+    topic = RPC_RESPONSE_TOPIC + String(requestId);
+    body = "{\"error\":\"" + String(error) + "\"}";
+    return false;
+}
+
+bool rpc_submit(const char *topic, const uint8_t *payload, unsigned int length, String &responseTopic,
+                String &response)
+{
+    const char *id = strrchr(topic, '/');
+    uint32_t requestId = (id != NULL) ? strtoul(id + 1, NULL, 10) : 0;
+    if (length >= RPC_MAX_REQUEST_SIZE)
+    {
+        return reject(requestId, "request too large", responseTopic, response);
+    }
+
+    // Only the method name is needed here, the worker parses the parameters
+    StaticJsonDocument<32> filter;
+    filter["method"] = true;
+    StaticJsonDocument<96> doc;
+    if (deserializeJson(doc, payload, length, DeserializationOption::Filter(filter)) != DeserializationError::Ok)
+    {
+        return reject(requestId, "invalid request", responseTopic, response);
+    }
+    const char *method = doc["method"] | "";
+
+    xSemaphoreTake(xRpcMutex, portMAX_DELAY);
+    int index = -1;
+    for (int i = 0; i < methodCount; i++)
+    {
+        if (strcmp(methods[i].name, method) == 0)
+        {
+            index = i;
+            break;
+        }
+    }
+    if (index < 0)
+    {
+        xSemaphoreGive(xRpcMutex);
+        Serial.printf("[RPC] Unknown method: %s\n", method);
+        return reject(requestId, "unknown method", responseTopic, response);
+    }
+    if (!bucket_take(&methods[index].bucket, 1))
+    {
+        stats.rejectedRate++;
+        xSemaphoreGive(xRpcMutex);
+        return reject(requestId, "rate limited", responseTopic, response);
+    }
+    if (methods[index].pending >= methods[index].maxConcurrent)
+    {
+        stats.rejectedBusy++;
+        xSemaphoreGive(xRpcMutex);
+        return reject(requestId, "busy", responseTopic, response);
+    }
+
+    // Only the network task submits, the copy is kept off its stack
+    static RpcRequest_t request;
+    request.requestId = requestId;
+    request.method = index;
+    request.deadline = millis() + methods[index].timeoutMs;
+    request.notify = xTaskGetCurrentTaskHandle();
+    request.length = length;
+    memcpy(request.message, payload, length);
+    request.message[length] = '\0';
+    bool queued = xQueueSend(xRpcRequestQueue, &request, 0) == pdTRUE;
+    if (queued)
+    {
+        methods[index].pending++;
+    }
+    else
+    {
+        stats.rejectedFull++;
+    }
+    xSemaphoreGive(xRpcMutex);
+
+    if (!queued)
+    {
+        return reject(requestId, "queue full", responseTopic, response);
+    }
+    return true;
+}
+
+bool rpc_take_response(String &topic, String &body)
+{
+    RpcResponse_t response;
+    if (xQueueReceive(xRpcResponseQueue, &response, 0) != pdTRUE)
+    {
+        return false;
+    }
+    topic = RPC_RESPONSE_TOPIC + String(response.requestId);
+    body = response.body;
+    free(response.body);
+    return true;
+}
+
+RpcStats_t rpc_get_stats()
+{
+    xSemaphoreTake(xRpcMutex, portMAX_DELAY);
+    RpcStats_t copy = stats;
+    xSemaphoreGive(xRpcMutex);
+    return copy;
+}
+
+void rpc_worker_task(void *pvParameters)
+{
+    // Too big for the worker stacks, one request per worker lives on the heap
+    RpcRequest_t *request = (RpcRequest_t *)malloc(sizeof(RpcRequest_t));
+    DynamicJsonDocument *doc = new DynamicJsonDocument(RPC_MAX_REQUEST_SIZE * 2);
+
+    while (1)
+    {
+        if (xQueueReceive(xRpcRequestQueue, request, portMAX_DELAY) != pdTRUE)
+        {
+            continue;
+        }
+        RpcMethod_t *method = &methods[request->method];
+
+        char *body = NULL;
+        bool expired = (int32_t)(millis() - request->deadline) >= 0;
+        if (!expired)
+        {
+            doc->clear();
+            deserializeJson(*doc, request->message, request->length);
+            String response = method->handler((*doc)["params"]);
+            if ((int32_t)(millis() - request->deadline) >= 0)
+            {
+                Serial.printf("[RPC] %s %lu finished after its deadline, response dropped\n", method->name,
+                              (unsigned long)request->requestId);
+                xSemaphoreTake(xRpcMutex, portMAX_DELAY);
+                stats.late++;
+                xSemaphoreGive(xRpcMutex);
+            }
+            else if (response.length() > 0)
+            {
+                body = strdup(response.c_str());
+            }
+        }
+
+        xSemaphoreTake(xRpcMutex, portMAX_DELAY);
+        method->pending--;
+        if (expired)
+        {
+            stats.expired++;
+        }
+        else
+        {
+            stats.completed++;
+        }
+        xSemaphoreGive(xRpcMutex);
+
+        if (expired)
+        {
+            respondError(request->requestId, "timeout", request->notify);
+        }
+        else
+        {
+            respond(request->requestId, body, request->notify);
+        }
+    }
+}
@@ -0,0 +1,317 @@
+#include "sample_history.h"
+
+#define SAMPLES_FILE "/history.dat"
+#define SAMPLES_OLD_FILE "/history.old"
+#define SCORES_FILE "/history.scr"
+#define SCORES_OLD_FILE "/history.osc"
+
+#define SCORES_MAGIC 0x52435348 // "HSCR"
+
+typedef struct {
+    uint32_t magic;
+    uint32_t modelId;
+} ScoresHeader_t;
+
+static StorageHandle_t samplesFile = STORAGE_INVALID_HANDLE;
+static uint32_t oldRecords = 0;
+static uint32_t currentRecords = 0;
+static uint32_t oldScored = 0;
+static uint32_t currentScored = 0;
+static uint32_t scoreModel = 0;
+static uint32_t generation = 0;
+
+static size_t fileSize(const char *path)
+{
+    File file = LittleFS.open(path, "r");
+    if (!file)
+    {
+        return 0;
+    }
+    size_t size = file.size();
+    file.close();
+    return size;
+}
+
+/**
+ * @brief Reads the header of a score file.
+ * @return Number of scores, 0 if the file is missing or not a score file
+ */
+static uint32_t loadScores(const char *path, uint32_t *modelId)
+{
+    File file = LittleFS.open(path, "r");
+    if (!file)
+    {
+        return 0;
+    }
+    ScoresHeader_t header;
+    size_t size = file.size();
+    bool valid = file.read((uint8_t *)&header, sizeof(header)) == sizeof(header) && header.magic == SCORES_MAGIC;
+    file.close();
+    if (!valid)
+    {
+        return 0;
+    }
+    *modelId = header.modelId;
+    return (size - sizeof(header)) / sizeof(uint16_t);
+}
+
+static void dropScores()
+{
+    LittleFS.remove(SCORES_FILE);
+    LittleFS.remove(SCORES_OLD_FILE);
+    oldScored = 0;
+    currentScored = 0;
+}
+
+static void openSamples()
+{
+    // Samples are synced once a minute, a reset loses at most that much history
+    static const StorageSyncPolicy_t policy = {60000, 0};
+    samplesFile = storage_open(SAMPLES_FILE, &policy, 1024);
+}
+
+/**
+ * @brief Moves the full current segment to the previous one. Caller holds xHistoryMutex.
+ * @return false if the buffered samples could not be flushed, nothing is moved then
+ */
+static bool rotate()
+{
+    if (!storage_close(samplesFile))
+    {
+        return false;
+    }
+    LittleFS.remove(SAMPLES_OLD_FILE);
+    LittleFS.remove(SCORES_OLD_FILE);
+    LittleFS.rename(SAMPLES_FILE, SAMPLES_OLD_FILE);
+    LittleFS.rename(SCORES_FILE, SCORES_OLD_FILE);
+
+    oldRecords = currentRecords;
+    oldScored = currentScored;
+    currentRecords = 0;
+    currentScored = 0;
+    generation++;
+    openSamples();
+    return true;
+}
+
+bool history_begin()
+{
+    oldRecords = fileSize(SAMPLES_OLD_FILE) / sizeof(HistorySample_t);
+    currentRecords = fileSize(SAMPLES_FILE) / sizeof(HistorySample_t);
+
+    uint32_t oldModel = 0;
+    uint32_t currentModel = 0;
+    oldScored = min(loadScores(SCORES_OLD_FILE, &oldModel), oldRecords);
+    currentScored = min(loadScores(SCORES_FILE, &currentModel), currentRecords);
+    // Scores are appended in order, current ones only count after a fully scored old segment
+    if (oldScored < oldRecords || (oldScored > 0 && currentScored > 0 && oldModel != currentModel))
+    {
+        currentScored = 0;
+    }
+    scoreModel = (oldScored > 0) ? oldModel : currentModel;
+
+    openSamples();
+    if (samplesFile == STORAGE_INVALID_HANDLE)
+    {
+        Serial.println("HISTORY: Unable to open sample file");
+        return false;
+    }
+    Serial.printf("HISTORY: %lu + %lu samples, %lu scored\n", (unsigned long)oldRecords,
+                  (unsigned long)currentRecords, (unsigned long)(oldScored + currentScored));
+    return true;
+}
+
+bool history_append(float temperature, float humidity)
+{
+    HistorySample_t sample;
+    time_t now = time(nullptr);
+    // Anything before 2020 means SNTP has not set the clock yet
+    sample.time = (now > 1577836800) ? (uint32_t)now : (millis() / 1000) | HISTORY_TIME_UPTIME;
+    sample.temperature = (int16_t)constrain(lroundf(temperature * 100), -32768L, 32767L);
+    sample.humidity = (uint16_t)constrain(lroundf(humidity * 100), 0L, 65535L);
+
+    xSemaphoreTake(xHistoryMutex, portMAX_DELAY);
+    // A segment that cannot rotate does not grow past its flash budget, the sample is dropped
+    bool ok = (currentRecords < HISTORY_SEGMENT_RECORDS || rotate()) &&
+              storage_append(samplesFile, &sample, sizeof(sample));
+    if (ok)
+    {
+        currentRecords++;
+    }
+    xSemaphoreGive(xHistoryMutex);
+    return ok;
+}
+
+uint32_t history_count()
+{
+    xSemaphoreTake(xHistoryMutex, portMAX_DELAY);
+    uint32_t count = oldRecords + currentRecords;
+    xSemaphoreGive(xHistoryMutex);
+    return count;
+}
+
+uint32_t history_aged()
+{
+    xSemaphoreTake(xHistoryMutex, portMAX_DELAY);
+    uint32_t count = oldRecords;
+    xSemaphoreGive(xHistoryMutex);
+    return count;
+}
+
+uint32_t history_generation()
+{
+    return generation;
+}
+
+/**
+ * @brief Reads fixed-size items at an offset of a file, returns the number read.
+ */
+static size_t readItems(const char *path, size_t offset, void *items, size_t itemSize, size_t count)
+{
+    File file = LittleFS.open(path, "r");
+    if (!file)
+    {
+        return 0;
+    }
+    size_t read = file.seek(offset) ? file.read((uint8_t *)items, count * itemSize) / itemSize : 0;
+    file.close();
+    return read;
+}
+
+size_t history_read(uint32_t index, HistorySample_t *samples, size_t max)
+{
+    size_t read = 0;
+    xSemaphoreTake(xHistoryMutex, portMAX_DELAY);
+    if (index < oldRecords && max > 0)
+    {
+        size_t count = min((size_t)(oldRecords - index), max);
+        read = readItems(SAMPLES_OLD_FILE, index * sizeof(HistorySample_t), samples, sizeof(HistorySample_t), count);
+    }
+    if (read < max && index + read >= oldRecords && index + read < oldRecords + currentRecords)
+    {
+        // The newest samples may still sit in the append buffer
+        storage_sync(samplesFile);
+        uint32_t first = index + read - oldRecords;
+        size_t count = min((size_t)(currentRecords - first), max - read);
+        read += readItems(SAMPLES_FILE, first * sizeof(HistorySample_t), samples + read, sizeof(HistorySample_t), count);
+    }
+    xSemaphoreGive(xHistoryMutex);
+    return read;
+}
+
+uint32_t history_scored(uint32_t modelId)
+{
+    xSemaphoreTake(xHistoryMutex, portMAX_DELAY);
+    if (modelId != scoreModel)
+    {
+        dropScores();
+        scoreModel = modelId;
+    }
+    uint32_t scored = oldScored + currentScored;
+    xSemaphoreGive(xHistoryMutex);
+    return scored;
+}
+
+/**
+ * @brief Appends scores to one segment's score file, writing the header into a new file.
+ */
+static bool writeScores(const char *path, uint32_t scored, const float *scores, size_t count)
+{
+    File file = LittleFS.open(path, scored == 0 ? "w" : "a");
+    if (!file)
+    {
+        return false;
+    }
+    size_t expected = count * sizeof(uint16_t);
+    size_t written = 0;
+    if (scored == 0)
+    {
+        ScoresHeader_t header = {SCORES_MAGIC, scoreModel};
+        expected += sizeof(header);
+        written += file.write((const uint8_t *)&header, sizeof(header));
+    }
+
+    uint16_t encoded[64];
+    for (size_t i = 0; i < count; i += 64)
+    {
+        size_t n = min(count - i, (size_t)64);
+        for (size_t j = 0; j < n; j++)
+        {
+            encoded[j] = (uint16_t)lroundf(constrain(scores[i + j], 0.0f, 1.0f) * 65535);
+        }
+        written += file.write((const uint8_t *)encoded, n * sizeof(uint16_t));
+    }
+    file.close();
+    return written == expected;
+}
+
+void history_drop_scores()
+{
+    xSemaphoreTake(xHistoryMutex, portMAX_DELAY);
+    dropScores();
+    xSemaphoreGive(xHistoryMutex);
+}
+
+bool history_append_scores(uint32_t expectedGeneration, uint32_t index, const float *scores, size_t count)
+{
+    bool ok = true;
+    xSemaphoreTake(xHistoryMutex, portMAX_DELAY);
+    if (expectedGeneration != generation || index != oldScored + currentScored ||
+        index + count > oldRecords + currentRecords)
+    {
+        ok = false;
+    }
+
+    if (ok && oldScored < oldRecords)
+    {
+        size_t n = min((size_t)(oldRecords - oldScored), count);
+        ok = writeScores(SCORES_OLD_FILE, oldScored, scores, n);
+        if (ok)
+        {
+            oldScored += n;
+            scores += n;
+            count -= n;
+        }
+    }
+    if (ok && count > 0)
+    {
+        ok = writeScores(SCORES_FILE, currentScored, scores, count);
+        if (ok)
+        {
+            currentScored += count;
+        }
+    }
+    xSemaphoreGive(xHistoryMutex);
+    return ok;
+}
+
+size_t history_read_scores(uint32_t index, float *scores, size_t max)
+{
+    uint16_t encoded[64];
+    size_t read = 0;
+    xSemaphoreTake(xHistoryMutex, portMAX_DELAY);
+    while (read < max)
+    {
+        uint32_t i = index + read;
+        const char *path = (i < oldRecords) ? SCORES_OLD_FILE : SCORES_FILE;
+        uint32_t first = (i < oldRecords) ? i : i - oldRecords;
+        uint32_t available = (i < oldRecords) ? oldScored - min(first, oldScored) : currentScored - min(first, currentScored);
+        size_t count = min(min((size_t)available, max - read), (size_t)64);
+        if (count == 0)
+        {
+            break;
+        }
+        size_t n = readItems(path, sizeof(ScoresHeader_t) + first * sizeof(uint16_t), encoded, sizeof(uint16_t), count);
+        for (size_t j = 0; j < n; j++)
+        {
+            scores[read + j] = encoded[j] / 65535.0f;
+        }
+        read += n;
+        if (n < count)
+        {
+            break;
+        }
+    }
+    xSemaphoreGive(xHistoryMutex);
+    return read;
+}
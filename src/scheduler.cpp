@@ -0,0 +1,518 @@
+#include "scheduler.h"
+
+// Timer action of calendar entries, the timer argument is the entry slot
+#define CALENDAR_ACTION 0xFF
+
+// Anything before 2020 means SNTP has not set the clock yet
+#define CLOCK_VALID_AFTER 1577836800
+
+static TimerWheel_t wheel;
+static ScheduleEntry_t entries[SCHEDULER_MAX_ENTRIES];
+static TimerWheelHandle_t entryTimers[SCHEDULER_MAX_ENTRIES];
+// Unix time the entry is due, 0 while it waits for the clock or for interval entries
+static uint32_t entryDue[SCHEDULER_MAX_ENTRIES];
+static TaskHandle_t dispatcherTask = NULL;
+
+static const uint8_t gpioPins[] = SCHEDULER_GPIO_PINS;
+
+static bool gpioAllowed(int32_t param)
+{
+    for (size_t i = 0; i < sizeof(gpioPins); i++)
+    {
+        if (gpioPins[i] == (param & 0xFF))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void gpioAction(int32_t param)
+{
+    uint8_t pin = param & 0xFF;
+    if (!gpioAllowed(param))
+    {
+        Serial.printf("[SCHEDULER] GPIO %u is not in SCHEDULER_GPIO_PINS, not driven\n", pin);
+        return;
+    }
+    pinMode(pin, OUTPUT);
+    digitalWrite(pin, (param >> 8) & 0x01);
+}
+
+static ScheduleActionHandler_t handlers[SCHEDULE_ACTION_COUNT] = {NULL, gpioAction, NULL, NULL};
+
+static const char *kindNames[SCHEDULE_KIND_COUNT] = {"once", "daily", "weekly", "interval"};
+static const char *actionNames[SCHEDULE_ACTION_COUNT] = {"log", "gpio", "report", "relay"};
+
+static uint32_t currentTick()
+{
+    return (uint32_t)(esp_timer_get_time() / (1000ULL * SCHEDULER_TICK_MS));
+}
+
+static uint32_t secondsToTicks(uint32_t seconds)
+{
+    return (uint32_t)min((uint64_t)seconds * 1000 / SCHEDULER_TICK_MS, (uint64_t)TIMER_WHEEL_MAX_DELAY);
+}
+
+/**
+ * @brief Wakes the dispatcher so it recomputes how long it may sleep.
+ */
+static void wakeDispatcher()
+{
+    if (dispatcherTask != NULL && xTaskGetCurrentTaskHandle() != dispatcherTask)
+    {
+        xTaskNotifyGive(dispatcherTask);
+    }
+}
+
+/**
+ * @brief Next local time after `now` that matches a daily or weekly entry, 0 if there is none.
+ */
+static time_t nextCalendarTime(const ScheduleEntry_t *entry, time_t now)
+{
+    struct tm today;
+    localtime_r(&now, &today);
+
+    for (int day = 0; day <= 7; day++)
+    {
+        struct tm candidate = today;
+        candidate.tm_mday += day;
+        candidate.tm_hour = entry->at / 3600;
+        candidate.tm_min = (entry->at / 60) % 60;
+        candidate.tm_sec = entry->at % 60;
+        candidate.tm_isdst = -1;
+        time_t t = mktime(&candidate);
+        if (t <= now)
+        {
+            continue;
+        }
+        if (entry->kind == SCHEDULE_WEEKLY && !(entry->weekdays & (1 << candidate.tm_wday)))
+        {
+            continue;
+        }
+        return t;
+    }
+    return 0;
+}
+
+/**
+ * @brief (Re-)arms the timer of a calendar entry for its next occurrence.
+ *        Called with xSchedulerMutex held.
+ */
+static void armEntry(int slot)
+{
+    ScheduleEntry_t *entry = &entries[slot];
+    if (entryTimers[slot] != TIMER_WHEEL_INVALID_HANDLE)
+    {
+        timer_wheel_cancel(&wheel, entryTimers[slot]);
+        entryTimers[slot] = TIMER_WHEEL_INVALID_HANDLE;
+    }
+    entryDue[slot] = 0;
+    if (entry->id == 0)
+    {
+        return;
+    }
+
+    uint32_t delay;
+    if (entry->kind == SCHEDULE_INTERVAL)
+    {
+        delay = entry->at;
+    }
+    else
+    {
+        time_t now = time(nullptr);
+        if (now <= CLOCK_VALID_AFTER)
+        {
+            delay = SCHEDULER_CLOCK_RETRY_S;
+        }
+        else
+        {
+            time_t due = (entry->kind == SCHEDULE_ONCE) ? (time_t)entry->at : nextCalendarTime(entry, now);
+            if (due == 0)
+            {
+                return;
+            }
+            entryDue[slot] = (uint32_t)due;
+            delay = (due > now) ? (uint32_t)(due - now) : 0;
+        }
+    }
+    entryTimers[slot] = timer_wheel_add(&wheel, secondsToTicks(delay), CALENDAR_ACTION, slot);
+}
+
+static bool saveEntries()
+{
+    File file = LittleFS.open(SCHEDULER_FILE ".tmp", "w");
+    if (!file)
+    {
+        return false;
+    }
+    size_t expected = 0;
+    size_t written = 0;
+    for (int i = 0; i < SCHEDULER_MAX_ENTRIES; i++)
+    {
+        if (entries[i].id != 0)
+        {
+            expected += sizeof(ScheduleEntry_t);
+            written += file.write((const uint8_t *)&entries[i], sizeof(ScheduleEntry_t));
+        }
+    }
+    file.close();
+    // Replaced in one rename, a power loss never leaves a half written table
+    return written == expected && LittleFS.rename(SCHEDULER_FILE ".tmp", SCHEDULER_FILE);
+}
+
+static void loadEntries()
+{
+    File file = LittleFS.open(SCHEDULER_FILE, "r");
+    if (!file)
+    {
+        return;
+    }
+    int slot = 0;
+    ScheduleEntry_t entry;
+    while (slot < SCHEDULER_MAX_ENTRIES && file.read((uint8_t *)&entry, sizeof(entry)) == sizeof(entry))
+    {
+        if (entry.id != 0 && entry.kind < SCHEDULE_KIND_COUNT && entry.action < SCHEDULE_ACTION_COUNT)
+        {
+            entries[slot++] = entry;
+        }
+    }
+    file.close();
+    Serial.printf("[SCHEDULER] Loaded %d calendar entries\n", slot);
+}
+
+/**
+ * @brief Runs a due calendar entry and arms its next occurrence.
+ */
+static void runEntry(int slot)
+{
+    ScheduleEntry_t *entry = &entries[slot];
+    entryTimers[slot] = TIMER_WHEEL_INVALID_HANDLE;
+    if (entry->id == 0)
+    {
+        return;
+    }
+
+    time_t now = time(nullptr);
+    bool waitingForClock = entry->kind != SCHEDULE_INTERVAL && entryDue[slot] == 0;
+    bool early = entryDue[slot] != 0 && now < (time_t)entryDue[slot];
+    if (waitingForClock || early)
+    {
+        // Clock was not synced yet, or the delay was longer than the wheel holds
+        armEntry(slot);
+        return;
+    }
+
+    journal_log(EVENT_SCHEDULE, entry->id, entry->param);
+    if (handlers[entry->action] != NULL)
+    {
+        handlers[entry->action](entry->param);
+    }
+
+    if (entry->kind == SCHEDULE_ONCE)
+    {
+        entry->id = 0;
+        entryDue[slot] = 0;
+        saveEntries();
+        return;
+    }
+    armEntry(slot);
+}
+
+static void onTimer(uint8_t action, uint16_t arg)
+{
+    if (action == CALENDAR_ACTION)
+    {
+        runEntry(arg);
+    }
+    else if (action < SCHEDULE_ACTION_COUNT && handlers[action] != NULL)
+    {
+        handlers[action](arg);
+    }
+}
+
+void scheduler_begin()
+{
+    timer_wheel_init(&wheel, currentTick());
+    memset(entries, 0, sizeof(entries));
+    loadEntries();
+    for (int i = 0; i < SCHEDULER_MAX_ENTRIES; i++)
+    {
+        entryTimers[i] = TIMER_WHEEL_INVALID_HANDLE;
+        armEntry(i);
+    }
+}
+
+void scheduler_task(void *pvParameters)
+{
+    dispatcherTask = xTaskGetCurrentTaskHandle();
+
+    while (1)
+    {
+        xSemaphoreTakeRecursive(xSchedulerMutex, portMAX_DELAY);
+        timer_wheel_advance(&wheel, currentTick(), onTimer);
+        uint32_t ticks = timer_wheel_ticks_to_next(&wheel);
+        xSemaphoreGiveRecursive(xSchedulerMutex);
+
+        // Sleeps until the wheel has work, or until a timer is added
+        TickType_t wait = portMAX_DELAY;
+        if (ticks != UINT32_MAX)
+        {
+            wait = pdMS_TO_TICKS((uint64_t)ticks * SCHEDULER_TICK_MS);
+        }
+        ulTaskNotifyTake(pdTRUE, wait);
+    }
+}
+
+void scheduler_set_action(ScheduleAction_t action, ScheduleActionHandler_t handler)
+{
+    if (action < SCHEDULE_ACTION_COUNT)
+    {
+        handlers[action] = handler;
+    }
+}
+
+TimerWheelHandle_t scheduler_after(uint32_t delayMs, ScheduleAction_t action, uint16_t param)
+{
+    if (action >= SCHEDULE_ACTION_COUNT)
+    {
+        return TIMER_WHEEL_INVALID_HANDLE;
+    }
+    xSemaphoreTakeRecursive(xSchedulerMutex, portMAX_DELAY);
+    // Catch the wheel up first, the delay is relative to the current tick
+    timer_wheel_advance(&wheel, currentTick(), onTimer);
+    TimerWheelHandle_t handle = timer_wheel_add(&wheel, (delayMs + SCHEDULER_TICK_MS - 1) / SCHEDULER_TICK_MS, action, param);
+    xSemaphoreGiveRecursive(xSchedulerMutex);
+    wakeDispatcher();
+    return handle;
+}
+
+bool scheduler_cancel(TimerWheelHandle_t handle)
+{
+    xSemaphoreTakeRecursive(xSchedulerMutex, portMAX_DELAY);
+    bool cancelled = timer_wheel_cancel(&wheel, handle);
+    xSemaphoreGiveRecursive(xSchedulerMutex);
+    return cancelled;
+}
+
+uint8_t scheduler_add_entry(const ScheduleEntry_t *entry)
+{
+    if (entry->kind >= SCHEDULE_KIND_COUNT || entry->action >= SCHEDULE_ACTION_COUNT ||
+        (entry->kind == SCHEDULE_INTERVAL && entry->at == 0) ||
+        ((entry->kind == SCHEDULE_DAILY || entry->kind == SCHEDULE_WEEKLY) && entry->at >= 86400) ||
+        (entry->kind == SCHEDULE_WEEKLY && (entry->weekdays & 0x7F) == 0) ||
+        (entry->action == SCHEDULE_ACTION_GPIO && !gpioAllowed(entry->param)))
+    {
+        return 0;
+    }
+
+    xSemaphoreTakeRecursive(xSchedulerMutex, portMAX_DELAY);
+    timer_wheel_advance(&wheel, currentTick(), onTimer);
+
+    int slot = -1;
+    int freeSlot = -1;
+    bool used[256] = {false};
+    for (int i = 0; i < SCHEDULER_MAX_ENTRIES; i++)
+    {
+        used[entries[i].id] = true;
+        if (entry->id != 0 && entries[i].id == entry->id)
+        {
+            slot = i;
+        }
+        if (entries[i].id == 0 && freeSlot < 0)
+        {
+            freeSlot = i;
+        }
+    }
+    if (slot < 0)
+    {
+        slot = freeSlot;
+    }
+
+    uint8_t id = entry->id;
+    for (int candidate = 1; id == 0 && candidate < 256; candidate++)
+    {
+        if (!used[candidate])
+        {
+            id = candidate;
+        }
+    }
+
+    if (slot >= 0 && id != 0)
+    {
+        entries[slot] = *entry;
+        entries[slot].id = id;
+        armEntry(slot);
+        saveEntries();
+    }
+    else
+    {
+        id = 0;
+    }
+    xSemaphoreGiveRecursive(xSchedulerMutex);
+
+    wakeDispatcher();
+    return id;
+}
+
+bool scheduler_remove_entry(uint8_t id)
+{
+    bool removed = false;
+    xSemaphoreTakeRecursive(xSchedulerMutex, portMAX_DELAY);
+    for (int i = 0; id != 0 && i < SCHEDULER_MAX_ENTRIES; i++)
+    {
+        if (entries[i].id == id)
+        {
+            entries[i].id = 0;
+            armEntry(i);
+            removed = true;
+        }
+    }
+    if (removed)
+    {
+        saveEntries();
+    }
+    xSemaphoreGiveRecursive(xSchedulerMutex);
+    return removed;
+}
+
+static int indexOfName(const char *name, const char *const *names, int count)
+{
+    for (int i = 0; name != NULL && i < count; i++)
+    {
+        if (strcmp(name, names[i]) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool scheduler_entry_from_json(JsonVariantConst params, ScheduleEntry_t *entry)
+{
+    memset(entry, 0, sizeof(ScheduleEntry_t));
+
+    int kind = indexOfName(params["kind"], kindNames, SCHEDULE_KIND_COUNT);
+    int action = indexOfName(params["action"] | "log", actionNames, SCHEDULE_ACTION_COUNT);
+    if (kind < 0 || action < 0)
+    {
+        return false;
+    }
+    entry->id = params["id"] | 0;
+    entry->kind = kind;
+    entry->action = action;
+    entry->weekdays = params["days"] | 0x7F;
+    entry->param = params["param"] | 0;
+
+    // Time of day may be given as "HH:MM" or "HH:MM:SS"
+    const char *clock = params["at"].as<const char *>();
+    if (clock != NULL)
+    {
+        int hours = 0;
+        int minutes = 0;
+        int seconds = 0;
+        if (sscanf(clock, "%d:%d:%d", &hours, &minutes, &seconds) < 2)
+        {
+            return false;
+        }
+        entry->at = hours * 3600 + minutes * 60 + seconds;
+    }
+    else
+    {
+        entry->at = params["at"] | 0UL;
+    }
+    return true;
+}
+
+String scheduler_list_json()
+{
+    DynamicJsonDocument doc(128 + SCHEDULER_MAX_ENTRIES * JSON_OBJECT_SIZE(8));
+    JsonArray array = doc.to<JsonArray>();
+
+    xSemaphoreTakeRecursive(xSchedulerMutex, portMAX_DELAY);
+    for (int i = 0; i < SCHEDULER_MAX_ENTRIES; i++)
+    {
+        if (entries[i].id == 0)
+        {
+            continue;
+        }
+        JsonObject item = array.createNestedObject();
+        item["id"] = entries[i].id;
+        item["kind"] = kindNames[entries[i].kind];
+        item["at"] = entries[i].at;
+        if (entries[i].kind == SCHEDULE_WEEKLY)
+        {
+            item["days"] = entries[i].weekdays;
+        }
+        item["action"] = actionNames[entries[i].action];
+        item["param"] = entries[i].param;
+        if (entryDue[i] != 0)
+        {
+            item["next"] = entryDue[i];
+        }
+    }
+    xSemaphoreGiveRecursive(xSchedulerMutex);
+
+    String payload;
+    serializeJson(doc, payload);
+    return payload;
+}
+
+static uint32_t benchmarkFired;
+
+static void benchmarkCallback(uint8_t action, uint16_t arg)
+{
+    benchmarkFired++;
+}
+
+void scheduler_benchmark()
+{
+    // Heap allocated, the benchmark wheel is as big as the scheduler's
+    TimerWheel_t *bench = (TimerWheel_t *)malloc(sizeof(TimerWheel_t));
+    TimerWheelHandle_t *handles = (TimerWheelHandle_t *)malloc(TIMER_WHEEL_CAPACITY * sizeof(TimerWheelHandle_t));
+    if (bench == NULL || handles == NULL)
+    {
+        free(bench);
+        free(handles);
+        Serial.println("[SCHEDULER] Benchmark: out of memory");
+        return;
+    }
+
+    Serial.printf("[SCHEDULER] Benchmark: %d timers, %u bytes\n", TIMER_WHEEL_CAPACITY, (unsigned)sizeof(TimerWheel_t));
+    for (int spread = 64; spread <= (1 << 20); spread <<= 4)
+    {
+        timer_wheel_init(bench, 0);
+        benchmarkFired = 0;
+
+        int64_t start = esp_timer_get_time();
+        for (int i = 0; i < TIMER_WHEEL_CAPACITY; i++)
+        {
+            handles[i] = timer_wheel_add(bench, 1 + esp_random() % spread, 0, i);
+        }
+        int64_t added = esp_timer_get_time();
+        for (int i = 0; i < TIMER_WHEEL_CAPACITY; i += 2)
+        {
+            timer_wheel_cancel(bench, handles[i]);
+        }
+        int64_t cancelled = esp_timer_get_time();
+
+        // Same pattern as the dispatcher: sleep until the next tick with work
+        uint32_t wakeups = 0;
+        while (bench->active > 0)
+        {
+            timer_wheel_advance(bench, bench->now + timer_wheel_ticks_to_next(bench), benchmarkCallback);
+            wakeups++;
+        }
+        int64_t done = esp_timer_get_time();
+
+        Serial.printf("[SCHEDULER]   spread %7d ticks: add %.2f us, cancel %.2f us, fire %.2f us per timer, %u wakeups for %u timers\n",
+                      spread,
+                      (float)(added - start) / TIMER_WHEEL_CAPACITY,
+                      (float)(cancelled - added) / (TIMER_WHEEL_CAPACITY / 2),
+                      (float)(done - cancelled) / max(benchmarkFired, (uint32_t)1),
+                      wakeups, benchmarkFired);
+    }
+
+    free(bench);
+    free(handles);
+}
@@ -0,0 +1,318 @@
+#include "snapshot.h"
+
+#define SNAPSHOT_MAGIC 0x50414E53 // "SNAP"
+#define SNAPSHOT_FORMAT 1
+
+typedef struct {
+    uint32_t magic;
+    uint16_t format;
+    uint16_t count;     // blobs in the image
+    uint32_t sequence;  // incremented by every save, the newer copy wins at boot
+    uint32_t length;    // bytes of blobs after the header
+    uint32_t crc;       // CRC-32 of those bytes
+} SnapshotHeader_t;
+
+typedef struct {
+    char name[SNAPSHOT_NAME_LEN];
+    uint16_t version;
+    uint16_t size;      // bytes of state that follow
+} SnapshotBlobHeader_t;
+
+// Blobs start 4 byte aligned
+#define BLOB_STRIDE(size) (sizeof(SnapshotBlobHeader_t) + (((size) + 3) & ~3))
+
+typedef struct {
+    const char *name;
+    uint16_t version;
+    uint16_t size;
+    SnapshotSave_t save;
+    SnapshotRestore_t restore;
+} SnapshotEntry_t;
+
+// Survives software resets, panics and watchdog resets, garbage after power-on
+RTC_NOINIT_ATTR static uint8_t rtcImage[SNAPSHOT_MAX_SIZE];
+
+static SnapshotEntry_t entries[SNAPSHOT_MAX_ENTRIES];
+static int entryCount = 0;
+// Image found at boot, blobs are restored from it on registration
+static uint8_t *bootImage = NULL;
+static uint32_t sequence = 0;
+// Image being written, only used under xSnapshotMutex
+static uint8_t image[SNAPSHOT_MAX_SIZE];
+
+static uint32_t crc32(const uint8_t *data, size_t len)
+{
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < len; i++)
+    {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
+
+/**
+ * @brief Checks magic, format, bounds and CRC of an image, and that every blob fits.
+ */
+static bool validImage(const uint8_t *data, size_t size)
+{
+    const SnapshotHeader_t *header = (const SnapshotHeader_t *)data;
+    if (size < sizeof(SnapshotHeader_t) || header->magic != SNAPSHOT_MAGIC || header->format != SNAPSHOT_FORMAT ||
+        header->length > size - sizeof(SnapshotHeader_t))
+    {
+        return false;
+    }
+    const uint8_t *payload = data + sizeof(SnapshotHeader_t);
+    if (crc32(payload, header->length) != header->crc)
+    {
+        return false;
+    }
+
+    size_t offset = 0;
+    for (int i = 0; i < header->count; i++)
+    {
+        if (offset + sizeof(SnapshotBlobHeader_t) > header->length)
+        {
+            return false;
+        }
+        const SnapshotBlobHeader_t *blob = (const SnapshotBlobHeader_t *)(payload + offset);
+        offset += BLOB_STRIDE(blob->size);
+    }
+    return offset == header->length;
+}
+
+/**
+ * @brief Finds a blob by name in a validated image.
+ */
+static const SnapshotBlobHeader_t *findBlob(const uint8_t *data, const char *name)
+{
+    const SnapshotHeader_t *header = (const SnapshotHeader_t *)data;
+    const uint8_t *payload = data + sizeof(SnapshotHeader_t);
+    size_t offset = 0;
+    for (int i = 0; i < header->count; i++)
+    {
+        const SnapshotBlobHeader_t *blob = (const SnapshotBlobHeader_t *)(payload + offset);
+        if (strncmp(blob->name, name, SNAPSHOT_NAME_LEN) == 0)
+        {
+            return blob;
+        }
+        offset += BLOB_STRIDE(blob->size);
+    }
+    return NULL;
+}
+
+static bool isRegistered(const char *name)
+{
+    for (int i = 0; i < entryCount; i++)
+    {
+        if (strncmp(entries[i].name, name, SNAPSHOT_NAME_LEN) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Appends one blob to the image being built.
+ */
+static bool appendBlob(size_t *offset, const char *name, uint16_t version, uint16_t size, SnapshotSave_t save,
+                       const void *data)
+{
+    if (*offset + BLOB_STRIDE(size) > SNAPSHOT_MAX_SIZE)
+    {
+        Serial.printf("[SNAPSHOT] No room for %s (%u bytes)\n", name, size);
+        return false;
+    }
+    SnapshotBlobHeader_t blob;
+    memset(&blob, 0, sizeof(blob));
+    strncpy(blob.name, name, SNAPSHOT_NAME_LEN);
+    blob.version = version;
+    blob.size = size;
+    memcpy(image + *offset, &blob, sizeof(blob));
+    *offset += sizeof(blob);
+
+    if (save != NULL)
+    {
+        save(image + *offset);
+    }
+    else
+    {
+        memcpy(image + *offset, data, size);
+    }
+    memset(image + *offset + size, 0, BLOB_STRIDE(size) - sizeof(blob) - size);
+    *offset += BLOB_STRIDE(size) - sizeof(blob);
+    return true;
+}
+
+void snapshot_begin()
+{
+    uint8_t *flashImage = (uint8_t *)malloc(SNAPSHOT_MAX_SIZE);
+    size_t flashSize = 0;
+    File file = LittleFS.open(SNAPSHOT_FILE, "r");
+    if (file && flashImage != NULL)
+    {
+        flashSize = file.read(flashImage, SNAPSHOT_MAX_SIZE);
+    }
+    if (file)
+    {
+        file.close();
+    }
+
+    bool rtcValid = validImage(rtcImage, sizeof(rtcImage));
+    bool flashValid = flashImage != NULL && validImage(flashImage, flashSize);
+    const SnapshotHeader_t *rtcHeader = (const SnapshotHeader_t *)rtcImage;
+    const SnapshotHeader_t *flashHeader = (const SnapshotHeader_t *)flashImage;
+    if (rtcValid && flashValid && (int32_t)(rtcHeader->sequence - flashHeader->sequence) < 0)
+    {
+        // Older RTC copy, e.g. from before a power cycle that happened to keep RTC memory
+        rtcValid = false;
+    }
+
+    const char *source = NULL;
+    if (rtcValid && flashImage != NULL)
+    {
+        // RTC copy is at least as new, the flash buffer holds it from here on
+        memcpy(flashImage, rtcImage, sizeof(rtcImage));
+        source = "RTC";
+    }
+    else if (flashValid)
+    {
+        source = "flash";
+    }
+
+    if (source != NULL)
+    {
+        bootImage = flashImage;
+        const SnapshotHeader_t *header = (const SnapshotHeader_t *)bootImage;
+        sequence = header->sequence;
+        Serial.printf("[SNAPSHOT] Restoring %u blobs from %s (sequence %u)\n", header->count, source,
+                      (unsigned)header->sequence);
+    }
+    else
+    {
+        free(flashImage);
+        Serial.println("[SNAPSHOT] No valid snapshot, cold start");
+    }
+}
+
+bool snapshot_register(const char *name, uint16_t version, size_t size,
+                       SnapshotSave_t save, SnapshotRestore_t restore)
+{
+    if (entryCount >= SNAPSHOT_MAX_ENTRIES || size > SNAPSHOT_MAX_SIZE || save == NULL)
+    {
+        return false;
+    }
+
+    xSemaphoreTake(xSnapshotMutex, portMAX_DELAY);
+    entries[entryCount++] = {name, version, (uint16_t)size, save, restore};
+
+    bool restored = false;
+    const SnapshotBlobHeader_t *blob = (bootImage != NULL) ? findBlob(bootImage, name) : NULL;
+    if (blob != NULL && blob->version == version && blob->size == size && restore != NULL)
+    {
+        restore((const uint8_t *)blob + sizeof(SnapshotBlobHeader_t));
+        restored = true;
+    }
+    else if (blob != NULL)
+    {
+        Serial.printf("[SNAPSHOT] %s: version %u / %u bytes in snapshot, expected %u / %u, starting cold\n",
+                      name, blob->version, blob->size, version, (unsigned)size);
+    }
+    xSemaphoreGive(xSnapshotMutex);
+
+    return restored;
+}
+
+bool snapshot_save(uint8_t targets)
+{
+    xSemaphoreTake(xSnapshotMutex, portMAX_DELAY);
+
+    size_t offset = sizeof(SnapshotHeader_t);
+    uint16_t count = 0;
+    for (int i = 0; i < entryCount; i++)
+    {
+        if (appendBlob(&offset, entries[i].name, entries[i].version, entries[i].size, entries[i].save, NULL))
+        {
+            count++;
+        }
+    }
+
+    // Keep the blobs of subsystems that have not registered since boot
+    if (bootImage != NULL)
+    {
+        const SnapshotHeader_t *boot = (const SnapshotHeader_t *)bootImage;
+        size_t bootOffset = sizeof(SnapshotHeader_t);
+        for (int i = 0; i < boot->count; i++)
+        {
+            const SnapshotBlobHeader_t *blob = (const SnapshotBlobHeader_t *)(bootImage + bootOffset);
+            char name[SNAPSHOT_NAME_LEN + 1];
+            strncpy(name, blob->name, SNAPSHOT_NAME_LEN);
+            name[SNAPSHOT_NAME_LEN] = '\0';
+            if (!isRegistered(name) &&
+                appendBlob(&offset, name, blob->version, blob->size, NULL, (const uint8_t *)blob + sizeof(SnapshotBlobHeader_t)))
+            {
+                count++;
+            }
+            bootOffset += BLOB_STRIDE(blob->size);
+        }
+    }
+
+    SnapshotHeader_t header;
+    header.magic = SNAPSHOT_MAGIC;
+    header.format = SNAPSHOT_FORMAT;
+    header.count = count;
+    header.sequence = ++sequence;
+    header.length = offset - sizeof(SnapshotHeader_t);
+    header.crc = crc32(image + sizeof(SnapshotHeader_t), header.length);
+    memcpy(image, &header, sizeof(header));
+
+    bool ok = true;
+    if (targets & SNAPSHOT_TARGET_RTC)
+    {
+        // A reset in the middle of the copy leaves a CRC mismatch, the flash copy is used then
+        memcpy(rtcImage, image, offset);
+    }
+    if (targets & SNAPSHOT_TARGET_FLASH)
+    {
+        File file = LittleFS.open(SNAPSHOT_FILE ".tmp", "w");
+        ok = file && file.write(image, offset) == offset;
+        if (file)
+        {
+            file.close();
+        }
+        // Replaced in one rename, a power loss keeps the previous flash copy
+        ok = ok && LittleFS.rename(SNAPSHOT_FILE ".tmp", SNAPSHOT_FILE);
+    }
+
+    xSemaphoreGive(xSnapshotMutex);
+    return ok;
+}
+
+void snapshot_restart()
+{
+    Serial.println("[SNAPSHOT] Saving state before restart");
+    snapshot_save(SNAPSHOT_TARGET_RTC | SNAPSHOT_TARGET_FLASH);
+    ESP.restart();
+}
+
+void snapshot_task(void *pvParameters)
+{
+    unsigned long lastFlashSave = millis();
+
+    while (1)
+    {
+        vTaskDelay(pdMS_TO_TICKS(SNAPSHOT_RTC_PERIOD_MS));
+
+        uint8_t targets = SNAPSHOT_TARGET_RTC;
+        if (millis() - lastFlashSave >= SNAPSHOT_FLASH_PERIOD_MS)
+        {
+            lastFlashSave = millis();
+            targets |= SNAPSHOT_TARGET_FLASH;
+        }
+        snapshot_save(targets);
+    }
+}
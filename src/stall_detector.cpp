@@ -0,0 +1,480 @@
+#include "stall_detector.h"
+#include "esp_rom_crc.h"
+
+#if CONFIG_IDF_TARGET_ARCH_XTENSA
+#include "freertos/xtensa_context.h"
+#include "esp_debug_helpers.h"
+#include "esp_rom_sys.h"
+#if __has_include("esp_memory_utils.h")
+#include "esp_memory_utils.h"
+#else
+#include "soc/soc_memory_layout.h"
+#endif
+#endif
+
+#define STALL_LOG_MAGIC 0x4C415453 // "STAL"
+
+typedef struct {
+    uint32_t magic;
+    uint32_t bootCount;
+    uint32_t sequence;          // records written, the next goes to sequence % STALL_LOG_ENTRIES
+    StallRecord_t records[STALL_LOG_ENTRIES];
+    uint32_t crc;               // CRC-32 of everything above
+} StallLog_t;
+
+typedef struct {
+    TaskHandle_t task;          // NULL while a restarted task has not registered again
+    char name[configMAX_TASK_NAME_LEN];
+    uint32_t periodMs;
+    volatile uint32_t lastBeat; // millis()
+    volatile bool stalled;      // recorded, until the next heartbeat
+    const char *volatile state;
+    StallRecovery_t recovery;
+    StallHandler_t handler;
+    void *arg;
+    TaskFunction_t entry;
+    uint32_t stackSize;
+    void *param;
+} StallTask_t;
+
+// Survives software resets, panics and watchdog resets, garbage after power-on
+RTC_NOINIT_ATTR static StallLog_t rtcLog;
+
+static StallTask_t tasks[STALL_MAX_TASKS];
+// Guards the task table and the log, the monitor must never block on a lock
+static portMUX_TYPE stallMux = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *taskStateNames[] = {"running", "ready", "blocked", "suspended", "deleted", "invalid"};
+static const char *recoveryNames[STALL_RECOVER_COUNT] = {"none", "handler", "restart_task", "reboot"};
+
+static uint32_t logCrc()
+{
+    return esp_rom_crc32_le(0, (const uint8_t *)&rtcLog, offsetof(StallLog_t, crc));
+}
+
+void stall_begin()
+{
+    portENTER_CRITICAL(&stallMux);
+    if (rtcLog.magic != STALL_LOG_MAGIC || rtcLog.crc != logCrc())
+    {
+        memset(&rtcLog, 0, sizeof(rtcLog));
+        rtcLog.magic = STALL_LOG_MAGIC;
+    }
+    rtcLog.bootCount++;
+    rtcLog.crc = logCrc();
+    portEXIT_CRITICAL(&stallMux);
+}
+
+uint32_t stall_boot_count()
+{
+    return rtcLog.bootCount;
+}
+
+static StallTask_t *findTask(TaskHandle_t task)
+{
+    for (int i = 0; i < STALL_MAX_TASKS; i++)
+    {
+        if (tasks[i].task == task)
+        {
+            return &tasks[i];
+        }
+    }
+    return NULL;
+}
+
+static bool registerTask(uint32_t periodMs, StallRecovery_t recovery, StallHandler_t handler, void *arg,
+                         TaskFunction_t entry, uint32_t stackSize, void *param)
+{
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    const char *name = pcTaskGetName(self);
+    bool ok = false;
+    portENTER_CRITICAL(&stallMux);
+    // The own slot, the slot of the same task before a restart, or a free one
+    StallTask_t *slot = findTask(self);
+    for (int i = 0; slot == NULL && i < STALL_MAX_TASKS; i++)
+    {
+        if (tasks[i].task == NULL && strncmp(tasks[i].name, name, configMAX_TASK_NAME_LEN) == 0)
+        {
+            slot = &tasks[i];
+        }
+    }
+    for (int i = 0; slot == NULL && i < STALL_MAX_TASKS; i++)
+    {
+        if (tasks[i].task == NULL && tasks[i].name[0] == '\0')
+        {
+            slot = &tasks[i];
+        }
+    }
+    if (slot != NULL)
+    {
+        strncpy(slot->name, name, configMAX_TASK_NAME_LEN - 1);
+        slot->name[configMAX_TASK_NAME_LEN - 1] = '\0';
+        slot->periodMs = periodMs;
+        slot->lastBeat = millis();
+        slot->stalled = false;
+        slot->state = NULL;
+        slot->recovery = recovery;
+        slot->handler = handler;
+        slot->arg = arg;
+        slot->entry = entry;
+        slot->stackSize = stackSize;
+        slot->param = param;
+        // Last, the monitor only looks at slots with a task
+        slot->task = self;
+        ok = true;
+    }
+    portEXIT_CRITICAL(&stallMux);
+    if (!ok)
+    {
+        Serial.printf("[STALL] No slot left for %s\n", name);
+    }
+    return ok;
+}
+
+bool stall_register(uint32_t periodMs, StallRecovery_t recovery, StallHandler_t handler, void *arg)
+{
+    if (recovery == STALL_RECOVER_RESTART_TASK || (recovery == STALL_RECOVER_HANDLER && handler == NULL))
+    {
+        return false;
+    }
+    return registerTask(periodMs, recovery, handler, arg, NULL, 0, NULL);
+}
+
+bool stall_register_restartable(uint32_t periodMs, TaskFunction_t entry, uint32_t stackSize, void *param)
+{
+    if (entry == NULL)
+    {
+        return false;
+    }
+    return registerTask(periodMs, STALL_RECOVER_RESTART_TASK, NULL, NULL, entry, stackSize, param);
+}
+
+void stall_heartbeat()
+{
+    StallTask_t *slot = findTask(xTaskGetCurrentTaskHandle());
+    if (slot != NULL)
+    {
+        slot->lastBeat = millis();
+        slot->stalled = false;
+    }
+}
+
+void stall_set_state(const char *state)
+{
+    StallTask_t *slot = findTask(xTaskGetCurrentTaskHandle());
+    if (slot != NULL)
+    {
+        slot->state = state;
+    }
+}
+
+#if CONFIG_IDF_TARGET_ARCH_XTENSA
+/**
+ * @brief Maps a return address to its call instruction, as the panic handler does.
+ */
+static uint32_t stackPc(uint32_t pc)
+{
+    if (pc & 0x80000000)
+    {
+        // The top two bits hold the window increment of the call
+        pc = (pc & 0x3FFFFFFF) | 0x40000000;
+    }
+    return pc - 3;
+}
+
+/**
+ * @brief Walks the stack of a task that is switched out. Its register windows
+ *        were spilled at the switch, so the frames are all on its stack.
+ */
+static uint8_t captureBacktrace(TaskHandle_t task, uint32_t *backtrace)
+{
+    // pxTopOfStack, the first member of the TCB, points to the context saved at the switch
+    const XtExcFrame *saved = *(XtExcFrame *const *)task;
+    if (!esp_stack_ptr_is_sane((uint32_t)saved))
+    {
+        return 0;
+    }
+    esp_backtrace_frame_t frame;
+    if (saved->exit != 0)
+    {
+        // Preempted by an interrupt
+        frame.pc = saved->pc;
+        frame.sp = saved->a1;
+        frame.next_pc = saved->a0;
+    }
+    else
+    {
+        // Yielded, e.g. blocked on a queue or in vTaskDelay()
+        const XtSolFrame *solicited = (const XtSolFrame *)saved;
+        frame.pc = solicited->pc;
+        frame.sp = solicited->a1;
+        frame.next_pc = solicited->a0;
+    }
+
+    uint8_t depth = 0;
+    while (depth < STALL_BACKTRACE_DEPTH)
+    {
+        uint32_t pc = stackPc(frame.pc);
+        if (!esp_stack_ptr_is_sane(frame.sp) || !esp_ptr_executable((void *)pc))
+        {
+            break;
+        }
+        backtrace[depth++] = pc;
+        if (frame.next_pc == 0 || !esp_backtrace_get_next_frame(&frame))
+        {
+            break;
+        }
+    }
+    return depth;
+}
+
+static bool onSomeCore(TaskHandle_t task)
+{
+    for (int core = 0; core < portNUM_PROCESSORS; core++)
+    {
+        if (xTaskGetCurrentTaskHandleForCPU(core) == task)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+#endif
+
+/**
+ * @brief Fills a record with everything about a stalled task but the log fields.
+ */
+static void describeTask(const StallTask_t *slot, uint32_t overdueMs, StallRecord_t *record)
+{
+    TaskHandle_t task = slot->task;
+    memset(record, 0, sizeof(*record));
+    time_t now = time(NULL);
+    if (now > 1577836800)
+    {
+        record->time = (uint32_t)now;
+    }
+    else
+    {
+        record->time = millis() / 1000;
+        record->flags |= STALL_FLAG_UPTIME;
+    }
+    record->periodMs = slot->periodMs;
+    record->overdueMs = overdueMs;
+    record->recovery = slot->recovery;
+    strncpy(record->task, slot->name, sizeof(record->task) - 1);
+    const char *state = slot->state;
+    if (state != NULL)
+    {
+        strncpy(record->state, state, sizeof(record->state) - 1);
+    }
+    const char *object = lock_profile_waiting_on(task);
+    if (object != NULL)
+    {
+        strncpy(record->blockedOn, object, sizeof(record->blockedOn) - 1);
+    }
+    record->stackFree = uxTaskGetStackHighWaterMark(task);
+
+    eTaskState taskState = eTaskGetState(task);
+    record->taskState = taskState;
+#if CONFIG_IDF_TARGET_ARCH_XTENSA
+    // A task that can run is held while its stack is read; a blocked one stays
+    // blocked, resuming it would cut its wait short
+    bool hold = taskState == eRunning || taskState == eReady;
+    if (hold)
+    {
+        vTaskSuspend(task);
+        // Suspending a task running on the other core only asks it to switch out
+        for (int i = 0; i < 100 && onSomeCore(task); i++)
+        {
+            esp_rom_delay_us(10);
+        }
+    }
+    if (!onSomeCore(task))
+    {
+        record->depth = captureBacktrace(task, record->backtrace);
+    }
+    if (hold)
+    {
+        vTaskResume(task);
+    }
+#endif
+}
+
+static void journalStall(void *arg)
+{
+    uint32_t packed = (uint32_t)(uintptr_t)arg;
+    journal_log(EVENT_STALL, packed >> 24, (float)(packed & 0xFFFFFF));
+}
+
+static void appendRecord(StallRecord_t *record)
+{
+    portENTER_CRITICAL(&stallMux);
+    record->sequence = rtcLog.sequence;
+    record->bootCount = rtcLog.bootCount;
+    rtcLog.records[rtcLog.sequence % STALL_LOG_ENTRIES] = *record;
+    rtcLog.sequence++;
+    rtcLog.crc = logCrc();
+    portEXIT_CRITICAL(&stallMux);
+}
+
+static void recover(StallTask_t *slot)
+{
+    switch (slot->recovery)
+    {
+    case STALL_RECOVER_HANDLER:
+        if (!executor_submit(slot->handler, slot->arg, EXECUTOR_PRIORITY_HIGH))
+        {
+            Serial.printf("[STALL] Executor full, no recovery of %s\n", slot->name);
+        }
+        break;
+    case STALL_RECOVER_RESTART_TASK:
+    {
+        TaskHandle_t task = slot->task;
+        UBaseType_t priority = uxTaskPriorityGet(task);
+        // tskNO_AFFINITY for a task created unpinned
+        BaseType_t core = xTaskGetAffinity(task);
+        portENTER_CRITICAL(&stallMux);
+        // Keeps the name, the new task takes the slot over when it registers
+        slot->task = NULL;
+        portEXIT_CRITICAL(&stallMux);
+        vTaskDelete(task);
+        if (xTaskCreatePinnedToCore(slot->entry, slot->name, slot->stackSize, slot->param, priority, NULL, core) !=
+            pdPASS)
+        {
+            Serial.printf("[STALL] Could not restart %s\n", slot->name);
+        }
+        break;
+    }
+    case STALL_RECOVER_REBOOT:
+        // The record is in RTC memory already
+        esp_restart();
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief Records and recovers every task past its deadline, once per stall.
+ */
+static void checkTasks()
+{
+    for (int i = 0; i < STALL_MAX_TASKS; i++)
+    {
+        StallTask_t *slot = &tasks[i];
+        uint32_t overdue = millis() - slot->lastBeat;
+        if (slot->task == NULL || slot->stalled || overdue <= slot->periodMs)
+        {
+            continue;
+        }
+        slot->stalled = true;
+
+        StallRecord_t record;
+        describeTask(slot, overdue, &record);
+        appendRecord(&record);
+        Serial.printf("[STALL] %s: no heartbeat for %lu ms (%s, state \"%s\", blocked on \"%s\", %lu bytes stack free), %s\n",
+                      record.task, (unsigned long)overdue, taskStateNames[min(record.taskState, (uint8_t)5)],
+                      record.state, record.blockedOn, (unsigned long)record.stackFree,
+                      recoveryNames[record.recovery]);
+
+        // The journal takes a lock the stalled task may hold
+        uint32_t packed = ((uint32_t)record.recovery << 24) | min(overdue / 1000, (uint32_t)0xFFFFFF);
+        executor_submit(journalStall, (void *)(uintptr_t)packed);
+        recover(slot);
+    }
+}
+
+void stall_monitor_task(void *pvParameters)
+{
+    TickType_t lastWake = xTaskGetTickCount();
+    while (true)
+    {
+        checkTasks();
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(STALL_CHECK_MS));
+    }
+}
+
+uint32_t stall_min_stack_free()
+{
+    uint32_t least = UINT32_MAX;
+    // A restarting task is taken out of its slot under the lock before it is deleted
+    portENTER_CRITICAL(&stallMux);
+    for (int i = 0; i < STALL_MAX_TASKS; i++)
+    {
+        if (tasks[i].task != NULL)
+        {
+            least = min(least, (uint32_t)uxTaskGetStackHighWaterMark(tasks[i].task));
+        }
+    }
+    portEXIT_CRITICAL(&stallMux);
+    return least;
+}
+
+bool stall_take_unpublished(StallRecord_t *record)
+{
+    bool found = false;
+    portENTER_CRITICAL(&stallMux);
+    uint32_t count = min(rtcLog.sequence, (uint32_t)STALL_LOG_ENTRIES);
+    for (uint32_t sequence = rtcLog.sequence - count; sequence < rtcLog.sequence; sequence++)
+    {
+        const StallRecord_t *entry = &rtcLog.records[sequence % STALL_LOG_ENTRIES];
+        if ((entry->flags & STALL_FLAG_PUBLISHED) == 0)
+        {
+            *record = *entry;
+            found = true;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&stallMux);
+    return found;
+}
+
+void stall_mark_published(uint32_t sequence)
+{
+    portENTER_CRITICAL(&stallMux);
+    StallRecord_t *entry = &rtcLog.records[sequence % STALL_LOG_ENTRIES];
+    // Overwritten by a newer stall in the meantime, that one is still to publish
+    if (entry->sequence == sequence && sequence < rtcLog.sequence)
+    {
+        entry->flags |= STALL_FLAG_PUBLISHED;
+        rtcLog.crc = logCrc();
+    }
+    portEXIT_CRITICAL(&stallMux);
+}
+
+String stall_record_json(const StallRecord_t *record)
+{
+    char backtrace[STALL_BACKTRACE_DEPTH * 11 + 1];
+    size_t used = 0;
+    backtrace[0] = '\0';
+    for (uint8_t i = 0; i < record->depth && i < STALL_BACKTRACE_DEPTH; i++)
+    {
+        used += snprintf(backtrace + used, sizeof(backtrace) - used, i == 0 ? "0x%08lx" : " 0x%08lx",
+                         (unsigned long)record->backtrace[i]);
+    }
+
+    StaticJsonDocument<512> doc;
+    JsonObject values = doc.to<JsonObject>();
+    if ((record->flags & STALL_FLAG_UPTIME) == 0)
+    {
+        doc["ts"] = (uint64_t)record->time * 1000;
+        values = doc.createNestedObject("values");
+    }
+    else
+    {
+        values["stall_uptime_s"] = record->time;
+    }
+    values["stall_task"] = record->task;
+    values["stall_state"] = record->state;
+    values["stall_blocked_on"] = record->blockedOn;
+    values["stall_task_state"] = taskStateNames[min(record->taskState, (uint8_t)5)];
+    values["stall_period_ms"] = record->periodMs;
+    values["stall_overdue_ms"] = record->overdueMs;
+    values["stall_stack_free"] = record->stackFree;
+    values["stall_recovery"] = recoveryNames[min(record->recovery, (uint8_t)(STALL_RECOVER_COUNT - 1))];
+    values["stall_boot"] = record->bootCount;
+    values["stall_backtrace"] = (const char *)backtrace;
+    String json;
+    serializeJson(doc, json);
+    return json;
+}
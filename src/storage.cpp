@@ -0,0 +1,393 @@
+#include "storage.h"
+
+typedef struct {
+    bool inUse;
+    char path[32];
+    StorageSyncPolicy_t policy;
+    uint8_t *buffer;
+    size_t capacity;
+    size_t used;
+    uint32_t records;           // appends waiting in the buffer
+    unsigned long firstAppend;  // millis() of the oldest buffered append
+    size_t fileSize;            // bytes already in LittleFS
+    StorageStats_t stats;
+} StorageFile_t;
+
+static StorageFile_t files[STORAGE_MAX_FILES];
+static size_t budgetUsed = 0;
+
+static StorageFile_t *getFile(StorageHandle_t handle)
+{
+    if (handle < 0 || handle >= STORAGE_MAX_FILES || !files[handle].inUse)
+    {
+        return NULL;
+    }
+    return &files[handle];
+}
+
+/**
+ * @brief One LittleFS append, i.e. one metadata commit. Caller holds xStorageMutex.
+ * @return Bytes that reached the file, less than len if the write failed or was cut short
+ */
+static size_t writeToFlash(StorageFile_t *f, const uint8_t *data, size_t len)
+{
+    File file = LittleFS.open(f->path, "a");
+    if (!file)
+    {
+        f->stats.failedWrites++;
+        return 0;
+    }
+    size_t written = file.write(data, len);
+    file.close();
+
+    f->stats.flashWrites++;
+    f->stats.bytesWritten += written;
+    // Appending into a partially filled block copies that block first
+    f->stats.estimatedFlashBytes += (f->fileSize % STORAGE_BLOCK_SIZE) + written + STORAGE_COMMIT_COST;
+    f->fileSize += written;
+
+    if (written != len)
+    {
+        f->stats.failedWrites++;
+    }
+    return written;
+}
+
+/**
+ * @brief Writes the buffered appends to LittleFS. Caller holds xStorageMutex.
+ */
+static bool flushLocked(StorageFile_t *f)
+{
+    if (f->used == 0)
+    {
+        return true;
+    }
+    size_t written = writeToFlash(f, f->buffer, f->used);
+    if (written != f->used)
+    {
+        // The written prefix is in the file now, only the rest stays buffered
+        // so the next flush does not append it a second time
+        memmove(f->buffer, f->buffer + written, f->used - written);
+        f->used -= written;
+        return false;
+    }
+    f->used = 0;
+    f->records = 0;
+    f->stats.syncs++;
+    return true;
+}
+
+StorageHandle_t storage_open(const char *path, const StorageSyncPolicy_t *policy, size_t bufferSize)
+{
+    if (path == NULL || strlen(path) >= sizeof(files[0].path))
+    {
+        return STORAGE_INVALID_HANDLE;
+    }
+
+    xSemaphoreTake(xStorageMutex, portMAX_DELAY);
+
+    StorageHandle_t handle = STORAGE_INVALID_HANDLE;
+    for (int i = 0; i < STORAGE_MAX_FILES; i++)
+    {
+        if (files[i].inUse && strcmp(files[i].path, path) == 0)
+        {
+            xSemaphoreGive(xStorageMutex);
+            return i;
+        }
+        if (!files[i].inUse && handle == STORAGE_INVALID_HANDLE)
+        {
+            handle = i;
+        }
+    }
+
+    if (handle != STORAGE_INVALID_HANDLE)
+    {
+        StorageFile_t *f = &files[handle];
+        memset(f, 0, sizeof(StorageFile_t));
+        strcpy(f->path, path);
+        if (policy != NULL)
+        {
+            f->policy = *policy;
+        }
+
+        File file = LittleFS.open(path, "r");
+        if (file)
+        {
+            f->fileSize = file.size();
+            file.close();
+        }
+
+        size_t capacity = min(bufferSize, (size_t)STORAGE_BLOCK_SIZE);
+        capacity = min(capacity, (size_t)STORAGE_RAM_BUDGET - budgetUsed);
+        if (capacity >= STORAGE_MIN_BUFFER)
+        {
+            f->buffer = (uint8_t *)malloc(capacity);
+        }
+        if (f->buffer != NULL)
+        {
+            f->capacity = capacity;
+            budgetUsed += capacity;
+        }
+        else if (bufferSize > 0)
+        {
+            Serial.printf("STORAGE: No buffer left for %s, appends go straight to flash\n", path);
+        }
+        f->inUse = true;
+    }
+
+    xSemaphoreGive(xStorageMutex);
+    return handle;
+}
+
+bool storage_close(StorageHandle_t handle)
+{
+    xSemaphoreTake(xStorageMutex, portMAX_DELAY);
+    StorageFile_t *f = getFile(handle);
+    bool ok = true;
+    if (f != NULL)
+    {
+        ok = flushLocked(f);
+        if (ok)
+        {
+            free(f->buffer);
+            budgetUsed -= f->capacity;
+            f->buffer = NULL;
+            f->inUse = false;
+        }
+        else
+        {
+            // Freeing the buffer would lose the appends, the file stays open so a later sync or close can retry
+            Serial.printf("STORAGE: %u bytes of %s not flushed, kept open\n", (unsigned)f->used, f->path);
+        }
+    }
+    xSemaphoreGive(xStorageMutex);
+    return ok;
+}
+
+bool storage_append(StorageHandle_t handle, const void *data, size_t len, StoragePriority_t priority)
+{
+    xSemaphoreTake(xStorageMutex, portMAX_DELAY);
+    StorageFile_t *f = getFile(handle);
+    if (f == NULL)
+    {
+        xSemaphoreGive(xStorageMutex);
+        return false;
+    }
+
+    f->stats.appends++;
+    f->stats.bytesAppended += len;
+
+    bool ok = true;
+    if (f->used + len > f->capacity)
+    {
+        // Make room first, keeps the appends in order
+        ok = flushLocked(f);
+    }
+
+    if (ok && len > f->capacity)
+    {
+        // Bigger than the buffer (or unbuffered file), nothing to combine it with
+        // A short write leaves a prefix of the record in the file, like an unbuffered append would
+        ok = writeToFlash(f, (const uint8_t *)data, len) == len;
+        if (ok)
+        {
+            f->stats.syncs++;
+        }
+    }
+    else if (ok)
+    {
+        if (f->records == 0)
+        {
+            f->firstAppend = millis();
+        }
+        memcpy(f->buffer + f->used, data, len);
+        f->used += len;
+        f->records++;
+
+        if (priority == STORAGE_PRIORITY_CRITICAL ||
+            (f->policy.maxRecords > 0 && f->records >= f->policy.maxRecords))
+        {
+            ok = flushLocked(f);
+        }
+    }
+
+    xSemaphoreGive(xStorageMutex);
+    return ok;
+}
+
+bool storage_sync(StorageHandle_t handle)
+{
+    xSemaphoreTake(xStorageMutex, portMAX_DELAY);
+    StorageFile_t *f = getFile(handle);
+    bool ok = (f != NULL) && flushLocked(f);
+    xSemaphoreGive(xStorageMutex);
+    return ok;
+}
+
+void storage_sync_all()
+{
+    xSemaphoreTake(xStorageMutex, portMAX_DELAY);
+    for (int i = 0; i < STORAGE_MAX_FILES; i++)
+    {
+        if (files[i].inUse)
+        {
+            flushLocked(&files[i]);
+        }
+    }
+    xSemaphoreGive(xStorageMutex);
+}
+
+size_t storage_size(StorageHandle_t handle)
+{
+    xSemaphoreTake(xStorageMutex, portMAX_DELAY);
+    StorageFile_t *f = getFile(handle);
+    size_t size = (f != NULL) ? f->fileSize + f->used : 0;
+    xSemaphoreGive(xStorageMutex);
+    return size;
+}
+
+void storage_get_stats(StorageHandle_t handle, StorageStats_t *stats)
+{
+    xSemaphoreTake(xStorageMutex, portMAX_DELAY);
+    StorageFile_t *f = getFile(handle);
+    if (f != NULL)
+    {
+        *stats = f->stats;
+    }
+    else
+    {
+        memset(stats, 0, sizeof(StorageStats_t));
+    }
+    xSemaphoreGive(xStorageMutex);
+}
+
+float storage_write_amplification(const StorageStats_t *stats)
+{
+    if (stats->bytesWritten == 0)
+    {
+        return 0.0f;
+    }
+    return (float)stats->estimatedFlashBytes / stats->bytesWritten;
+}
+
+void storage_task(void *pvParameters)
+{
+    while (1)
+    {
+        xSemaphoreTake(xStorageMutex, portMAX_DELAY);
+        unsigned long now = millis();
+        for (int i = 0; i < STORAGE_MAX_FILES; i++)
+        {
+            StorageFile_t *f = &files[i];
+            if (f->inUse && f->used > 0 && f->policy.maxDelayMs > 0 &&
+                now - f->firstAppend >= f->policy.maxDelayMs)
+            {
+                flushLocked(f);
+            }
+        }
+        xSemaphoreGive(xStorageMutex);
+
+        vTaskDelay(pdMS_TO_TICKS(250));
+    }
+}
+
+typedef struct {
+    const char *name;
+    int fileCount;
+    size_t recordSize;
+    int count;
+    size_t bufferSize;          // 0 = direct appends
+} StorageBenchmarkPattern_t;
+
+typedef struct {
+    unsigned long elapsedUs;    // appends plus the final syncs
+    unsigned long worstUs;      // slowest single append
+    float kbPerSecond;
+    StorageStats_t total;       // summed over the pattern's files
+    uint32_t blockErases;       // estimated, from the programmed bytes
+    size_t usedBytes;           // partition space the files took
+} StorageBenchmarkResult_t;
+
+// The access patterns storage_benchmark() measures, also run by the host suite
+static const StorageBenchmarkPattern_t benchmarkPatterns[] = {
+    {"direct 32 B", 1, 32, 200, 0},
+    {"coalesced 32 B", 1, 32, 200, STORAGE_BLOCK_SIZE},
+    {"direct 256 B", 1, 256, 100, 0},
+    {"coalesced 256 B", 1, 256, 100, STORAGE_BLOCK_SIZE},
+    {"direct 4 files 32 B", 4, 32, 200, 0},
+    {"coalesced 4 files 32 B", 4, 32, 200, STORAGE_BLOCK_SIZE},
+    {"coalesced 4 files 1 KB", 4, 32, 200, 1024},
+};
+
+/**
+ * @brief Runs one benchmark pattern: `count` appends of `recordSize` bytes,
+ *        round robin over `fileCount` files, then a final sync.
+ */
+static StorageBenchmarkResult_t benchmarkPattern(const StorageBenchmarkPattern_t *pattern)
+{
+    StorageHandle_t handles[4];
+    char path[32];
+    uint8_t record[256];
+    memset(record, 0xA5, sizeof(record));
+    size_t recordSize = min(pattern->recordSize, sizeof(record));
+    int fileCount = min(pattern->fileCount, 4);
+    int count = pattern->count;
+
+    size_t usedBefore = LittleFS.usedBytes();
+    for (int i = 0; i < fileCount; i++)
+    {
+        snprintf(path, sizeof(path), "/bench/f%d.bin", i);
+        LittleFS.remove(path);
+        handles[i] = storage_open(path, NULL, pattern->bufferSize);
+    }
+
+    StorageBenchmarkResult_t result = {};
+    unsigned long start = micros();
+    for (int i = 0; i < count; i++)
+    {
+        unsigned long t = micros();
+        storage_append(handles[i % fileCount], record, recordSize);
+        result.worstUs = max(result.worstUs, micros() - t);
+    }
+    for (int i = 0; i < fileCount; i++)
+    {
+        storage_sync(handles[i]);
+    }
+    result.elapsedUs = micros() - start;
+    size_t usedAfter = LittleFS.usedBytes();
+
+    for (int i = 0; i < fileCount; i++)
+    {
+        StorageStats_t stats;
+        storage_get_stats(handles[i], &stats);
+        result.total.flashWrites += stats.flashWrites;
+        result.total.bytesWritten += stats.bytesWritten;
+        result.total.estimatedFlashBytes += stats.estimatedFlashBytes;
+        storage_close(handles[i]);
+        snprintf(path, sizeof(path), "/bench/f%d.bin", i);
+        LittleFS.remove(path);
+    }
+
+    result.kbPerSecond = (float)(recordSize * count) * 1000.0f / 1024.0f / (result.elapsedUs / 1000.0f + 0.001f);
+    result.blockErases = (result.total.estimatedFlashBytes + STORAGE_BLOCK_SIZE - 1) / STORAGE_BLOCK_SIZE;
+    result.usedBytes = usedAfter > usedBefore ? usedAfter - usedBefore : 0;
+    return result;
+}
+
+void storage_benchmark()
+{
+    LittleFS.mkdir("/bench");
+    Serial.println("========================================");
+    Serial.println("STORAGE: LittleFS append benchmark");
+    Serial.println("========================================");
+    for (size_t i = 0; i < sizeof(benchmarkPatterns) / sizeof(benchmarkPatterns[0]); i++)
+    {
+        const StorageBenchmarkPattern_t *pattern = &benchmarkPatterns[i];
+        StorageBenchmarkResult_t result = benchmarkPattern(pattern);
+        Serial.printf("%-24s %6lu us/append (max %6lu) %7.1f KB/s %5lu writes  WA %5.2f  ~%4lu block erases  +%u B used\n",
+                      pattern->name, result.elapsedUs / pattern->count, result.worstUs, result.kbPerSecond,
+                      (unsigned long)result.total.flashWrites, storage_write_amplification(&result.total),
+                      (unsigned long)result.blockErases, (unsigned)result.usedBytes);
+    }
+    LittleFS.rmdir("/bench");
+}
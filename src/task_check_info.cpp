@@ -30,7 +30,7 @@ void Delete_info_File()
   {
     LittleFS.remove("/info.dat");
   }
-  ESP.restart();
+  snapshot_restart();
 }
 
 void Save_info_File(String wifi_ssid, String wifi_pass, String CORE_IOT_TOKEN, String CORE_IOT_SERVER, String CORE_IOT_PORT)
@@ -55,7 +55,7 @@ void Save_info_File(String wifi_ssid, String wifi_pass, String CORE_IOT_TOKEN, S
   {
     Serial.println('Unable to save the configuration.');
   }
-  ESP.restart();
+  snapshot_restart();
 };
 
 bool check_info_File(bool check)
@@ -1,11 +1,20 @@
 
 #include "task_core_iot.h"
 
-constexpr uint32_t MAX_MESSAGE_SIZE = 1024U;
+// Only has to fit the biggest message received from the server, bigger telemetry
+// is streamed into the client in BUFFERING_SIZE chunks by the ThingsBoard library
+constexpr uint32_t MAX_MESSAGE_SIZE = 256U;
+constexpr size_t BUFFERING_SIZE = 128U;
 
 WiFiClient wifiClient;
+#if CORE_IOT_USE_WEBSOCKET
+// MQTT packets in binary WebSocket frames, as coreiot does
+WebSocketStreamClient wsClient(wifiClient, CORE_IOT_WEBSOCKET_PATH);
+Arduino_MQTT_Client mqttClient(wsClient);
+#else
 Arduino_MQTT_Client mqttClient(wifiClient);
-ThingsBoard tb(mqttClient, MAX_MESSAGE_SIZE);
+#endif
+ThingsBoard tb(mqttClient, MAX_MESSAGE_SIZE, Default_Max_Stack_Size, BUFFERING_SIZE);
 
 constexpr char LED_STATE_ATTR[] = "ledState";
 
@@ -83,7 +92,11 @@ void CORE_IOT_reconnect()
 {
     if (!tb.connected())
     {
-        if (!tb.connect(CORE_IOT_SERVER.c_str(), CORE_IOT_TOKEN.c_str(), CORE_IOT_PORT.toInt()))
+        // Resolved through the DNS cache, static because the client keeps the pointer
+        static String address;
+        IPAddress ip;
+        address = dns_cache_resolve(CORE_IOT_SERVER.c_str(), ip, NULL) ? ip.toString() : CORE_IOT_SERVER;
+        if (!tb.connect(address.c_str(), CORE_IOT_TOKEN.c_str(), CORE_IOT_PORT.toInt()))
         {
             // Serial.println("Failed to connect");
             return;
@@ -58,4 +58,19 @@ void handleWebSocketMessage(String message)
         String msg = "{\"status\":\"ok\",\"page\":\"setting_saved\"}";
         ws.textAll(msg);
     }
+    else if (doc["page"] == "events")
+    {
+        // Same params and result as the "getEvents" RPC
+        String msg = "{\"page\":\"events\",\"value\":" + journal_query_json(value) + "}";
+        ws.textAll(msg);
+    }
+    else if (doc["page"] == "profile")
+    {
+        // Same params and result as the startProfile / stopProfile / getProfile RPCs
+        String action = value["action"] | "status";
+        String status = action == "start" ? cpu_profile_start_json(value)
+                        : action == "stop" ? cpu_profile_stop_json()
+                                           : cpu_profile_status_json();
+        ws.textAll("{\"page\":\"profile\",\"value\":" + status + "}");
+    }
 }
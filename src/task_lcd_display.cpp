@@ -4,6 +4,22 @@
 // We declare it as extern to use it here
 LiquidCrystal_I2C lcd_display(0x27, 16, 2);  // Use standard I2C address 0x27
 
+// Display state survives warm restarts, a reboot in WARNING does not journal
+// a NORMAL -> WARNING change again
+static void saveDisplaySnapshot(void *buffer) {
+    uint8_t state = currentDisplayState;
+    memcpy(buffer, &state, sizeof(state));
+}
+
+static void restoreDisplaySnapshot(const void *buffer) {
+    uint8_t state;
+    memcpy(&state, buffer, sizeof(state));
+    if (state <= DISPLAY_STATE_CRITICAL && lock_take(xLCDStateSemaphore, portMAX_DELAY) == pdTRUE) {
+        currentDisplayState = (DisplayState_t)state;
+        lock_give(xLCDStateSemaphore);
+    }
+}
+
 /**
  * @brief TASK 3: LCD Display Task with State-Based Display
  * 
@@ -54,6 +70,8 @@ void lcd_display_task(void *pvParameters) {
     
     // Initialize LCD
     // Note: We create our own LCD instance to avoid conflicts
+    // The bus is shared with the DHT20, every LCD update holds xI2CMutex
+    lock_take(xI2CMutex, portMAX_DELAY);
     lcd_display.begin();
     lcd_display.backlight();
     lcd_display.clear();
@@ -72,17 +90,19 @@ void lcd_display_task(void *pvParameters) {
     lcd_display.print("LCD Task Ready");
     lcd_display.setCursor(0, 1);
     lcd_display.print("Waiting data...");
+    lock_give(xI2CMutex);
     
     // Local variables (NO GLOBALS USED!)
     SensorData_t receivedData;
-    DisplayState_t previousState = DISPLAY_STATE_NORMAL;
+    snapshot_register("lcd", 1, sizeof(uint8_t), saveDisplaySnapshot, restoreDisplaySnapshot);
+    DisplayState_t previousState = currentDisplayState;
     bool flashState = false;
     unsigned long lastUpdate = 0;
     uint16_t updateInterval = 5000;  // Default update interval
     
     while (1) {
         // RECEIVE DATA FROM QUEUE (replaces reading global variables)
-        if (xQueueReceive(xSensorDataQueue, &receivedData, pdMS_TO_TICKS(500)) == pdTRUE) {
+        if (lock_receive(xSensorDataQueue, &receivedData, pdMS_TO_TICKS(500)) == pdTRUE) {
             
             // Extract sensor data from queue
             float temperature = receivedData.temperature;
@@ -120,7 +140,7 @@ void lcd_display_task(void *pvParameters) {
             }
             
             // USE MUTEX SEMAPHORE to protect state change
-            if (xSemaphoreTake(xLCDStateSemaphore, pdMS_TO_TICKS(100)) == pdTRUE) {
+            if (lock_take(xLCDStateSemaphore, pdMS_TO_TICKS(100)) == pdTRUE) {
                 
                 // Check if state changed
                 if (newState != previousState) {
@@ -142,6 +162,12 @@ void lcd_display_task(void *pvParameters) {
                     
                     // Semaphore "given" on state change (signal event)
                     Serial.println(">>> LCD Task: Display state semaphore signaled <<<");
+                    journal_log(EVENT_LCD_STATE_CHANGE, newState, temperature);
+
+                    // Escalations record the readings around them
+                    if (newState > previousState) {
+                        capture_trigger(newState == DISPLAY_STATE_CRITICAL ? CAPTURE_TRIGGER_CRITICAL : CAPTURE_TRIGGER_WARNING, temperature);
+                    }
                 }
                 
                 // Update global state (protected by mutex)
@@ -149,13 +175,14 @@ void lcd_display_task(void *pvParameters) {
                 previousState = newState;
                 
                 // Release mutex
-                xSemaphoreGive(xLCDStateSemaphore);
+                lock_give(xLCDStateSemaphore);
                 
             } else {
                 Serial.println("LCD Task: Warning - Could not acquire mutex");
             }
             
             // UPDATE LCD DISPLAY based on current state
+            lock_take(xI2CMutex, portMAX_DELAY);
             lcd_display.clear();
             
             switch (newState) {
@@ -218,6 +245,7 @@ void lcd_display_task(void *pvParameters) {
                     Serial.println("LCD Display: CRITICAL mode - Values outside safe range!");
                     break;
             }
+            lock_give(xI2CMutex);
             
             lastUpdate = millis();
         }
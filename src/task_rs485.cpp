@@ -79,60 +79,69 @@ void Task_Read_Sensor(void *pvParameters)
     }
 }
 
-void Task_Send_data(void *pvParameters)
+// Relay ON command template
+static const uint8_t relay_ON[][8] = {
+    {1, 5, 0, 0, 255, 0, 140, 58},  // Relay 0 ON
+    {1, 5, 0, 1, 255, 0, 221, 250}, // Relay 1 ON
+    {1, 5, 0, 2, 255, 0, 45, 250},  // Relay 2 ON
+    {1, 5, 0, 3, 255, 0, 124, 58},  // Relay 3 ON
+    {1, 5, 0, 31, 255, 0, 189, 252} // Relay ALL ON
+};
+
+// Relay OFF command template
+static const uint8_t relay_OFF[][8] = {
+    {1, 5, 0, 0, 0, 0, 205, 202}, // Relay 0 OFF
+    {1, 5, 0, 1, 0, 0, 156, 10},  // Relay 1 OFF
+    {1, 5, 0, 2, 0, 0, 108, 10},  // Relay 2 OFF
+    {1, 5, 0, 3, 0, 0, 61, 202},  // Relay 3 OFF
+    {1, 5, 0, 31, 0, 0, 252, 207} // Relay ALL OFF
+};
+
+/**
+ * @brief Switches one relay, param as for SCHEDULE_ACTION_RELAY. With
+ *        RELAY_SEQUENCE set it is a step of the on / off cycle and schedules
+ *        the next step, so the cycle holds no task while it waits.
+ */
+static void relayJob(void *arg)
 {
-    // Relay ON command template
-    const uint8_t relay_ON[][8] = {
-        {1, 5, 0, 0, 255, 0, 140, 58},  // Relay 0 ON
-        {1, 5, 0, 1, 255, 0, 221, 250}, // Relay 1 ON
-        {1, 5, 0, 2, 255, 0, 45, 250},  // Relay 2 ON
-        {1, 5, 0, 3, 255, 0, 124, 58},  // Relay 3 ON
-        {1, 5, 0, 31, 255, 0, 189, 252} // Relay ALL ON
-    };
-
-    // Relay OFF command template
-    const uint8_t relay_OFF[][8] = {
-        {1, 5, 0, 0, 0, 0, 205, 202}, // Relay 0 OFF
-        {1, 5, 0, 1, 0, 0, 156, 10},  // Relay 1 OFF
-        {1, 5, 0, 2, 0, 0, 108, 10},  // Relay 2 OFF
-        {1, 5, 0, 3, 0, 0, 61, 202},  // Relay 3 OFF
-        {1, 5, 0, 31, 0, 0, 252, 207} // Relay ALL OFF
-    };
-    bool state = false; // false = bật, true = tắt
+    uint16_t param = (uint16_t)(uintptr_t)arg;
+    uint8_t relay = param & 0xFF;
+    bool on = (param >> 8) & 0x01;
+    int index = (relay == RELAY_ALL) ? 4 : relay;
+    if (index > 4)
+    {
+        return;
+    }
+    bool sequence = (param & RELAY_SEQUENCE) != 0;
+    if (sequence && relay == 0)
+    {
+        Serial.println(on ? "🟢 Đang bật từng relay..." : "🔴 Đang tắt từng relay...");
+    }
 
-    while (true)
+    sendModbusCommand(on ? relay_ON[index] : relay_OFF[index], sizeof(relay_ON[index]));
+    Serial.println((on ? "Bật relay " : "Tắt relay ") + String(relay));
+
+    if (!sequence)
+    {
+        return;
+    }
+    if (relay < RELAY_COUNT - 1)
     {
-        if (!state)
-        {
-            Serial.println("🟢 Đang bật từng relay...");
-            for (int i = 0; i < 4; i++)
-            {
-                sendModbusCommand(relay_ON[i], sizeof(relay_ON[i]));
-                Serial.println("Bật relay " + String(i));
-                vTaskDelay(1000 / portTICK_PERIOD_MS); // Giữ 1 giây giữa mỗi lần bật
-            }
-        }
-        else
-        {
-            Serial.println("🔴 Đang tắt từng relay...");
-            for (int i = 0; i < 4; i++)
-            {
-                sendModbusCommand(relay_OFF[i], sizeof(relay_OFF[i]));
-                Serial.println("Tắt relay " + String(i));
-                vTaskDelay(1000 / portTICK_PERIOD_MS); // Giữ 1 giây giữa mỗi lần tắt
-            }
-        }
-
-        if (!state)
-            Serial.println("✅ Hoàn tất bật tất cả relay!");
-        else
-            Serial.println("✅ Hoàn tất tắt tất cả relay!");
-
-        // Đảo trạng thái cho lần kế tiếp
-        state = !state;
-
-        // Nghỉ giữa 2 chu kỳ (3 giây)
-        vTaskDelay(3000 / portTICK_PERIOD_MS);
+        // Giữ 1 giây giữa mỗi lần bật / tắt
+        scheduler_after(RELAY_STEP_MS, SCHEDULE_ACTION_RELAY, RELAY_SEQUENCE | (on << 8) | (relay + 1));
+        return;
+    }
+    Serial.println(on ? "✅ Hoàn tất bật tất cả relay!" : "✅ Hoàn tất tắt tất cả relay!");
+    // Nghỉ giữa 2 chu kỳ, rồi đảo trạng thái
+    scheduler_after(RELAY_STEP_MS + RELAY_CYCLE_PAUSE_MS, SCHEDULE_ACTION_RELAY, RELAY_SEQUENCE | (!on << 8));
+}
+
+static void relayAction(int32_t param)
+{
+    // The Modbus write waits for the bus, keep it off the scheduler's dispatcher
+    if (!executor_submit(relayJob, (void *)(intptr_t)param, EXECUTOR_PRIORITY_HIGH))
+    {
+        Serial.println("[RS485] Executor full, relay command dropped");
     }
 }
 
@@ -140,5 +149,7 @@ void tasksensor_init()
 {
     RS485Serial.begin(9600, SERIAL_8N1, TXD_RS485, RXD_RS485);
     xTaskCreate(Task_Read_Sensor, "Task_Read_Sensor", 4096, NULL, 1, NULL);
-    xTaskCreate(Task_Send_data, "Task_Send_data", 4096, NULL, 1, NULL);
-}
\ No newline at end of file
+    scheduler_set_action(SCHEDULE_ACTION_RELAY, relayAction);
+    // Relay on / off cycle, stepped by the scheduler and run on the executor
+    relayAction(RELAY_SEQUENCE | (1 << 8));
+}
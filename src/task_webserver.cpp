@@ -18,6 +18,13 @@ void Webserver_sendata(String data)
     }
 }
 
+static void webSocketJob(void *arg)
+{
+    char *message = (char *)arg;
+    handleWebSocketMessage(String(message));
+    free(message);
+}
+
 void onEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType type, void *arg, uint8_t *data, size_t len)
 {
     if (type == WS_EVT_CONNECT)
@@ -34,10 +41,14 @@ void onEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType
 
         if (info->opcode == WS_TEXT)
         {
-            String message;
-            message += String((char *)data).substring(0, len);
-            // parseJson(message, true);
-            handleWebSocketMessage(message);
+            // Parsing and the handlers (flash writes among them) run on the executor,
+            // the AsyncTCP task only copies the frame
+            char *message = strndup((char *)data, len);
+            if (message == NULL || !executor_submit(webSocketJob, message))
+            {
+                Serial.println("⚠️ WebSocket message dropped, executor busy");
+                free(message);
+            }
         }
     }
 }
@@ -46,14 +57,29 @@ void connnectWSV()
 {
     ws.onEvent(onEvent);
     server.addHandler(&ws);
+    // Dashboard is a single gzipped bundle in flash (tools/build_dashboard.py),
+    // so it loads in one request and without any CDN
     server.on("/", HTTP_GET, [](AsyncWebServerRequest *request)
-              { request->send(LittleFS, "/index.html", "text/html"); });
-    server.on("/script.js", HTTP_GET, [](AsyncWebServerRequest *request)
-              { request->send(LittleFS, "/script.js", "application/javascript"); });
-    server.on("/styles.css", HTTP_GET, [](AsyncWebServerRequest *request)
-              { request->send(LittleFS, "/styles.css", "text/css"); });
+              {
+                  AsyncWebServerResponse *response = request->beginResponse_P(200, "text/html", DASHBOARD_HTML, sizeof(DASHBOARD_HTML));
+                  response->addHeader("Content-Encoding", "gzip");
+                  request->send(response); });
+    // Lock contention profile in the Prometheus text format
+    server.on("/metrics", HTTP_GET, [](AsyncWebServerRequest *request)
+              { request->send(200, "text/plain; version=0.0.4", lock_profile_metrics()); });
+    // Firmware image for the peers of the site, with range requests
+    peer_ota_register(server);
+    // Stopped CPU profile, for tools/profile_flamegraph.py
+    cpu_profile_register(server);
     server.begin();
     ElegantOTA.begin(&server);
+    // ElegantOTA restarts shortly after a successful update, keep the derived state
+    ElegantOTA.onEnd([](bool success)
+                     {
+                         if (success)
+                         {
+                             snapshot_save(SNAPSHOT_TARGET_RTC | SNAPSHOT_TARGET_FLASH);
+                         } });
     webserver_isrunning = true;
 }
 
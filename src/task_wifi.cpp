@@ -26,10 +26,13 @@ void startSTA()
         WiFi.begin(WIFI_SSID.c_str(), WIFI_PASS.c_str());
     }
 
+    // Reported if the wait outlasts the stall deadline of the calling task
+    stall_set_state("wifi connect");
     while (WiFi.status() != WL_CONNECTED)
     {
         vTaskDelay(100 / portTICK_PERIOD_MS);
     }
+    stall_set_state(NULL);
     //Give a semaphore here
     xSemaphoreGive(xBinarySemaphoreInternet);
 }
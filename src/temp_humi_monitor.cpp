@@ -2,6 +2,58 @@
 DHT20 dht20;
 LiquidCrystal_I2C lcd(33,16,2);
 
+// Last good reading and failure state, kept across warm restarts so the first
+// telemetry after a reboot is not a burst of zeros
+typedef struct {
+    float temperature;
+    float humidity;
+    bool sensorFailed;
+} SensorSnapshot_t;
+
+static bool sensorFailed = false;
+
+static void saveSensorSnapshot(void *buffer)
+{
+    SensorSnapshot_t snapshot = {glob_temperature, glob_humidity, sensorFailed};
+    memcpy(buffer, &snapshot, sizeof(snapshot));
+}
+
+static void restoreSensorSnapshot(const void *buffer)
+{
+    SensorSnapshot_t snapshot;
+    memcpy(&snapshot, buffer, sizeof(snapshot));
+    glob_temperature = snapshot.temperature;
+    glob_humidity = snapshot.humidity;
+    sensorFailed = snapshot.sensorFailed;
+}
+
+/**
+ * @brief Stall recovery of the sensor task, runs on the executor. Clocks out a
+ *        slave that holds SDA low after a cut transfer, then restarts the I2C
+ *        driver (shared with the LCD). The stalled sensor task usually still
+ *        holds xI2CMutex from its read, so the wait for it is bounded.
+ */
+static void resetSensorBus(void *arg)
+{
+    bool locked = lock_take(xI2CMutex, pdMS_TO_TICKS(SENSOR_BUS_RESET_WAIT_MS)) == pdTRUE;
+    Wire.end();
+    pinMode(SENSOR_SDA, INPUT_PULLUP);
+    pinMode(SENSOR_SCL, OUTPUT_OPEN_DRAIN);
+    for (int i = 0; i < 9 && digitalRead(SENSOR_SDA) == LOW; i++)
+    {
+        digitalWrite(SENSOR_SCL, LOW);
+        delayMicroseconds(5);
+        digitalWrite(SENSOR_SCL, HIGH);
+        delayMicroseconds(5);
+    }
+    Wire.begin(SENSOR_SDA, SENSOR_SCL);
+    if (locked)
+    {
+        lock_give(xI2CMutex);
+    }
+    Serial.printf("TEMP Task: I2C bus reset after a stall%s\n", locked ? "" : ", bus still held by a stuck transfer");
+}
+
 /**
  * @brief Temperature and Humidity Monitoring Task with Semaphore Signaling
  * 
@@ -10,6 +62,8 @@ LiquidCrystal_I2C lcd(33,16,2);
  * 
  * FUNCTIONALITY:
  * 1. Reads temperature and humidity from DHT20 sensor every 5 seconds
+ *    (every CAPTURE_PERIOD_MS for the pre-trigger capture ring, the rest of
+ *    the pipeline only uses every few of those reads)
  * 2. Updates global variables (glob_temperature, glob_humidity)
  * 3. Signals the LED task via xTempUpdateSemaphore
  * 4. Handles sensor read failures gracefully
@@ -30,39 +84,78 @@ LiquidCrystal_I2C lcd(33,16,2);
 
 void temp_humi_monitor(void *pvParameters){
 
-    Wire.begin(11, 12);
+    lock_take(xI2CMutex, portMAX_DELAY);
+    Wire.begin(SENSOR_SDA, SENSOR_SCL);
     Serial.begin(115200);
     dht20.begin();
+    lock_give(xI2CMutex);
     
     Serial.println("Temperature/Humidity Monitor Task Started");
     Serial.println("Sensor: DHT20");
     Serial.println("Update interval: 5 seconds");
+    Serial.printf("Capture interval: %u ms\n", CAPTURE_PERIOD_MS);
     Serial.println("----------------------------------------");
 
+    snapshot_register("sensor", 1, sizeof(SensorSnapshot_t), saveSensorSnapshot, restoreSensorSnapshot);
+    stall_register(SENSOR_STALL_MS, STALL_RECOVER_HANDLER, resetSensorBus);
+
+    // Reads per 5 second update of the other tasks
+    const uint8_t readsPerUpdate = max(1, 5000 / CAPTURE_PERIOD_MS);
+    uint8_t reads = 0;
+    TickType_t lastWake = xTaskGetTickCount();
+
     while (1){
         /* Read sensor data */
-        
-        dht20.read();
+        stall_heartbeat();
+        unsigned long passStart = micros();
+        stall_set_state("dht20 read");
+        lock_take(xI2CMutex, portMAX_DELAY);
+        int status = dht20.read();
+        lock_give(xI2CMutex);
+        stall_set_state(NULL);
         // Reading temperature in Celsius
         float temperature = dht20.getTemperature();
         // Reading humidity
         float humidity = dht20.getHumidity();
 
-        
+        // Every read goes into the capture ring, also the ones skipped below
+        capture_add(status == DHT20_OK ? temperature : NAN, status == DHT20_OK ? humidity : NAN);
+        if (++reads < readsPerUpdate) {
+            vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(CAPTURE_PERIOD_MS));
+            continue;
+        }
+        reads = 0;
 
         // Check if any reads failed and exit early
         if (isnan(temperature) || isnan(humidity)) {
             Serial.println("TEMP Task: Failed to read from DHT sensor!");
             temperature = humidity =  -1;
+            // Journal only the first failed read, not every retry
+            if (!sensorFailed) {
+                journal_log(EVENT_SENSOR_FAILURE);
+                sensorFailed = true;
+            }
             //return;
         }
         else {
+            sensorFailed = false;
+
             // Successfully read sensor data
             
             //Update global variables for temperature and humidity
             glob_temperature = temperature;
             glob_humidity = humidity;
 
+            // Every sample goes into the window sketches for distribution telemetry
+            if (xSemaphoreTake(xSketchMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+                sketch_add(&tempWindowSketch, temperature);
+                sketch_add(&humiWindowSketch, humidity);
+                xSemaphoreGive(xSketchMutex);
+            }
+
+            // Raw history, e.g. for re-scoring with a new anomaly model
+            history_append(temperature, humidity);
+
             // Print the results
             Serial.println("----------------------------------------");
             Serial.print("TEMP Task: Humidity: ");
@@ -75,14 +168,14 @@ void temp_humi_monitor(void *pvParameters){
             // This allows tasks to immediately respond to sensor changes
             
             // TASK 1: Notify LED task of temperature update
-            if (xSemaphoreGive(xTempUpdateSemaphore) == pdTRUE) {
+            if (lock_give(xTempUpdateSemaphore) == pdTRUE) {
                 Serial.println("TEMP Task: Temperature semaphore given - LED task notified");
             } else {
                 Serial.println("TEMP Task: Warning - Failed to give temperature semaphore");
             }
             
             // TASK 2: Notify NeoPixel task of humidity update
-            if (xSemaphoreGive(xHumidityUpdateSemaphore) == pdTRUE) {
+            if (lock_give(xHumidityUpdateSemaphore) == pdTRUE) {
                 Serial.println("TEMP Task: Humidity semaphore given - NeoPixel task notified");
             } else {
                 Serial.println("TEMP Task: Warning - Failed to give humidity semaphore");
@@ -94,7 +187,7 @@ void temp_humi_monitor(void *pvParameters){
             sensorData.humidity = humidity;
             sensorData.timestamp = millis();
             
-            if (xQueueSend(xSensorDataQueue, &sensorData, pdMS_TO_TICKS(100)) == pdTRUE) {
+            if (lock_send(xSensorDataQueue, &sensorData, pdMS_TO_TICKS(100)) == pdTRUE) {
                 Serial.println("TEMP Task: Sensor data sent to queue");
             } else {
                 Serial.println("TEMP Task: Warning - Queue full, data not sent");
@@ -102,9 +195,10 @@ void temp_humi_monitor(void *pvParameters){
             
             Serial.println("----------------------------------------");
         }
+        canary_record(CANARY_SENSOR_LOOP_MS, (micros() - passStart) / 1000.0f);
         
-        // Wait 5 seconds before next reading
-        vTaskDelay(5000);
+        // Fixed period, the capture samples stay evenly spaced
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(CAPTURE_PERIOD_MS));
     }
     
 }
\ No newline at end of file
@@ -0,0 +1,223 @@
+#include "timer_wheel.h"
+
+#define SLOT_MASK (TIMER_WHEEL_SLOTS - 1)
+
+static inline uint32_t levelShift(int level)
+{
+    return level * TIMER_WHEEL_SLOT_BITS;
+}
+
+static inline uint16_t handleIndex(TimerWheelHandle_t handle)
+{
+    return (uint16_t)(handle & 0xFFFF);
+}
+
+/**
+ * @brief Links a node into the slot for its expiry, relative to the current tick.
+ */
+static void placeNode(TimerWheel_t *wheel, uint16_t index)
+{
+    TimerNode_t *node = &wheel->nodes[index];
+    uint32_t delta = node->expires - wheel->now;
+
+    int level = 0;
+    while (level < TIMER_WHEEL_LEVELS - 1 && delta >= (1UL << levelShift(level + 1)))
+    {
+        level++;
+    }
+    uint32_t slot = (node->expires >> levelShift(level)) & SLOT_MASK;
+
+    node->prev = TIMER_WHEEL_NONE;
+    node->next = wheel->heads[level][slot];
+    if (node->next != TIMER_WHEEL_NONE)
+    {
+        wheel->nodes[node->next].prev = index;
+    }
+    wheel->heads[level][slot] = index;
+    wheel->occupied[level] |= 1ULL << slot;
+}
+
+/**
+ * @brief Unlinks a node from whichever slot list it is in.
+ */
+static void unlinkNode(TimerWheel_t *wheel, uint16_t index)
+{
+    TimerNode_t *node = &wheel->nodes[index];
+    if (node->prev != TIMER_WHEEL_NONE)
+    {
+        wheel->nodes[node->prev].next = node->next;
+    }
+    else
+    {
+        // Head of its list, find the slot it heads (same rule as placeNode)
+        for (int level = 0; level < TIMER_WHEEL_LEVELS; level++)
+        {
+            uint32_t slot = (node->expires >> levelShift(level)) & SLOT_MASK;
+            if (wheel->heads[level][slot] == index)
+            {
+                wheel->heads[level][slot] = node->next;
+                if (node->next == TIMER_WHEEL_NONE)
+                {
+                    wheel->occupied[level] &= ~(1ULL << slot);
+                }
+                break;
+            }
+        }
+    }
+    if (node->next != TIMER_WHEEL_NONE)
+    {
+        wheel->nodes[node->next].prev = node->prev;
+    }
+}
+
+static void freeNode(TimerWheel_t *wheel, uint16_t index)
+{
+    wheel->nodes[index].generation = 0;
+    wheel->nodes[index].next = wheel->freeList;
+    wheel->freeList = index;
+    wheel->active--;
+}
+
+void timer_wheel_init(TimerWheel_t *wheel, uint32_t now)
+{
+    memset(wheel, 0, sizeof(TimerWheel_t));
+    memset(wheel->heads, 0xFF, sizeof(wheel->heads));
+    wheel->now = now;
+    wheel->nextGeneration = 1;
+    for (uint16_t i = 0; i < TIMER_WHEEL_CAPACITY; i++)
+    {
+        wheel->nodes[i].next = (i + 1 < TIMER_WHEEL_CAPACITY) ? i + 1 : TIMER_WHEEL_NONE;
+    }
+    wheel->freeList = 0;
+}
+
+TimerWheelHandle_t timer_wheel_add(TimerWheel_t *wheel, uint32_t delay, uint8_t action, uint16_t arg)
+{
+    uint16_t index = wheel->freeList;
+    if (index == TIMER_WHEEL_NONE)
+    {
+        return TIMER_WHEEL_INVALID_HANDLE;
+    }
+    TimerNode_t *node = &wheel->nodes[index];
+    wheel->freeList = node->next;
+    wheel->active++;
+
+    node->expires = wheel->now + constrain(delay, (uint32_t)1, (uint32_t)TIMER_WHEEL_MAX_DELAY);
+    node->action = action;
+    node->arg = arg;
+    node->generation = wheel->nextGeneration;
+    wheel->nextGeneration = (wheel->nextGeneration == 255) ? 1 : wheel->nextGeneration + 1;
+    placeNode(wheel, index);
+
+    return ((TimerWheelHandle_t)node->generation << 16) | index;
+}
+
+bool timer_wheel_cancel(TimerWheel_t *wheel, TimerWheelHandle_t handle)
+{
+    uint16_t index = handleIndex(handle);
+    if (index >= TIMER_WHEEL_CAPACITY || wheel->nodes[index].generation == 0 ||
+        wheel->nodes[index].generation != (uint8_t)(handle >> 16))
+    {
+        return false;
+    }
+    unlinkNode(wheel, index);
+    freeNode(wheel, index);
+    return true;
+}
+
+/**
+ * @brief Re-places every timer of a higher level slot relative to the current tick.
+ */
+static void cascade(TimerWheel_t *wheel, int level, uint32_t slot)
+{
+    uint16_t index = wheel->heads[level][slot];
+    wheel->heads[level][slot] = TIMER_WHEEL_NONE;
+    wheel->occupied[level] &= ~(1ULL << slot);
+    while (index != TIMER_WHEEL_NONE)
+    {
+        uint16_t next = wheel->nodes[index].next;
+        placeNode(wheel, index);
+        index = next;
+    }
+}
+
+/**
+ * @brief Ticks from `now` to the next set bit of a level's occupancy, looking
+ *        at the slots after the current one up to the end of this rotation.
+ */
+static uint32_t ticksToOccupied(const TimerWheel_t *wheel, int level)
+{
+    uint32_t current = (wheel->now >> levelShift(level)) & SLOT_MASK;
+    uint64_t ahead = (current == SLOT_MASK) ? 0 : wheel->occupied[level] & (~0ULL << (current + 1));
+    if (ahead == 0)
+    {
+        return UINT32_MAX;
+    }
+    uint32_t slot = __builtin_ctzll(ahead);
+    // Start of that slot in ticks
+    uint32_t base = (wheel->now >> levelShift(level + 1)) << levelShift(level + 1);
+    return base + (slot << levelShift(level)) - wheel->now;
+}
+
+uint32_t timer_wheel_ticks_to_next(const TimerWheel_t *wheel)
+{
+    if (wheel->active == 0)
+    {
+        return UINT32_MAX;
+    }
+    uint32_t best = UINT32_MAX;
+    for (int level = 0; level < TIMER_WHEEL_LEVELS; level++)
+    {
+        if (wheel->occupied[level] == 0)
+        {
+            continue;
+        }
+        best = min(best, ticksToOccupied(wheel, level));
+        // Slots at or behind the current position are reached by the next
+        // rotation, which begins at the next boundary of the level above
+        uint32_t span = 1UL << levelShift(level + 1);
+        best = min(best, span - (wheel->now & (span - 1)));
+    }
+    return best;
+}
+
+uint32_t timer_wheel_advance(TimerWheel_t *wheel, uint32_t to, TimerWheelCallback_t callback)
+{
+    uint32_t fired = 0;
+    while ((int32_t)(to - wheel->now) > 0)
+    {
+        // Jump straight to the next tick that has work, or to `to`
+        uint32_t step = timer_wheel_ticks_to_next(wheel);
+        step = min(max(step, (uint32_t)1), to - wheel->now);
+        wheel->now += step;
+
+        // Every wrap of a level moves the matching slot of the level above down
+        for (int level = 1; level < TIMER_WHEEL_LEVELS; level++)
+        {
+            if ((wheel->now & ((1UL << levelShift(level)) - 1)) != 0)
+            {
+                break;
+            }
+            cascade(wheel, level, (wheel->now >> levelShift(level)) & SLOT_MASK);
+        }
+
+        // Due timers are taken off the head of the slot one at a time, a
+        // callback may cancel the others or add timers while the list is walked
+        uint32_t slot = wheel->now & SLOT_MASK;
+        uint16_t index;
+        while ((index = wheel->heads[0][slot]) != TIMER_WHEEL_NONE)
+        {
+            TimerNode_t *node = &wheel->nodes[index];
+            uint8_t action = node->action;
+            uint16_t arg = node->arg;
+            unlinkNode(wheel, index);
+            freeNode(wheel, index);
+            fired++;
+            if (callback != NULL)
+            {
+                callback(action, arg);
+            }
+        }
+    }
+    return fired;
+}
@@ -9,7 +9,54 @@ namespace
     TfLiteTensor *input = nullptr;
     TfLiteTensor *output = nullptr;
     constexpr int kTensorArenaSize = 8 * 1024; // Adjust size based on your model
-    uint8_t tensor_arena[kTensorArenaSize];
+    alignas(16) uint8_t tensor_arena[kTensorArenaSize];
+
+    /**
+     * @brief Writes a value into the input tensor, quantising it with the tensor's
+     *        scale and zero point when the model takes int8 / uint8 input.
+     */
+    bool setInput(TfLiteTensor *tensor, int index, float value)
+    {
+        switch (tensor->type)
+        {
+        case kTfLiteFloat32:
+            tensor->data.f[index] = value;
+            return true;
+        case kTfLiteInt8:
+        {
+            int32_t q = lroundf(value / tensor->params.scale) + tensor->params.zero_point;
+            tensor->data.int8[index] = (int8_t)constrain(q, -128, 127);
+            return true;
+        }
+        case kTfLiteUInt8:
+        {
+            int32_t q = lroundf(value / tensor->params.scale) + tensor->params.zero_point;
+            tensor->data.uint8[index] = (uint8_t)constrain(q, 0, 255);
+            return true;
+        }
+        default:
+            return false;
+        }
+    }
+
+    /**
+     * @brief Reads a value from the output tensor, dequantising it with the tensor's
+     *        scale and zero point when the model produces int8 / uint8 output.
+     */
+    float getOutput(TfLiteTensor *tensor, int index)
+    {
+        switch (tensor->type)
+        {
+        case kTfLiteFloat32:
+            return tensor->data.f[index];
+        case kTfLiteInt8:
+            return (tensor->data.int8[index] - tensor->params.zero_point) * tensor->params.scale;
+        case kTfLiteUInt8:
+            return (tensor->data.uint8[index] - tensor->params.zero_point) * tensor->params.scale;
+        default:
+            return NAN;
+        }
+    }
 } // namespace
 
 void setupTinyML()
@@ -18,7 +65,7 @@ void setupTinyML()
     static tflite::MicroErrorReporter micro_error_reporter;
     error_reporter = &micro_error_reporter;
 
-    model = tflite::GetModel(dht_anomaly_model_tflite); // g_model_data is from model_data.h
+    model = tflite::GetModel(DHT_ANOMALY_MODEL); // float or int8 model, see tinyml.h
     if (model->version() != TFLITE_SCHEMA_VERSION)
     {
         error_reporter->Report("Model provided is schema version %d, not equal to supported version %d.",
@@ -41,35 +88,216 @@ void setupTinyML()
     input = interpreter->input(0);
     output = interpreter->output(0);
 
-    Serial.println("TensorFlow Lite Micro initialized on ESP32.");
+    Serial.printf("TensorFlow Lite Micro initialized on ESP32 (%s model, arena used %u of %u bytes).\n",
+                  TfLiteTypeGetName(input->type), (unsigned)interpreter->arena_used_bytes(), (unsigned)kTensorArenaSize);
+}
+
+// Whether the last inference was anomalous, kept across warm restarts so an
+// ongoing anomaly is not journaled again after a reboot
+static bool anomaly = false;
+
+static void saveAnomalySnapshot(void *buffer)
+{
+    memcpy(buffer, &anomaly, sizeof(anomaly));
+}
+
+static void restoreAnomalySnapshot(const void *buffer)
+{
+    memcpy(&anomaly, buffer, sizeof(anomaly));
 }
 
 void tiny_ml_task(void *pvParameters)
 {
 
     setupTinyML();
+    if (input == nullptr)
+    {
+        vTaskDelete(NULL);
+    }
+    snapshot_register("anomaly", 1, sizeof(anomaly), saveAnomalySnapshot, restoreAnomalySnapshot);
 
     while (1)
     {
 
-        // Prepare input data (e.g., sensor readings)
-        // For a simple example, let's assume a single float input
-        input->data.f[0] = glob_temperature;
-        input->data.f[1] = glob_humidity;
+        // Prepare input data (e.g., sensor readings), quantised automatically for int8 models
+        if (!setInput(input, 0, glob_temperature) || !setInput(input, 1, glob_humidity))
+        {
+            error_reporter->Report("Unsupported input tensor type %s", TfLiteTypeGetName(input->type));
+            vTaskDelete(NULL);
+        }
 
         // Run inference
+        unsigned long start = micros();
         TfLiteStatus invoke_status = interpreter->Invoke();
+        unsigned long elapsed = micros() - start;
         if (invoke_status != kTfLiteOk)
         {
             error_reporter->Report("Invoke failed");
-            return;
+            vTaskDelete(NULL);
         }
 
         // Get and process output
-        float result = output->data.f[0];
-        Serial.print("Inference result: ");
-        Serial.println(result);
+        float result = getOutput(output, 0);
+        Serial.printf("Inference result: %.4f (%lu us)\n", result, elapsed);
+
+        // Journal the start of an anomaly, not every anomalous inference
+        if (result > TINYML_ANOMALY_THRESHOLD && !anomaly)
+        {
+            journal_log(EVENT_ANOMALY, 0, result);
+            capture_trigger(CAPTURE_TRIGGER_ANOMALY, result);
+        }
+        anomaly = result > TINYML_ANOMALY_THRESHOLD;
 
         vTaskDelay(5000);
     }
-}
\ No newline at end of file
+}
+// Backfill state, only one backfill runs at a time
+static TaskHandle_t backfillTask = NULL;
+static HistorySample_t backfillSamples[TINYML_BACKFILL_CHUNK];
+static float backfillScores[TINYML_BACKFILL_CHUNK];
+
+/**
+ * @brief FNV-1a of the model flatbuffer, identifies the model a score series belongs to.
+ */
+static uint32_t modelFingerprint(const unsigned char *data, size_t len)
+{
+    uint32_t hash = 2166136261UL;
+    for (size_t i = 0; i < len; i++)
+    {
+        hash = (hash ^ data[i]) * 16777619UL;
+    }
+    return hash;
+}
+
+/**
+ * @brief Scores one chunk of samples, `batch` samples per Invoke. A partial last
+ *        batch is padded with copies of its last sample.
+ */
+static bool scoreChunk(tflite::MicroInterpreter *backfill, int batch, const HistorySample_t *samples, float *scores,
+                       size_t count)
+{
+    TfLiteTensor *in = backfill->input(0);
+    TfLiteTensor *out = backfill->output(0);
+    for (size_t first = 0; first < count; first += batch)
+    {
+        for (int b = 0; b < batch; b++)
+        {
+            const HistorySample_t *sample = &samples[min(first + b, count - 1)];
+            if (!setInput(in, b * 2, history_temperature(sample)) || !setInput(in, b * 2 + 1, history_humidity(sample)))
+            {
+                return false;
+            }
+        }
+        if (backfill->Invoke() != kTfLiteOk)
+        {
+            return false;
+        }
+        for (int b = 0; b < batch && first + b < count; b++)
+        {
+            scores[first + b] = getOutput(out, b);
+        }
+    }
+    return true;
+}
+
+void tinyml_backfill_task(void *pvParameters)
+{
+    bool rescoreAll = pvParameters != NULL;
+    static tflite::MicroErrorReporter backfill_error_reporter;
+    static tflite::AllOpsResolver backfill_resolver;
+
+    // Own arena and interpreter, the live inference in tiny_ml_task is not touched
+    uint8_t *arena = (uint8_t *)malloc(TINYML_BACKFILL_ARENA_SIZE + 15);
+    uint8_t *alignedArena = (uint8_t *)(((uintptr_t)arena + 15) & ~(uintptr_t)15);
+    const tflite::Model *backfillModel = tflite::GetModel(DHT_ANOMALY_MODEL);
+    tflite::MicroInterpreter *backfill = NULL;
+    if (arena != NULL && backfillModel->version() == TFLITE_SCHEMA_VERSION)
+    {
+        backfill = new tflite::MicroInterpreter(backfillModel, backfill_resolver, alignedArena,
+                                                TINYML_BACKFILL_ARENA_SIZE, &backfill_error_reporter);
+    }
+    if (backfill == NULL || backfill->AllocateTensors() != kTfLiteOk)
+    {
+        Serial.println("[BACKFILL] Unable to set up the backfill interpreter");
+        delete backfill;
+        free(arena);
+        backfillTask = NULL;
+        vTaskDelete(NULL);
+        return;
+    }
+
+    // Input is [batch, 2], a batch model scores several samples per Invoke
+    TfLiteTensor *in = backfill->input(0);
+    int batch = (in->dims->size >= 2) ? max(in->dims->data[0], 1) : 1;
+
+    uint32_t modelId = modelFingerprint(DHT_ANOMALY_MODEL, sizeof(DHT_ANOMALY_MODEL));
+    if (rescoreAll)
+    {
+        history_drop_scores();
+    }
+    uint32_t first = history_scored(modelId);
+    Serial.printf("[BACKFILL] Scoring from sample %lu of %lu, batch %d, core %d\n", (unsigned long)first,
+                  (unsigned long)history_count(), batch, xPortGetCoreID());
+
+    uint32_t scored = 0;
+    uint32_t anomalies = 0;
+    int64_t busyUs = 0;
+    int64_t start = esp_timer_get_time();
+    while (1)
+    {
+        uint32_t generation = history_generation();
+        uint32_t index = history_scored(modelId);
+        size_t count = history_read(index, backfillSamples, TINYML_BACKFILL_CHUNK);
+        if (count == 0)
+        {
+            break;
+        }
+
+        int64_t chunkStart = esp_timer_get_time();
+        if (!scoreChunk(backfill, batch, backfillSamples, backfillScores, count))
+        {
+            Serial.println("[BACKFILL] Inference failed");
+            break;
+        }
+        busyUs += esp_timer_get_time() - chunkStart;
+
+        if (history_append_scores(generation, index, backfillScores, count))
+        {
+            scored += count;
+            for (size_t i = 0; i < count; i++)
+            {
+                anomalies += backfillScores[i] > TINYML_ANOMALY_THRESHOLD;
+            }
+        }
+        else if (history_generation() == generation)
+        {
+            // Not a rotation (which the next round recovers from by starting at
+            // the new index) but a failed write, e.g. a full partition
+            Serial.println("[BACKFILL] Unable to store the scores");
+            break;
+        }
+
+        // Lets the idle task of this core run, so its watchdog stays fed
+        vTaskDelay(1);
+    }
+
+    float seconds = (esp_timer_get_time() - start) / 1e6f;
+    Serial.printf("[BACKFILL] Scored %lu samples in %.2f s (%.0f samples/s, %.0f samples/s of inference), %lu anomalous\n",
+                  (unsigned long)scored, seconds, scored / max(seconds, 1e-3f), scored / max(busyUs / 1e6f, 1e-6f),
+                  (unsigned long)anomalies);
+
+    delete backfill;
+    free(arena);
+    backfillTask = NULL;
+    vTaskDelete(NULL);
+}
+
+bool tinyml_backfill_start(bool rescoreAll)
+{
+    if (backfillTask != NULL)
+    {
+        return false;
+    }
+    return xTaskCreatePinnedToCore(tinyml_backfill_task, "Task Backfill", 6144, rescoreAll ? (void *)1 : NULL,
+                                   TINYML_BACKFILL_PRIORITY, &backfillTask, TINYML_BACKFILL_CORE) == pdPASS;
+}
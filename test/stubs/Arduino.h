@@ -0,0 +1,250 @@
+// Host stand-in for the parts of the Arduino core the firmware uses, so its
+// modules build and run in the native test environment. Time comes from the
+// steady clock unless a test sets hostFakeMicros.
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <math.h>
+#include <time.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+
+using std::max;
+using std::min;
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define PROGMEM
+#define F(x) x
+#define PSTR(x) x
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_byte_near(p) (*(const uint8_t *)(p))
+#define pgm_read_dword(p) (*(const uint32_t *)(p))
+#define memcpy_P memcpy
+#define strlen_P strlen
+#define snprintf_P snprintf
+#define IRAM_ATTR
+#define RTC_NOINIT_ATTR
+#define RTC_DATA_ATTR
+#define DRAM_ATTR
+#define ARDUINO_ISR_ATTR
+
+#define HEX 16
+#define DEC 10
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define SERIAL_8N1 0
+
+#define isHexadecimalDigit(c) isxdigit(c)
+#define isSpace(c) isspace(c)
+#define isAlphaNumeric(c) isalnum(c)
+#define isAlpha(c) isalpha(c)
+#define isDigit(c) isdigit(c)
+#ifndef constrain
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#endif
+
+// >= 0: the time every clock function returns, advanced by the test
+inline int64_t hostFakeMicros = -1;
+
+inline int64_t hostMicros()
+{
+    if (hostFakeMicros >= 0)
+        return hostFakeMicros;
+    static const auto start = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+inline unsigned long millis() { return (unsigned long)(hostMicros() / 1000); }
+inline unsigned long micros() { return (unsigned long)hostMicros(); }
+inline void delay(unsigned long ms)
+{
+    if (hostFakeMicros >= 0)
+        hostFakeMicros += (int64_t)ms * 1000;
+    else
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+inline void delayMicroseconds(unsigned int us) { std::this_thread::sleep_for(std::chrono::microseconds(us)); }
+inline void yield() { std::this_thread::yield(); }
+inline uint32_t getCpuFrequencyMhz() { return 240; }
+
+// Hardware timers keep what they were set up with, alarms never fire on the
+// host: a test calls the attached handler itself
+typedef struct {
+    uint8_t num;
+    uint16_t divider;
+    uint64_t alarm;
+    bool enabled;
+    void (*isr)();
+} hw_timer_t;
+
+inline hw_timer_t hostTimers[4];
+
+inline hw_timer_t *timerBegin(uint8_t num, uint16_t divider, bool countUp)
+{
+    if (num >= 4)
+        return nullptr;
+    hostTimers[num] = {num, divider, 0, false, nullptr};
+    return &hostTimers[num];
+}
+inline void timerAttachInterrupt(hw_timer_t *timer, void (*isr)(), bool edge) { timer->isr = isr; }
+inline void timerDetachInterrupt(hw_timer_t *timer) { timer->isr = nullptr; }
+inline void timerAlarmWrite(hw_timer_t *timer, uint64_t alarm, bool autoreload) { timer->alarm = alarm; }
+inline void timerAlarmEnable(hw_timer_t *timer) { timer->enabled = true; }
+inline void timerAlarmDisable(hw_timer_t *timer) { timer->enabled = false; }
+inline void timerEnd(hw_timer_t *timer) {}
+
+inline long random(long howbig) { return howbig > 0 ? rand() % howbig : 0; }
+inline long random(long howsmall, long howbig) { return howsmall >= howbig ? howsmall : howsmall + rand() % (howbig - howsmall); }
+inline void randomSeed(unsigned long seed) { srand(seed); }
+inline uint32_t esp_random() { return ((uint32_t)rand() << 16) ^ (uint32_t)rand(); }
+
+inline int hostPinLevels[64];
+inline void pinMode(int, int) {}
+inline void digitalWrite(int pin, int level) { hostPinLevels[pin & 63] = level; }
+inline int digitalRead(int pin) { return hostPinLevels[pin & 63]; }
+
+class String
+{
+public:
+    String() {}
+    String(const char *c) : s(c ? c : "") {}
+    String(const std::string &v) : s(v) {}
+    String(char c) : s(1, c) {}
+    String(int v, unsigned char base = 10) { s = format(v, base); }
+    String(unsigned int v, unsigned char base = 10) { s = format(v, base); }
+    String(long v, unsigned char base = 10) { s = format(v, base); }
+    String(unsigned long v, unsigned char base = 10) { s = format(v, base); }
+    String(long long v) : s(std::to_string(v)) {}
+    String(unsigned long long v) : s(std::to_string(v)) {}
+    String(float v, unsigned int decimals = 2) { s = fixed(v, decimals); }
+    String(double v, unsigned int decimals = 2) { s = fixed(v, decimals); }
+
+    const char *c_str() const { return s.c_str(); }
+    // size_t as on the target, ArduinoJson takes a String by its length()
+    size_t length() const { return s.size(); }
+    bool isEmpty() const { return s.empty(); }
+    unsigned char reserve(unsigned int n) { s.reserve(n); return 1; }
+    char operator[](unsigned int i) const { return i < s.size() ? s[i] : 0; }
+    char charAt(unsigned int i) const { return (*this)[i]; }
+
+    String &operator+=(const String &o) { s += o.s; return *this; }
+    String &operator+=(const char *o) { s += o ? o : ""; return *this; }
+    String &operator+=(char c) { s += c; return *this; }
+    String &operator+=(int v) { s += std::to_string(v); return *this; }
+    String &operator+=(unsigned int v) { s += std::to_string(v); return *this; }
+    String &operator+=(long v) { s += std::to_string(v); return *this; }
+    String &operator+=(unsigned long v) { s += std::to_string(v); return *this; }
+    bool concat(const String &o) { s += o.s; return true; }
+    bool concat(const char *o) { s += o ? o : ""; return true; }
+    bool concat(char c) { s += c; return true; }
+    bool concat(const char *o, unsigned int n) { s.append(o, n); return true; }
+
+    bool operator==(const String &o) const { return s == o.s; }
+    bool operator==(const char *o) const { return s == (o ? o : ""); }
+    bool operator!=(const String &o) const { return s != o.s; }
+    bool operator!=(const char *o) const { return !(*this == o); }
+    bool operator<(const String &o) const { return s < o.s; }
+    bool equals(const String &o) const { return s == o.s; }
+    bool equalsIgnoreCase(const String &o) const { return strcasecmp(s.c_str(), o.s.c_str()) == 0; }
+    bool startsWith(const String &p) const { return s.rfind(p.s, 0) == 0; }
+    bool endsWith(const String &p) const { return s.size() >= p.s.size() && s.compare(s.size() - p.s.size(), p.s.size(), p.s) == 0; }
+
+    int indexOf(char c, unsigned int from = 0) const { size_t p = s.find(c, from); return p == std::string::npos ? -1 : (int)p; }
+    int indexOf(const String &o, unsigned int from = 0) const { size_t p = s.find(o.s, from); return p == std::string::npos ? -1 : (int)p; }
+    int lastIndexOf(char c) const { size_t p = s.rfind(c); return p == std::string::npos ? -1 : (int)p; }
+    String substring(unsigned int from) const { return from < s.size() ? String(s.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const { return from < s.size() && to > from ? String(s.substr(from, to - from)) : String(); }
+    void replace(const String &from, const String &to)
+    {
+        if (from.s.empty())
+            return;
+        for (size_t p = 0; (p = s.find(from.s, p)) != std::string::npos; p += to.s.size())
+            s.replace(p, from.s.size(), to.s);
+    }
+    void remove(unsigned int index) { if (index < s.size()) s.erase(index); }
+    void remove(unsigned int index, unsigned int count) { if (index < s.size()) s.erase(index, count); }
+    void trim()
+    {
+        size_t a = s.find_first_not_of(" \t\r\n");
+        size_t b = s.find_last_not_of(" \t\r\n");
+        s = (a == std::string::npos) ? std::string() : s.substr(a, b - a + 1);
+    }
+    void toLowerCase() { for (auto &c : s) c = tolower(c); }
+    void toUpperCase() { for (auto &c : s) c = toupper(c); }
+    long toInt() const { return atol(s.c_str()); }
+    float toFloat() const { return atof(s.c_str()); }
+    void getBytes(unsigned char *buf, unsigned int n) const { if (n) { size_t l = std::min((size_t)n - 1, s.size()); memcpy(buf, s.data(), l); buf[l] = 0; } }
+    void toCharArray(char *buf, unsigned int n) const { getBytes((unsigned char *)buf, n); }
+
+    // ArduinoJson writes into a String through these
+    size_t write(uint8_t c) { s += (char)c; return 1; }
+    size_t write(const uint8_t *b, size_t n) { s.append((const char *)b, n); return n; }
+
+private:
+    template <typename T>
+    static std::string format(T v, unsigned char base)
+    {
+        if (base == 10)
+            return std::to_string(v);
+        char buf[72];
+        unsigned long long u = (unsigned long long)(long long)v;
+        if (v < 0)
+            u = (unsigned long long)(unsigned long)v;
+        int i = sizeof(buf) - 1;
+        buf[i] = 0;
+        do
+        {
+            buf[--i] = "0123456789abcdefghijklmnopqrstuvwxyz"[u % base];
+            u /= base;
+        } while (u);
+        return buf + i;
+    }
+    static std::string fixed(double v, unsigned int decimals)
+    {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%.*f", (int)decimals, v);
+        return buf;
+    }
+
+    std::string s;
+};
+
+inline String operator+(const String &a, const String &b) { String r(a); r += b; return r; }
+inline String operator+(const String &a, const char *b) { String r(a); r += b; return r; }
+inline String operator+(const char *a, const String &b) { String r(a); r += b; return r; }
+inline String operator+(const String &a, char b) { String r(a); r += b; return r; }
+
+#include "Print.h"
+#include "Stream.h"
+#include "IPAddress.h"
+#include "Client.h"
+#include "HardwareSerial.h"
+
+struct HostEsp
+{
+    bool restarted = false;
+    void restart() { restarted = true; }
+    uint32_t getFreeHeap() { return 200000; }
+    uint32_t getMinFreeHeap() { return 150000; }
+    uint32_t getMaxAllocHeap() { return 100000; }
+    const char *getSdkVersion() { return "host"; }
+    const char *getSketchMD5() { return "00000000000000000000000000000000"; }
+};
+inline HostEsp ESP;
+
+#endif
@@ -0,0 +1,66 @@
+// Host stand-in for ESPAsyncWebServer: handlers are registered and a test
+// calls them with a request of its own, responses are kept on the request.
+#ifndef HOST_ESPASYNCWEBSERVER_H
+#define HOST_ESPASYNCWEBSERVER_H
+
+#include "Arduino.h"
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+
+typedef enum
+{
+    HTTP_GET = 1,
+    HTTP_POST = 2,
+} WebRequestMethod;
+
+typedef std::function<size_t(uint8_t *buffer, size_t maxLen, size_t index)> AwsResponseFiller;
+
+class AsyncWebServerResponse
+{
+public:
+    int code;
+    size_t length;
+    AwsResponseFiller filler;
+    std::map<std::string, std::string> headers;
+
+    AsyncWebServerResponse(int code, size_t length = 0, AwsResponseFiller filler = nullptr)
+        : code(code), length(length), filler(filler) {}
+    void setCode(int value) { code = value; }
+    void addHeader(const String &name, const String &value) { headers[name.c_str()] = value.c_str(); }
+};
+
+class AsyncWebServerRequest
+{
+public:
+    std::map<std::string, std::string> headers;
+    std::unique_ptr<AsyncWebServerResponse> response;
+    std::function<void()> disconnected;
+
+    bool hasHeader(const char *name) { return headers.count(name) > 0; }
+    String header(const char *name) { return hasHeader(name) ? String(headers[name].c_str()) : String(); }
+    AsyncWebServerResponse *beginResponse(int code) { return new AsyncWebServerResponse(code); }
+    AsyncWebServerResponse *beginResponse(const String &contentType, size_t length, AwsResponseFiller filler)
+    {
+        return new AsyncWebServerResponse(200, length, filler);
+    }
+    void send(int code) { response.reset(new AsyncWebServerResponse(code)); }
+    void send(int code, const char *contentType, const char *content) { send(code); }
+    void send(AsyncWebServerResponse *sent) { response.reset(sent); }
+    void onDisconnect(std::function<void()> callback) { disconnected = callback; }
+};
+
+typedef std::function<void(AsyncWebServerRequest *request)> ArRequestHandlerFunction;
+
+class AsyncWebServer
+{
+public:
+    std::map<std::string, ArRequestHandlerFunction> handlers;
+
+    AsyncWebServer(uint16_t port = 80) {}
+    void on(const char *uri, WebRequestMethod method, ArRequestHandlerFunction handler) { handlers[uri] = handler; }
+};
+
+#endif
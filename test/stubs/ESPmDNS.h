@@ -0,0 +1,64 @@
+// Host stand-in for ESPmDNS: a query is answered from hostMdns.answers, at
+// most MDNS_QUERY_RESULTS of them like the Arduino wrapper of mdns_query_ptr().
+// The TXT records this device advertises land in hostMdns.txt.
+#ifndef HOST_ESPMDNS_H
+#define HOST_ESPMDNS_H
+
+#include "Arduino.h"
+#include "IPAddress.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+#define MDNS_QUERY_RESULTS 20
+
+struct HostMdnsAnswer
+{
+    IPAddress ip;
+    uint16_t port;
+    std::map<std::string, std::string> txt;
+};
+
+struct HostMdns
+{
+    std::vector<HostMdnsAnswer> answers;
+    std::map<std::string, std::string> txt;
+    uint32_t queries = 0;
+
+    void reset()
+    {
+        *this = HostMdns();
+    }
+};
+
+inline HostMdns hostMdns;
+
+class MDNSResponder
+{
+public:
+    bool begin(const char *hostName) { return true; }
+    bool addService(const char *service, const char *proto, uint16_t port) { return true; }
+    bool addServiceTxt(const char *service, const char *proto, const char *key, const char *value)
+    {
+        hostMdns.txt[key] = value;
+        return true;
+    }
+    int queryService(const char *service, const char *proto)
+    {
+        hostMdns.queries++;
+        return (int)std::min(hostMdns.answers.size(), (size_t)MDNS_QUERY_RESULTS);
+    }
+    IPAddress IP(int index) { return hostMdns.answers[index].ip; }
+    uint16_t port(int index) { return hostMdns.answers[index].port; }
+    String txt(int index, const char *key)
+    {
+        auto &records = hostMdns.answers[index].txt;
+        auto entry = records.find(key);
+        return entry == records.end() ? String() : String(entry->second.c_str());
+    }
+};
+
+inline MDNSResponder MDNS;
+
+#endif
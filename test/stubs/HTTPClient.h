@@ -0,0 +1,75 @@
+// Host stand-in for HTTPClient: every GET goes to hostHttp.handler, which
+// answers with the status code, the body and the response headers.
+#ifndef HOST_HTTPCLIENT_H
+#define HOST_HTTPCLIENT_H
+
+#include "Arduino.h"
+#include "WiFi.h"
+
+#include <functional>
+#include <map>
+#include <string>
+
+struct HostHttpRequest
+{
+    std::string url;
+    std::map<std::string, std::string> headers;
+};
+
+struct HostHttpResponse
+{
+    int code;
+    std::string body;
+    std::map<std::string, std::string> headers;
+};
+
+struct HostHttp
+{
+    std::function<HostHttpResponse(const HostHttpRequest &)> handler;
+    uint32_t requests = 0;
+
+    void reset()
+    {
+        *this = HostHttp();
+    }
+};
+
+inline HostHttp hostHttp;
+
+class HTTPClient
+{
+public:
+    void setConnectTimeout(int32_t timeout) {}
+    void setTimeout(uint16_t timeout) {}
+    bool begin(const String &url)
+    {
+        _request = {url.c_str(), {}};
+        _response = {0, "", {}};
+        return true;
+    }
+    void collectHeaders(const char *headerKeys[], const size_t headerKeysCount) {}
+    void addHeader(const String &name, const String &value) { _request.headers[name.c_str()] = value.c_str(); }
+    int GET()
+    {
+        hostHttp.requests++;
+        _response = hostHttp.handler ? hostHttp.handler(_request) : HostHttpResponse{-1, "", {}};
+        _stream.body = _response.body;
+        _stream.position = 0;
+        return _response.code;
+    }
+    int getSize() { return _response.code > 0 ? (int)_response.body.size() : -1; }
+    String header(const char *name)
+    {
+        auto entry = _response.headers.find(name);
+        return entry == _response.headers.end() ? String() : String(entry->second.c_str());
+    }
+    WiFiClient *getStreamPtr() { return &_stream; }
+    void end() {}
+
+private:
+    HostHttpRequest _request;
+    HostHttpResponse _response;
+    WiFiClient _stream;
+};
+
+#endif
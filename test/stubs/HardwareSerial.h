@@ -0,0 +1,25 @@
+#ifndef HOST_HARDWARE_SERIAL_H
+#define HOST_HARDWARE_SERIAL_H
+
+#include "Stream.h"
+
+// Console output goes to stdout, set quiet to keep test logs short
+class HardwareSerial : public Stream
+{
+public:
+    HardwareSerial(int = 0) {}
+    void begin(unsigned long, int = SERIAL_8N1, int = -1, int = -1) {}
+    size_t write(uint8_t c) { return quiet ? 1 : fwrite(&c, 1, 1, stdout); }
+    size_t write(const uint8_t *b, size_t n) { return quiet ? n : fwrite(b, 1, n, stdout); }
+    using Print::write;
+    int available() { return 0; }
+    int read() { return -1; }
+    int peek() { return -1; }
+    operator bool() { return true; }
+    bool quiet = true;
+};
+
+inline HardwareSerial Serial;
+inline HardwareSerial Serial2(2);
+
+#endif
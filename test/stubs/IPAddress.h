@@ -0,0 +1,37 @@
+#ifndef HOST_IPADDRESS_H
+#define HOST_IPADDRESS_H
+
+#include <arpa/inet.h>
+#include "Arduino.h"
+
+class IPAddress
+{
+public:
+    IPAddress() {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : _address(a | (b << 8) | (c << 16) | ((uint32_t)d << 24)) {}
+    IPAddress(uint32_t address) : _address(address) {}
+    operator uint32_t() const { return _address; }
+    bool operator==(const IPAddress &o) const { return _address == o._address; }
+    bool operator!=(const IPAddress &o) const { return _address != o._address; }
+    uint8_t operator[](int i) const { return (_address >> (8 * i)) & 0xFF; }
+    bool fromString(const char *s)
+    {
+        in_addr a;
+        if (inet_pton(AF_INET, s, &a) != 1)
+            return false;
+        _address = a.s_addr;
+        return true;
+    }
+    bool fromString(const String &s) { return fromString(s.c_str()); }
+    String toString() const
+    {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+        return String(buf);
+    }
+
+private:
+    uint32_t _address = 0;
+};
+
+#endif
@@ -0,0 +1,204 @@
+// Host stand-in for LittleFS: files live in memory, directories are path
+// prefixes. hostFs counts the writes and commits the firmware causes, and
+// can cut writes short to model a full partition or a failing flash.
+#ifndef HOST_LITTLEFS_H
+#define HOST_LITTLEFS_H
+
+#include "Arduino.h"
+#include "Stream.h"
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+struct HostFileSystem
+{
+    std::map<std::string, std::shared_ptr<std::vector<uint8_t>>> files;
+    std::set<std::string> dirs = {"/"};
+    size_t totalBytes = 1572864;
+    uint32_t writes = 0;        // File::write calls
+    uint32_t opens = 0;         // LittleFS.open calls that succeeded
+    size_t bytesRead = 0;       // File::read bytes, over all files
+    // Bytes the next writes may still store, SIZE_MAX for no limit
+    size_t writeBudget = SIZE_MAX;
+
+    size_t usedBytes() const
+    {
+        size_t used = 0;
+        for (const auto &file : files)
+        {
+            // LittleFS keeps every file in whole 4 KB blocks
+            used += (file.second->size() + 4095) / 4096 * 4096;
+        }
+        return used;
+    }
+
+    void reset()
+    {
+        *this = HostFileSystem();
+    }
+};
+
+inline HostFileSystem hostFs;
+
+class File : public Stream
+{
+public:
+    File() {}
+    File(const std::string &path, std::shared_ptr<std::vector<uint8_t>> data, bool writable, bool append)
+        : _path(path), _data(data), _writable(writable), _position(append ? data->size() : 0) {}
+    File(const std::string &path, std::vector<std::string> entries)
+        : _path(path), _entries(entries), _directory(true) {}
+
+    operator bool() const { return _data != nullptr || _directory; }
+    bool isDirectory() const { return _directory; }
+    const char *name() const
+    {
+        size_t slash = _path.rfind('/');
+        return _path.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+    }
+    const char *path() const { return _path.c_str(); }
+
+    size_t write(uint8_t b) override { return write(&b, 1); }
+    size_t write(const uint8_t *buffer, size_t size) override
+    {
+        if (!_data || !_writable)
+            return 0;
+        hostFs.writes++;
+        size = std::min(size, hostFs.writeBudget);
+        if (hostFs.writeBudget != SIZE_MAX)
+            hostFs.writeBudget -= size;
+        if (_position + size > _data->size())
+            _data->resize(_position + size);
+        memcpy(_data->data() + _position, buffer, size);
+        _position += size;
+        return size;
+    }
+    using Print::write;
+
+    int available() override { return _data ? (int)(_data->size() - std::min(_position, _data->size())) : 0; }
+    int read() override
+    {
+        uint8_t b;
+        return read(&b, 1) == 1 ? b : -1;
+    }
+    size_t read(uint8_t *buffer, size_t size)
+    {
+        size = std::min(size, (size_t)available());
+        if (size > 0)
+            memcpy(buffer, _data->data() + _position, size);
+        hostFs.bytesRead += size;
+        _position += size;
+        return size;
+    }
+    int peek() override { return available() > 0 ? (*_data)[_position] : -1; }
+    bool seek(uint32_t position)
+    {
+        if (!_data || position > _data->size())
+            return false;
+        _position = position;
+        return true;
+    }
+    size_t position() const { return _position; }
+    size_t size() const { return _data ? _data->size() : 0; }
+    void flush() override {}
+    void close()
+    {
+        _data = nullptr;
+        _directory = false;
+    }
+
+    File openNextFile()
+    {
+        while (_next < _entries.size())
+        {
+            const std::string &path = _entries[_next++];
+            auto file = hostFs.files.find(path);
+            if (file != hostFs.files.end())
+                return File(path, file->second, false, false);
+            return File(path, std::vector<std::string>());
+        }
+        return File();
+    }
+
+private:
+    std::string _path;
+    std::shared_ptr<std::vector<uint8_t>> _data;
+    bool _writable = false;
+    size_t _position = 0;
+    std::vector<std::string> _entries;
+    size_t _next = 0;
+    bool _directory = false;
+};
+
+class HostLittleFS
+{
+public:
+    bool begin(bool formatOnFail = false, const char *basePath = "/littlefs", uint8_t maxOpenFiles = 10,
+               const char *partitionLabel = "spiffs")
+    {
+        return true;
+    }
+    void end() {}
+
+    File open(const char *path, const char *mode = "r", bool create = false)
+    {
+        std::string p = path;
+        if (hostFs.dirs.count(p))
+        {
+            // Direct children, files and directories
+            std::vector<std::string> entries;
+            std::string prefix = (p == "/") ? p : p + "/";
+            for (const auto &file : hostFs.files)
+                if (file.first.compare(0, prefix.size(), prefix) == 0 && file.first.find('/', prefix.size()) == std::string::npos)
+                    entries.push_back(file.first);
+            for (const auto &dir : hostFs.dirs)
+                if (dir != p && dir.compare(0, prefix.size(), prefix) == 0 && dir.find('/', prefix.size()) == std::string::npos)
+                    entries.push_back(dir);
+            hostFs.opens++;
+            return File(p, entries);
+        }
+
+        auto file = hostFs.files.find(p);
+        if (mode[0] == 'r')
+        {
+            if (file == hostFs.files.end())
+                return File();
+            hostFs.opens++;
+            return File(p, file->second, mode[1] == '+', false);
+        }
+        if (file == hostFs.files.end() || mode[0] == 'w')
+            file = hostFs.files.insert_or_assign(p, std::make_shared<std::vector<uint8_t>>()).first;
+        hostFs.opens++;
+        return File(p, file->second, true, mode[0] == 'a');
+    }
+    File open(const String &path, const char *mode = "r") { return open(path.c_str(), mode); }
+
+    bool exists(const char *path) { return hostFs.files.count(path) || hostFs.dirs.count(path); }
+    bool exists(const String &path) { return exists(path.c_str()); }
+    bool remove(const char *path) { return hostFs.files.erase(path) > 0; }
+    bool remove(const String &path) { return remove(path.c_str()); }
+    bool rename(const char *from, const char *to)
+    {
+        auto file = hostFs.files.find(from);
+        if (file == hostFs.files.end())
+            return false;
+        auto data = file->second;
+        hostFs.files.erase(file);
+        hostFs.files[to] = data;
+        return true;
+    }
+    bool rename(const String &from, const String &to) { return rename(from.c_str(), to.c_str()); }
+    bool mkdir(const char *path) { return hostFs.dirs.insert(path).second; }
+    bool mkdir(const String &path) { return mkdir(path.c_str()); }
+    bool rmdir(const char *path) { return hostFs.dirs.erase(path) > 0; }
+    bool rmdir(const String &path) { return rmdir(path.c_str()); }
+    size_t totalBytes() { return hostFs.totalBytes; }
+    size_t usedBytes() { return hostFs.usedBytes(); }
+};
+
+inline HostLittleFS LittleFS;
+
+#endif
@@ -0,0 +1,95 @@
+// Host stand-in for Preferences: NVS namespaces live in memory and survive
+// a simulated reboot, hostNvs counts the writes.
+#ifndef HOST_PREFERENCES_H
+#define HOST_PREFERENCES_H
+
+#include "Arduino.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+struct HostNvs
+{
+    std::map<std::string, std::map<std::string, std::vector<uint8_t>>> namespaces;
+    uint32_t writes = 0;
+
+    void reset()
+    {
+        *this = HostNvs();
+    }
+};
+
+inline HostNvs hostNvs;
+
+class Preferences
+{
+public:
+    bool begin(const char *name, bool readOnly = false)
+    {
+        _name = name;
+        _readOnly = readOnly;
+        return true;
+    }
+    void end() {}
+
+    size_t putBytes(const char *key, const void *value, size_t len)
+    {
+        if (_readOnly)
+            return 0;
+        hostNvs.writes++;
+        hostNvs.namespaces[_name][key].assign((const uint8_t *)value, (const uint8_t *)value + len);
+        return len;
+    }
+    size_t getBytes(const char *key, void *buf, size_t maxLen)
+    {
+        auto &entries = hostNvs.namespaces[_name];
+        auto entry = entries.find(key);
+        if (entry == entries.end() || entry->second.size() > maxLen)
+            return 0;
+        memcpy(buf, entry->second.data(), entry->second.size());
+        return entry->second.size();
+    }
+    size_t getBytesLength(const char *key)
+    {
+        auto &entries = hostNvs.namespaces[_name];
+        auto entry = entries.find(key);
+        return entry == entries.end() ? 0 : entry->second.size();
+    }
+    size_t putUInt(const char *key, uint32_t value) { return putBytes(key, &value, sizeof(value)) ? 4 : 0; }
+    uint32_t getUInt(const char *key, uint32_t defaultValue = 0)
+    {
+        uint32_t value;
+        return getBytes(key, &value, sizeof(value)) == sizeof(value) ? value : defaultValue;
+    }
+    size_t putString(const char *key, const char *value) { return putBytes(key, value, strlen(value)); }
+    String getString(const char *key, const String &defaultValue = String())
+    {
+        auto &entries = hostNvs.namespaces[_name];
+        auto entry = entries.find(key);
+        if (entry == entries.end())
+            return defaultValue;
+        return String(std::string(entry->second.begin(), entry->second.end()).c_str());
+    }
+    size_t getString(const char *key, char *value, size_t maxLen)
+    {
+        String stored = getString(key);
+        if (maxLen == 0 || stored.length() + 1 > maxLen)
+            return 0;
+        memcpy(value, stored.c_str(), stored.length() + 1);
+        return stored.length() + 1;
+    }
+    bool isKey(const char *key) { return hostNvs.namespaces[_name].count(key) > 0; }
+    bool remove(const char *key)
+    {
+        if (_readOnly)
+            return false;
+        return hostNvs.namespaces[_name].erase(key) > 0;
+    }
+
+private:
+    std::string _name;
+    bool _readOnly = false;
+};
+
+#endif
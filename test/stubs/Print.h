@@ -0,0 +1,46 @@
+#ifndef HOST_PRINT_H
+#define HOST_PRINT_H
+
+#include "Arduino.h"
+
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size)
+    {
+        size_t n = 0;
+        while (size--)
+            n += write(*buffer++);
+        return n;
+    }
+    size_t write(const char *s) { return s ? write((const uint8_t *)s, strlen(s)) : 0; }
+    size_t write(const char *b, size_t n) { return write((const uint8_t *)b, n); }
+    virtual void flush() {}
+
+    size_t print(const char *s) { return write(s); }
+    size_t print(const String &s) { return write((const uint8_t *)s.c_str(), s.length()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int v, int base = DEC) { return print(String(v, base)); }
+    size_t print(unsigned int v, int base = DEC) { return print(String(v, base)); }
+    size_t print(long v, int base = DEC) { return print(String(v, base)); }
+    size_t print(unsigned long v, int base = DEC) { return print(String(v, base)); }
+    size_t print(double v, int decimals = 2) { return print(String(v, decimals)); }
+    size_t println() { return write((const uint8_t *)"\r\n", 2); }
+    template <typename T>
+    size_t println(const T &v) { size_t n = print(v); return n + println(); }
+    template <typename T>
+    size_t println(const T &v, int format) { size_t n = print(v, format); return n + println(); }
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)))
+    {
+        char buf[512];
+        va_list args;
+        va_start(args, format);
+        int n = vsnprintf(buf, sizeof(buf), format, args);
+        va_end(args);
+        return n > 0 ? write((const uint8_t *)buf, std::min((size_t)n, sizeof(buf) - 1)) : 0;
+    }
+};
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef HOST_STREAM_H
+#define HOST_STREAM_H
+
+#include "Print.h"
+
+class Stream : public Print
+{
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long timeout) { _timeout = timeout; }
+    int timedRead()
+    {
+        unsigned long start = millis();
+        do
+        {
+            int c = read();
+            if (c >= 0)
+                return c;
+        } while (millis() - start < _timeout);
+        return -1;
+    }
+    size_t readBytes(uint8_t *buffer, size_t length)
+    {
+        size_t n = 0;
+        while (n < length)
+        {
+            int c = timedRead();
+            if (c < 0)
+                break;
+            buffer[n++] = (uint8_t)c;
+        }
+        return n;
+    }
+    size_t readBytes(char *buffer, size_t length) { return readBytes((uint8_t *)buffer, length); }
+    String readString()
+    {
+        String s;
+        int c;
+        while ((c = timedRead()) >= 0)
+            s += (char)c;
+        return s;
+    }
+    String readStringUntil(char terminator)
+    {
+        String s;
+        int c;
+        while ((c = timedRead()) >= 0 && c != terminator)
+            s += (char)c;
+        return s;
+    }
+
+protected:
+    unsigned long _timeout = 1000;
+};
+
+#endif
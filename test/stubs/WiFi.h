@@ -0,0 +1,85 @@
+// Host stand-in for the WiFi library. Name lookups answer from hostWiFi.hosts
+// and cost one DNS round trip of hostWiFi.dnsRttMs, on the fake clock when
+// the test runs one.
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+#include "Arduino.h"
+#include "Client.h"
+
+#include <map>
+#include <string>
+
+typedef enum
+{
+    WL_IDLE_STATUS = 0,
+    WL_DISCONNECTED = 6,
+    WL_CONNECTED = 3,
+} wl_status_t;
+
+struct HostWiFi
+{
+    std::map<std::string, IPAddress> hosts;
+    bool dnsReachable = true;
+    unsigned long dnsRttMs = 0;
+    uint32_t dnsQueries = 0;
+    wl_status_t status = WL_CONNECTED;
+    IPAddress localIP = IPAddress(192, 168, 1, 10);
+    const char *macAddress = "24:0A:C4:00:00:01";
+
+    void reset()
+    {
+        *this = HostWiFi();
+    }
+};
+
+inline HostWiFi hostWiFi;
+
+class WiFiClass
+{
+public:
+    int hostByName(const char *host, IPAddress &ip)
+    {
+        hostWiFi.dnsQueries++;
+        delay(hostWiFi.dnsRttMs);
+        auto entry = hostWiFi.hosts.find(host);
+        if (!hostWiFi.dnsReachable || entry == hostWiFi.hosts.end())
+            return 0;
+        ip = entry->second;
+        return 1;
+    }
+    wl_status_t status() { return hostWiFi.status; }
+    IPAddress localIP() { return hostWiFi.localIP; }
+    String macAddress() { return String(hostWiFi.macAddress); }
+};
+
+inline WiFiClass WiFi;
+
+// Reads back a response body set by the test, see HTTPClient.h
+class WiFiClient : public Client
+{
+public:
+    std::string body;
+    size_t position = 0;
+
+    int connect(IPAddress ip, uint16_t port) override { return 1; }
+    int connect(const char *host, uint16_t port) override { return 1; }
+    size_t write(uint8_t b) override { return 1; }
+    size_t write(const uint8_t *buf, size_t size) override { return size; }
+    int available() override { return (int)(body.size() - position); }
+    int read() override { return position < body.size() ? (uint8_t)body[position++] : -1; }
+    int read(uint8_t *buf, size_t size) override
+    {
+        size = std::min(size, body.size() - position);
+        memcpy(buf, body.data() + position, size);
+        position += size;
+        return (int)size;
+    }
+    int peek() override { return position < body.size() ? (uint8_t)body[position] : -1; }
+    void flush() override {}
+    void stop() override { position = body.size(); }
+    uint8_t connected() override { return position < body.size(); }
+    operator bool() override { return true; }
+};
+
+#endif
@@ -0,0 +1,128 @@
+// Host stand-in for the OTA and partition API: two app partitions in memory,
+// hostOta records the image written and the partition selected for the next
+// boot.
+#ifndef HOST_ESP_OTA_OPS_H
+#define HOST_ESP_OTA_OPS_H
+
+#include "Arduino.h"
+
+#include <vector>
+
+typedef int esp_err_t;
+typedef uint32_t esp_ota_handle_t;
+
+#define ESP_OK 0
+#define ESP_FAIL -1
+
+typedef struct
+{
+    char label[17];
+    uint32_t size;
+} esp_partition_t;
+
+typedef struct
+{
+    char version[32];
+    char project_name[32];
+    uint8_t app_elf_sha256[32];
+} esp_app_desc_t;
+
+struct HostOta
+{
+    esp_partition_t partitions[2] = {{"app0", 0x180000}, {"app1", 0x180000}};
+    std::vector<uint8_t> data[2];
+    esp_app_desc_t descriptions[2] = {};
+    int running = 0;
+    int boot = 0;
+    int writing = -1;
+    uint32_t begun = 0;
+    uint32_t aborted = 0;
+    bool markedValid = false;
+
+    void reset()
+    {
+        *this = HostOta();
+    }
+    int indexOf(const esp_partition_t *partition)
+    {
+        return partition == &partitions[1] ? 1 : 0;
+    }
+};
+
+inline HostOta hostOta;
+
+inline const esp_partition_t *esp_ota_get_running_partition() { return &hostOta.partitions[hostOta.running]; }
+inline const esp_partition_t *esp_ota_get_next_update_partition(const esp_partition_t *start)
+{
+    return &hostOta.partitions[1 - hostOta.running];
+}
+
+inline esp_err_t esp_ota_begin(const esp_partition_t *partition, size_t imageSize, esp_ota_handle_t *handle)
+{
+    int index = hostOta.indexOf(partition);
+    if (index == hostOta.running || imageSize > partition->size)
+        return ESP_FAIL;
+    hostOta.data[index].clear();
+    hostOta.writing = index;
+    hostOta.begun++;
+    *handle = index + 1;
+    return ESP_OK;
+}
+inline esp_err_t esp_ota_write(esp_ota_handle_t handle, const void *data, size_t size)
+{
+    if ((int)handle - 1 != hostOta.writing)
+        return ESP_FAIL;
+    hostOta.data[hostOta.writing].insert(hostOta.data[hostOta.writing].end(), (const uint8_t *)data,
+                                         (const uint8_t *)data + size);
+    return ESP_OK;
+}
+inline esp_err_t esp_ota_end(esp_ota_handle_t handle)
+{
+    if ((int)handle - 1 != hostOta.writing)
+        return ESP_FAIL;
+    hostOta.writing = -1;
+    return ESP_OK;
+}
+inline esp_err_t esp_ota_abort(esp_ota_handle_t handle)
+{
+    hostOta.writing = -1;
+    hostOta.aborted++;
+    return ESP_OK;
+}
+inline esp_err_t esp_ota_set_boot_partition(const esp_partition_t *partition)
+{
+    hostOta.boot = hostOta.indexOf(partition);
+    return ESP_OK;
+}
+inline esp_err_t esp_ota_mark_app_valid_cancel_rollback()
+{
+    hostOta.markedValid = true;
+    return ESP_OK;
+}
+
+inline const esp_app_desc_t *esp_ota_get_app_description() { return &hostOta.descriptions[hostOta.running]; }
+inline esp_err_t esp_ota_get_partition_description(const esp_partition_t *partition, esp_app_desc_t *description)
+{
+    *description = hostOta.descriptions[hostOta.indexOf(partition)];
+    return ESP_OK;
+}
+inline int esp_ota_get_app_elf_sha256(char *dst, size_t size)
+{
+    size_t n = 0;
+    for (; n < 32 && n * 2 + 2 < size; n++)
+        snprintf(dst + n * 2, 3, "%02x", hostOta.descriptions[hostOta.running].app_elf_sha256[n]);
+    return (int)(n * 2);
+}
+
+// Erased flash past the written image reads as 0xFF
+inline esp_err_t esp_partition_read(const esp_partition_t *partition, size_t offset, void *dst, size_t size)
+{
+    if (offset + size > partition->size)
+        return ESP_FAIL;
+    const std::vector<uint8_t> &data = hostOta.data[hostOta.indexOf(partition)];
+    for (size_t i = 0; i < size; i++)
+        ((uint8_t *)dst)[i] = offset + i < data.size() ? data[offset + i] : 0xFF;
+    return ESP_OK;
+}
+
+#endif
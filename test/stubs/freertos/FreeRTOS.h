@@ -0,0 +1,90 @@
+// Host stand-in for FreeRTOS on std::thread: tasks are threads, ticks are
+// milliseconds, semaphores and queues block like the real ones.
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint32_t StackType_t;
+typedef void (*TaskFunction_t)(void *);
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdFAIL 0
+#define errQUEUE_FULL 0
+#define portMAX_DELAY 0xffffffffu
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define configMAX_PRIORITIES 25
+#define configMAX_TASK_NAME_LEN 16
+#define configTICK_RATE_HZ 1000
+#define tskNO_AFFINITY 0x7FFFFFFF
+#ifndef portNUM_PROCESSORS
+#define portNUM_PROCESSORS 2
+#endif
+
+typedef std::recursive_mutex portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {}
+#define portENTER_CRITICAL(mux) ((mux)->lock())
+#define portEXIT_CRITICAL(mux) ((mux)->unlock())
+#define portENTER_CRITICAL_ISR(mux) ((mux)->lock())
+#define portEXIT_CRITICAL_ISR(mux) ((mux)->unlock())
+#define taskENTER_CRITICAL(mux) ((mux)->lock())
+#define taskEXIT_CRITICAL(mux) ((mux)->unlock())
+#define portYIELD_FROM_ISR() ((void)0)
+
+struct HostTask
+{
+    std::string name;
+    UBaseType_t priority = 1;
+    BaseType_t core = 0;
+    std::mutex m;
+    std::condition_variable cv;
+    uint32_t notify = 0;
+    std::atomic<bool> deleted{false};
+};
+typedef HostTask *TaskHandle_t;
+
+// Task of the calling thread, threads not started by xTaskCreate share one
+inline thread_local HostTask *hostSelf = nullptr;
+inline HostTask hostMainTask;
+
+inline TaskHandle_t hostCurrentTask()
+{
+    if (hostSelf == nullptr)
+    {
+        hostSelf = &hostMainTask;
+        if (hostMainTask.name.empty())
+            hostMainTask.name = "main";
+    }
+    return hostSelf;
+}
+
+// Waits on cv until ready() or the ticks ran out, portMAX_DELAY waits forever
+template <typename Lock, typename Ready>
+inline bool hostWait(std::condition_variable &cv, Lock &lock, TickType_t ticks, Ready ready)
+{
+    if (ticks == portMAX_DELAY)
+    {
+        cv.wait(lock, ready);
+        return true;
+    }
+    return cv.wait_for(lock, std::chrono::milliseconds(ticks), ready);
+}
+
+inline int xPortGetCoreID() { return hostCurrentTask()->core == 1 ? 1 : 0; }
+inline bool xPortInIsrContext() { return false; }
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef HOST_FREERTOS_QUEUE_H
+#define HOST_FREERTOS_QUEUE_H
+
+#include "FreeRTOS.h"
+#include <string.h>
+
+struct HostQueue
+{
+    std::mutex m;
+    std::condition_variable cv;
+    std::deque<std::vector<uint8_t>> items;
+    UBaseType_t length;
+    UBaseType_t itemSize;
+};
+typedef HostQueue *QueueHandle_t;
+
+inline QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize)
+{
+    HostQueue *q = new HostQueue;
+    q->length = length;
+    q->itemSize = itemSize;
+    return q;
+}
+
+inline void vQueueDelete(QueueHandle_t q) { delete q; }
+
+inline BaseType_t hostQueueSend(QueueHandle_t q, const void *item, TickType_t ticks, bool front)
+{
+    std::unique_lock<std::mutex> lock(q->m);
+    if (!hostWait(q->cv, lock, ticks, [q] { return q->items.size() < q->length; }))
+        return errQUEUE_FULL;
+    std::vector<uint8_t> bytes((const uint8_t *)item, (const uint8_t *)item + q->itemSize);
+    if (front)
+        q->items.push_front(std::move(bytes));
+    else
+        q->items.push_back(std::move(bytes));
+    q->cv.notify_all();
+    return pdTRUE;
+}
+
+inline BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t ticks) { return hostQueueSend(q, item, ticks, false); }
+inline BaseType_t xQueueSendToBack(QueueHandle_t q, const void *item, TickType_t ticks) { return hostQueueSend(q, item, ticks, false); }
+inline BaseType_t xQueueSendToFront(QueueHandle_t q, const void *item, TickType_t ticks) { return hostQueueSend(q, item, ticks, true); }
+inline BaseType_t xQueueSendFromISR(QueueHandle_t q, const void *item, BaseType_t *woken)
+{
+    if (woken)
+        *woken = pdFALSE;
+    return hostQueueSend(q, item, 0, false);
+}
+
+inline BaseType_t xQueueOverwrite(QueueHandle_t q, const void *item)
+{
+    std::lock_guard<std::mutex> lock(q->m);
+    q->items.clear();
+    q->items.emplace_back((const uint8_t *)item, (const uint8_t *)item + q->itemSize);
+    q->cv.notify_all();
+    return pdTRUE;
+}
+
+inline BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t ticks)
+{
+    std::unique_lock<std::mutex> lock(q->m);
+    if (!hostWait(q->cv, lock, ticks, [q] { return !q->items.empty(); }))
+        return pdFALSE;
+    memcpy(item, q->items.front().data(), q->itemSize);
+    q->items.pop_front();
+    q->cv.notify_all();
+    return pdTRUE;
+}
+
+inline BaseType_t xQueuePeek(QueueHandle_t q, void *item, TickType_t ticks)
+{
+    std::unique_lock<std::mutex> lock(q->m);
+    if (!hostWait(q->cv, lock, ticks, [q] { return !q->items.empty(); }))
+        return pdFALSE;
+    memcpy(item, q->items.front().data(), q->itemSize);
+    return pdTRUE;
+}
+
+inline UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q)
+{
+    std::lock_guard<std::mutex> lock(q->m);
+    return q->items.size();
+}
+
+inline UBaseType_t uxQueueSpacesAvailable(QueueHandle_t q)
+{
+    std::lock_guard<std::mutex> lock(q->m);
+    return q->length - q->items.size();
+}
+
+inline BaseType_t xQueueReset(QueueHandle_t q)
+{
+    std::lock_guard<std::mutex> lock(q->m);
+    q->items.clear();
+    q->cv.notify_all();
+    return pdPASS;
+}
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef HOST_FREERTOS_SEMPHR_H
+#define HOST_FREERTOS_SEMPHR_H
+
+#include "FreeRTOS.h"
+
+// Mutexes are counting semaphores of one that remember their holder,
+// recursive ones count the takes of the holder
+struct HostSemaphore
+{
+    std::mutex m;
+    std::condition_variable cv;
+    UBaseType_t count = 0;
+    UBaseType_t max = 1;
+    bool mutex = false;
+    bool recursive = false;
+    TaskHandle_t holder = nullptr;
+    UBaseType_t depth = 0;
+};
+typedef HostSemaphore *SemaphoreHandle_t;
+typedef HostSemaphore StaticSemaphore_t;
+
+inline SemaphoreHandle_t hostSemaphoreCreate(UBaseType_t max, UBaseType_t initial, bool mutex, bool recursive, HostSemaphore *buffer = nullptr)
+{
+    HostSemaphore *s = buffer ? buffer : new HostSemaphore;
+    s->max = max;
+    s->count = initial;
+    s->mutex = mutex;
+    s->recursive = recursive;
+    s->holder = nullptr;
+    s->depth = 0;
+    return s;
+}
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex() { return hostSemaphoreCreate(1, 1, true, false); }
+inline SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() { return hostSemaphoreCreate(1, 1, true, true); }
+inline SemaphoreHandle_t xSemaphoreCreateBinary() { return hostSemaphoreCreate(1, 0, false, false); }
+inline SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t initial) { return hostSemaphoreCreate(max, initial, false, false); }
+inline SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t *buffer) { return hostSemaphoreCreate(1, 1, true, false, buffer); }
+inline SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t *buffer) { return hostSemaphoreCreate(1, 0, false, false, buffer); }
+inline void vSemaphoreDelete(SemaphoreHandle_t s) { delete s; }
+
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t ticks)
+{
+    std::unique_lock<std::mutex> lock(s->m);
+    TaskHandle_t self = hostCurrentTask();
+    if (s->recursive && s->holder == self)
+    {
+        s->depth++;
+        return pdTRUE;
+    }
+    if (!hostWait(s->cv, lock, ticks, [s] { return s->count > 0; }))
+        return pdFALSE;
+    s->count--;
+    if (s->mutex)
+    {
+        s->holder = self;
+        s->depth = 1;
+    }
+    return pdTRUE;
+}
+
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t s)
+{
+    std::lock_guard<std::mutex> lock(s->m);
+    if (s->mutex)
+    {
+        if (s->holder != hostCurrentTask())
+            return pdFALSE;
+        if (--s->depth > 0)
+            return pdTRUE;
+        s->holder = nullptr;
+    }
+    if (s->count >= s->max)
+        return pdFALSE;
+    s->count++;
+    s->cv.notify_one();
+    return pdTRUE;
+}
+
+inline BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t s, TickType_t ticks) { return xSemaphoreTake(s, ticks); }
+inline BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t s) { return xSemaphoreGive(s); }
+inline BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t s, BaseType_t *woken)
+{
+    if (woken)
+        *woken = pdFALSE;
+    return xSemaphoreGive(s);
+}
+inline TaskHandle_t xSemaphoreGetMutexHolder(SemaphoreHandle_t s)
+{
+    std::lock_guard<std::mutex> lock(s->m);
+    return s->holder;
+}
+inline UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t s)
+{
+    std::lock_guard<std::mutex> lock(s->m);
+    return s->count;
+}
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef HOST_FREERTOS_TASK_H
+#define HOST_FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+#include <string.h>
+
+typedef enum { eRunning = 0, eReady, eBlocked, eSuspended, eDeleted, eInvalid } eTaskState;
+
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char *name, uint32_t stack, void *arg,
+                                          UBaseType_t priority, TaskHandle_t *handle, BaseType_t core)
+{
+    HostTask *task = new HostTask;
+    task->name = name ? name : "";
+    task->priority = priority;
+    task->core = core;
+    if (handle)
+        *handle = task;
+    std::thread([function, arg, task]() {
+        hostSelf = task;
+        function(arg);
+    }).detach();
+    return pdPASS;
+}
+
+inline BaseType_t xTaskCreate(TaskFunction_t function, const char *name, uint32_t stack, void *arg,
+                              UBaseType_t priority, TaskHandle_t *handle)
+{
+    return xTaskCreatePinnedToCore(function, name, stack, arg, priority, handle, tskNO_AFFINITY);
+}
+
+// The thread of a task deleting itself parks forever, nothing runs after it
+inline void vTaskDelete(TaskHandle_t task)
+{
+    if (task == nullptr || task == hostCurrentTask())
+    {
+        hostCurrentTask()->deleted = true;
+        for (;;)
+            std::this_thread::sleep_for(std::chrono::hours(1));
+    }
+    task->deleted = true;
+}
+
+#define taskYIELD() std::this_thread::yield()
+
+inline void vTaskDelay(TickType_t ticks) { std::this_thread::sleep_for(std::chrono::milliseconds(ticks)); }
+
+inline TickType_t xTaskGetTickCount()
+{
+    static const auto start = std::chrono::steady_clock::now();
+    return (TickType_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+inline void vTaskDelayUntil(TickType_t *previous, TickType_t increment)
+{
+    *previous += increment;
+    TickType_t now = xTaskGetTickCount();
+    if ((int32_t)(*previous - now) > 0)
+        vTaskDelay(*previous - now);
+}
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle() { return hostCurrentTask(); }
+inline const char *pcTaskGetName(TaskHandle_t task) { return (task ? task : hostCurrentTask())->name.c_str(); }
+inline const char *pcTaskGetTaskName(TaskHandle_t task) { return pcTaskGetName(task); }
+inline UBaseType_t uxTaskPriorityGet(TaskHandle_t task) { return (task ? task : hostCurrentTask())->priority; }
+inline void vTaskPrioritySet(TaskHandle_t task, UBaseType_t priority) { (task ? task : hostCurrentTask())->priority = priority; }
+inline eTaskState eTaskGetState(TaskHandle_t task) { return task->deleted ? eDeleted : eBlocked; }
+inline UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t) { return 1024; }
+inline BaseType_t xTaskGetAffinity(TaskHandle_t task) { return task->core; }
+
+inline void xTaskNotifyGive(TaskHandle_t task)
+{
+    std::lock_guard<std::mutex> lock(task->m);
+    task->notify++;
+    task->cv.notify_all();
+}
+
+inline void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken)
+{
+    xTaskNotifyGive(task);
+    if (woken)
+        *woken = pdTRUE;
+}
+
+inline uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks)
+{
+    HostTask *task = hostCurrentTask();
+    std::unique_lock<std::mutex> lock(task->m);
+    if (!hostWait(task->cv, lock, ticks, [task] { return task->notify > 0; }))
+        return 0;
+    uint32_t value = task->notify;
+    task->notify = clear ? 0 : value - 1;
+    return value;
+}
+
+#endif
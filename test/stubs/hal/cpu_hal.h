@@ -0,0 +1,10 @@
+// Host stand-in for the cycle counter, derived from the host clock.
+#ifndef HOST_HAL_CPU_HAL_H
+#define HOST_HAL_CPU_HAL_H
+
+#include "Arduino.h"
+
+// Cycles at getCpuFrequencyMhz()
+inline uint32_t cpu_hal_get_cycle_count() { return (uint32_t)(hostMicros() * getCpuFrequencyMhz()); }
+
+#endif
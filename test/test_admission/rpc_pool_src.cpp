@@ -0,0 +1,3 @@
+// The RPC pool, built as its own translation unit: admission.cpp and
+// rpc_pool.cpp both keep a static `stats`.
+#include "rpc_pool.cpp"
@@ -0,0 +1,309 @@
+// Inbound flood through PubSubClient into the callback path of coreiot:
+// admission by topic and rate, attribute messages getting through an RPC
+// flood, and one response for every RPC request that was admitted.
+#include <Arduino.h>
+#include <unity.h>
+#include <PubSubClient.h>
+
+#include "admission.cpp"
+#include "rpc_pool.h"
+
+#include <deque>
+#include <map>
+#include <vector>
+
+QueueHandle_t xRpcRequestQueue;
+QueueHandle_t xRpcResponseQueue;
+SemaphoreHandle_t xRpcMutex;
+
+// Queues inbound messages and records the PUBLISH packets the device sends
+class Broker : public Client
+{
+public:
+    bool open = false;
+    std::deque<uint8_t> in;
+    size_t outBytes = 0;
+    std::map<std::string, int> published;   // topic -> count
+
+    int connect(IPAddress ip, uint16_t port) override { return connect("", port); }
+    int connect(const char *host, uint16_t port) override
+    {
+        open = true;
+        return 1;
+    }
+    size_t write(uint8_t b) override { return write(&b, 1); }
+    size_t write(const uint8_t *buf, size_t size) override
+    {
+        outBytes += size;
+        pending.insert(pending.end(), buf, buf + size);
+        parse();
+        return size;
+    }
+    int available() override { return (int)in.size(); }
+    int read() override
+    {
+        if (in.empty())
+            return -1;
+        int c = in.front();
+        in.pop_front();
+        return c;
+    }
+    int read(uint8_t *buf, size_t size) override { return -1; }
+    int peek() override { return in.empty() ? -1 : in.front(); }
+    void flush() override {}
+    void stop() override { open = false; }
+    uint8_t connected() override { return open; }
+    operator bool() override { return open; }
+
+    // QoS 0 PUBLISH in MQTT 3.1.1 framing
+    void inject(const std::string &topic, const std::string &payload)
+    {
+        size_t remaining = 2 + topic.size() + payload.size();
+        in.push_back(0x30);
+        do
+        {
+            uint8_t digit = remaining & 127;
+            remaining >>= 7;
+            in.push_back(remaining ? digit | 128 : digit);
+        } while (remaining);
+        in.push_back(topic.size() >> 8);
+        in.push_back(topic.size() & 255);
+        in.insert(in.end(), topic.begin(), topic.end());
+        in.insert(in.end(), payload.begin(), payload.end());
+    }
+
+private:
+    std::vector<uint8_t> pending;
+
+    void parse()
+    {
+        while (pending.size() >= 2)
+        {
+            size_t h = 1;
+            uint32_t length = 0, multiplier = 1;
+            uint8_t digit;
+            do
+            {
+                digit = pending[h++];
+                length += (digit & 127) * multiplier;
+                multiplier <<= 7;
+            } while (digit & 128);
+            if (pending.size() < h + length)
+                return;
+            uint8_t type = pending[0] & 0xF0;
+            if (type == 0x10)
+                in.insert(in.end(), {0x20, 2, 0, 0});
+            else if (type == 0x30)
+            {
+                size_t topicLength = (pending[h] << 8) | pending[h + 1];
+                published[std::string(pending.begin() + h + 2, pending.begin() + h + 2 + topicLength)]++;
+            }
+            pending.erase(pending.begin(), pending.begin() + h + length);
+        }
+    }
+};
+
+static PubSubClient *client;
+static bool useAdmission;
+static uint32_t attributesHandled;
+static uint32_t handlersRun;
+
+static String setStateLED(JsonVariantConst params)
+{
+    handlersRun++;
+    return "{\"ok\":true}";
+}
+
+// The callback of coreiot.cpp, with the firmware announcement handling
+// replaced by a counter
+static void callback(char *topic, byte *payload, unsigned int length)
+{
+    if (useAdmission && !admission_check(topic, length))
+    {
+        return;
+    }
+    if (strncmp(topic, "v1/devices/me/attributes", 24) == 0)
+    {
+        attributesHandled++;
+        return;
+    }
+    String responseTopic;
+    String response;
+    if (!rpc_submit(topic, payload, length, responseTopic, response))
+    {
+        client->publish(responseTopic.c_str(), response.c_str());
+    }
+}
+
+static void publishRpcResponses()
+{
+    String topic;
+    String response;
+    while (rpc_take_response(topic, response))
+    {
+        client->publish(topic.c_str(), response.c_str());
+    }
+}
+
+typedef struct {
+    uint32_t rpcs;              // RPC requests sent
+    uint32_t rpcsAnswered;      // distinct RPC requests answered
+    uint32_t duplicates;        // responses beyond the first per request
+    size_t outBytes;
+} FloodResult_t;
+
+// 1000 messages per second for ten seconds on the fake clock: RPC requests
+// and junk on an unserved topic in turn, a firmware announcement every 2 s
+static FloodResult_t flood(bool admission)
+{
+    useAdmission = admission;
+    attributesHandled = 0;
+    handlersRun = 0;
+    Broker stand_in;
+    PubSubClient mqtt(stand_in);
+    client = &mqtt;
+    mqtt.setProtocolVersion(MQTT_VERSION_3_1_1);
+    mqtt.setServer("broker", 1883);
+    mqtt.setCallback(callback);
+    TEST_ASSERT_TRUE(mqtt.connect("device"));
+
+    FloodResult_t result = {};
+    for (int ms = 0; ms < 10000; ms++)
+    {
+        if (ms % 2000 == 0)
+        {
+            stand_in.inject("v1/devices/me/attributes", "{\"fw_title\":\"yolo\",\"fw_version\":\"1.2.0\"}");
+        }
+        else if (ms % 2)
+        {
+            stand_in.inject("v1/devices/me/rpc/request/" + std::to_string(result.rpcs++),
+                            "{\"method\":\"setStateLED\",\"params\":\"ON\"}");
+        }
+        else
+        {
+            stand_in.inject("v1/devices/me/junk", "{\"method\":\"setStateLED\",\"params\":\"ON\"}");
+        }
+        while (stand_in.available())
+        {
+            TEST_ASSERT_TRUE(mqtt.loop());
+        }
+        publishRpcResponses();
+        if (ms % 50 == 0)
+        {
+            // Lets the workers catch up with the network task
+            vTaskDelay(2);
+        }
+        hostFakeMicros += 1000;
+    }
+    vTaskDelay(50);
+    publishRpcResponses();
+
+    for (const auto &topic : stand_in.published)
+    {
+        if (topic.first.rfind("v1/devices/me/rpc/response/", 0) == 0)
+        {
+            result.rpcsAnswered++;
+            result.duplicates += topic.second - 1;
+        }
+    }
+    result.outBytes = stand_in.outBytes;
+    return result;
+}
+
+void setUp(void)
+{
+    static bool workersStarted = false;
+    hostFakeMicros = 0;
+    if (!workersStarted)
+    {
+        xRpcRequestQueue = xQueueCreate(RPC_QUEUE_LENGTH, sizeof(RpcRequest_t));
+        xRpcResponseQueue = xQueueCreate(RPC_QUEUE_LENGTH, sizeof(RpcResponse_t));
+        xRpcMutex = xSemaphoreCreateMutex();
+        rpc_register("setStateLED", setStateLED, 2, 2000, 2.0f, 4);
+        for (int i = 0; i < RPC_WORKERS; i++)
+        {
+            xTaskCreate(rpc_worker_task, "Task RPC", 4096, NULL, 1, NULL);
+        }
+        workersStarted = true;
+    }
+    // Full buckets at the start of every flood
+    bucket_init(&messageBucket, ADMISSION_MAX_MESSAGES_PER_S, ADMISSION_MESSAGE_BURST);
+    bucket_init(&byteBucket, ADMISSION_MAX_BYTES_PER_S, ADMISSION_BYTE_BURST);
+    bucket_init(&attributeBucket, ADMISSION_MAX_ATTRIBUTES_PER_S, ADMISSION_ATTRIBUTE_BURST);
+    memset(&stats, 0, sizeof(stats));
+}
+
+void tearDown(void)
+{
+    hostFakeMicros = -1;
+}
+
+static void test_unserved_topics_are_dropped(void)
+{
+    TEST_ASSERT_FALSE(admission_check("v1/devices/me/junk", 10));
+    TEST_ASSERT_FALSE(admission_check("v1/devices/me/rpc/request/", 10));
+    TEST_ASSERT_FALSE(admission_check("v1/devices/me/rpc/request/12a", 10));
+    TEST_ASSERT_TRUE(admission_check("v1/devices/me/rpc/request/12", 10));
+    TEST_ASSERT_TRUE(admission_check("v1/devices/me/attributes/response/1", 10));
+    TEST_ASSERT_EQUAL(3, admission_get_stats().droppedTopic);
+}
+
+static void test_rpc_flood_leaves_attributes_alone(void)
+{
+    for (int i = 0; i < ADMISSION_MESSAGE_BURST; i++)
+    {
+        TEST_ASSERT_TRUE(admission_check("v1/devices/me/rpc/request/1", 40));
+    }
+    TEST_ASSERT_FALSE(admission_check("v1/devices/me/rpc/request/1", 40));
+    TEST_ASSERT_TRUE(admission_check("v1/devices/me/attributes", 200));
+
+    // Attributes have a rate of their own as well
+    for (int i = 1; i < ADMISSION_ATTRIBUTE_BURST; i++)
+    {
+        TEST_ASSERT_TRUE(admission_check("v1/devices/me/attributes", 200));
+    }
+    TEST_ASSERT_FALSE(admission_check("v1/devices/me/attributes", 200));
+    AdmissionStats_t stats = admission_get_stats();
+    TEST_ASSERT_EQUAL(1, stats.droppedRate);
+    TEST_ASSERT_EQUAL(1, stats.droppedAttributes);
+}
+
+static void test_flood_with_and_without_admission(void)
+{
+    FloodResult_t without = flood(false);
+    uint32_t handlersWithout = handlersRun;
+    setUp();
+    RpcStats_t before = rpc_get_stats();
+    FloodResult_t with = flood(true);
+
+    AdmissionStats_t admission = admission_get_stats();
+    RpcStats_t rpc = rpc_get_stats();
+    rpc.rejectedRate -= before.rejectedRate;
+    char line[200];
+    snprintf(line, sizeof(line), "10 s flood, %lu RPCs: without admission %lu answered, %lu handlers, %lu bytes out",
+             (unsigned long)without.rpcs, (unsigned long)without.rpcsAnswered, (unsigned long)handlersWithout,
+             (unsigned long)without.outBytes);
+    TEST_MESSAGE(line);
+    snprintf(line, sizeof(line),
+             "with admission %lu admitted, %lu answered, %lu handlers, %lu bytes out, %lu method rate limited",
+             (unsigned long)(admission.accepted - attributesHandled), (unsigned long)with.rpcsAnswered,
+             (unsigned long)handlersRun, (unsigned long)with.outBytes, (unsigned long)rpc.rejectedRate);
+    TEST_MESSAGE(line);
+
+    // Every firmware announcement got through
+    TEST_ASSERT_EQUAL(5, attributesHandled);
+    // Every admitted RPC was answered once, by its handler or with an error
+    TEST_ASSERT_EQUAL(admission.accepted - attributesHandled, with.rpcsAnswered);
+    TEST_ASSERT_EQUAL(0, with.duplicates);
+    TEST_ASSERT_GREATER_THAN(0, rpc.rejectedRate);
+    TEST_ASSERT_LESS_THAN(without.outBytes / 10, with.outBytes);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_unserved_topics_are_dropped);
+    RUN_TEST(test_rpc_flood_leaves_attributes_alone);
+    RUN_TEST(test_flood_with_and_without_admission);
+    return UNITY_END();
+}
@@ -0,0 +1,185 @@
+// Event captures on the in-memory LittleFS: the write handed to the executor
+// instead of the sensor task, the file limit, and captures that cannot be
+// uploaded being skipped instead of blocking the queue.
+#include <Arduino.h>
+#include <unity.h>
+
+#include "capture.cpp"
+
+#include <deque>
+
+SemaphoreHandle_t xCaptureMutex;
+
+// Jobs wait here until the test runs them, like a busy executor worker
+static std::deque<std::pair<ExecutorJob_t, void *>> jobs;
+static bool executorFull;
+
+bool executor_submit(ExecutorJob_t job, void *arg, ExecutorPriority_t priority, ExecutorJob_t done,
+                     ExecutorFuture_t *future)
+{
+    if (executorFull)
+    {
+        return false;
+    }
+    jobs.push_back({job, arg});
+    return true;
+}
+
+static void runJobs()
+{
+    while (!jobs.empty())
+    {
+        auto job = jobs.front();
+        jobs.pop_front();
+        job.first(job.second);
+    }
+}
+
+static void addSamples(int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        capture_add(24.0f + (i % 7) * 0.01f, 55.0f);
+    }
+}
+
+// One full capture, its write still waiting on the executor
+static void record(CaptureTrigger_t reason)
+{
+    capture_trigger(reason, 1.0f);
+    addSamples(CAPTURE_POST_SAMPLES + 1);
+}
+
+void setUp(void)
+{
+    hostFs.reset();
+    xCaptureMutex = xSemaphoreCreateMutex();
+    head = filled = 0;
+    recording = storing = false;
+    pendingReason = 0;
+    stats = {};
+    jobs.clear();
+    executorFull = false;
+    LittleFS.begin();
+    capture_begin();
+    addSamples(CAPTURE_PRE_SAMPLES);
+}
+
+void tearDown(void)
+{
+    vSemaphoreDelete(xCaptureMutex);
+}
+
+static void test_sensor_task_leaves_the_write_to_the_executor(void)
+{
+    uint32_t writesBefore = hostFs.writes;
+    record(CAPTURE_TRIGGER_CRITICAL);
+    TEST_ASSERT_EQUAL(writesBefore, hostFs.writes);
+    TEST_ASSERT_EQUAL(1, jobs.size());
+    TEST_ASSERT_EQUAL(0, capture_pending());
+
+    runJobs();
+    TEST_ASSERT_EQUAL(1, capture_pending());
+    TEST_ASSERT_EQUAL(1, capture_get_stats().captured);
+
+    uint8_t buffer[CAPTURE_MAX_FILE_SIZE];
+    uint32_t id;
+    size_t length = capture_read_oldest(buffer, sizeof(buffer), &id);
+    TEST_ASSERT_EQUAL(capture_get_stats().bytesWritten, length);
+    CaptureHeader_t stored;
+    memcpy(&stored, buffer, sizeof(stored));
+    TEST_ASSERT_EQUAL(CAPTURE_TRIGGER_CRITICAL, stored.reason);
+    TEST_ASSERT_EQUAL(CAPTURE_PRE_SAMPLES, stored.preSamples);
+    TEST_ASSERT_EQUAL(CAPTURE_PRE_SAMPLES + CAPTURE_POST_SAMPLES, stored.samples);
+}
+
+static void test_capture_finished_during_the_write_is_lost(void)
+{
+    record(CAPTURE_TRIGGER_WARNING);
+    record(CAPTURE_TRIGGER_CRITICAL);
+    TEST_ASSERT_EQUAL(1, jobs.size());
+    TEST_ASSERT_EQUAL(1, capture_get_stats().failed);
+
+    runJobs();
+    TEST_ASSERT_EQUAL(1, capture_pending());
+    // The next one is written again
+    record(CAPTURE_TRIGGER_CRITICAL);
+    runJobs();
+    TEST_ASSERT_EQUAL(2, capture_pending());
+}
+
+static void test_full_executor_writes_inline(void)
+{
+    executorFull = true;
+    record(CAPTURE_TRIGGER_ANOMALY);
+    TEST_ASSERT_EQUAL(0, jobs.size());
+    TEST_ASSERT_EQUAL(1, capture_pending());
+}
+
+static void test_oldest_is_dropped_beyond_the_file_limit(void)
+{
+    for (int i = 0; i < CAPTURE_MAX_FILES + 2; i++)
+    {
+        record(CAPTURE_TRIGGER_ANOMALY);
+        runJobs();
+    }
+    TEST_ASSERT_EQUAL(CAPTURE_MAX_FILES, capture_pending());
+    TEST_ASSERT_EQUAL(2, capture_get_stats().dropped);
+
+    uint8_t buffer[CAPTURE_MAX_FILE_SIZE];
+    uint32_t id;
+    TEST_ASSERT_GREATER_THAN(0, capture_read_oldest(buffer, sizeof(buffer), &id));
+    TEST_ASSERT_EQUAL(2, id);
+}
+
+static void test_oversized_capture_does_not_block_the_queue(void)
+{
+    record(CAPTURE_TRIGGER_WARNING);
+    runJobs();
+    record(CAPTURE_TRIGGER_CRITICAL);
+    runJobs();
+    // e.g. left behind by a firmware with a larger CAPTURE_MAX_FILE_SIZE
+    File file = LittleFS.open("/capture/0.bin", "w");
+    std::vector<uint8_t> large(CAPTURE_MAX_FILE_SIZE + 1, 0);
+    file.write(large.data(), large.size());
+    file.close();
+
+    uint8_t buffer[CAPTURE_MAX_FILE_SIZE];
+    uint32_t id;
+    TEST_ASSERT_EQUAL(0, capture_read_oldest(buffer, sizeof(buffer), &id));
+    TEST_ASSERT_EQUAL(0, id);
+    TEST_ASSERT_EQUAL(1, capture_pending());
+    TEST_ASSERT_FALSE(LittleFS.exists("/capture/0.bin"));
+    TEST_ASSERT_EQUAL(1, capture_get_stats().dropped);
+
+    TEST_ASSERT_GREATER_THAN(0, capture_read_oldest(buffer, sizeof(buffer), &id));
+    TEST_ASSERT_EQUAL(1, id);
+}
+
+static void test_missing_capture_is_skipped(void)
+{
+    record(CAPTURE_TRIGGER_WARNING);
+    runJobs();
+    record(CAPTURE_TRIGGER_CRITICAL);
+    runJobs();
+    LittleFS.remove("/capture/0.bin");
+
+    uint8_t buffer[CAPTURE_MAX_FILE_SIZE];
+    uint32_t id;
+    TEST_ASSERT_EQUAL(0, capture_read_oldest(buffer, sizeof(buffer), &id));
+    TEST_ASSERT_EQUAL(1, capture_pending());
+    TEST_ASSERT_GREATER_THAN(0, capture_read_oldest(buffer, sizeof(buffer), &id));
+    TEST_ASSERT_EQUAL(1, id);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_sensor_task_leaves_the_write_to_the_executor);
+    RUN_TEST(test_capture_finished_during_the_write_is_lost);
+    RUN_TEST(test_full_executor_writes_inline);
+    RUN_TEST(test_oldest_is_dropped_beyond_the_file_limit);
+    RUN_TEST(test_oversized_capture_does_not_block_the_queue);
+    RUN_TEST(test_missing_capture_is_skipped);
+    return UNITY_END();
+}
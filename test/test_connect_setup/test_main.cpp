@@ -0,0 +1,273 @@
+// Connection setup on the fake clock: the DNS cache in RAM and NVS, and the
+// round trips a reconnect pays with a DNS query and serial SUBSCRIBEs versus
+// a cached address and pipelined SUBSCRIBEs.
+#include <Arduino.h>
+#include <unity.h>
+#include <PubSubClient.h>
+
+#include "dns_cache.cpp"
+
+#include <deque>
+#include <vector>
+
+SemaphoreHandle_t xDnsCacheMutex;
+
+static const unsigned long RTT_MS = 80;
+
+// Answers CONNECT and SUBSCRIBE one RTT after they were sent. available()
+// advances the fake clock to the next answer, like a client blocking on it.
+class Broker : public Client
+{
+public:
+    bool open = false;
+
+    int connect(IPAddress ip, uint16_t port) override
+    {
+        // TCP handshake
+        delay(RTT_MS);
+        open = true;
+        return 1;
+    }
+    int connect(const char *host, uint16_t port) override { return connect(IPAddress(), port); }
+    size_t write(uint8_t b) override { return write(&b, 1); }
+    size_t write(const uint8_t *buf, size_t size) override
+    {
+        pending.insert(pending.end(), buf, buf + size);
+        parse();
+        return size;
+    }
+    int available() override
+    {
+        if (!in.empty() && in.front().first > hostFakeMicros)
+            hostFakeMicros = in.front().first;
+        int ready = 0;
+        for (const auto &byte : in)
+        {
+            if (byte.first > hostFakeMicros)
+                break;
+            ready++;
+        }
+        return ready;
+    }
+    int read() override
+    {
+        if (available() == 0)
+            return -1;
+        int c = in.front().second;
+        in.pop_front();
+        return c;
+    }
+    int read(uint8_t *buf, size_t size) override { return -1; }
+    int peek() override { return -1; }
+    void flush() override {}
+    void stop() override { open = false; }
+    uint8_t connected() override { return open; }
+    operator bool() override { return open; }
+
+private:
+    std::vector<uint8_t> pending;
+    std::deque<std::pair<int64_t, uint8_t>> in;
+
+    void reply(std::initializer_list<uint8_t> bytes)
+    {
+        for (uint8_t b : bytes)
+            in.push_back({hostFakeMicros + (int64_t)RTT_MS * 1000, b});
+    }
+
+    void parse()
+    {
+        while (pending.size() >= 2)
+        {
+            size_t h = 1;
+            uint32_t length = 0, multiplier = 1;
+            uint8_t digit;
+            do
+            {
+                digit = pending[h++];
+                length += (digit & 127) * multiplier;
+                multiplier <<= 7;
+            } while (digit & 128);
+            if (pending.size() < h + length)
+                return;
+            uint8_t type = pending[0] & 0xF0;
+            uint8_t id0 = pending[h], id1 = pending[h + 1];
+            pending.erase(pending.begin(), pending.begin() + h + length);
+            if (type == 0x10)
+                reply({0x20, 2, 0, 0});
+            else if (type == 0x80)
+                reply({0x90, 3, id0, id1, 0});
+        }
+    }
+};
+
+static const char *topics[] = {"v1/devices/me/rpc/request/+", "v1/devices/me/attributes",
+                               "v1/devices/me/attributes/response/+"};
+
+// Milliseconds from the DNS lookup until every SUBSCRIBE is acknowledged
+static unsigned long reconnect(bool pipelined)
+{
+    Broker broker;
+    PubSubClient client(broker);
+    client.setProtocolVersion(MQTT_VERSION_3_1_1);
+    unsigned long start = millis();
+
+    IPAddress ip;
+    TEST_ASSERT_TRUE(dns_cache_resolve("demo.coreiot.io", ip, NULL));
+    broker.connect(ip, 1883);
+    TEST_ASSERT_TRUE(client.connect("dev"));
+    for (const char *topic : topics)
+    {
+        TEST_ASSERT_TRUE(client.subscribe(topic));
+        while (!pipelined && client.getPendingSubscribes() > 0)
+            TEST_ASSERT_TRUE(client.loop());
+    }
+    while (client.getPendingSubscribes() > 0)
+        TEST_ASSERT_TRUE(client.loop());
+    return millis() - start;
+}
+
+void setUp(void)
+{
+    hostFakeMicros = 0;
+    hostWiFi.reset();
+    hostWiFi.hosts["demo.coreiot.io"] = IPAddress(10, 0, 0, 42);
+    hostWiFi.dnsRttMs = RTT_MS;
+    hostNvs.reset();
+    xDnsCacheMutex = xSemaphoreCreateMutex();
+    dns_cache_begin();
+}
+
+void tearDown(void)
+{
+    vSemaphoreDelete(xDnsCacheMutex);
+    hostFakeMicros = -1;
+}
+
+static void test_second_lookup_comes_from_ram(void)
+{
+    IPAddress ip;
+    bool cached;
+    TEST_ASSERT_TRUE(dns_cache_resolve("demo.coreiot.io", ip, &cached));
+    TEST_ASSERT_FALSE(cached);
+    TEST_ASSERT_TRUE(ip == IPAddress(10, 0, 0, 42));
+
+    unsigned long start = millis();
+    TEST_ASSERT_TRUE(dns_cache_resolve("demo.coreiot.io", ip, &cached));
+    TEST_ASSERT_TRUE(cached);
+    TEST_ASSERT_EQUAL(0, millis() - start);
+    TEST_ASSERT_EQUAL(1, hostWiFi.dnsQueries);
+}
+
+static void test_ip_literals_bypass_the_cache(void)
+{
+    IPAddress ip;
+    bool cached;
+    TEST_ASSERT_TRUE(dns_cache_resolve("10.1.2.3", ip, &cached));
+    TEST_ASSERT_TRUE(cached);
+    TEST_ASSERT_TRUE(ip == IPAddress(10, 1, 2, 3));
+    TEST_ASSERT_EQUAL(0, hostWiFi.dnsQueries);
+    TEST_ASSERT_EQUAL(0, hostNvs.writes);
+}
+
+static void test_entries_expire_after_the_ttl(void)
+{
+    IPAddress ip;
+    bool cached;
+    dns_cache_resolve("demo.coreiot.io", ip, &cached);
+    delay(DNS_CACHE_TTL_S * 1000UL + 1);
+    hostWiFi.hosts["demo.coreiot.io"] = IPAddress(10, 0, 0, 43);
+    TEST_ASSERT_TRUE(dns_cache_resolve("demo.coreiot.io", ip, &cached));
+    TEST_ASSERT_FALSE(cached);
+    TEST_ASSERT_TRUE(ip == IPAddress(10, 0, 0, 43));
+    // NVS follows the new address
+    TEST_ASSERT_EQUAL(2, hostNvs.writes);
+}
+
+static void test_refresh_with_the_same_address_skips_nvs(void)
+{
+    IPAddress ip;
+    dns_cache_resolve("demo.coreiot.io", ip, NULL);
+    dns_cache_invalidate("demo.coreiot.io");
+    dns_cache_resolve("demo.coreiot.io", ip, NULL);
+    TEST_ASSERT_EQUAL(2, hostWiFi.dnsQueries);
+    TEST_ASSERT_EQUAL(1, hostNvs.writes);
+}
+
+static void test_nvs_entry_is_used_after_a_reboot(void)
+{
+    IPAddress ip;
+    dns_cache_resolve("demo.coreiot.io", ip, NULL);
+
+    // RAM is gone, NVS is kept
+    dns_cache_begin();
+    bool cached;
+    TEST_ASSERT_TRUE(dns_cache_resolve("demo.coreiot.io", ip, &cached));
+    TEST_ASSERT_TRUE(cached);
+    TEST_ASSERT_TRUE(ip == IPAddress(10, 0, 0, 42));
+    TEST_ASSERT_EQUAL(1, hostWiFi.dnsQueries);
+
+    // A failed connect to it sends the next resolve to the DNS server
+    dns_cache_invalidate("demo.coreiot.io");
+    TEST_ASSERT_TRUE(dns_cache_resolve("demo.coreiot.io", ip, &cached));
+    TEST_ASSERT_FALSE(cached);
+    TEST_ASSERT_EQUAL(2, hostWiFi.dnsQueries);
+}
+
+static void test_expired_address_beats_an_unreachable_server(void)
+{
+    IPAddress ip;
+    dns_cache_resolve("demo.coreiot.io", ip, NULL);
+    dns_cache_invalidate("demo.coreiot.io");
+    hostWiFi.dnsReachable = false;
+    TEST_ASSERT_TRUE(dns_cache_resolve("demo.coreiot.io", ip, NULL));
+    TEST_ASSERT_TRUE(ip == IPAddress(10, 0, 0, 42));
+    TEST_ASSERT_FALSE(dns_cache_resolve("unknown.coreiot.io", ip, NULL));
+}
+
+static void test_full_cache_replaces_the_oldest_entry(void)
+{
+    IPAddress ip;
+    char host[32];
+    for (int i = 0; i <= DNS_CACHE_ENTRIES; i++)
+    {
+        snprintf(host, sizeof(host), "host%d.coreiot.io", i);
+        hostWiFi.hosts[host] = IPAddress(10, 0, 1, i);
+        TEST_ASSERT_TRUE(dns_cache_resolve(host, ip, NULL));
+        delay(1000);
+    }
+    bool cached;
+    dns_cache_resolve("host0.coreiot.io", ip, &cached);
+    TEST_ASSERT_FALSE(cached);
+    snprintf(host, sizeof(host), "host%d.coreiot.io", DNS_CACHE_ENTRIES);
+    dns_cache_resolve(host, ip, &cached);
+    TEST_ASSERT_TRUE(cached);
+}
+
+// A reconnect needs DNS + TCP + CONNECT + SUBSCRIBEs round trips; with the
+// cache and pipelining it is TCP + CONNECT + one SUBSCRIBE round trip
+static void test_cached_pipelined_reconnect_saves_round_trips(void)
+{
+    unsigned long cold = reconnect(false);
+    unsigned long warm = reconnect(true);
+
+    char line[120];
+    snprintf(line, sizeof(line), "RTT %lu ms: DNS query + serial SUBSCRIBE %lu ms, cached + pipelined %lu ms", RTT_MS,
+             cold, warm);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_EQUAL(6 * RTT_MS, cold);
+    TEST_ASSERT_EQUAL(3 * RTT_MS, warm);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_second_lookup_comes_from_ram);
+    RUN_TEST(test_ip_literals_bypass_the_cache);
+    RUN_TEST(test_entries_expire_after_the_ttl);
+    RUN_TEST(test_refresh_with_the_same_address_skips_nvs);
+    RUN_TEST(test_nvs_entry_is_used_after_a_reboot);
+    RUN_TEST(test_expired_address_beats_an_unreachable_server);
+    RUN_TEST(test_full_cache_replaces_the_oldest_entry);
+    RUN_TEST(test_cached_pipelined_reconnect_saves_round_trips);
+    return UNITY_END();
+}
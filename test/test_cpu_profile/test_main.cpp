@@ -0,0 +1,286 @@
+// CPU profiler on the host: the timers never fire, the test calls the handler
+// attached to the timer of a core from a task on that core and numbers every
+// sample in pc[0] (there is no stack to walk). Covers the order of a wrapped
+// ring, the download in chunks through /profile, and a new profile
+// invalidating a download of the previous one.
+#include <Arduino.h>
+#include <unity.h>
+
+#include "cpu_profile.cpp"
+
+#include <atomic>
+#include <vector>
+
+volatile unsigned port_interruptNesting[portNUM_PROCESSORS] = {1, 1};
+
+static AsyncWebServer server;
+static std::atomic<int> done;
+
+static void waitFor(bool (*condition)())
+{
+    for (int i = 0; i < 5000 && !condition(); i++)
+    {
+        vTaskDelay(1);
+    }
+    TEST_ASSERT_TRUE(condition());
+}
+
+static bool timersArmed()
+{
+    return hostTimers[CPU_PROFILE_TIMER].enabled && hostTimers[CPU_PROFILE_TIMER + 1].enabled;
+}
+
+static bool stopped()
+{
+    return !cpu_profile_get_status().running;
+}
+
+static void startProfile(uint16_t hz, uint32_t seconds)
+{
+    TEST_ASSERT_NULL(cpu_profile_start(hz, seconds));
+    waitFor(timersArmed);
+    TEST_ASSERT_EQUAL(1000000 / hz, hostTimers[CPU_PROFILE_TIMER].alarm);
+    TEST_ASSERT_EQUAL(80, hostTimers[CPU_PROFILE_TIMER + 1].divider);
+}
+
+static void stopProfile()
+{
+    cpu_profile_stop();
+    waitFor(stopped);
+    TEST_ASSERT_NULL(hostTimers[CPU_PROFILE_TIMER].isr);
+}
+
+// Fires the timer of the current core count times
+static void takeSamples(uint32_t count, uint32_t first)
+{
+    int core = xPortGetCoreID();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        hostTimers[CPU_PROFILE_TIMER + core].isr();
+        rings[core][(heads[core] - 1) % capacity].pc[0] = first + i;
+    }
+}
+
+struct CoreSamples {
+    uint32_t count;
+    uint32_t first;
+};
+
+static void sampleOnCore1(void *arg)
+{
+    const CoreSamples *samples = (const CoreSamples *)arg;
+    takeSamples(samples->count, samples->first);
+    done++;
+    vTaskDelete(NULL);
+}
+
+// count0 samples on core 0 from this task, count1 on core 1 from "core1"
+static void takeOnBothCores(uint32_t count0, uint32_t first0, uint32_t count1, uint32_t first1)
+{
+    takeSamples(count0, first0);
+    static CoreSamples samples;
+    samples = {count1, first1};
+    int before = done;
+    xTaskCreatePinnedToCore(sampleOnCore1, "core1", 2048, &samples, 1, NULL, 1);
+    while (done == before)
+    {
+        vTaskDelay(1);
+    }
+}
+
+static AsyncWebServerResponse *request()
+{
+    static AsyncWebServerRequest current;
+    server.handlers[CPU_PROFILE_PATH](&current);
+    return current.response.release();
+}
+
+// Reads a response the way the web server does, at most chunk bytes a call
+static std::vector<uint8_t> download(AsyncWebServerResponse *response, size_t chunk)
+{
+    std::vector<uint8_t> bytes;
+    std::vector<uint8_t> buffer(chunk);
+    size_t n;
+    while (bytes.size() < response->length && (n = response->filler(buffer.data(), chunk, bytes.size())) > 0)
+    {
+        TEST_ASSERT_TRUE(n <= chunk);
+        bytes.insert(bytes.end(), buffer.begin(), buffer.begin() + n);
+    }
+    return bytes;
+}
+
+static const CpuProfileSample_t *sampleAt(const std::vector<uint8_t> &bytes, uint32_t i)
+{
+    const CpuProfileHeader_t *header = (const CpuProfileHeader_t *)bytes.data();
+    size_t offset = sizeof(CpuProfileHeader_t) + header->tasks * CPU_PROFILE_NAME_LEN + i * sizeof(CpuProfileSample_t);
+    return (const CpuProfileSample_t *)(bytes.data() + offset);
+}
+
+static const char *taskName(const std::vector<uint8_t> &bytes, uint8_t task)
+{
+    return (const char *)bytes.data() + sizeof(CpuProfileHeader_t) + task * CPU_PROFILE_NAME_LEN;
+}
+
+// The samples of a core are numbered first, first + 1, ... in the file
+static void checkSamples(const std::vector<uint8_t> &bytes, uint32_t at, uint8_t core, uint32_t count,
+                         uint32_t first, const char *task)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const CpuProfileSample_t *sample = sampleAt(bytes, at + i);
+        TEST_ASSERT_EQUAL(core, sample->core & ~CPU_PROFILE_SAMPLE_NESTED);
+        TEST_ASSERT_EQUAL(first + i, sample->pc[0]);
+        TEST_ASSERT_EQUAL_STRING(task, taskName(bytes, sample->task));
+    }
+}
+
+void setUp(void)
+{
+    static bool registered = false;
+    if (!registered)
+    {
+        cpu_profile_register(server);
+        registered = true;
+    }
+    done = 0;
+}
+
+void tearDown(void)
+{
+    cpu_profile_stop();
+    waitFor(stopped);
+}
+
+static void test_wrapped_ring_is_read_oldest_first(void)
+{
+    startProfile(10, 1);
+    TEST_ASSERT_EQUAL(10, cpu_profile_get_status().capacity);
+
+    // Core 0 wraps two and a half times, one of its samples interrupted a handler
+    takeSamples(22, 0);
+    port_interruptNesting[0] = 2;
+    takeSamples(1, 22);
+    port_interruptNesting[0] = 1;
+    takeOnBothCores(2, 23, 7, 1000);
+    stopProfile();
+
+    CpuProfileStatus_t status = cpu_profile_get_status();
+    TEST_ASSERT_EQUAL(25, status.taken[0]);
+    TEST_ASSERT_EQUAL(15, status.dropped[0]);
+    TEST_ASSERT_EQUAL(1, status.nested[0]);
+    TEST_ASSERT_EQUAL(7, status.taken[1]);
+    TEST_ASSERT_EQUAL(0, status.dropped[1]);
+    TEST_ASSERT_EQUAL(2, status.tasks);
+
+    uint32_t generation;
+    size_t size = cpu_profile_size(&generation);
+    TEST_ASSERT_EQUAL(sizeof(CpuProfileHeader_t) + 2 * CPU_PROFILE_NAME_LEN + 17 * sizeof(CpuProfileSample_t), size);
+    std::vector<uint8_t> bytes(size);
+    TEST_ASSERT_EQUAL(size, cpu_profile_read(generation, 0, bytes.data(), size + 100));
+
+    const CpuProfileHeader_t *header = (const CpuProfileHeader_t *)bytes.data();
+    TEST_ASSERT_EQUAL(0, memcmp(header->magic, "CPRF", 4));
+    TEST_ASSERT_EQUAL(CPU_PROFILE_FORMAT, header->format);
+    TEST_ASSERT_EQUAL(portNUM_PROCESSORS, header->cores);
+    TEST_ASSERT_EQUAL(CPU_PROFILE_DEPTH, header->depth);
+    TEST_ASSERT_EQUAL(10, header->hz);
+    TEST_ASSERT_EQUAL(17, header->samples);
+
+    // The last 10 of core 0 in the order taken, then core 1
+    checkSamples(bytes, 0, 0, 10, 15, "main");
+    TEST_ASSERT_EQUAL(CPU_PROFILE_SAMPLE_NESTED, sampleAt(bytes, 7)->core);
+    TEST_ASSERT_EQUAL(0, sampleAt(bytes, 7)->depth);
+    checkSamples(bytes, 10, 1, 7, 1000, "core1");
+}
+
+static void test_download_in_chunks(void)
+{
+    // Rings filled exactly once and exactly twice: no wrap point to stitch
+    startProfile(10, 1);
+    takeOnBothCores(20, 100, 10, 200);
+    stopProfile();
+
+    AsyncWebServerResponse *response = request();
+    TEST_ASSERT_EQUAL(200, response->code);
+    uint32_t generation;
+    TEST_ASSERT_EQUAL(cpu_profile_size(&generation), response->length);
+    std::vector<uint8_t> whole = download(response, response->length);
+    TEST_ASSERT_EQUAL(response->length, whole.size());
+    checkSamples(whole, 0, 0, 10, 110, "main");
+    checkSamples(whole, 10, 1, 10, 200, "core1");
+
+    // Chunks that split the header, the names and the samples anywhere
+    const size_t chunks[] = {1, 7, sizeof(CpuProfileHeader_t) + 1, sizeof(CpuProfileSample_t) - 1,
+                             sizeof(CpuProfileSample_t), sizeof(CpuProfileSample_t) + 1, 1436};
+    for (size_t chunk : chunks)
+    {
+        std::vector<uint8_t> bytes = download(response, chunk);
+        TEST_ASSERT_EQUAL(whole.size(), bytes.size());
+        TEST_ASSERT_EQUAL(0, memcmp(whole.data(), bytes.data(), whole.size()));
+    }
+
+    // A chunk from the middle of a wrapped ring, and nothing past the end
+    startProfile(10, 1);
+    takeOnBothCores(13, 300, 0, 0);
+    stopProfile();
+    TEST_ASSERT_EQUAL(0, cpu_profile_read(generation, 0, whole.data(), whole.size()));
+    size_t size = cpu_profile_size(&generation);
+    size_t names = sizeof(CpuProfileHeader_t) + cpu_profile_get_status().tasks * CPU_PROFILE_NAME_LEN;
+    uint32_t pc;
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        size_t offset = names + i * sizeof(CpuProfileSample_t) + offsetof(CpuProfileSample_t, pc);
+        TEST_ASSERT_EQUAL(sizeof(pc), cpu_profile_read(generation, offset, (uint8_t *)&pc, sizeof(pc)));
+        TEST_ASSERT_EQUAL(303 + i, pc);
+    }
+    TEST_ASSERT_EQUAL(0, cpu_profile_read(generation, size, whole.data(), 1));
+    TEST_ASSERT_EQUAL(1, cpu_profile_read(generation, size - 1, whole.data(), 10));
+    delete response;
+}
+
+static void test_new_profile_invalidates_the_download(void)
+{
+    startProfile(10, 1);
+    takeOnBothCores(5, 0, 5, 50);
+    stopProfile();
+    AsyncWebServerResponse *old = request();
+    uint8_t buffer[64];
+    TEST_ASSERT_EQUAL(sizeof(buffer), old->filler(buffer, sizeof(buffer), 0));
+    uint32_t oldGeneration = cpu_profile_get_status().generation;
+
+    // Nothing to download while the next one runs, and no second start
+    startProfile(20, 1);
+    TEST_ASSERT_EQUAL_STRING("busy", cpu_profile_start(10, 1));
+    TEST_ASSERT_EQUAL(0, old->filler(buffer, sizeof(buffer), sizeof(buffer)));
+    AsyncWebServerResponse *running = request();
+    TEST_ASSERT_EQUAL(404, running->code);
+    delete running;
+    takeOnBothCores(3, 500, 2, 600);
+    stopProfile();
+
+    // The old download stays cut off, a new one gets the new profile
+    TEST_ASSERT_EQUAL(0, old->filler(buffer, sizeof(buffer), sizeof(buffer)));
+    TEST_ASSERT_EQUAL(0, cpu_profile_read(oldGeneration, 0, buffer, sizeof(buffer)));
+    TEST_ASSERT_EQUAL(oldGeneration + 1, cpu_profile_get_status().generation);
+    AsyncWebServerResponse *response = request();
+    std::vector<uint8_t> bytes = download(response, 100);
+    TEST_ASSERT_EQUAL(response->length, bytes.size());
+    TEST_ASSERT_EQUAL(20, ((const CpuProfileHeader_t *)bytes.data())->hz);
+    TEST_ASSERT_EQUAL(5, ((const CpuProfileHeader_t *)bytes.data())->samples);
+    checkSamples(bytes, 0, 0, 3, 500, "main");
+    checkSamples(bytes, 3, 1, 2, 600, "core1");
+    delete response;
+    delete old;
+
+    TEST_ASSERT_EQUAL_STRING("bad parameters", cpu_profile_start(0, 1));
+    TEST_ASSERT_EQUAL_STRING("bad parameters", cpu_profile_start(CPU_PROFILE_MAX_HZ + 1, 1));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_wrapped_ring_is_read_oldest_first);
+    RUN_TEST(test_download_in_chunks);
+    RUN_TEST(test_new_profile_invalidates_the_download);
+    return UNITY_END();
+}
@@ -0,0 +1,306 @@
+// Event journal on the in-memory LittleFS: range and type queries against a
+// scan of every record, before and after a reload and across rotations,
+// blocks the index lets a query skip, records timed before SNTP, and the
+// cost of an append and of queries over a month of events.
+#include <Arduino.h>
+#include <unity.h>
+#include <LittleFS.h>
+
+#include "storage.cpp"
+#include "event_journal.cpp"
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+SemaphoreHandle_t xStorageMutex;
+
+// The global one, journal_query_json() reads it
+static EventJournal_t &journal = eventJournal;
+static std::vector<EventRecord_t> appended;
+
+static EventRecord_t makeRecord(uint32_t time, EventType_t type, uint8_t flags = 0)
+{
+    EventRecord_t record;
+    record.time = time;
+    record.type = type;
+    record.flags = flags;
+    record.code = (int16_t)appended.size();
+    record.value = (float)time;
+    return record;
+}
+
+static void append(uint32_t time, EventType_t type, uint8_t flags = 0)
+{
+    EventRecord_t record = makeRecord(time, type, flags);
+    TEST_ASSERT_TRUE(appendRecord(&journal, &record));
+    appended.push_back(record);
+}
+
+static void closeJournal()
+{
+    storage_close(journal.data);
+    storage_close(journal.indexFile);
+    vSemaphoreDelete(journal.mutex);
+    memset(&journal, 0, sizeof(journal));
+}
+
+static void reopenJournal()
+{
+    closeJournal();
+    TEST_ASSERT_TRUE(journal_begin(&journal, "jtest"));
+}
+
+// Blocks the query read from the data files
+static size_t blocksRead(uint32_t from, uint32_t to, uint32_t typeMask, size_t *found = NULL)
+{
+    // Buffered records are flushed by the query, not counted as reads
+    storage_sync(journal.data);
+    size_t before = hostFs.bytesRead;
+    size_t matched = journal_query(&journal, from, to, typeMask, NULL, 0);
+    if (found != NULL)
+    {
+        *found = matched;
+    }
+    return (hostFs.bytesRead - before + JOURNAL_BLOCK_BYTES - 1) / JOURNAL_BLOCK_BYTES;
+}
+
+/**
+ * @brief Compares a query against a scan of the records the journal still keeps.
+ */
+static void checkQuery(size_t kept, uint32_t from, uint32_t to, uint32_t typeMask)
+{
+    std::vector<EventRecord_t> expected;
+    for (size_t i = appended.size() - kept; i < appended.size(); i++)
+    {
+        const EventRecord_t &record = appended[i];
+        bool uptime = (record.flags & EVENT_FLAG_UPTIME) != 0;
+        if (uptime == ((typeMask & EVENT_QUERY_UPTIME) != 0) && record.time >= from && record.time <= to &&
+            (typeMask & (1UL << record.type)))
+        {
+            expected.push_back(record);
+        }
+    }
+
+    std::vector<EventRecord_t> out(expected.size() + 1);
+    size_t found = journal_query(&journal, from, to, typeMask, out.data(), out.size());
+    TEST_ASSERT_EQUAL(expected.size(), found);
+    for (size_t i = 0; i < found; i++)
+    {
+        TEST_ASSERT_EQUAL(expected[i].time, out[i].time);
+        TEST_ASSERT_EQUAL(expected[i].type, out[i].type);
+        TEST_ASSERT_EQUAL(expected[i].code, out[i].code);
+    }
+}
+
+static void checkRandomQueries(size_t kept, uint32_t first, uint32_t last)
+{
+    std::mt19937 random(7);
+    for (int q = 0; q < 50; q++)
+    {
+        uint32_t from = first + random() % (last - first);
+        uint32_t to = from + random() % 20000;
+        uint32_t typeMask = (q % 3 == 0) ? EVENT_TYPE_ALL : (random() & EVENT_TYPE_ALL);
+        checkQuery(kept, from, to, typeMask);
+    }
+    checkQuery(kept, 0, UINT32_MAX, EVENT_TYPE_ALL);
+    checkQuery(kept, 0, UINT32_MAX, 1UL << EVENT_ANOMALY);
+}
+
+void setUp(void)
+{
+    hostFs.reset();
+    xStorageMutex = xSemaphoreCreateMutex();
+    appended.clear();
+    memset(&journal, 0, sizeof(journal));
+    TEST_ASSERT_TRUE(journal_begin(&journal, "jtest"));
+}
+
+void tearDown(void)
+{
+    closeJournal();
+    vSemaphoreDelete(xStorageMutex);
+}
+
+static void test_queries_match_a_scan(void)
+{
+    // Roughly ordered times, a few arrive late, types weighted like on a device
+    std::mt19937 random(1);
+    const uint32_t base = 1700000000;
+    for (uint32_t i = 0; i < 5000; i++)
+    {
+        uint32_t r = random() % 100;
+        EventType_t type = r < 2 ? EVENT_ANOMALY : r < 50 ? EVENT_LCD_STATE_CHANGE : r < 90 ? EVENT_MQTT_CONNECT : EVENT_SCHEDULE;
+        append(base + i * 60 - (random() % 4) * 45, type);
+    }
+    uint32_t last = base + 5000 * 60;
+
+    checkRandomQueries(appended.size(), base, last);
+
+    // Reload with the index file, then rebuilt from the records alone
+    reopenJournal();
+    checkRandomQueries(appended.size(), base, last);
+    closeJournal();
+    LittleFS.remove("/jtest.idx");
+    TEST_ASSERT_TRUE(journal_begin(&journal, "jtest"));
+    TEST_ASSERT_EQUAL(5000, journal.current.records);
+    checkRandomQueries(appended.size(), base, last);
+}
+
+static void test_rotation_keeps_two_segments(void)
+{
+    const uint32_t segment = JOURNAL_MAX_BLOCKS * JOURNAL_RECORDS_PER_BLOCK;
+    const uint32_t base = 1700000000;
+    for (uint32_t i = 0; i < 2 * segment + 1000; i++)
+    {
+        append(base + i * 10, (i % 500 == 0) ? EVENT_ANOMALY : EVENT_MQTT_CONNECT);
+    }
+    TEST_ASSERT_EQUAL(segment, journal.previous.records);
+    TEST_ASSERT_EQUAL(1000, journal.current.records);
+
+    // The first segment is gone, the rest is found oldest first
+    checkRandomQueries(segment + 1000, base, base + (2 * segment + 1000) * 10);
+    reopenJournal();
+    checkRandomQueries(segment + 1000, base, base + (2 * segment + 1000) * 10);
+}
+
+static void test_index_prunes_blocks(void)
+{
+    const uint32_t base = 1700000000;
+    for (uint32_t i = 0; i < 20 * JOURNAL_RECORDS_PER_BLOCK; i++)
+    {
+        append(base + i * 60, (i == 5 * JOURNAL_RECORDS_PER_BLOCK + 3) ? EVENT_ANOMALY : EVENT_LCD_STATE_CHANGE);
+    }
+
+    size_t found;
+    // An hour is 60 records, in one or two blocks
+    TEST_ASSERT_TRUE(blocksRead(base + 36000, base + 39599, EVENT_TYPE_ALL, &found) <= 2);
+    TEST_ASSERT_EQUAL(60, found);
+    // One block has the only anomaly, none has a boot
+    TEST_ASSERT_EQUAL(1, blocksRead(0, UINT32_MAX, 1UL << EVENT_ANOMALY, &found));
+    TEST_ASSERT_EQUAL(1, found);
+    TEST_ASSERT_EQUAL(0, blocksRead(0, UINT32_MAX, 1UL << EVENT_BOOT));
+    // Outside every block's range
+    TEST_ASSERT_EQUAL(0, blocksRead(0, base - 1, EVENT_TYPE_ALL));
+    TEST_ASSERT_EQUAL(20, blocksRead(0, UINT32_MAX, EVENT_TYPE_ALL));
+}
+
+static void test_uptime_records_stay_out_of_the_range(void)
+{
+    // Boot before SNTP, then wall clock time
+    const uint32_t base = 1700000000;
+    append(4, EVENT_BOOT, EVENT_FLAG_UPTIME);
+    append(9, EVENT_MQTT_CONNECT, EVENT_FLAG_UPTIME);
+    for (uint32_t i = 0; i < 4 * JOURNAL_RECORDS_PER_BLOCK - 2; i++)
+    {
+        append(base + i * 60, EVENT_LCD_STATE_CHANGE);
+    }
+    // Starts the fifth block
+    append(2, EVENT_BOOT, EVENT_FLAG_UPTIME);
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+        TEST_ASSERT_EQUAL(base, journal.current.index[0].minTime);
+        TEST_ASSERT_EQUAL(1UL << EVENT_LCD_STATE_CHANGE |
+                              ((1UL << EVENT_BOOT | 1UL << EVENT_MQTT_CONNECT) << JOURNAL_UPTIME_TYPE_SHIFT),
+                          journal.current.index[0].typeMask);
+        TEST_ASSERT_EQUAL(1UL << EVENT_LCD_STATE_CHANGE, journal.current.index[1].typeMask);
+        // The uptime-only tail block has no unix range
+        TEST_ASSERT_TRUE(journal.current.index[4].minTime > journal.current.index[4].maxTime);
+
+        // Unix queries neither read nor return the uptime records
+        TEST_ASSERT_EQUAL(0, blocksRead(0, base - 1, EVENT_TYPE_ALL));
+        size_t found;
+        TEST_ASSERT_EQUAL(4, blocksRead(0, UINT32_MAX, EVENT_TYPE_ALL, &found));
+        TEST_ASSERT_EQUAL(4 * JOURNAL_RECORDS_PER_BLOCK - 2, found);
+        TEST_ASSERT_EQUAL(0, blocksRead(0, UINT32_MAX, 1UL << EVENT_BOOT));
+
+        // They are found by uptime, in the blocks marked for it
+        TEST_ASSERT_EQUAL(2, blocksRead(0, UINT32_MAX, EVENT_QUERY_UPTIME | (1UL << EVENT_BOOT), &found));
+        TEST_ASSERT_EQUAL(2, found);
+        checkQuery(appended.size(), 0, 5, EVENT_QUERY_UPTIME | EVENT_TYPE_ALL);
+        checkQuery(appended.size(), 0, UINT32_MAX, EVENT_TYPE_ALL);
+
+        // Same index once rebuilt at boot
+        reopenJournal();
+    }
+}
+
+static void test_query_json_marks_uptime_records(void)
+{
+    append(3, EVENT_BOOT, EVENT_FLAG_UPTIME);
+    append(1700000000, EVENT_ANOMALY);
+
+    StaticJsonDocument<128> params;
+    String payload = journal_query_json(params.as<JsonVariantConst>());
+    TEST_ASSERT_NOT_NULL(strstr(payload.c_str(), "\"matched\":1"));
+    TEST_ASSERT_NOT_NULL(strstr(payload.c_str(), "\"type\":\"ANOMALY\""));
+    TEST_ASSERT_NULL(strstr(payload.c_str(), "BOOT"));
+
+    params["uptime"] = true;
+    payload = journal_query_json(params.as<JsonVariantConst>());
+    TEST_ASSERT_NOT_NULL(strstr(payload.c_str(), "\"matched\":1"));
+    TEST_ASSERT_NOT_NULL(strstr(payload.c_str(), "\"t\":3,\"type\":\"BOOT\""));
+    TEST_ASSERT_NOT_NULL(strstr(payload.c_str(), "\"uptime\":true"));
+}
+
+// Append and query cost over a month of events, the host side of journal_benchmark()
+static void test_benchmark_append_and_month_query(void)
+{
+    const uint32_t count = 15000;
+    const uint32_t base = 1700000000;
+    const uint32_t end = base + (count - 1) * 180;
+
+    auto start = std::chrono::steady_clock::now();
+    double worst = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        EventRecord_t record = makeRecord(base + i * 180,
+                                          (i % 2000 == 0) ? EVENT_ANOMALY : (i % 2 ? EVENT_LCD_STATE_CHANGE : EVENT_MQTT_CONNECT));
+        auto t = std::chrono::steady_clock::now();
+        appendRecord(&journal, &record);
+        worst = std::max(worst, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t).count());
+    }
+    double appendUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / count;
+    char line[160];
+    snprintf(line, sizeof(line), "append: %.2f us/record (max %.1f us)", appendUs, worst);
+    TEST_MESSAGE(line);
+
+    struct
+    {
+        const char *name;
+        uint32_t from;
+        uint32_t to;
+        uint32_t mask;
+        size_t maxBlocks;
+    } queries[] = {
+        {"month, all types", base, end, EVENT_TYPE_ALL, 118},
+        {"month, ANOMALY", base, end, 1UL << EVENT_ANOMALY, 8},
+        {"month, BOOT (none)", base, end, 1UL << EVENT_BOOT, 0},
+        {"last day, all types", end - 86400, end, EVENT_TYPE_ALL, 5},
+        {"one hour, all types", base + 86400, base + 90000, EVENT_TYPE_ALL, 2},
+    };
+    for (size_t q = 0; q < sizeof(queries) / sizeof(queries[0]); q++)
+    {
+        size_t found;
+        auto t = std::chrono::steady_clock::now();
+        size_t blocks = blocksRead(queries[q].from, queries[q].to, queries[q].mask, &found);
+        double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t).count();
+        snprintf(line, sizeof(line), "query %-20s %6u matches, %3u of %u blocks read in %.1f us", queries[q].name,
+                 (unsigned)found, (unsigned)blocks, (unsigned)((count + JOURNAL_RECORDS_PER_BLOCK - 1) / JOURNAL_RECORDS_PER_BLOCK), us);
+        TEST_MESSAGE(line);
+        TEST_ASSERT_TRUE(blocks <= queries[q].maxBlocks);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_queries_match_a_scan);
+    RUN_TEST(test_rotation_keeps_two_segments);
+    RUN_TEST(test_index_prunes_blocks);
+    RUN_TEST(test_uptime_records_stay_out_of_the_range);
+    RUN_TEST(test_query_json_marks_uptime_records);
+    RUN_TEST(test_benchmark_append_and_month_query);
+    return UNITY_END();
+}
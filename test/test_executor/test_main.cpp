@@ -0,0 +1,258 @@
+// Deferred-work executor with real worker threads: every job run exactly
+// once under concurrent producers and nested submissions, completion
+// callbacks and futures, the bounded pool, and HIGH before NORMAL.
+#include <Arduino.h>
+#include <unity.h>
+
+#include "executor.cpp"
+
+#include <functional>
+#include <vector>
+
+static const int STRESS_JOBS = 20000;
+
+static std::atomic<int> marks[2 * STRESS_JOBS];
+static std::atomic<long> ran(0);
+static std::atomic<int> producersDone(0);
+
+static void leaf(void *arg)
+{
+    marks[(intptr_t)arg].fetch_add(1);
+    ran++;
+}
+
+// Submitted from a job: lands on the deque of the worker running it
+static void parent(void *arg)
+{
+    intptr_t i = (intptr_t)arg;
+    marks[i].fetch_add(1);
+    ran++;
+    while (!executor_submit(leaf, (void *)(i + STRESS_JOBS), EXECUTOR_PRIORITY_HIGH))
+    {
+        taskYIELD();
+    }
+}
+
+static void producer(void *pvParameters)
+{
+    intptr_t first = (intptr_t)pvParameters;
+    for (intptr_t i = first; i < STRESS_JOBS; i += 4)
+    {
+        while (!executor_submit(parent, (void *)i, (ExecutorPriority_t)(i & 1)))
+        {
+            taskYIELD();
+        }
+    }
+    producersDone++;
+    vTaskDelete(NULL);
+}
+
+static bool waitFor(std::function<bool()> ready, unsigned long timeoutMs)
+{
+    unsigned long start = millis();
+    while (!ready())
+    {
+        if (millis() - start > timeoutMs)
+        {
+            return false;
+        }
+        vTaskDelay(1);
+    }
+    return true;
+}
+
+// Holds a worker until the gate opens
+static std::atomic<bool> gateOpen(true);
+static std::atomic<int> gated(0);
+
+static void gate(void *arg)
+{
+    gated++;
+    while (!gateOpen.load())
+    {
+        vTaskDelay(1);
+    }
+    gated--;
+}
+
+// Blocks every worker, so whatever is submitted next stays queued
+static void closeGate()
+{
+    gateOpen = false;
+    for (int i = 0; i < EXECUTOR_WORKERS; i++)
+    {
+        TEST_ASSERT_TRUE(executor_submit(gate, NULL, EXECUTOR_PRIORITY_HIGH));
+        // One each, the next worker steals the next gate
+        TEST_ASSERT_TRUE(waitFor([i] { return gated.load() == i + 1; }, 1000));
+    }
+}
+
+// Releases the workers, the next closeGate() must not catch a gate still leaving
+static bool openGate()
+{
+    gateOpen = true;
+    return waitFor([] { return gated.load() == 0; }, 1000);
+}
+
+static std::mutex orderMutex;
+static std::vector<intptr_t> order;
+
+static void recordOrder(void *arg)
+{
+    std::lock_guard<std::mutex> lock(orderMutex);
+    order.push_back((intptr_t)arg);
+}
+
+void setUp(void)
+{
+    // Workers run forever, the executor is set up once for the whole suite
+    static bool started = false;
+    if (started)
+    {
+        return;
+    }
+    executor_begin();
+    for (int i = 0; i < EXECUTOR_WORKERS; i++)
+    {
+        xTaskCreatePinnedToCore(executor_worker_task, "Task Executor", 4096, (void *)(intptr_t)i,
+                                EXECUTOR_TASK_PRIORITY, NULL, i % portNUM_PROCESSORS);
+    }
+    started = true;
+}
+
+void tearDown(void)
+{
+    openGate();
+}
+
+static void test_every_job_runs_once(void)
+{
+    ExecutorStats_t before = executor_get_stats();
+    // Two producers per core, into the inboxes of both workers
+    for (int p = 0; p < 4; p++)
+    {
+        xTaskCreatePinnedToCore(producer, "Task Producer", 4096, (void *)(intptr_t)p, 1, NULL, p % 2);
+    }
+    TEST_ASSERT_TRUE(waitFor([] { return producersDone.load() == 4 && ran.load() == 2 * STRESS_JOBS; }, 20000));
+
+    int wrong = 0;
+    for (int i = 0; i < 2 * STRESS_JOBS; i++)
+    {
+        wrong += marks[i].load() != 1;
+    }
+    TEST_ASSERT_EQUAL(0, wrong);
+
+    ExecutorStats_t after = executor_get_stats();
+    uint32_t executed = 0;
+    char line[80];
+    for (int i = 0; i < EXECUTOR_WORKERS; i++)
+    {
+        uint32_t jobs = after.workers[i].executed - before.workers[i].executed;
+        snprintf(line, sizeof(line), "worker %d: %lu jobs, %lu stolen", i, (unsigned long)jobs,
+                 (unsigned long)(after.workers[i].stolen - before.workers[i].stolen));
+        TEST_MESSAGE(line);
+        executed += jobs;
+    }
+    TEST_ASSERT_EQUAL(2 * STRESS_JOBS, executed);
+    TEST_ASSERT_EQUAL(2 * STRESS_JOBS, after.submitted - before.submitted);
+    // No slot was lost on a free ring that looked full
+    TEST_ASSERT_EQUAL(EXECUTOR_MAX_JOBS, freeSlots.tail.load() - freeSlots.head.load());
+}
+
+static std::atomic<int> doneCalls(0);
+static std::atomic<int> jobValue(0);
+
+static void setValue(void *arg)
+{
+    jobValue = (int)(intptr_t)arg;
+}
+
+static void afterSetValue(void *arg)
+{
+    // Same arg, and the job has already run
+    if (jobValue.load() == (int)(intptr_t)arg)
+    {
+        doneCalls++;
+    }
+}
+
+static void test_done_callback_and_future(void)
+{
+    ExecutorFuture_t future;
+    executor_future_init(&future);
+    for (intptr_t round = 1; round <= 3; round++)
+    {
+        TEST_ASSERT_TRUE(executor_submit(setValue, (void *)round, EXECUTOR_PRIORITY_NORMAL, afterSetValue, &future));
+        TEST_ASSERT_TRUE(executor_wait(&future, 1000));
+        // The future completes after the callback
+        TEST_ASSERT_EQUAL(round, doneCalls.load());
+        TEST_ASSERT_TRUE(future.submittedUs <= future.startedUs);
+        TEST_ASSERT_TRUE(future.startedUs <= future.finishedUs);
+    }
+}
+
+static void test_full_pool_rejects_without_running(void)
+{
+    closeGate();
+    ExecutorStats_t before = executor_get_stats();
+    ran = 0;
+    int queued = 0;
+    while (executor_submit(leaf, (void *)0, EXECUTOR_PRIORITY_NORMAL))
+    {
+        queued++;
+        TEST_ASSERT_TRUE(queued <= EXECUTOR_MAX_JOBS);
+    }
+    // A running job has given its slot back already, the gates hold none
+    TEST_ASSERT_EQUAL(EXECUTOR_MAX_JOBS, queued);
+    TEST_ASSERT_FALSE(executor_submit(leaf, (void *)0, EXECUTOR_PRIORITY_HIGH));
+    TEST_ASSERT_EQUAL(2, executor_get_stats().rejected - before.rejected);
+    TEST_ASSERT_EQUAL(0, ran.load());
+
+    TEST_ASSERT_TRUE(openGate());
+    TEST_ASSERT_TRUE(waitFor([queued] { return ran.load() == queued; }, 1000));
+    // The slots are free again
+    ExecutorFuture_t future;
+    executor_future_init(&future);
+    TEST_ASSERT_TRUE(executor_submit(leaf, (void *)0, EXECUTOR_PRIORITY_NORMAL, NULL, &future));
+    TEST_ASSERT_TRUE(executor_wait(&future, 1000));
+}
+
+static void test_high_priority_runs_first(void)
+{
+    const int count = 8;
+    closeGate();
+    order.clear();
+    for (intptr_t i = 0; i < count; i++)
+    {
+        TEST_ASSERT_TRUE(executor_submit(recordOrder, (void *)i, EXECUTOR_PRIORITY_NORMAL));
+    }
+    for (intptr_t i = 0; i < count; i++)
+    {
+        TEST_ASSERT_TRUE(executor_submit(recordOrder, (void *)(100 + i), EXECUTOR_PRIORITY_HIGH));
+    }
+    TEST_ASSERT_TRUE(openGate());
+    TEST_ASSERT_TRUE(waitFor([] {
+        std::lock_guard<std::mutex> lock(orderMutex);
+        return order.size() == 2 * count;
+    }, 1000));
+
+    // A worker only takes a NORMAL job once it found no HIGH one left, the
+    // others may still be running the last HIGH jobs then
+    int highFirst = 0;
+    for (int i = 0; i < count; i++)
+    {
+        highFirst += order[i] >= 100;
+    }
+    TEST_ASSERT_TRUE(order[0] >= 100);
+    TEST_ASSERT_TRUE(highFirst >= count - (EXECUTOR_WORKERS - 1));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_every_job_runs_once);
+    RUN_TEST(test_done_callback_and_future);
+    RUN_TEST(test_full_pool_rejects_without_running);
+    RUN_TEST(test_high_priority_runs_first);
+    return UNITY_END();
+}
@@ -0,0 +1,63 @@
+// Worst case flash footprint of the stores against the 1.5 MB LittleFS
+// partition of the board, and the boot check that catches limits raised
+// past it.
+#include <Arduino.h>
+#include <unity.h>
+
+#include "flash_budget.cpp"
+
+void setUp(void)
+{
+    hostFs.reset();
+}
+
+void tearDown(void)
+{
+}
+
+static void test_stores_fit_the_partition(void)
+{
+    size_t stores = flash_budget_bytes();
+    char line[120];
+    snprintf(line, sizeof(line), "stores %u + reserve %u of %u bytes", (unsigned)stores,
+             (unsigned)FLASH_BUDGET_RESERVE_BYTES, (unsigned)hostFs.totalBytes);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_TRUE(flash_budget_check());
+    // The data/ folder alone takes 15 blocks, the rest is for LittleFS
+    TEST_ASSERT_GREATER_THAN(15 * STORAGE_BLOCK_SIZE, FLASH_BUDGET_RESERVE_BYTES);
+}
+
+static void test_every_file_counts_whole_blocks(void)
+{
+    TEST_ASSERT_EQUAL(0, blocks(0));
+    TEST_ASSERT_EQUAL(STORAGE_BLOCK_SIZE, blocks(1));
+    TEST_ASSERT_EQUAL(STORAGE_BLOCK_SIZE, blocks(STORAGE_BLOCK_SIZE));
+    TEST_ASSERT_EQUAL(2 * STORAGE_BLOCK_SIZE, blocks(STORAGE_BLOCK_SIZE + 1));
+    TEST_ASSERT_EQUAL(0, flash_budget_bytes() % STORAGE_BLOCK_SIZE);
+}
+
+// The tiers at their former size: 1 year of hours and 3 days of minutes
+static void test_former_tier_sizes_do_not_fit(void)
+{
+    size_t former = flash_budget_bytes() -
+                    2 * blocks(HISTORY_MINUTE_SEGMENT_RECORDS * sizeof(HistoryAggregate_t)) -
+                    2 * blocks(HISTORY_HOUR_SEGMENT_RECORDS * sizeof(HistoryAggregate_t)) +
+                    2 * blocks(4320 * sizeof(HistoryAggregate_t)) + 2 * blocks(8760 * sizeof(HistoryAggregate_t));
+    TEST_ASSERT_GREATER_THAN(hostFs.totalBytes - FLASH_BUDGET_RESERVE_BYTES, former);
+}
+
+static void test_smaller_partition_fails_the_check(void)
+{
+    hostFs.totalBytes = flash_budget_bytes() + FLASH_BUDGET_RESERVE_BYTES - STORAGE_BLOCK_SIZE;
+    TEST_ASSERT_FALSE(flash_budget_check());
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_stores_fit_the_partition);
+    RUN_TEST(test_every_file_counts_whole_blocks);
+    RUN_TEST(test_former_tier_sizes_do_not_fit);
+    RUN_TEST(test_smaller_partition_fails_the_check);
+    return UNITY_END();
+}
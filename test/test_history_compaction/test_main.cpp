@@ -0,0 +1,343 @@
+// History compaction on the in-memory LittleFS, with small segments so the
+// raw history, the minute and the hour tier all rotate: aggregates against a
+// brute force over the raw samples, history_query() without gaps or
+// overlaps between tiers, no sample lost to a rotation, and the flash bytes
+// read and written per pass.
+#include <Arduino.h>
+#include <unity.h>
+#include <LittleFS.h>
+
+#include <time.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+// 2 h of raw samples at one per 5 s, 100 minutes (not whole hours), 12 h of hours per segment
+#define HISTORY_SEGMENT_RECORDS 1440
+#define HISTORY_MINUTE_SEGMENT_RECORDS 100
+#define HISTORY_HOUR_SEGMENT_RECORDS 12
+
+#include "storage.cpp"
+#include "sample_history.cpp"
+#include "history_compaction.cpp"
+
+SemaphoreHandle_t xStorageMutex;
+SemaphoreHandle_t xHistoryMutex;
+SemaphoreHandle_t xCompactionMutex;
+
+// The wall clock history_append() reads, overrides the C library's time()
+static time_t hostTime;
+
+time_t time(time_t *t) noexcept
+{
+    if (t != NULL)
+    {
+        *t = hostTime;
+    }
+    return hostTime;
+}
+
+static const uint32_t base = 1700000000 - 1700000000 % 3600;
+static std::vector<HistorySample_t> samples;    // every sample appended with a unix time
+
+static void appendSample(std::mt19937 &random)
+{
+    float temperature = 20.0f + (random() % 2000) / 100.0f - 10.0f;
+    float humidity = 40.0f + (random() % 4000) / 100.0f;
+    TEST_ASSERT_TRUE(history_append(temperature, humidity));
+    HistorySample_t sample;
+    sample.time = (uint32_t)hostTime;
+    sample.temperature = (int16_t)lroundf(temperature * 100);
+    sample.humidity = (uint16_t)lroundf(humidity * 100);
+    samples.push_back(sample);
+}
+
+/**
+ * @brief Appends a sample every 5 s for `seconds`, with an outage now and then,
+ *        compacting every `compactEvery` samples like the background task.
+ */
+static void run(uint32_t seconds, uint32_t compactEvery)
+{
+    std::mt19937 random(3);
+    uint32_t end = hostTime + seconds;
+    uint32_t n = 0;
+    while ((uint32_t)hostTime < end)
+    {
+        appendSample(random);
+        hostTime += (random() % 200 == 0) ? 5 + random() % 900 : 5;
+        if (++n % compactEvery == 0)
+        {
+            while (history_compact())
+            {
+            }
+        }
+    }
+}
+
+// Brute force aggregate of the samples in [from, from + seconds)
+static HistoryAggregate_t expected(uint32_t from, uint32_t seconds)
+{
+    HistoryAggregate_t aggregate = {};
+    int32_t temperatureSum = 0;
+    uint32_t humiditySum = 0;
+    aggregate.temperatureMin = INT16_MAX;
+    aggregate.temperatureMax = INT16_MIN;
+    aggregate.humidityMin = UINT16_MAX;
+    for (const HistorySample_t &sample : samples)
+    {
+        if (sample.time >= from && sample.time < from + seconds)
+        {
+            aggregate.count++;
+            aggregate.temperatureMin = std::min(aggregate.temperatureMin, sample.temperature);
+            aggregate.temperatureMax = std::max(aggregate.temperatureMax, sample.temperature);
+            aggregate.humidityMin = std::min(aggregate.humidityMin, sample.humidity);
+            aggregate.humidityMax = std::max(aggregate.humidityMax, sample.humidity);
+            temperatureSum += sample.temperature;
+            humiditySum += sample.humidity;
+        }
+    }
+    if (aggregate.count > 0)
+    {
+        aggregate.temperatureMean = divideRounded(temperatureSum, aggregate.count);
+        aggregate.humidityMean = (uint16_t)divideRounded((int32_t)humiditySum, aggregate.count);
+    }
+    return aggregate;
+}
+
+/**
+ * @brief Checks every stored aggregate of a tier against the raw samples.
+ * @param meanTolerance Hour means are means of rounded minute means
+ */
+static uint32_t checkTier(uint8_t level, int meanTolerance)
+{
+    uint32_t count = levelCount(level);
+    std::vector<HistoryAggregate_t> records(count);
+    TEST_ASSERT_EQUAL(count, levelRead(level, 0, records.data(), count));
+    for (const HistoryAggregate_t &record : records)
+    {
+        HistoryAggregate_t brute = expected(record.time, record.seconds);
+        TEST_ASSERT_EQUAL(tiers[level - 1].seconds, record.seconds);
+        TEST_ASSERT_EQUAL(0, record.time % record.seconds);
+        TEST_ASSERT_EQUAL(brute.count, record.count);
+        TEST_ASSERT_EQUAL(brute.temperatureMin, record.temperatureMin);
+        TEST_ASSERT_EQUAL(brute.temperatureMax, record.temperatureMax);
+        TEST_ASSERT_EQUAL(brute.humidityMin, record.humidityMin);
+        TEST_ASSERT_EQUAL(brute.humidityMax, record.humidityMax);
+        TEST_ASSERT_INT_WITHIN(meanTolerance, brute.temperatureMean, record.temperatureMean);
+        TEST_ASSERT_INT_WITHIN(meanTolerance, brute.humidityMean, record.humidityMean);
+    }
+    return count;
+}
+
+/**
+ * @brief Reads the whole history through history_query() in chunks.
+ */
+static std::vector<HistoryAggregate_t> queryAll()
+{
+    std::vector<HistoryAggregate_t> all;
+    HistoryAggregate_t chunk[37];
+    uint32_t from = 0;
+    while (true)
+    {
+        size_t n = history_query(from, UINT32_MAX, chunk, 37);
+        if (n == 0)
+        {
+            break;
+        }
+        all.insert(all.end(), chunk, chunk + n);
+        from = chunk[n - 1].time + std::max((uint32_t)chunk[n - 1].seconds, (uint32_t)1);
+    }
+    return all;
+}
+
+void setUp(void)
+{
+    hostFs.reset();
+    xStorageMutex = xSemaphoreCreateMutex();
+    xHistoryMutex = xSemaphoreCreateMutex();
+    xCompactionMutex = xSemaphoreCreateMutex();
+    memset(&stats, 0, sizeof(stats));
+    samples.clear();
+    hostTime = base;
+    TEST_ASSERT_TRUE(history_begin());
+    history_compaction_begin();
+}
+
+void tearDown(void)
+{
+    storage_close(samplesFile);
+    vSemaphoreDelete(xCompactionMutex);
+    vSemaphoreDelete(xHistoryMutex);
+    vSemaphoreDelete(xStorageMutex);
+}
+
+static void test_aggregates_match_a_brute_force(void)
+{
+    run(10 * 3600, 60);
+    uint32_t minutes = checkTier(1, 0);
+    uint32_t hours = checkTier(2, 1);
+    char line[96];
+    snprintf(line, sizeof(line), "%u samples: %u minutes, %u hours stored", (unsigned)samples.size(),
+             (unsigned)minutes, (unsigned)hours);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_TRUE(hours >= 4);
+    TEST_ASSERT_EQUAL(0, history_compaction_get_stats().lost);
+}
+
+/**
+ * @brief history_query() over everything: intervals follow each other, finer
+ *        tiers start where coarser ones end, and every sample from the oldest
+ *        one still stored on is counted exactly once.
+ */
+static void checkCoverage()
+{
+    std::vector<HistoryAggregate_t> all = queryAll();
+    TEST_ASSERT_TRUE(all.size() > 0);
+
+    uint32_t covered = 0;
+    for (size_t i = 0; i < all.size(); i++)
+    {
+        if (i > 0)
+        {
+            TEST_ASSERT_TRUE(all[i].time >= all[i - 1].time + std::max((uint32_t)all[i - 1].seconds, (uint32_t)1));
+            TEST_ASSERT_TRUE(all[i].seconds <= all[i - 1].seconds);
+        }
+        covered += all[i].count;
+    }
+    uint32_t oldest = all[0].time;
+    uint32_t stored = std::count_if(samples.begin(), samples.end(),
+                                    [oldest](const HistorySample_t &sample) { return sample.time >= oldest; });
+    TEST_ASSERT_EQUAL(stored, covered);
+    TEST_ASSERT_EQUAL(samples.back().time, all.back().time);
+}
+
+static void test_query_has_no_gaps_or_overlaps(void)
+{
+    // Checked every minute, between rotations and compaction passes alike
+    std::mt19937 random(4);
+    for (int minute = 0; minute < 10 * 60; minute++)
+    {
+        for (int i = 0; i < 12; i++)
+        {
+            appendSample(random);
+            hostTime += 5;
+        }
+        checkCoverage();
+        if (minute % 5 == 4)
+        {
+            while (history_compact())
+            {
+            }
+            checkCoverage();
+        }
+    }
+    TEST_ASSERT_EQUAL(base, queryAll()[0].time);
+}
+
+static void test_no_samples_lost_across_rotations(void)
+{
+    // A boot before SNTP: those samples cannot be placed and are skipped
+    hostTime = 1000;
+    std::mt19937 random(9);
+    for (int i = 0; i < 10; i++)
+    {
+        TEST_ASSERT_TRUE(history_append(21.0f, 50.0f));
+    }
+    hostTime = base;
+
+    // Compacted only every 20 minutes, each raw rotation still finds the aged segment done
+    run(12 * 3600, 240);
+    HistoryCompactionStats_t result = history_compaction_get_stats();
+    TEST_ASSERT_EQUAL(0, result.lost);
+    TEST_ASSERT_EQUAL(10, result.skipped);
+    TEST_ASSERT_TRUE(history_generation() >= 5);
+    TEST_ASSERT_TRUE(tiers[0].generation >= 2);
+    checkTier(1, 0);
+    checkTier(2, 1);
+
+    // A reset in between: compaction resumes after the newest aggregate
+    storage_close(samplesFile);
+    TEST_ASSERT_TRUE(history_begin());
+    history_compaction_begin();
+    run(6 * 3600, 60);
+    TEST_ASSERT_EQUAL(0, history_compaction_get_stats().lost);
+    checkTier(1, 0);
+    checkTier(2, 1);
+
+    // Without compaction two rotations drop an aged segment, and say so
+    uint32_t aged = history_aged();
+    uint32_t generation = history_generation();
+    while (history_generation() < generation + 2)
+    {
+        appendSample(random);
+        hostTime += 5;
+    }
+    while (history_compact())
+    {
+    }
+    TEST_ASSERT_TRUE(history_compaction_get_stats().lost >= aged);
+}
+
+// Flash read and written per compaction pass, the cost stated in history_compaction.h
+static void test_io_per_pass(void)
+{
+    std::mt19937 random(5);
+    for (int i = 0; i < 2 * HISTORY_SEGMENT_RECORDS; i++)
+    {
+        appendSample(random);
+        hostTime += 5;
+    }
+    TEST_ASSERT_EQUAL(HISTORY_SEGMENT_RECORDS, history_aged());
+
+    // One aged raw segment, compacted in bounded passes
+    TEST_ASSERT_EQUAL(0, history_compaction_get_stats().passes);
+    size_t readBefore = hostFs.bytesRead;
+    while (history_compact())
+    {
+    }
+    HistoryCompactionStats_t result = history_compaction_get_stats();
+    size_t fsRead = hostFs.bytesRead - readBefore;
+
+    char line[160];
+    snprintf(line, sizeof(line), "%lu passes: %lu B read (%lu B incl. searches), %lu B written, %.0f B read / %.0f B written per pass",
+             (unsigned long)result.passes, (unsigned long)result.bytesRead, (unsigned long)fsRead,
+             (unsigned long)result.bytesWritten, (double)result.bytesRead / result.passes,
+             (double)result.bytesWritten / result.passes);
+    TEST_MESSAGE(line);
+
+    // The raw segment gives 120 minutes, which rotate the minute tier once
+    uint32_t minutesAged = tiers[0].oldRecords;
+    TEST_ASSERT_EQUAL(HISTORY_MINUTE_SEGMENT_RECORDS, minutesAged);
+    TEST_ASSERT_EQUAL((HISTORY_SEGMENT_RECORDS + HISTORY_COMPACT_BATCH - 1) / HISTORY_COMPACT_BATCH +
+                          (minutesAged + HISTORY_COMPACT_BATCH - 1) / HISTORY_COMPACT_BATCH,
+                      result.passes);
+    TEST_ASSERT_EQUAL(HISTORY_SEGMENT_RECORDS + minutesAged, result.recordsRead);
+    TEST_ASSERT_EQUAL(HISTORY_SEGMENT_RECORDS * sizeof(HistorySample_t) + minutesAged * sizeof(HistoryAggregate_t),
+                      result.bytesRead);
+    // Each pass reads at most one batch
+    TEST_ASSERT_TRUE(result.bytesRead / result.passes <= HISTORY_COMPACT_BATCH * sizeof(HistoryAggregate_t));
+    // On top of that, the start searches: 16 samples or one aggregate per probe
+    TEST_ASSERT_TRUE(fsRead - result.bytesRead <= 12 * 16 * sizeof(HistorySample_t) + 8 * sizeof(HistoryAggregate_t));
+
+    // What the stats count is what reached the tier files
+    size_t stored = 0;
+    for (const HistoryTier_t &tier : tiers)
+    {
+        for (const char *path : {tier.path, tier.oldPath})
+        {
+            stored += hostFs.files.count(path) ? hostFs.files[path]->size() : 0;
+        }
+    }
+    TEST_ASSERT_EQUAL(result.recordsWritten * sizeof(HistoryAggregate_t), result.bytesWritten);
+    TEST_ASSERT_EQUAL(result.bytesWritten, stored);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_aggregates_match_a_brute_force);
+    RUN_TEST(test_query_has_no_gaps_or_overlaps);
+    RUN_TEST(test_no_samples_lost_across_rotations);
+    RUN_TEST(test_io_per_pass);
+    return UNITY_END();
+}
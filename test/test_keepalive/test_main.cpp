@@ -0,0 +1,303 @@
+// Adaptive keepalive against a broker stand-in behind a simulated NAT, 48 h
+// on the fake clock per run: pings per hour, drops and lost server-to-device
+// messages for the fixed 15 s interval and the learned one.
+#include <Arduino.h>
+#include <unity.h>
+#include <PubSubClient.h>
+
+#include "keepalive.cpp"
+
+#include <deque>
+#include <vector>
+
+static int64_t nowMs()
+{
+    return hostFakeMicros / 1000;
+}
+
+// The NAT forgets flows idle longer than natTimeoutMs, then either resets
+// the connection or silently drops the next packet. The broker closes a
+// session after 1.5 keep alive without a packet from the client.
+class NatBroker : public Client
+{
+public:
+    int64_t natTimeoutMs;
+    bool reset;
+    bool open = false;
+    bool mapped = false;
+    int64_t lastSeen = 0;
+    int64_t lastFromClient = 0;
+    int64_t killAt = 0;
+    uint16_t keepAlive = 0;
+    long pings = 0;
+    long lostInbound = 0;
+    long brokerKills = 0;
+
+    NatBroker(int64_t timeoutMs, bool sendsReset) : natTimeoutMs(timeoutMs), reset(sendsReset) {}
+
+    bool alive() { return mapped && nowMs() - lastSeen <= natTimeoutMs; }
+
+    int connect(IPAddress ip, uint16_t port) override
+    {
+        open = mapped = true;
+        lastSeen = lastFromClient = nowMs();
+        in.clear();
+        later.clear();
+        return 1;
+    }
+    int connect(const char *host, uint16_t port) override { return connect(IPAddress(), port); }
+    size_t write(uint8_t b) override { return write(&b, 1); }
+    size_t write(const uint8_t *buf, size_t size) override
+    {
+        if (!open)
+            return 0;
+        if (!alive())
+        {
+            // The flow is gone, the packet never reaches the broker
+            mapped = false;
+            if (reset && killAt == 0)
+                killAt = nowMs() + 50;
+            return size;
+        }
+        lastSeen = lastFromClient = nowMs();
+        uint8_t type = buf[0] & 0xF0;
+        if ((buf[0] & 0xF6) == 0x32)
+            type = 0x32;
+        if (type == 0x10)
+        {
+            keepAlive = (buf[10] << 8) | buf[11];
+            later.push_back({nowMs(), {0x20, 2, 0, 0}});
+        }
+        else if (type == 0x32)
+        {
+            // QoS 1 PUBLISH, a one byte remaining length: PUBACK of its packet id
+            size_t id = 4 + ((buf[2] << 8) | buf[3]);
+            later.push_back({nowMs() + 50, {0x40, 2, buf[id], buf[id + 1]}});
+        }
+        else if (type == 0xC0)
+        {
+            pings++;
+            later.push_back({nowMs() + 50, {0xD0, 0}});
+        }
+        return size;
+    }
+    void tick()
+    {
+        if (open && keepAlive && nowMs() - lastFromClient > keepAlive * 1500LL)
+        {
+            brokerKills++;
+            open = false;
+        }
+        if (killAt && nowMs() >= killAt)
+        {
+            killAt = 0;
+            open = false;
+        }
+    }
+    // A server-to-device message, e.g. an RPC request
+    void inbound()
+    {
+        if (!open)
+            return;
+        if (!alive())
+        {
+            lostInbound++;
+            mapped = false;
+            return;
+        }
+        lastSeen = nowMs();
+        later.push_back({nowMs() + 50, {0x30, 5, 0, 1, 'x', 'h', 'i'}});
+    }
+    int available() override
+    {
+        while (!later.empty() && later.front().first <= nowMs())
+        {
+            if (mapped)
+            {
+                lastSeen = nowMs();
+                in.insert(in.end(), later.front().second.begin(), later.front().second.end());
+            }
+            later.pop_front();
+        }
+        return (int)in.size();
+    }
+    int read() override
+    {
+        if (available() == 0)
+            return -1;
+        int c = in.front();
+        in.pop_front();
+        return c;
+    }
+    int read(uint8_t *buf, size_t size) override { return -1; }
+    int peek() override { return -1; }
+    void flush() override {}
+    void stop() override { open = false; }
+    uint8_t connected() override { return open; }
+    operator bool() override { return open; }
+
+private:
+    std::deque<uint8_t> in;
+    std::deque<std::pair<int64_t, std::vector<uint8_t>>> later;
+};
+
+typedef struct {
+    double pingsPerHour;
+    long drops;
+    long lostInbound;
+    long brokerKills;
+    uint32_t probes;
+    uint16_t safe;
+    uint16_t limit;
+} NatResult_t;
+
+static void ignoreMessage(char *topic, uint8_t *payload, unsigned int length)
+{
+}
+
+/**
+ * @param natS NAT timeout for the first half of the run
+ * @param natLaterS NAT timeout for the second half
+ * @param telemetryMs Period of device-to-server publishes, 0 for none
+ */
+static NatResult_t run(bool adaptive, int64_t natS, int64_t natLaterS, bool reset, uint32_t telemetryMs)
+{
+    const int64_t hours = 48;
+    const int64_t end = hours * 3600000;
+    record = {0, KEEPALIVE_MIN_S, 0};
+    stats = {};
+    loaded = false;
+    negotiated = KEEPALIVE_MAX_S;
+    interval = KEEPALIVE_MIN_S;
+    confirmations = 0;
+    hostNvs.reset();
+    hostFakeMicros = 0;
+    srand(1);
+
+    NatBroker broker(natS * 1000, reset);
+    PubSubClient client(broker);
+    client.setProtocolVersion(MQTT_VERSION_3_1_1);
+    client.setServer("broker", 1883);
+    client.setCallback(ignoreMessage);
+
+    long drops = 0;
+    bool wasConnected = false;
+    uint16_t pingCount = 0;
+    int64_t nextInbound = 1800000;
+    int64_t nextTelemetry = telemetryMs;
+    for (; nowMs() < end; hostFakeMicros += 100000)
+    {
+        if (nowMs() >= end / 2)
+            broker.natTimeoutMs = natLaterS * 1000;
+        broker.tick();
+        if (!client.connected())
+        {
+            if (wasConnected)
+            {
+                drops++;
+                if (adaptive)
+                    keepalive_on_drop(false);
+                wasConnected = false;
+            }
+            client.setKeepAlive(adaptive ? keepalive_connect_value("lab") : KEEPALIVE_MIN_S);
+            if (!client.connect("device"))
+                continue;
+            wasConnected = true;
+            client.setPingInterval(adaptive ? keepalive_on_connect(client.getKeepAlive()) : 0);
+        }
+        client.loop();
+        if (adaptive && client.getPingCount() != pingCount)
+        {
+            pingCount = client.getPingCount();
+            client.setPingInterval(keepalive_on_ping(client.getPingIdle()));
+        }
+        if (telemetryMs > 0 && nowMs() >= nextTelemetry)
+        {
+            // QoS 1 like the raw telemetry of coreiot
+            MQTTPublishOptions options;
+            options.qos = 1;
+            client.publish("v1/devices/me/telemetry", (const uint8_t *)"{\"temperature\":25.0}", 20, false, options);
+            nextTelemetry += telemetryMs;
+        }
+        if (nowMs() >= nextInbound)
+        {
+            broker.inbound();
+            nextInbound += 1800000 + rand() % 600000;
+        }
+    }
+    hostFakeMicros = -1;
+
+    KeepaliveStats_t learned = keepalive_get_stats();
+    return {(double)broker.pings / hours, drops, broker.lostInbound, broker.brokerKills, learned.probes,
+            learned.safe, learned.limit};
+}
+
+static void report(const char *path, const NatResult_t &fixed, const NatResult_t &adaptive)
+{
+    char line[160];
+    snprintf(line, sizeof(line), "%-22s pings/h %6.1f -> %5.1f, drops %ld -> %ld, lost %ld -> %ld, safe/limit %u/%u s",
+             path, fixed.pingsPerHour, adaptive.pingsPerHour, fixed.drops, adaptive.drops, fixed.lostInbound,
+             adaptive.lostInbound, adaptive.safe, adaptive.limit);
+    TEST_MESSAGE(line);
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+static void test_idle_link_learns_the_nat_timeout(void)
+{
+    struct {
+        const char *name;
+        int64_t nat;
+        int64_t natLater;
+        bool reset;
+    } paths[] = {{"NAT 300 s, RST", 300, 300, true},
+                 {"NAT 300 s, silent", 300, 300, false},
+                 {"NAT 120 s, silent", 120, 120, false},
+                 {"NAT 3600 s, RST", 3600, 3600, true},
+                 {"NAT 600 -> 120 s", 600, 120, false}};
+    for (const auto &path : paths)
+    {
+        NatResult_t fixed = run(false, path.nat, path.natLater, path.reset, 0);
+        NatResult_t adaptive = run(true, path.nat, path.natLater, path.reset, 0);
+        report(path.name, fixed, adaptive);
+
+        TEST_ASSERT_EQUAL(0, fixed.drops);
+        TEST_ASSERT_TRUE(adaptive.pingsPerHour < fixed.pingsPerHour / 5);
+        // Learned within the timeout of the path at the end of the run
+        TEST_ASSERT_TRUE(adaptive.safe <= path.natLater);
+        TEST_ASSERT_EQUAL(0, adaptive.lostInbound);
+        TEST_ASSERT_EQUAL(0, adaptive.brokerKills);
+        // Only the failed probes of the search, and the halving after the
+        // timeout shrank, cost a connection
+        TEST_ASSERT_TRUE(adaptive.drops <= 8);
+    }
+}
+
+// Raw telemetry every 10 s keeps the link busier than any ping interval:
+// nothing is pinged and nothing is probed, the learning is inert
+static void test_telemetry_faster_than_the_pings_leaves_it_inert(void)
+{
+    NatResult_t fixed = run(false, 300, 300, true, 10000);
+    NatResult_t adaptive = run(true, 300, 300, true, 10000);
+    report("NAT 300 s, 10 s data", fixed, adaptive);
+
+    TEST_ASSERT_EQUAL(0, fixed.pingsPerHour);
+    TEST_ASSERT_EQUAL(0, adaptive.pingsPerHour);
+    TEST_ASSERT_EQUAL(0, adaptive.probes);
+    TEST_ASSERT_EQUAL(KEEPALIVE_MIN_S, adaptive.safe);
+    TEST_ASSERT_EQUAL(0, adaptive.drops);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_idle_link_learns_the_nat_timeout);
+    RUN_TEST(test_telemetry_faster_than_the_pings_leaves_it_inert);
+    return UNITY_END();
+}
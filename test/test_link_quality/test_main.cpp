@@ -0,0 +1,213 @@
+// Link quality estimate and batch controller: the response to weak and
+// recovering links, and a simulation of fixed vs adaptive batching on
+// strong, medium, weak and swinging links.
+#include <Arduino.h>
+#include <unity.h>
+
+#include "link_quality.cpp"
+
+#include <random>
+#include <vector>
+
+void setUp(void)
+{
+    rssi = sendMs = rttMs = failures = Smoothed_t{};
+    batch = LINK_MIN_BATCH;
+}
+
+void tearDown(void)
+{
+}
+
+static void feed(int rssiDbm, uint32_t sendDuration, uint32_t rtt, bool ok, int times)
+{
+    for (int i = 0; i < times; i++)
+    {
+        link_record_rssi(rssiDbm);
+        link_record_publish(sendDuration, ok);
+        if (ok)
+        {
+            link_record_rtt(rtt);
+        }
+    }
+}
+
+static void test_unknown_link_counts_as_good(void)
+{
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, link_quality());
+    TEST_ASSERT_EQUAL(LINK_MIN_BATCH, link_batch_size());
+    // 0 dBm means not associated, it is not a measurement
+    link_record_rssi(0);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, link_quality());
+}
+
+static void test_weakest_signal_sets_the_quality(void)
+{
+    feed(-55, 5, 60, true, 20);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, link_quality());
+    TEST_ASSERT_EQUAL(LINK_MIN_BATCH, link_batch_size());
+
+    // Good RSSI, but the round trip is at the bad bound
+    feed(-55, 5, LINK_RTT_BAD_MS, true, 40);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, link_quality());
+    TEST_ASSERT_EQUAL(LINK_MAX_BATCH, link_batch_size());
+}
+
+static void test_failures_grow_the_batch_at_once(void)
+{
+    feed(-55, 5, 60, true, 20);
+    link_record_publish(0, false);
+    link_record_publish(0, false);
+    // 0.44 failure rate is beyond LINK_FAILURE_BAD
+    TEST_ASSERT_EQUAL(LINK_MAX_BATCH, link_batch_size());
+}
+
+static void test_recovery_halves_the_batch_per_publish(void)
+{
+    feed(-90, 600, 2000, true, 10);
+    TEST_ASSERT_EQUAL(LINK_MAX_BATCH, link_batch_size());
+
+    std::vector<uint8_t> batches;
+    for (int i = 0; i < 30 && link_batch_size() > LINK_MIN_BATCH; i++)
+    {
+        feed(-55, 5, 60, true, 1);
+        batches.push_back(link_batch_size());
+    }
+    TEST_ASSERT_EQUAL(LINK_MIN_BATCH, link_batch_size());
+    uint8_t previous = LINK_MAX_BATCH;
+    for (uint8_t size : batches)
+    {
+        TEST_ASSERT_TRUE(size >= previous / 2);
+        TEST_ASSERT_TRUE(size <= previous);
+        previous = size;
+    }
+}
+
+typedef struct {
+    const char *name;
+    int rssi;
+    double sendMs;
+    double rttMs;
+    double loss;
+} Link_t;
+
+typedef struct {
+    double publishesPerSample;
+    double bytesPerSample;
+    double radioMsPerSample;   // wake + blocked send + waiting for the PUBACK
+    double latencyS;           // sample taken to PUBACK received
+} SimResult_t;
+
+// One sample every 10 s. A publish costs a fixed wake-up, blocks longer for
+// bigger batches and waits a round trip for its PUBACK, two when lost.
+static SimResult_t simulate(const Link_t *phases, int phaseCount, int samplesPerPhase, bool adaptive,
+                            std::mt19937 &random)
+{
+    setUp();
+    std::normal_distribution<double> jitter(1.0, 0.25);
+    std::uniform_real_distribution<double> uniform(0, 1);
+    const double periodS = 10.0, wakeMs = 40;
+    // MQTT header, topic, packet id, TCP/IP headers, TCP ACK and PUBACK
+    const double overheadBytes = 2 + 2 + 23 + 2 + 4 + 40 + 40 + 44;
+
+    std::vector<double> collected;
+    long publishes = 0, samples = 0, delivered = 0;
+    double bytes = 0, radioMs = 0, latencyS = 0;
+    for (int phase = 0; phase < phaseCount; phase++)
+    {
+        const Link_t &link = phases[phase];
+        for (int s = 0; s < samplesPerPhase; s++)
+        {
+            double now = (phase * samplesPerPhase + s) * periodS;
+            samples++;
+            collected.push_back(now);
+            if (collected.size() > LINK_MAX_BATCH)
+            {
+                collected.erase(collected.begin());
+            }
+            link_record_rssi(link.rssi + (int)((uniform(random) - 0.5) * 6));
+            size_t wanted = adaptive ? link_batch_size() : 1;
+            if (collected.size() < wanted)
+            {
+                continue;
+            }
+
+            publishes++;
+            double send = link.sendMs * std::max(0.2, jitter(random)) * (1 + collected.size() / 12.0);
+            double rtt = link.rttMs * std::max(0.2, jitter(random));
+            bool ok = uniform(random) >= link.loss;
+            bytes += overheadBytes + (collected.size() == 1 ? 38 : 2 + collected.size() * 76);
+            radioMs += wakeMs + send + (ok ? rtt : 2 * rtt);
+            link_record_publish((uint32_t)send, ok);
+            if (ok)
+            {
+                link_record_rtt((uint32_t)rtt);
+                for (double taken : collected)
+                {
+                    latencyS += now - taken + rtt / 1000;
+                }
+                delivered += collected.size();
+                collected.clear();
+            }
+        }
+    }
+    return {(double)publishes / samples, bytes / samples, radioMs / samples, latencyS / delivered};
+}
+
+static void test_simulated_links(void)
+{
+    std::mt19937 random(1);
+    const Link_t strong = {"strong", -55, 8, 60, 0.0};
+    const Link_t medium = {"medium", -72, 60, 400, 0.01};
+    const Link_t weak = {"weak", -84, 300, 1100, 0.08};
+    const Link_t swinging[] = {strong, weak, strong, medium, weak, strong};
+    struct {
+        const char *name;
+        const Link_t *phases;
+        int count;
+        int samplesPerPhase;
+    } scenarios[] = {{"strong", &strong, 1, 2000},
+                     {"medium", &medium, 1, 2000},
+                     {"weak", &weak, 1, 2000},
+                     {"swinging", swinging, 6, 400}};
+
+    TEST_MESSAGE("link      mode      pub/sample  bytes/sample  radio ms/sample  latency s");
+    for (const auto &scenario : scenarios)
+    {
+        SimResult_t fixed = simulate(scenario.phases, scenario.count, scenario.samplesPerPhase, false, random);
+        SimResult_t adaptive = simulate(scenario.phases, scenario.count, scenario.samplesPerPhase, true, random);
+        for (int i = 0; i < 2; i++)
+        {
+            const SimResult_t &r = i ? adaptive : fixed;
+            char line[120];
+            snprintf(line, sizeof(line), "%-9s %-9s %10.2f %13.1f %16.1f %10.1f", scenario.name,
+                     i ? "adaptive" : "fixed", r.publishesPerSample, r.bytesPerSample, r.radioMsPerSample,
+                     r.latencyS);
+            TEST_MESSAGE(line);
+        }
+
+        if (strcmp(scenario.name, "strong") == 0)
+        {
+            // Nothing to gain, every sample still goes out on its own
+            TEST_ASSERT_FLOAT_WITHIN(0.01, fixed.publishesPerSample, adaptive.publishesPerSample);
+        }
+        else
+        {
+            TEST_ASSERT_TRUE(adaptive.bytesPerSample < fixed.bytesPerSample);
+            TEST_ASSERT_TRUE(adaptive.radioMsPerSample < fixed.radioMsPerSample);
+            // Bounded by the batch, not more than LINK_MAX_BATCH samples late
+            TEST_ASSERT_TRUE(adaptive.latencyS < LINK_MAX_BATCH * 10.0);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_unknown_link_counts_as_good);
+    RUN_TEST(test_weakest_signal_sets_the_quality);
+    RUN_TEST(test_failures_grow_the_batch_at_once);
+    RUN_TEST(test_recovery_halves_the_batch_per_publish);
+    RUN_TEST(test_simulated_links);
+    return UNITY_END();
+}
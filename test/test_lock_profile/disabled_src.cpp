@@ -0,0 +1,35 @@
+// lock_profile.cpp built with LOCK_PROFILING=0, as its own translation unit
+// and namespace: the wrappers are the plain FreeRTOS calls.
+#include <Arduino.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "esp_timer.h"
+
+#define LOCK_PROFILING 0
+
+namespace lockDisabled
+{
+#include "lock_profile.cpp"
+}
+
+bool lockDisabledPassesThrough(String *metrics)
+{
+    SemaphoreHandle_t mutex = xSemaphoreCreateMutex();
+    QueueHandle_t queue = xQueueCreate(1, sizeof(int));
+    lock_profile_register(mutex, "off", LOCK_KIND_MUTEX);
+    lock_profile_register(queue, "off_queue", LOCK_KIND_QUEUE);
+
+    int item = 7;
+    bool ok = lock_take(mutex, 0) == pdTRUE && lock_take(mutex, 0) == pdFALSE && lock_give(mutex) == pdTRUE &&
+              lock_send(queue, &item, 0) == pdTRUE && lock_send(queue, &item, 0) == pdFALSE &&
+              lock_receive(queue, &item, 0) == pdTRUE && item == 7;
+    lockDisabled::LockProfile_t profile;
+    ok = ok && !lock_profile_get(mutex, &profile) && lock_profile_waiting_on(xTaskGetCurrentTaskHandle()) == NULL;
+    *metrics = lock_profile_metrics();
+
+    vQueueDelete(queue);
+    vSemaphoreDelete(mutex);
+    return ok;
+}
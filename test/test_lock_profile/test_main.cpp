@@ -0,0 +1,313 @@
+// Lock profiler on the host FreeRTOS tasks, with the fake clock setting every
+// wait: the histogram buckets, hold times, the waiting and the blocking task,
+// signal waits kept out of the timeouts, the /metrics text, and the wrappers
+// with LOCK_PROFILING=0 (disabled_src.cpp).
+#include <Arduino.h>
+#include <unity.h>
+
+#include "lock_profile.cpp"
+
+#include <atomic>
+
+bool lockDisabledPassesThrough(String *metrics);
+
+static SemaphoreHandle_t mutex;
+static SemaphoreHandle_t signal;
+static QueueHandle_t queue;
+static std::atomic<int> done;
+
+// Blocks until `task` waits in a profiled call on `name`
+static void waitUntilBlocked(TaskHandle_t task, const char *name)
+{
+    for (int i = 0; i < 5000; i++)
+    {
+        const char *on = lock_profile_waiting_on(task);
+        if (on != NULL && strcmp(on, name) == 0)
+        {
+            return;
+        }
+        vTaskDelay(1);
+    }
+    TEST_FAIL_MESSAGE("task never blocked");
+}
+
+static void waitDone(int count)
+{
+    for (int i = 0; i < 5000 && done < count; i++)
+    {
+        vTaskDelay(1);
+    }
+    TEST_ASSERT_EQUAL(count, (int)done);
+}
+
+static void takeAndGive(void *)
+{
+    lock_take(mutex, portMAX_DELAY);
+    lock_give(mutex);
+    done++;
+    vTaskDelete(NULL);
+}
+
+static void takeWithTimeout(void *)
+{
+    lock_take(mutex, 10);
+    done++;
+    vTaskDelete(NULL);
+}
+
+static void sendFull(void *)
+{
+    int item = 2;
+    lock_send(queue, &item, portMAX_DELAY);
+    done++;
+    vTaskDelete(NULL);
+}
+
+// A consumer polling for the signal the way the display task does
+static void pollSignal(void *)
+{
+    while (lock_take(signal, 5) != pdTRUE)
+    {
+    }
+    done++;
+    vTaskDelete(NULL);
+}
+
+static uint8_t bucketOf(const LockTiming_t *timing)
+{
+    for (uint8_t b = 0; b < LOCK_BUCKETS; b++)
+    {
+        if (timing->buckets[b] > 0)
+        {
+            return b;
+        }
+    }
+    return LOCK_BUCKETS;
+}
+
+void setUp(void)
+{
+    entryCount = 0;
+    memset(waits, 0, sizeof(waits));
+    hostFakeMicros = 1000000;
+    done = 0;
+    mutex = xSemaphoreCreateMutex();
+    signal = xSemaphoreCreateBinary();
+    queue = xQueueCreate(1, sizeof(int));
+    lock_profile_register(mutex, "bus", LOCK_KIND_MUTEX);
+    lock_profile_register(signal, "frame", LOCK_KIND_SIGNAL);
+    lock_profile_register(queue, "events", LOCK_KIND_QUEUE);
+}
+
+void tearDown(void)
+{
+    hostFakeMicros = -1;
+    vQueueDelete(queue);
+    vSemaphoreDelete(signal);
+    vSemaphoreDelete(mutex);
+}
+
+static void test_buckets_and_hold_times(void)
+{
+    // Uncontended: no wait, a 500 us hold
+    TEST_ASSERT_EQUAL(pdTRUE, lock_take(mutex, portMAX_DELAY));
+    hostFakeMicros += 500;
+    TEST_ASSERT_EQUAL(pdTRUE, lock_give(mutex));
+
+    // Contended: the waiter blocks 20 ms on a hold of 20 ms
+    TEST_ASSERT_EQUAL(pdTRUE, lock_take(mutex, portMAX_DELAY));
+    TaskHandle_t waiter;
+    xTaskCreate(takeAndGive, "waiter", 2048, NULL, 1, &waiter);
+    waitUntilBlocked(waiter, "bus");
+    hostFakeMicros += 20000;
+    lock_give(mutex);
+    waitDone(1);
+
+    LockProfile_t profile;
+    TEST_ASSERT_TRUE(lock_profile_get(mutex, &profile));
+    TEST_ASSERT_EQUAL(3, profile.acquire.count);
+    TEST_ASSERT_EQUAL(2, profile.acquire.buckets[0]);
+    TEST_ASSERT_EQUAL(1, profile.acquire.buckets[4]);
+    TEST_ASSERT_EQUAL(1, profile.acquire.contended);
+    TEST_ASSERT_EQUAL(20000, profile.acquire.maxUs);
+    TEST_ASSERT_EQUAL(0, profile.acquire.timeouts);
+
+    // 500 us, 20 ms, and the waiter's own hold of nothing
+    TEST_ASSERT_EQUAL(3, profile.hold.count);
+    TEST_ASSERT_EQUAL(1, profile.hold.buckets[0]);
+    TEST_ASSERT_EQUAL(1, profile.hold.buckets[2]);
+    TEST_ASSERT_EQUAL(1, profile.hold.buckets[4]);
+    TEST_ASSERT_EQUAL(20500, (uint32_t)profile.hold.totalUs);
+    TEST_ASSERT_EQUAL(3, profile.release.count);
+
+    // Exactly on a bound falls in the bucket below it
+    TEST_ASSERT_EQUAL(pdTRUE, lock_take(mutex, portMAX_DELAY));
+    hostFakeMicros += lockBucketUs[5];
+    lock_give(mutex);
+    TEST_ASSERT_TRUE(lock_profile_get(mutex, &profile));
+    TEST_ASSERT_EQUAL(1, profile.hold.buckets[5]);
+    TEST_ASSERT_EQUAL(0, profile.hold.buckets[6]);
+}
+
+static void test_waiter_and_blocker_names(void)
+{
+    TEST_ASSERT_EQUAL(pdTRUE, lock_take(mutex, portMAX_DELAY));
+    TaskHandle_t waiter;
+    xTaskCreate(takeAndGive, "waiter", 2048, NULL, 1, &waiter);
+    waitUntilBlocked(waiter, "bus");
+    TEST_ASSERT_NULL(lock_profile_waiting_on(xTaskGetCurrentTaskHandle()));
+    hostFakeMicros += 3000;
+    lock_give(mutex);
+    waitDone(1);
+
+    // The timeout names the holder too
+    TEST_ASSERT_EQUAL(pdTRUE, lock_take(mutex, portMAX_DELAY));
+    xTaskCreate(takeWithTimeout, "impatient", 2048, NULL, 1, NULL);
+    waitDone(2);
+    lock_give(mutex);
+
+    LockProfile_t profile;
+    TEST_ASSERT_TRUE(lock_profile_get(mutex, &profile));
+    TEST_ASSERT_EQUAL(3000, profile.worstWaitUs);
+    TEST_ASSERT_EQUAL_STRING("waiter", profile.worstWaiter);
+    TEST_ASSERT_EQUAL_STRING("main", profile.worstBlocker);
+    TEST_ASSERT_EQUAL(1, profile.acquire.timeouts);
+    TEST_ASSERT_EQUAL_STRING("impatient", profile.timeoutWaiter);
+    TEST_ASSERT_EQUAL_STRING("main", profile.timeoutBlocker);
+
+    // A full queue waits for its last receiver, depth is counted after a send
+    int item = 1;
+    TEST_ASSERT_EQUAL(pdTRUE, lock_send(queue, &item, 0));
+    TEST_ASSERT_EQUAL(pdTRUE, lock_receive(queue, &item, 0));
+    TEST_ASSERT_EQUAL(pdTRUE, lock_send(queue, &item, 0));
+    TaskHandle_t sender;
+    xTaskCreate(sendFull, "sender", 2048, NULL, 1, &sender);
+    waitUntilBlocked(sender, "events");
+    hostFakeMicros += 2000;
+    TEST_ASSERT_EQUAL(pdTRUE, lock_receive(queue, &item, 0));
+    waitDone(3);
+
+    TEST_ASSERT_TRUE(lock_profile_get(queue, &profile));
+    TEST_ASSERT_EQUAL(1, profile.maxDepth);
+    TEST_ASSERT_EQUAL(1, profile.release.buckets[3]);
+    TEST_ASSERT_EQUAL_STRING("sender", profile.worstWaiter);
+    TEST_ASSERT_EQUAL_STRING("main", profile.worstBlocker);
+
+    // Unregistered objects pass straight through
+    SemaphoreHandle_t other = xSemaphoreCreateMutex();
+    TEST_ASSERT_EQUAL(pdTRUE, lock_take(other, 0));
+    TEST_ASSERT_EQUAL(pdTRUE, lock_give(other));
+    TEST_ASSERT_FALSE(lock_profile_get(other, &profile));
+    vSemaphoreDelete(other);
+}
+
+static void test_expired_signal_waits_are_not_timeouts(void)
+{
+    TaskHandle_t consumer;
+    xTaskCreate(pollSignal, "consumer", 2048, NULL, 1, &consumer);
+    waitUntilBlocked(consumer, "frame");
+    // Several polls expire before the producer gives, 250 ms after the first
+    vTaskDelay(40);
+    hostFakeMicros += 250000;
+    TEST_ASSERT_EQUAL(pdTRUE, lock_give(signal));
+    waitDone(1);
+
+    LockProfile_t profile;
+    TEST_ASSERT_TRUE(lock_profile_get(signal, &profile));
+    TEST_ASSERT_GREATER_OR_EQUAL(2, profile.expiredWaits);
+    TEST_ASSERT_EQUAL(0, profile.acquire.count);
+    TEST_ASSERT_EQUAL(0, profile.acquire.timeouts);
+    TEST_ASSERT_EQUAL(0, profile.acquire.contended);
+    TEST_ASSERT_EQUAL(0, profile.worstWaitUs);
+    TEST_ASSERT_EQUAL(0, profile.release.timeouts);
+
+    // One time-to-signal across the expired polls
+    TEST_ASSERT_EQUAL(1, profile.signal.count);
+    TEST_ASSERT_EQUAL(250000, profile.signal.maxUs);
+    TEST_ASSERT_EQUAL(5, bucketOf(&profile.signal));
+
+    // The next wait starts over, a signal already there takes no time
+    hostFakeMicros += 50;
+    TEST_ASSERT_EQUAL(pdTRUE, lock_give(signal));
+    TEST_ASSERT_EQUAL(pdTRUE, lock_take(signal, 5));
+    TEST_ASSERT_TRUE(lock_profile_get(signal, &profile));
+    TEST_ASSERT_EQUAL(2, profile.signal.count);
+    TEST_ASSERT_EQUAL(1, profile.signal.buckets[0]);
+    TEST_ASSERT_EQUAL(250000, (uint32_t)profile.signal.totalUs);
+
+    // A give of a signal already given still fails as a timeout
+    TEST_ASSERT_EQUAL(pdTRUE, lock_give(signal));
+    TEST_ASSERT_EQUAL(pdFALSE, lock_give(signal));
+    TEST_ASSERT_TRUE(lock_profile_get(signal, &profile));
+    TEST_ASSERT_EQUAL(1, profile.release.timeouts);
+}
+
+static void test_metrics_text(void)
+{
+    TEST_ASSERT_EQUAL(pdTRUE, lock_take(mutex, portMAX_DELAY));
+    TaskHandle_t waiter;
+    xTaskCreate(takeAndGive, "waiter", 2048, NULL, 1, &waiter);
+    waitUntilBlocked(waiter, "bus");
+    hostFakeMicros += 20000;
+    lock_give(mutex);
+    waitDone(1);
+    TEST_ASSERT_EQUAL(pdFALSE, lock_take(signal, 1));
+    TEST_ASSERT_EQUAL(pdFALSE, lock_take(signal, 1));
+
+    String metrics = lock_profile_metrics();
+    const char *text = metrics.c_str();
+    const char *expected[] = {
+        "# TYPE lock_acquire_wait_seconds histogram\n",
+        "lock_acquire_wait_seconds_bucket{lock=\"bus\",le=\"0.01\"} 1\n",
+        "lock_acquire_wait_seconds_bucket{lock=\"bus\",le=\"0.1\"} 2\n",
+        "lock_acquire_wait_seconds_bucket{lock=\"bus\",le=\"+Inf\"} 2\n",
+        "lock_acquire_wait_seconds_sum{lock=\"bus\"} 0.020000\n",
+        "lock_acquire_wait_seconds_count{lock=\"bus\"} 2\n",
+        "lock_hold_seconds_bucket{lock=\"bus\",le=\"1e-05\"} 1\n",
+        "lock_hold_seconds_bucket{lock=\"bus\",le=\"0.1\"} 2\n",
+        "lock_signal_wait_seconds_count{lock=\"frame\"} 0\n",
+        "lock_contended_total{lock=\"bus\",kind=\"mutex\",op=\"acquire\"} 1\n",
+        "lock_contended_total{lock=\"frame\",kind=\"signal\",op=\"acquire\"} 0\n",
+        "lock_timeouts_total{lock=\"frame\",op=\"acquire\"} 0\n",
+        "lock_signal_expired_total{lock=\"frame\"} 2\n",
+        "lock_max_seconds{lock=\"bus\",op=\"hold\"} 0.020000\n",
+        "lock_queue_max_depth{lock=\"events\"} 0\n",
+        "lock_worst_wait_seconds{lock=\"bus\",waiter=\"waiter\",blocker=\"main\"} 0.020000\n",
+    };
+    for (const char *line : expected)
+    {
+        TEST_ASSERT_TRUE_MESSAGE(strstr(text, line) != NULL, line);
+    }
+
+    // Each kind only in its own histograms, no timeout for the expired polls
+    const char *unexpected[] = {
+        "lock_acquire_wait_seconds_count{lock=\"frame\"}",
+        "lock_hold_seconds_count{lock=\"frame\"}",
+        "lock_hold_seconds_count{lock=\"events\"}",
+        "lock_signal_wait_seconds_count{lock=\"bus\"}",
+        "lock_max_seconds{lock=\"events\",op=\"hold\"}",
+        "lock_last_timeout_info{",
+    };
+    for (const char *line : unexpected)
+    {
+        TEST_ASSERT_TRUE_MESSAGE(strstr(text, line) == NULL, line);
+    }
+}
+
+static void test_profiling_disabled(void)
+{
+    String metrics;
+    TEST_ASSERT_TRUE(lockDisabledPassesThrough(&metrics));
+    TEST_ASSERT_EQUAL_STRING("# lock profiling disabled\n", metrics.c_str());
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_buckets_and_hold_times);
+    RUN_TEST(test_waiter_and_blocker_names);
+    RUN_TEST(test_expired_signal_waits_are_not_timeouts);
+    RUN_TEST(test_metrics_text);
+    RUN_TEST(test_profiling_disabled);
+    return UNITY_END();
+}
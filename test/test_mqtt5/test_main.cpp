@@ -0,0 +1,414 @@
+// MQTT 5 in PubSubClient against a broker stand-in: CONNACK limits, topic
+// aliases, the QoS 1 quota and PUBACK reporting, the Server Keep Alive and
+// the fallback to 3.1.1.
+#include <Arduino.h>
+#include <unity.h>
+#include <PubSubClient.h>
+
+#include <deque>
+#include <string>
+#include <vector>
+
+// Parses what the client sends and answers like an MQTT 5 broker, or like a
+// 3.1.1-only one that refuses protocol level 5
+class Broker : public Client
+{
+public:
+    struct Publish
+    {
+        std::string topic;
+        uint16_t alias = 0;
+        uint8_t qos = 0;
+        uint16_t id = 0;
+        std::string payload;
+    };
+
+    bool v5 = true;
+    uint8_t receiveMaximum = 2;
+    uint8_t aliasMaximum = 10;
+    int serverKeepAlive = -1;   // >= 0: sent in the CONNACK
+    bool autoAck = true;
+    size_t budget = SIZE_MAX;   // bytes the socket still takes
+    bool open = false;
+    int opens = 0;
+    std::vector<uint8_t> versions;      // protocol level of every CONNECT
+    std::vector<uint16_t> keepAlives;   // keep alive of every CONNECT
+    std::vector<Publish> publishes;
+    std::vector<uint16_t> unacked;
+    std::deque<uint8_t> in;
+
+    int connect(IPAddress ip, uint16_t port) override { return connect("", port); }
+    int connect(const char *host, uint16_t port) override
+    {
+        open = true;
+        opens++;
+        pending.clear();
+        return 1;
+    }
+    size_t write(uint8_t b) override { return write(&b, 1); }
+    size_t write(const uint8_t *buf, size_t size) override
+    {
+        size_t n = std::min(size, budget);
+        if (budget != SIZE_MAX)
+            budget -= n;
+        pending.insert(pending.end(), buf, buf + n);
+        parse();
+        return n;
+    }
+    int available() override { return (int)in.size(); }
+    int read() override
+    {
+        if (in.empty())
+            return -1;
+        int c = in.front();
+        in.pop_front();
+        return c;
+    }
+    int read(uint8_t *buf, size_t size) override { return -1; }
+    int peek() override { return in.empty() ? -1 : in.front(); }
+    void flush() override {}
+    void stop() override
+    {
+        open = false;
+        in.clear();
+    }
+    uint8_t connected() override { return open; }
+    operator bool() override { return open; }
+
+    void ack(uint16_t id, uint8_t reason = 0)
+    {
+        // MQTT 5 leaves out the reason code on success
+        if (reason)
+            in.insert(in.end(), {0x40, 3, (uint8_t)(id >> 8), (uint8_t)id, reason});
+        else
+            in.insert(in.end(), {0x40, 2, (uint8_t)(id >> 8), (uint8_t)id});
+    }
+    void ackAll()
+    {
+        for (uint16_t id : unacked)
+            ack(id);
+        unacked.clear();
+    }
+    void send(const std::string &topic, const std::string &payload)
+    {
+        // QoS 0 PUBLISH with an empty property list
+        size_t remaining = 2 + topic.size() + 1 + payload.size();
+        in.push_back(0x30);
+        in.push_back((uint8_t)remaining);
+        in.push_back(0);
+        in.push_back((uint8_t)topic.size());
+        in.insert(in.end(), topic.begin(), topic.end());
+        in.push_back(0);
+        in.insert(in.end(), payload.begin(), payload.end());
+    }
+
+private:
+    std::vector<uint8_t> pending;
+
+    static size_t skipString(const std::vector<uint8_t> &p, size_t pos)
+    {
+        return pos + 2 + ((p[pos] << 8) | p[pos + 1]);
+    }
+
+    void parse()
+    {
+        while (pending.size() >= 2)
+        {
+            size_t h = 1;
+            uint32_t length = 0, multiplier = 1;
+            uint8_t digit;
+            do
+            {
+                if (h >= pending.size())
+                    return;
+                digit = pending[h++];
+                length += (digit & 127) * multiplier;
+                multiplier <<= 7;
+            } while (digit & 128);
+            if (pending.size() < h + length)
+                return;
+            std::vector<uint8_t> packet(pending.begin(), pending.begin() + h + length);
+            pending.erase(pending.begin(), pending.begin() + h + length);
+            handle(packet, h);
+        }
+    }
+
+    void handle(const std::vector<uint8_t> &p, size_t h)
+    {
+        uint8_t type = p[0] & 0xF0;
+        if (type == 0x10)
+        {
+            uint8_t version = p[h + 6];
+            versions.push_back(version);
+            keepAlives.push_back((p[h + 8] << 8) | p[h + 9]);
+            if (version == 5 && v5)
+            {
+                std::vector<uint8_t> properties = {0x21, 0, receiveMaximum, 0x22, 0, aliasMaximum};
+                if (serverKeepAlive >= 0)
+                {
+                    properties.insert(properties.end(), {0x13, (uint8_t)(serverKeepAlive >> 8), (uint8_t)serverKeepAlive});
+                }
+                in.insert(in.end(), {0x20, (uint8_t)(3 + properties.size()), 0, 0, (uint8_t)properties.size()});
+                in.insert(in.end(), properties.begin(), properties.end());
+            }
+            else if (version == 5)
+            {
+                // 3.1.1 broker: unacceptable protocol version, then it closes the socket
+                in.insert(in.end(), {0x20, 2, 0, 1});
+            }
+            else
+            {
+                in.insert(in.end(), {0x20, 2, 0, 0});
+            }
+        }
+        else if (type == 0x30)
+        {
+            Publish publish;
+            publish.qos = (p[0] >> 1) & 3;
+            size_t pos = h;
+            size_t topicLength = (p[pos] << 8) | p[pos + 1];
+            publish.topic.assign((const char *)&p[pos + 2], topicLength);
+            pos += 2 + topicLength;
+            if (publish.qos)
+            {
+                publish.id = (p[pos] << 8) | p[pos + 1];
+                pos += 2;
+            }
+            if (versions.back() == 5)
+            {
+                // Message expiry, topic alias and user properties are all the client sends
+                size_t end = pos + 1 + p[pos];
+                for (pos++; pos < end;)
+                {
+                    uint8_t id = p[pos++];
+                    if (id == 0x23)
+                        publish.alias = (p[pos] << 8) | p[pos + 1];
+                    if (id == 0x26)
+                        pos = skipString(p, skipString(p, pos));
+                    else
+                        pos += (id == 0x02) ? 4 : 2;
+                }
+            }
+            publish.payload.assign((const char *)&p[pos], p.size() - pos);
+            publishes.push_back(publish);
+            if (publish.qos)
+            {
+                if (autoAck)
+                    ack(publish.id);
+                else
+                    unacked.push_back(publish.id);
+            }
+        }
+        else if (type == 0x80)
+        {
+            uint16_t id = (p[h] << 8) | p[h + 1];
+            in.insert(in.end(), {0x90, 4, (uint8_t)(id >> 8), (uint8_t)id, 0, 0});
+        }
+    }
+};
+
+static Broker *broker;
+static PubSubClient *mqtt;
+static const char *topic = "v1/devices/me/telemetry";
+static const char *payload = "{\"temperature\":25.31,\"humidity\":61.02}";
+static int messages;
+static std::vector<std::pair<uint16_t, uint8_t>> acks;
+
+static void onMessage(char *topic, uint8_t *payload, unsigned int length)
+{
+    messages++;
+}
+
+static void onAck(uint16_t id, uint8_t reason)
+{
+    acks.push_back({id, reason});
+}
+
+static bool publishQos1()
+{
+    MQTTPublishOptions options;
+    options.qos = 1;
+    return mqtt->publish(topic, (const uint8_t *)payload, strlen(payload), false, options);
+}
+
+void setUp(void)
+{
+    broker = new Broker;
+    mqtt = new PubSubClient(*broker);
+    mqtt->setServer("broker", 1883);
+    mqtt->setSocketTimeout(1);
+    mqtt->setProtocolVersion(MQTT_VERSION_5);
+    mqtt->setCallback(onMessage);
+    mqtt->setAckCallback(onAck);
+    messages = 0;
+    acks.clear();
+}
+
+void tearDown(void)
+{
+    delete mqtt;
+    delete broker;
+}
+
+static void test_connects_with_mqtt5(void)
+{
+    TEST_ASSERT_TRUE(mqtt->connect("device"));
+    TEST_ASSERT_EQUAL(MQTT_VERSION_5, mqtt->getProtocolVersion());
+    TEST_ASSERT_EQUAL(1, broker->versions.size());
+    TEST_ASSERT_EQUAL(5, broker->versions[0]);
+}
+
+static void test_repeated_topic_gets_an_alias(void)
+{
+    TEST_ASSERT_TRUE(mqtt->connect("device"));
+    for (int i = 0; i < 3; i++)
+        TEST_ASSERT_TRUE(mqtt->publish(topic, payload));
+
+    // Seen once: full topic; second time: topic and alias; then the alias alone
+    TEST_ASSERT_TRUE(broker->publishes[0].topic == topic);
+    TEST_ASSERT_EQUAL(0, broker->publishes[0].alias);
+    TEST_ASSERT_TRUE(broker->publishes[1].topic == topic);
+    TEST_ASSERT_EQUAL(1, broker->publishes[1].alias);
+    TEST_ASSERT_TRUE(broker->publishes[2].topic.empty());
+    TEST_ASSERT_EQUAL(1, broker->publishes[2].alias);
+    TEST_ASSERT_TRUE(broker->publishes[2].payload == payload);
+}
+
+static void test_alias_is_only_used_once_the_broker_has_it(void)
+{
+    TEST_ASSERT_TRUE(mqtt->connect("device"));
+    TEST_ASSERT_TRUE(mqtt->publish(topic, payload));
+
+    // The packet that would set up the alias does not get out
+    broker->budget = 0;
+    TEST_ASSERT_FALSE(mqtt->publish(topic, payload));
+    broker->budget = SIZE_MAX;
+
+    TEST_ASSERT_TRUE(mqtt->publish(topic, payload));
+    TEST_ASSERT_TRUE(broker->publishes.back().topic == topic);
+    TEST_ASSERT_EQUAL(1, broker->publishes.back().alias);
+}
+
+static void test_quota_refuses_without_running_callbacks(void)
+{
+    broker->autoAck = false;
+    TEST_ASSERT_TRUE(mqtt->connect("device"));
+    TEST_ASSERT_TRUE(publishQos1());
+    TEST_ASSERT_TRUE(publishQos1());
+    TEST_ASSERT_EQUAL(2, mqtt->getInflight());
+
+    // Receive Maximum 2 is used up. A message and the PUBACKs are waiting on
+    // the socket, the publish must not read them
+    broker->send("v1/devices/me/rpc/request/1", "{}");
+    broker->ackAll();
+    TEST_ASSERT_FALSE(publishQos1());
+    TEST_ASSERT_EQUAL(0, messages);
+    TEST_ASSERT_EQUAL(2, broker->publishes.size());
+
+    for (int i = 0; i < 3; i++)
+        mqtt->loop();
+    TEST_ASSERT_EQUAL(1, messages);
+    TEST_ASSERT_EQUAL(0, mqtt->getInflight());
+    TEST_ASSERT_TRUE(publishQos1());
+}
+
+static void test_puback_is_reported_with_its_packet_id(void)
+{
+    broker->autoAck = false;
+    TEST_ASSERT_TRUE(mqtt->connect("device"));
+    TEST_ASSERT_TRUE(publishQos1());
+    uint16_t first = mqtt->getLastMessageId();
+    TEST_ASSERT_TRUE(publishQos1());
+    uint16_t second = mqtt->getLastMessageId();
+    TEST_ASSERT_NOT_EQUAL(0, first);
+    TEST_ASSERT_NOT_EQUAL(first, second);
+    TEST_ASSERT_EQUAL(broker->publishes[0].id, first);
+
+    broker->ack(second, 0x97);  // quota exceeded
+    broker->ack(first);
+    mqtt->loop();
+    mqtt->loop();
+    TEST_ASSERT_EQUAL(2, acks.size());
+    TEST_ASSERT_EQUAL(second, acks[0].first);
+    TEST_ASSERT_EQUAL(0x97, acks[0].second);
+    TEST_ASSERT_EQUAL(first, acks[1].first);
+    TEST_ASSERT_EQUAL(0, acks[1].second);
+
+    // QoS 0 messages have no packet id to wait for
+    TEST_ASSERT_TRUE(mqtt->publish(topic, payload));
+    TEST_ASSERT_EQUAL(0, mqtt->getLastMessageId());
+}
+
+static void test_failed_qos1_publish_is_not_in_flight(void)
+{
+    TEST_ASSERT_TRUE(mqtt->connect("device"));
+    broker->budget = 0;
+    TEST_ASSERT_FALSE(publishQos1());
+    TEST_ASSERT_EQUAL(0, mqtt->getInflight());
+    TEST_ASSERT_EQUAL(0, mqtt->getLastMessageId());
+}
+
+static void test_server_keep_alive_applies_to_its_connection_only(void)
+{
+    broker->serverKeepAlive = 30;
+    mqtt->setKeepAlive(600);
+    TEST_ASSERT_EQUAL(600, mqtt->getKeepAlive());
+    TEST_ASSERT_TRUE(mqtt->connect("device"));
+    TEST_ASSERT_EQUAL(30, mqtt->getKeepAlive());
+
+    mqtt->disconnect();
+    TEST_ASSERT_EQUAL(600, mqtt->getKeepAlive());
+    TEST_ASSERT_TRUE(mqtt->connect("device"));
+    TEST_ASSERT_EQUAL(600, broker->keepAlives[1]);
+}
+
+static void test_fallback_on_own_socket_connects_again(void)
+{
+    broker->v5 = false;
+    TEST_ASSERT_TRUE(mqtt->connect("device"));
+    TEST_ASSERT_EQUAL(MQTT_VERSION_3_1_1, mqtt->getProtocolVersion());
+    TEST_ASSERT_EQUAL(2, broker->opens);
+    TEST_ASSERT_EQUAL(5, broker->versions[0]);
+    TEST_ASSERT_EQUAL(4, broker->versions[1]);
+    TEST_ASSERT_TRUE(mqtt->publish(topic, payload));
+}
+
+static void test_fallback_leaves_the_callers_socket_to_the_caller(void)
+{
+    broker->v5 = false;
+    // Opened and tuned by the application, e.g. coreiot's connectTransport()
+    broker->connect("broker", 1883);
+    TEST_ASSERT_FALSE(mqtt->connect("device"));
+    TEST_ASSERT_EQUAL(MQTT_CONNECT_BAD_PROTOCOL, mqtt->state());
+    TEST_ASSERT_EQUAL(1, broker->opens);
+
+    // The application's next socket gets a 3.1.1 CONNECT straight away
+    broker->connect("broker", 1883);
+    TEST_ASSERT_TRUE(mqtt->connect("device"));
+    TEST_ASSERT_EQUAL(2, broker->opens);
+    TEST_ASSERT_EQUAL(2, broker->versions.size());
+    TEST_ASSERT_EQUAL(4, broker->versions[1]);
+
+    // Asking for MQTT 5 again starts over
+    mqtt->disconnect();
+    broker->v5 = true;
+    mqtt->setProtocolVersion(MQTT_VERSION_5);
+    broker->connect("broker", 1883);
+    TEST_ASSERT_TRUE(mqtt->connect("device"));
+    TEST_ASSERT_EQUAL(MQTT_VERSION_5, mqtt->getProtocolVersion());
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_connects_with_mqtt5);
+    RUN_TEST(test_repeated_topic_gets_an_alias);
+    RUN_TEST(test_alias_is_only_used_once_the_broker_has_it);
+    RUN_TEST(test_quota_refuses_without_running_callbacks);
+    RUN_TEST(test_puback_is_reported_with_its_packet_id);
+    RUN_TEST(test_failed_qos1_publish_is_not_in_flight);
+    RUN_TEST(test_server_keep_alive_applies_to_its_connection_only);
+    RUN_TEST(test_fallback_on_own_socket_connects_again);
+    RUN_TEST(test_fallback_leaves_the_callers_socket_to_the_caller);
+    return UNITY_END();
+}
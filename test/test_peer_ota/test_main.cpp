@@ -0,0 +1,306 @@
+// LAN-assisted firmware download against stubbed mDNS, HTTP and OTA
+// partitions: the election on a site too large for one query, a corrupt
+// range blamed on its peer after the peer list was rebuilt, an image the
+// cloud serves with another checksum, the back-off of a failed target, and a
+// verified download served to the next peer.
+#include <Arduino.h>
+#include <unity.h>
+
+#include "peer_ota.cpp"
+
+#include <set>
+#include <vector>
+
+String CORE_IOT_TOKEN;
+String CORE_IOT_SERVER;
+
+void snapshot_restart()
+{
+}
+
+static std::string image;
+static char imageChecksum[65];
+static std::string cloudImage;                  // what the cloud serves
+static std::set<std::string> corruptPeers;      // flip a byte of every range
+static std::set<std::string> busyPeers;         // refuse the next range, after a timeout
+static std::map<std::string, int> ranges;       // served per peer
+static std::function<void(const std::string &)> afterRange;
+
+static void sha256Hex(const std::string &data, char *hex)
+{
+    mbedtls_md_context_t md;
+    mbedtls_md_init(&md);
+    mbedtls_md_setup(&md, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 0);
+    mbedtls_md_starts(&md);
+    mbedtls_md_update(&md, (const unsigned char *)data.data(), data.size());
+    uint8_t digest[32];
+    mbedtls_md_finish(&md, digest);
+    digestHex(digest, hex);
+}
+
+static HostHttpResponse serve(const HostHttpRequest &request)
+{
+    std::string host = request.url.substr(7, request.url.find_first_of(":/", 7) - 7);
+    if (host == "cloud.example")
+    {
+        size_t chunk = atoi(request.url.c_str() + request.url.rfind('=') + 1);
+        return {200, cloudImage.substr(chunk * PEER_OTA_CHUNK, PEER_OTA_CHUNK), {}};
+    }
+    if (busyPeers.erase(host))
+    {
+        hostFakeMicros += (PEER_OTA_DISCOVERY_MS + 1) * 1000LL;
+        return {503, "", {}};
+    }
+    unsigned long first = 0, last = 0;
+    sscanf(request.headers.at("Range").c_str(), "bytes=%lu-%lu", &first, &last);
+    HostHttpResponse response = {206, image.substr(first, last - first + 1), {{"X-Fw-Checksum", imageChecksum}}};
+    if (corruptPeers.count(host))
+    {
+        response.body[0] ^= 1;
+    }
+    ranges[host]++;
+    if (afterRange)
+    {
+        afterRange(host);
+    }
+    return response;
+}
+
+static HostMdnsAnswer device(uint8_t last, const char *id, bool hasImage)
+{
+    return {IPAddress(192, 168, 1, last), 80, {{"id", id}, {"sha", hasImage ? std::string(imageChecksum, 16) : ""}}};
+}
+
+static void announce(const char *checksum)
+{
+    char json[320];
+    snprintf(json, sizeof(json),
+             "{\"fw_title\":\"%s\",\"fw_version\":\"2.0.0\",\"fw_checksum\":\"%s\",\"fw_size\":%u}",
+             FIRMWARE_TITLE, checksum, (unsigned)image.size());
+    peer_ota_on_attributes((const uint8_t *)json, strlen(json));
+}
+
+static PeerOtaTarget_t wanted()
+{
+    PeerOtaTarget_t copy;
+    TEST_ASSERT_TRUE(copyTarget(&copy));
+    return copy;
+}
+
+static Peer_t *peerAt(uint8_t last)
+{
+    return findPeer(peers, peerCount, IPAddress(192, 168, 1, last));
+}
+
+void setUp(void)
+{
+    hostFakeMicros = 1000000;
+    hostWiFi.reset();
+    hostMdns.reset();
+    hostHttp.reset();
+    hostOta.reset();
+    hostNvs.reset();
+    hostHttp.handler = serve;
+    CORE_IOT_SERVER = "cloud.example";
+    CORE_IOT_TOKEN = "token";
+
+    target = {};
+    targetValid = false;
+    peerCount = 0;
+    discovered = seedersListed = selfListed = siteComplete = false;
+    servePartition = NULL;
+    rejected[0] = '\0';
+    retryGeneration = retryAt = retryMs = 0;
+    stats = {};
+    mdnsStarted = false;
+    startMdns();
+
+    // Three full chunks and a short one
+    srand(1);
+    image.resize(3 * PEER_OTA_CHUNK + 1000);
+    for (char &c : image)
+    {
+        c = (char)rand();
+    }
+    sha256Hex(image, imageChecksum);
+    cloudImage = image;
+    corruptPeers.clear();
+    busyPeers.clear();
+    ranges.clear();
+    afterRange = nullptr;
+}
+
+void tearDown(void)
+{
+    hostFakeMicros = -1;
+}
+
+static void test_partial_view_elects_nobody_and_spreads_the_fallback(void)
+{
+    announce(imageChecksum);
+    PeerOtaTarget_t target = wanted();
+    uint32_t own = rankOf(ownId, imageChecksum);
+
+    // A small site is ranked: elected unless two devices rank lower
+    char id[13];
+    int lower = 0;
+    for (int i = 0; i < 5; i++)
+    {
+        snprintf(id, sizeof(id), "240AC40001%02X", i);
+        hostMdns.answers.push_back(device(20 + i, id, false));
+        lower += rankOf(id, imageChecksum) < own;
+    }
+    TEST_ASSERT_EQUAL(lower < PEER_OTA_SEEDERS ? SOURCE_CLOUD : SOURCE_NONE, pickSource(&target, millis()));
+    TEST_ASSERT_TRUE(siteComplete);
+
+    // 40 devices, the query returns 20 of them: no rank is compared
+    for (int i = 5; i < 40; i++)
+    {
+        snprintf(id, sizeof(id), "240AC40001%02X", i);
+        hostMdns.answers.push_back(device(20 + i, id, false));
+    }
+    discover(&target);
+    TEST_ASSERT_FALSE(siteComplete);
+    TEST_ASSERT_EQUAL(MDNS_QUERY_RESULTS, peerCount);
+    TEST_ASSERT_FALSE(elected(&target));
+
+    // The own rank decides how long to wait
+    uint32_t wait = fallbackMs(&target);
+    TEST_ASSERT_EQUAL((uint32_t)(((uint64_t)PEER_OTA_CLOUD_FALLBACK_MS * own) >> 32), wait);
+    uint32_t since = millis();
+    hostFakeMicros += (int64_t)(wait - 1) * 1000;
+    TEST_ASSERT_EQUAL(SOURCE_NONE, pickSource(&target, since));
+    hostFakeMicros += 1000;
+    TEST_ASSERT_EQUAL(SOURCE_CLOUD, pickSource(&target, since));
+
+    // fw_seeders decides on its own, the others wait the whole fallback
+    strcpy(target.seeders, "192.168.1.99");
+    discover(&target);
+    TEST_ASSERT_FALSE(elected(&target));
+    TEST_ASSERT_EQUAL(PEER_OTA_CLOUD_FALLBACK_MS, fallbackMs(&target));
+}
+
+static void test_corrupt_range_is_blamed_on_its_peer_after_rediscovery(void)
+{
+    // .21 is the only holder at first and corrupts its range, then it is
+    // busy. The query that follows finds .22 as well, and lists the site in
+    // another order
+    hostMdns.answers = {device(21, "24:0A:C4:00:00:21", true), device(22, "24:0A:C4:00:00:22", false),
+                        device(23, "24:0A:C4:00:00:23", false)};
+    corruptPeers.insert("192.168.1.21");
+    afterRange = [](const std::string &host)
+    {
+        if (host == "192.168.1.21")
+        {
+            busyPeers.insert(host);
+            hostMdns.answers = {device(23, "24:0A:C4:00:00:23", false), device(22, "24:0A:C4:00:00:22", true),
+                                device(21, "24:0A:C4:00:00:21", true)};
+        }
+    };
+    announce(imageChecksum);
+    PeerOtaTarget_t target = wanted();
+
+    TEST_ASSERT_FALSE(download(&target, esp_ota_get_next_update_partition(NULL)));
+    TEST_ASSERT_EQUAL(1, ranges["192.168.1.21"]);
+    TEST_ASSERT_EQUAL(3, ranges["192.168.1.22"]);
+    TEST_ASSERT_EQUAL(1, stats.hashFailures);
+    TEST_ASSERT_EQUAL(1, hostOta.aborted);
+
+    // Both that served are blamed by address, .23 holds the first slot .21
+    // had when it served and is left alone
+    TEST_ASSERT_EQUAL_STRING("192.168.1.23", peers[0].ip.toString().c_str());
+    TEST_ASSERT_TRUE(peerAt(21)->failed);
+    TEST_ASSERT_EQUAL(millis(), peerAt(21)->failedAt);
+    TEST_ASSERT_TRUE(peerAt(22)->failed);
+    TEST_ASSERT_FALSE(peerAt(23)->failed);
+    TEST_ASSERT_EQUAL_STRING("checksum mismatch", fwError);
+    TEST_ASSERT_EQUAL_STRING("", rejected);
+}
+
+static void test_cloud_mismatch_rejects_the_image(void)
+{
+    // Alone on the site, elected, and the cloud serves another image
+    cloudImage[100] ^= 1;
+    announce(imageChecksum);
+    PeerOtaTarget_t target = wanted();
+
+    TEST_ASSERT_FALSE(download(&target, esp_ota_get_next_update_partition(NULL)));
+    TEST_ASSERT_EQUAL(image.size(), stats.cloudBytes);
+    TEST_ASSERT_EQUAL(0, stats.lanBytes);
+    TEST_ASSERT_EQUAL_STRING("checksum mismatch from the cloud", fwError);
+    TEST_ASSERT_EQUAL_STRING(imageChecksum, rejected);
+
+    // Announced again, it stays the same target and is skipped
+    announce(imageChecksum);
+    TEST_ASSERT_EQUAL(target.generation, wanted().generation);
+    TEST_ASSERT_EQUAL(0, strcasecmp(wanted().checksum, rejected));
+}
+
+static void test_failed_download_backs_off_per_target(void)
+{
+    announce(imageChecksum);
+    PeerOtaTarget_t first = wanted();
+    TEST_ASSERT_TRUE(retryDue(&first));
+
+    uint32_t expected = PEER_OTA_RETRY_MS;
+    for (int failure = 0; failure < 8; failure++)
+    {
+        backOff(&first);
+        TEST_ASSERT_EQUAL(expected, retryMs);
+        hostFakeMicros += (int64_t)(expected - 1) * 1000;
+        TEST_ASSERT_FALSE(retryDue(&first));
+        hostFakeMicros += 1000;
+        TEST_ASSERT_TRUE(retryDue(&first));
+        expected = min(expected * 2, (uint32_t)PEER_OTA_RETRY_MAX_MS);
+    }
+    TEST_ASSERT_EQUAL(PEER_OTA_RETRY_MAX_MS, retryMs);
+
+    // A new target is tried at once and starts over
+    backOff(&first);
+    char other[65];
+    sha256Hex(image + "x", other);
+    announce(other);
+    PeerOtaTarget_t second = wanted();
+    TEST_ASSERT_TRUE(retryDue(&second));
+    backOff(&second);
+    TEST_ASSERT_EQUAL(PEER_OTA_RETRY_MS, retryMs);
+}
+
+static void test_download_from_peers_is_served_after_verification(void)
+{
+    hostMdns.answers = {device(21, "24:0A:C4:00:00:21", true), device(22, "24:0A:C4:00:00:22", true)};
+    announce(imageChecksum);
+    PeerOtaTarget_t target = wanted();
+    const esp_partition_t *partition = esp_ota_get_next_update_partition(NULL);
+
+    TEST_ASSERT_TRUE(download(&target, partition));
+    TEST_ASSERT_EQUAL(image.size(), stats.lanBytes);
+    TEST_ASSERT_EQUAL(0, stats.cloudBytes);
+    std::vector<uint8_t> buffer(PEER_OTA_CHUNK);
+    TEST_ASSERT_TRUE(partitionHolds(partition, &target, buffer.data()));
+    char prefix[17] = "";
+    strncpy(prefix, imageChecksum, 16);
+    TEST_ASSERT_EQUAL_STRING(prefix, hostMdns.txt["sha"].c_str());
+
+    // A range of it, as a peer asks for it
+    AsyncWebServerRequest request;
+    request.headers["Range"] = "bytes=100-199";
+    handleImage(&request);
+    TEST_ASSERT_EQUAL(206, request.response->code);
+    TEST_ASSERT_EQUAL(100, request.response->length);
+    TEST_ASSERT_EQUAL(100, request.response->filler(buffer.data(), 100, 0));
+    TEST_ASSERT_EQUAL_MEMORY(image.data() + 100, buffer.data(), 100);
+    request.disconnected();
+    TEST_ASSERT_EQUAL(0, activeServes);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_partial_view_elects_nobody_and_spreads_the_fallback);
+    RUN_TEST(test_corrupt_range_is_blamed_on_its_peer_after_rediscovery);
+    RUN_TEST(test_cloud_mismatch_rejects_the_image);
+    RUN_TEST(test_failed_download_backs_off_per_target);
+    RUN_TEST(test_download_from_peers_is_served_after_verification);
+    return UNITY_END();
+}
@@ -0,0 +1,179 @@
+// Write combining in PubSubClient: publishes leave in whole segments, and a
+// network write that comes up short fails the message it belongs to instead
+// of being reported as sent.
+#include <Arduino.h>
+#include <unity.h>
+#include <PubSubClient.h>
+
+#include <string>
+#include <vector>
+
+// Network client that records every write and accepts only `budget` more
+// bytes, like a socket whose peer went away mid-message
+class SegmentClient : public Client
+{
+public:
+    std::string out;
+    std::vector<size_t> writes;
+    size_t budget = SIZE_MAX;
+    std::string in;
+    bool open = false;
+
+    int connect(IPAddress ip, uint16_t port) override { return connect("", port); }
+    int connect(const char *host, uint16_t port) override
+    {
+        // A CONNACK for the CONNECT to come
+        in.assign("\x20\x02\x00\x00", 4);
+        open = true;
+        return 1;
+    }
+    size_t write(uint8_t b) override { return write(&b, 1); }
+    size_t write(const uint8_t *buf, size_t size) override
+    {
+        size_t n = std::min(size, budget);
+        if (budget != SIZE_MAX)
+            budget -= n;
+        writes.push_back(n);
+        out.append((const char *)buf, n);
+        return n;
+    }
+    int available() override { return (int)in.size(); }
+    int read() override
+    {
+        if (in.empty())
+            return -1;
+        int c = (uint8_t)in[0];
+        in.erase(0, 1);
+        return c;
+    }
+    int read(uint8_t *buf, size_t size) override { return -1; }
+    int peek() override { return in.empty() ? -1 : (uint8_t)in[0]; }
+    void flush() override {}
+    void stop() override { open = false; }
+    uint8_t connected() override { return open; }
+    operator bool() override { return open; }
+};
+
+static SegmentClient *network;
+static PubSubClient *mqtt;
+static const char *topic = "v1/devices/me/telemetry";
+
+void setUp(void)
+{
+    network = new SegmentClient;
+    mqtt = new PubSubClient(*network);
+    mqtt->setServer("broker", 1883);
+    TEST_ASSERT_TRUE(mqtt->connect("device"));
+    network->out.clear();
+    network->writes.clear();
+}
+
+void tearDown(void)
+{
+    delete mqtt;
+    delete network;
+}
+
+static void streamPayload(const std::string &payload)
+{
+    for (char c : payload)
+        mqtt->write((uint8_t)c);
+}
+
+static void test_streamed_publish_leaves_in_one_write(void)
+{
+    std::string payload = "{\"temperature\":25.3,\"humidity\":61.0}";
+    TEST_ASSERT_TRUE(mqtt->beginPublish(topic, payload.size(), false));
+    streamPayload(payload);
+    TEST_ASSERT_EQUAL(0, network->writes.size());
+    TEST_ASSERT_EQUAL(1, mqtt->endPublish());
+    TEST_ASSERT_EQUAL(1, network->writes.size());
+    TEST_ASSERT_TRUE(network->out.size() > payload.size() + strlen(topic));
+    TEST_ASSERT_TRUE(network->out.compare(network->out.size() - payload.size(), payload.size(), payload) == 0);
+}
+
+static void test_large_publish_is_cut_into_full_segments(void)
+{
+    std::string payload(5000, 'x');
+    TEST_ASSERT_TRUE(mqtt->beginPublish(topic, payload.size(), false));
+    streamPayload(payload);
+    TEST_ASSERT_EQUAL(1, mqtt->endPublish());
+    for (size_t i = 0; i + 1 < network->writes.size(); i++)
+        TEST_ASSERT_EQUAL(MQTT_WRITE_BUFFER_SIZE, network->writes[i]);
+    TEST_ASSERT_EQUAL((network->out.size() + MQTT_WRITE_BUFFER_SIZE - 1) / MQTT_WRITE_BUFFER_SIZE, network->writes.size());
+}
+
+// Fixed header, remaining length of 2 bytes, topic length and topic
+static size_t publishHeaderLength()
+{
+    return 1 + 2 + 2 + strlen(topic);
+}
+
+static void test_short_write_fails_the_streamed_publish(void)
+{
+    std::string payload(3000, 'x');
+    // The first full segment goes out, the second is cut short
+    network->budget = MQTT_WRITE_BUFFER_SIZE + 100;
+    TEST_ASSERT_TRUE(mqtt->beginPublish(topic, payload.size(), false));
+    size_t accepted = mqtt->write((const uint8_t *)payload.data(), payload.size());
+    // Exactly the payload bytes that reached the network are reported as written
+    TEST_ASSERT_EQUAL(network->out.size() - publishHeaderLength(), accepted);
+
+    // The error sticks: later writes are refused and endPublish reports it,
+    // even though nothing is left in the buffer to fail
+    TEST_ASSERT_EQUAL(0, mqtt->write((uint8_t)'y'));
+    network->budget = SIZE_MAX;
+    TEST_ASSERT_EQUAL(0, mqtt->endPublish());
+
+    // The next message starts clean
+    TEST_ASSERT_TRUE(mqtt->beginPublish(topic, 2, false));
+    streamPayload("ok");
+    TEST_ASSERT_EQUAL(1, mqtt->endPublish());
+}
+
+static void test_dropped_bytes_of_earlier_writes_fail_the_message(void)
+{
+    TEST_ASSERT_TRUE(mqtt->beginPublish(topic, 4000, false));
+    std::string chunk(MQTT_WRITE_BUFFER_SIZE, 'x');
+    // Only part of the buffered header gets out when the buffer fills
+    network->budget = 10;
+    TEST_ASSERT_EQUAL(0, mqtt->write((const uint8_t *)chunk.data(), chunk.size()));
+    TEST_ASSERT_EQUAL(10, network->out.size());
+    TEST_ASSERT_EQUAL(0, mqtt->endPublish());
+}
+
+static void test_packet_does_not_follow_a_broken_stream(void)
+{
+    std::string payload(2000, 'x');
+    network->budget = 50;
+    TEST_ASSERT_TRUE(mqtt->beginPublish(topic, payload.size(), false));
+    streamPayload(payload);
+    network->budget = SIZE_MAX;
+    size_t sent = network->out.size();
+
+    // A plain publish would be read by the broker as the rest of the payload
+    TEST_ASSERT_FALSE(mqtt->publish(topic, "{\"a\":1}"));
+    TEST_ASSERT_EQUAL(sent, network->out.size());
+    TEST_ASSERT_EQUAL(0, mqtt->endPublish());
+}
+
+static void test_publish_p_reports_a_short_write(void)
+{
+    std::string payload(600, 'p');
+    network->budget = 300;
+    TEST_ASSERT_FALSE(mqtt->publish_P(topic, (const uint8_t *)payload.data(), payload.size(), false));
+    network->budget = SIZE_MAX;
+    TEST_ASSERT_TRUE(mqtt->publish_P(topic, (const uint8_t *)payload.data(), payload.size(), false));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_streamed_publish_leaves_in_one_write);
+    RUN_TEST(test_large_publish_is_cut_into_full_segments);
+    RUN_TEST(test_short_write_fails_the_streamed_publish);
+    RUN_TEST(test_dropped_bytes_of_earlier_writes_fail_the_message);
+    RUN_TEST(test_packet_does_not_follow_a_broken_stream);
+    RUN_TEST(test_publish_p_reports_a_short_write);
+    return UNITY_END();
+}
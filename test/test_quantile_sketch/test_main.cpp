@@ -0,0 +1,181 @@
+// Quantile sketch accuracy against exact quantiles, merging, encoding and the
+// cost of an update.
+#include <Arduino.h>
+#include <unity.h>
+
+#include "quantile_sketch.cpp"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+static float exactQuantile(std::vector<float> values, float q)
+{
+    std::sort(values.begin(), values.end());
+    return values[(size_t)(q * (values.size() - 1))];
+}
+
+static void assertWithinAlpha(const QuantileSketch_t *sketch, const std::vector<float> &values)
+{
+    for (float q : {0.05f, 0.25f, 0.5f, 0.75f, 0.95f, 0.99f})
+    {
+        float exact = exactQuantile(values, q);
+        float estimate = sketch_quantile(sketch, q);
+        // The rank of an estimate is exact, a float rounding of the bin bounds aside
+        TEST_ASSERT_FLOAT_WITHIN(fabsf(exact) * QUANTILE_SKETCH_ALPHA * 1.01f + QUANTILE_SKETCH_MIN_VALUE, exact,
+                                 estimate);
+    }
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+static void test_empty_sketch_has_no_quantiles(void)
+{
+    QuantileSketch_t sketch;
+    sketch_reset(&sketch);
+    TEST_ASSERT_TRUE(isnan(sketch_quantile(&sketch, 0.5f)));
+    TEST_ASSERT_EQUAL(0, sketch.count);
+}
+
+static void test_sensor_readings_within_one_percent(void)
+{
+    std::mt19937 random(1);
+    std::normal_distribution<float> temperature(27.0f, 3.0f);
+    QuantileSketch_t sketch;
+    sketch_reset(&sketch);
+    std::vector<float> values;
+    for (int i = 0; i < 100000; i++)
+    {
+        float value = roundf(temperature(random) * 100) / 100;
+        values.push_back(value);
+        sketch_add(&sketch, value);
+    }
+    assertWithinAlpha(&sketch, values);
+    TEST_ASSERT_EQUAL_FLOAT(*std::min_element(values.begin(), values.end()), sketch.min);
+    TEST_ASSERT_EQUAL_FLOAT(*std::max_element(values.begin(), values.end()), sketch.max);
+    TEST_ASSERT_EQUAL_FLOAT(*std::max_element(values.begin(), values.end()), sketch_quantile(&sketch, 1.0f));
+}
+
+static void test_negative_and_zero_values(void)
+{
+    std::mt19937 random(2);
+    // A freezer probe, the negative store spans the same factor as the positive one
+    std::normal_distribution<float> freezer(-18.0f, 2.0f);
+    QuantileSketch_t sketch;
+    sketch_reset(&sketch);
+    std::vector<float> values;
+    for (int i = 0; i < 50000; i++)
+    {
+        float value = (i % 10 == 0) ? 0.0f : freezer(random);
+        values.push_back(value);
+        sketch_add(&sketch, value);
+    }
+    assertWithinAlpha(&sketch, values);
+    TEST_ASSERT_EQUAL(5000, sketch.zeroCount);
+}
+
+static void test_single_outliers_keep_the_bulk_accurate(void)
+{
+    std::mt19937 random(3);
+    std::normal_distribution<float> humidity(60.0f, 5.0f);
+    QuantileSketch_t sketch;
+    sketch_reset(&sketch);
+    std::vector<float> values;
+    for (int i = 0; i < 50000; i++)
+    {
+        float value = (i % 1000 == 999) ? 5000.0f : humidity(random);
+        values.push_back(value);
+        sketch_add(&sketch, value);
+    }
+    for (float q : {0.05f, 0.5f, 0.95f})
+    {
+        float exact = exactQuantile(values, q);
+        TEST_ASSERT_FLOAT_WITHIN(exact * QUANTILE_SKETCH_ALPHA * 1.01f, exact, sketch_quantile(&sketch, q));
+    }
+    TEST_ASSERT_EQUAL_FLOAT(5000.0f, sketch.max);
+}
+
+static void test_merged_halves_equal_the_whole(void)
+{
+    std::mt19937 random(4);
+    std::lognormal_distribution<float> skewed(1.0f, 0.5f);
+    QuantileSketch_t whole, odd, even;
+    sketch_reset(&whole);
+    sketch_reset(&odd);
+    sketch_reset(&even);
+    for (int i = 0; i < 20000; i++)
+    {
+        float value = skewed(random);
+        sketch_add(&whole, value);
+        sketch_add((i & 1) ? &odd : &even, value);
+    }
+    sketch_merge(&odd, &even);
+    TEST_ASSERT_EQUAL(whole.count, odd.count);
+    for (float q : {0.01f, 0.5f, 0.9f, 0.99f})
+    {
+        TEST_ASSERT_EQUAL_FLOAT(sketch_quantile(&whole, q), sketch_quantile(&odd, q));
+    }
+}
+
+static void test_encoding_is_compact(void)
+{
+    QuantileSketch_t sketch;
+    sketch_reset(&sketch);
+    for (int i = 0; i < 1000; i++)
+    {
+        sketch_add(&sketch, 25.0f + (i % 7) * 0.5f);
+    }
+    char buffer[512];
+    size_t length = sketch_encode(&sketch, buffer, sizeof(buffer));
+    TEST_ASSERT_GREATER_THAN(0, length);
+    TEST_ASSERT_EQUAL(strlen(buffer), length);
+    TEST_ASSERT_EQUAL('a', buffer[0]);
+    TEST_ASSERT_NOT_NULL(strstr(buffer, ";p"));
+
+    char tiny[8];
+    TEST_ASSERT_EQUAL(0, sketch_encode(&sketch, tiny, sizeof(tiny)));
+}
+
+static void test_update_cost(void)
+{
+    std::mt19937 random(5);
+    std::normal_distribution<float> temperature(27.0f, 3.0f);
+    std::vector<float> values(200000);
+    for (float &value : values)
+    {
+        value = temperature(random);
+    }
+    QuantileSketch_t sketch;
+    sketch_reset(&sketch);
+    auto start = std::chrono::steady_clock::now();
+    for (float value : values)
+    {
+        sketch_add(&sketch, value);
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / values.size();
+
+    char line[120];
+    snprintf(line, sizeof(line), "sketch_add: %.1f ns per value, %u bytes per sketch", ns, (unsigned)sizeof(sketch));
+    TEST_MESSAGE(line);
+    TEST_ASSERT_EQUAL(values.size(), sketch.count);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_sketch_has_no_quantiles);
+    RUN_TEST(test_sensor_readings_within_one_percent);
+    RUN_TEST(test_negative_and_zero_values);
+    RUN_TEST(test_single_outliers_keep_the_bulk_accurate);
+    RUN_TEST(test_merged_halves_equal_the_whole);
+    RUN_TEST(test_encoding_is_compact);
+    RUN_TEST(test_update_cost);
+    return UNITY_END();
+}
@@ -0,0 +1,3 @@
+// The token buckets of the admission module, built as their own translation
+// unit: admission.cpp and rpc_pool.cpp both keep a static `stats`.
+#include "admission.cpp"
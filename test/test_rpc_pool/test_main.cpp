@@ -0,0 +1,195 @@
+// RPC worker pool with real worker threads: concurrency limits, deadlines,
+// rejections answered by the submitting task, and worker responses that
+// find the response queue full.
+#include <Arduino.h>
+#include <unity.h>
+
+#include "rpc_pool.cpp"
+
+#include <vector>
+
+QueueHandle_t xRpcRequestQueue;
+QueueHandle_t xRpcResponseQueue;
+SemaphoreHandle_t xRpcMutex;
+
+static bool workersStarted = false;
+
+static String sleepHandler(JsonVariantConst params)
+{
+    vTaskDelay(params["ms"] | 100);
+    return "{\"slept\":" + String((int)(params["ms"] | 100)) + "}";
+}
+
+static String okHandler(JsonVariantConst params)
+{
+    return "{\"ok\":true}";
+}
+
+// Rejections published right away, as "<id> <body>"
+static std::vector<std::string> rejected;
+
+static void submit(uint32_t id, const char *message)
+{
+    char topic[64];
+    snprintf(topic, sizeof(topic), "v1/devices/me/rpc/request/%lu", (unsigned long)id);
+    String responseTopic, response;
+    if (!rpc_submit(topic, (const uint8_t *)message, strlen(message), responseTopic, response))
+    {
+        TEST_ASSERT_TRUE(responseTopic == String("v1/devices/me/rpc/response/") + String(id));
+        rejected.push_back(std::to_string(id) + " " + response.c_str());
+    }
+}
+
+// Responses taken within timeoutMs, as "<id> <body>"
+static std::vector<std::string> collect(size_t count, unsigned long timeoutMs)
+{
+    std::vector<std::string> responses;
+    unsigned long start = millis();
+    while (responses.size() < count && millis() - start < timeoutMs)
+    {
+        String topic, body;
+        while (rpc_take_response(topic, body))
+        {
+            const char *id = strrchr(topic.c_str(), '/') + 1;
+            responses.push_back(std::string(id) + " " + body.c_str());
+        }
+        ulTaskNotifyTake(pdTRUE, 10);
+    }
+    return responses;
+}
+
+static bool contains(const std::vector<std::string> &responses, const char *response)
+{
+    return std::find(responses.begin(), responses.end(), response) != responses.end();
+}
+
+void setUp(void)
+{
+    // Workers run forever, the pool is set up once for the whole suite
+    if (workersStarted)
+    {
+        return;
+    }
+    xRpcRequestQueue = xQueueCreate(RPC_QUEUE_LENGTH, sizeof(RpcRequest_t));
+    xRpcResponseQueue = xQueueCreate(RPC_QUEUE_LENGTH, sizeof(RpcResponse_t));
+    xRpcMutex = xSemaphoreCreateMutex();
+    rpc_register("sleep", sleepHandler, 3, 500, 100, 100);
+    rpc_register("ok", okHandler, 4, 500, 100, 100);
+    rpc_register("limited", okHandler, 4, 500, 0.001f, 2);
+    for (int i = 0; i < RPC_WORKERS; i++)
+    {
+        xTaskCreate(rpc_worker_task, "Task RPC", 4096, NULL, 1, NULL);
+    }
+    workersStarted = true;
+}
+
+void tearDown(void)
+{
+    // Nothing may be left over for the next test
+    collect(SIZE_MAX, 200);
+    rejected.clear();
+}
+
+static void test_handlers_run_on_the_workers(void)
+{
+    submit(1, "{\"method\":\"ok\"}");
+    submit(2, "{\"method\":\"sleep\",\"params\":{\"ms\":20}}");
+    std::vector<std::string> responses = collect(2, 1000);
+    TEST_ASSERT_EQUAL(2, responses.size());
+    TEST_ASSERT_TRUE(contains(responses, "1 {\"ok\":true}"));
+    TEST_ASSERT_TRUE(contains(responses, "2 {\"slept\":20}"));
+}
+
+static void test_rejections_are_answered(void)
+{
+    submit(10, "{\"method\":\"nope\"}");
+    submit(11, "not json");
+    std::string large(RPC_MAX_REQUEST_SIZE, ' ');
+    submit(12, large.c_str());
+    TEST_ASSERT_EQUAL(3, rejected.size());
+    TEST_ASSERT_TRUE(contains(rejected, "10 {\"error\":\"unknown method\"}"));
+    TEST_ASSERT_TRUE(contains(rejected, "11 {\"error\":\"invalid request\"}"));
+    TEST_ASSERT_TRUE(contains(rejected, "12 {\"error\":\"request too large\"}"));
+    // Nothing went through the response queue
+    TEST_ASSERT_EQUAL(0, collect(SIZE_MAX, 50).size());
+}
+
+static void test_method_limits(void)
+{
+    RpcStats_t before = rpc_get_stats();
+    // Three sleeps at once, the fourth is busy
+    for (uint32_t id = 20; id < 24; id++)
+    {
+        submit(id, "{\"method\":\"sleep\",\"params\":{\"ms\":50}}");
+    }
+    // Burst of two, then rate limited
+    for (uint32_t id = 30; id < 33; id++)
+    {
+        submit(id, "{\"method\":\"limited\"}");
+    }
+    TEST_ASSERT_EQUAL(2, rejected.size());
+    TEST_ASSERT_TRUE(contains(rejected, "23 {\"error\":\"busy\"}"));
+    TEST_ASSERT_TRUE(contains(rejected, "32 {\"error\":\"rate limited\"}"));
+    TEST_ASSERT_EQUAL(5, collect(5, 1000).size());
+
+    RpcStats_t after = rpc_get_stats();
+    TEST_ASSERT_EQUAL(1, after.rejectedBusy - before.rejectedBusy);
+    TEST_ASSERT_EQUAL(1, after.rejectedRate - before.rejectedRate);
+}
+
+static void test_requests_queued_past_their_deadline_expire(void)
+{
+    RpcStats_t before = rpc_get_stats();
+    // Both workers sleep past the 500 ms deadline, the third request waits for them
+    submit(40, "{\"method\":\"sleep\",\"params\":{\"ms\":600}}");
+    submit(41, "{\"method\":\"sleep\",\"params\":{\"ms\":600}}");
+    submit(42, "{\"method\":\"sleep\",\"params\":{\"ms\":10}}");
+    std::vector<std::string> responses = collect(1, 1500);
+    TEST_ASSERT_EQUAL(1, responses.size());
+    TEST_ASSERT_TRUE(responses[0] == "42 {\"error\":\"timeout\"}");
+
+    RpcStats_t after = rpc_get_stats();
+    TEST_ASSERT_EQUAL(1, after.expired - before.expired);
+    TEST_ASSERT_EQUAL(2, after.late - before.late);
+}
+
+// The network task does not empty the response queue: rejections are still
+// answered, worker responses beyond the queue are dropped and counted
+static void test_full_response_queue(void)
+{
+    RpcStats_t before = rpc_get_stats();
+    for (uint32_t id = 50; id < 50 + RPC_QUEUE_LENGTH + 2; id++)
+    {
+        submit(id, "{\"method\":\"ok\"}");
+        // Handled before the next one, the method allows 4 at once
+        vTaskDelay(20);
+    }
+    unsigned long start = millis();
+    for (uint32_t id = 100; id < 110; id++)
+    {
+        submit(id, "{\"method\":\"nope\"}");
+    }
+    unsigned long elapsed = millis() - start;
+    // The workers give up on the last two responses after a second
+    vTaskDelay(1200);
+
+    char line[80];
+    snprintf(line, sizeof(line), "10 rejections on a full response queue: %lu ms", elapsed);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_LESS_THAN(50, elapsed);
+    TEST_ASSERT_EQUAL(10, rejected.size());
+    RpcStats_t after = rpc_get_stats();
+    TEST_ASSERT_EQUAL(2, after.droppedResponses - before.droppedResponses);
+    TEST_ASSERT_EQUAL(RPC_QUEUE_LENGTH, collect(SIZE_MAX, 100).size());
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_handlers_run_on_the_workers);
+    RUN_TEST(test_rejections_are_answered);
+    RUN_TEST(test_method_limits);
+    RUN_TEST(test_requests_queued_past_their_deadline_expire);
+    RUN_TEST(test_full_response_queue);
+    return UNITY_END();
+}
@@ -0,0 +1,209 @@
+// Sample history and its score series on the in-memory LittleFS: scores stay
+// on their sample across rotations and reloads, a stale generation or index
+// is refused, and a new model starts the series over.
+#include <Arduino.h>
+#include <unity.h>
+#include <LittleFS.h>
+
+// Small segments, so a test rotates a few times
+#define HISTORY_SEGMENT_RECORDS 256
+
+#include "storage.cpp"
+#include "sample_history.cpp"
+
+#include <vector>
+
+SemaphoreHandle_t xStorageMutex;
+SemaphoreHandle_t xHistoryMutex;
+
+static uint32_t appended;
+
+static void appendSamples(uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++, appended++)
+    {
+        // The temperature numbers the sample, in 0.01 °C
+        TEST_ASSERT_TRUE(history_append((appended % 30000) / 100.0f, 50.0f));
+    }
+}
+
+// What the model makes of a sample, different for neighbours so a shift shows
+static float scoreOf(const HistorySample_t *sample)
+{
+    return ((sample->temperature * 37) % 1000) / 1000.0f;
+}
+
+/**
+ * @brief Scores up to `max` unscored samples the way tinyml's backfill does.
+ * @return Samples scored
+ */
+static size_t scoreBatch(uint32_t modelId, size_t max)
+{
+    uint32_t generation = history_generation();
+    uint32_t index = history_scored(modelId);
+    std::vector<HistorySample_t> samples(max);
+    std::vector<float> scores(max);
+    size_t n = history_read(index, samples.data(), max);
+    for (size_t i = 0; i < n; i++)
+    {
+        scores[i] = scoreOf(&samples[i]);
+    }
+    return history_append_scores(generation, index, scores.data(), n) ? n : 0;
+}
+
+static void scoreAll(uint32_t modelId)
+{
+    while (scoreBatch(modelId, 100) > 0)
+    {
+    }
+    TEST_ASSERT_EQUAL(history_count(), history_scored(modelId));
+}
+
+// Every stored score belongs to the sample at its index
+static void checkAligned(uint32_t scored)
+{
+    uint32_t count = history_count();
+    std::vector<HistorySample_t> samples(count);
+    std::vector<float> scores(count);
+    TEST_ASSERT_EQUAL(count, history_read(0, samples.data(), count));
+    TEST_ASSERT_EQUAL(scored, history_read_scores(0, scores.data(), count));
+    for (uint32_t i = 0; i < scored; i++)
+    {
+        TEST_ASSERT_FLOAT_WITHIN(1.0f / 65535, scoreOf(&samples[i]), scores[i]);
+    }
+}
+
+// A reset: the files stay, every static is loaded again
+static void reload()
+{
+    storage_close(samplesFile);
+    TEST_ASSERT_TRUE(history_begin());
+}
+
+void setUp(void)
+{
+    hostFs.reset();
+    xStorageMutex = xSemaphoreCreateMutex();
+    xHistoryMutex = xSemaphoreCreateMutex();
+    appended = 0;
+    TEST_ASSERT_TRUE(history_begin());
+}
+
+void tearDown(void)
+{
+    storage_close(samplesFile);
+    vSemaphoreDelete(xHistoryMutex);
+    vSemaphoreDelete(xStorageMutex);
+}
+
+static void test_scores_stay_aligned_across_rotations(void)
+{
+    appendSamples(HISTORY_SEGMENT_RECORDS);
+    TEST_ASSERT_EQUAL(100, scoreBatch(1, 100));
+
+    // A batch read before the rotation is refused after it
+    uint32_t generation = history_generation();
+    uint32_t index = history_scored(1);
+    float stale[10] = {};
+    appendSamples(1);
+    TEST_ASSERT_EQUAL(generation + 1, history_generation());
+    TEST_ASSERT_EQUAL(HISTORY_SEGMENT_RECORDS, history_aged());
+    TEST_ASSERT_FALSE(history_append_scores(generation, index, stale, 10));
+
+    // One batch spans the end of the previous segment and the current one
+    scoreAll(1);
+    checkAligned(HISTORY_SEGMENT_RECORDS + 1);
+
+    // The fully scored current segment ages, the new one starts unscored
+    appendSamples(HISTORY_SEGMENT_RECORDS - 1);
+    scoreAll(1);
+    appendSamples(10);
+    TEST_ASSERT_EQUAL(HISTORY_SEGMENT_RECORDS, history_aged());
+    TEST_ASSERT_EQUAL(HISTORY_SEGMENT_RECORDS + 10, history_count());
+    TEST_ASSERT_EQUAL(HISTORY_SEGMENT_RECORDS, history_scored(1));
+    checkAligned(HISTORY_SEGMENT_RECORDS);
+    scoreAll(1);
+    checkAligned(HISTORY_SEGMENT_RECORDS + 10);
+}
+
+static void test_partly_scored_segment_ages(void)
+{
+    appendSamples(HISTORY_SEGMENT_RECORDS);
+    TEST_ASSERT_EQUAL(100, scoreBatch(1, 100));
+    // Rotates twice: the scored samples drop out, scoring starts over at index 0
+    appendSamples(2 * HISTORY_SEGMENT_RECORDS);
+    TEST_ASSERT_EQUAL(0, history_scored(1));
+    scoreAll(1);
+    checkAligned(2 * HISTORY_SEGMENT_RECORDS);
+}
+
+static void test_reload_keeps_the_series(void)
+{
+    appendSamples(HISTORY_SEGMENT_RECORDS + 50);
+    scoreAll(7);
+    appendSamples(20);
+    uint32_t generation = history_generation();
+
+    reload();
+    TEST_ASSERT_EQUAL(HISTORY_SEGMENT_RECORDS + 70, history_count());
+    TEST_ASSERT_EQUAL(HISTORY_SEGMENT_RECORDS + 50, history_scored(7));
+    checkAligned(HISTORY_SEGMENT_RECORDS + 50);
+
+    // Scoring carries on from where it was, a stale generation from before the
+    // reset only passes if nothing rotated
+    float scores[20];
+    std::vector<HistorySample_t> samples(20);
+    TEST_ASSERT_EQUAL(20, history_read(HISTORY_SEGMENT_RECORDS + 50, samples.data(), 20));
+    for (int i = 0; i < 20; i++)
+    {
+        scores[i] = scoreOf(&samples[i]);
+    }
+    TEST_ASSERT_FALSE(history_append_scores(history_generation(), HISTORY_SEGMENT_RECORDS + 49, scores, 20));
+    TEST_ASSERT_EQUAL(generation, history_generation());
+    TEST_ASSERT_TRUE(history_append_scores(history_generation(), HISTORY_SEGMENT_RECORDS + 50, scores, 20));
+    checkAligned(HISTORY_SEGMENT_RECORDS + 70);
+
+    // Scores cut short in the previous segment (a reset mid-write) make the
+    // current segment's scores unusable, scoring resumes at the gap
+    auto oldScores = hostFs.files[SCORES_OLD_FILE];
+    oldScores->resize(oldScores->size() - 10 * sizeof(uint16_t));
+    reload();
+    TEST_ASSERT_EQUAL(HISTORY_SEGMENT_RECORDS - 10, history_scored(7));
+    checkAligned(HISTORY_SEGMENT_RECORDS - 10);
+    scoreAll(7);
+    checkAligned(HISTORY_SEGMENT_RECORDS + 70);
+}
+
+static void test_model_change_restarts_the_series(void)
+{
+    appendSamples(HISTORY_SEGMENT_RECORDS + 30);
+    scoreAll(1);
+
+    // A new model starts at the oldest sample, the old scores are gone
+    TEST_ASSERT_EQUAL(0, history_scored(2));
+    float score;
+    TEST_ASSERT_EQUAL(0, history_read_scores(0, &score, 1));
+    TEST_ASSERT_FALSE(LittleFS.exists(SCORES_OLD_FILE));
+    scoreAll(2);
+    checkAligned(HISTORY_SEGMENT_RECORDS + 30);
+
+    // The score files remember the model over a reset
+    reload();
+    TEST_ASSERT_EQUAL(HISTORY_SEGMENT_RECORDS + 30, history_scored(2));
+    TEST_ASSERT_EQUAL(0, history_scored(1));
+
+    // Dropping keeps the model, re-scoring starts over too
+    scoreAll(1);
+    history_drop_scores();
+    TEST_ASSERT_EQUAL(0, history_scored(1));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_scores_stay_aligned_across_rotations);
+    RUN_TEST(test_partly_scored_segment_ages);
+    RUN_TEST(test_reload_keeps_the_series);
+    RUN_TEST(test_model_change_restarts_the_series);
+    return UNITY_END();
+}
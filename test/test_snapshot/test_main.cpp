@@ -0,0 +1,200 @@
+// Warm-restart snapshots: round trip through RTC memory and the flash file,
+// carry-over of blobs whose owner has not registered yet, and the cold
+// starts after corruption, a layout change or a power loss.
+#include <Arduino.h>
+#include <unity.h>
+#include <LittleFS.h>
+
+#include "snapshot.cpp"
+#include "quantile_sketch.cpp"
+
+SemaphoreHandle_t xSnapshotMutex;
+
+// The open telemetry window, the biggest blob the firmware registers
+typedef struct {
+    uint32_t elapsed;
+    QuantileSketch_t temperature;
+    QuantileSketch_t humidity;
+} Window_t;
+
+static Window_t window, restoredWindow;
+static float reading, restoredReading;
+static uint8_t display, restoredDisplay;
+
+static void saveWindow(void *buffer) { memcpy(buffer, &window, sizeof(window)); }
+static void restoreWindow(const void *buffer) { memcpy(&restoredWindow, buffer, sizeof(restoredWindow)); }
+static void saveReading(void *buffer) { memcpy(buffer, &reading, sizeof(reading)); }
+static void restoreReading(const void *buffer) { memcpy(&restoredReading, buffer, sizeof(restoredReading)); }
+static void saveDisplay(void *buffer) { memcpy(buffer, &display, sizeof(display)); }
+static void restoreDisplay(const void *buffer) { memcpy(&restoredDisplay, buffer, sizeof(restoredDisplay)); }
+
+static bool registerReading(uint16_t version = 1)
+{
+    return snapshot_register("sensor", version, sizeof(reading), saveReading, restoreReading);
+}
+
+static bool registerDisplay()
+{
+    return snapshot_register("lcd", 1, sizeof(display), saveDisplay, restoreDisplay);
+}
+
+static bool registerWindow()
+{
+    return snapshot_register("window", 1, sizeof(window), saveWindow, restoreWindow);
+}
+
+// A reset: RAM state is gone, RTC memory and the file system stay
+static void reboot()
+{
+    entryCount = 0;
+    free(bootImage);
+    bootImage = NULL;
+    sequence = 0;
+    snapshot_begin();
+}
+
+void setUp(void)
+{
+    hostFs.reset();
+    xSnapshotMutex = xSemaphoreCreateMutex();
+    // Power-on content of RTC memory
+    memset(rtcImage, 0xA5, sizeof(rtcImage));
+    restoredReading = 0;
+    restoredDisplay = 0;
+    memset(&restoredWindow, 0, sizeof(restoredWindow));
+
+    reading = 1.5f;
+    display = 2;
+    window.elapsed = 123456;
+    sketch_reset(&window.temperature);
+    sketch_reset(&window.humidity);
+    for (int i = 0; i < 1000; i++)
+    {
+        sketch_add(&window.temperature, 20.0f + i * 0.01f);
+        sketch_add(&window.humidity, 50.0f - i * 0.02f);
+    }
+
+    reboot();
+}
+
+void tearDown(void)
+{
+    vSemaphoreDelete(xSnapshotMutex);
+}
+
+static void test_cold_start_restores_nothing(void)
+{
+    TEST_ASSERT_NULL(bootImage);
+    TEST_ASSERT_FALSE(registerReading());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, restoredReading);
+}
+
+static void test_warm_restart_from_rtc(void)
+{
+    registerWindow();
+    registerReading();
+    TEST_ASSERT_TRUE(snapshot_save(SNAPSHOT_TARGET_RTC));
+    TEST_ASSERT_FALSE(LittleFS.exists(SNAPSHOT_FILE));
+
+    reboot();
+    TEST_ASSERT_TRUE(registerWindow());
+    TEST_ASSERT_EQUAL_MEMORY(&window, &restoredWindow, sizeof(window));
+    TEST_ASSERT_EQUAL_FLOAT(sketch_quantile(&window.temperature, 0.5f), sketch_quantile(&restoredWindow.temperature, 0.5f));
+    TEST_ASSERT_TRUE(registerReading());
+    TEST_ASSERT_EQUAL_FLOAT(1.5f, restoredReading);
+}
+
+static void test_unregistered_blobs_are_carried_over(void)
+{
+    registerReading();
+    registerDisplay();
+    snapshot_save(SNAPSHOT_TARGET_RTC);
+
+    // The display task has not registered yet when the next save runs
+    reboot();
+    registerReading();
+    reading = 2.5f;
+    snapshot_save(SNAPSHOT_TARGET_RTC);
+
+    reboot();
+    TEST_ASSERT_TRUE(registerDisplay());
+    TEST_ASSERT_EQUAL(2, restoredDisplay);
+    TEST_ASSERT_TRUE(registerReading());
+    TEST_ASSERT_EQUAL_FLOAT(2.5f, restoredReading);
+}
+
+static void test_corrupt_rtc_falls_back_to_flash(void)
+{
+    registerReading();
+    TEST_ASSERT_TRUE(snapshot_save(SNAPSHOT_TARGET_RTC | SNAPSHOT_TARGET_FLASH));
+    TEST_ASSERT_TRUE(LittleFS.exists(SNAPSHOT_FILE));
+    TEST_ASSERT_FALSE(LittleFS.exists(SNAPSHOT_FILE ".tmp"));
+    reading = 2.5f;
+    snapshot_save(SNAPSHOT_TARGET_RTC);
+
+    // A reset in the middle of the RTC copy
+    rtcImage[sizeof(SnapshotHeader_t) + 8] ^= 1;
+    reboot();
+    TEST_ASSERT_TRUE(registerReading());
+    TEST_ASSERT_EQUAL_FLOAT(1.5f, restoredReading);
+}
+
+static void test_newer_flash_copy_wins(void)
+{
+    registerReading();
+    snapshot_save(SNAPSHOT_TARGET_RTC);
+    reading = 3.5f;
+    snapshot_save(SNAPSHOT_TARGET_FLASH);
+
+    reboot();
+    TEST_ASSERT_TRUE(registerReading());
+    TEST_ASSERT_EQUAL_FLOAT(3.5f, restoredReading);
+}
+
+static void test_layout_change_starts_cold(void)
+{
+    registerReading();
+    snapshot_save(SNAPSHOT_TARGET_RTC);
+    reboot();
+    TEST_ASSERT_FALSE(registerReading(2));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, restoredReading);
+}
+
+static void test_power_loss_without_flash_copy_starts_cold(void)
+{
+    registerReading();
+    snapshot_save(SNAPSHOT_TARGET_RTC);
+    memset(rtcImage, 0, sizeof(rtcImage));
+    reboot();
+    TEST_ASSERT_NULL(bootImage);
+    TEST_ASSERT_FALSE(registerReading());
+}
+
+static void test_failed_flash_write_keeps_the_previous_file(void)
+{
+    registerReading();
+    TEST_ASSERT_TRUE(snapshot_save(SNAPSHOT_TARGET_FLASH));
+    reading = 4.5f;
+    hostFs.writeBudget = 10;
+    TEST_ASSERT_FALSE(snapshot_save(SNAPSHOT_TARGET_FLASH));
+    hostFs.writeBudget = SIZE_MAX;
+
+    memset(rtcImage, 0, sizeof(rtcImage));
+    reboot();
+    TEST_ASSERT_TRUE(registerReading());
+    TEST_ASSERT_EQUAL_FLOAT(1.5f, restoredReading);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_cold_start_restores_nothing);
+    RUN_TEST(test_warm_restart_from_rtc);
+    RUN_TEST(test_unregistered_blobs_are_carried_over);
+    RUN_TEST(test_corrupt_rtc_falls_back_to_flash);
+    RUN_TEST(test_newer_flash_copy_wins);
+    RUN_TEST(test_layout_change_starts_cold);
+    RUN_TEST(test_power_loss_without_flash_copy_starts_cold);
+    RUN_TEST(test_failed_flash_write_keeps_the_previous_file);
+    return UNITY_END();
+}
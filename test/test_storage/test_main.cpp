@@ -0,0 +1,227 @@
+// Write-coalescing append layer over the in-memory LittleFS: contents after
+// short writes, sync points, and LittleFS writes saved per append.
+#include <Arduino.h>
+#include <unity.h>
+#include <LittleFS.h>
+
+#include "storage.cpp"
+
+SemaphoreHandle_t xStorageMutex;
+
+static std::string contents(const char *path)
+{
+    auto file = hostFs.files.find(path);
+    return file == hostFs.files.end() ? std::string() : std::string(file->second->begin(), file->second->end());
+}
+
+static void appendRecords(StorageHandle_t handle, int first, int count)
+{
+    for (int i = first; i < first + count; i++)
+    {
+        char record[16];
+        snprintf(record, sizeof(record), "rec%04d;", i);
+        TEST_ASSERT_TRUE(storage_append(handle, record, strlen(record)));
+    }
+}
+
+static std::string expectedRecords(int count)
+{
+    std::string expected;
+    for (int i = 0; i < count; i++)
+    {
+        char record[16];
+        snprintf(record, sizeof(record), "rec%04d;", i);
+        expected += record;
+    }
+    return expected;
+}
+
+void setUp(void)
+{
+    hostFs.reset();
+    xStorageMutex = xSemaphoreCreateMutex();
+}
+
+void tearDown(void)
+{
+    for (int i = 0; i < STORAGE_MAX_FILES; i++)
+    {
+        storage_close(i);
+    }
+    vSemaphoreDelete(xStorageMutex);
+}
+
+static void test_appends_reach_the_file_in_order(void)
+{
+    StorageHandle_t handle = storage_open("/log.txt", NULL, 256);
+    appendRecords(handle, 0, 100);
+    TEST_ASSERT_EQUAL(800, storage_size(handle));
+    TEST_ASSERT_TRUE(storage_sync(handle));
+    TEST_ASSERT_TRUE(expectedRecords(100) == contents("/log.txt"));
+    // 800 bytes through a 256 byte buffer
+    TEST_ASSERT_EQUAL(4, hostFs.writes);
+}
+
+static void test_short_write_keeps_only_the_unwritten_rest(void)
+{
+    StorageHandle_t handle = storage_open("/log.txt", NULL, 256);
+    appendRecords(handle, 0, 20);
+
+    // The partition fills up in the middle of the flush
+    hostFs.writeBudget = 100;
+    TEST_ASSERT_FALSE(storage_sync(handle));
+    TEST_ASSERT_EQUAL(100, contents("/log.txt").size());
+    TEST_ASSERT_EQUAL(160, storage_size(handle));
+
+    // Space again: the rest follows the prefix, nothing is written twice
+    hostFs.writeBudget = SIZE_MAX;
+    appendRecords(handle, 20, 10);
+    TEST_ASSERT_TRUE(storage_sync(handle));
+    TEST_ASSERT_TRUE(expectedRecords(30) == contents("/log.txt"));
+    TEST_ASSERT_EQUAL(240, storage_size(handle));
+
+    StorageStats_t stats;
+    storage_get_stats(handle, &stats);
+    TEST_ASSERT_EQUAL(1, stats.failedWrites);
+    TEST_ASSERT_EQUAL(240, stats.bytesWritten);
+}
+
+static void test_failed_open_keeps_everything_buffered(void)
+{
+    StorageHandle_t handle = storage_open("/log.txt", NULL, 256);
+    appendRecords(handle, 0, 10);
+    hostFs.writeBudget = 0;
+    TEST_ASSERT_FALSE(storage_sync(handle));
+    TEST_ASSERT_FALSE(storage_sync(handle));
+    hostFs.writeBudget = SIZE_MAX;
+    TEST_ASSERT_TRUE(storage_sync(handle));
+    TEST_ASSERT_TRUE(expectedRecords(10) == contents("/log.txt"));
+}
+
+static void test_policies_and_critical_appends_sync(void)
+{
+    StorageSyncPolicy_t policy = {0, 5};
+    StorageHandle_t handle = storage_open("/log.txt", &policy, 256);
+    appendRecords(handle, 0, 4);
+    TEST_ASSERT_EQUAL(0, contents("/log.txt").size());
+    appendRecords(handle, 4, 1);
+    TEST_ASSERT_EQUAL(40, contents("/log.txt").size());
+
+    TEST_ASSERT_TRUE(storage_append(handle, "alarm;", 6, STORAGE_PRIORITY_CRITICAL));
+    TEST_ASSERT_EQUAL(46, contents("/log.txt").size());
+}
+
+static void test_oversized_appends_go_straight_to_flash(void)
+{
+    StorageHandle_t handle = storage_open("/blob.bin", NULL, 256);
+    appendRecords(handle, 0, 2);
+    std::string blob(1000, 'x');
+    TEST_ASSERT_TRUE(storage_append(handle, blob.data(), blob.size()));
+    // The buffered records are flushed first, so the order holds
+    TEST_ASSERT_TRUE(expectedRecords(2) + blob == contents("/blob.bin"));
+}
+
+static void test_failed_close_keeps_the_buffer(void)
+{
+    StorageHandle_t handle = storage_open("/log.txt", NULL, 256);
+    appendRecords(handle, 0, 10);
+    hostFs.writeBudget = 0;
+    TEST_ASSERT_FALSE(storage_close(handle));
+    // Still open, with the records that did not reach the file
+    TEST_ASSERT_EQUAL(80, storage_size(handle));
+    TEST_ASSERT_EQUAL(handle, storage_open("/log.txt", NULL, 256));
+
+    hostFs.writeBudget = SIZE_MAX;
+    TEST_ASSERT_TRUE(storage_close(handle));
+    TEST_ASSERT_TRUE(expectedRecords(10) == contents("/log.txt"));
+    TEST_ASSERT_EQUAL(0, storage_size(handle));
+}
+
+// LittleFS writes and estimated write amplification of 32 byte appends,
+// direct vs coalesced, the host side of storage_benchmark()
+static void test_benchmark_coalescing(void)
+{
+    const int count = 1000;
+    char record[32];
+    memset(record, 0xA5, sizeof(record));
+
+    StorageHandle_t direct = storage_open("/direct.bin", NULL, 0);
+    StorageHandle_t coalesced = storage_open("/coalesced.bin", NULL, STORAGE_BLOCK_SIZE);
+    for (int i = 0; i < count; i++)
+    {
+        storage_append(direct, record, sizeof(record));
+        storage_append(coalesced, record, sizeof(record));
+    }
+    storage_sync(direct);
+    storage_sync(coalesced);
+
+    StorageStats_t directStats, coalescedStats;
+    storage_get_stats(direct, &directStats);
+    storage_get_stats(coalesced, &coalescedStats);
+    char line[160];
+    snprintf(line, sizeof(line), "%d x 32 B: direct %lu writes WA %.1f, coalesced %lu writes WA %.2f", count,
+             (unsigned long)directStats.flashWrites, storage_write_amplification(&directStats),
+             (unsigned long)coalescedStats.flashWrites, storage_write_amplification(&coalescedStats));
+    TEST_MESSAGE(line);
+
+    TEST_ASSERT_EQUAL(count, directStats.flashWrites);
+    TEST_ASSERT_EQUAL((count * 32 + STORAGE_BLOCK_SIZE - 1) / STORAGE_BLOCK_SIZE, coalescedStats.flashWrites);
+    TEST_ASSERT_TRUE(storage_write_amplification(&coalescedStats) < 2.0f);
+    TEST_ASSERT_EQUAL(contents("/direct.bin").size(), contents("/coalesced.bin").size());
+}
+
+// storage_benchmark()'s access patterns on the host image: append latency,
+// throughput, LittleFS writes and estimated block erases
+static void test_benchmark_patterns(void)
+{
+    const size_t patterns = sizeof(benchmarkPatterns) / sizeof(benchmarkPatterns[0]);
+    StorageBenchmarkResult_t results[patterns];
+    LittleFS.mkdir("/bench");
+    for (size_t i = 0; i < patterns; i++)
+    {
+        const StorageBenchmarkPattern_t *pattern = &benchmarkPatterns[i];
+        results[i] = benchmarkPattern(pattern);
+        char line[160];
+        snprintf(line, sizeof(line), "%-24s %.2f us/append (max %lu) %8.0f KB/s %4lu writes WA %5.2f ~%3lu erases",
+                 pattern->name, (float)results[i].elapsedUs / pattern->count, results[i].worstUs,
+                 results[i].kbPerSecond, (unsigned long)results[i].total.flashWrites,
+                 storage_write_amplification(&results[i].total), (unsigned long)results[i].blockErases);
+        TEST_MESSAGE(line);
+        TEST_ASSERT_EQUAL(pattern->recordSize * pattern->count, results[i].total.bytesWritten);
+    }
+    LittleFS.rmdir("/bench");
+
+    // Every coalesced pattern against the direct one with the same records and files
+    for (size_t i = 0; i < patterns; i++)
+    {
+        if (benchmarkPatterns[i].bufferSize == 0)
+        {
+            continue;
+        }
+        for (size_t j = 0; j < patterns; j++)
+        {
+            if (benchmarkPatterns[j].bufferSize == 0 && benchmarkPatterns[j].fileCount == benchmarkPatterns[i].fileCount &&
+                benchmarkPatterns[j].recordSize == benchmarkPatterns[i].recordSize)
+            {
+                TEST_ASSERT_TRUE(results[i].total.flashWrites * 8 <= results[j].total.flashWrites);
+                TEST_ASSERT_TRUE(results[i].blockErases * 4 <= results[j].blockErases);
+            }
+        }
+    }
+    // The scratch files are gone afterwards
+    TEST_ASSERT_EQUAL(0, hostFs.usedBytes());
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_appends_reach_the_file_in_order);
+    RUN_TEST(test_short_write_keeps_only_the_unwritten_rest);
+    RUN_TEST(test_failed_open_keeps_everything_buffered);
+    RUN_TEST(test_policies_and_critical_appends_sync);
+    RUN_TEST(test_oversized_appends_go_straight_to_flash);
+    RUN_TEST(test_failed_close_keeps_the_buffer);
+    RUN_TEST(test_benchmark_coalescing);
+    RUN_TEST(test_benchmark_patterns);
+    return UNITY_END();
+}
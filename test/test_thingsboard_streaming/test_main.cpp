@@ -0,0 +1,204 @@
+// Streaming publish of ThingsBoard payloads bigger than the client buffer:
+// announced length, failure handling of Streaming_Publish_Writer and the
+// client writes it saves.
+#include <Arduino.h>
+#include <unity.h>
+#include <ThingsBoard.h>
+
+#include <chrono>
+#include <string>
+
+// Records what the ThingsBoard client does with a publish, writes fail
+// once failAfter bytes were written
+class RecordingClient : public IMQTT_Client
+{
+public:
+    size_t announced = 0;
+    std::string payload;
+    uint32_t writes = 0;
+    uint32_t publishes = 0;
+    bool ended = false;
+    size_t failAfter = SIZE_MAX;
+    bool keepPayload = true;
+
+    void set_callback(function cb) override {}
+    bool set_buffer_size(const uint16_t &size) override { buffer = size; return true; }
+    uint16_t get_buffer_size() override { return buffer; }
+    void set_server(const char *, const uint16_t &) override {}
+    bool connect(const char *, const char *, const char *) override { return true; }
+    void disconnect() override {}
+    bool loop() override { return true; }
+    bool publish(const char *, const uint8_t *p, const size_t &length) override
+    {
+        payload.assign((const char *)p, length);
+        publishes++;
+        return true;
+    }
+    bool subscribe(const char *) override { return true; }
+    bool unsubscribe(const char *) override { return true; }
+    bool connected() override { return true; }
+
+    bool begin_publish(const char *topic, const size_t &length) override
+    {
+        announced = length;
+        payload.clear();
+        sent = 0;
+        ended = false;
+        return true;
+    }
+    bool end_publish() override
+    {
+        ended = true;
+        publishes++;
+        // A broker reads exactly the announced bytes
+        return sent == announced;
+    }
+    size_t write(uint8_t b) override { return write(&b, 1); }
+    size_t write(const uint8_t *buf, size_t size) override
+    {
+        writes++;
+        if (sent + size > failAfter)
+            return 0;
+        sent += size;
+        if (keepPayload)
+            payload.append((const char *)buf, size);
+        return size;
+    }
+
+private:
+    uint16_t buffer = 64;
+    size_t sent = 0;
+};
+
+static RecordingClient *client;
+
+void setUp(void)
+{
+    client = new RecordingClient;
+}
+
+void tearDown(void)
+{
+    delete client;
+}
+
+template <typename TDocument>
+static void fillTelemetry(TDocument &doc, int keys)
+{
+    for (int i = 0; i < keys; i++)
+    {
+        char key[16];
+        snprintf(key, sizeof(key), "sensor_%02d", i);
+        doc[key] = 20.0 + i * 0.25;
+    }
+}
+
+static void test_streamed_publish_announces_the_serialized_length(void)
+{
+    ThingsBoardSized<32> tb(*client, 64, 4096, 32);
+    StaticJsonDocument<1024> doc;
+    fillTelemetry(doc, 24);
+    const size_t size = Helper::Measure_Json(doc);
+    TEST_ASSERT_GREATER_THAN(64, size);
+
+    TEST_ASSERT_TRUE(tb.sendTelemetryJson(doc, size));
+    TEST_ASSERT_TRUE(client->ended);
+    TEST_ASSERT_EQUAL(measureJson(doc), client->announced);
+    TEST_ASSERT_EQUAL(client->announced, client->payload.size());
+
+    std::string expected;
+    serializeJson(doc, expected);
+    TEST_ASSERT_EQUAL_STRING(expected.c_str(), client->payload.c_str());
+}
+
+static void test_small_payloads_are_not_streamed(void)
+{
+    ThingsBoardSized<32> tb(*client, 256, 4096, 32);
+    StaticJsonDocument<256> doc;
+    fillTelemetry(doc, 2);
+    TEST_ASSERT_TRUE(tb.sendTelemetryJson(doc, Helper::Measure_Json(doc)));
+    TEST_ASSERT_EQUAL(0, client->announced);
+    TEST_ASSERT_EQUAL(1, client->publishes);
+}
+
+static void test_failed_write_stops_the_writer(void)
+{
+    uint8_t buffer[16];
+    client->failAfter = 32;
+    Streaming_Publish_Writer writer(*client, buffer, sizeof(buffer));
+
+    size_t accepted = 0;
+    for (int i = 0; i < 100; i++)
+        accepted += writer.write((uint8_t)'a');
+    uint32_t writes = client->writes;
+
+    // Once a flush failed, single bytes are refused like buffers are
+    TEST_ASSERT_EQUAL(0, writer.write((uint8_t)'b'));
+    TEST_ASSERT_EQUAL(0, writer.write((const uint8_t *)"cd", 2));
+    TEST_ASSERT_FALSE(writer.flush());
+    TEST_ASSERT_EQUAL(writes, client->writes);
+    TEST_ASSERT_LESS_THAN(100, accepted);
+}
+
+static void test_failed_stream_is_reported(void)
+{
+    ThingsBoardSized<32> tb(*client, 64, 4096, 32);
+    StaticJsonDocument<1024> doc;
+    fillTelemetry(doc, 24);
+    client->failAfter = 100;
+    TEST_ASSERT_FALSE(tb.sendTelemetryJson(doc, Helper::Measure_Json(doc)));
+}
+
+// Client writes and time of a 1 KB telemetry publish, serialized token by
+// token into the client as before, and through the write-combining writer
+static void test_benchmark_write_combining(void)
+{
+    StaticJsonDocument<4096> doc;
+    fillTelemetry(doc, 64);
+    const int rounds = 2000;
+    client->keepPayload = false;
+
+    struct Direct
+    {
+        IMQTT_Client &client;
+        size_t write(uint8_t b) { return client.write(b); }
+        size_t write(const uint8_t *b, size_t n) { return client.write(b, n); }
+    } direct{*client};
+
+    auto start = std::chrono::steady_clock::now();
+    client->writes = 0;
+    for (int i = 0; i < rounds; i++)
+    {
+        client->begin_publish("v1/devices/me/telemetry", measureJson(doc));
+        serializeJson(doc, direct);
+        client->end_publish();
+    }
+    double directSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double directWrites = (double)client->writes / rounds;
+
+    ThingsBoardSized<64> tb(*client, 64, 8192, 128);
+    start = std::chrono::steady_clock::now();
+    client->writes = 0;
+    for (int i = 0; i < rounds; i++)
+        TEST_ASSERT_TRUE(tb.sendTelemetryJson(doc, Helper::Measure_Json(doc)));
+    double bufferedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double bufferedWrites = (double)client->writes / rounds;
+
+    char line[200];
+    snprintf(line, sizeof(line), "%u byte payload: %.0f client writes, %.1f us unbuffered; %.0f writes, %.1f us with a 128 byte writer",
+             (unsigned)measureJson(doc), directWrites, directSeconds * 1e6 / rounds, bufferedWrites, bufferedSeconds * 1e6 / rounds);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_LESS_OR_EQUAL((measureJson(doc) + 127) / 128, bufferedWrites);
+    TEST_ASSERT_GREATER_THAN(bufferedWrites * 10, directWrites);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_streamed_publish_announces_the_serialized_length);
+    RUN_TEST(test_small_payloads_are_not_streamed);
+    RUN_TEST(test_failed_write_stops_the_writer);
+    RUN_TEST(test_failed_stream_is_reported);
+    RUN_TEST(test_benchmark_write_combining);
+    return UNITY_END();
+}
@@ -0,0 +1,30 @@
+// Add + cancel cost loop, included next to timer_wheel.cpp by test_main.cpp
+// and by the 10k timer build in wheel_10k_src.cpp.
+#include <chrono>
+#include <random>
+#include <vector>
+
+/**
+ * @brief Fills the pool with random delays and cancels every timer again, `rounds` times.
+ * @return Nanoseconds per add + cancel
+ */
+static double addCancelCost(TimerWheel_t *wheel, int rounds)
+{
+    std::mt19937 random(2);
+    std::vector<TimerWheelHandle_t> handles(TIMER_WHEEL_CAPACITY);
+    timer_wheel_init(wheel, 0);
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; round++)
+    {
+        for (int i = 0; i < TIMER_WHEEL_CAPACITY; i++)
+        {
+            handles[i] = timer_wheel_add(wheel, 1 + random() % 100000, 0, i);
+        }
+        for (int i = 0; i < TIMER_WHEEL_CAPACITY; i++)
+        {
+            timer_wheel_cancel(wheel, handles[i]);
+        }
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+           ((double)rounds * TIMER_WHEEL_CAPACITY);
+}
@@ -0,0 +1,184 @@
+// Timer wheel: every timer fires at its due tick over the full delay range,
+// stale handles, callbacks that cancel or add timers of the same tick, and
+// the cost of an add and a cancel with 1k and 10k timers.
+#include <Arduino.h>
+#include <unity.h>
+
+#include "timer_wheel.cpp"
+#include "add_cancel_cost.h"
+
+#include <chrono>
+#include <map>
+#include <random>
+#include <vector>
+
+static TimerWheel_t wheel;
+static std::vector<std::pair<uint32_t, uint16_t>> fired;
+static TimerWheelHandle_t cancelInCallback;
+static uint16_t addInCallback;
+
+static void record(uint8_t action, uint16_t arg)
+{
+    fired.push_back({wheel.now, arg});
+    if (cancelInCallback != TIMER_WHEEL_INVALID_HANDLE)
+    {
+        TEST_ASSERT_TRUE(timer_wheel_cancel(&wheel, cancelInCallback));
+        cancelInCallback = TIMER_WHEEL_INVALID_HANDLE;
+    }
+    if (addInCallback != 0)
+    {
+        TEST_ASSERT_NOT_EQUAL(TIMER_WHEEL_INVALID_HANDLE, timer_wheel_add(&wheel, 1, action, addInCallback));
+        addInCallback = 0;
+    }
+}
+
+static void runUntilEmpty()
+{
+    while (wheel.active > 0)
+    {
+        timer_wheel_advance(&wheel, wheel.now + timer_wheel_ticks_to_next(&wheel), record);
+    }
+}
+
+void setUp(void)
+{
+    fired.clear();
+    cancelInCallback = TIMER_WHEEL_INVALID_HANDLE;
+    addInCallback = 0;
+}
+
+void tearDown(void)
+{
+}
+
+static void test_timers_fire_at_their_due_tick(void)
+{
+    std::mt19937 random(1);
+    const uint32_t start = 12345;
+    timer_wheel_init(&wheel, start);
+
+    std::map<uint16_t, uint32_t> due;
+    std::vector<TimerWheelHandle_t> handles(TIMER_WHEEL_CAPACITY);
+    for (int i = 0; i < TIMER_WHEEL_CAPACITY; i++)
+    {
+        // Spread over every level of the wheel
+        static const uint32_t spreads[] = {60, 4000, 200000, TIMER_WHEEL_MAX_DELAY};
+        uint32_t delay = 1 + random() % spreads[i % 4];
+        handles[i] = timer_wheel_add(&wheel, delay, 1, i);
+        TEST_ASSERT_NOT_EQUAL(TIMER_WHEEL_INVALID_HANDLE, handles[i]);
+        due[i] = start + delay;
+    }
+    TEST_ASSERT_EQUAL(TIMER_WHEEL_INVALID_HANDLE, timer_wheel_add(&wheel, 1, 1, 0));
+
+    for (int i = 0; i < TIMER_WHEEL_CAPACITY; i += 7)
+    {
+        TEST_ASSERT_TRUE(timer_wheel_cancel(&wheel, handles[i]));
+        due.erase(i);
+    }
+    TEST_ASSERT_FALSE(timer_wheel_cancel(&wheel, handles[0]));
+
+    runUntilEmpty();
+    TEST_ASSERT_EQUAL(due.size(), fired.size());
+    uint32_t last = start;
+    for (const auto &timer : fired)
+    {
+        TEST_ASSERT_EQUAL(due[timer.second], timer.first);
+        TEST_ASSERT_TRUE(timer.first >= last);
+        last = timer.first;
+    }
+}
+
+static void test_stale_handle_cannot_cancel_a_reused_node(void)
+{
+    timer_wheel_init(&wheel, 0);
+    TimerWheelHandle_t first = timer_wheel_add(&wheel, 10, 0, 1);
+    TEST_ASSERT_TRUE(timer_wheel_cancel(&wheel, first));
+    TimerWheelHandle_t second = timer_wheel_add(&wheel, 10, 0, 2);
+    TEST_ASSERT_EQUAL(handleIndex(first), handleIndex(second));
+
+    TEST_ASSERT_FALSE(timer_wheel_cancel(&wheel, first));
+    runUntilEmpty();
+    TEST_ASSERT_EQUAL(1, fired.size());
+    TEST_ASSERT_EQUAL(2, fired[0].second);
+}
+
+static void test_callback_cancels_a_timer_of_the_same_tick(void)
+{
+    timer_wheel_init(&wheel, 0);
+    // Slot lists are LIFO, so 3 fires first and 2 would be its next node
+    timer_wheel_add(&wheel, 5, 0, 1);
+    TimerWheelHandle_t second = timer_wheel_add(&wheel, 5, 0, 2);
+    timer_wheel_add(&wheel, 5, 0, 3);
+    cancelInCallback = second;
+
+    TEST_ASSERT_EQUAL(2, timer_wheel_advance(&wheel, 5, record));
+    TEST_ASSERT_EQUAL(2, fired.size());
+    TEST_ASSERT_EQUAL(3, fired[0].second);
+    TEST_ASSERT_EQUAL(1, fired[1].second);
+    TEST_ASSERT_EQUAL(0, wheel.active);
+
+    // The pool is intact: every node can be taken again
+    for (int i = 0; i < TIMER_WHEEL_CAPACITY; i++)
+    {
+        TEST_ASSERT_NOT_EQUAL(TIMER_WHEEL_INVALID_HANDLE, timer_wheel_add(&wheel, 1 + i, 0, i));
+    }
+}
+
+static void test_callback_adds_a_timer(void)
+{
+    timer_wheel_init(&wheel, 0);
+    timer_wheel_add(&wheel, 3, 0, 1);
+    addInCallback = 2;
+    runUntilEmpty();
+    TEST_ASSERT_EQUAL(2, fired.size());
+    TEST_ASSERT_EQUAL(3, fired[0].first);
+    TEST_ASSERT_EQUAL(4, fired[1].first);
+    TEST_ASSERT_EQUAL(2, fired[1].second);
+}
+
+static void test_wheel_size(void)
+{
+    // Stated in timer_wheel.h: about 12.8 KB for 1024 timers
+    TEST_ASSERT_EQUAL(12, sizeof(TimerNode_t));
+    TEST_ASSERT_TRUE(sizeof(TimerWheel_t) < 13 * 1024);
+}
+
+// Built with TIMER_WHEEL_CAPACITY 10000 in wheel_10k_src.cpp
+double wheel10kAddCancelCost(int rounds, uint32_t *active, size_t *bytes);
+
+// O(1) add and cancel: the cost per timer stays flat from 1k to 10k timers
+static void test_add_cancel_cost(void)
+{
+    // Same number of operations for both pools, best of three against scheduling noise
+    double ns1k = 1e9, ns10k = 1e9;
+    uint32_t active10k;
+    size_t bytes10k;
+    for (int run = 0; run < 3; run++)
+    {
+        ns1k = std::min(ns1k, addCancelCost(&wheel, 10000000 / TIMER_WHEEL_CAPACITY / 3));
+        TEST_ASSERT_EQUAL(0, wheel.active);
+        ns10k = std::min(ns10k, wheel10kAddCancelCost(1000 / 3, &active10k, &bytes10k));
+        TEST_ASSERT_EQUAL(0, active10k);
+    }
+
+    char line[120];
+    snprintf(line, sizeof(line), "add + cancel, %u timers: %.1f ns per timer, %u bytes per wheel",
+             (unsigned)TIMER_WHEEL_CAPACITY, ns1k, (unsigned)sizeof(wheel));
+    TEST_MESSAGE(line);
+    snprintf(line, sizeof(line), "add + cancel, 10000 timers: %.1f ns per timer, %u bytes per wheel", ns10k, (unsigned)bytes10k);
+    TEST_MESSAGE(line);
+    // Slot lists and the node pool are out of L1 at 10k, anything close to 10x would be a scan
+    TEST_ASSERT_TRUE(ns10k < 2.5 * ns1k);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_timers_fire_at_their_due_tick);
+    RUN_TEST(test_stale_handle_cannot_cancel_a_reused_node);
+    RUN_TEST(test_callback_cancels_a_timer_of_the_same_tick);
+    RUN_TEST(test_callback_adds_a_timer);
+    RUN_TEST(test_wheel_size);
+    RUN_TEST(test_add_cancel_cost);
+    return UNITY_END();
+}
@@ -0,0 +1,25 @@
+// The wheel built again with a 10k timer pool, as its own translation unit
+// and namespace so both pool sizes run in one suite.
+#include <Arduino.h>
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+#define TIMER_WHEEL_CAPACITY 10000
+
+namespace wheel10k
+{
+#include "timer_wheel.cpp"
+#include "add_cancel_cost.h"
+
+static TimerWheel_t wheel;
+}
+
+double wheel10kAddCancelCost(int rounds, uint32_t *active, size_t *bytes)
+{
+    double ns = wheel10k::addCancelCost(&wheel10k::wheel, rounds);
+    *active = wheel10k::wheel.active;
+    *bytes = sizeof(wheel10k::wheel);
+    return ns;
+}
@@ -0,0 +1,334 @@
+// MQTT over WebSocket through WebSocketStreamClient, against an in-process
+// WebSocket server stand-in, and the send throughput of the uplink.
+#include <Arduino.h>
+#include <unity.h>
+#include <ArduinoHttpClient.h>
+#include <PubSubClient.h>
+
+#include <deque>
+#include <vector>
+
+// Server side of the socket: answers the upgrade, unmasks and checks every
+// frame the client sends, and feeds the client the frames a test queued,
+// at most trickle bytes per available() when set
+class WebSocketServerStandIn : public Client
+{
+public:
+    std::string request;
+    bool upgraded = false;
+    bool open = true;
+    std::vector<uint8_t> stream;        // unmasked payload of the data frames received
+    std::vector<uint8_t> pongs;         // payload of the pongs received
+    uint32_t frames = 0;
+    uint32_t socketWrites = 0;
+    bool badFrame = false;
+    bool closeReceived = false;
+    std::deque<uint8_t> inbound;
+    size_t trickle = 0;
+    bool keepStream = true;
+
+    void queueFrame(uint8_t opcode, const std::vector<uint8_t> &payload, bool fin = true)
+    {
+        inbound.push_back((fin ? 0x80 : 0x00) | opcode);
+        if (payload.size() < 126)
+        {
+            inbound.push_back(payload.size());
+        }
+        else
+        {
+            inbound.push_back(126);
+            inbound.push_back(payload.size() >> 8);
+            inbound.push_back(payload.size() & 0xff);
+        }
+        inbound.insert(inbound.end(), payload.begin(), payload.end());
+    }
+
+    int connect(IPAddress, uint16_t) override { open = true; return 1; }
+    int connect(const char *, uint16_t) override { open = true; return 1; }
+    size_t write(uint8_t b) override { return write(&b, 1); }
+    size_t write(const uint8_t *buf, size_t size) override
+    {
+        if (!open)
+            return 0;
+        socketWrites++;
+        if (!upgraded)
+        {
+            request.append((const char *)buf, size);
+            if (request.find("\r\n\r\n") != std::string::npos)
+            {
+                upgraded = true;
+                const char *response = "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                                       "Sec-WebSocket-Protocol: mqtt\r\n\r\n";
+                inbound.insert(inbound.end(), response, response + strlen(response));
+            }
+            return size;
+        }
+        pending.insert(pending.end(), buf, buf + size);
+        decode();
+        return size;
+    }
+    int available() override
+    {
+        size_t n = inbound.size();
+        return (int)(trickle > 0 && n > trickle ? trickle : n);
+    }
+    int read() override
+    {
+        if (available() == 0)
+            return -1;
+        int c = inbound.front();
+        inbound.pop_front();
+        return c;
+    }
+    int read(uint8_t *buf, size_t size) override
+    {
+        size_t n = std::min(size, (size_t)available());
+        for (size_t i = 0; i < n; i++)
+        {
+            buf[i] = inbound.front();
+            inbound.pop_front();
+        }
+        return n;
+    }
+    int peek() override { return available() ? inbound.front() : -1; }
+    void flush() override {}
+    void stop() override { open = false; }
+    uint8_t connected() override { return open; }
+    operator bool() override { return open; }
+
+private:
+    std::vector<uint8_t> pending;
+
+    void decode()
+    {
+        for (;;)
+        {
+            if (pending.size() < 2)
+                return;
+            uint8_t opcode = pending[0] & 0x0f;
+            bool masked = pending[1] & 0x80;
+            size_t length = pending[1] & 0x7f;
+            size_t pos = 2;
+            if (length == 126)
+            {
+                if (pending.size() < 4)
+                    return;
+                length = (pending[2] << 8) | pending[3];
+                pos = 4;
+            }
+            else if (length == 127)
+            {
+                badFrame = true;
+                return;
+            }
+            if (pending.size() < pos + 4 + length)
+                return;
+            // Client frames are always masked and final
+            if (!masked || !(pending[0] & 0x80))
+                badFrame = true;
+            const uint8_t *key = &pending[pos];
+            pos += 4;
+            std::vector<uint8_t> payload(length);
+            for (size_t i = 0; i < length; i++)
+                payload[i] = pending[pos + i] ^ key[i & 3];
+            pending.erase(pending.begin(), pending.begin() + pos + length);
+            frames++;
+            if (opcode == TYPE_BINARY)
+            {
+                if (keepStream)
+                    stream.insert(stream.end(), payload.begin(), payload.end());
+            }
+            else if (opcode == TYPE_PONG)
+                pongs = payload;
+            else if (opcode == TYPE_CONNECTION_CLOSE)
+                closeReceived = true;
+            else
+                badFrame = true;
+        }
+    }
+};
+
+static WebSocketServerStandIn *server;
+static WebSocketStreamClient *ws;
+
+void setUp(void)
+{
+    server = new WebSocketServerStandIn;
+    ws = new WebSocketStreamClient(*server, "/mqtt", "mqtt");
+}
+
+void tearDown(void)
+{
+    delete ws;
+    delete server;
+}
+
+static std::vector<uint8_t> readAll(Client &client)
+{
+    std::vector<uint8_t> bytes;
+    for (int spins = 0; spins < 10000; spins++)
+    {
+        int c = client.read();
+        if (c >= 0)
+            bytes.push_back(c);
+    }
+    return bytes;
+}
+
+static void test_upgrade_asks_for_the_mqtt_subprotocol(void)
+{
+    TEST_ASSERT_EQUAL(1, ws->connect("broker.local", 8083));
+    TEST_ASSERT_TRUE(server->request.find("GET /mqtt HTTP/1.1") != std::string::npos);
+    TEST_ASSERT_TRUE(server->request.find("Host: broker.local:8083") != std::string::npos);
+    TEST_ASSERT_TRUE(server->request.find("Upgrade: websocket") != std::string::npos);
+    TEST_ASSERT_TRUE(server->request.find("Sec-WebSocket-Protocol: mqtt") != std::string::npos);
+    TEST_ASSERT_TRUE(ws->connected());
+}
+
+static void test_every_write_is_one_masked_binary_frame(void)
+{
+    ws->upgrade("broker.local", 80);
+    uint32_t writes = server->socketWrites;
+
+    const uint8_t packet[] = {0x30, 0x05, 0x00, 0x01, 't', 'h', 'i'};
+    TEST_ASSERT_EQUAL(sizeof(packet), ws->write(packet, sizeof(packet)));
+    TEST_ASSERT_EQUAL(1, server->frames);
+    TEST_ASSERT_EQUAL(writes + 1, server->socketWrites);
+    TEST_ASSERT_FALSE(server->badFrame);
+    TEST_ASSERT_EQUAL(sizeof(packet), server->stream.size());
+    TEST_ASSERT_EQUAL_MEMORY(packet, server->stream.data(), sizeof(packet));
+}
+
+static void test_big_writes_are_split_into_frames(void)
+{
+    ws->upgrade("broker.local", 80);
+    std::vector<uint8_t> data(5000);
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = i * 7;
+
+    TEST_ASSERT_EQUAL(data.size(), ws->write(data.data(), data.size()));
+    TEST_ASSERT_EQUAL((data.size() + WS_STREAM_FRAME_SIZE - 1) / WS_STREAM_FRAME_SIZE, server->frames);
+    TEST_ASSERT_FALSE(server->badFrame);
+    TEST_ASSERT_TRUE(server->stream == data);
+}
+
+static void test_server_frames_are_read_as_one_stream(void)
+{
+    ws->upgrade("broker.local", 80);
+    // One MQTT packet split over a fragmented message, a ping in between
+    server->queueFrame(TYPE_BINARY, {0x30, 0x06, 0x00, 0x01}, false);
+    server->queueFrame(TYPE_PING, {'h', 'i'});
+    server->queueFrame(TYPE_CONTINUATION, {'t', 'a', 'b'}, true);
+    server->queueFrame(TYPE_BINARY, {'c'});
+    // Headers and payloads arrive a byte at a time
+    server->trickle = 1;
+
+    std::vector<uint8_t> expected = {0x30, 0x06, 0x00, 0x01, 't', 'a', 'b', 'c'};
+    TEST_ASSERT_TRUE(readAll(*ws) == expected);
+    TEST_ASSERT_EQUAL(2, server->pongs.size());
+    TEST_ASSERT_EQUAL('h', server->pongs[0]);
+    TEST_ASSERT_TRUE(ws->connected());
+}
+
+static void test_available_counts_only_payload(void)
+{
+    ws->upgrade("broker.local", 80);
+    server->queueFrame(TYPE_BINARY, {1, 2, 3});
+    server->queueFrame(TYPE_BINARY, {4, 5});
+    TEST_ASSERT_EQUAL(3, ws->available());
+    TEST_ASSERT_EQUAL(1, ws->peek());
+    uint8_t buf[8];
+    TEST_ASSERT_EQUAL(3, ws->read(buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL(2, ws->available());
+    TEST_ASSERT_EQUAL(2, ws->read(buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL(0, ws->available());
+    TEST_ASSERT_EQUAL(-1, ws->read());
+}
+
+static void test_close_frame_ends_the_connection(void)
+{
+    ws->upgrade("broker.local", 80);
+    server->queueFrame(TYPE_CONNECTION_CLOSE, {0x03, 0xe8});
+    TEST_ASSERT_EQUAL(0, ws->available());
+    TEST_ASSERT_TRUE(server->closeReceived);
+    TEST_ASSERT_FALSE(ws->connected());
+    TEST_ASSERT_EQUAL(0, ws->write((const uint8_t *)"x", 1));
+}
+
+static void test_pubsubclient_connects_and_publishes_over_websocket(void)
+{
+    PubSubClient mqtt(*ws);
+    mqtt.setServer("broker.local", 8083);
+    ws->upgrade("broker.local", 8083);
+    // CONNACK, accepted
+    server->queueFrame(TYPE_BINARY, {0x20, 0x02, 0x00, 0x00});
+    TEST_ASSERT_TRUE(mqtt.connect("device"));
+    TEST_ASSERT_EQUAL(0x10, server->stream[0]);     // CONNECT
+
+    server->stream.clear();
+    TEST_ASSERT_TRUE(mqtt.publish("v1/devices/me/telemetry", "{\"temperature\":21.5}"));
+    const char *topic = "v1/devices/me/telemetry";
+    TEST_ASSERT_EQUAL(0x30, server->stream[0]);
+    TEST_ASSERT_EQUAL(strlen(topic), server->stream[3]);
+    TEST_ASSERT_EQUAL_MEMORY(topic, &server->stream[4], strlen(topic));
+    TEST_ASSERT_FALSE(server->badFrame);
+
+    // An inbound PUBLISH, split over two frames, reaches the callback
+    static std::string received;
+    received.clear();
+    mqtt.setCallback([](char *t, uint8_t *payload, unsigned int length) { received.assign((const char *)payload, length); });
+    server->queueFrame(TYPE_BINARY, {0x30, 0x07, 0x00, 0x01, 'r'});
+    server->queueFrame(TYPE_BINARY, {'o', 'k', '!', '!'});
+    for (int i = 0; i < 10 && received.empty(); i++)
+        mqtt.loop();
+    TEST_ASSERT_EQUAL_STRING("ok!!", received.c_str());
+}
+
+// Send throughput of the uplink: 1 KB telemetry publishes through PubSubClient,
+// framed, masked and written to the stand-in, which unmasks them again
+static void test_send_throughput(void)
+{
+    PubSubClient mqtt(*ws);
+    mqtt.setBufferSize(2048);
+    ws->upgrade("broker.local", 80);
+    server->queueFrame(TYPE_BINARY, {0x20, 0x02, 0x00, 0x00});
+    TEST_ASSERT_TRUE(mqtt.connect("device"));
+    server->keepStream = false;
+
+    std::string payload(1024, 'x');
+    const int publishes = 20000;
+    uint32_t frames = server->frames;
+    uint32_t writes = server->socketWrites;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < publishes; i++)
+    {
+        mqtt.beginPublish("v1/devices/me/telemetry", payload.size(), false);
+        mqtt.write((const uint8_t *)payload.data(), payload.size());
+        TEST_ASSERT_TRUE(mqtt.endPublish());
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double megabytes = publishes * (payload.size() + 28) / 1e6;
+
+    char line[160];
+    snprintf(line, sizeof(line), "send: %.1f MB/s, %.2f frames and %.2f socket writes per publish",
+             megabytes / seconds, (double)(server->frames - frames) / publishes,
+             (double)(server->socketWrites - writes) / publishes);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_FALSE(server->badFrame);
+    // Header, topic and payload of a publish share a frame and a socket write
+    TEST_ASSERT_EQUAL(publishes, server->socketWrites - writes);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_upgrade_asks_for_the_mqtt_subprotocol);
+    RUN_TEST(test_every_write_is_one_masked_binary_frame);
+    RUN_TEST(test_big_writes_are_split_into_frames);
+    RUN_TEST(test_server_frames_are_read_as_one_stream);
+    RUN_TEST(test_available_counts_only_payload);
+    RUN_TEST(test_close_frame_ends_the_connection);
+    RUN_TEST(test_pubsubclient_connects_and_publishes_over_websocket);
+    RUN_TEST(test_send_throughput);
+    return UNITY_END();
+}
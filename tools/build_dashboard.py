@@ -0,0 +1,125 @@
+# Builds the dashboard into a single gzipped bundle that is served from flash.
+#
+# data/index.html is taken as the entry point, every local stylesheet and
+# script it references is inlined, the result is minified and gzipped and
+# written as a PROGMEM byte array, the same way ElegantOTA embeds ELEGANT_HTML:
+#
+#   include/dashboard_bundle.h   -> extern const uint8_t DASHBOARD_HTML[...]
+#   src/dashboard_bundle.cpp     -> the gzipped bytes
+#
+# The header and the source carry a hash of the bundled, not yet gzipped, page.
+# They are rewritten when it no longer matches, so an edit in data/ or in the
+# minifiers is picked up whatever the file times say (a checkout, a copy).
+#
+# Runs automatically before every build through platformio.ini:
+#
+#   extra_scripts = pre:tools/build_dashboard.py
+#
+# and can also be run by hand: python tools/build_dashboard.py
+
+import gzip
+import hashlib
+import os
+import re
+import sys
+
+try:
+    Import("env")  # noqa: F821 - provided by PlatformIO
+    PROJECT_DIR = env.subst("$PROJECT_DIR")  # noqa: F821
+except NameError:
+    PROJECT_DIR = os.path.dirname(os.path.dirname(os.path.abspath(sys.argv[0])))
+
+DATA_DIR = os.path.join(PROJECT_DIR, "data")
+ENTRY = os.path.join(DATA_DIR, "index.html")
+HEADER = os.path.join(PROJECT_DIR, "include", "dashboard_bundle.h")
+SOURCE = os.path.join(PROJECT_DIR, "src", "dashboard_bundle.cpp")
+
+LINK_RE = re.compile(r'<link\s+rel="stylesheet"\s+href="([^":]+)"\s*/?>')
+SCRIPT_RE = re.compile(r'<script\s+src="([^":]+)"\s*>\s*</script>')
+HASH_RE = re.compile(r"^// Bundle sha256: ([0-9a-f]{64})$", re.M)
+
+
+def read(name):
+    with open(os.path.join(DATA_DIR, name), encoding="utf-8") as f:
+        return f.read()
+
+
+def minify_css(css):
+    css = re.sub(r"/\*.*?\*/", "", css, flags=re.S)
+    css = re.sub(r"\s+", " ", css)
+    css = re.sub(r"\s*([{};,:])\s*", r"\1", css)
+    return css.replace(";}", "}").strip()
+
+
+def minify_js(js):
+    # Only whitespace and whole line comments are removed, line breaks are
+    # kept so automatic semicolon insertion still behaves the same
+    lines = []
+    for line in js.splitlines():
+        line = line.strip()
+        if line and not line.startswith("//"):
+            lines.append(line)
+    return "\n".join(lines)
+
+
+def minify_html(html):
+    html = re.sub(r"<!--.*?-->", "", html, flags=re.S)
+    html = re.sub(r">\s+<", "><", html)
+    return re.sub(r"\s+", " ", html).strip()
+
+
+def bundle():
+    html = minify_html(read("index.html"))
+    html = LINK_RE.sub(lambda m: "<style>" + minify_css(read(m.group(1))) + "</style>", html)
+    html = SCRIPT_RE.sub(lambda m: "<script>" + minify_js(read(m.group(1))) + "</script>", html)
+    return html.encode("utf-8")
+
+
+def sources():
+    html = read("index.html")
+    names = LINK_RE.findall(html) + SCRIPT_RE.findall(html)
+    return [ENTRY] + [os.path.join(DATA_DIR, name) for name in names]
+
+
+def built_hash(path):
+    if not os.path.exists(path):
+        return None
+    with open(path, encoding="utf-8") as f:
+        match = HASH_RE.search(f.read())
+    return match.group(1) if match else None
+
+
+def up_to_date(digest):
+    return built_hash(HEADER) == digest and built_hash(SOURCE) == digest
+
+
+def write_bundle(html, digest):
+    raw = sum(os.path.getsize(path) for path in sources())
+    data = gzip.compress(html, compresslevel=9, mtime=0)
+
+    with open(HEADER, "w", newline="\n") as f:
+        f.write("#ifndef __DASHBOARD_BUNDLE_H__\n")
+        f.write("#define __DASHBOARD_BUNDLE_H__\n\n")
+        f.write("#include <Arduino.h>\n\n")
+        f.write("// Generated by tools/build_dashboard.py from data/, do not edit.\n")
+        f.write("// Gzipped, single file dashboard, serve with Content-Encoding: gzip.\n")
+        f.write("// Bundle sha256: %s\n" % digest)
+        f.write("extern const uint8_t DASHBOARD_HTML[%d];\n\n" % len(data))
+        f.write("#endif\n")
+
+    with open(SOURCE, "w", newline="\n") as f:
+        f.write('#include "dashboard_bundle.h"\n\n')
+        f.write("// Bundle sha256: %s\n" % digest)
+        f.write("const uint8_t DASHBOARD_HTML[%d] PROGMEM = {\n" % len(data))
+        for i in range(0, len(data), 30):
+            f.write(",".join(str(b) for b in data[i:i + 30]))
+            f.write(",\n" if i + 30 < len(data) else "\n")
+        f.write("};\n")
+
+    print("Dashboard bundle: %d source bytes -> %d gzipped bytes" % (raw, len(data)))
+
+
+html = bundle()
+digest = hashlib.sha256(html).hexdigest()
+if not up_to_date(digest):
+    write_bundle(html, digest)
@@ -0,0 +1,95 @@
+# Decodes a pre-trigger capture, see include/capture.h for the format.
+#
+# Takes the file written to LittleFS (/capture/<id>.bin) or the base64 string
+# of the "capture" telemetry key and prints one CSV line per sample:
+#
+#   python tools/decode_capture.py capture.bin
+#   python tools/decode_capture.py --base64 "AQH..."
+#
+# The offset is in seconds relative to the trigger, failed reads are empty.
+
+import argparse
+import base64
+import struct
+import sys
+
+HEADER = struct.Struct("<BBHIHHf")
+FORMAT = 1
+MISSING = -32768
+TIME_UPTIME = 0x80000000
+REASONS = {1: "ANOMALY", 2: "WARNING", 3: "CRITICAL"}
+
+
+def read_varint(data, pos):
+    value = 0
+    shift = 0
+    while True:
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            return value, pos
+
+
+def unzigzag(value):
+    return (value >> 1) ^ -(value & 1)
+
+
+def decode(data):
+    fmt, reason, period_ms, time, pre, count, value = HEADER.unpack_from(data)
+    if fmt != FORMAT:
+        raise ValueError("unknown capture format %d" % fmt)
+
+    header = {
+        "reason": REASONS.get(reason, "UNKNOWN"),
+        "period_ms": period_ms,
+        "uptime": bool(time & TIME_UPTIME),
+        "time": time & ~TIME_UPTIME,
+        "pre_samples": pre,
+        "samples": count,
+        "value": value,
+    }
+    samples = []
+    pos = HEADER.size
+    temperature = humidity = 0
+    for _ in range(count):
+        delta, pos = read_varint(data, pos)
+        temperature += unzigzag(delta)
+        delta, pos = read_varint(data, pos)
+        humidity += unzigzag(delta)
+        if temperature == MISSING:
+            samples.append((None, None))
+        else:
+            samples.append((temperature / 100.0, humidity / 100.0))
+    return header, samples
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decodes a pre-trigger capture")
+    parser.add_argument("capture", help="capture file, or the base64 string with --base64")
+    parser.add_argument("--base64", action="store_true", help="the argument is the telemetry value")
+    args = parser.parse_args()
+
+    if args.base64:
+        data = base64.b64decode(args.capture)
+    else:
+        with open(args.capture, "rb") as f:
+            data = f.read()
+
+    header, samples = decode(data)
+    clock = "uptime" if header["uptime"] else "unix"
+    print("# %s at %s %d, value %.4f, %d samples every %d ms, %d before the trigger"
+          % (header["reason"], clock, header["time"], header["value"], header["samples"],
+             header["period_ms"], header["pre_samples"]))
+    print("offset_s,temperature,humidity")
+    for i, (temperature, humidity) in enumerate(samples):
+        offset = (i - header["pre_samples"]) * header["period_ms"] / 1000.0
+        if temperature is None:
+            print("%.2f,," % offset)
+        else:
+            print("%.2f,%.2f,%.2f" % (offset, temperature, humidity))
+
+
+if __name__ == "__main__":
+    sys.exit(main())
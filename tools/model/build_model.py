@@ -0,0 +1,150 @@
+# Builds the DHT anomaly model in float and full-integer int8 variants.
+#
+# The model maps (temperature, humidity) to an anomaly score in [0, 1]. It is
+# trained on recorded sensor traces, a CSV file with the columns
+#
+#   temperature,humidity,label
+#
+# where label is 1 for anomalous samples and 0 otherwise (extra columns such
+# as a timestamp are ignored). The int8 variant is calibrated with a
+# representative dataset drawn from the same traces, so input, output and all
+# weights / activations are int8 and only integer kernels run on the device.
+#
+# Outputs, written next to the traces (or into --out) so the committed model
+# is never replaced by accident:
+#
+#   dht_anomaly_model.tflite / .h        (float)
+#   dht_anomaly_model_int8.tflite / .h   (int8)
+#
+# With --batch N two more variants with a fixed [N, 2] input are written,
+# which let the history backfill score N samples per Invoke:
+#
+#   dht_anomaly_model_batch.tflite / .h
+#   dht_anomaly_model_batch_int8.tflite / .h
+#
+# Compare them with evaluate_model.py. The firmware runs whatever model
+# include/dht_anomaly_model.h holds; the interpreter takes float or int8
+# tensors and any batch size. --install VARIANT writes that variant there as
+# dht_anomaly_model_tflite, e.g. --install int8 once it evaluated well.
+#
+#   pip install tensorflow numpy
+#   python tools/model/build_model.py traces.csv
+#
+# Pass --keras model.keras to convert an already trained model instead of
+# training a new one.
+
+import argparse
+import os
+import sys
+
+import numpy as np
+import tensorflow as tf
+
+from model_header import write_header
+
+PROJECT_DIR = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+
+def load_traces(path):
+    data = np.genfromtxt(path, delimiter=",", names=True, dtype=np.float32)
+    x = np.stack([data["temperature"], data["humidity"]], axis=1)
+    y = data["label"].astype(np.float32) if "label" in data.dtype.names else None
+    return x, y
+
+
+def train(x, y, epochs):
+    norm = tf.keras.layers.Normalization(input_shape=(2,))
+    norm.adapt(x)
+    model = tf.keras.Sequential([
+        norm,
+        tf.keras.layers.Dense(8, activation="relu"),
+        tf.keras.layers.Dense(8, activation="relu"),
+        tf.keras.layers.Dense(1, activation="sigmoid"),
+    ])
+    model.compile(optimizer="adam", loss="binary_crossentropy", metrics=["accuracy"])
+    model.fit(x, y, epochs=epochs, batch_size=32, validation_split=0.2, verbose=2)
+    return model
+
+
+def make_converter(model, batch):
+    if batch is None:
+        return tf.lite.TFLiteConverter.from_keras_model(model)
+    # Fixes the batch dimension, TFLM can not resize input tensors at runtime
+    function = tf.function(lambda x: model(x)).get_concrete_function(
+        tf.TensorSpec([batch, 2], tf.float32))
+    return tf.lite.TFLiteConverter.from_concrete_functions([function], model)
+
+
+def convert_float(model, batch=None):
+    converter = make_converter(model, batch)
+    return converter.convert()
+
+
+def convert_int8(model, x, samples, batch=None):
+    def representative_dataset():
+        idx = np.random.default_rng(0).permutation(len(x))[:samples]
+        for i in idx:
+            yield [np.resize(x[i:i + (batch or 1)], (batch or 1, 2))]
+
+    converter = make_converter(model, batch)
+    converter.optimizations = [tf.lite.Optimize.DEFAULT]
+    converter.representative_dataset = representative_dataset
+    converter.target_spec.supported_ops = [tf.lite.OpsSet.TFLITE_BUILTINS_INT8]
+    converter.inference_input_type = tf.int8
+    converter.inference_output_type = tf.int8
+    return converter.convert()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Builds the DHT anomaly model in float and int8 variants")
+    parser.add_argument("traces", help="CSV with temperature,humidity,label columns")
+    parser.add_argument("--keras", help="convert this trained model instead of training")
+    parser.add_argument("--epochs", type=int, default=50)
+    parser.add_argument("--calibration-samples", type=int, default=500)
+    parser.add_argument("--batch", type=int, help="also write fixed-batch variants for the backfill")
+    parser.add_argument("--out", help="directory for the variants, default next to the traces")
+    parser.add_argument("--install", choices=["float", "int8", "batch", "batch_int8"],
+                        help="also write this variant as include/dht_anomaly_model.h")
+    args = parser.parse_args()
+
+    x, y = load_traces(args.traces)
+    if args.keras:
+        model = tf.keras.models.load_model(args.keras)
+    elif y is None:
+        sys.exit("traces need a label column to train a model")
+    else:
+        model = train(x, y, args.epochs)
+
+    variants = [
+        ("dht_anomaly_model", convert_float(model), "Float32 DHT anomaly model."),
+        ("dht_anomaly_model_int8", convert_int8(model, x, args.calibration_samples),
+         "Full-integer int8 DHT anomaly model, calibrated on %s." % os.path.basename(args.traces)),
+    ]
+    if args.batch:
+        variants += [
+            ("dht_anomaly_model_batch", convert_float(model, args.batch),
+             "Float32 DHT anomaly model, batch of %d." % args.batch),
+            ("dht_anomaly_model_batch_int8", convert_int8(model, x, args.calibration_samples, args.batch),
+             "Full-integer int8 DHT anomaly model, batch of %d, calibrated on %s." % (
+                 args.batch, os.path.basename(args.traces))),
+        ]
+    out = args.out or os.path.dirname(os.path.abspath(args.traces))
+    for name, data, comment in variants:
+        with open(os.path.join(out, name + ".tflite"), "wb") as f:
+            f.write(data)
+        write_header(os.path.join(out, name + ".h"), name + "_tflite", data, comment)
+        print("%s: %d bytes" % (name, len(data)))
+
+    if args.install:
+        name = "dht_anomaly_model" + ("" if args.install == "float" else "_" + args.install)
+        installed = [v for v in variants if v[0] == name]
+        if not installed:
+            sys.exit("--install %s needs --batch" % args.install)
+        _, data, comment = installed[0]
+        write_header(os.path.join(PROJECT_DIR, "include", "dht_anomaly_model.h"), "dht_anomaly_model_tflite", data,
+                     comment)
+        print("installed %s as include/dht_anomaly_model.h" % name)
+
+
+if __name__ == "__main__":
+    main()
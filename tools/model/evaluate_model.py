@@ -0,0 +1,97 @@
+# Compares model variants on recorded sensor traces.
+#
+# Every model is run over the same traces (CSV with temperature,humidity and
+# optionally label columns, see build_model.py) with the TFLite interpreter,
+# quantising inputs and dequantising outputs from the tensor parameters the
+# same way src/tinyml.cpp does. The report lists per model:
+#
+#   size       flatbuffer size in bytes (flash)
+#   arena      bytes of the input and all op outputs, a lower bound for the
+#              TFLM tensor arena (the device prints the exact arena_used_bytes())
+#   latency    mean / p95 host invoke time, only useful relative to each other
+#   samples/s  host throughput, batch models score several samples per invoke
+#   accuracy   against the labels, with the anomaly score thresholded
+#   agreement  share of samples classified the same as the first model
+#   max err    largest absolute score difference to the first model
+#
+# Models can be .tflite files or the generated headers:
+#
+#   python tools/model/evaluate_model.py traces.csv \
+#       dht_anomaly_model.h dht_anomaly_model_int8.h
+
+import argparse
+import time
+
+import numpy as np
+import tensorflow as tf
+
+from build_model import load_traces
+from model_header import read_model
+
+
+def run(model_data, x):
+    interpreter = tf.lite.Interpreter(model_content=model_data)
+    interpreter.allocate_tensors()
+    inp = interpreter.get_input_details()[0]
+    out = interpreter.get_output_details()[0]
+
+    # Activations are the model input plus every op output, the weights stay in flash
+    details = {tensor["index"]: tensor for tensor in interpreter.get_tensor_details()}
+    activations = {inp["index"]}
+    for op in interpreter._get_ops_details():
+        activations.update(op["outputs"])
+    arena = sum(int(np.prod(details[i]["shape"])) * np.dtype(details[i]["dtype"]).itemsize
+                for i in activations if i in details)
+
+    # Batch models take [N, 2], the last batch is padded like the backfill does
+    batch = int(inp["shape"][0]) if len(inp["shape"]) > 1 else 1
+    scores = np.empty(len(x), dtype=np.float32)
+    times = np.empty((len(x) + batch - 1) // batch, dtype=np.float64)
+    in_scale, in_zero = inp["quantization"]
+    out_scale, out_zero = out["quantization"]
+    for n, first in enumerate(range(0, len(x), batch)):
+        chunk = x[first:first + batch]
+        value = np.concatenate([chunk, np.repeat(chunk[-1:], batch - len(chunk), axis=0)])
+        value = value.reshape(inp["shape"])
+        if inp["dtype"] != np.float32:
+            info = np.iinfo(inp["dtype"])
+            value = np.clip(np.round(value / in_scale) + in_zero, info.min, info.max)
+        interpreter.set_tensor(inp["index"], value.astype(inp["dtype"]))
+        start = time.perf_counter()
+        interpreter.invoke()
+        times[n] = time.perf_counter() - start
+        result = interpreter.get_tensor(out["index"]).astype(np.float32).flatten()[:len(chunk)]
+        if out["dtype"] != np.float32:
+            result = (result - out_zero) * out_scale
+        scores[first:first + len(chunk)] = result
+    return scores, times, arena, np.dtype(inp["dtype"]).name, batch
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compares model variants on recorded sensor traces")
+    parser.add_argument("traces")
+    parser.add_argument("models", nargs="+", help=".tflite or generated .h files")
+    parser.add_argument("--threshold", type=float, default=0.5)
+    args = parser.parse_args()
+
+    x, y = load_traces(args.traces)
+    reference = None
+    print("%-40s %6s %5s %8s %7s %10s %10s %10s %9s %10s %8s" % (
+        "model", "input", "batch", "size", "arena", "mean us", "p95 us", "samples/s", "accuracy", "agreement",
+        "max err"))
+    for path in args.models:
+        data = read_model(path)
+        scores, times, arena, dtype, batch = run(data, x)
+        predicted = scores >= args.threshold
+        accuracy = "%.2f%%" % (100 * np.mean(predicted == (y >= 0.5))) if y is not None else "-"
+        if reference is None:
+            reference = scores
+        agreement = 100 * np.mean(predicted == (reference >= args.threshold))
+        max_err = np.max(np.abs(scores - reference))
+        print("%-40s %6s %5d %8d %7d %10.1f %10.1f %10.0f %9s %9.2f%% %8.4f" % (
+            path, dtype, batch, len(data), arena, 1e6 * np.mean(times), 1e6 * np.percentile(times, 95),
+            len(x) / np.sum(times), accuracy, agreement, max_err))
+
+
+if __name__ == "__main__":
+    main()
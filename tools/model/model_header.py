@@ -0,0 +1,39 @@
+# Reads and writes TFLite flatbuffers embedded as C arrays, in the format of
+# include/dht_anomaly_model.h.
+
+import re
+
+HEX_RE = re.compile(r"0x([0-9a-fA-F]{2})")
+
+
+def read_header(path):
+    """Returns the bytes of the first array in a generated model header."""
+    with open(path, encoding="utf-8") as f:
+        text = f.read()
+    start = text.index("{")
+    end = text.index("}", start)
+    return bytes(int(h, 16) for h in HEX_RE.findall(text[start:end]))
+
+
+def read_model(path):
+    """Accepts either a .tflite file or a generated .h header."""
+    if path.endswith(".h"):
+        return read_header(path)
+    with open(path, "rb") as f:
+        return f.read()
+
+
+def write_header(path, name, data, comment):
+    guard = "__%s_H__" % name.upper()
+    with open(path, "w", newline="\n") as f:
+        f.write("#ifndef %s\n" % guard)
+        f.write("#define %s\n\n" % guard)
+        f.write("// %s\n" % comment)
+        f.write("// Generated by tools/model/build_model.py, do not edit.\n")
+        f.write("// TFLM requires the flatbuffer to be 16 byte aligned.\n")
+        f.write("alignas(16) const unsigned char %s[] = {\n" % name)
+        for i in range(0, len(data), 12):
+            line = ", ".join("0x%02x" % b for b in data[i:i + 12])
+            f.write("  " + line + (",\n" if i + 12 < len(data) else "};\n"))
+        f.write("const unsigned int %s_len = %d;\n\n" % (name, len(data)))
+        f.write("#endif\n")
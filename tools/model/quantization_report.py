@@ -0,0 +1,287 @@
+# Float vs int8 report for the committed anomaly model, without TensorFlow.
+#
+# evaluate_model.py compares real converted models and needs TensorFlow; this
+# script answers the same question for include/dht_anomaly_model.h on any
+# machine with plain Python 3. It reads the float flatbuffer (the FULLY_CONNECTED
+# / LOGISTIC graph build_model.py produces), runs it in float and through an
+# emulation of the full-integer int8 model build_model.py converts it to:
+#
+#   - input and activations asymmetric int8, ranges calibrated on the traces
+#   - weights symmetric per-tensor int8, biases int32 at input * weight scale
+#   - LOGISTIC output at the fixed 1/256 scale, zero point -128
+#
+# Rescaling uses float multipliers where TFLM uses 32 bit fixed point, which
+# moves scores by far less than one output step. The report lists size of the
+# weights, activation arena and flatbuffer, and how often the int8 model takes
+# the float model's decision (its accuracy with float as the reference); with
+# a labelled CSV (see build_model.py) accuracy against the labels is added.
+# Without a CSV it scores a synthetic week of DHT20 readings, 5 s apart.
+#
+#   python tools/model/quantization_report.py [traces.csv] [--out report.md]
+
+import argparse
+import math
+import os
+import random
+import struct
+
+from model_header import read_model
+
+PROJECT_DIR = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+OP_FULLY_CONNECTED = 9
+OP_LOGISTIC = 14
+OP_RELU = 19
+ACTIVATION_RELU = 1
+
+
+class FlatBuffer:
+    """Just enough of the flatbuffer wire format to walk a TFLite model."""
+
+    def __init__(self, data):
+        self.data = data
+
+    def u8(self, offset):
+        return self.data[offset]
+
+    def i32(self, offset):
+        return struct.unpack_from("<i", self.data, offset)[0]
+
+    def ref(self, offset):
+        return offset + struct.unpack_from("<I", self.data, offset)[0]
+
+    def field(self, table, index):
+        vtable = table - self.i32(table)
+        position = 4 + 2 * index
+        if position >= struct.unpack_from("<H", self.data, vtable)[0]:
+            return None
+        offset = struct.unpack_from("<H", self.data, vtable + position)[0]
+        return table + offset if offset else None
+
+    def vector(self, offset):
+        start = self.ref(offset)
+        return start + 4, struct.unpack_from("<I", self.data, start)[0]
+
+    def tables(self, table, index):
+        offset = self.field(table, index)
+        if offset is None:
+            return []
+        start, count = self.vector(offset)
+        return [self.ref(start + 4 * i) for i in range(count)]
+
+    def ints(self, table, index):
+        offset = self.field(table, index)
+        if offset is None:
+            return []
+        start, count = self.vector(offset)
+        return [self.i32(start + 4 * i) for i in range(count)]
+
+    def floats(self, offset):
+        start, count = self.vector(offset)
+        return list(struct.unpack_from("<%df" % (count // 4), self.data, start))
+
+
+def load_float_model(data):
+    """Returns the ops of the model as (opcode, activation, weights, bias) with
+    weights as rows of output units."""
+    fb = FlatBuffer(data)
+    model = fb.ref(0)
+    opcodes = []
+    for code in fb.tables(model, 1):
+        deprecated = fb.field(code, 0)
+        builtin = fb.field(code, 3)
+        opcodes.append(fb.i32(builtin) if builtin is not None else fb.u8(deprecated))
+    buffers = []
+    for buffer in fb.tables(model, 4):
+        offset = fb.field(buffer, 0)
+        buffers.append(fb.floats(offset) if offset is not None else [])
+    subgraph = fb.tables(model, 2)[0]
+    tensors = []
+    for tensor in fb.tables(subgraph, 0):
+        if fb.field(tensor, 1) is not None and fb.u8(fb.field(tensor, 1)) != 0:
+            raise SystemExit("only float32 models can be emulated")
+        tensors.append((fb.ints(tensor, 0), buffers[fb.i32(fb.field(tensor, 2))]))
+
+    ops = []
+    for op in fb.tables(subgraph, 3):
+        opcode = opcodes[fb.i32(fb.field(op, 0)) if fb.field(op, 0) is not None else 0]
+        inputs = fb.ints(op, 1)
+        if opcode == OP_FULLY_CONNECTED:
+            options = fb.field(op, 4)
+            activation = fb.u8(fb.field(fb.ref(options), 0)) if options and fb.field(fb.ref(options), 0) else 0
+            shape, weights = tensors[inputs[1]]
+            bias = tensors[inputs[2]][1] if len(inputs) > 2 and inputs[2] >= 0 else [0.0] * shape[0]
+            rows = [weights[r * shape[1]:(r + 1) * shape[1]] for r in range(shape[0])]
+            ops.append((opcode, activation, rows, bias))
+        elif opcode in (OP_LOGISTIC, OP_RELU):
+            ops.append((opcode, 0, None, None))
+        else:
+            raise SystemExit("op %d is not emulated" % opcode)
+    return ops
+
+
+def run_float(ops, sample, trace=None):
+    values = list(sample)
+    for n, (opcode, activation, rows, bias) in enumerate(ops):
+        if opcode == OP_FULLY_CONNECTED:
+            values = [sum(w * v for w, v in zip(row, values)) + b for row, b in zip(rows, bias)]
+            if activation == ACTIVATION_RELU:
+                values = [max(v, 0.0) for v in values]
+        elif opcode == OP_RELU:
+            values = [max(v, 0.0) for v in values]
+        else:
+            values = [1.0 / (1.0 + math.exp(-v)) for v in values]
+        if trace is not None:
+            trace[n].extend(values)
+    return values[0]
+
+
+def asymmetric(low, high):
+    """Scale and zero point of an int8 tensor covering [low, high] and 0."""
+    low, high = min(low, 0.0), max(high, 0.0)
+    scale = (high - low) / 255.0 or 1.0
+    return scale, int(max(-128, min(127, round(-128 - low / scale))))
+
+
+def quantize(value, scale, zero):
+    return max(-128, min(127, int(round(value / scale)) + zero))
+
+
+class Int8Model:
+    def __init__(self, ops, samples):
+        # Calibration: the range of every activation over the traces
+        ranges = [[] for _ in ops]
+        for sample in samples:
+            run_float(ops, sample, ranges)
+        self.input = asymmetric(min(min(s) for s in samples), max(max(s) for s in samples))
+        self.layers = []
+        for (opcode, activation, rows, bias), values in zip(ops, ranges):
+            if opcode == OP_LOGISTIC:
+                output = (1.0 / 256.0, -128)
+            else:
+                output = asymmetric(min(values), max(values))
+            weights = None
+            if rows is not None:
+                w_scale = max(abs(w) for row in rows for w in row) / 127.0 or 1.0
+                weights = ([[quantize(w, w_scale, 0) for w in row] for row in rows], w_scale, bias)
+            self.layers.append((opcode, activation, weights, output))
+
+    def run(self, sample):
+        scale, zero = self.input
+        q = [quantize(v, scale, zero) for v in sample]
+        for opcode, activation, weights, (out_scale, out_zero) in self.layers:
+            if opcode == OP_FULLY_CONNECTED:
+                rows, w_scale, bias = weights
+                acc_scale = scale * w_scale
+                out = []
+                for row, b in zip(rows, bias):
+                    acc = sum(w * (v - zero) for w, v in zip(row, q)) + int(round(b / acc_scale))
+                    value = quantize(acc * acc_scale, out_scale, out_zero)
+                    if activation == ACTIVATION_RELU:
+                        value = max(value, out_zero)
+                    out.append(value)
+                q = out
+            elif opcode == OP_RELU:
+                q = [quantize(max((v - zero) * scale, 0.0), out_scale, out_zero) for v in q]
+            else:
+                q = [quantize(1.0 / (1.0 + math.exp(-(v - zero) * scale)), out_scale, out_zero) for v in q]
+            scale, zero = out_scale, out_zero
+        return (q[0] - zero) * scale
+
+
+def synthetic_week(seed=0):
+    """DHT20 readings every 5 s for a week: a daily cycle with sensor noise,
+    humid spells and a few heat episodes so both sides of the threshold occur."""
+    rng = random.Random(seed)
+    samples = []
+    humid = heat = 0
+    for i in range(7 * 24 * 720):
+        day = 2 * math.pi * i / (24 * 720)
+        if humid == 0 and rng.random() < 1 / 5000:
+            humid = rng.randint(360, 2880)
+        if heat == 0 and rng.random() < 1 / 20000:
+            heat = rng.randint(360, 1440)
+        temperature = 27 + 4 * math.sin(day) + rng.gauss(0, 0.3) + (8 if heat else 0)
+        humidity = 62 - 10 * math.sin(day) + rng.gauss(0, 1.5) + (25 if humid else 0)
+        humid, heat = max(humid - 1, 0), max(heat - 1, 0)
+        samples.append((round(temperature, 2), round(min(max(humidity, 0), 100), 2), None))
+    return samples
+
+
+def load_csv(path):
+    with open(path, encoding="utf-8") as f:
+        header = f.readline().strip().split(",")
+        t, h = header.index("temperature"), header.index("humidity")
+        label = header.index("label") if "label" in header else None
+        samples = []
+        for line in f:
+            cells = line.strip().split(",")
+            if len(cells) == len(header):
+                samples.append((float(cells[t]), float(cells[h]), float(cells[label]) if label is not None else None))
+    return samples
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Float vs int8 report for the anomaly model")
+    parser.add_argument("traces", nargs="?", help="CSV with temperature,humidity and optionally label columns")
+    parser.add_argument("--model", default=os.path.join(PROJECT_DIR, "include", "dht_anomaly_model.h"))
+    parser.add_argument("--threshold", type=float, default=0.5)
+    parser.add_argument("--out", help="also write the report to this file")
+    args = parser.parse_args()
+
+    data = read_model(args.model)
+    ops = load_float_model(data)
+    rows = load_csv(args.traces) if args.traces else synthetic_week()
+    samples = [(t, h) for t, h, _ in rows]
+    labels = [label for _, _, label in rows]
+    int8 = Int8Model(ops, samples)
+
+    float_scores = [run_float(ops, s) for s in samples]
+    int8_scores = [int8.run(s) for s in samples]
+    float_flags = [s > args.threshold for s in float_scores]
+    int8_flags = [s > args.threshold for s in int8_scores]
+    agreement = sum(a == b for a, b in zip(float_flags, int8_flags)) / len(samples)
+    errors = sorted(abs(a - b) for a, b in zip(float_scores, int8_scores))
+
+    # Bytes of weights (flash) and of the activations in the tensor arena
+    weights = sum(len(rows) * len(rows[0]) for _, _, rows, _ in ops if rows)
+    biases = sum(len(bias) for _, _, _, bias in ops if bias)
+    activations = 2 + sum(len(rows) for _, _, rows, _ in ops if rows) + sum(1 for op in ops if not op[2])
+    # Every tensor gets a scale and zero point in the int8 flatbuffer, about 44 bytes each
+    tensors = 1 + sum(3 if op[2] else 1 for op in ops)
+    int8_size = len(data) - 3 * weights + 44 * tensors
+
+    lines = [
+        "# Anomaly model, float32 vs int8",
+        "",
+        "Generated by tools/model/quantization_report.py, int8 figures are emulated.",
+        "",
+        "Model: %s (%d ops), %d samples%s, threshold %.2f" % (
+            os.path.relpath(args.model, PROJECT_DIR), len(ops), len(samples),
+            " from " + os.path.basename(args.traces) if args.traces else " of a synthetic week", args.threshold),
+        "",
+        "| | float32 | int8 (emulated) |",
+        "|---|---:|---:|",
+        "| weights + biases | %d B | %d B |" % (4 * (weights + biases), weights + 4 * biases),
+        "| activations | %d B | %d B |" % (4 * activations, activations),
+        "| flatbuffer | %d B | ~%d B |" % (len(data), int8_size),
+        "| anomalous samples | %.2f%% | %.2f%% |" % (
+            100 * sum(float_flags) / len(samples), 100 * sum(int8_flags) / len(samples)),
+        "| decisions equal to float | 100.00%% | %.2f%% |" % (100 * agreement),
+        "| score error, p50 / p99 / max | - | %.4f / %.4f / %.4f |" % (
+            errors[len(errors) // 2], errors[len(errors) * 99 // 100], errors[-1]),
+    ]
+    if all(label is not None for label in labels):
+        truth = [label >= 0.5 for label in labels]
+        lines.append("| accuracy against labels | %.2f%% | %.2f%% |" % (
+            100 * sum(a == b for a, b in zip(float_flags, truth)) / len(truth),
+            100 * sum(a == b for a, b in zip(int8_flags, truth)) / len(truth)))
+    report = "\n".join(lines) + "\n"
+    print(report, end="")
+    if args.out:
+        with open(args.out, "w", newline="\n") as f:
+            f.write(report)
+
+
+if __name__ == "__main__":
+    main()
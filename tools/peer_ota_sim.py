@@ -0,0 +1,232 @@
+# Simulates the LAN-assisted firmware rollout of a site, see include/peer_ota.h.
+#
+# Every device gets the announcement, the elected seeders fetch the image from
+# the cloud chunk by chunk, the others discover them over mDNS and fetch ranges
+# from a random holder (PEER_OTA_MAX_SERVES at once per holder, a busy or
+# rebooting one is backed off). A query returns --mdns-results devices of the
+# site at most, the election and the holders are taken from that view only.
+# Ranks are compared when the view is the whole site, otherwise an unelected
+# device goes to the cloud after a wait spread over the fallback by its rank. A verified device seeds for PEER_OTA_SEED_MS,
+# reboots and serves from its running partition. The cloud link of the site
+# and the airtime of the LAN are shared by the transfers running at once.
+#
+#   python tools/peer_ota_sim.py
+#   python tools/peer_ota_sim.py --devices 50 --wan-mbps 5 --seeders 1
+#   python tools/peer_ota_sim.py --partial-election    # ranks compared on any view
+#
+# Prints WAN bytes and rollout times against every device fetching from the
+# cloud (the plain ThingsBoard OTA).
+
+import argparse
+import random
+import statistics
+
+MBIT = 1000000 / 8
+
+WAITING, DOWNLOADING, SEEDING, REBOOTING, UPDATED = range(5)
+
+
+class Device:
+    def __init__(self, index, rank, announce_at):
+        self.index = index
+        self.rank = rank            # id hashed with the checksum, a random permutation here
+        self.state = WAITING
+        self.announce_at = announce_at
+        self.started = None
+        self.offset = 0
+        self.transfer = None        # [source, remaining bytes, busy until] of the running chunk
+        self.sleep_until = 0.0
+        self.known = []             # holders seen at the last discovery
+        self.lower = 0              # devices without the image ranked below, in the same view
+        self.complete = False       # the view was the whole site
+        self.discovered_at = None
+        self.backoff = {}           # peer -> time it failed
+        self.serving = 0
+        self.holder = False
+        self.state_until = 0.0
+        self.updated_at = None
+        self.wan = 0
+        self.lan = 0
+
+
+def simulate(args, peers):
+    rng = random.Random(args.seed)
+    size = int(args.image_kb * 1024)
+    chunk = args.chunk
+    ranks = list(range(args.devices))
+    rng.shuffle(ranks)
+    devices = [Device(i, ranks[i], rng.uniform(0, args.announce_spread)) for i in range(args.devices)]
+    stats = {"busy": 0, "failed": 0, "seeders": 0}
+
+    def discover(device, now):
+        # The first answers of the site, in no particular order
+        others = [d for d in devices if d.index != device.index]
+        view = rng.sample(others, min(len(others), args.mdns_results, args.max_peers))
+        device.known = [d.index for d in view if d.holder]
+        device.lower = sum(1 for d in view if not d.holder and d.rank < device.rank)
+        device.complete = len(view) == len(others)
+        device.discovered_at = now
+
+    def elected(device):
+        if not device.complete and not args.partial_election:
+            return False
+        return device.lower < args.seeders
+
+    def fallback(device):
+        if device.complete or args.partial_election:
+            return args.cloud_fallback
+        return args.cloud_fallback * device.rank / len(devices)
+
+    def pick(device, now):
+        # pickSource(): a random holder, the cloud when elected or waited long enough
+        if not peers:
+            return "cloud"
+        for _ in range(2):
+            candidates = [p for p in device.known
+                          if now - device.backoff.get(p, -1e9) >= args.peer_backoff]
+            if candidates:
+                return rng.choice(candidates)
+            if device.discovered_at is not None and now - device.discovered_at < args.discovery:
+                break
+            discover(device, now)
+        if elected(device) or now - device.started >= fallback(device):
+            return "cloud"
+        return None
+
+    now = 0.0
+    dt = args.step
+    while any(d.state != UPDATED for d in devices):
+        if now > args.limit:
+            break
+
+        # Bandwidth of this step, split between the transfers running
+        cloud_transfers = [d for d in devices if d.transfer and d.transfer[0] == "cloud" and d.transfer[2] <= now]
+        lan_transfers = [d for d in devices if d.transfer and d.transfer[0] != "cloud" and d.transfer[2] <= now]
+        cloud_rate = min(args.device_mbps, args.wan_mbps / max(1, len(cloud_transfers))) * MBIT
+        lan_rate = min(args.device_mbps, args.lan_mbps / max(1, len(lan_transfers))) * MBIT
+
+        for d in devices:
+            if d.state == WAITING and now >= d.announce_at:
+                d.state = DOWNLOADING
+                d.started = now
+            elif d.state == SEEDING and now >= d.state_until:
+                d.state = REBOOTING
+                d.state_until = now + args.reboot
+            elif d.state == REBOOTING and now >= d.state_until:
+                d.state = UPDATED
+                d.updated_at = now
+
+            if d.state != DOWNLOADING:
+                continue
+
+            if d.transfer is not None:
+                source, remaining, ready = d.transfer
+                if ready > now:
+                    continue
+                rate = cloud_rate if source == "cloud" else lan_rate
+                remaining -= rate * dt
+                if remaining > 0:
+                    d.transfer[1] = remaining
+                    continue
+                length = min(chunk, size - d.offset)
+                d.offset += length
+                if source == "cloud":
+                    d.wan += length
+                else:
+                    d.lan += length
+                    devices[source].serving -= 1
+                d.transfer = None
+                if d.offset >= size:
+                    # Verified, advertised, seeding until the reboot
+                    d.holder = True
+                    d.state = SEEDING
+                    d.state_until = now + (args.seed_time if peers else 0.0)
+                    continue
+
+            if now < d.sleep_until:
+                continue
+            source = pick(d, now)
+            if source is None:
+                d.sleep_until = now + args.discovery
+                continue
+            length = min(chunk, size - d.offset)
+            if source == "cloud":
+                if d.offset == 0:
+                    stats["seeders"] += 1
+                d.transfer = ["cloud", length, now + args.latency]
+                continue
+            peer = devices[source]
+            if peer.state == REBOOTING:
+                # Times out, resumed at the same offset from another peer
+                d.backoff[source] = now
+                d.sleep_until = now + args.timeout
+                stats["failed"] += 1
+            elif peer.serving >= args.max_serves:
+                d.backoff[source] = now
+                d.sleep_until = now + args.latency
+                stats["busy"] += 1
+            else:
+                peer.serving += 1
+                d.transfer = [source, length, now + args.latency]
+        now += dt
+
+    updated = [d.updated_at - d.announce_at for d in devices if d.updated_at is not None]
+    return {
+        "wan": sum(d.wan for d in devices),
+        "lan": sum(d.lan for d in devices),
+        "updated": len(updated),
+        "median": statistics.median(updated) if updated else float("nan"),
+        "last": max(d.updated_at for d in devices if d.updated_at is not None) if updated else float("nan"),
+        "busy": stats["busy"],
+        "failed": stats["failed"],
+        "seeders": stats["seeders"],
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Simulates a LAN-assisted firmware rollout")
+    parser.add_argument("--devices", type=int, default=200)
+    parser.add_argument("--image-kb", type=float, default=1400)
+    parser.add_argument("--chunk", type=int, default=16384, help="PEER_OTA_CHUNK")
+    parser.add_argument("--wan-mbps", type=float, default=10, help="cloud link of the site")
+    parser.add_argument("--lan-mbps", type=float, default=40, help="WiFi airtime shared by the LAN transfers")
+    parser.add_argument("--device-mbps", type=float, default=4, help="HTTP throughput of one device")
+    parser.add_argument("--seeders", type=int, default=2, help="PEER_OTA_SEEDERS")
+    parser.add_argument("--max-serves", type=int, default=2, help="PEER_OTA_MAX_SERVES")
+    parser.add_argument("--max-peers", type=int, default=24, help="PEER_OTA_MAX_PEERS")
+    parser.add_argument("--mdns-results", type=int, default=20, help="PEER_OTA_MDNS_RESULTS")
+    parser.add_argument("--partial-election", action="store_true",
+                        help="compare ranks on whatever view the query returned")
+    parser.add_argument("--discovery", type=float, default=15, help="PEER_OTA_DISCOVERY_MS, seconds")
+    parser.add_argument("--cloud-fallback", type=float, default=900, help="PEER_OTA_CLOUD_FALLBACK_MS, seconds")
+    parser.add_argument("--peer-backoff", type=float, default=60, help="PEER_OTA_PEER_BACKOFF_MS, seconds")
+    parser.add_argument("--seed-time", type=float, default=60, help="PEER_OTA_SEED_MS, seconds")
+    parser.add_argument("--timeout", type=float, default=10, help="PEER_OTA_TIMEOUT_MS, seconds")
+    parser.add_argument("--reboot", type=float, default=8, help="seconds until a rebooted device serves again")
+    parser.add_argument("--latency", type=float, default=0.05, help="seconds per request")
+    parser.add_argument("--announce-spread", type=float, default=5, help="seconds over which the attributes arrive")
+    parser.add_argument("--step", type=float, default=0.05)
+    parser.add_argument("--limit", type=float, default=6 * 3600, help="simulated seconds at most")
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    size = int(args.image_kb * 1024)
+    print("%d devices, %.0f KB image, WAN %.0f Mbit/s, LAN %.0f Mbit/s"
+          % (args.devices, size / 1024, args.wan_mbps, args.lan_mbps))
+    print("%-10s %10s %10s %8s %10s %10s %6s %6s %8s"
+          % ("", "WAN MB", "LAN MB", "updated", "median s", "last s", "busy", "failed", "seeders"))
+    results = {}
+    for name, peers in (("cloud", False), ("peer", True)):
+        r = simulate(args, peers)
+        results[name] = r
+        print("%-10s %10.1f %10.1f %8d %10.0f %10.0f %6d %6d %8d"
+              % (name, r["wan"] / 1e6, r["lan"] / 1e6, r["updated"], r["median"], r["last"], r["busy"], r["failed"],
+                 r["seeders"]))
+
+    cloud, peer = results["cloud"], results["peer"]
+    if peer["wan"] > 0 and peer["last"] > 0:
+        print("WAN bytes / %.1f, rollout %.2fx" % (cloud["wan"] / peer["wan"], cloud["last"] / peer["last"]))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,151 @@
+# Symbolises a CPU profile, see include/cpu_profile.h for the format.
+#
+# Takes the file downloaded from /profile and the ELF of the firmware that
+# took it, and prints the folded stacks flamegraph.pl and speedscope read,
+# one line per distinct stack with its sample count:
+#
+#   python tools/profile_flamegraph.py profile.bin .pio/build/yolo_uno/firmware.elf > profile.folded
+#   flamegraph.pl profile.folded > profile.svg
+#
+# Stacks start with the task, and the core with --cores. Inlined functions
+# are expanded unless --no-inline. --top N prints the functions with the most
+# samples of their own to stderr instead.
+
+import argparse
+import collections
+import shutil
+import struct
+import subprocess
+import sys
+
+HEADER = struct.Struct("<4sBBBBHHII")
+MAGIC = b"CPRF"
+FORMAT = 1
+SAMPLE_NESTED = 0x80
+TASK_UNKNOWN = 0xFF
+ADDR2LINE = "xtensa-esp32s3-elf-addr2line"
+
+
+def decode(data):
+    magic, fmt, cores, depth, tasks, hz, name_len, duration_ms, count = HEADER.unpack_from(data)
+    if magic != MAGIC or fmt != FORMAT:
+        raise ValueError("not a CPU profile of format %d" % FORMAT)
+
+    pos = HEADER.size
+    names = []
+    for _ in range(tasks):
+        names.append(data[pos:pos + name_len].split(b"\0")[0].decode(errors="replace"))
+        pos += name_len
+
+    record = struct.Struct("<BBBB%dI" % depth)
+    if len(data) < pos + count * record.size:
+        raise ValueError("truncated profile, %d of %d samples"
+                         % ((len(data) - pos) // record.size, count))
+    samples = []
+    for _ in range(count):
+        core, task, used, _reserved, *pcs = record.unpack_from(data, pos)
+        pos += record.size
+        samples.append({
+            "core": core & ~SAMPLE_NESTED,
+            "nested": bool(core & SAMPLE_NESTED),
+            "task": names[task] if task < len(names) else "?",
+            "pcs": pcs[:used],
+        })
+
+    header = {"cores": cores, "depth": depth, "hz": hz, "duration_ms": duration_ms}
+    return header, samples
+
+
+def symbolise(addresses, elf, addr2line, inline):
+    """Maps every address to its frames, innermost first."""
+    if not addresses:
+        return {}
+    command = [addr2line, "-f", "-C", "-a", "-e", elf]
+    if inline:
+        command.append("-i")
+    ordered = sorted(addresses)
+    output = subprocess.run(command, input="\n".join("0x%08x" % a for a in ordered),
+                            capture_output=True, text=True, check=True).stdout
+
+    # -a starts every address with its own line, then function / location pairs
+    frames = {}
+    current = None
+    lines = output.splitlines()
+    i = 0
+    while i < len(lines):
+        line = lines[i]
+        if line.startswith("0x"):
+            current = int(line, 16)
+            frames[current] = []
+            i += 1
+            continue
+        function = line.strip()
+        i += 2
+        if function == "??":
+            function = "0x%08x" % current
+        frames[current].append(function)
+    return frames
+
+
+def fold(samples, frames, cores):
+    stacks = collections.Counter()
+    for sample in samples:
+        path = [sample["task"]]
+        if cores:
+            path.insert(0, "core%d" % sample["core"])
+        if sample["nested"]:
+            path.append("[interrupt]")
+        elif not sample["pcs"]:
+            path.append("[unknown]")
+        else:
+            # Outermost caller first, each address innermost inline first
+            for pc in reversed(sample["pcs"]):
+                path.extend(reversed(frames.get(pc, ["0x%08x" % pc])))
+        stacks[";".join(name.replace(";", ":") for name in path)] += 1
+    return stacks
+
+
+def top(samples, frames, count):
+    own = collections.Counter()
+    for sample in samples:
+        if sample["pcs"]:
+            own[frames.get(sample["pcs"][0], ["0x%08x" % sample["pcs"][0]])[0]] += 1
+        else:
+            own["[interrupt]" if sample["nested"] else "[unknown]"] += 1
+    total = len(samples) or 1
+    for name, n in own.most_common(count):
+        print("%6.2f%% %6d  %s" % (100.0 * n / total, n, name), file=sys.stderr)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Folded stacks of a CPU profile")
+    parser.add_argument("profile", help="file downloaded from /profile")
+    parser.add_argument("elf", help="firmware.elf of the image that was profiled")
+    parser.add_argument("--addr2line", default=ADDR2LINE, help="addr2line of the toolchain")
+    parser.add_argument("--no-inline", action="store_true", help="one frame per address")
+    parser.add_argument("--cores", action="store_true", help="start every stack with its core")
+    parser.add_argument("--task", help="only the samples of this task")
+    parser.add_argument("--top", type=int, metavar="N", help="print the N hottest functions instead")
+    args = parser.parse_args()
+
+    if shutil.which(args.addr2line) is None:
+        sys.exit("%s not found, pass --addr2line (it comes with the PlatformIO toolchain)" % args.addr2line)
+
+    with open(args.profile, "rb") as f:
+        header, samples = decode(f.read())
+    if args.task:
+        samples = [s for s in samples if s["task"] == args.task]
+    print("%d samples at %d Hz over %.1f s" % (len(samples), header["hz"], header["duration_ms"] / 1000.0),
+          file=sys.stderr)
+
+    addresses = {pc for sample in samples for pc in sample["pcs"]}
+    frames = symbolise(addresses, args.elf, args.addr2line, not args.no_inline)
+    if args.top:
+        top(samples, frames, args.top)
+        return
+    for stack, n in sorted(fold(samples, frames, args.cores).items()):
+        print("%s %d" % (stack, n))
+
+
+if __name__ == "__main__":
+    main()